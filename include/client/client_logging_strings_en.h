@@ -2,11 +2,13 @@
 #define CLIENT_LOGGING_STRINGS_H
 
 /* String constants for logging messages */
-#define CLIENT_LOG_USAGE "Usage: %s <pseudo> [-s server_ip]\n"
+#define CLIENT_LOG_USAGE "Usage: %s <pseudo> [-s server_ip | -u socket_path] [-c]\n"
 #define CLIENT_LOG_USAGE_PSEUDO "  pseudo: Your player name\n"
 #define CLIENT_LOG_USAGE_SERVER "  -s <server_ip> : Optional - directly connect to server IP instead of UDP discovery\n"
+#define CLIENT_LOG_USAGE_UNIX "  -u <socket_path> : Optional - connect to a local server through its Unix socket\n"
+#define CLIENT_LOG_USAGE_CHECKSUM "  -c : Optional - add a CRC-32C checksum to every frame\n"
 #define CLIENT_LOG_USAGE_DISCOVERY "  If no server IP is provided the client will use UDP broadcast discovery.\n"
-#define CLIENT_LOG_MISSING_PSEUDO "Il manque le pseudo. Usage: %s <pseudo> [-s server_ip]\n"
+#define CLIENT_LOG_MISSING_PSEUDO "Il manque le pseudo. Usage: %s <pseudo> [-s server_ip | -u socket_path]\n"
 #define CLIENT_LOG_PLAYER_NAME "Joueur: %s\n"
 #define CLIENT_LOG_WAITING_NOTIFICATION "En attente de notification\n"
 #define CLIENT_LOG_INVALID_CHOICE "Invalid choice. Please select 1-13.\n"
@@ -18,11 +20,16 @@
 #define CLIENT_LOG_USING_PROVIDED_IP "Using provided server IP: %s\n"
 #define CLIENT_LOG_CONNECTION_FAILED "Failed to connect to server\n"
 #define CLIENT_LOG_CONNECTED "Connected to server at %s:%d\n"
+#define CLIENT_LOG_CONNECTED_UNIX "Connected to local server at %s\n"
 #define CLIENT_LOG_INVALID_INPUT "Entree invalide\n"
 #define CLIENT_LOG_SEND_CONNECT_FAILED "Failed to send connect message\n"
 #define CLIENT_LOG_RECV_ACK_FAILED "Failed to receive acknowledgment\n"
 #define CLIENT_LOG_CONNECTION_REJECTED "Connection rejected: %s\n"
 #define CLIENT_LOG_CONNECTION_SUCCESS "%s\n"
+#define CLIENT_LOG_RECONNECTING "Connection lost - resuming session...\n"
+#define CLIENT_LOG_SESSION_RESUMED "Session resumed (%u missed notifications replayed)\n"
+#define CLIENT_LOG_SESSION_RESUMED_PARTIAL "Some notifications were lost while disconnected - refresh your lists and boards\n"
+#define CLIENT_LOG_RESUME_REJECTED "Could not resume session: %s\n"
 
 /* Basic commands logging constants */
 #define CLIENT_LOG_LISTING_PLAYERS "\nListing connected players...\n"
@@ -213,6 +220,8 @@
 #define CLIENT_UI_PLAYER_LIST_SEPARATOR "─────────────────────────────\n"
 #define CLIENT_UI_PLAYER_LIST_ITEM "  %d. %s\n"
 #define CLIENT_UI_PLAYER_LIST_FOOTER "─────────────────────────────\n"
+#define CLIENT_UI_PLAYER_LIST_STREAM_HEADER "\nConnected players:\n"
+#define CLIENT_UI_PLAYER_LIST_TOTAL "%d player(s) online\n"
 
 #define CLIENT_UI_CHALLENGE_SENT "Challenge sent to %s!\n"
 #define CLIENT_UI_CHALLENGE_SENT_INFO "They will receive a notification. Wait for them to accept or decline.\n"
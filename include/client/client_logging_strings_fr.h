@@ -2,11 +2,13 @@
 #define CLIENT_LOGGING_STRINGS_FR_H
 
 /* String constants for logging messages */
-#define CLIENT_LOG_USAGE "Utilisation : %s <pseudo> [-s server_ip]\n"
+#define CLIENT_LOG_USAGE "Utilisation : %s <pseudo> [-s server_ip | -u socket_path] [-c]\n"
 #define CLIENT_LOG_USAGE_PSEUDO "  pseudo : Votre nom de joueur\n"
 #define CLIENT_LOG_USAGE_SERVER "  -s <server_ip> : Optionnel - se connecter directement à l'IP du serveur au lieu de la découverte UDP\n"
+#define CLIENT_LOG_USAGE_UNIX "  -u <socket_path> : Optionnel - se connecter à un serveur local via son socket Unix\n"
+#define CLIENT_LOG_USAGE_CHECKSUM "  -c : Optionnel - ajouter une somme de contrôle CRC-32C à chaque trame\n"
 #define CLIENT_LOG_USAGE_DISCOVERY "  Si aucune IP de serveur n'est fournie, le client utilisera la découverte par diffusion UDP.\n"
-#define CLIENT_LOG_MISSING_PSEUDO "Il manque le pseudo. Usage: %s <pseudo> [-s server_ip]\n"
+#define CLIENT_LOG_MISSING_PSEUDO "Il manque le pseudo. Usage: %s <pseudo> [-s server_ip | -u socket_path]\n"
 #define CLIENT_LOG_PLAYER_NAME "Joueur: %s\n"
 #define CLIENT_LOG_WAITING_NOTIFICATION "En attente de notification\n"
 #define CLIENT_LOG_INVALID_CHOICE "Choix invalide. Veuillez sélectionner 1-10.\n"
@@ -18,11 +20,16 @@
 #define CLIENT_LOG_USING_PROVIDED_IP "Utilisation de l'IP du serveur fournie : %s\n"
 #define CLIENT_LOG_CONNECTION_FAILED "Échec de connexion au serveur\n"
 #define CLIENT_LOG_CONNECTED "Connecté au serveur à %s:%d\n"
+#define CLIENT_LOG_CONNECTED_UNIX "Connecté au serveur local sur %s\n"
 #define CLIENT_LOG_INVALID_INPUT "Entree invalide\n"
 #define CLIENT_LOG_SEND_CONNECT_FAILED "Échec d'envoi du message de connexion\n"
 #define CLIENT_LOG_RECV_ACK_FAILED "Échec de réception de l'accusé de réception\n"
 #define CLIENT_LOG_CONNECTION_REJECTED "Connexion rejetée : %s\n"
 #define CLIENT_LOG_CONNECTION_SUCCESS "%s\n"
+#define CLIENT_LOG_RECONNECTING "Connexion perdue - reprise de la session...\n"
+#define CLIENT_LOG_SESSION_RESUMED "Session reprise (%u notifications manquées rejouées)\n"
+#define CLIENT_LOG_SESSION_RESUMED_PARTIAL "Des notifications ont été perdues pendant la déconnexion - rafraîchissez vos listes et plateaux\n"
+#define CLIENT_LOG_RESUME_REJECTED "Impossible de reprendre la session : %s\n"
 
 /* Basic commands logging constants */
 #define CLIENT_LOG_LISTING_PLAYERS "\nListe des joueurs connectés...\n"
@@ -213,6 +220,8 @@
 #define CLIENT_UI_PLAYER_LIST_SEPARATOR "─────────────────────────────\n"
 #define CLIENT_UI_PLAYER_LIST_ITEM "  %d. %s\n"
 #define CLIENT_UI_PLAYER_LIST_FOOTER "─────────────────────────────\n"
+#define CLIENT_UI_PLAYER_LIST_STREAM_HEADER "\nJoueurs connectés :\n"
+#define CLIENT_UI_PLAYER_LIST_TOTAL "%d joueur(s) en ligne\n"
 
 #define CLIENT_UI_CHALLENGE_SENT "Défi envoyé à %s !\n"
 #define CLIENT_UI_CHALLENGE_SENT_INFO "Ils recevront une notification. Attendez qu'ils acceptent ou refusent.\n"
@@ -8,6 +8,7 @@
 #include <pthread.h>
 #include "../../include/common/types.h"
 #include "../../include/common/protocol.h"
+#include "../../include/common/messages.h"
 
 /* Notification listener thread */
 void* notification_listener(void* arg);
@@ -15,6 +16,12 @@ void* notification_listener(void* arg);
 /* Start notification listener thread */
 pthread_t start_notification_listener(void);
 
+/* Tagged request/response over the shared connection */
+error_code_t client_request_send(message_type_t type, const void* payload, size_t size, uint32_t* sequence);
+error_code_t client_request_wait(uint32_t sequence, message_type_t* type, void* payload,
+                                 size_t max_size, size_t* actual_size, int timeout_ms);
+error_code_t client_request_send_list(const msg_list_page_t* req, uint32_t* sequence);
+
 /* Send challenge accept message */
 error_code_t send_challenge_accept(int64_t challenge_id);
 
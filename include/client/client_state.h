@@ -17,6 +17,11 @@ extern void client_state_set_pseudo(const char* pseudo);
 extern bool client_state_is_running(void);
 extern void client_state_set_running(bool running);
 
+/* Server endpoint, remembered for resuming after a dropped connection:
+ * a TCP host and port, or a Unix socket path (host unused) */
+void client_state_set_endpoint(const char* host, int port, const char* unix_path);
+error_code_t client_state_reconnect(connection_t* conn);
+
 /* Pending challenges tracking */
 #define MAX_PENDING_CHALLENGES 10
 
@@ -36,7 +41,8 @@ pending_challenge_t* pending_challenges_get(int index);
 #define MAX_ACTIVE_GAMES 10
 
 typedef struct {
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;
+    char game_id[MAX_GAME_ID_LEN];      /* Label, for display */
     char player_a[MAX_PSEUDO_LEN];
     char player_b[MAX_PSEUDO_LEN];
     player_id_t my_side;
@@ -44,8 +50,8 @@ typedef struct {
 } active_game_t;
 
 void active_games_init(void);
-void active_games_add(const char* game_id, const char* player_a, const char* player_b, player_id_t my_side);
-void active_games_remove(const char* game_id);
+void active_games_add(game_handle_t game, const char* game_id, const char* player_a, const char* player_b, player_id_t my_side);
+void active_games_remove(game_handle_t game);
 int active_games_count(void);
 active_game_t* active_games_get(int index);
 void active_games_notify_turn(void);
@@ -55,14 +61,38 @@ void active_games_clear_notifications(void);  /* Clear all pending notifications
 
 /* Spectator state tracking */
 void spectator_state_init(void);
-void spectator_state_set(const char* game_id, const char* player_a, const char* player_b);
+void spectator_state_set(game_handle_t game, const char* player_a, const char* player_b);
 void spectator_state_clear(void);
 bool spectator_state_is_active(void);
-const char* spectator_state_get_game_id(void);
+game_handle_t spectator_state_get_game(void);
 void spectator_state_notify_update(void);
 bool spectator_state_wait_for_update(int timeout_sec);
 bool spectator_state_check_and_clear_updated(void);
 
+/* Watched board cache - kept current by MSG_BOARD_DELTA pushes */
+void board_cache_init(void);
+void board_cache_watch(game_handle_t game);
+void board_cache_seed(const msg_board_state_t* board);
+error_code_t board_cache_apply_delta(const msg_board_delta_t* delta);
+bool board_cache_get(msg_board_state_t* board_out);
+bool board_cache_take_resync(void);  /* True once after a sequence gap */
+void board_cache_clear(void);
+
+/* Response mailbox - the notification listener is the only socket reader;
+ * frames carrying a non-zero sequence are filed here for the waiting command */
+#define MAX_PENDING_REQUESTS 16
+
+/* How long the listener holds a stream frame waiting for the command */
+#define STREAM_DRAIN_TIMEOUT_MS 10000
+
+void response_mailbox_init(void);
+error_code_t response_mailbox_expect(uint32_t sequence);
+error_code_t response_mailbox_expect_stream(uint32_t sequence);  /* Frames until MSG_LIST_END */
+void response_mailbox_cancel(uint32_t sequence);
+bool response_mailbox_deliver(uint32_t sequence, message_type_t type, const void* payload, size_t size);
+error_code_t response_mailbox_wait(uint32_t sequence, message_type_t* type, void* payload,
+                                   size_t max_size, size_t* actual_size, int timeout_ms);
+
 /* Initialize all client state */
 void client_state_init(session_t* session);
 
@@ -24,6 +24,7 @@ char* read_line(char* buffer, size_t size);
 
 /* New UI display functions */
 void ui_display_player_list(const msg_player_list_t* list);
+void ui_display_player_list_page(const msg_player_list_t* list, int first_number);
 void ui_display_challenge_sent(const char* opponent);
 void ui_display_challenge_error(const char* error_msg);
 void ui_display_pending_challenges(int count);
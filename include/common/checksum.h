@@ -0,0 +1,24 @@
+/* Checksums
+ * CRC-32C (Castagnoli), used by the game log, the player store and frames
+ * sent with HEADER_FLAG_CHECKSUM. CPUs with SSE4.2 compute it with the crc32
+ * instruction, others with slicing-by-8 tables; the choice is made on first
+ * use. Like zlib's crc32, start with 0 and pass the result back in to
+ * continue over more data.
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* CRC-32C of `size` bytes, continuing from `crc` */
+uint32_t checksum_crc32c(uint32_t crc, const void* data, size_t size);
+
+/* Same result without the crc32 instruction, whatever the CPU */
+uint32_t checksum_crc32c_portable(uint32_t crc, const void* data, size_t size);
+
+/* "sse4.2" or "slicing-by-8": what checksum_crc32c uses */
+const char* checksum_implementation(void);
+
+#endif /* CHECKSUM_H */
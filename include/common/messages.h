@@ -15,6 +15,7 @@ typedef struct {
 typedef struct {
     char pseudo[MAX_PSEUDO_LEN];
     char version[16];
+    uint32_t features;   /* CONNECT_FEATURE_* the client supports */
 } msg_connect_t;
 
 /* MSG_CONNECT_ACK */
@@ -22,12 +23,15 @@ typedef struct {
     bool success;
     char message[256];
     char session_id[64];
+    char version[16];    /* Protocol version the server selected */
+    uint32_t features;   /* CONNECT_FEATURE_* enabled for this connection */
 } msg_connect_ack_t;
 
 /* MSG_ERROR */
 typedef struct {
     int32_t error_code;
     char error_msg[256];
+    uint32_t retry_after_ms;   /* ERR_RATE_LIMITED: wait this long before retrying */
 } msg_error_t;
 
 /* Player list item (reduced info for listing) */
@@ -74,7 +78,8 @@ typedef struct {
 
 /* MSG_GAME_STARTED */
 typedef struct {
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;
+    char game_id[MAX_GAME_ID_LEN];      /* Label, for display only */
     char player_a[MAX_PSEUDO_LEN];
     char player_b[MAX_PSEUDO_LEN];
     player_id_t your_side;
@@ -82,7 +87,7 @@ typedef struct {
 
 /* MSG_PLAY_MOVE */
 typedef struct {
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;
     char player[MAX_PSEUDO_LEN];
     int pit_index;
 } msg_play_move_t;
@@ -96,16 +101,18 @@ typedef struct {
     winner_t winner;
 } msg_move_result_t;
 
-/* MSG_GET_BOARD / MSG_BOARD_STATE */
+/* MSG_GET_BOARD / MSG_BOARD_STATE. A request without a handle looks the
+ * game up by its players. */
 typedef struct {
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;
     char player_a[MAX_PSEUDO_LEN];
     char player_b[MAX_PSEUDO_LEN];
 } msg_get_board_t;
 
 typedef struct {
     bool exists;
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;                 /* GAME_HANDLE_NONE for saved games */
+    char game_id[MAX_GAME_ID_LEN];      /* Label, or the saved game's key */
     char player_a[MAX_PSEUDO_LEN];
     char player_b[MAX_PSEUDO_LEN];
     int pits[NUM_PITS];
@@ -114,11 +121,43 @@ typedef struct {
     player_id_t current_player;
     game_state_t state;
     winner_t winner;
+    uint32_t seq;           /* Move sequence the snapshot reflects */
 } msg_board_state_t;
 
+/* MSG_BOARD_DELTA - Pushed to players and spectators after each move.
+ * Only the pits that changed are listed. Every BOARD_KEYFRAME_INTERVAL
+ * moves (and in answer to MSG_BOARD_RESYNC) a keyframe carrying all pits
+ * and absolute scores is sent instead. Only the used entries of changed[]
+ * are sent. */
+#define BOARD_DELTA_KEYFRAME 0x01   /* pits and scores are absolute */
+
+typedef struct {
+    uint8_t pit;
+    uint8_t seeds;
+} board_delta_pit_t;
+
+typedef struct {
+    game_handle_t game;
+    uint32_t seq;               /* Per-game move sequence number */
+    uint8_t flags;              /* BOARD_DELTA_* */
+    int8_t pit_played;          /* -1 if not caused by a move */
+    uint8_t current_player;     /* player_id_t */
+    uint8_t state;              /* game_state_t */
+    int8_t winner;              /* winner_t */
+    int8_t score_a;             /* Delta, or absolute on keyframes */
+    int8_t score_b;
+    uint8_t changed_count;
+    board_delta_pit_t changed[NUM_PITS];
+} msg_board_delta_t;
+
+/* MSG_BOARD_RESYNC */
+typedef struct {
+    game_handle_t game;
+} msg_board_resync_t;
+
 /* MSG_GAME_OVER */
 typedef struct {
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;
     winner_t winner;
     int score_a;
     int score_b;
@@ -133,7 +172,8 @@ typedef struct {
 
 /* MSG_LIST_GAMES / MSG_GAME_LIST */
 typedef struct {
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;                 /* GAME_HANDLE_NONE for saved games */
+    char game_id[MAX_GAME_ID_LEN];      /* Label, or the saved game's key */
     char player_a[MAX_PSEUDO_LEN];
     char player_b[MAX_PSEUDO_LEN];
     int spectator_count;
@@ -148,9 +188,9 @@ typedef struct {
 /* MSG_LIST_MY_GAMES / MSG_MY_GAME_LIST - Same structure as game_list but for player's games */
 typedef msg_game_list_t msg_my_game_list_t;
 
-/* MSG_SPECTATE_GAME */
+/* MSG_SPECTATE_GAME / MSG_STOP_SPECTATE */
 typedef struct {
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;
 } msg_spectate_game_t;
 
 /* MSG_SPECTATE_ACK */
@@ -164,7 +204,7 @@ typedef struct {
 typedef struct {
     char spectator[MAX_PSEUDO_LEN];
     int spectator_count;
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;
 } msg_spectator_joined_t;
 
 /* MSG_SET_BIO */
@@ -259,4 +299,41 @@ typedef struct {
 /* MSG_SAVED_GAME_STATE - Same structure as msg_board_state_t */
 typedef msg_board_state_t msg_saved_game_state_t;
 
+/* MSG_LIST_PAGE - Cursor-paginated form of the list requests. Answered with
+ * frames of the list's usual response type (MSG_PLAYER_LIST for
+ * MSG_LIST_PLAYERS, ...) and then MSG_LIST_END, all under the request's tag */
+typedef struct {
+    int32_t list_type;             /* MSG_LIST_PLAYERS, MSG_LIST_GAMES, MSG_LIST_MY_GAMES,
+                                      MSG_GET_CHALLENGES, MSG_LIST_FRIENDS or MSG_LIST_SAVED_GAMES */
+    uint64_t cursor;               /* 0 to start, else next_cursor from MSG_LIST_END */
+    uint32_t limit;                /* Max entries per frame, 0 for as many as fit */
+    uint32_t flags;                /* LIST_FLAG_* */
+    char player[MAX_PSEUDO_LEN];   /* MSG_LIST_SAVED_GAMES: optional player filter */
+} msg_list_page_t;
+
+/* MSG_LIST_END */
+typedef struct {
+    int32_t list_type;             /* Echoes msg_list_page_t.list_type */
+    uint64_t next_cursor;          /* Where the next request resumes, 0 once exhausted */
+    uint32_t entries;              /* Entries sent in the preceding frames */
+    uint32_t frames;               /* Number of preceding list frames */
+} msg_list_end_t;
+
+/* MSG_RESUME - sent instead of MSG_CONNECT on a new connection after the
+ * old one dropped. The token is the session_id of the MSG_CONNECT_ACK. */
+typedef struct {
+    char pseudo[MAX_PSEUDO_LEN];
+    char token[64];
+    uint32_t notifications_seen;   /* Untagged frames received on the session so far */
+} msg_resume_t;
+
+/* MSG_RESUME_ACK */
+typedef struct {
+    bool success;
+    bool complete;                 /* Every missed notification follows; if not, refetch state */
+    char message[256];
+    uint32_t replayed;             /* Untagged frames replayed right after this one */
+    uint32_t notifications_sent;   /* The client's notifications_seen once they arrive */
+} msg_resume_ack_t;
+
 #endif /* MESSAGES_H */
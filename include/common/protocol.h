@@ -5,6 +5,7 @@
 
 /* Protocol version */
 #define PROTOCOL_VERSION "1.0"
+#define PROTOCOL_VERSION_COMPACT "1.1"   /* Adds the compact payload codec */
 
 /* Message types */
 typedef enum {
@@ -62,7 +63,19 @@ typedef enum {
     MSG_SPECTATE_ACK,         /* Confirmation of spectate start */
     MSG_SPECTATOR_JOINED,     /* Notify players/spectators of new spectator */
     MSG_BIO_RESPONSE,         /* Bio data response */
-    MSG_PLAYER_STATS          /* Player statistics response */
+    MSG_PLAYER_STATS,         /* Player statistics response */
+
+    /* Incremental board updates */
+    MSG_BOARD_DELTA,          /* Push: changed pits/scores after a move */
+    MSG_BOARD_RESYNC,         /* Request a keyframe after a sequence gap */
+
+    /* Cursor-paginated lists */
+    MSG_LIST_PAGE,            /* Request a page (or stream) of any list */
+    MSG_LIST_END,             /* Closes the frames answering MSG_LIST_PAGE */
+
+    /* Session resumption */
+    MSG_RESUME,               /* Reattach to a session within its grace window */
+    MSG_RESUME_ACK            /* Followed by the notifications the client missed */
 } message_type_t;
 
 /* Notification message type filter */
@@ -73,16 +86,34 @@ typedef enum {
      (type) == MSG_SPECTATOR_JOINED || \
      (type) == MSG_GAME_OVER || \
      (type) == MSG_CHAT_MESSAGE || \
-     (type) == MSG_PLAYER_STATS)
+     (type) == MSG_PLAYER_STATS || \
+     (type) == MSG_BOARD_DELTA)
 
 /* Message header (fixed size for easy parsing) */
 typedef struct {
     uint32_t type;           /* message_type_t */
     uint32_t length;         /* Payload length in bytes */
     uint32_t sequence;       /* Sequence number for tracking */
-    uint32_t reserved;       /* Reserved for future use */
+    uint32_t reserved;       /* HEADER_FLAG_* bits */
 } message_header_t;
 
+/* Header flags (message_header_t.reserved) */
+#define HEADER_FLAG_COMPACT 0x00000001u  /* Payload uses the compact codec */
+#define HEADER_FLAG_COMPRESSED 0x00000002u  /* Payload is zlib-compressed */
+#define HEADER_FLAG_CHECKSUM 0x00000004u  /* Payload starts with a CRC-32C of the frame */
+
+/* With HEADER_FLAG_CHECKSUM, the payload's first 4 bytes (counted in its
+ * length, network order) are the CRC-32C of the header, then of the rest
+ * of the payload */
+#define FRAME_CHECKSUM_SIZE 4
+
+/* Optional features negotiated at MSG_CONNECT (msg_connect_t.features) */
+#define CONNECT_FEATURE_COMPRESSION 0x00000001u  /* Peer inflates compressed frames */
+#define CONNECT_FEATURE_CHECKSUM 0x00000002u     /* Both ends send HEADER_FLAG_CHECKSUM frames */
+
+/* Paged list requests (msg_list_page_t.flags) */
+#define LIST_FLAG_STREAM 0x00000001u  /* Send every remaining page, not just one */
+
 /* Maximum message size */
 #define MAX_MESSAGE_SIZE 8192
 #define HEADER_SIZE sizeof(message_header_t)
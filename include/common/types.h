@@ -37,6 +37,7 @@ typedef enum {
     ERR_RATE_LIMITED = -15,
     ERR_TOO_MANY_DECLINES = -16,
     ERR_UNEXPECTED_MESSAGE = -17,
+    ERR_SEQUENCE_GAP = -18,
     ERR_UNKNOWN = -99
 } error_code_t;
 
@@ -46,6 +47,15 @@ typedef enum {
     PLAYER_B = 1
 } player_id_t;
 
+/* Live game handle: the game's pool slot in the low 32 bits and the slot's
+ * generation in the high 32, so a handle to a finished game never reaches
+ * the game that reuses its slot. Handles are opaque to clients. */
+typedef uint64_t game_handle_t;
+#define GAME_HANDLE_NONE 0
+#define GAME_HANDLE_SLOT(handle) ((uint32_t)(handle))
+#define GAME_HANDLE_GENERATION(handle) ((uint32_t)((handle) >> 32))
+#define GAME_HANDLE_MAKE(slot, generation) (((game_handle_t)(generation) << 32) | (uint32_t)(slot))
+
 /* Game state */
 typedef enum {
     GAME_STATE_WAITING = 0,
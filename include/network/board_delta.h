@@ -0,0 +1,35 @@
+/* Board Delta Encoding
+ * Builds and applies MSG_BOARD_DELTA payloads so clients can track a game
+ * without re-requesting the full msg_board_state_t after every move
+ */
+
+#ifndef BOARD_DELTA_H
+#define BOARD_DELTA_H
+
+#include "../common/types.h"
+#include "../common/messages.h"
+#include "../game/board.h"
+#include <stddef.h>
+
+/* A full keyframe is sent every N moves to bound drift */
+#define BOARD_KEYFRAME_INTERVAL 16
+
+/* Delta construction (server side) */
+void board_delta_build(const board_t* before, const board_t* after, game_handle_t game,
+                       uint32_t seq, int pit_played, msg_board_delta_t* delta);
+void board_delta_build_keyframe(const board_t* board, game_handle_t game,
+                                uint32_t seq, msg_board_delta_t* delta);
+bool board_delta_is_keyframe_seq(uint32_t seq);
+
+/* Number of bytes to put on the wire (unused changed[] entries are cut) */
+size_t board_delta_wire_size(const msg_board_delta_t* delta);
+
+/* Check a received payload before use */
+error_code_t board_delta_validate(const msg_board_delta_t* delta, size_t size);
+
+/* Apply a delta to a cached board (client side).
+ * Returns ERR_DUPLICATE for stale deltas and ERR_SEQUENCE_GAP when one or
+ * more deltas were missed; the caller should then send MSG_BOARD_RESYNC. */
+error_code_t board_delta_apply(msg_board_state_t* board, const msg_board_delta_t* delta);
+
+#endif /* BOARD_DELTA_H */
@@ -0,0 +1,33 @@
+/* Compact Payload Codec
+ * Variable-length encoding of the message structs (varints, length-prefixed
+ * strings, only the used entries of lists). Negotiated per connection by
+ * protocol version; compact frames set HEADER_FLAG_COMPACT.
+ */
+
+#ifndef CODEC_H
+#define CODEC_H
+
+#include "../common/types.h"
+#include "../common/protocol.h"
+#include <stddef.h>
+
+/* Payload codecs */
+#define CODEC_RAW 0       /* C structs as-is (protocol 1.0) */
+#define CODEC_COMPACT 1   /* Variable-length encoding (protocol 1.1) */
+
+/* Codec a peer speaking `version` understands */
+uint8_t codec_for_version(const char* version);
+
+/* True if `type` has a compact encoding (empty payloads never need one) */
+bool codec_supports(message_type_t type);
+
+/* Encode a struct payload; fails if the result would not fit in max_output */
+error_code_t codec_encode(message_type_t type, const void* payload, size_t payload_size,
+                          void* output, size_t max_output, size_t* output_size);
+
+/* Decode back into the struct; *payload_size is the size a raw sender would
+ * have used (lists are cut after the last used entry) */
+error_code_t codec_decode(message_type_t type, const void* input, size_t input_size,
+                          void* payload, size_t max_payload_size, size_t* payload_size);
+
+#endif /* CODEC_H */
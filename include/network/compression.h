@@ -0,0 +1,51 @@
+/* Frame Compression
+ * zlib compression of large list/bio payloads, negotiated at MSG_CONNECT with
+ * CONNECT_FEATURE_COMPRESSION. Compressed frames set HEADER_FLAG_COMPRESSED;
+ * hot-path messages (moves, board updates) are never compressed.
+ */
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include "../common/types.h"
+#include "../common/protocol.h"
+#include <stddef.h>
+
+/* Payloads smaller than this (after the codec) are sent as-is */
+#define COMPRESSION_THRESHOLD 512
+
+/* zlib level: cheap, most of the gain on repetitive list entries */
+#define COMPRESSION_LEVEL 1
+
+/* Deflate state sized for frames of at most MAX_MESSAGE_SIZE */
+#define COMPRESSION_WINDOW_BITS 13
+#define COMPRESSION_MEM_LEVEL 6
+
+/* Process-wide counters, bumped atomically; a snapshot reads each on its own */
+typedef struct {
+    uint64_t frames_compressed;    /* Sent with HEADER_FLAG_COMPRESSED */
+    uint64_t frames_skipped;       /* Eligible but did not shrink */
+    uint64_t bytes_in;             /* Payload bytes before compression */
+    uint64_t bytes_out;            /* Payload bytes after compression */
+    uint64_t compress_ns;          /* Time spent in deflate */
+    uint64_t frames_decompressed;
+    uint64_t decompress_ns;        /* Time spent in inflate */
+} compression_stats_t;
+
+/* True if `type` is a bulk response worth compressing at `payload_size` */
+bool compression_should_compress(message_type_t type, size_t payload_size);
+
+/* Compress; ERR_SERIALIZATION if the result would not be smaller */
+error_code_t compression_compress(const void* input, size_t input_size,
+                                  void* output, size_t max_output, size_t* output_size);
+
+/* Inflate a compressed payload of at most max_output bytes */
+error_code_t compression_decompress(const void* input, size_t input_size,
+                                    void* output, size_t max_output, size_t* output_size);
+
+/* Statistics */
+void compression_get_stats(compression_stats_t* stats);
+void compression_reset_stats(void);
+void compression_print_stats(const char* label);
+
+#endif /* COMPRESSION_H */
@@ -3,26 +3,56 @@
 
 #include "../common/types.h"
 #include "../common/protocol.h"
+#include "read_buffer.h"
+#include "write_queue.h"
+#include "transport.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
-#include <sys/select.h>
 
 /* Connection structure with single socket for bidirectional communication */
-typedef struct {
+typedef struct connection_s {
     int socket_fd;    /* Single socket for both reading and writing */
     struct sockaddr_in addr;
     bool connected;
     uint32_t sequence;  /* Message sequence counter */
+    read_buffer_t* rx;  /* Receive ring, allocated by the first framed read */
+    write_queue_t* tx;  /* Send queue, shared by every copy of an open connection */
+    const transport_ops_t* transport;  /* NULL means TCP */
+    void* transport_data;  /* Per-transport state (loopback channel end) */
 } connection_t;
 
+/* Listen queue length for servers; the kernel caps it at net.core.somaxconn */
+#define CONNECTION_BACKLOG_DEFAULT 1024
+
 /* Connection management - Single socket for bidirectional communication */
 error_code_t connection_init(connection_t* conn);
 error_code_t connection_create_server(connection_t* conn, int port);
+/* With reuse_port, several listeners bind the same port (SO_REUSEPORT) and
+ * the kernel spreads incoming connections across them */
+error_code_t connection_create_listener(connection_t* conn, int port, int backlog, bool reuse_port);
 error_code_t connection_connect(connection_t* conn, const char* host, int port);
 error_code_t connection_accept(connection_t* server, connection_t* client);
+error_code_t connection_adopt(connection_t* conn, int fd);  /* Wrap an fd accepted elsewhere */
 error_code_t connection_close(connection_t* conn);
 
-/* Send/receive raw data */
+/* Session resumption over a new socket. connection_resume moves `fresh`'s
+ * socket under `conn`'s fd number (dup2), so threads already using `conn`
+ * carry on over the new socket; frames still queued for the old one are
+ * dropped, bytes `fresh` has buffered are kept, and `fresh` is closed
+ * (also on failure). Socket transports only. connection_shutdown wakes whoever is blocked on
+ * `conn`: reads see EOF and sends fail. */
+error_code_t connection_resume(connection_t* conn, connection_t* fresh);
+void connection_shutdown(connection_t* conn);
+
+/* Unix domain sockets: same stream protocol, no TCP/IP stack */
+error_code_t connection_create_unix_server(connection_t* conn, const char* path);
+error_code_t connection_connect_unix(connection_t* conn, const char* path);
+
+/* In-process pair: bytes sent on one end are received on the other.
+ * No fd and no syscalls; both ends must be closed. */
+error_code_t connection_loopback_pair(connection_t* a, connection_t* b);
+
+/* Send/receive raw data (socket transports only) */
 error_code_t connection_send_raw(connection_t* conn, const void* data, size_t size);
 error_code_t connection_recv_raw(connection_t* conn, void* buffer, size_t size, size_t* received);
 
@@ -31,10 +61,26 @@ error_code_t connection_send_timeout(connection_t* conn, const void* data, size_
 error_code_t connection_recv_timeout(connection_t* conn, void* buffer, size_t size, size_t* received, int timeout_ms);
 error_code_t connection_recv_peek(connection_t* conn, void* buffer, size_t size, size_t* received, int timeout_ms);
 
+/* Buffered framing: whole frames out of the connection's receive ring.
+ * A negative timeout blocks; zero takes only what is already readable.
+ * The view is valid until the next receive. */
+error_code_t connection_wait_readable(connection_t* conn, int timeout_ms);
+error_code_t connection_recv_frame(connection_t* conn, frame_view_t* view, int timeout_ms);
+error_code_t connection_peek_frame(connection_t* conn, message_header_t* header, int timeout_ms);
+
+/* Scatter-gather frame send. Between cork and the matching uncork, frames
+ * to this connection are held and then written together. */
+error_code_t connection_send_frame(connection_t* conn, const void* header, size_t header_size,
+                                   const void* payload, size_t payload_size, int timeout_ms);
+void connection_cork(connection_t* conn);
+error_code_t connection_uncork(connection_t* conn, int timeout_ms);
+
 /* Connection state */
+const transport_ops_t* connection_transport(const connection_t* conn);  /* Never NULL */
 bool connection_is_connected(const connection_t* conn);
 const char* connection_get_peer_ip(const connection_t* conn);
 error_code_t connection_enable_keepalive(connection_t* conn);
+error_code_t connection_enable_nodelay(connection_t* conn);
 error_code_t connection_set_nonblocking(connection_t* conn, bool enable);
 error_code_t connection_check_alive(connection_t* conn);
 
@@ -47,20 +93,42 @@ typedef struct {
 error_code_t connection_broadcast_discovery(discovery_response_t* response, int timeout_sec);
 error_code_t connection_listen_for_discovery(int discovery_port, int broadcast_port);
 
-/* Select-based multiplexing */
+/* Readiness multiplexing (epoll). Works for any fd value; there is no
+ * FD_SETSIZE limit. Results of the last wait are kept in `ready`. */
+#define POLL_CONTEXT_READ  0x1u
+#define POLL_CONTEXT_WRITE 0x2u
+#define POLL_CONTEXT_ERROR 0x4u   /* Hangup or socket error (reported, not requested) */
+#define POLL_CONTEXT_ONESHOT 0x8u /* Disarm after one report; re-arm with modify */
+
+/* Events collected per wait, and per epoll_wait call */
+#define POLL_CONTEXT_MAX_EVENTS 8192
+#define POLL_CONTEXT_BATCH 256
+
+typedef struct {
+    int fd;
+    uint32_t events;            /* POLL_CONTEXT_* */
+} poll_event_t;
+
 typedef struct {
-    fd_set read_fds;
-    fd_set write_fds;
-    fd_set except_fds;
-    int max_fd;
-    struct timeval timeout;
-} select_context_t;
-
-error_code_t select_context_init(select_context_t* ctx, int timeout_sec, int timeout_usec);
-error_code_t select_context_add_read(select_context_t* ctx, int fd);
-error_code_t select_context_add_write(select_context_t* ctx, int fd);
-bool select_context_is_readable(select_context_t* ctx, int fd);
-bool select_context_is_writable(select_context_t* ctx, int fd);
-error_code_t select_wait(select_context_t* ctx, int* ready_count);
+    int epoll_fd;
+    int timeout_ms;             /* Negative waits forever */
+    int registered;
+    poll_event_t* ready;
+    int ready_count;
+    int ready_capacity;
+} poll_context_t;
+
+error_code_t poll_context_init(poll_context_t* ctx, int timeout_ms);
+void poll_context_destroy(poll_context_t* ctx);
+error_code_t poll_context_add(poll_context_t* ctx, int fd, uint32_t events);
+error_code_t poll_context_modify(poll_context_t* ctx, int fd, uint32_t events);
+error_code_t poll_context_remove(poll_context_t* ctx, int fd);
+error_code_t poll_context_wait(poll_context_t* ctx, int* ready_count);
+const poll_event_t* poll_context_ready(const poll_context_t* ctx, int index);
+bool poll_context_is_readable(const poll_context_t* ctx, int fd);
+bool poll_context_is_writable(const poll_context_t* ctx, int fd);
+
+/* Wait for one fd (poll); SUCCESS when ready, ERR_TIMEOUT otherwise */
+error_code_t poll_fd(int fd, uint32_t events, int timeout_ms);
 
 #endif /* CONNECTION_H */
@@ -0,0 +1,100 @@
+/* Event-Driven Socket Backend
+ * One thread drives accepts, receives and sends for many sockets. Two
+ * implementations sit behind the same calls: epoll (readiness, then accept /
+ * recv / sendmsg per socket) and io_uring (multishot accept, multishot
+ * receives into a provided buffer ring, frames to one socket submitted as a
+ * linked chain, all of it submitted and reaped with one io_uring_enter per
+ * wait). io_uring falls back to epoll when the kernel refuses it.
+ */
+
+#ifndef IO_BACKEND_H
+#define IO_BACKEND_H
+
+#include "../common/types.h"
+#include "../common/protocol.h"
+#include <stddef.h>
+
+typedef enum {
+    IO_BACKEND_EPOLL = 0,
+    IO_BACKEND_URING
+} io_backend_kind_t;
+
+/* Receive buffers: size of each, and how many the ring provides */
+#define IO_BACKEND_BUFFER_SIZE 4096
+#define IO_BACKEND_BUFFER_COUNT 512
+
+/* Most events returned by one wait */
+#define IO_BACKEND_MAX_EVENTS 256
+
+/* Listening sockets one backend accepts on (e.g. TCP and a Unix socket) */
+#define IO_BACKEND_MAX_LISTENERS 4
+
+typedef enum {
+    IO_EVENT_ACCEPT,        /* fd: new connection from one of the listeners */
+    IO_EVENT_DATA,          /* fd: bytes received */
+    IO_EVENT_CLOSED         /* fd: peer hung up or the socket failed; receiving stopped */
+} io_event_type_t;
+
+/* `data` stays valid until the next io_backend_wait() */
+typedef struct {
+    io_event_type_t type;
+    int fd;
+    const char* data;
+    size_t length;
+} io_event_t;
+
+typedef struct {
+    uint64_t syscalls;      /* Kernel entries made by the backend */
+    uint64_t accepts;
+    uint64_t receives;      /* DATA events */
+    uint64_t bytes_in;
+    uint64_t sends;         /* Frames handed to io_backend_send() */
+    uint64_t bytes_out;
+} io_backend_stats_t;
+
+typedef struct {
+    io_backend_kind_t kind;
+    int listeners[IO_BACKEND_MAX_LISTENERS];
+    int listener_count;     /* 0 when not accepting */
+    void* impl;
+    io_backend_stats_t stats;
+} io_backend_t;
+
+/* Lifecycle. Asking for io_uring on a kernel without it (or with it
+ * disabled) yields an epoll backend; check `kind` afterwards. */
+error_code_t io_backend_init(io_backend_t* io, io_backend_kind_t kind, int listen_fd);
+void io_backend_destroy(io_backend_t* io);
+
+/* Accept on another listening socket as well */
+error_code_t io_backend_listen(io_backend_t* io, int listen_fd);
+
+/* Receive continuously from fd until it closes or is unwatched */
+error_code_t io_backend_watch(io_backend_t* io, int fd);
+/* Receive from fd once; the next DATA event for it disarms it again */
+error_code_t io_backend_recv(io_backend_t* io, int fd);
+/* Stop receiving and drop unsent frames; call before closing the fd */
+error_code_t io_backend_unwatch(io_backend_t* io, int fd);
+
+/* Send one frame. epoll writes it now; io_uring copies it and submits it
+ * with the next wait, chained behind earlier frames to the same fd. */
+error_code_t io_backend_send(io_backend_t* io, int fd, const void* header, size_t header_size,
+                             const void* payload, size_t payload_size);
+
+/* Submit queued work and collect up to max_events (negative timeout blocks) */
+error_code_t io_backend_wait(io_backend_t* io, io_event_t* events, int max_events, int timeout_ms,
+                             int* count);
+
+const char* io_backend_name(io_backend_kind_t kind);
+error_code_t io_backend_parse(const char* name, io_backend_kind_t* kind);
+
+/* io_uring implementation (io_uring.c) */
+error_code_t uring_backend_init(io_backend_t* io);
+void uring_backend_destroy(io_backend_t* io);
+error_code_t uring_backend_arm(io_backend_t* io, int fd, bool multishot);
+error_code_t uring_backend_unwatch(io_backend_t* io, int fd);
+error_code_t uring_backend_send(io_backend_t* io, int fd, const void* header, size_t header_size,
+                                const void* payload, size_t payload_size);
+error_code_t uring_backend_wait(io_backend_t* io, io_event_t* events, int max_events, int timeout_ms,
+                                int* count);
+
+#endif /* IO_BACKEND_H */
@@ -0,0 +1,66 @@
+/* Buffered Frame Reader
+ * Per-connection receive ring filled with large non-blocking reads. Complete
+ * frames are handed out as views into the ring, so a burst of small messages
+ * costs one read instead of a header read and a payload read each.
+ */
+
+#ifndef READ_BUFFER_H
+#define READ_BUFFER_H
+
+#include "../common/types.h"
+#include "../common/protocol.h"
+#include <stddef.h>
+
+/* Ring capacity: several full frames, so a pipelined burst drains in one read */
+#define READ_BUFFER_SIZE 65536
+
+/* Per-connection counters */
+typedef struct {
+    uint64_t waits;         /* Readiness waits (poll) */
+    uint64_t reads;         /* recvmsg calls, including ones that found nothing */
+    uint64_t bytes;         /* Bytes read from the socket */
+    uint64_t frames;        /* Frames handed out */
+    uint64_t linearized;    /* Frames copied out because they wrapped the ring */
+} read_buffer_stats_t;
+
+/* A received frame; payload points into the ring (or its scratch copy) and
+ * stays valid until the next read_buffer call on the same buffer */
+typedef struct {
+    message_type_t type;
+    uint32_t sequence;
+    uint32_t flags;         /* HEADER_FLAG_* */
+    const char* payload;
+    size_t length;
+} frame_view_t;
+
+typedef struct {
+    char data[READ_BUFFER_SIZE];
+    size_t head;            /* Offset of the first unread byte */
+    size_t count;           /* Unread bytes */
+    char scratch[MAX_MESSAGE_SIZE];  /* Linear copy of a frame that wraps */
+    read_buffer_stats_t stats;
+} read_buffer_t;
+
+/* Lifecycle */
+read_buffer_t* read_buffer_create(void);
+void read_buffer_destroy(read_buffer_t* rb);
+void read_buffer_reset(read_buffer_t* rb);
+
+/* One read into all free space. Unless `block`, *received is 0 if nothing
+ * was pending. ERR_NETWORK_ERROR on EOF or a socket error. */
+error_code_t read_buffer_fill(read_buffer_t* rb, int fd, bool block, size_t* received);
+
+/* Append bytes directly (tests and in-process transports) */
+error_code_t read_buffer_append(read_buffer_t* rb, const void* data, size_t size);
+
+/* Take the next complete frame. ERR_TIMEOUT if more bytes are needed,
+ * ERR_SERIALIZATION if the header announces an oversized payload. */
+error_code_t read_buffer_next_frame(read_buffer_t* rb, frame_view_t* view);
+
+/* Decode the next header without consuming it; ERR_TIMEOUT if incomplete */
+error_code_t read_buffer_peek_header(const read_buffer_t* rb, message_header_t* header);
+
+size_t read_buffer_pending(const read_buffer_t* rb);
+void read_buffer_get_stats(const read_buffer_t* rb, read_buffer_stats_t* stats);
+
+#endif /* READ_BUFFER_H */
@@ -23,6 +23,9 @@ error_code_t serialize_uint32(serialize_buffer_t* buffer, uint32_t value);
 error_code_t serialize_bool(serialize_buffer_t* buffer, bool value);
 error_code_t serialize_string(serialize_buffer_t* buffer, const char* str, size_t max_len);
 error_code_t serialize_bytes(serialize_buffer_t* buffer, const void* data, size_t size);
+error_code_t serialize_varint(serialize_buffer_t* buffer, uint64_t value);
+error_code_t serialize_svarint(serialize_buffer_t* buffer, int64_t value);
+error_code_t serialize_lstring(serialize_buffer_t* buffer, const char* str, size_t max_len);
 
 /* Deserialization primitives */
 error_code_t deserialize_int32(serialize_buffer_t* buffer, int32_t* value);
@@ -30,6 +33,9 @@ error_code_t deserialize_uint32(serialize_buffer_t* buffer, uint32_t* value);
 error_code_t deserialize_bool(serialize_buffer_t* buffer, bool* value);
 error_code_t deserialize_string(serialize_buffer_t* buffer, char* str, size_t max_len);
 error_code_t deserialize_bytes(serialize_buffer_t* buffer, void* data, size_t size);
+error_code_t deserialize_varint(serialize_buffer_t* buffer, uint64_t* value);
+error_code_t deserialize_svarint(serialize_buffer_t* buffer, int64_t* value);
+error_code_t deserialize_lstring(serialize_buffer_t* buffer, char* str, size_t max_len);
 
 /* Message header serialization */
 error_code_t serialize_header(serialize_buffer_t* buffer, const message_header_t* header);
@@ -38,6 +44,11 @@ error_code_t deserialize_header(serialize_buffer_t* buffer, message_header_t* he
 /* High-level message serialization */
 error_code_t serialize_message(message_type_t type, const void* payload, size_t payload_size, 
                                void* output, size_t* output_size);
+error_code_t serialize_message_tagged(message_type_t type, uint32_t sequence, const void* payload,
+                                      size_t payload_size, void* output, size_t* output_size);
+error_code_t serialize_message_frame(message_type_t type, uint32_t sequence, uint32_t flags,
+                                     const void* payload, size_t payload_size,
+                                     void* output, size_t* output_size);
 error_code_t deserialize_message(const void* input, size_t input_size, 
                                  message_type_t* type, void* payload, size_t max_payload_size);
 
@@ -5,15 +5,40 @@
 #include "../common/protocol.h"
 #include "../common/messages.h"
 #include "connection.h"
+#include <pthread.h>
+
+/* Notification backlog: the untagged frames a server session has sent, kept
+ * so a client that resumes after a dropped connection gets the ones it
+ * missed. Frames are stored before encoding and re-encoded on replay. */
+#define SESSION_BACKLOG_FRAMES 64
+#define SESSION_BACKLOG_PAYLOAD 1024      /* Larger frames are counted, not kept */
+
+typedef struct {
+    message_type_t type;
+    uint32_t size;                        /* SESSION_BACKLOG_DROPPED if not kept */
+    char payload[SESSION_BACKLOG_PAYLOAD];
+} session_backlog_frame_t;
+
+#define SESSION_BACKLOG_DROPPED UINT32_MAX
+
+typedef struct {
+    pthread_mutex_t lock;                 /* Orders recording with the wire, and with resumes */
+    uint32_t recorded;                    /* Untagged frames sent over the session's life */
+    session_backlog_frame_t frames[SESSION_BACKLOG_FRAMES];
+} session_backlog_t;
 
 /* Session structure */
 typedef struct {
     connection_t conn;
     char pseudo[MAX_PSEUDO_LEN];
+    uint32_t player_id;         /* Server side: interned pseudo (pseudo_table.h) */
     char session_id[64];
     bool authenticated;
     time_t created_at;
     time_t last_activity;
+    uint8_t codec;              /* CODEC_* payload encoding agreed at connect */
+    uint32_t features;          /* CONNECT_FEATURE_* agreed at connect */
+    session_backlog_t* backlog; /* Server side, resumable sessions only */
 } session_t;
 
 /* Session management */
@@ -21,14 +46,41 @@ error_code_t session_init(session_t* session);
 error_code_t session_create(session_t* session, connection_t* conn, const char* pseudo);
 error_code_t session_close(session_t* session);
 
+/* Resumption (server side). session_resume moves the session onto `fresh`
+ * (see connection_resume), confirms with MSG_RESUME_ACK and replays the
+ * untagged frames sent since the client's notifications_seen. */
+session_backlog_t* session_backlog_create(void);
+void session_backlog_destroy(session_backlog_t* backlog);
+error_code_t session_resume(session_t* session, connection_t* fresh, uint32_t notifications_seen);
+
 /* Message sending (high-level) */
 error_code_t session_send_message(session_t* session, message_type_t type, const void* payload, size_t payload_size);
 error_code_t session_recv_message(session_t* session, message_type_t* type, void* payload, size_t max_payload_size, size_t* actual_size, const message_type_t* expected_types, size_t num_expected);
 error_code_t session_recv_message_timeout(session_t* session, message_type_t* type, void* payload, size_t max_payload_size, size_t* actual_size, int timeout_ms, const message_type_t* expected_types, size_t num_expected);
 error_code_t session_peek_message_type(session_t* session, message_type_t* type, int timeout_ms);
 
+/* Sequence correlation: requests carry a non-zero tag that the server echoes
+ * in its response; notifications always carry tag 0 */
+error_code_t session_send_request(session_t* session, message_type_t type, const void* payload, size_t payload_size, uint32_t* sequence_out);
+uint32_t session_next_sequence(session_t* session);
+error_code_t session_send_tagged(session_t* session, message_type_t type, uint32_t sequence, const void* payload, size_t payload_size);
+error_code_t session_send_notification(session_t* session, message_type_t type, const void* payload, size_t payload_size);
+error_code_t session_recv_tagged_timeout(session_t* session, message_type_t* type, uint32_t* sequence, void* payload, size_t max_payload_size, size_t* actual_size, int timeout_ms);
+
+/* Server side: make session_send_message echo a request tag on this thread */
+void session_begin_reply(const session_t* session, uint32_t sequence);
+void session_end_reply(void);
+
+/* Coalescing: frames sent to `session` between begin and flush, by any
+ * thread, are held and written with one send at the flush. Call from the
+ * thread that owns the session. */
+void session_batch_begin(session_t* session);
+void session_batch_flush(void);
+
 /* Convenience functions for specific messages */
 error_code_t session_send_error(session_t* session, error_code_t error, const char* msg);
+/* ERR_RATE_LIMITED with a retry hint, also appended to msg */
+error_code_t session_send_rate_limited(session_t* session, uint32_t retry_after_ms, const char* msg);
 error_code_t session_send_connect_ack(session_t* session, bool success, const char* msg);
 error_code_t session_send_message_connect_ack(connection_t conn, const char* msg);
 error_code_t session_send_board_state(session_t* session, const msg_board_state_t* board);
@@ -0,0 +1,43 @@
+/* Connection Transports
+ * A connection does its byte I/O through a transport: TCP, a Unix domain
+ * socket, or an in-process loopback pair. Framing, corking and the session
+ * layer above are the same for all of them.
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include "../common/types.h"
+#include "read_buffer.h"
+#include <stdbool.h>
+#include <sys/uio.h>
+
+struct connection_s;
+
+typedef struct transport_ops {
+    const char* name;
+
+    /* One read into the receive ring; same contract as read_buffer_fill */
+    error_code_t (*fill)(struct connection_s* conn, read_buffer_t* rx, bool block, size_t* received);
+
+    /* SUCCESS once readable (or closed), ERR_TIMEOUT otherwise */
+    error_code_t (*wait_readable)(struct connection_s* conn, int timeout_ms);
+
+    /* Write every byte of `iov`; `iov` is consumed */
+    error_code_t (*sendv)(struct connection_s* conn, struct iovec* iov, int iov_count, int timeout_ms);
+
+    error_code_t (*check_alive)(struct connection_s* conn);
+    void (*close)(struct connection_s* conn);
+
+    /* Shown in place of a peer IP; NULL for transports with an IP peer */
+    const char* peer_name;
+} transport_ops_t;
+
+extern const transport_ops_t transport_tcp;
+extern const transport_ops_t transport_unix;
+extern const transport_ops_t transport_loopback;
+
+/* Bytes buffered in each direction of a loopback pair */
+#define LOOPBACK_CAPACITY 65536
+
+#endif /* TRANSPORT_H */
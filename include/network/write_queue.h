@@ -0,0 +1,72 @@
+/* Outbound Frame Queue
+ * Per-connection send path. Frames go out as a header + payload iovec pair
+ * with no staging copy. While a connection is corked, frames are appended to
+ * a queue instead and leave in one send when the last cork is released, so a
+ * burst of replies and notifications shares a syscall and a TCP segment.
+ */
+
+#ifndef WRITE_QUEUE_H
+#define WRITE_QUEUE_H
+
+#include "../common/types.h"
+#include "../common/protocol.h"
+#include <stddef.h>
+#include <pthread.h>
+#include <sys/uio.h>
+
+/* Queue capacity; a frame that does not fit flushes what is queued first */
+#define WRITE_QUEUE_SIZE 32768
+
+/* Per-connection counters */
+typedef struct {
+    uint64_t frames;        /* Frames handed to the queue */
+    uint64_t queued;        /* Of those, frames held for a later flush */
+    uint64_t flushes;       /* Batches written out */
+    uint64_t sends;         /* sendmsg calls, including partial writes */
+    uint64_t waits;         /* Waits for a full socket buffer to drain */
+    uint64_t bytes;
+} write_queue_stats_t;
+
+/* Destination for flushed bytes when the connection has no socket (an
+ * in-process transport). Same contract as write_queue_sendv. */
+typedef error_code_t (*write_queue_sink_t)(void* ctx, struct iovec* iov, int iov_count, int timeout_ms);
+
+typedef struct {
+    pthread_mutex_t lock;   /* Serializes writers; frames never interleave */
+    int corked;             /* Nested cork depth */
+    size_t used;
+    char data[WRITE_QUEUE_SIZE];
+    write_queue_stats_t stats;
+    write_queue_sink_t sink;    /* NULL: sendmsg on the fd passed in */
+    void* sink_ctx;
+} write_queue_t;
+
+/* Lifecycle */
+write_queue_t* write_queue_create(void);
+void write_queue_destroy(write_queue_t* wq);
+void write_queue_set_sink(write_queue_t* wq, write_queue_sink_t sink, void* ctx);
+
+/* Send a frame now, or queue it while corked. Frames already queued go
+ * first; if they time out they stay queued and the new frame is not sent. */
+error_code_t write_queue_send(write_queue_t* wq, int fd, const void* header, size_t header_size,
+                              const void* payload, size_t payload_size, int timeout_ms);
+
+/* Corking nests; the outermost uncork flushes */
+void write_queue_cork(write_queue_t* wq);
+error_code_t write_queue_uncork(write_queue_t* wq, int fd, int timeout_ms);
+
+/* Drop queued frames without sending them; the cork depth is kept */
+void write_queue_discard(write_queue_t* wq);
+
+size_t write_queue_pending(write_queue_t* wq);
+void write_queue_get_stats(write_queue_t* wq, write_queue_stats_t* stats);
+
+/* Write every byte of `iov`, waiting up to timeout_ms each time the socket
+ * buffer is full. `iov` is consumed. `stats` may be NULL. A failure after
+ * some bytes went out would leave a torn frame on the stream: the socket is
+ * then shut down and ERR_NETWORK_ERROR returned, so ERR_TIMEOUT always means
+ * nothing was written. */
+error_code_t write_queue_sendv(int fd, struct iovec* iov, int iov_count, int timeout_ms,
+                               write_queue_stats_t* stats);
+
+#endif /* WRITE_QUEUE_H */
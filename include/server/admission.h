@@ -0,0 +1,78 @@
+/* Admission Control
+ * client_handler asks admission_begin before dispatching a request. Each
+ * session has a token bucket for all its traffic and one per request class,
+ * so a client can burst but not sustain a flood of lists, chat or storage
+ * scans. Across the server, the number of requests being handled selects an
+ * overload level that sheds the most expensive classes first. A refused
+ * request is answered with ERR_RATE_LIMITED and a retry hint.
+ */
+
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include "../common/types.h"
+#include "../common/protocol.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Request classes, cheapest first. Overload sheds from the end. */
+typedef enum {
+    ADMISSION_CLASS_GAME,       /* Moves, boards, challenges, spectating */
+    ADMISSION_CLASS_QUERY,      /* Single-record lookups and updates */
+    ADMISSION_CLASS_CHAT,       /* Fans out to other sessions */
+    ADMISSION_CLASS_LIST,       /* Walks a server-wide table */
+    ADMISSION_CLASS_STORAGE,    /* Scans the games file */
+    ADMISSION_CLASS_COUNT
+} admission_class_t;
+
+/* Sustained requests/s and burst for a session's overall bucket */
+#define ADMISSION_SESSION_RATE 50.0
+#define ADMISSION_SESSION_BURST 100.0
+
+/* Requests being handled server-wide at which overload sheds storage scans,
+ * and at which it also sheds lists and chat. Game traffic and queries are
+ * never shed. */
+#define ADMISSION_OVERLOAD_INFLIGHT 8
+#define ADMISSION_SHED_INFLIGHT 16
+/* Retry hint for shed requests, per overload level */
+#define ADMISSION_OVERLOAD_RETRY_MS 500
+
+typedef struct {
+    double tokens;
+    double rate;                /* Tokens added per second */
+    double burst;               /* Capacity */
+    double last;                /* Refill time, seconds on the monotonic clock */
+} token_bucket_t;
+
+/* One per session, owned by its handler thread */
+typedef struct {
+    token_bucket_t session;
+    token_bucket_t classes[ADMISSION_CLASS_COUNT];
+    bool limited;               /* Last request was refused; logs once per streak */
+} admission_t;
+
+/* Starts full */
+void token_bucket_init(token_bucket_t* bucket, double rate, double burst, double now);
+/* Takes `cost` tokens if there are enough. Otherwise takes none and, if
+ * retry_ms is non-NULL, sets it to how long until there will be. */
+bool token_bucket_take(token_bucket_t* bucket, double cost, double now, uint32_t* retry_ms);
+
+/* Class of a request; MSG_LIST_PAGE is classed by the list it pages */
+admission_class_t admission_classify(message_type_t type, const void* payload, size_t payload_size);
+const char* admission_class_name(admission_class_t cls);
+
+void admission_init(admission_t* admission);
+
+/* Admit or refuse a request. On SUCCESS the request counts as in progress
+ * until admission_end. Otherwise returns ERR_RATE_LIMITED with *retry_ms
+ * set and *shed true if overload rather than the session's own rate
+ * refused it. */
+error_code_t admission_begin(admission_t* admission, message_type_t type, const void* payload,
+                             size_t payload_size, uint32_t* retry_ms, bool* shed);
+void admission_end(void);
+
+/* 0 normal, 1 shedding storage scans, 2 also shedding lists and chat */
+int admission_overload_level(void);
+
+#endif /* ADMISSION_H */
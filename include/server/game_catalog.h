@@ -0,0 +1,55 @@
+/* Game Catalog
+ * What the saved-game listings show of every stored game (ID, label,
+ * players, result, date and move count), kept in memory. It is built from
+ * the game log when storage opens, then kept current as games start,
+ * finish and are deleted, so listing reads no disk.
+ *
+ * Games are listed by date (creation time, then ID). Besides the list of
+ * all games, each player has their own, so a page filtered by player
+ * and/or date range starts with a binary search: O(log N) plus the page,
+ * however many games are stored or match.
+ */
+
+#ifndef GAME_CATALOG_H
+#define GAME_CATALOG_H
+
+#include "../common/types.h"
+#include "game_log.h"
+#include "pseudo_table.h"
+#include <stdint.h>
+#include <time.h>
+
+/* A listing's filter; zeroed, it lists every game */
+typedef struct {
+    pseudo_id_t player;         /* PSEUDO_ID_NONE for any */
+    time_t since;               /* Created at or after; 0 for no bound */
+    time_t until;               /* Created before; 0 for no bound */
+} game_catalog_filter_t;
+
+typedef struct {
+    uint64_t games;
+    uint32_t players;           /* With at least one game */
+    uint32_t build_ms;          /* Building it from the log when last opened */
+} game_catalog_stats_t;
+
+/* Rebuild from the open game log */
+error_code_t game_catalog_build(void);
+void game_catalog_clear(void);
+
+/* A game just started in the log, or imported into it */
+error_code_t game_catalog_add(game_log_id_t id, const char* label, pseudo_id_t player_a, pseudo_id_t player_b,
+                              time_t created_at);
+/* A game's result once it has ended */
+void game_catalog_finish(game_log_id_t id, game_state_t state, winner_t winner, uint32_t moves);
+void game_catalog_remove(game_log_id_t id);
+
+/* Up to `max` games matching `filter` by date, starting at the game with ID
+ * `from` (GAME_LOG_ID_NONE for the first). *next is the ID to resume from,
+ * or GAME_LOG_ID_NONE once exhausted. A `from` deleted meanwhile resumes
+ * where it stood. */
+error_code_t game_catalog_page(const game_catalog_filter_t* filter, game_log_id_t from, game_log_info_t* out,
+                               int max, int* count, game_log_id_t* next);
+
+void game_catalog_get_stats(game_catalog_stats_t* stats);
+
+#endif /* GAME_CATALOG_H */
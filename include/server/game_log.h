@@ -0,0 +1,176 @@
+/* Game Log
+ * Append-only record of every game, in numbered segment files under one
+ * directory. A game is a START record, one MOVE record per move (a few
+ * bytes) and optional SNAPSHOT records carrying the whole board. Each record
+ * points back at the previous record of the same game, and an in-memory
+ * index maps each game ID to its first and latest record. Persisting a move
+ * is one append and an index update, however many games are stored; loading
+ * a game walks back to its last snapshot and replays the moves after it.
+ * The index is rebuilt by scanning the segments when the log is opened,
+ * several at a time.
+ *
+ * A finished game gets a compact GAME record holding its whole history:
+ * names, times, every move in 4 bits, a board every
+ * GAME_LOG_SNAPSHOT_INTERVAL moves and the final board. Loading it needs no
+ * replay, and the START/MOVE records before it are no longer read.
+ *
+ * Appends only encode the record and queue it; a writer thread drains the
+ * queue, writing each run of records with one pwritev and syncing them
+ * together according to the sync policy (group commit).
+ *
+ * Segments are immutable once sealed and are then read through a read-only
+ * mapping, records decoded in place; only the active segment is read with
+ * pread.
+ *
+ * Sealed segments are compacted in the background: one that holds no record
+ * of a game still without its GAME record is rewritten as an immutable
+ * archive of the GAME records still current (plus the DELETE records still
+ * needed), deflated in blocks found through a sparse index, and the segment
+ * file is removed. Appends go on meanwhile; the index lock is only taken
+ * briefly.
+ */
+
+#ifndef GAME_LOG_H
+#define GAME_LOG_H
+
+#include "../common/types.h"
+#include "../game/board.h"
+#include "pseudo_table.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Game IDs are assigned in order from 1 and never reused */
+typedef uint64_t game_log_id_t;
+#define GAME_LOG_ID_NONE 0
+
+/* A segment is closed once it reaches this size */
+#define GAME_LOG_SEGMENT_SIZE (64u << 20)
+#define GAME_LOG_MAX_SEGMENTS 4096
+
+/* GAME records: a board is kept every this many moves, and longer games
+ * stay as START/MOVE records */
+#define GAME_LOG_SNAPSHOT_INTERVAL 64
+#define GAME_LOG_MAX_HISTORY 4096
+
+/* When appended records are synced to disk */
+typedef enum {
+    GAME_LOG_SYNC_EVERY,        /* Appends return once synced; concurrent ones share an fdatasync */
+    GAME_LOG_SYNC_INTERVAL,     /* Synced every interval; a crash loses at most that window */
+    GAME_LOG_SYNC_NONE          /* Left to the OS until the log is flushed or closed */
+} game_log_sync_t;
+
+#define GAME_LOG_SYNC_INTERVAL_DEFAULT_MS 50
+
+/* How often the background compactor looks for sealed segments */
+#define GAME_LOG_COMPACT_INTERVAL_DEFAULT_MS 30000
+
+/* A game read back from the log */
+typedef struct {
+    game_log_id_t id;
+    char label[MAX_GAME_ID_LEN];
+    pseudo_id_t player_a;
+    pseudo_id_t player_b;
+    board_t board;
+    uint32_t moves;             /* Played; for game_log_load_at, up to the board */
+} game_log_game_t;
+
+/* A game as listed: index fields plus the label from its START record */
+typedef struct {
+    game_log_id_t id;
+    char label[MAX_GAME_ID_LEN];
+    pseudo_id_t player_a;
+    pseudo_id_t player_b;
+    time_t created_at;
+    game_state_t state;
+    winner_t winner;
+    uint32_t moves;
+} game_log_info_t;
+
+typedef struct {
+    uint64_t games;             /* Stored, not counting deleted ones */
+    uint32_t segments;
+    uint64_t bytes;             /* Across all segments */
+    uint64_t appends;           /* Records appended since opened */
+    uint64_t queued;            /* Bytes appended but not yet written */
+    uint64_t writes;            /* pwritev calls by the writer */
+    uint64_t commits;           /* fdatasync rounds */
+    uint64_t file_reads;        /* Records read with pread; sealed segments are mapped instead */
+    uint32_t scan_ms;           /* Rebuilding the index when last opened */
+    uint32_t archives;          /* Segments compacted into archives */
+    uint64_t compactions;       /* Segments compacted since opened... */
+    uint64_t compacted_bytes;   /* ... their size... */
+    uint64_t archived_bytes;    /* ... the size of their archives... */
+    uint64_t compact_ms;        /* ... and the time it took */
+} game_log_stats_t;
+
+/* Open (creating if needed) the log in `dir` and rebuild the index. A torn
+ * record at the end of the last segment is cut off. Reopening closes the
+ * current log first. */
+error_code_t game_log_open(const char* dir);
+/* Threads reading segments while the index is rebuilt (at most 8); 0, the
+ * default, is one per online CPU. Takes effect on the next open. */
+void game_log_set_scan_threads(int threads);
+/* Writes out and syncs everything appended, then closes */
+void game_log_close(void);
+/* Milliseconds between background compaction passes; 0 turns them off.
+ * Takes effect on the next open. */
+void game_log_set_compaction(int interval_ms);
+
+/* Takes effect for the next append; interval_ms only for GAME_LOG_SYNC_INTERVAL */
+void game_log_set_sync(game_log_sync_t policy, int interval_ms);
+/* "every", "none", or an interval in milliseconds */
+error_code_t game_log_parse_sync(const char* text, game_log_sync_t* policy, int* interval_ms);
+const char* game_log_sync_name(game_log_sync_t policy);
+
+/* Wait until everything appended so far is written and synced, whatever
+ * the policy. ERR_NETWORK_ERROR if the writer failed. */
+error_code_t game_log_flush(void);
+
+/* START record; *id_out gets the new game's ID */
+error_code_t game_log_start(pseudo_id_t player_a, pseudo_id_t player_b, const char* label,
+                            time_t created_at, game_log_id_t* id_out);
+/* MOVE record: the pit played and the board after it */
+error_code_t game_log_append_move(game_log_id_t id, int pit_index, const board_t* after);
+/* SNAPSHOT record: the whole board */
+error_code_t game_log_append_snapshot(game_log_id_t id, const board_t* board);
+/* The game is dropped from the index; its records go when compacted */
+error_code_t game_log_delete(game_log_id_t id);
+
+/* GAME record for a game that has ended: `moves` are the pits played, in
+ * order, and `final` the board after them. ERR_MAX_CAPACITY past
+ * GAME_LOG_MAX_HISTORY moves; the game stays readable as it was. */
+error_code_t game_log_finish(game_log_id_t id, const char* label, const uint8_t* moves, uint32_t count,
+                             const board_t* final);
+/* GAME record for a game with no history in the log, such as one converted
+ * from an older format; only its final board is kept */
+error_code_t game_log_import(const game_log_game_t* game, game_log_id_t* id_out);
+
+/* ERR_GAME_NOT_FOUND for unknown or deleted games, ERR_SERIALIZATION if a
+ * record fails its CRC or a move does not replay */
+error_code_t game_log_load(game_log_id_t id, game_log_game_t* game);
+/* The board after the first `move` moves; ERR_INVALID_PARAM past the end
+ * or for a game whose history was not kept */
+error_code_t game_log_load_at(game_log_id_t id, uint32_t move, game_log_game_t* game);
+/* Pits played, in order; *count is 0 for a game whose history was not kept.
+ * ERR_MAX_CAPACITY if there are more than `max`. */
+error_code_t game_log_history(game_log_id_t id, uint8_t* moves, uint32_t max, uint32_t* count);
+
+/* Up to `max` games with ID >= from, in ID order; a `player` other than
+ * PSEUDO_ID_NONE keeps only their games. *next is the ID to resume from,
+ * or GAME_LOG_ID_NONE once exhausted. */
+error_code_t game_log_scan(game_log_id_t from, pseudo_id_t player, game_log_info_t* out, int max,
+                           int* count, game_log_id_t* next);
+
+/* The `max` most recent games still in progress, oldest first, from the
+ * index alone; *total counts all of them */
+error_code_t game_log_list_active(game_log_id_t* ids, int max, int* count, uint64_t* total);
+
+/* One compaction pass now: archive every sealed segment that can be */
+error_code_t game_log_compact(void);
+/* Seal the active segment and start the next one */
+error_code_t game_log_rotate(void);
+
+void game_log_get_stats(game_log_stats_t* stats);
+
+#endif /* GAME_LOG_H */
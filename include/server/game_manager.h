@@ -4,6 +4,8 @@
 #include "../common/types.h"
 #include "../common/messages.h"
 #include "../game/board.h"
+#include "pseudo_table.h"
+#include "game_log.h"
 #include <pthread.h>
 
 #define MAX_GAMES 100
@@ -11,14 +13,21 @@
 /* Game instance */
 #define MAX_SPECTATORS_PER_GAME 50
 typedef struct {
-    char game_id[MAX_GAME_ID_LEN];
-    char player_a[MAX_PSEUDO_LEN];
-    char player_b[MAX_PSEUDO_LEN];
+    game_handle_t handle;       /* GAME_HANDLE_NONE unless live in the manager */
+    uint32_t generation;        /* Bumped each time the slot is reused */
+    char game_id[MAX_GAME_ID_LEN];  /* Label, for display */
+    game_log_id_t log_id;       /* GAME_LOG_ID_NONE until storage_start_game */
+    pseudo_id_t player_a;
+    pseudo_id_t player_b;
     board_t board;
+    uint32_t move_seq;          /* Incremented on every accepted move */
+    uint8_t* moves;             /* Pits played, for the game's GAME record */
+    uint32_t moves_kept;        /* Less than move_seq if the buffer could not grow */
+    uint32_t moves_capacity;    /* Kept across games in the slot */
     bool active;
     pthread_mutex_t lock;
     /* Spectator tracking */
-    char spectators[MAX_SPECTATORS_PER_GAME][MAX_PSEUDO_LEN];
+    pseudo_id_t spectators[MAX_SPECTATORS_PER_GAME];
     int spectator_count;
 } game_instance_t;
 
@@ -34,33 +43,48 @@ error_code_t game_manager_init(game_manager_t* manager);
 error_code_t game_manager_destroy(game_manager_t* manager);
 
 /* Game creation and destruction */
-error_code_t game_manager_create_game(game_manager_t* manager, const char* player_a, 
-                                     const char* player_b, char* game_id_out);
-error_code_t game_manager_remove_game(game_manager_t* manager, const char* game_id);
+/* handle_out and label_out (MAX_GAME_ID_LEN) may be NULL */
+error_code_t game_manager_create_game(game_manager_t* manager, pseudo_id_t player_a,
+                                     pseudo_id_t player_b, game_handle_t* handle_out, char* label_out);
+/* A game read back from the game log, in progress, with a new handle. A
+ * history shorter than saved->moves is not kept. */
+error_code_t game_manager_restore_game(game_manager_t* manager, const game_log_game_t* saved,
+                                       const uint8_t* moves, uint32_t moves_kept, game_handle_t* handle_out);
+error_code_t game_manager_remove_game(game_manager_t* manager, game_handle_t game);
 
-/* Game lookup */
-game_instance_t* game_manager_find_game(game_manager_t* manager, const char* game_id);
-game_instance_t* game_manager_find_game_by_players(game_manager_t* manager, 
-                                                   const char* player_a, const char* player_b);
+/* Game lookup: a handle indexes its slot directly; NULL once the game
+ * ended, even if the slot holds a newer one */
+game_instance_t* game_manager_find_game(game_manager_t* manager, game_handle_t game);
+game_instance_t* game_manager_find_game_by_players(game_manager_t* manager,
+                                                   pseudo_id_t player_a, pseudo_id_t player_b);
 
 /* Game operations */
-error_code_t game_manager_play_move(game_manager_t* manager, const char* game_id, 
-                                   const char* player, int pit_index, int* seeds_captured);
-error_code_t game_manager_get_board(game_manager_t* manager, const char* game_id, board_t* board_out);
+error_code_t game_manager_play_move(game_manager_t* manager, game_handle_t game, 
+                                   pseudo_id_t player, int pit_index, int* seeds_captured,
+                                   msg_board_delta_t* delta_out);
+error_code_t game_manager_get_keyframe(game_manager_t* manager, game_handle_t game,
+                                       msg_board_delta_t* delta_out);
+error_code_t game_manager_get_board(game_manager_t* manager, game_handle_t game, board_t* board_out);
 
 /* Game queries */
 int game_manager_count_active_games(game_manager_t* manager);
-int game_manager_count_player_games(game_manager_t* manager, const char* player);
-bool game_manager_is_player_in_game(game_manager_t* manager, const char* player);
+bool game_manager_is_player_in_game(game_manager_t* manager, pseudo_id_t player);
 int game_manager_get_active_games(game_manager_t* manager, game_info_t* games_out, int max_games);
-int game_manager_get_player_games(game_manager_t* manager, const char* player, game_info_t* games_out, int max_games);
+int game_manager_get_player_games(game_manager_t* manager, pseudo_id_t player, game_info_t* games_out, int max_games);
+
+/* Paged listing from game slot `cursor` on (0 to start), only games
+ * `player` is in unless it is PSEUDO_ID_NONE; *next_cursor is 0 once
+ * exhausted */
+error_code_t game_manager_list_games(game_manager_t* manager, pseudo_id_t player, uint32_t cursor,
+                                     game_info_t* games_out, int max_games,
+                                     int* count, uint32_t* next_cursor);
 
 /* Spectator management */
-error_code_t game_manager_add_spectator(game_manager_t* manager, const char* game_id, const char* spectator);
-error_code_t game_manager_remove_spectator(game_manager_t* manager, const char* game_id, const char* spectator);
-int game_manager_get_spectator_count(game_manager_t* manager, const char* game_id);
+error_code_t game_manager_add_spectator(game_manager_t* manager, game_handle_t game, pseudo_id_t spectator);
+error_code_t game_manager_remove_spectator(game_manager_t* manager, game_handle_t game, pseudo_id_t spectator);
+int game_manager_get_spectator_count(game_manager_t* manager, game_handle_t game);
 
-/* Game ID generation */
-void game_manager_generate_id(const char* player_a, const char* player_b, char* game_id);
+/* Display label ("a-vs-b"); not unique, never used for lookup */
+void game_manager_generate_label(const char* player_a, const char* player_b, char* label);
 
 #endif /* GAME_MANAGER_H */
@@ -2,6 +2,8 @@
 #define MATCHMAKING_H
 
 #include "../common/types.h"
+#include "../common/messages.h"
+#include "pseudo_table.h"
 #include <pthread.h>
 
 #define MAX_CHALLENGES 100
@@ -10,23 +12,39 @@
 /* Challenge structure */
 typedef struct {
     int64_t challenge_id;
-    char challenger[MAX_PSEUDO_LEN];
-    char opponent[MAX_PSEUDO_LEN];
+    pseudo_id_t challenger;
+    pseudo_id_t opponent;
     time_t created_at;
     bool active;
 } challenge_t;
 
-/* Player registry entry */
+/* Player registry entry: the hot part of a player, all that logins, rosters
+ * and stats read. 100 of them fit in two pages. */
 typedef struct {
-    player_info_t info;
+    pseudo_id_t id;
+    char ip[MAX_IP_LEN];
     bool connected;
+    int games_played;
+    int games_won;
+    int games_lost;
+    int total_score;
 } player_entry_t;
 
+/* The cold part: bio and friends (~2.8 KB). Loaded from the player's file
+ * the first time it is needed; NULL in matchmaking_t until then. */
+typedef struct {
+    char bio[10][256];
+    int bio_lines;
+    pseudo_id_t friends[MAX_FRIENDS];
+    int friend_count;
+} player_profile_t;
+
 /* Matchmaking manager */
 typedef struct {
     challenge_t challenges[MAX_CHALLENGES];
     int challenge_count;
     player_entry_t players[MAX_PLAYERS];
+    player_profile_t* profiles[MAX_PLAYERS];   /* Same index as players */
     int player_count;
     pthread_mutex_t lock;
     /* Rate limiting: last challenge time from challenger[i] to opponent[j] */
@@ -41,44 +59,59 @@ typedef struct {
 error_code_t matchmaking_init(matchmaking_t* mm);
 error_code_t matchmaking_destroy(matchmaking_t* mm);
 
-/* Player management */
-error_code_t matchmaking_add_player(matchmaking_t* mm, const char* pseudo, const char* ip);
-error_code_t matchmaking_remove_player(matchmaking_t* mm, const char* pseudo);
-error_code_t matchmaking_get_players(matchmaking_t* mm, player_info_t* players, int max_players, int* count);
-bool matchmaking_player_exists(matchmaking_t* mm, const char* pseudo);
+/* Player management. Adding a player who is already connected fails with
+ * ERR_DUPLICATE, so of two concurrent logins with one pseudo only one wins. */
+error_code_t matchmaking_add_player(matchmaking_t* mm, pseudo_id_t player, const char* ip);
+error_code_t matchmaking_remove_player(matchmaking_t* mm, pseudo_id_t player);
+bool matchmaking_player_exists(matchmaking_t* mm, pseudo_id_t player);
+bool matchmaking_player_connected(matchmaking_t* mm, pseudo_id_t player);
+/* Whether a player not seen before can still be added */
+bool matchmaking_has_room(matchmaking_t* mm);
+
+/* Paged listings: up to max_items entries from `cursor` on (0 to start);
+ * *next_cursor is where the next page resumes, 0 once exhausted */
+error_code_t matchmaking_list_players(matchmaking_t* mm, uint32_t cursor, player_list_item_t* items,
+                                      int max_items, int* count, uint32_t* next_cursor);
+error_code_t matchmaking_list_challengers(matchmaking_t* mm, pseudo_id_t opponent, uint32_t cursor,
+                                          char challengers[][MAX_PSEUDO_LEN], int max_items,
+                                          int* count, uint32_t* next_cursor);
+error_code_t matchmaking_list_friends(matchmaking_t* mm, pseudo_id_t player, uint32_t cursor,
+                                      char friends[][MAX_PSEUDO_LEN], int max_items,
+                                      int* count, uint32_t* next_cursor);
 
 /* Challenge management */
-error_code_t matchmaking_create_challenge(matchmaking_t* mm, const char* challenger,
-                                         const char* opponent, bool* mutual_found);
-error_code_t matchmaking_create_challenge_with_id(matchmaking_t* mm, const char* challenger,
-                                                  const char* opponent, int64_t* challenge_id, bool* is_new);
-error_code_t matchmaking_remove_challenge(matchmaking_t* mm, const char* challenger, const char* opponent);
+error_code_t matchmaking_create_challenge(matchmaking_t* mm, pseudo_id_t challenger,
+                                         pseudo_id_t opponent, bool* mutual_found);
+error_code_t matchmaking_create_challenge_with_id(matchmaking_t* mm, pseudo_id_t challenger,
+                                                  pseudo_id_t opponent, int64_t* challenge_id, bool* is_new);
+error_code_t matchmaking_remove_challenge(matchmaking_t* mm, pseudo_id_t challenger, pseudo_id_t opponent);
 error_code_t matchmaking_remove_challenge_by_id(matchmaking_t* mm, int64_t challenge_id);
 error_code_t matchmaking_find_challenge_by_id(matchmaking_t* mm, int64_t challenge_id, challenge_t** challenge);
-error_code_t matchmaking_get_challenges_for(matchmaking_t* mm, const char* player,
+error_code_t matchmaking_get_challenges_for(matchmaking_t* mm, pseudo_id_t player,
                                            char challengers[][MAX_PSEUDO_LEN], int max_count, int* count);
-bool matchmaking_has_mutual_challenge(matchmaking_t* mm, const char* player_a, const char* player_b);
+bool matchmaking_has_mutual_challenge(matchmaking_t* mm, pseudo_id_t player_a, pseudo_id_t player_b);
 
 /* Challenge queries */
 int matchmaking_count_challenges(matchmaking_t* mm);
-int matchmaking_count_challenges_for(matchmaking_t* mm, const char* player);
+int matchmaking_count_challenges_for(matchmaking_t* mm, pseudo_id_t player);
 
 /* Player statistics management */
-error_code_t matchmaking_update_player_stats(matchmaking_t* mm, const char* pseudo,
+error_code_t matchmaking_update_player_stats(matchmaking_t* mm, pseudo_id_t player,
                                              bool game_won, int score_earned);
-error_code_t matchmaking_get_player_stats(matchmaking_t* mm, const char* pseudo,
-                                          player_info_t* info_out);
+error_code_t matchmaking_get_player_stats(matchmaking_t* mm, pseudo_id_t player,
+                                          player_entry_t* entry_out);
 
 /* Utility functions */
-int matchmaking_get_player_index(matchmaking_t* mm, const char* pseudo);
+int matchmaking_get_player_index(matchmaking_t* mm, pseudo_id_t player);
 
-/* Update player's bio lines */
-error_code_t matchmaking_set_player_bio(matchmaking_t* mm, const char* pseudo, const char bio[][256], int lines);
+/* Player's bio lines (at most 10) */
+error_code_t matchmaking_set_player_bio(matchmaking_t* mm, pseudo_id_t player, const char bio[][256], int lines);
+error_code_t matchmaking_get_player_bio(matchmaking_t* mm, pseudo_id_t player, char bio[][256], int* lines);
 
 /* Friend management */
-error_code_t matchmaking_add_friend(matchmaking_t* mm, const char* pseudo, const char* friend_pseudo);
-error_code_t matchmaking_remove_friend(matchmaking_t* mm, const char* pseudo, const char* friend_pseudo);
-bool matchmaking_are_friends(matchmaking_t* mm, const char* pseudo1, const char* pseudo2);
+error_code_t matchmaking_add_friend(matchmaking_t* mm, pseudo_id_t player, pseudo_id_t friend_id);
+error_code_t matchmaking_remove_friend(matchmaking_t* mm, pseudo_id_t player, pseudo_id_t friend_id);
+bool matchmaking_are_friends(matchmaking_t* mm, pseudo_id_t player1, pseudo_id_t player2);
 
 /* Cleanup */
 void matchmaking_cleanup_old_challenges(matchmaking_t* mm, int max_age_seconds);
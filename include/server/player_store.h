@@ -0,0 +1,56 @@
+/* Player Store
+ * All player records in one file of fixed-size slots, one slot per player,
+ * in the order players were first stored. Each slot holds two page-aligned
+ * copies of the record with a sequence number: a write goes to the older
+ * copy, so a crash mid-write leaves the newer one intact, and opening picks
+ * the newest copy that passes its CRC.
+ *
+ * Storing a record only copies it and marks the slot dirty; a flusher
+ * thread writes the dirty slots every flush interval with one fdatasync for
+ * all of them. The file is mapped once when opened and records are read
+ * from the mapping.
+ */
+
+#ifndef PLAYER_STORE_H
+#define PLAYER_STORE_H
+
+#include "../common/types.h"
+#include "pseudo_table.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define PLAYER_STORE_PAGE_SIZE 4096
+#define PLAYER_STORE_FLUSH_INTERVAL_DEFAULT_MS 200
+
+typedef struct {
+    uint32_t records;           /* Stored players */
+    uint32_t dirty;             /* Not yet written */
+    uint64_t puts;
+    uint64_t written;           /* Records written by flushes */
+    uint64_t syncs;             /* fdatasync rounds */
+} player_store_stats_t;
+
+/* Open (creating if needed) the store at `path` for records of
+ * `record_size` bytes and start the flusher; *created tells whether the
+ * file is new. ERR_SERIALIZATION if the file holds another record size. */
+error_code_t player_store_open(const char* path, size_t record_size, bool* created);
+/* Writes out the dirty records, then closes */
+void player_store_close(void);
+
+/* Takes effect from the flusher's next wait */
+void player_store_set_flush_interval(int interval_ms);
+
+/* ERR_PLAYER_NOT_FOUND if `player` was never stored */
+error_code_t player_store_get(pseudo_id_t player, void* record);
+/* Copy the record in; it reaches the disk with the next flush */
+error_code_t player_store_put(pseudo_id_t player, const void* record);
+/* Write out and sync every record stored so far */
+error_code_t player_store_flush(void);
+
+/* Calls `visit` for each stored player in slot order, under the store
+ * lock; `record` is only valid during the call */
+error_code_t player_store_each(void (*visit)(pseudo_id_t player, const void* record, void* arg), void* arg);
+
+void player_store_get_stats(player_store_stats_t* stats);
+
+#endif /* PLAYER_STORE_H */
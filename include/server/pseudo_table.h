@@ -0,0 +1,31 @@
+/* Pseudo Table
+ * Interns each pseudo into a 32-bit ID that stays valid for the life of the
+ * server. Games, challenges, spectators, friend lists and the session
+ * registry store and compare IDs; pseudos are looked up only where they
+ * cross the protocol or storage boundary.
+ */
+
+#ifndef PSEUDO_TABLE_H
+#define PSEUDO_TABLE_H
+
+#include "../common/types.h"
+#include <stdint.h>
+
+typedef uint32_t pseudo_id_t;
+
+/* Never assigned; the "no player" value */
+#define PSEUDO_ID_NONE 0
+
+/* ID of `pseudo`, assigning one on first sight. PSEUDO_ID_NONE for an empty
+ * pseudo or if the table is full. */
+pseudo_id_t pseudo_intern(const char* pseudo);
+
+/* ID of `pseudo` if it was ever interned, else PSEUDO_ID_NONE. Use for
+ * names from the wire, so unknown names do not grow the table. */
+pseudo_id_t pseudo_lookup(const char* pseudo);
+
+/* The pseudo behind an ID; "" for PSEUDO_ID_NONE or an unknown ID. The
+ * string never moves or changes. */
+const char* pseudo_name(pseudo_id_t id);
+
+#endif /* PSEUDO_TABLE_H */
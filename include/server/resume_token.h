@@ -0,0 +1,27 @@
+/* Resumption Tokens
+ * The session id a client gets in MSG_CONNECT_ACK is also what it presents
+ * in MSG_RESUME: a random nonce and a SipHash-2-4 MAC of pseudo and nonce,
+ * keyed with a secret drawn when the server starts. A forged token fails
+ * verification without touching the session registry; a token from before
+ * a restart fails because the key changed.
+ */
+
+#ifndef RESUME_TOKEN_H
+#define RESUME_TOKEN_H
+
+#include "../common/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* 16 hex digits of nonce, 16 of MAC */
+#define RESUME_TOKEN_LEN 32
+
+/* token_size must be more than RESUME_TOKEN_LEN */
+error_code_t resume_token_issue(const char* pseudo, char* token, size_t token_size);
+bool resume_token_verify(const char* pseudo, const char* token);
+
+/* SipHash-2-4 of data under a 128-bit key */
+uint64_t siphash24(const uint8_t key[16], const void* data, size_t size);
+
+#endif /* RESUME_TOKEN_H */
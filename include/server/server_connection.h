@@ -12,6 +12,17 @@
 #include <pthread.h>
 #include <stdbool.h>
 
+/* Client handler structure: one per authenticated client, owned (and
+ * freed) by its client_handler thread */
+typedef struct {
+    connection_t conn;
+    char pseudo[MAX_PSEUDO_LEN];
+    char session_id[64];        /* Resumption token sent in the connect ack */
+    uint8_t codec;
+    uint32_t features;
+    pthread_t thread;
+} client_handler_t;
+
 /* Initialize connection manager with global managers and running flag */
 void connection_manager_init(game_manager_t* game_mgr, matchmaking_t* matchmaking, 
                              volatile bool* running_flag, int discovery_port);
@@ -22,7 +33,10 @@ void connection_manager_init(game_manager_t* game_mgr, matchmaking_t* matchmakin
 void* udp_discovery_thread(void* arg);
 
 /* Client handler thread function
- * Processes messages from a connected client
+ * Processes messages from a connected client. Takes a malloc'd
+ * client_handler_t; the connection can use any transport. If the connection
+ * drops, the session is held for RESUME_GRACE_SEC in case the client
+ * resumes it; MSG_DISCONNECT ends it at once.
  */
 void* client_handler(void* arg);
 
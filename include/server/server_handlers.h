@@ -40,6 +40,9 @@ void handle_play_move(session_t* session, const msg_play_move_t* move);
 /* Handle MSG_GET_BOARD - Retrieve board state for a game */
 void handle_get_board(session_t* session, const msg_get_board_t* req);
 
+/* Handle MSG_BOARD_RESYNC - Send a keyframe after a client-side sequence gap */
+void handle_board_resync(session_t* session, const msg_board_resync_t* req);
+
 /* Handle MSG_LIST_GAMES - Get list of active games */
 void handle_list_games(session_t* session);
 
@@ -47,10 +50,10 @@ void handle_list_games(session_t* session);
 void handle_list_my_games(session_t* session);
 
 /* Handle MSG_SPECTATE_GAME - Join as spectator for a game */
-void handle_spectate_game(session_t* session, const char* game_id);
+void handle_spectate_game(session_t* session, game_handle_t game);
 
 /* Handle MSG_STOP_SPECTATE - Stop spectating a game */
-void handle_stop_spectate(session_t* session, const char* game_id);
+void handle_stop_spectate(session_t* session, game_handle_t game);
 
 /* Handle MSG_SET_BIO - Set player bio */
 void handle_set_bio(session_t* session, const msg_set_bio_t* bio);
@@ -79,4 +82,8 @@ void handle_list_saved_games(session_t* session, const msg_list_saved_games_t* r
 /* Handle MSG_VIEW_SAVED_GAME - View a saved game */
 void handle_view_saved_game(session_t* session, const msg_view_saved_game_t* req);
 
+/* Handle MSG_LIST_PAGE - One page, or with LIST_FLAG_STREAM every remaining
+ * page, of any list, closed by MSG_LIST_END */
+void handle_list_page(session_t* session, const msg_list_page_t* req);
+
 #endif /* SERVER_HANDLERS_H */
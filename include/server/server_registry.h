@@ -1,13 +1,18 @@
 /* Session Registry - Thread-safe registry for active client sessions
- * Used for push notifications and session lookup by pseudo
+ * Used for push notifications and session lookup by pseudo, and to hand a
+ * resumed connection to the session it belongs to
  */
 
 #ifndef SERVER_REGISTRY_H
 #define SERVER_REGISTRY_H
 
 #include "../network/session.h"
+#include "pseudo_table.h"
 #include <stdbool.h>
 
+/* How long a session whose connection dropped waits to be resumed */
+#define RESUME_GRACE_SEC 30
+
 /* Initialize the session registry */
 void session_registry_init(void);
 
@@ -19,9 +24,28 @@ bool session_registry_add(session_t* session);
 /* Remove a session from the registry */
 void session_registry_remove(session_t* session);
 
-/* Find a session by pseudo (player name)
+/* Find a session by its player's interned pseudo
  * Returns the session pointer if found, NULL otherwise
  */
-session_t* session_registry_find(const char* pseudo);
+session_t* session_registry_find(pseudo_id_t player);
+
+/* Called by a session's handler once its connection dropped. Waits up to
+ * grace_sec for session_registry_resume to hand over a new connection, and
+ * resumes onto it (session_resume). Returns false once the window closed or
+ * a fresh login replaced the session; it is then no longer registered and
+ * cannot be resumed. */
+bool session_registry_await_resume(session_t* session, int grace_sec);
+
+/* A fresh MSG_CONNECT for a player whose dropped session is still held:
+ * release that session so the new login can take the player over. Its
+ * handler wakes from session_registry_await_resume with false and a
+ * player_id of PSEUDO_ID_NONE. Returns false if no session was detached. */
+bool session_registry_replace_detached(pseudo_id_t player);
+
+/* Hand `conn` (which carried msg) to the session it resumes. The token must
+ * verify and match the session's id. On SUCCESS the session owns the
+ * connection; otherwise the caller still does. If the handler has not yet
+ * noticed the old connection is gone, it is shut down to wake it. */
+error_code_t session_registry_resume(const msg_resume_t* msg, connection_t* conn);
 
 #endif /* SERVER_REGISTRY_H */
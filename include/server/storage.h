@@ -7,26 +7,62 @@
 
 /* Storage paths */
 #define STORAGE_DIR "./data"
-#define GAMES_FILE "./data/games.dat"
-#define PLAYERS_FILE "./data/players.dat"
+#define GAMES_LOG_DIR "./data/games"
+#define GAMES_FILE "./data/games.dat"       /* Fixed-size records from before the game log; only read to convert them */
+#define PLAYERS_FILE "./data/players.db"          /* Player store (player_store.h) */
 
-/* Storage operations */
+/* Storage operations: init opens the player store (player_store.h) and the
+ * game log (game_log.h), cleanup closes them */
 error_code_t storage_init(void);
 error_code_t storage_cleanup(void);
 
-/* Game persistence */
-error_code_t storage_save_game(const game_instance_t* game);
-error_code_t storage_load_game(const char* game_id, game_instance_t* game);
-error_code_t storage_delete_game(const char* game_id);
-error_code_t storage_load_all_games(game_manager_t* manager);
+/* Game persistence. A game is started in the log once, then each move
+ * appends a few bytes. storage_save_game records the whole board, starting
+ * the game first if needed. Records reach the disk from the log's writer
+ * thread under its sync policy; storage_flush_games waits for all of them. */
+error_code_t storage_start_game(game_instance_t* game);
+error_code_t storage_record_move(const game_instance_t* game, int pit_index);
+/* Compact GAME record of a game that has ended, from its kept moves */
+error_code_t storage_finish_game(const game_instance_t* game);
+error_code_t storage_save_game(game_instance_t* game);
+error_code_t storage_load_game(const char* key, game_instance_t* game);
+error_code_t storage_delete_game(const char* key);
+/* Startup recovery: put the games the log holds as still in progress back
+ * in the manager, the most recent first if there are more than it has room
+ * for. Games that do not replay, or whose players are already in a game,
+ * are left in the log and counted in *skipped. */
+error_code_t storage_load_all_games(game_manager_t* manager, int* restored, int* skipped);
+error_code_t storage_flush_games(void);
+
+/* Import the fixed-size records of an old GAMES_FILE into the game log as
+ * GAME records and wait until they are synced. Records failing their
+ * version or CRC check are skipped. Only final boards were kept in that
+ * format, so the converted games have no move history. */
+error_code_t storage_convert_legacy_games(const char* path, int* converted, int* skipped);
+
+/* A saved game's key, "<label>#<log id>": labels repeat, log IDs do not */
+void storage_game_key(const char* label, game_log_id_t log_id, char key[MAX_GAME_ID_LEN]);
 
 /* Saved games for review */
 error_code_t storage_list_saved_games(int* count, char game_ids[][MAX_GAME_ID_LEN], int max_games);
-error_code_t storage_load_saved_game(const char* game_id, game_instance_t* game);
+error_code_t storage_load_saved_game(const char* key, game_instance_t* game);
+
+/* Paged listing of saved games; the cursor is a game log ID (0 to start),
+ * *next_cursor is 0 once exhausted. An optional `player` keeps only the
+ * games they played in. */
+error_code_t storage_list_saved_games_page(const char* player, game_log_id_t cursor, game_info_t* games_out,
+                                           int max_games, int* count, game_log_id_t* next_cursor);
 
-/* Player persistence */
+/* Player persistence: one record per player in the player store. Saving
+ * only marks the record dirty; the store's flusher writes changed records
+ * together, and storage_flush_players waits for them. Loading reads only the
+ * hot records into mm; a profile is read with storage_load_player_profile.
+ * A new store imports the player_<pseudo>.dat files from before it. */
+error_code_t storage_save_player(const matchmaking_t* mm, int index);
 error_code_t storage_save_players(const matchmaking_t* mm);
+error_code_t storage_flush_players(void);
 error_code_t storage_load_players(matchmaking_t* mm);
+error_code_t storage_load_player_profile(const char* pseudo, player_profile_t* profile);
 
 /* Utility functions */
 bool storage_directory_exists(const char* path);
@@ -16,13 +16,18 @@
 #include <string.h>
 #include <stdlib.h>
 
-/* List connected players */
+/* List connected players - streamed a frame at a time, so the lobby size
+ * is not bounded by one message */
 void cmd_list_players(void) {
-    session_t* session = client_state_get_session();
-
     client_log_info(CLIENT_LOG_LISTING_PLAYERS);
 
-    error_code_t err = session_send_message(session, MSG_LIST_PLAYERS, NULL, 0);
+    msg_list_page_t req;
+    memset(&req, 0, sizeof(req));
+    req.list_type = MSG_LIST_PLAYERS;
+    req.flags = LIST_FLAG_STREAM;
+
+    uint32_t seq;
+    error_code_t err = client_request_send_list(&req, &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_ERROR_SENDING_REQUEST, error_to_string(err));
         return;
@@ -30,25 +35,33 @@ void cmd_list_players(void) {
     message_type_t type;
     msg_player_list_t* list = calloc(1, sizeof(msg_player_list_t));
     if (!list) {
+        response_mailbox_cancel(seq);
         client_log_error("Memory allocation failed");
         return;
     }
     size_t size;
+    int shown = 0;
+
+    printf(CLIENT_UI_PLAYER_LIST_STREAM_HEADER);
+    printf(CLIENT_UI_PLAYER_LIST_SEPARATOR);
+    for (;;) {
+        err = client_request_wait(seq, &type, list, sizeof(*list), &size, 10000);
+        if (err == ERR_TIMEOUT) {
+            client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
+            break;
+        }
+        if (err != SUCCESS || (type != MSG_PLAYER_LIST && type != MSG_LIST_END)) {
+            client_log_error(CLIENT_LOG_ERROR_RECEIVING_RESPONSE);
+            response_mailbox_cancel(seq);
+            break;
+        }
+        if (type == MSG_LIST_END) break;
 
-    err = session_recv_message_timeout(session, &type, list, sizeof(*list), &size, 10000, NULL, 0);
-    if (err == ERR_TIMEOUT) {
-        client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
-        free(list);
-        return;
+        ui_display_player_list_page(list, shown + 1);
+        shown += list->count;
     }
-    if (err != SUCCESS || type != MSG_PLAYER_LIST) {
-        client_log_error(CLIENT_LOG_ERROR_RECEIVING_RESPONSE);
-        free(list);
-        return;
-    }
-
-    printf("Received player list with %d players\n", list->count);
-    ui_display_player_list(list);
+    printf(CLIENT_UI_PLAYER_LIST_FOOTER);
+    printf(CLIENT_UI_PLAYER_LIST_TOTAL, shown);
     free(list);
 }
 
@@ -83,19 +96,19 @@ __attribute__((unused)) void cmd_challenge_player(void)
     snprintf(challenge.challenger, MAX_PSEUDO_LEN, "%s", my_pseudo);
     snprintf(challenge.opponent, MAX_PSEUDO_LEN, "%s", opponent);
     
-    error_code_t err = session_send_message(session, MSG_CHALLENGE, &challenge, sizeof(challenge));
+    uint32_t seq;
+    error_code_t err = client_request_send(MSG_CHALLENGE, &challenge, sizeof(challenge), &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_ERROR_SENDING_CHALLENGE, error_to_string(err));
         return;
     }
     
     /* Wait for acknowledgment */
-    message_type_t expected[] = {MSG_CHALLENGE_SENT, MSG_ERROR};
     message_type_t type;
     char response[MAX_MESSAGE_SIZE];
     size_t size;
 
-    err = session_recv_message_timeout(session, &type, response, MAX_MESSAGE_SIZE, &size, 5000, expected, 2);
+    err = client_request_wait(seq, &type, response, MAX_MESSAGE_SIZE, &size, 5000);
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
         return;
@@ -175,8 +188,6 @@ __attribute__((unused)) void cmd_view_challenges(void)
 /* Set player bio */
 __attribute__((unused)) void cmd_set_bio(void)
 {
-    session_t* session = client_state_get_session();
-    
     msg_set_bio_t bio_msg;
     memset(&bio_msg, 0, sizeof(bio_msg));
     
@@ -187,7 +198,8 @@ __attribute__((unused)) void cmd_set_bio(void)
         return;
     }
     
-    error_code_t err = session_send_message(session, MSG_SET_BIO, &bio_msg, sizeof(bio_msg));
+    uint32_t seq;
+    error_code_t err = client_request_send(MSG_SET_BIO, &bio_msg, sizeof(bio_msg), &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_ERROR_SENDING_BIO, error_to_string(err));
         return;
@@ -197,7 +209,7 @@ __attribute__((unused)) void cmd_set_bio(void)
     char dummy[1];
     size_t size;
 
-    err = session_recv_message_timeout(session, &type, dummy, sizeof(dummy), &size, 5000, NULL, 0);
+    err = client_request_wait(seq, &type, dummy, sizeof(dummy), &size, 5000);
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
         return;
@@ -212,8 +224,6 @@ __attribute__((unused)) void cmd_set_bio(void)
 /* View player bio */
 __attribute__((unused)) void cmd_view_bio(void)
 {
-    session_t* session = client_state_get_session();
-    
     client_log_info(CLIENT_LOG_VIEW_BIO_HEADER);
     client_log_info(CLIENT_LOG_VIEW_BIO_PROMPT);
     
@@ -238,7 +248,8 @@ __attribute__((unused)) void cmd_view_bio(void)
     memset(&bio_req, 0, sizeof(bio_req));
     snprintf(bio_req.target_player, MAX_PSEUDO_LEN, "%s", target_player);
     
-    error_code_t err = session_send_message(session, MSG_GET_BIO, &bio_req, sizeof(bio_req));
+    uint32_t seq;
+    error_code_t err = client_request_send(MSG_GET_BIO, &bio_req, sizeof(bio_req), &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_ERROR_SENDING_REQUEST, error_to_string(err));
         return;
@@ -248,7 +259,7 @@ __attribute__((unused)) void cmd_view_bio(void)
     msg_bio_response_t response;
     size_t size;
 
-    err = session_recv_message_timeout(session, &type, &response, sizeof(response), &size, 5000, NULL, 0);
+    err = client_request_wait(seq, &type, &response, sizeof(response), &size, 5000);
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
         return;
@@ -264,8 +275,6 @@ __attribute__((unused)) void cmd_view_bio(void)
 /* View player statistics */
 __attribute__((unused)) void cmd_view_player_stats(void)
 {
-    session_t* session = client_state_get_session();
-    
     client_log_info(CLIENT_LOG_VIEW_STATS_HEADER);
     client_log_info(CLIENT_LOG_VIEW_STATS_PROMPT);
     
@@ -288,7 +297,8 @@ __attribute__((unused)) void cmd_view_player_stats(void)
     memset(&stats_req, 0, sizeof(stats_req));
     snprintf(stats_req.target_player, MAX_PSEUDO_LEN, "%s", target_player);
     
-    error_code_t err = session_send_message(session, MSG_GET_PLAYER_STATS, &stats_req, sizeof(stats_req));
+    uint32_t seq;
+    error_code_t err = client_request_send(MSG_GET_PLAYER_STATS, &stats_req, sizeof(stats_req), &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_ERROR_SENDING_REQUEST, error_to_string(err));
         return;
@@ -298,7 +308,7 @@ __attribute__((unused)) void cmd_view_player_stats(void)
     msg_player_stats_t response;
     size_t size;
 
-    err = session_recv_message_timeout(session, &type, &response, sizeof(response), &size, 5000, NULL, 0);
+    err = client_request_wait(seq, &type, &response, sizeof(response), &size, 5000);
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
         return;
@@ -394,8 +404,6 @@ __attribute__((unused)) void cmd_chat(void)
 /* Friend management menu */
 __attribute__((unused)) void cmd_friend_management(void)
 {
-    session_t* session = client_state_get_session();
-
     while (client_state_is_running()) {
         ui_display_friend_menu();
 
@@ -422,7 +430,8 @@ __attribute__((unused)) void cmd_friend_management(void)
                 memset(&add_msg, 0, sizeof(add_msg));
                 snprintf(add_msg.friend_pseudo, MAX_PSEUDO_LEN, "%s", friend_name);
 
-                error_code_t err = session_send_message(session, MSG_ADD_FRIEND, &add_msg, sizeof(add_msg));
+                uint32_t seq;
+                error_code_t err = client_request_send(MSG_ADD_FRIEND, &add_msg, sizeof(add_msg), &seq);
                 if (err != SUCCESS) {
                     printf(CLIENT_UI_FRIEND_ADD_ERROR, error_to_string(err));
                     continue;
@@ -431,7 +440,7 @@ __attribute__((unused)) void cmd_friend_management(void)
                 message_type_t type;
                 char response[MAX_MESSAGE_SIZE];
                 size_t size;
-                err = session_recv_message_timeout(session, &type, response, sizeof(response), &size, 5000, NULL, 0);
+                err = client_request_wait(seq, &type, response, sizeof(response), &size, 5000);
                 if (err == SUCCESS && type == MSG_CHALLENGE_SENT) {  /* Reuse ACK message */
                     printf(CLIENT_UI_FRIEND_ADD_SUCCESS, friend_name);
                 } else if (err == SUCCESS && type == MSG_ERROR) {
@@ -457,7 +466,8 @@ __attribute__((unused)) void cmd_friend_management(void)
                 memset(&remove_msg, 0, sizeof(remove_msg));
                 snprintf(remove_msg.friend_pseudo, MAX_PSEUDO_LEN, "%s", friend_name);
 
-                error_code_t err = session_send_message(session, MSG_REMOVE_FRIEND, &remove_msg, sizeof(remove_msg));
+                uint32_t seq;
+                error_code_t err = client_request_send(MSG_REMOVE_FRIEND, &remove_msg, sizeof(remove_msg), &seq);
                 if (err != SUCCESS) {
                     printf(CLIENT_UI_FRIEND_REMOVE_ERROR, error_to_string(err));
                     continue;
@@ -466,7 +476,7 @@ __attribute__((unused)) void cmd_friend_management(void)
                 message_type_t type;
                 char response[MAX_MESSAGE_SIZE];
                 size_t size;
-                err = session_recv_message_timeout(session, &type, response, sizeof(response), &size, 5000, NULL, 0);
+                err = client_request_wait(seq, &type, response, sizeof(response), &size, 5000);
                 if (err == SUCCESS && type == MSG_CHALLENGE_SENT) {  /* Reuse ACK message */
                     printf(CLIENT_UI_FRIEND_REMOVE_SUCCESS, friend_name);
                 } else if (err == SUCCESS && type == MSG_ERROR) {
@@ -479,7 +489,8 @@ __attribute__((unused)) void cmd_friend_management(void)
             }
 
             case 3: {  /* List friends */
-                error_code_t err = session_send_message(session, MSG_LIST_FRIENDS, NULL, 0);
+                uint32_t seq;
+                error_code_t err = client_request_send(MSG_LIST_FRIENDS, NULL, 0, &seq);
                 if (err != SUCCESS) {
                     client_log_error(CLIENT_LOG_ERROR_SENDING_REQUEST, error_to_string(err));
                     continue;
@@ -488,7 +499,7 @@ __attribute__((unused)) void cmd_friend_management(void)
                 message_type_t type;
                 msg_list_friends_t friends;
                 size_t size;
-                err = session_recv_message_timeout(session, &type, &friends, sizeof(friends), &size, 5000, NULL, 0);
+                err = client_request_wait(seq, &type, &friends, sizeof(friends), &size, 5000);
                 if (err == ERR_TIMEOUT) {
                     client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
                     continue;
@@ -514,8 +525,6 @@ __attribute__((unused)) void cmd_friend_management(void)
 
 /* List saved games for review */
 __attribute__((unused)) void cmd_list_saved_games(void) {
-    session_t* session = client_state_get_session();
-
     client_log_info(CLIENT_LOG_LIST_SAVED_GAMES_HEADER);
     client_log_info(CLIENT_LOG_LIST_SAVED_GAMES_PROMPT);
 
@@ -528,13 +537,16 @@ __attribute__((unused)) void cmd_list_saved_games(void) {
     }
 
     /* If empty, list all games */
-    msg_list_saved_games_t req;
+    msg_list_page_t req;
     memset(&req, 0, sizeof(req));
+    req.list_type = MSG_LIST_SAVED_GAMES;
+    req.flags = LIST_FLAG_STREAM;
     if (strlen(player_filter) > 0) {
         snprintf(req.player, MAX_PSEUDO_LEN, "%s", player_filter);
     }
 
-    error_code_t err = session_send_message(session, MSG_LIST_SAVED_GAMES, &req, sizeof(req));
+    uint32_t seq;
+    error_code_t err = client_request_send_list(&req, &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_ERROR_SENDING_REQUEST, error_to_string(err));
         return;
@@ -543,42 +555,45 @@ __attribute__((unused)) void cmd_list_saved_games(void) {
     message_type_t type;
     msg_saved_game_list_t list;
     size_t size;
-
-    err = session_recv_message_timeout(session, &type, &list, sizeof(list), &size, 5000, NULL, 0);
-    if (err == ERR_TIMEOUT) {
-        client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
-        return;
-    }
-    if (err != SUCCESS || type != MSG_SAVED_GAME_LIST) {
-        client_log_error(CLIENT_LOG_ERROR_RECEIVING_RESPONSE);
-        return;
-    }
+    int shown = 0;
 
     /* Display the list - reuse game list UI */
     printf("Saved Games for Review:\n");
-    if (list.count == 0) {
-        printf("No saved games found.\n");
-        return;
+    for (;;) {
+        err = client_request_wait(seq, &type, &list, sizeof(list), &size, 5000);
+        if (err == ERR_TIMEOUT) {
+            client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
+            return;
+        }
+        if (err != SUCCESS || (type != MSG_SAVED_GAME_LIST && type != MSG_LIST_END)) {
+            client_log_error(CLIENT_LOG_ERROR_RECEIVING_RESPONSE);
+            response_mailbox_cancel(seq);
+            return;
+        }
+        if (type == MSG_LIST_END) break;
+
+        for (int i = 0; i < list.count; i++) {
+            game_info_t* game = &list.games[i];
+            printf("%d. %s vs %s (%s)\n",
+                   ++shown, game->player_a, game->player_b, game->game_id);
+        }
     }
 
-    for (int i = 0; i < list.count; i++) {
-        game_info_t* game = &list.games[i];
-        printf("%d. %s vs %s (%s)\n",
-               i + 1, game->player_a, game->player_b, game->game_id);
+    if (shown == 0) {
+        printf("No saved games found.\n");
     }
 }
 
 /* View a saved game */
 __attribute__((unused)) void cmd_view_saved_game(void) {
-    session_t* session = client_state_get_session();
-
     client_log_info(CLIENT_LOG_VIEW_SAVED_GAME_HEADER);
 
     /* First, get and display the list of saved games */
     msg_list_saved_games_t list_req;
     memset(&list_req, 0, sizeof(list_req));
     /* List all games for selection */
-    error_code_t err = session_send_message(session, MSG_LIST_SAVED_GAMES, &list_req, sizeof(list_req));
+    uint32_t seq;
+    error_code_t err = client_request_send(MSG_LIST_SAVED_GAMES, &list_req, sizeof(list_req), &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_ERROR_SENDING_REQUEST, error_to_string(err));
         return;
@@ -588,7 +603,7 @@ __attribute__((unused)) void cmd_view_saved_game(void) {
     msg_saved_game_list_t list;
     size_t size;
 
-    err = session_recv_message_timeout(session, &type, &list, sizeof(list), &size, 5000, NULL, 0);
+    err = client_request_wait(seq, &type, &list, sizeof(list), &size, 5000);
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
         return;
@@ -638,7 +653,7 @@ __attribute__((unused)) void cmd_view_saved_game(void) {
     memset(&req, 0, sizeof(req));
     snprintf(req.game_id, MAX_GAME_ID_LEN, "%s", game_id);
 
-    err = session_send_message(session, MSG_VIEW_SAVED_GAME, &req, sizeof(req));
+    err = client_request_send(MSG_VIEW_SAVED_GAME, &req, sizeof(req), &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_ERROR_SENDING_REQUEST, error_to_string(err));
         return;
@@ -646,7 +661,7 @@ __attribute__((unused)) void cmd_view_saved_game(void) {
 
     msg_saved_game_state_t board_state;
 
-    err = session_recv_message_timeout(session, &type, &board_state, sizeof(board_state), &size, 5000, NULL, 0);
+    err = client_request_wait(seq, &type, &board_state, sizeof(board_state), &size, 5000);
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
         return;
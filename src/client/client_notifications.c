@@ -11,6 +11,7 @@
 #include "../../include/common/messages.h"
 #include "../../include/common/protocol.h"
 #include "../../include/network/session.h"
+#include "../../include/network/board_delta.h"
 #include <stdio.h>
 #include <string.h>
 #include <pthread.h>
@@ -21,18 +22,84 @@
 #define MAX_PAYLOAD_SIZE MAX_MESSAGE_SIZE
 #endif
 
-/* Notification listener thread */
+/* Resume attempts after a drop, 250 ms apart and doubling */
+#define RESUME_ATTEMPTS 5
+
+/* Reconnect and take the server-side session back. The server replays the
+ * untagged frames sent after notifications_seen; they come through the
+ * listener loop like any other push. Requests in flight when the link
+ * dropped are not answered, so their commands time out. */
+static bool resume_session(session_t* session, uint32_t* notifications_seen) {
+    client_log_warning(CLIENT_LOG_RECONNECTING);
+
+    for (int attempt = 0; attempt < RESUME_ATTEMPTS && client_state_is_running(); attempt++) {
+        long delay_ms = 250L << attempt;
+        struct timespec delay = { delay_ms / 1000, (delay_ms % 1000) * 1000000L };
+        nanosleep(&delay, NULL);
+
+        session_t fresh;
+        session_init(&fresh);
+        if (client_state_reconnect(&fresh.conn) != SUCCESS) continue;
+
+        msg_resume_t resume_msg;
+        memset(&resume_msg, 0, sizeof(resume_msg));
+        snprintf(resume_msg.pseudo, sizeof(resume_msg.pseudo), "%s", client_state_get_pseudo());
+        snprintf(resume_msg.token, sizeof(resume_msg.token), "%s", session->session_id);
+        resume_msg.notifications_seen = *notifications_seen;
+
+        message_type_t type = MSG_UNKNOWN;
+        msg_resume_ack_t ack;
+        size_t size;
+        memset(&ack, 0, sizeof(ack));
+        error_code_t err = session_send_message(&fresh, MSG_RESUME, &resume_msg, sizeof(resume_msg));
+        if (err == SUCCESS) {
+            err = session_recv_message_timeout(&fresh, &type, &ack, sizeof(ack), &size, 5000, NULL, 0);
+        }
+        if (err != SUCCESS || type != MSG_RESUME_ACK) {
+            connection_close(&fresh.conn);
+            continue;
+        }
+        if (!ack.success) {
+            /* Window closed or server restarted: nothing left to resume */
+            ack.message[sizeof(ack.message) - 1] = '\0';
+            client_log_error(CLIENT_LOG_RESUME_REJECTED, ack.message);
+            connection_close(&fresh.conn);
+            return false;
+        }
+
+        /* Same fd number, so the command thread keeps sending on it */
+        if (connection_resume(&session->conn, &fresh.conn) != SUCCESS) return false;
+        session->authenticated = true;
+        *notifications_seen = ack.notifications_sent - ack.replayed;
+
+        client_log_info(CLIENT_LOG_SESSION_RESUMED, ack.replayed);
+        if (!ack.complete) {
+            client_log_warning(CLIENT_LOG_SESSION_RESUMED_PARTIAL);
+        }
+        return true;
+    }
+    return false;
+}
+
+/* Notification listener thread
+ * This is the only thread reading the socket: tagged frames are responses
+ * and go to the mailbox, untagged frames are server pushes (counted, so a
+ * resume can name the first one missed) */
 void* notification_listener(void* arg) {
     (void)arg;
     session_t* session = client_state_get_session();
+    uint32_t notifications_seen = 0;
     int consecutive_errors = 0;
     const int MAX_CONSECUTIVE_ERRORS = 3;
+    char payload[MAX_PAYLOAD_SIZE];
     
     while (client_state_is_running()) {
         message_type_t type;
+        uint32_t sequence;
+        size_t size;
 
-        /* Peek at the message type without consuming it */
-        error_code_t err = session_peek_message_type(session, &type, 1000);
+        error_code_t err = session_recv_tagged_timeout(session, &type, &sequence, payload,
+                                                       MAX_PAYLOAD_SIZE, &size, 1000);
 
         if (err == ERR_TIMEOUT) {
             consecutive_errors = 0;  /* Reset error counter on successful timeout */
@@ -43,6 +110,10 @@ void* notification_listener(void* arg) {
             consecutive_errors++;
 
             if (client_state_is_running()) {
+                if (err == ERR_NETWORK_ERROR && resume_session(session, &notifications_seen)) {
+                    consecutive_errors = 0;
+                    continue;
+                }
                 if (err == ERR_NETWORK_ERROR) {
                     /* Connection is broken - stop the client */
                     ui_display_connection_lost();
@@ -69,59 +140,54 @@ void* notification_listener(void* arg) {
             break;
         }
 
-        /* Check if this is a notification message */
-        if (IS_NOTIFICATION_MESSAGE(type)) {
-
-            /* This is a notification, consume and process it with retry logic */
-            char payload[MAX_PAYLOAD_SIZE];
-            size_t size;
-            int recv_retries = 0;
-            const int MAX_RECV_RETRIES = 3;
-            bool recv_success = false;
-
-            while (recv_retries < MAX_RECV_RETRIES && client_state_is_running()) {
-                err = session_recv_message_timeout(session, &type, payload, MAX_PAYLOAD_SIZE, &size, 1000, NULL, 0);
-                if (err == SUCCESS) {
-                    recv_success = true;
-                    break;
-                } else if (err == ERR_TIMEOUT) {
-                    recv_retries++;
-                    continue;
-                } else {
-                    /* Other error - could be network error or message consumed */
-                    break;
-                }
-            }
-
-            if (recv_success) {
-                /* Reset error counter on successful receive */
-                consecutive_errors = 0;
+        consecutive_errors = 0;
 
-                /* Handle the notification */
-                handle_notification_message(type, payload, size);
-            } else {
-                /* Failed to receive after retries */
-                if (err == ERR_NETWORK_ERROR) {
-                    consecutive_errors++;
-                    ui_display_connection_lost();
-                    client_state_set_running(false);
-                    raise(SIGTERM);
-                    break;
-                } else {
-                    /* Timeout or message consumed by main thread - not a network error */
-                    consecutive_errors = 0;
-                }
-            }
+        if (sequence != 0) {
+            /* Response to a request - hand it to the waiting command */
+            response_mailbox_deliver(sequence, type, payload, size);
         } else {
-            /* Not a notification message - leave it for the main thread */
-            consecutive_errors = 0;  /* Reset on successful peek */
-            continue;
+            notifications_seen++;
+            handle_notification_message(type, payload, size);
         }
     }
     
     return NULL;
 }
 
+static error_code_t client_request_send_tagged(message_type_t type, const void* payload, size_t size,
+                                               bool stream, uint32_t* sequence) {
+    session_t* session = client_state_get_session();
+    if (!sequence) return ERR_INVALID_PARAM;
+
+    /* Register the tag before sending so a fast reply cannot be missed */
+    *sequence = session_next_sequence(session);
+    error_code_t err = stream ? response_mailbox_expect_stream(*sequence) : response_mailbox_expect(*sequence);
+    if (err != SUCCESS) return err;
+
+    err = session_send_tagged(session, type, *sequence, payload, size);
+    if (err != SUCCESS) {
+        response_mailbox_cancel(*sequence);
+    }
+    return err;
+}
+
+/* Send a tagged request; the response is collected with client_request_wait */
+error_code_t client_request_send(message_type_t type, const void* payload, size_t size, uint32_t* sequence) {
+    return client_request_send_tagged(type, payload, size, false, sequence);
+}
+
+/* Send MSG_LIST_PAGE; call client_request_wait for each list frame until
+ * it returns MSG_LIST_END (or MSG_ERROR) */
+error_code_t client_request_send_list(const msg_list_page_t* req, uint32_t* sequence) {
+    return client_request_send_tagged(MSG_LIST_PAGE, req, sizeof(*req), true, sequence);
+}
+
+/* Wait for the response to a request sent with client_request_send */
+error_code_t client_request_wait(uint32_t sequence, message_type_t* type, void* payload,
+                                 size_t max_size, size_t* actual_size, int timeout_ms) {
+    return response_mailbox_wait(sequence, type, payload, max_size, actual_size, timeout_ms);
+}
+
 /* Send challenge accept message */
 error_code_t send_challenge_accept(int64_t challenge_id) {
     session_t* session = client_state_get_session();
@@ -146,10 +212,21 @@ error_code_t send_challenge_decline(int64_t challenge_id) {
 
 /* Handle a notification message */
 void handle_notification_message(message_type_t type, const void* payload, size_t size) {
-    (void)size;  /* Size is not used in handling */
-
     /* Handle push notifications */
-    if (type == MSG_CHALLENGE_RECEIVED) {
+    if (type == MSG_BOARD_DELTA) {
+        const msg_board_delta_t* delta = (const msg_board_delta_t*)payload;
+        if (board_delta_validate(delta, size) != SUCCESS) return;
+
+        /* Applied deltas and gaps both wake the play/spectator loop;
+         * on a gap the loop sends MSG_BOARD_RESYNC */
+        error_code_t err = board_cache_apply_delta(delta);
+        if (err == SUCCESS || err == ERR_SEQUENCE_GAP) {
+            active_games_notify_turn();
+            if (spectator_state_is_active()) {
+                spectator_state_notify_update();
+            }
+        }
+    } else if (type == MSG_CHALLENGE_RECEIVED) {
         msg_challenge_received_t* notif = (msg_challenge_received_t*)payload;
         pending_challenges_add(notif->from, notif->challenge_id);
         ui_display_challenge_received(notif);
@@ -157,7 +234,7 @@ void handle_notification_message(message_type_t type, const void* payload, size_
         msg_game_started_t* start = (msg_game_started_t*)payload;
 
         /* Add to active games */
-        active_games_add(start->game_id, start->player_a, start->player_b, start->your_side);
+        active_games_add(start->game, start->game_id, start->player_a, start->player_b, start->your_side);
 
         ui_display_game_started(start);
     } else if (type == MSG_MOVE_RESULT) {
@@ -173,11 +250,19 @@ void handle_notification_message(message_type_t type, const void* payload, size_
         ui_display_spectator_joined(notif);
     } else if (type == MSG_GAME_OVER) {
         msg_game_over_t* game_over = (msg_game_over_t*)payload;
-        active_games_remove(game_over->game_id);
+        active_games_remove(game_over->game);
         ui_display_game_over(game_over);
     } else if (type == MSG_CHAT_MESSAGE) {
         msg_chat_message_t* chat = (msg_chat_message_t*)payload;
         ui_display_chat_message(chat);
+    } else if (type == MSG_ERROR) {
+        /* Errors for untagged requests (moves, chat, challenge replies) */
+        msg_error_t* error = (msg_error_t*)payload;
+        if (error->error_code == SUCCESS) {
+            client_log_info("%s", error->error_msg);  /* e.g. challenge declined */
+        } else {
+            ui_display_challenge_error(error->error_msg);
+        }
     }
 }
 
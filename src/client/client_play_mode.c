@@ -2,17 +2,20 @@
  * Event-driven state machine for interactive play mode
  * 
  * Architecture:
- * - Single event loop using select() on stdin + notification pipe
+ * - Single event loop using poll() on stdin + notification pipe
  * - State machine transitions based on server responses
  * - Always drain user input to prevent buffering issues
  * - Process all user input before handling server events
  * - Server is authoritative - client adjusts to server state
+ * - The board is fetched once, then kept current from MSG_BOARD_DELTA
+ *   pushes applied by the notification listener (no request per move)
  */
 
 #define _POSIX_C_SOURCE 200809L
 
 #include "../../include/client/client_play_mode.h"
 #include "../../include/client/client_state.h"
+#include "../../include/client/client_notifications.h"
 #include "../../include/client/client_ui.h"
 #include "../../include/client/client_logging.h"
 #include "../../include/common/messages.h"
@@ -23,7 +26,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <time.h>
 #include <ctype.h>
 
@@ -42,35 +45,27 @@ typedef enum {
     EVENT_NONE = 0,
     EVENT_USER_INPUT,        /* User typed something on stdin */
     EVENT_NOTIFICATION,      /* Server notification received */
-    EVENT_TIMEOUT            /* Select timeout (for debugging) */
+    EVENT_TIMEOUT            /* Poll timeout (for debugging) */
 } event_type_t;
 
 /* Helper: Poll for events from user or server */
 static event_type_t poll_events(int notification_fd, int timeout_ms) {
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(STDIN_FILENO, &readfds);
-    
-    int max_fd = STDIN_FILENO;
+    struct pollfd fds[2];
+    nfds_t nfds = 1;
+    fds[0].fd = STDIN_FILENO;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
     if (notification_fd != -1) {
-        FD_SET(notification_fd, &readfds);
-        if (notification_fd > max_fd) {
-            max_fd = notification_fd;
-        }
-    }
-    
-    struct timeval tv;
-    struct timeval* tv_ptr = NULL;
-    if (timeout_ms >= 0) {
-        tv.tv_sec = timeout_ms / 1000;
-        tv.tv_usec = (timeout_ms % 1000) * 1000;
-        tv_ptr = &tv;
+        fds[1].fd = notification_fd;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        nfds = 2;
     }
     
-    int ready = select(max_fd + 1, &readfds, NULL, NULL, tv_ptr);
+    int ready = poll(fds, nfds, timeout_ms >= 0 ? timeout_ms : -1);
     
     if (ready < 0) {
-        perror("select error");
+        perror("poll error");
         return EVENT_NONE;
     }
     
@@ -79,11 +74,11 @@ static event_type_t poll_events(int notification_fd, int timeout_ms) {
     }
     
     /* Priority: Process ALL user input before handling server notifications */
-    if (FD_ISSET(STDIN_FILENO, &readfds)) {
+    if (fds[0].revents & (POLLIN | POLLHUP)) {
         return EVENT_USER_INPUT;
     }
     
-    if (notification_fd != -1 && FD_ISSET(notification_fd, &readfds)) {
+    if (nfds == 2 && (fds[1].revents & (POLLIN | POLLHUP))) {
         return EVENT_NOTIFICATION;
     }
     
@@ -91,13 +86,15 @@ static event_type_t poll_events(int notification_fd, int timeout_ms) {
 }
 
 /* Helper: Request board state from server */
-static error_code_t request_board(const char* player_a, const char* player_b) {
+static error_code_t request_board(game_handle_t game, const char* player_a, const char* player_b,
+                                  uint32_t* seq) {
     msg_get_board_t board_req;
     memset(&board_req, 0, sizeof(board_req));
+    board_req.game = game;
     snprintf(board_req.player_a, MAX_PSEUDO_LEN, "%s", player_a);
     snprintf(board_req.player_b, MAX_PSEUDO_LEN, "%s", player_b);
     
-    error_code_t err = session_send_message(client_state_get_session(), MSG_GET_BOARD, &board_req, sizeof(board_req));
+    error_code_t err = client_request_send(MSG_GET_BOARD, &board_req, sizeof(board_req), seq);
     
     if (err == ERR_NETWORK_ERROR) {
         client_log_error(CLIENT_LOG_FAILED_SEND_BOARD_REQUEST);
@@ -110,55 +107,40 @@ static error_code_t request_board(const char* player_a, const char* player_b) {
     return err;
 }
 
-/* Helper: Receive board state from server with retry logic */
-static error_code_t receive_board(msg_board_state_t* board) {
+/* Helper: Receive the board state answering request `seq` */
+static error_code_t receive_board(uint32_t seq, msg_board_state_t* board) {
     message_type_t type;
     size_t size;
-    int retries = 0;
     const int MAX_RETRIES = 2;
     
-    while (retries <= MAX_RETRIES) {
-        error_code_t err = session_recv_message_timeout(client_state_get_session(), &type, board,
-                                                         sizeof(*board), &size, 5000, NULL, 0);
-        
-        if (err == ERR_TIMEOUT) {
-            retries++;
-            if (retries <= MAX_RETRIES) {
-                client_log_warning(CLIENT_LOG_SERVER_RESPONSE_TIMEOUT, retries, MAX_RETRIES + 1);
-                continue;
-            }
-            client_log_error(CLIENT_LOG_SERVER_NOT_RESPONDING, MAX_RETRIES + 1);
-            return err;
-        }
-        
-        if (err == ERR_NETWORK_ERROR) {
-            client_log_error(CLIENT_LOG_CONNECTION_LOST);
-            return err;
-        }
-        
-        if (err != SUCCESS) {
-            client_log_error(CLIENT_LOG_ERROR_RECEIVING_BOARD, error_to_string(err));
-            return err;
-        }
-        
-        if (type != MSG_BOARD_STATE) {
-            /* Unexpected message type - might be out of order */
-            retries++;
-            if (retries <= MAX_RETRIES) {
-                client_log_warning(CLIENT_LOG_UNEXPECTED_MESSAGE_TYPE, type, MSG_BOARD_STATE);
-                /* Request board again */
-                return ERR_UNKNOWN;
-            }
-            client_log_error(CLIENT_LOG_PROTOCOL_ERROR);
-            return ERR_UNKNOWN;
-        }
-
-        /* Success - log board reception */
-        client_log_info(CLIENT_LOG_BOARD_RECEIVED);
-        return SUCCESS;
+    /* The response is matched by tag, so a slow server only costs time:
+     * wait out the whole retry budget instead of re-reading the socket */
+    error_code_t err = client_request_wait(seq, &type, board, sizeof(*board), &size,
+                                           5000 * (MAX_RETRIES + 1));
+    
+    if (err == ERR_TIMEOUT) {
+        client_log_error(CLIENT_LOG_SERVER_NOT_RESPONDING, MAX_RETRIES + 1);
+        return err;
     }
     
-    return ERR_TIMEOUT;
+    if (err == ERR_NETWORK_ERROR) {
+        client_log_error(CLIENT_LOG_CONNECTION_LOST);
+        return err;
+    }
+    
+    if (err != SUCCESS) {
+        client_log_error(CLIENT_LOG_ERROR_RECEIVING_BOARD, error_to_string(err));
+        return err;
+    }
+    
+    if (type != MSG_BOARD_STATE) {
+        client_log_warning(CLIENT_LOG_UNEXPECTED_MESSAGE_TYPE, type, MSG_BOARD_STATE);
+        return ERR_UNKNOWN;
+    }
+
+    /* Success - log board reception */
+    client_log_info(CLIENT_LOG_BOARD_RECEIVED);
+    return SUCCESS;
 }
 
 /* Helper: Display board and current state */
@@ -184,9 +166,53 @@ static void display_board(const msg_board_state_t* board, player_id_t my_side) {
     fflush(stdout);
 }
 
+/* Helper: Ask the server for a keyframe after a missed delta */
+static error_code_t request_resync(game_handle_t game) {
+    msg_board_resync_t resync_req;
+    memset(&resync_req, 0, sizeof(resync_req));
+    resync_req.game = game;
+    
+    return session_send_message(client_state_get_session(), MSG_BOARD_RESYNC, &resync_req, sizeof(resync_req));
+}
+
+/* Helper: Pick up the cached board if deltas moved it past what is displayed */
+static bool take_cached_board(msg_board_state_t* board) {
+    msg_board_state_t cached;
+    if (!board_cache_get(&cached) || cached.seq <= board->seq) {
+        return false;
+    }
+    *board = cached;
+    return true;
+}
+
+/* Helper: Show a fresh board and return the state to move to */
+static play_state_t show_board(const msg_board_state_t* board, player_id_t my_side) {
+    if (board->state == GAME_STATE_FINISHED) {
+        client_log_info(CLIENT_LOG_GAME_OVER_HEADER);
+        client_log_info(CLIENT_LOG_GAME_FINISHED);
+        if (board->winner == WINNER_A) {
+            client_log_info(CLIENT_LOG_GAME_WINNER, board->player_a, board->score_a);
+            client_log_info(CLIENT_LOG_GAME_PLAYER_B, board->player_b, board->score_b);
+        } else if (board->winner == WINNER_B) {
+            client_log_info(CLIENT_LOG_GAME_WINNER, board->player_b, board->score_b);
+            client_log_info(CLIENT_LOG_GAME_PLAYER_A, board->player_a, board->score_a);
+        } else {
+            client_log_info(CLIENT_LOG_GAME_DRAW, board->score_a, board->score_b);
+        }
+        client_log_info(CLIENT_LOG_GAME_OVER_SEPARATOR);
+        client_log_info(CLIENT_LOG_GAME_REMATCH_PROMPT);
+        fflush(stdout);
+        
+        return STATE_GAME_OVER;
+    }
+    
+    display_board(board, my_side);
+    return STATE_IDLE;
+}
+
 /* Helper: Handle user input based on current state */
 static void handle_user_input(play_state_t* state, const msg_board_state_t* board, 
-                              player_id_t my_side, const char* game_id, 
+                              player_id_t my_side, game_handle_t game, 
                               char input[32], bool* should_request_board) {
     (void)should_request_board;  /* Reserved for future use */
     
@@ -244,7 +270,7 @@ static void handle_user_input(play_state_t* state, const msg_board_state_t* boar
             /* Valid move - send it */
             msg_play_move_t move;
             memset(&move, 0, sizeof(move));
-            snprintf(move.game_id, MAX_GAME_ID_LEN, "%s", game_id);
+            move.game = game;
             snprintf(move.player, MAX_PSEUDO_LEN, "%s", client_state_get_pseudo());
             move.pit_index = pit;
             
@@ -301,11 +327,10 @@ void cmd_play_mode(void) {
 
     /* If no local active games, query server for player's games */
     if (game_count == 0) {
-        session_t* session = client_state_get_session();
-
         client_log_info(CLIENT_LOG_LOADING_BOARD_STATE);  /* Reuse loading message */
 
-        error_code_t err = session_send_message(session, MSG_LIST_MY_GAMES, NULL, 0);
+        uint32_t seq;
+        error_code_t err = client_request_send(MSG_LIST_MY_GAMES, NULL, 0, &seq);
         if (err != SUCCESS) {
             client_log_error(CLIENT_LOG_ERROR_SENDING_REQUEST, error_to_string(err));
             return;
@@ -315,7 +340,7 @@ void cmd_play_mode(void) {
         msg_my_game_list_t list;
         size_t size;
 
-        err = session_recv_message_timeout(session, &type, &list, sizeof(list), &size, 5000, NULL, 0);
+        err = client_request_wait(seq, &type, &list, sizeof(list), &size, 5000);
         if (err == ERR_TIMEOUT) {
             client_log_error(CLIENT_LOG_TIMEOUT_SERVER);
             return;
@@ -332,7 +357,7 @@ void cmd_play_mode(void) {
             bool already_exists = false;
             for (int j = 0; j < active_games_count(); j++) {
                 active_game_t* existing = active_games_get(j);
-                if (existing && strcmp(existing->game_id, list.games[i].game_id) == 0) {
+                if (existing && existing->game == list.games[i].game) {
                     already_exists = true;
                     break;
                 }
@@ -348,7 +373,7 @@ void cmd_play_mode(void) {
                 } else {
                     continue;  /* Not my game */
                 }
-                active_games_add(list.games[i].game_id, list.games[i].player_a,
+                active_games_add(list.games[i].game, list.games[i].game_id, list.games[i].player_a,
                                list.games[i].player_b, my_side);
             }
         }
@@ -411,6 +436,7 @@ void cmd_play_mode(void) {
     
     /* Initialize state machine */
     play_state_t state = STATE_INIT;
+    game_handle_t game = selected_game->game;
     char game_id_copy[MAX_GAME_ID_LEN];
     char player_a_copy[MAX_PSEUDO_LEN];
     char player_b_copy[MAX_PSEUDO_LEN];
@@ -422,6 +448,9 @@ void cmd_play_mode(void) {
     snprintf(player_a_copy, MAX_PSEUDO_LEN, "%s", selected_game->player_a);
     snprintf(player_b_copy, MAX_PSEUDO_LEN, "%s", selected_game->player_b);
     
+    /* Track deltas for this game from now on */
+    board_cache_watch(game);
+    
     /* Clear stale notifications and input */
     active_games_clear_notifications();
     clear_input();
@@ -433,6 +462,7 @@ void cmd_play_mode(void) {
     
     int notification_fd = active_games_get_notification_fd();
     bool should_request_board = true;
+    uint32_t board_seq = 0;
     
     /* ═══════════════════════════════════════════════════════════════
      * EVENT LOOP - Single polling point for all events
@@ -441,7 +471,7 @@ void cmd_play_mode(void) {
         
         /* STATE: INIT - Initial board request */
         if (state == STATE_INIT) {
-            error_code_t err = request_board(player_a_copy, player_b_copy);
+            error_code_t err = request_board(game, player_a_copy, player_b_copy, &board_seq);
             if (err != SUCCESS) {
                 client_log_error(CLIENT_LOG_ERROR_REQUESTING_INITIAL_BOARD, error_to_string(err));
                 break;
@@ -453,7 +483,7 @@ void cmd_play_mode(void) {
         
         /* Request board if needed (after notification or state transition) */
         if (should_request_board) {
-            error_code_t err = request_board(player_a_copy, player_b_copy);
+            error_code_t err = request_board(game, player_a_copy, player_b_copy, &board_seq);
             if (err != SUCCESS) {
                 client_log_error(CLIENT_LOG_ERROR_REQUESTING_BOARD, error_to_string(err));
                 if (err == ERR_NETWORK_ERROR) {
@@ -469,7 +499,7 @@ void cmd_play_mode(void) {
         
         /* STATE: WAITING_BOARD - Expecting board response from server */
         if (state == STATE_WAITING_BOARD) {
-            error_code_t err = receive_board(&board);
+            error_code_t err = receive_board(board_seq, &board);
             
             if (err == ERR_TIMEOUT) {
                 /* Timeout - try requesting again */
@@ -494,34 +524,13 @@ void cmd_play_mode(void) {
             /* Board received successfully */
             if (!board.exists) {
                 client_log_error(CLIENT_LOG_GAME_NO_LONGER_EXISTS);
-                active_games_remove(game_id_copy);
+                active_games_remove(game);
                 break;
             }
             
-            /* Check if game is over */
-            if (board.state == GAME_STATE_FINISHED) {
-                client_log_info(CLIENT_LOG_GAME_OVER_HEADER);
-                client_log_info(CLIENT_LOG_GAME_FINISHED);
-                if (board.winner == WINNER_A) {
-                    client_log_info(CLIENT_LOG_GAME_WINNER, board.player_a, board.score_a);
-                    client_log_info(CLIENT_LOG_GAME_PLAYER_B, board.player_b, board.score_b);
-                } else if (board.winner == WINNER_B) {
-                    client_log_info(CLIENT_LOG_GAME_WINNER, board.player_b, board.score_b);
-                    client_log_info(CLIENT_LOG_GAME_PLAYER_A, board.player_a, board.score_a);
-                } else {
-                    client_log_info(CLIENT_LOG_GAME_DRAW, board.score_a, board.score_b);
-                }
-                client_log_info(CLIENT_LOG_GAME_OVER_SEPARATOR);
-                client_log_info(CLIENT_LOG_GAME_REMATCH_PROMPT);
-                fflush(stdout);
-                
-                state = STATE_GAME_OVER;
-                continue;
-            }
-            
-            /* Display board and transition to IDLE */
-            display_board(&board, my_side);
-            state = STATE_IDLE;
+            /* Seed the delta cache, then display (or show game over) */
+            board_cache_seed(&board);
+            state = show_board(&board, my_side);
             continue;
         }
         
@@ -531,10 +540,26 @@ void cmd_play_mode(void) {
             event_type_t event = poll_events(notification_fd, 5000);  /* 5 second timeout */
             
             if (event == EVENT_NOTIFICATION) {
-                /* Move processed - request fresh board */
                 active_games_clear_notifications();
-                should_request_board = true;
-                state = STATE_INIT;
+                
+                /* Missed a delta - the keyframe will wake us again */
+                if (board_cache_take_resync()) {
+                    if (request_resync(game) != SUCCESS) {
+                        should_request_board = true;
+                        state = STATE_INIT;
+                    }
+                    continue;
+                }
+                
+                /* Move applied locally from the delta push */
+                if (take_cached_board(&board)) {
+                    state = show_board(&board, my_side);
+                    continue;
+                }
+                
+                /* Result without a delta - move was rejected, board unchanged */
+                display_board(&board, my_side);
+                state = STATE_IDLE;
                 continue;
             }
             
@@ -549,7 +574,7 @@ void cmd_play_mode(void) {
             if (event == EVENT_USER_INPUT) {
                 /* User typed something while waiting - drain it */
                 char input[32];
-                handle_user_input(&state, &board, my_side, game_id_copy, input, &should_request_board);
+                handle_user_input(&state, &board, my_side, game, input, &should_request_board);
                 continue;
             }
             
@@ -564,14 +589,24 @@ void cmd_play_mode(void) {
             if (event == EVENT_USER_INPUT) {
                 /* Process ALL user input before handling server events */
                 char input[32];
-                handle_user_input(&state, &board, my_side, game_id_copy, input, &should_request_board);
+                handle_user_input(&state, &board, my_side, game, input, &should_request_board);
                 continue;
             }
             
             if (event == EVENT_NOTIFICATION) {
                 /* Server notification (opponent moved, game state changed) */
                 active_games_clear_notifications();
-                should_request_board = true;
+                
+                if (board_cache_take_resync()) {
+                    if (request_resync(game) != SUCCESS) {
+                        should_request_board = true;
+                    }
+                    continue;
+                }
+                
+                if (take_cached_board(&board)) {
+                    state = show_board(&board, my_side);
+                }
                 continue;
             }
             
@@ -581,14 +616,15 @@ void cmd_play_mode(void) {
         /* STATE: GAME_OVER - Handle rematch decision */
         if (state == STATE_GAME_OVER) {
             char input[32];
-            handle_user_input(&state, &board, my_side, game_id_copy, input, &should_request_board);
+            handle_user_input(&state, &board, my_side, game, input, &should_request_board);
             continue;
         }
     }
 
     /* Cleanup - user explicitly exited, so remove from active games */
+    board_cache_clear();
     client_log_info(CLIENT_LOG_GAME_REMOVED_ON_EXIT, game_id_copy);
-    active_games_remove(game_id_copy);
+    active_games_remove(game);
 
     client_log_info(CLIENT_LOG_EXITING_PLAY_MODE);
 }
@@ -6,11 +6,13 @@
 
 #include "../../include/client/client_spectator_mode.h"
 #include "../../include/client/client_state.h"
+#include "../../include/client/client_notifications.h"
 #include "../../include/client/client_ui.h"
 #include "../../include/client/client_logging.h"
 #include "../../include/common/messages.h"
 #include "../../include/common/protocol.h"
 #include "../../include/network/session.h"
+#include "../../include/network/board_delta.h"
 #include "../../include/game/board.h"
 #include <stdio.h>
 #include <string.h>
@@ -18,6 +20,26 @@
 #include <sys/select.h>
 #include <time.h>
 
+/* Print a spectated board with scores and turn */
+static void display_spectated_board(const msg_board_state_t* board_state) {
+    /* Create board_t from board_state for printing */
+    board_t board;
+    memcpy(board.pits, board_state->pits, sizeof(board.pits));
+    board.scores[0] = board_state->score_a;  /* Player A */
+    board.scores[1] = board_state->score_b;  /* Player B */
+    board.current_player = board_state->current_player;
+
+    client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
+    ui_display_board_simple(&board);
+    client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
+    client_log_info(CLIENT_LOG_SPECTATOR_SCORE_FORMAT,
+           board_state->player_a, board_state->score_a,
+           board_state->player_b, board_state->score_b);
+    const char* current_str = (board_state->current_player == PLAYER_A) ? board_state->player_a : board_state->player_b;
+    client_log_info(CLIENT_LOG_SPECTATOR_CURRENT_TURN, current_str);
+    client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
+}
+
 void cmd_spectator_mode(void) {
     client_log_info(CLIENT_LOG_SPECTATOR_MODE_HEADER);
     client_log_info(CLIENT_LOG_SPECTATOR_MODE_TITLE);
@@ -25,7 +47,8 @@ void cmd_spectator_mode(void) {
     client_log_info(CLIENT_LOG_SPECTATOR_MODE_INFO);
     
     /* Request list of active games */
-    error_code_t err = session_send_message(client_state_get_session(), MSG_LIST_GAMES, NULL, 0);
+    uint32_t seq;
+    error_code_t err = client_request_send(MSG_LIST_GAMES, NULL, 0, &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_FAILED_REQUEST_GAME_LIST);
         return;
@@ -36,8 +59,7 @@ void cmd_spectator_mode(void) {
     msg_game_list_t game_list;
     size_t size;
     
-    err = session_recv_message_timeout(client_state_get_session(), &type, (char*)&game_list,
-                                       sizeof(game_list), &size, 5000, NULL, 0);
+    err = client_request_wait(seq, &type, (char*)&game_list, sizeof(game_list), &size, 5000);
     
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_TIMEOUT_GAME_LIST);
@@ -94,9 +116,9 @@ void cmd_spectator_mode(void) {
     
     /* Send spectate request */
     msg_spectate_game_t spectate_req;
-    snprintf(spectate_req.game_id, sizeof(spectate_req.game_id), "%s", selected_game->game_id);
+    spectate_req.game = selected_game->game;
     
-    err = session_send_message(client_state_get_session(), MSG_SPECTATE_GAME, &spectate_req, sizeof(spectate_req));
+    err = client_request_send(MSG_SPECTATE_GAME, &spectate_req, sizeof(spectate_req), &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_SPECTATOR_FAILED_SEND_REQUEST);
         return;
@@ -104,8 +126,7 @@ void cmd_spectator_mode(void) {
     
     /* Wait for acknowledgment */
     msg_spectate_ack_t ack;
-    err = session_recv_message_timeout(client_state_get_session(), &type, (char*)&ack,
-                                        sizeof(ack), &size, 5000, NULL, 0);
+    err = client_request_wait(seq, &type, (char*)&ack, sizeof(ack), &size, 5000);
 
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_SPECTATOR_TIMEOUT_ACK);
@@ -125,7 +146,7 @@ void cmd_spectator_mode(void) {
     client_log_info(CLIENT_LOG_SPECTATOR_ACK_MESSAGE, ack.message);
     
     /* Set spectator state */
-    spectator_state_set(selected_game->game_id, selected_game->player_a, selected_game->player_b);
+    spectator_state_set(selected_game->game, selected_game->player_a, selected_game->player_b);
 
     /* Spectator loop */
     client_log_info(CLIENT_LOG_SPECTATOR_GAME_HEADER);
@@ -135,15 +156,19 @@ void cmd_spectator_mode(void) {
     client_log_info(CLIENT_LOG_SPECTATOR_COMMAND_REFRESH);
     client_log_info(CLIENT_LOG_SPECTATOR_COMMAND_QUIT);
 
+    /* Track deltas for this game from now on */
+    board_cache_watch(selected_game->game);
+
     /* Flag to prevent concurrent board requests */
     bool board_request_pending = false;
 
     /* Initial board request */
     msg_get_board_t board_req;
     memset(&board_req, 0, sizeof(board_req));
+    board_req.game = selected_game->game;
     snprintf(board_req.player_a, MAX_PSEUDO_LEN, "%s", selected_game->player_a);
     snprintf(board_req.player_b, MAX_PSEUDO_LEN, "%s", selected_game->player_b);
-    err = session_send_message(client_state_get_session(), MSG_GET_BOARD, &board_req, sizeof(board_req));
+    err = client_request_send(MSG_GET_BOARD, &board_req, sizeof(board_req), &seq);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_SPECTATOR_FAILED_SEND_REQUEST);
         return;
@@ -152,8 +177,7 @@ void cmd_spectator_mode(void) {
 
     /* Display initial board */
     char buffer[MAX_MESSAGE_SIZE];
-    err = session_recv_message_timeout(client_state_get_session(), &type, buffer,
-                                         MAX_MESSAGE_SIZE, &size, 5000, NULL, 0);
+    err = client_request_wait(seq, &type, buffer, MAX_MESSAGE_SIZE, &size, 5000);
 
     if (err == ERR_TIMEOUT) {
         client_log_error(CLIENT_LOG_TIMEOUT_GAME_LIST);  /* Reuse timeout message */
@@ -169,83 +193,17 @@ void cmd_spectator_mode(void) {
 
     board_request_pending = false;  /* Request completed */
 
+    /* Pushes are routed to the notification listener, so only the
+     * tagged response can arrive here */
     if (type != MSG_BOARD_STATE) {
-        /* Handle unexpected message types */
-        if (IS_NOTIFICATION_MESSAGE(type)) {
-            /* This is a notification that arrived during board request wait */
-            /* Process it here since notification listener might not have caught it */
-            /* Keep processing notifications until we get the board state */
-            while (type != MSG_BOARD_STATE && IS_NOTIFICATION_MESSAGE(type)) {
-                client_log_info("Received notification %d during board request, processing...", type);
-
-                /* Handle the notification */
-                if (type == MSG_CHALLENGE_RECEIVED) {
-                    // Handle challenge received
-                    msg_challenge_received_t* notif = (msg_challenge_received_t*)buffer;
-                    pending_challenges_add(notif->from, notif->challenge_id);
-                    ui_display_challenge_received(notif);
-                } else if (type == MSG_GAME_STARTED) {
-                    // Handle game started
-                    msg_game_started_t* start = (msg_game_started_t*)buffer;
-                    active_games_add(start->game_id, start->player_a, start->player_b, start->your_side);
-                    ui_display_game_started(start);
-                } else if (type == MSG_MOVE_RESULT) {
-                    /* Move result - trigger board update */
-                    spectator_state_notify_update();
-                } else if (type == MSG_GAME_OVER) {
-                    // Handle game over
-                    msg_game_over_t* game_over = (msg_game_over_t*)buffer;
-                    active_games_remove(game_over->game_id);
-                    ui_display_game_over(game_over);
-                } else if (type == MSG_CHAT_MESSAGE) {
-                    // Handle chat message
-                    msg_chat_message_t* chat = (msg_chat_message_t*)buffer;
-                    ui_display_chat_message(chat);
-                } else if (type == MSG_SPECTATOR_JOINED) {
-                    // Handle spectator joined
-                    msg_spectator_joined_t* joined = (msg_spectator_joined_t*)buffer;
-                    client_log_info("Spectator joined: %s (Total: %d)", joined->spectator, joined->spectator_count);
-                }
-
-                /* Continue waiting for board state or more notifications */
-                err = session_recv_message_timeout(client_state_get_session(), &type, buffer,
-                                                     MAX_MESSAGE_SIZE, &size, 5000, NULL, 0);
-                if (err != SUCCESS) {
-                    client_log_error("Failed to receive next message after processing notification");
-                    return;
-                }
-            }
-
-            /* After processing all notifications, check if we got the board state */
-            if (type != MSG_BOARD_STATE) {
-                client_log_error("Expected board state but got message type %d", type);
-                return;
-            }
-        } else {
-            /* Unexpected non-notification message */
-            client_log_error(CLIENT_LOG_PROTOCOL_ERROR);
-            client_log_error(CLIENT_LOG_SPECTATOR_UNEXPECTED_MSG, type, MSG_BOARD_STATE);
-            return;
-        }
+        client_log_error(CLIENT_LOG_PROTOCOL_ERROR);
+        client_log_error(CLIENT_LOG_SPECTATOR_UNEXPECTED_MSG, type, MSG_BOARD_STATE);
+        return;
     }
 
-    /* Create board_t from board_state for printing */
-    msg_board_state_t* board_state = (msg_board_state_t*)buffer;
-    board_t board;
-    memcpy(board.pits, board_state->pits, sizeof(board.pits));
-    board.scores[0] = board_state->score_a;  /* Player A */
-    board.scores[1] = board_state->score_b;  /* Player B */
-    board.current_player = board_state->current_player;
-
-    client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
-    ui_display_board_simple(&board);
-    client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
-    client_log_info(CLIENT_LOG_SPECTATOR_SCORE_FORMAT,
-           board_state->player_a, board_state->score_a,
-           board_state->player_b, board_state->score_b);
-    const char* current_str = (board_state->current_player == PLAYER_A) ? board_state->player_a : board_state->player_b;
-    client_log_info(CLIENT_LOG_SPECTATOR_CURRENT_TURN, current_str);
-    client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
+    /* Seed the delta cache; later moves arrive as MSG_BOARD_DELTA pushes */
+    board_cache_seed((msg_board_state_t*)buffer);
+    display_spectated_board((msg_board_state_t*)buffer);
     
     bool spectating = true;
     bool prompt_printed = false;
@@ -282,9 +240,10 @@ void cmd_spectator_mode(void) {
                 if (!board_request_pending) {
                     msg_get_board_t refresh_req;
                     memset(&refresh_req, 0, sizeof(refresh_req));
+                    refresh_req.game = selected_game->game;
                     snprintf(refresh_req.player_a, MAX_PSEUDO_LEN, "%s", selected_game->player_a);
                     snprintf(refresh_req.player_b, MAX_PSEUDO_LEN, "%s", selected_game->player_b);
-                    err = session_send_message(client_state_get_session(), MSG_GET_BOARD, &refresh_req, sizeof(refresh_req));
+                    err = client_request_send(MSG_GET_BOARD, &refresh_req, sizeof(refresh_req), &seq);
                     if (err != SUCCESS) {
                         client_log_error(CLIENT_LOG_SPECTATOR_FAILED_SEND_REQUEST);
                         spectating = false;  /* Exit spectator mode on send failure */
@@ -292,8 +251,7 @@ void cmd_spectator_mode(void) {
                     }
                     board_request_pending = true;
 
-                    err = session_recv_message_timeout(client_state_get_session(), &type, buffer,
-                                                         MAX_MESSAGE_SIZE, &size, 5000, NULL, 0);
+                    err = client_request_wait(seq, &type, buffer, MAX_MESSAGE_SIZE, &size, 5000);
                     board_request_pending = false;
 
                     if (err == ERR_TIMEOUT) {
@@ -313,24 +271,9 @@ void cmd_spectator_mode(void) {
                         spectating = false;  /* Exit spectator mode on protocol error */
                         break;
                     } else {
-                        /* Success - display board */
-                        /* Create board_t from board_state for printing */
-                        msg_board_state_t* board_state = (msg_board_state_t*)buffer;
-                        board_t board;
-                        memcpy(board.pits, board_state->pits, sizeof(board.pits));
-                        board.scores[0] = board_state->score_a;  /* Player A */
-                        board.scores[1] = board_state->score_b;  /* Player B */
-                        board.current_player = board_state->current_player;
-
-                        client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
-                        ui_display_board_simple(&board);
-                        client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
-                        client_log_info(CLIENT_LOG_SPECTATOR_SCORE_FORMAT,
-                            board_state->player_a, board_state->score_a,
-                            board_state->player_b, board_state->score_b);
-                        const char* current_str = (board_state->current_player == PLAYER_A) ? board_state->player_a : board_state->player_b;
-                        client_log_info(CLIENT_LOG_SPECTATOR_CURRENT_TURN, current_str);
-                        client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
+                        /* Success - reseed cache and display board */
+                        board_cache_seed((msg_board_state_t*)buffer);
+                        display_spectated_board((msg_board_state_t*)buffer);
                     }
                 } else {
                     client_log_info("Board refresh already in progress, please wait...");
@@ -338,74 +281,42 @@ void cmd_spectator_mode(void) {
             }
         }
         
-        /* Check if board was updated by notification */
+        /* Check if board was updated by a delta push */
         if (spectator_state_check_and_clear_updated() && !board_request_pending) {
             prompt_printed = false;  /* Reset prompt flag when board updates */
 
-            /* Auto-refresh board */
-            client_log_info(CLIENT_LOG_SPECTATOR_BOARD_UPDATED);
-            msg_get_board_t update_req;
-            memset(&update_req, 0, sizeof(update_req));
-            snprintf(update_req.player_a, MAX_PSEUDO_LEN, "%s", selected_game->player_a);
-            snprintf(update_req.player_b, MAX_PSEUDO_LEN, "%s", selected_game->player_b);
-            err = session_send_message(client_state_get_session(), MSG_GET_BOARD, &update_req, sizeof(update_req));
-            if (err != SUCCESS) {
-                client_log_error(CLIENT_LOG_SPECTATOR_FAILED_SEND_REQUEST);
-                spectating = false;  /* Exit spectator mode on send failure */
-                break;
+            /* Missed a delta - ask for a keyframe, it will trigger another update */
+            if (board_cache_take_resync()) {
+                msg_board_resync_t resync_req;
+                memset(&resync_req, 0, sizeof(resync_req));
+                resync_req.game = selected_game->game;
+                err = session_send_message(client_state_get_session(), MSG_BOARD_RESYNC, &resync_req, sizeof(resync_req));
+                if (err != SUCCESS) {
+                    client_log_error(CLIENT_LOG_SPECTATOR_FAILED_SEND_REQUEST);
+                    spectating = false;  /* Exit spectator mode on send failure */
+                    break;
+                }
+                continue;
             }
-            board_request_pending = true;
-
-            err = session_recv_message_timeout(client_state_get_session(), &type, buffer,
-                                                 MAX_MESSAGE_SIZE, &size, 5000, NULL, 0);
-            board_request_pending = false;
-
-            if (err == ERR_TIMEOUT) {
-                client_log_error(CLIENT_LOG_TIMEOUT_GAME_LIST);  /* Reuse timeout message */
-                client_log_error(CLIENT_LOG_SPECTATOR_FAILED_REFRESH);
-                /* Continue spectating on timeout - notification will trigger again */
-            } else if (err == ERR_NETWORK_ERROR) {
-                client_log_error(CLIENT_LOG_CONNECTION_LOST);
-                spectating = false;  /* Exit spectator mode on network error */
-                break;
-            } else if (err != SUCCESS) {
-                client_log_error(CLIENT_LOG_SPECTATOR_FAILED_RECEIVE_ACK);  /* Reuse generic error */
-                spectating = false;  /* Exit spectator mode on other errors */
-                break;
-            } else if (type != MSG_BOARD_STATE) {
-                client_log_error(CLIENT_LOG_PROTOCOL_ERROR);
-                spectating = false;  /* Exit spectator mode on protocol error */
-                break;
-            } else {
-                /* Success - display board */
-                /* Create board_t from board_state for printing */
-                msg_board_state_t* board_state = (msg_board_state_t*)buffer;
-                board_t board;
-                memcpy(board.pits, board_state->pits, sizeof(board.pits));
-                board.scores[0] = board_state->score_a;  /* Player A */
-                board.scores[1] = board_state->score_b;  /* Player B */
-                board.current_player = board_state->current_player;
 
-                client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
-                ui_display_board_simple(&board);
-                client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
-                client_log_info(CLIENT_LOG_SPECTATOR_SCORE_FORMAT,
-                    board_state->player_a, board_state->score_a,
-                    board_state->player_b, board_state->score_b);
-                const char* current_str = (board_state->current_player == PLAYER_A) ? board_state->player_a : board_state->player_b;
-                client_log_info(CLIENT_LOG_SPECTATOR_CURRENT_TURN, current_str);
-                client_log_info(CLIENT_LOG_SPECTATOR_NEWLINE);
+            /* Display the locally updated board - no round trip */
+            msg_board_state_t cached;
+            if (board_cache_get(&cached)) {
+                client_log_info(CLIENT_LOG_SPECTATOR_BOARD_UPDATED);
+                display_spectated_board(&cached);
             }
         }
     }
     
     /* Send stop spectating message */
     msg_spectate_game_t stop_req;
-    snprintf(stop_req.game_id, sizeof(stop_req.game_id), "%s", selected_game->game_id);
+    memset(&stop_req, 0, sizeof(stop_req));
+    stop_req.game = selected_game->game;
     session_send_message(client_state_get_session(), MSG_STOP_SPECTATE, &stop_req, sizeof(stop_req));
     
     /* Clear spectator state */
     spectator_state_clear();
+    board_cache_clear();
     
     client_log_info(CLIENT_LOG_SPECTATOR_STOPPED);
 }
@@ -5,6 +5,7 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include "../../include/client/client_state.h"
+#include "../../include/network/board_delta.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -16,6 +17,14 @@ static session_t* g_session_ptr = NULL;
 static char g_pseudo[MAX_PSEUDO_LEN] = {0};
 static volatile bool g_running = true;
 
+/* Server endpoint */
+static struct {
+    char host[64];
+    int port;
+    char unix_path[108];
+    bool local;
+} g_endpoint;
+
 /* Pending challenges data structure */
 static struct {
     pending_challenge_t challenges[MAX_PENDING_CHALLENGES];
@@ -35,7 +44,7 @@ static struct {
 
 /* Spectator state data structure */
 static struct {
-    char game_id[MAX_GAME_ID_LEN];
+    game_handle_t game;
     char player_a[MAX_PSEUDO_LEN];
     char player_b[MAX_PSEUDO_LEN];
     bool active;
@@ -44,6 +53,32 @@ static struct {
     pthread_cond_t update_cond;
 } g_spectator_state;
 
+/* Watched board cache data structure */
+static struct {
+    game_handle_t game;
+    msg_board_state_t board;
+    bool watching;
+    bool resync_needed;
+    pthread_mutex_t lock;
+} g_board_cache;
+
+/* Response mailbox data structure */
+typedef struct {
+    uint32_t sequence;
+    bool expected;
+    bool filled;
+    bool stream;          /* Stays registered until MSG_LIST_END or MSG_ERROR */
+    message_type_t type;
+    size_t size;
+    char payload[MAX_PAYLOAD_SIZE];
+} mailbox_slot_t;
+
+static struct {
+    mailbox_slot_t slots[MAX_PENDING_REQUESTS];
+    pthread_mutex_t lock;
+    pthread_cond_t filled_cond;
+} g_response_mailbox;
+
 /* Global state access */
 session_t* client_state_get_session(void) {
     return g_session_ptr;
@@ -66,6 +101,20 @@ void client_state_set_running(bool running) {
     g_running = running;
 }
 
+void client_state_set_endpoint(const char* host, int port, const char* unix_path) {
+    memset(&g_endpoint, 0, sizeof(g_endpoint));
+    g_endpoint.local = unix_path != NULL;
+    snprintf(g_endpoint.unix_path, sizeof(g_endpoint.unix_path), "%s", unix_path ? unix_path : "");
+    snprintf(g_endpoint.host, sizeof(g_endpoint.host), "%s", host ? host : "");
+    g_endpoint.port = port;
+}
+
+error_code_t client_state_reconnect(connection_t* conn) {
+    if (g_endpoint.local) return connection_connect_unix(conn, g_endpoint.unix_path);
+    if (g_endpoint.host[0] == '\0') return ERR_INVALID_PARAM;
+    return connection_connect(conn, g_endpoint.host, g_endpoint.port);
+}
+
 /* Pending challenges implementation */
 void pending_challenges_init(void) {
     pthread_mutex_init(&g_pending_challenges.lock, NULL);
@@ -158,13 +207,12 @@ void active_games_init(void) {
     }
 }
 
-void active_games_add(const char* game_id, const char* player_a, const char* player_b, player_id_t my_side) {
+void active_games_add(game_handle_t game, const char* game_id, const char* player_a, const char* player_b, player_id_t my_side) {
     pthread_mutex_lock(&g_active_games.lock);
     
     /* Check if game already exists */
     for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
-        if (g_active_games.games[i].active && 
-            strcmp(g_active_games.games[i].game_id, game_id) == 0) {
+        if (g_active_games.games[i].active && g_active_games.games[i].game == game) {
             pthread_mutex_unlock(&g_active_games.lock);
             return;
         }
@@ -173,6 +221,7 @@ void active_games_add(const char* game_id, const char* player_a, const char* pla
     /* Add new game */
     for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
         if (!g_active_games.games[i].active) {
+            g_active_games.games[i].game = game;
             snprintf(g_active_games.games[i].game_id, MAX_GAME_ID_LEN, "%s", game_id);
             snprintf(g_active_games.games[i].player_a, MAX_PSEUDO_LEN, "%s", player_a);
             snprintf(g_active_games.games[i].player_b, MAX_PSEUDO_LEN, "%s", player_b);
@@ -185,11 +234,10 @@ void active_games_add(const char* game_id, const char* player_a, const char* pla
     pthread_mutex_unlock(&g_active_games.lock);
 }
 
-void active_games_remove(const char* game_id) {
+void active_games_remove(game_handle_t game) {
     pthread_mutex_lock(&g_active_games.lock);
     for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
-        if (g_active_games.games[i].active &&
-            strcmp(g_active_games.games[i].game_id, game_id) == 0) {
+        if (g_active_games.games[i].active && g_active_games.games[i].game == game) {
             g_active_games.games[i].active = false;
             g_active_games.count--;
             break;
@@ -309,14 +357,14 @@ void spectator_state_init(void) {
     pthread_cond_init(&g_spectator_state.update_cond, NULL);
     g_spectator_state.active = false;
     g_spectator_state.board_updated = false;
-    g_spectator_state.game_id[0] = '\0';
+    g_spectator_state.game = GAME_HANDLE_NONE;
     g_spectator_state.player_a[0] = '\0';
     g_spectator_state.player_b[0] = '\0';
 }
 
-void spectator_state_set(const char* game_id, const char* player_a, const char* player_b) {
+void spectator_state_set(game_handle_t game, const char* player_a, const char* player_b) {
     pthread_mutex_lock(&g_spectator_state.lock);
-    snprintf(g_spectator_state.game_id, sizeof(g_spectator_state.game_id), "%s", game_id);
+    g_spectator_state.game = game;
     snprintf(g_spectator_state.player_a, sizeof(g_spectator_state.player_a), "%s", player_a);
     snprintf(g_spectator_state.player_b, sizeof(g_spectator_state.player_b), "%s", player_b);
     g_spectator_state.active = true;
@@ -328,7 +376,7 @@ void spectator_state_clear(void) {
     pthread_mutex_lock(&g_spectator_state.lock);
     g_spectator_state.active = false;
     g_spectator_state.board_updated = false;
-    g_spectator_state.game_id[0] = '\0';
+    g_spectator_state.game = GAME_HANDLE_NONE;
     g_spectator_state.player_a[0] = '\0';
     g_spectator_state.player_b[0] = '\0';
     pthread_mutex_unlock(&g_spectator_state.lock);
@@ -341,8 +389,11 @@ bool spectator_state_is_active(void) {
     return active;
 }
 
-const char* spectator_state_get_game_id(void) {
-    return g_spectator_state.game_id;
+game_handle_t spectator_state_get_game(void) {
+    pthread_mutex_lock(&g_spectator_state.lock);
+    game_handle_t game = g_spectator_state.game;
+    pthread_mutex_unlock(&g_spectator_state.lock);
+    return game;
 }
 
 void spectator_state_notify_update(void) {
@@ -384,6 +435,223 @@ bool spectator_state_check_and_clear_updated(void) {
     return updated;
 }
 
+/* Watched board cache implementation */
+void board_cache_init(void) {
+    pthread_mutex_init(&g_board_cache.lock, NULL);
+    g_board_cache.watching = false;
+    g_board_cache.resync_needed = false;
+    g_board_cache.game = GAME_HANDLE_NONE;
+    memset(&g_board_cache.board, 0, sizeof(g_board_cache.board));
+}
+
+void board_cache_watch(game_handle_t game) {
+    pthread_mutex_lock(&g_board_cache.lock);
+    g_board_cache.game = game;
+    memset(&g_board_cache.board, 0, sizeof(g_board_cache.board));
+    g_board_cache.watching = true;
+    g_board_cache.resync_needed = false;
+    pthread_mutex_unlock(&g_board_cache.lock);
+}
+
+void board_cache_seed(const msg_board_state_t* board) {
+    pthread_mutex_lock(&g_board_cache.lock);
+    /* A delta may already have moved the cache past this snapshot */
+    if (g_board_cache.watching &&
+        (!g_board_cache.board.exists || board->seq >= g_board_cache.board.seq)) {
+        g_board_cache.board = *board;
+        g_board_cache.resync_needed = false;
+    }
+    pthread_mutex_unlock(&g_board_cache.lock);
+}
+
+error_code_t board_cache_apply_delta(const msg_board_delta_t* delta) {
+    pthread_mutex_lock(&g_board_cache.lock);
+    
+    if (!g_board_cache.watching || g_board_cache.game != delta->game) {
+        pthread_mutex_unlock(&g_board_cache.lock);
+        return ERR_GAME_NOT_FOUND;
+    }
+    
+    error_code_t err = board_delta_apply(&g_board_cache.board, delta);
+    if (err == SUCCESS) {
+        g_board_cache.resync_needed = false;
+    } else if (err == ERR_SEQUENCE_GAP) {
+        g_board_cache.resync_needed = true;
+    }
+    
+    pthread_mutex_unlock(&g_board_cache.lock);
+    return err;
+}
+
+bool board_cache_get(msg_board_state_t* board_out) {
+    pthread_mutex_lock(&g_board_cache.lock);
+    bool valid = g_board_cache.watching && g_board_cache.board.exists;
+    if (valid) {
+        *board_out = g_board_cache.board;
+    }
+    pthread_mutex_unlock(&g_board_cache.lock);
+    return valid;
+}
+
+bool board_cache_take_resync(void) {
+    pthread_mutex_lock(&g_board_cache.lock);
+    bool needed = g_board_cache.resync_needed;
+    g_board_cache.resync_needed = false;
+    pthread_mutex_unlock(&g_board_cache.lock);
+    return needed;
+}
+
+void board_cache_clear(void) {
+    pthread_mutex_lock(&g_board_cache.lock);
+    g_board_cache.watching = false;
+    g_board_cache.resync_needed = false;
+    g_board_cache.game = GAME_HANDLE_NONE;
+    pthread_mutex_unlock(&g_board_cache.lock);
+}
+
+/* Response mailbox implementation */
+void response_mailbox_init(void) {
+    pthread_mutex_init(&g_response_mailbox.lock, NULL);
+    pthread_cond_init(&g_response_mailbox.filled_cond, NULL);
+    for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
+        g_response_mailbox.slots[i].expected = false;
+        g_response_mailbox.slots[i].filled = false;
+    }
+}
+
+static mailbox_slot_t* response_mailbox_find(uint32_t sequence) {
+    for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
+        if (g_response_mailbox.slots[i].expected &&
+            g_response_mailbox.slots[i].sequence == sequence) {
+            return &g_response_mailbox.slots[i];
+        }
+    }
+    return NULL;
+}
+
+static error_code_t response_mailbox_register(uint32_t sequence, bool stream) {
+    pthread_mutex_lock(&g_response_mailbox.lock);
+    for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
+        mailbox_slot_t* slot = &g_response_mailbox.slots[i];
+        if (!slot->expected) {
+            slot->sequence = sequence;
+            slot->expected = true;
+            slot->filled = false;
+            slot->stream = stream;
+            pthread_mutex_unlock(&g_response_mailbox.lock);
+            return SUCCESS;
+        }
+    }
+    pthread_mutex_unlock(&g_response_mailbox.lock);
+    return ERR_MAX_CAPACITY;
+}
+
+error_code_t response_mailbox_expect(uint32_t sequence) {
+    return response_mailbox_register(sequence, false);
+}
+
+error_code_t response_mailbox_expect_stream(uint32_t sequence) {
+    return response_mailbox_register(sequence, true);
+}
+
+void response_mailbox_cancel(uint32_t sequence) {
+    pthread_mutex_lock(&g_response_mailbox.lock);
+    mailbox_slot_t* slot = response_mailbox_find(sequence);
+    if (slot) {
+        slot->expected = false;
+        slot->filled = false;
+        pthread_cond_broadcast(&g_response_mailbox.filled_cond);  /* Drops a held stream frame */
+    }
+    pthread_mutex_unlock(&g_response_mailbox.lock);
+}
+
+bool response_mailbox_deliver(uint32_t sequence, message_type_t type, const void* payload, size_t size) {
+    pthread_mutex_lock(&g_response_mailbox.lock);
+    
+    /* Late responses to cancelled (timed out) requests are dropped */
+    mailbox_slot_t* slot = response_mailbox_find(sequence);
+    
+    /* A stream's next frame waits for the command to take the previous one;
+     * the listener blocks meanwhile, which paces the server */
+    if (slot && slot->stream && slot->filled) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += STREAM_DRAIN_TIMEOUT_MS / 1000;
+        while (slot->expected && slot->sequence == sequence && slot->filled && g_running) {
+            if (pthread_cond_timedwait(&g_response_mailbox.filled_cond, &g_response_mailbox.lock, &deadline) != 0) {
+                break;
+            }
+        }
+        slot = response_mailbox_find(sequence);
+    }
+    
+    if (!slot || slot->filled || size > MAX_PAYLOAD_SIZE) {
+        pthread_mutex_unlock(&g_response_mailbox.lock);
+        return false;
+    }
+    
+    slot->type = type;
+    slot->size = size;
+    if (size > 0) {
+        memcpy(slot->payload, payload, size);
+    }
+    slot->filled = true;
+    pthread_cond_broadcast(&g_response_mailbox.filled_cond);
+    
+    pthread_mutex_unlock(&g_response_mailbox.lock);
+    return true;
+}
+
+error_code_t response_mailbox_wait(uint32_t sequence, message_type_t* type, void* payload,
+                                   size_t max_size, size_t* actual_size, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    pthread_mutex_lock(&g_response_mailbox.lock);
+    
+    mailbox_slot_t* slot = response_mailbox_find(sequence);
+    if (!slot) {
+        pthread_mutex_unlock(&g_response_mailbox.lock);
+        return ERR_INVALID_PARAM;
+    }
+    
+    while (!slot->filled && g_running) {
+        if (pthread_cond_timedwait(&g_response_mailbox.filled_cond, &g_response_mailbox.lock, &deadline) != 0) {
+            break;
+        }
+    }
+    
+    error_code_t err;
+    if (!slot->filled) {
+        err = g_running ? ERR_TIMEOUT : ERR_NETWORK_ERROR;
+    } else if (slot->size > max_size || (slot->size > 0 && !payload)) {
+        err = ERR_SERIALIZATION;
+    } else {
+        *type = slot->type;
+        if (slot->size > 0) {
+            memcpy(payload, slot->payload, slot->size);
+        }
+        if (actual_size) *actual_size = slot->size;
+        err = SUCCESS;
+    }
+    
+    /* Streams keep their slot until the closing frame */
+    if (err != SUCCESS || !slot->stream || slot->type == MSG_LIST_END || slot->type == MSG_ERROR) {
+        slot->expected = false;
+    }
+    slot->filled = false;
+    pthread_cond_broadcast(&g_response_mailbox.filled_cond);
+    
+    pthread_mutex_unlock(&g_response_mailbox.lock);
+    return err;
+}
+
 /* Initialize all client state */
 void client_state_init(session_t* session) {
     g_session_ptr = session;
@@ -391,4 +659,6 @@ void client_state_init(session_t* session) {
     pending_challenges_init();
     active_games_init();
     spectator_state_init();
+    board_cache_init();
+    response_mailbox_init();
 }
@@ -142,6 +142,13 @@ void ui_display_player_list(const msg_player_list_t* list) {
     printf(CLIENT_UI_PLAYER_LIST_FOOTER);
 }
 
+/* Entries of one streamed frame, numbered on from earlier frames */
+void ui_display_player_list_page(const msg_player_list_t* list, int first_number) {
+    for (int i = 0; i < list->count; i++) {
+        printf(CLIENT_UI_PLAYER_LIST_ITEM, first_number + i, list->players[i].pseudo);
+    }
+}
+
 void ui_display_challenge_sent(const char* opponent) {
     printf(CLIENT_UI_CHALLENGE_SENT, opponent);
     printf(CLIENT_UI_CHALLENGE_SENT_INFO);
@@ -300,7 +307,13 @@ void ui_display_game_started(const msg_game_started_t* start) {
 void ui_display_spectator_joined(const msg_spectator_joined_t* notif) {
     printf(CLIENT_UI_SPECTATOR_JOINED_HEADER);
     printf(CLIENT_UI_SPECTATOR_JOINED_TITLE, notif->spectator);
-    printf(CLIENT_UI_SPECTATOR_JOINED_ID, notif->game_id);
+    for (int i = 0; i < active_games_count(); i++) {
+        active_game_t* game = active_games_get(i);
+        if (game && game->game == notif->game) {
+            printf(CLIENT_UI_SPECTATOR_JOINED_ID, game->game_id);
+            break;
+        }
+    }
     printf(CLIENT_UI_SPECTATOR_JOINED_COUNT, notif->spectator_count);
     printf(CLIENT_UI_SPECTATOR_JOINED_SEPARATOR);
     fflush(stdout);
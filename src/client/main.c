@@ -9,6 +9,7 @@
 #include "../../include/common/messages.h"
 #include "../../include/network/connection.h"
 #include "../../include/network/session.h"
+#include "../../include/network/codec.h"
 #include "../../include/client/client_state.h"
 #include "../../include/client/client_ui.h"
 #include "../../include/client/client_commands.h"
@@ -22,33 +23,46 @@
 #include <pthread.h>
 
 /* Connection setup helper */
-static error_code_t establish_connection(const char* pseudo, const char* server_ip, session_t* session);
+static error_code_t establish_connection(const char* pseudo, const char* server_ip, const char* unix_path,
+                                         session_t* session);
+static error_code_t send_connect(const char* pseudo, session_t* session);
+
+/* CONNECT_FEATURE_* offered to the server */
+static uint32_t g_features = CONNECT_FEATURE_COMPRESSION;
 
 int main(int argc, char** argv) {
     if (argc < 2) {
         client_log_error(CLIENT_LOG_USAGE, argv[0]);
         client_log_info(CLIENT_LOG_USAGE_PSEUDO);
         client_log_info(CLIENT_LOG_USAGE_SERVER);
+        client_log_info(CLIENT_LOG_USAGE_UNIX);
+        client_log_info(CLIENT_LOG_USAGE_CHECKSUM);
         client_log_info(CLIENT_LOG_USAGE_DISCOVERY);
         return 1;
     }
 
-    /* Parse optional args: allow -s server_ip before or after pseudo */
+    /* Parse optional args: allow -s server_ip / -u socket_path before or after pseudo.
+     * The first non-option argument is the pseudo. */
     const char* server_ip = NULL;
+    const char* unix_path = NULL;
+    const char* pseudo = NULL;
     for (int i = 1; i < argc; i++) {
         if ((strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--server-ip") == 0) && i + 1 < argc) {
             server_ip = argv[i + 1];
             i++; /* skip next */
             continue;
         }
-    }
-
-    /* The first non-option argument is the pseudo */
-    const char* pseudo = NULL;
-    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-u") == 0 || strcmp(argv[i], "--unix") == 0) && i + 1 < argc) {
+            unix_path = argv[i + 1];
+            i++; /* skip next */
+            continue;
+        }
+        if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--checksum") == 0) {
+            g_features |= CONNECT_FEATURE_CHECKSUM;
+            continue;
+        }
         if (argv[i][0] == '-') continue;
-        pseudo = argv[i];
-        break;
+        if (!pseudo) pseudo = argv[i];
     }
     if (!pseudo) {
         client_log_error(CLIENT_LOG_MISSING_PSEUDO, argv[0]);
@@ -61,7 +75,7 @@ int main(int argc, char** argv) {
     
     /* Establish connection */
     session_t g_session;
-    if (establish_connection(pseudo, server_ip, &g_session) != SUCCESS) {
+    if (establish_connection(pseudo, server_ip, unix_path, &g_session) != SUCCESS) {
         return 1;
     }
     
@@ -100,8 +114,9 @@ int main(int argc, char** argv) {
             case 12: cmd_view_saved_game(); break;
             case 13:
                 client_log_info(CLIENT_LOG_DISCONNECTING);
-                session_send_message(&g_session, MSG_DISCONNECT, NULL, 0);
+                /* Stop first so the listener does not treat the close as a lost connection */
                 client_state_set_running(false);
+                session_send_message(&g_session, MSG_DISCONNECT, NULL, 0);
                 break;
             default:
                 client_log_warning(CLIENT_LOG_INVALID_CHOICE);
@@ -118,10 +133,24 @@ int main(int argc, char** argv) {
 }
 
 /* Connection establishment (UDP discovery + bidirectional setup) */
-static error_code_t establish_connection(const char* pseudo, const char* server_ip, session_t* session) {
+static error_code_t establish_connection(const char* pseudo, const char* server_ip, const char* unix_path,
+                                         session_t* session) {
     discovery_response_t discovery;
     error_code_t err = SUCCESS;
 
+    if (unix_path != NULL) {
+        /* Local server: no discovery, no TCP */
+        session_init(session);
+        err = connection_connect_unix(&session->conn, unix_path);
+        if (err != SUCCESS) {
+            client_log_error(CLIENT_LOG_CONNECTION_FAILED);
+            return err;
+        }
+        client_log_info(CLIENT_LOG_CONNECTED_UNIX, unix_path);
+        client_state_set_endpoint(NULL, 0, unix_path);
+        return send_connect(pseudo, session);
+    }
+
     if (server_ip == NULL) {
         client_log_info(CLIENT_LOG_BROADCAST_DISCOVERY);
         /* Step 1: UDP broadcast to discover server */
@@ -140,7 +169,7 @@ static error_code_t establish_connection(const char* pseudo, const char* server_
     }
     
     /* Connect to server discovery port (single socket for all communication) */
-    connection_init(&session->conn);
+    session_init(session);
     err = connection_connect(&session->conn, (server_ip != NULL) ? server_ip : discovery.server_ip, discovery.discovery_port);
     if (err != SUCCESS) {
         client_log_error(CLIENT_LOG_CONNECTION_FAILED);
@@ -148,12 +177,21 @@ static error_code_t establish_connection(const char* pseudo, const char* server_
     }
     
     client_log_info(CLIENT_LOG_CONNECTED, (server_ip != NULL) ? server_ip : discovery.server_ip, discovery.discovery_port);
+    client_state_set_endpoint((server_ip != NULL) ? server_ip : discovery.server_ip, discovery.discovery_port, NULL);
+    return send_connect(pseudo, session);
+}
+
+/* MSG_CONNECT / MSG_CONNECT_ACK handshake, whatever the transport */
+static error_code_t send_connect(const char* pseudo, session_t* session) {
+    error_code_t err;
 
     /* Send MSG_CONNECT */
     msg_connect_t connect_msg;
     memset(&connect_msg, 0, sizeof(connect_msg));
     snprintf(connect_msg.pseudo, MAX_PSEUDO_LEN, "%s", pseudo);
-    snprintf(connect_msg.version, 16, "%s", PROTOCOL_VERSION);
+    /* Offer the compact codec; a 1.0 server answers without it and we stay raw */
+    snprintf(connect_msg.version, 16, "%s", PROTOCOL_VERSION_COMPACT);
+    connect_msg.features = g_features;
     
     err = session_send_message(session, MSG_CONNECT, &connect_msg, sizeof(connect_msg));
     if (err != SUCCESS) {
@@ -166,6 +204,7 @@ static error_code_t establish_connection(const char* pseudo, const char* server_
     message_type_t type;
     msg_connect_ack_t ack;
     size_t size;
+    memset(&ack, 0, sizeof(ack));
 
     err = session_recv_message_timeout(session, &type, &ack, sizeof(ack), &size, 10000, NULL, 0);  /* 10 second timeout */
     if (err == ERR_TIMEOUT) {
@@ -187,6 +226,9 @@ static error_code_t establish_connection(const char* pseudo, const char* server_
     
     client_log_info(CLIENT_LOG_CONNECTION_SUCCESS, ack.message);
     snprintf(session->session_id, sizeof(session->session_id), "%s", ack.session_id);
+    ack.version[sizeof(ack.version) - 1] = '\0';
+    session->codec = codec_for_version(ack.version);
+    session->features = ack.features;
     session->authenticated = true;
     
     return SUCCESS;
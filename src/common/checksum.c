@@ -0,0 +1,152 @@
+/* Checksum Implementation
+ * The CRC register is kept inverted, as zlib does, so results chain. The
+ * portable path reads 8 bytes at a time through 8 tables of 256 entries.
+ * The SSE4.2 path runs the crc32 instruction on three independent streams
+ * of CHECKSUM_STREAM bytes, which hides its 3-cycle latency, then shifts the
+ * first two results over the bytes after them with CHECKSUM_STREAM and
+ * 2 * CHECKSUM_STREAM zero-byte operators and XORs them together.
+ */
+
+#include "../../include/common/checksum.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CHECKSUM_SSE42 1
+#include <nmmintrin.h>
+#endif
+
+#define CRC32C_POLY 0x82F63B78u     /* Reflected Castagnoli polynomial */
+#define CHECKSUM_STREAM 256         /* Bytes per stream and round */
+
+static uint32_t g_slices[8][256];
+static bool g_hardware;
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+#ifdef CHECKSUM_SSE42
+static uint32_t g_shift[2][4][256];  /* Zero-byte operators: [0] one stream, [1] two */
+#endif
+
+static uint64_t get_le64(const uint8_t* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#else
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+#endif
+    return v;
+}
+
+/* Register after `size` bytes, no inversion */
+static uint32_t slice_update(uint32_t crc, const uint8_t* p, size_t size) {
+    while (size >= 8) {
+        uint64_t word = get_le64(p) ^ crc;
+        crc = g_slices[7][word & 0xFF] ^ g_slices[6][(word >> 8) & 0xFF] ^
+              g_slices[5][(word >> 16) & 0xFF] ^ g_slices[4][(word >> 24) & 0xFF] ^
+              g_slices[3][(word >> 32) & 0xFF] ^ g_slices[2][(word >> 40) & 0xFF] ^
+              g_slices[1][(word >> 48) & 0xFF] ^ g_slices[0][word >> 56];
+        p += 8;
+        size -= 8;
+    }
+    while (size--) crc = (crc >> 8) ^ g_slices[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#ifdef CHECKSUM_SSE42
+/* Register after `zeros` zero bytes */
+static uint32_t shift_slow(uint32_t crc, size_t zeros) {
+    while (zeros--) crc = (crc >> 8) ^ g_slices[0][crc & 0xFF];
+    return crc;
+}
+
+static uint32_t shift(uint32_t (*table)[256], uint32_t crc) {
+    return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^
+           table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+}
+
+/* Shifting is linear in the register: tabulate it from the 32 single bits */
+static void build_shift(uint32_t (*table)[256], size_t zeros) {
+    uint32_t bit[32];
+    for (int i = 0; i < 32; i++) bit[i] = shift_slow(1u << i, zeros);
+    for (int k = 0; k < 4; k++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t v = 0;
+            for (int i = 0; i < 8; i++) {
+                if (b & (1u << i)) v ^= bit[k * 8 + i];
+            }
+            table[k][b] = v;
+        }
+    }
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t hardware_update(uint32_t crc, const uint8_t* p, size_t size) {
+    while (size > 0 && ((uintptr_t)p & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+        size--;
+    }
+
+    while (size >= 3 * CHECKSUM_STREAM) {
+        uint64_t a = crc, b = 0, c = 0;
+        const uint8_t* end = p + CHECKSUM_STREAM;
+        for (; p < end; p += 8) {
+            a = _mm_crc32_u64(a, get_le64(p));
+            b = _mm_crc32_u64(b, get_le64(p + CHECKSUM_STREAM));
+            c = _mm_crc32_u64(c, get_le64(p + 2 * CHECKSUM_STREAM));
+        }
+        crc = shift(g_shift[1], (uint32_t)a) ^ shift(g_shift[0], (uint32_t)b) ^ (uint32_t)c;
+        p += 2 * CHECKSUM_STREAM;
+        size -= 3 * CHECKSUM_STREAM;
+    }
+
+    uint64_t c = crc;
+    for (; size >= 8; p += 8, size -= 8) c = _mm_crc32_u64(c, get_le64(p));
+    crc = (uint32_t)c;
+    while (size--) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+#endif
+
+static void checksum_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+        g_slices[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int s = 1; s < 8; s++) {
+            g_slices[s][i] = (g_slices[s - 1][i] >> 8) ^ g_slices[0][g_slices[s - 1][i] & 0xFF];
+        }
+    }
+
+#ifdef CHECKSUM_SSE42
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        build_shift(g_shift[0], CHECKSUM_STREAM);
+        build_shift(g_shift[1], 2 * CHECKSUM_STREAM);
+        g_hardware = true;
+    }
+#endif
+}
+
+uint32_t checksum_crc32c(uint32_t crc, const void* data, size_t size) {
+    pthread_once(&g_once, checksum_init);
+    if (!data) return crc;
+#ifdef CHECKSUM_SSE42
+    if (g_hardware) return ~hardware_update(~crc, data, size);
+#endif
+    return ~slice_update(~crc, data, size);
+}
+
+uint32_t checksum_crc32c_portable(uint32_t crc, const void* data, size_t size) {
+    pthread_once(&g_once, checksum_init);
+    if (!data) return crc;
+    return ~slice_update(~crc, data, size);
+}
+
+const char* checksum_implementation(void) {
+    pthread_once(&g_once, checksum_init);
+    return g_hardware ? "sse4.2" : "slicing-by-8";
+}
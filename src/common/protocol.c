@@ -17,6 +17,13 @@ const char* message_type_to_string(message_type_t type) {
         case MSG_PLAY_MOVE: return "PLAY_MOVE";
         case MSG_GET_BOARD: return "GET_BOARD";
         case MSG_SURRENDER: return "SURRENDER";
+        case MSG_LIST_GAMES: return "LIST_GAMES";
+        case MSG_LIST_MY_GAMES: return "LIST_MY_GAMES";
+        case MSG_SPECTATE_GAME: return "SPECTATE_GAME";
+        case MSG_STOP_SPECTATE: return "STOP_SPECTATE";
+        case MSG_SET_BIO: return "SET_BIO";
+        case MSG_GET_BIO: return "GET_BIO";
+        case MSG_GET_PLAYER_STATS: return "GET_PLAYER_STATS";
         case MSG_CONNECT_ACK: return "CONNECT_ACK";
         case MSG_ERROR: return "ERROR";
         case MSG_PLAYER_LIST: return "PLAYER_LIST";
@@ -30,10 +37,29 @@ const char* message_type_to_string(message_type_t type) {
         case MSG_SEND_CHAT: return "SEND_CHAT";
         case MSG_CHAT_MESSAGE: return "CHAT_MESSAGE";
         case MSG_CHAT_HISTORY: return "CHAT_HISTORY";
+        case MSG_ADD_FRIEND: return "ADD_FRIEND";
+        case MSG_REMOVE_FRIEND: return "REMOVE_FRIEND";
+        case MSG_LIST_FRIENDS: return "LIST_FRIENDS";
+        case MSG_LIST_SAVED_GAMES: return "LIST_SAVED_GAMES";
+        case MSG_VIEW_SAVED_GAME: return "VIEW_SAVED_GAME";
+        case MSG_SAVED_GAME_LIST: return "SAVED_GAME_LIST";
+        case MSG_SAVED_GAME_STATE: return "SAVED_GAME_STATE";
+        case MSG_GAME_LIST: return "GAME_LIST";
+        case MSG_MY_GAME_LIST: return "MY_GAME_LIST";
+        case MSG_SPECTATE_ACK: return "SPECTATE_ACK";
+        case MSG_SPECTATOR_JOINED: return "SPECTATOR_JOINED";
+        case MSG_BIO_RESPONSE: return "BIO_RESPONSE";
+        case MSG_PLAYER_STATS: return "PLAYER_STATS";
+        case MSG_BOARD_DELTA: return "BOARD_DELTA";
+        case MSG_BOARD_RESYNC: return "BOARD_RESYNC";
+        case MSG_LIST_PAGE: return "LIST_PAGE";
+        case MSG_LIST_END: return "LIST_END";
+        case MSG_RESUME: return "RESUME";
+        case MSG_RESUME_ACK: return "RESUME_ACK";
         default: return NULL;
     }
 }
 
 bool is_valid_message_type(message_type_t type) {
-    return type > MSG_UNKNOWN && type <= MSG_PLAYER_STATS;
+    return type > MSG_UNKNOWN && type <= MSG_RESUME_ACK;
 }
@@ -21,6 +21,7 @@ const char* error_to_string(error_code_t err) {
         case ERR_RATE_LIMITED: return "Rate limited";
         case ERR_TOO_MANY_DECLINES: return "Too many declines";
         case ERR_UNEXPECTED_MESSAGE: return "Unexpected message type";
+        case ERR_SEQUENCE_GAP: return "Sequence gap";
         default: return NULL;
     }
 }
@@ -0,0 +1,121 @@
+#define _POSIX_C_SOURCE 200809L
+
+/* Board Delta Encoding
+ * Builds and applies MSG_BOARD_DELTA payloads
+ */
+
+#include "../../include/network/board_delta.h"
+#include <string.h>
+
+static void board_delta_fill_common(const board_t* board, game_handle_t game,
+                                    uint32_t seq, msg_board_delta_t* delta) {
+    memset(delta, 0, sizeof(*delta));
+    delta->game = game;
+    delta->seq = seq;
+    delta->current_player = (uint8_t)board->current_player;
+    delta->state = (uint8_t)board->state;
+    delta->winner = (int8_t)board->winner;
+}
+
+void board_delta_build(const board_t* before, const board_t* after, game_handle_t game,
+                       uint32_t seq, int pit_played, msg_board_delta_t* delta) {
+    if (!before || !after || !delta) return;
+
+    if (board_delta_is_keyframe_seq(seq)) {
+        board_delta_build_keyframe(after, game, seq, delta);
+        delta->pit_played = (int8_t)pit_played;
+        return;
+    }
+
+    board_delta_fill_common(after, game, seq, delta);
+    delta->pit_played = (int8_t)pit_played;
+    delta->score_a = (int8_t)(after->scores[0] - before->scores[0]);
+    delta->score_b = (int8_t)(after->scores[1] - before->scores[1]);
+
+    for (int i = 0; i < NUM_PITS; i++) {
+        if (after->pits[i] != before->pits[i]) {
+            delta->changed[delta->changed_count].pit = (uint8_t)i;
+            delta->changed[delta->changed_count].seeds = (uint8_t)after->pits[i];
+            delta->changed_count++;
+        }
+    }
+}
+
+void board_delta_build_keyframe(const board_t* board, game_handle_t game,
+                                uint32_t seq, msg_board_delta_t* delta) {
+    if (!board || !delta) return;
+
+    board_delta_fill_common(board, game, seq, delta);
+    delta->flags = BOARD_DELTA_KEYFRAME;
+    delta->pit_played = -1;
+    delta->score_a = (int8_t)board->scores[0];
+    delta->score_b = (int8_t)board->scores[1];
+    delta->changed_count = NUM_PITS;
+    for (int i = 0; i < NUM_PITS; i++) {
+        delta->changed[i].pit = (uint8_t)i;
+        delta->changed[i].seeds = (uint8_t)board->pits[i];
+    }
+}
+
+bool board_delta_is_keyframe_seq(uint32_t seq) {
+    return seq % BOARD_KEYFRAME_INTERVAL == 0;
+}
+
+size_t board_delta_wire_size(const msg_board_delta_t* delta) {
+    if (!delta) return 0;
+    size_t count = MIN(delta->changed_count, (uint8_t)NUM_PITS);
+    return offsetof(msg_board_delta_t, changed) + count * sizeof(board_delta_pit_t);
+}
+
+error_code_t board_delta_validate(const msg_board_delta_t* delta, size_t size) {
+    if (!delta) return ERR_INVALID_PARAM;
+
+    /* Fixed part plus exactly the changed[] entries it announces */
+    if (size < offsetof(msg_board_delta_t, changed) || size > sizeof(msg_board_delta_t)) {
+        return ERR_SERIALIZATION;
+    }
+    if (delta->changed_count > NUM_PITS) return ERR_SERIALIZATION;
+    if (size != board_delta_wire_size(delta)) return ERR_SERIALIZATION;
+    for (int i = 0; i < delta->changed_count; i++) {
+        if (delta->changed[i].pit >= NUM_PITS) return ERR_SERIALIZATION;
+    }
+    if (delta->current_player > PLAYER_B) return ERR_SERIALIZATION;
+
+    return SUCCESS;
+}
+
+error_code_t board_delta_apply(msg_board_state_t* board, const msg_board_delta_t* delta) {
+    if (!board || !delta) return ERR_INVALID_PARAM;
+
+    bool keyframe = (delta->flags & BOARD_DELTA_KEYFRAME) != 0;
+
+    if (keyframe) {
+        if (board->exists && delta->seq < board->seq) return ERR_DUPLICATE;
+    } else {
+        if (!board->exists) return ERR_SEQUENCE_GAP;
+        if (delta->seq <= board->seq) return ERR_DUPLICATE;
+        if (delta->seq != board->seq + 1) return ERR_SEQUENCE_GAP;
+    }
+
+    for (int i = 0; i < delta->changed_count && i < NUM_PITS; i++) {
+        if (delta->changed[i].pit < NUM_PITS) {
+            board->pits[delta->changed[i].pit] = delta->changed[i].seeds;
+        }
+    }
+
+    if (keyframe) {
+        board->score_a = delta->score_a;
+        board->score_b = delta->score_b;
+    } else {
+        board->score_a += delta->score_a;
+        board->score_b += delta->score_b;
+    }
+
+    board->current_player = (player_id_t)delta->current_player;
+    board->state = (game_state_t)delta->state;
+    board->winner = (winner_t)delta->winner;
+    board->seq = delta->seq;
+    board->exists = true;
+
+    return SUCCESS;
+}
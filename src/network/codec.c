@@ -0,0 +1,1021 @@
+/* Compact Payload Codec
+ * Per-type encoders/decoders built on the varint and length-prefixed string
+ * primitives in serialization.c
+ */
+
+#include "../../include/network/codec.h"
+#include "../../include/network/serialization.h"
+#include "../../include/common/messages.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+_Static_assert(sizeof(msg_saved_game_list_t) == sizeof(msg_game_list_t),
+               "saved game list shares the game list encoding");
+_Static_assert(sizeof(msg_challenge_decline_t) == sizeof(msg_challenge_accept_t),
+               "challenge decline shares the challenge accept encoding");
+
+typedef error_code_t (*codec_encode_fn)(serialize_buffer_t* buffer, const void* payload, size_t payload_size);
+typedef error_code_t (*codec_decode_fn)(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                        size_t* payload_size);
+
+/* fixed_size != 0: the struct is always sent whole; codec_decode checks
+ * room for it and zeroes it first. fixed_size == 0: the decoder sizes
+ * the output itself (lists, board deltas). */
+typedef struct {
+    message_type_t type;
+    codec_encode_fn encode;
+    codec_decode_fn decode;
+    size_t fixed_size;
+} codec_entry_t;
+
+/* ========== Field helpers ========== */
+
+static error_code_t decode_int(serialize_buffer_t* buffer, int* value) {
+    int64_t raw;
+    error_code_t err = deserialize_svarint(buffer, &raw);
+    if (err != SUCCESS) return err;
+    if (raw < INT32_MIN || raw > INT32_MAX) return ERR_SERIALIZATION;
+    *value = (int)raw;
+    return SUCCESS;
+}
+
+static error_code_t decode_count(serialize_buffer_t* buffer, int max_count, int* count) {
+    uint64_t raw;
+    error_code_t err = deserialize_varint(buffer, &raw);
+    if (err != SUCCESS) return err;
+    if (raw > (uint64_t)max_count) return ERR_SERIALIZATION;
+    *count = (int)raw;
+    return SUCCESS;
+}
+
+static error_code_t decode_u32(serialize_buffer_t* buffer, uint32_t* value) {
+    uint64_t raw;
+    error_code_t err = deserialize_varint(buffer, &raw);
+    if (err != SUCCESS) return err;
+    if (raw > UINT32_MAX) return ERR_SERIALIZATION;
+    *value = (uint32_t)raw;
+    return SUCCESS;
+}
+
+/* Raw list payloads are cut after the last used entry */
+static error_code_t list_size(size_t header, size_t item, int count, size_t max_payload_size,
+                              size_t* payload_size) {
+    size_t size = header + (size_t)count * item;
+    if (size > max_payload_size) return ERR_SERIALIZATION;
+    *payload_size = size;
+    return SUCCESS;
+}
+
+static error_code_t encode_list_count(serialize_buffer_t* buffer, int count, int max_count,
+                                      size_t header, size_t item, size_t payload_size) {
+    if (count < 0 || count > max_count) return ERR_INVALID_PARAM;
+    if (payload_size < header + (size_t)count * item) return ERR_INVALID_PARAM;
+    return serialize_varint(buffer, (uint64_t)count);
+}
+
+static error_code_t decode_handle(serialize_buffer_t* buffer, game_handle_t* handle) {
+    uint64_t raw;
+    error_code_t err = deserialize_varint(buffer, &raw);
+    if (err != SUCCESS) return err;
+    *handle = (game_handle_t)raw;
+    return SUCCESS;
+}
+
+/* ========== Single-field payloads ========== */
+
+/* resync, spectate, stop spectate: the handle is the whole payload */
+static error_code_t encode_game_handle(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    return serialize_varint(buffer, *(const game_handle_t*)payload);
+}
+
+static error_code_t decode_game_handle(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                       size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    return decode_handle(buffer, (game_handle_t*)payload);
+}
+
+/* view saved game */
+static error_code_t encode_game_ref(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    return serialize_lstring(buffer, (const char*)payload, MAX_GAME_ID_LEN);
+}
+
+static error_code_t decode_game_ref(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                    size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    return deserialize_lstring(buffer, (char*)payload, MAX_GAME_ID_LEN);
+}
+
+/* challenge response, get bio, get stats, add/remove friend, list saved games */
+static error_code_t encode_player_ref(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    return serialize_lstring(buffer, (const char*)payload, MAX_PSEUDO_LEN);
+}
+
+static error_code_t decode_player_ref(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                      size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    return deserialize_lstring(buffer, (char*)payload, MAX_PSEUDO_LEN);
+}
+
+/* ========== Connection ========== */
+
+static error_code_t encode_port_negotiation(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_port_negotiation_t* msg = payload;
+    return serialize_svarint(buffer, msg->my_port);
+}
+
+static error_code_t decode_port_negotiation(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                            size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_port_negotiation_t* msg = payload;
+    return decode_int(buffer, &msg->my_port);
+}
+
+static error_code_t encode_connect(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_connect_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_lstring(buffer, msg->pseudo, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->version, sizeof(msg->version))) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->features)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_connect(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                   size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_connect_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_lstring(buffer, msg->pseudo, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->version, sizeof(msg->version))) != SUCCESS) return err;
+    if ((err = decode_u32(buffer, &msg->features)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_connect_ack(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_connect_ack_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_bool(buffer, msg->success)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->session_id, sizeof(msg->session_id))) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->version, sizeof(msg->version))) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->features)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_connect_ack(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                       size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_connect_ack_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_bool(buffer, &msg->success)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->session_id, sizeof(msg->session_id))) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->version, sizeof(msg->version))) != SUCCESS) return err;
+    if ((err = decode_u32(buffer, &msg->features)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_error(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_error_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_svarint(buffer, msg->error_code)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->error_msg, sizeof(msg->error_msg))) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->retry_after_ms)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_error(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                 size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_error_t* msg = payload;
+    error_code_t err;
+    if ((err = decode_int(buffer, &msg->error_code)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->error_msg, sizeof(msg->error_msg))) != SUCCESS) return err;
+    if ((err = decode_u32(buffer, &msg->retry_after_ms)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+/* ========== Players and challenges ========== */
+
+static error_code_t encode_player_list(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    const msg_player_list_t* msg = payload;
+    error_code_t err;
+    if ((err = encode_list_count(buffer, msg->count, 100, offsetof(msg_player_list_t, players),
+                                 sizeof(player_list_item_t), payload_size)) != SUCCESS) return err;
+    for (int i = 0; i < msg->count; i++) {
+        if ((err = serialize_lstring(buffer, msg->players[i].pseudo, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+        if ((err = serialize_lstring(buffer, msg->players[i].ip, MAX_IP_LEN)) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+static error_code_t decode_player_list(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                       size_t* payload_size) {
+    msg_player_list_t* msg = payload;
+    int count;
+    error_code_t err;
+    if ((err = decode_count(buffer, 100, &count)) != SUCCESS) return err;
+    if ((err = list_size(offsetof(msg_player_list_t, players), sizeof(player_list_item_t), count,
+                         max_payload_size, payload_size)) != SUCCESS) return err;
+    memset(msg, 0, *payload_size);
+    msg->count = count;
+    for (int i = 0; i < count; i++) {
+        if ((err = deserialize_lstring(buffer, msg->players[i].pseudo, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+        if ((err = deserialize_lstring(buffer, msg->players[i].ip, MAX_IP_LEN)) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+static error_code_t encode_challenge(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_challenge_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_lstring(buffer, msg->challenger, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->opponent, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_challenge(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                     size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_challenge_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_lstring(buffer, msg->challenger, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->opponent, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+/* MSG_CHALLENGE_ACCEPT and MSG_CHALLENGE_DECLINE */
+static error_code_t encode_challenge_reply(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_challenge_accept_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_svarint(buffer, msg->challenge_id)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->response, sizeof(msg->response))) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_challenge_reply(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                           size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_challenge_accept_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_svarint(buffer, &msg->challenge_id)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->response, sizeof(msg->response))) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_challenge_received(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_challenge_received_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_lstring(buffer, msg->from, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->challenge_id)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_challenge_received(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                              size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_challenge_received_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_lstring(buffer, msg->from, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    if ((err = deserialize_svarint(buffer, &msg->challenge_id)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_challenge_list(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    const msg_challenge_list_t* msg = payload;
+    error_code_t err;
+    if ((err = encode_list_count(buffer, msg->count, 100, offsetof(msg_challenge_list_t, challengers),
+                                 MAX_PSEUDO_LEN, payload_size)) != SUCCESS) return err;
+    for (int i = 0; i < msg->count; i++) {
+        if ((err = serialize_lstring(buffer, msg->challengers[i], MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+static error_code_t decode_challenge_list(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                          size_t* payload_size) {
+    msg_challenge_list_t* msg = payload;
+    int count;
+    error_code_t err;
+    if ((err = decode_count(buffer, 100, &count)) != SUCCESS) return err;
+    if ((err = list_size(offsetof(msg_challenge_list_t, challengers), MAX_PSEUDO_LEN, count,
+                         max_payload_size, payload_size)) != SUCCESS) return err;
+    memset(msg, 0, *payload_size);
+    msg->count = count;
+    for (int i = 0; i < count; i++) {
+        if ((err = deserialize_lstring(buffer, msg->challengers[i], MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+/* ========== Games ========== */
+
+static error_code_t encode_game_started(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_game_started_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->your_side)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_game_started(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                        size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_game_started_t* msg = payload;
+    int side;
+    error_code_t err;
+    if ((err = decode_handle(buffer, &msg->game)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &side)) != SUCCESS) return err;
+    msg->your_side = (player_id_t)side;
+    return SUCCESS;
+}
+
+static error_code_t encode_play_move(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_play_move_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->pit_index)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_play_move(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                     size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_play_move_t* msg = payload;
+    error_code_t err;
+    if ((err = decode_handle(buffer, &msg->game)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->pit_index)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_move_result(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_move_result_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_bool(buffer, msg->success)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->seeds_captured)) != SUCCESS) return err;
+    if ((err = serialize_bool(buffer, msg->game_over)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->winner)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_move_result(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                       size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_move_result_t* msg = payload;
+    int winner;
+    error_code_t err;
+    if ((err = deserialize_bool(buffer, &msg->success)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->seeds_captured)) != SUCCESS) return err;
+    if ((err = deserialize_bool(buffer, &msg->game_over)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &winner)) != SUCCESS) return err;
+    msg->winner = (winner_t)winner;
+    return SUCCESS;
+}
+
+static error_code_t encode_get_board(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_get_board_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_get_board(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                     size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_get_board_t* msg = payload;
+    error_code_t err;
+    if ((err = decode_handle(buffer, &msg->game)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+/* MSG_BOARD_STATE and MSG_SAVED_GAME_STATE */
+static error_code_t encode_board_state(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_board_state_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_bool(buffer, msg->exists)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    for (int i = 0; i < NUM_PITS; i++) {
+        if ((err = serialize_svarint(buffer, msg->pits[i])) != SUCCESS) return err;
+    }
+    if ((err = serialize_svarint(buffer, msg->score_a)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->score_b)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->current_player)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->state)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->winner)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->seq)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_board_state(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                       size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_board_state_t* msg = payload;
+    int current_player, state, winner;
+    uint64_t seq;
+    error_code_t err;
+    if ((err = deserialize_bool(buffer, &msg->exists)) != SUCCESS) return err;
+    if ((err = decode_handle(buffer, &msg->game)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    for (int i = 0; i < NUM_PITS; i++) {
+        if ((err = decode_int(buffer, &msg->pits[i])) != SUCCESS) return err;
+    }
+    if ((err = decode_int(buffer, &msg->score_a)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->score_b)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &current_player)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &state)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &winner)) != SUCCESS) return err;
+    if ((err = deserialize_varint(buffer, &seq)) != SUCCESS) return err;
+    if (seq > UINT32_MAX) return ERR_SERIALIZATION;
+    msg->current_player = (player_id_t)current_player;
+    msg->state = (game_state_t)state;
+    msg->winner = (winner_t)winner;
+    msg->seq = (uint32_t)seq;
+    return SUCCESS;
+}
+
+static error_code_t encode_board_delta(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    const msg_board_delta_t* msg = payload;
+    /* Raw deltas are cut after the last changed[] entry */
+    if (payload_size < offsetof(msg_board_delta_t, changed)) return ERR_INVALID_PARAM;
+    if (msg->changed_count > NUM_PITS) return ERR_INVALID_PARAM;
+    if (payload_size < offsetof(msg_board_delta_t, changed) + msg->changed_count * sizeof(board_delta_pit_t)) {
+        return ERR_INVALID_PARAM;
+    }
+
+    error_code_t err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->seq)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->flags)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->pit_played)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->current_player)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->state)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->winner)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->score_a)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->score_b)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->changed_count)) != SUCCESS) return err;
+    for (int i = 0; i < msg->changed_count; i++) {
+        if ((err = serialize_varint(buffer, msg->changed[i].pit)) != SUCCESS) return err;
+        if ((err = serialize_varint(buffer, msg->changed[i].seeds)) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+static error_code_t decode_byte(serialize_buffer_t* buffer, uint8_t* value) {
+    uint64_t raw;
+    error_code_t err = deserialize_varint(buffer, &raw);
+    if (err != SUCCESS) return err;
+    if (raw > UINT8_MAX) return ERR_SERIALIZATION;
+    *value = (uint8_t)raw;
+    return SUCCESS;
+}
+
+static error_code_t decode_small(serialize_buffer_t* buffer, int8_t* value) {
+    int64_t raw;
+    error_code_t err = deserialize_svarint(buffer, &raw);
+    if (err != SUCCESS) return err;
+    if (raw < INT8_MIN || raw > INT8_MAX) return ERR_SERIALIZATION;
+    *value = (int8_t)raw;
+    return SUCCESS;
+}
+
+static error_code_t decode_board_delta(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                       size_t* payload_size) {
+    msg_board_delta_t delta;
+    uint64_t seq;
+    int count;
+    error_code_t err;
+
+    memset(&delta, 0, sizeof(delta));
+    if ((err = decode_handle(buffer, &delta.game)) != SUCCESS) return err;
+    if ((err = deserialize_varint(buffer, &seq)) != SUCCESS) return err;
+    if (seq > UINT32_MAX) return ERR_SERIALIZATION;
+    delta.seq = (uint32_t)seq;
+    if ((err = decode_byte(buffer, &delta.flags)) != SUCCESS) return err;
+    if ((err = decode_small(buffer, &delta.pit_played)) != SUCCESS) return err;
+    if ((err = decode_byte(buffer, &delta.current_player)) != SUCCESS) return err;
+    if ((err = decode_byte(buffer, &delta.state)) != SUCCESS) return err;
+    if ((err = decode_small(buffer, &delta.winner)) != SUCCESS) return err;
+    if ((err = decode_small(buffer, &delta.score_a)) != SUCCESS) return err;
+    if ((err = decode_small(buffer, &delta.score_b)) != SUCCESS) return err;
+    if ((err = decode_count(buffer, NUM_PITS, &count)) != SUCCESS) return err;
+    delta.changed_count = (uint8_t)count;
+    for (int i = 0; i < count; i++) {
+        if ((err = decode_byte(buffer, &delta.changed[i].pit)) != SUCCESS) return err;
+        if ((err = decode_byte(buffer, &delta.changed[i].seeds)) != SUCCESS) return err;
+    }
+
+    /* Same truncated layout a raw sender uses */
+    size_t size = offsetof(msg_board_delta_t, changed) + (size_t)count * sizeof(board_delta_pit_t);
+    if (size > max_payload_size) return ERR_SERIALIZATION;
+    memcpy(payload, &delta, size);
+    *payload_size = size;
+    return SUCCESS;
+}
+
+static error_code_t encode_game_over(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_game_over_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->winner)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->score_a)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->score_b)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_game_over(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                     size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_game_over_t* msg = payload;
+    int winner;
+    error_code_t err;
+    if ((err = decode_handle(buffer, &msg->game)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &winner)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->score_a)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->score_b)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    msg->winner = (winner_t)winner;
+    return SUCCESS;
+}
+
+/* MSG_GAME_LIST, MSG_MY_GAME_LIST and MSG_SAVED_GAME_LIST */
+static error_code_t encode_game_list(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    const msg_game_list_t* msg = payload;
+    error_code_t err;
+    if ((err = encode_list_count(buffer, msg->count, 50, offsetof(msg_game_list_t, games),
+                                 sizeof(game_info_t), payload_size)) != SUCCESS) return err;
+    for (int i = 0; i < msg->count; i++) {
+        const game_info_t* game = &msg->games[i];
+        if ((err = serialize_varint(buffer, game->game)) != SUCCESS) return err;
+        if ((err = serialize_lstring(buffer, game->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
+        if ((err = serialize_lstring(buffer, game->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+        if ((err = serialize_lstring(buffer, game->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+        if ((err = serialize_svarint(buffer, game->spectator_count)) != SUCCESS) return err;
+        if ((err = serialize_svarint(buffer, game->state)) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+static error_code_t decode_game_list(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                     size_t* payload_size) {
+    msg_game_list_t* msg = payload;
+    int count, state;
+    error_code_t err;
+    if ((err = decode_count(buffer, 50, &count)) != SUCCESS) return err;
+    if ((err = list_size(offsetof(msg_game_list_t, games), sizeof(game_info_t), count,
+                         max_payload_size, payload_size)) != SUCCESS) return err;
+    memset(msg, 0, *payload_size);
+    msg->count = count;
+    for (int i = 0; i < count; i++) {
+        game_info_t* game = &msg->games[i];
+        if ((err = decode_handle(buffer, &game->game)) != SUCCESS) return err;
+        if ((err = deserialize_lstring(buffer, game->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
+        if ((err = deserialize_lstring(buffer, game->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+        if ((err = deserialize_lstring(buffer, game->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+        if ((err = decode_int(buffer, &game->spectator_count)) != SUCCESS) return err;
+        if ((err = decode_int(buffer, &state)) != SUCCESS) return err;
+        game->state = (game_state_t)state;
+    }
+    return SUCCESS;
+}
+
+/* ========== Spectators ========== */
+
+static error_code_t encode_spectate_ack(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_spectate_ack_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_bool(buffer, msg->success)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->spectator_count)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_spectate_ack(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                        size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_spectate_ack_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_bool(buffer, &msg->success)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->spectator_count)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_spectator_joined(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_spectator_joined_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_lstring(buffer, msg->spectator, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->spectator_count)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_spectator_joined(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                            size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_spectator_joined_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_lstring(buffer, msg->spectator, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->spectator_count)) != SUCCESS) return err;
+    if ((err = decode_handle(buffer, &msg->game)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+/* ========== Profiles ========== */
+
+static error_code_t encode_bio_lines(serialize_buffer_t* buffer, const char bio[10][256], int bio_lines) {
+    if (bio_lines < 0 || bio_lines > 10) return ERR_INVALID_PARAM;
+    error_code_t err = serialize_varint(buffer, (uint64_t)bio_lines);
+    for (int i = 0; err == SUCCESS && i < bio_lines; i++) {
+        err = serialize_lstring(buffer, bio[i], 256);
+    }
+    return err;
+}
+
+static error_code_t decode_bio_lines(serialize_buffer_t* buffer, char bio[10][256], int* bio_lines) {
+    error_code_t err = decode_count(buffer, 10, bio_lines);
+    for (int i = 0; err == SUCCESS && i < *bio_lines; i++) {
+        err = deserialize_lstring(buffer, bio[i], 256);
+    }
+    return err;
+}
+
+static error_code_t encode_set_bio(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_set_bio_t* msg = payload;
+    return encode_bio_lines(buffer, msg->bio, msg->bio_lines);
+}
+
+static error_code_t decode_set_bio(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                   size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_set_bio_t* msg = payload;
+    return decode_bio_lines(buffer, msg->bio, &msg->bio_lines);
+}
+
+static error_code_t encode_bio_response(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_bio_response_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_bool(buffer, msg->success)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = encode_bio_lines(buffer, msg->bio, msg->bio_lines)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_bio_response(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                        size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_bio_response_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_bool(buffer, &msg->success)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = decode_bio_lines(buffer, msg->bio, &msg->bio_lines)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_player_stats(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_player_stats_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_bool(buffer, msg->success)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->games_played)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->games_won)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->games_lost)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, msg->total_score)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_player_stats(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                        size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_player_stats_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_bool(buffer, &msg->success)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->games_played)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->games_won)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->games_lost)) != SUCCESS) return err;
+    if ((err = decode_int(buffer, &msg->total_score)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, sizeof(msg->message))) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_friend_list(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    const msg_list_friends_t* msg = payload;
+    error_code_t err;
+    if ((err = encode_list_count(buffer, msg->count, MAX_FRIENDS, offsetof(msg_list_friends_t, friends),
+                                 MAX_PSEUDO_LEN, payload_size)) != SUCCESS) return err;
+    for (int i = 0; i < msg->count; i++) {
+        if ((err = serialize_lstring(buffer, msg->friends[i], MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+static error_code_t decode_friend_list(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                       size_t* payload_size) {
+    msg_list_friends_t* msg = payload;
+    int count;
+    error_code_t err;
+    if ((err = decode_count(buffer, MAX_FRIENDS, &count)) != SUCCESS) return err;
+    if ((err = list_size(offsetof(msg_list_friends_t, friends), MAX_PSEUDO_LEN, count,
+                         max_payload_size, payload_size)) != SUCCESS) return err;
+    memset(msg, 0, *payload_size);
+    msg->count = count;
+    for (int i = 0; i < count; i++) {
+        if ((err = deserialize_lstring(buffer, msg->friends[i], MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+/* ========== Paged lists ========== */
+
+static error_code_t encode_list_page(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_list_page_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_svarint(buffer, msg->list_type)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->cursor)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->limit)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->flags)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_list_page(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                     size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_list_page_t* msg = payload;
+    error_code_t err;
+    if ((err = decode_int(buffer, &msg->list_type)) != SUCCESS) return err;
+    if ((err = deserialize_varint(buffer, &msg->cursor)) != SUCCESS) return err;
+    if ((err = decode_u32(buffer, &msg->limit)) != SUCCESS) return err;
+    if ((err = decode_u32(buffer, &msg->flags)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_list_end(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_list_end_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_svarint(buffer, msg->list_type)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->next_cursor)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->entries)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->frames)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_list_end(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                    size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_list_end_t* msg = payload;
+    error_code_t err;
+    if ((err = decode_int(buffer, &msg->list_type)) != SUCCESS) return err;
+    if ((err = deserialize_varint(buffer, &msg->next_cursor)) != SUCCESS) return err;
+    if ((err = decode_u32(buffer, &msg->entries)) != SUCCESS) return err;
+    if ((err = decode_u32(buffer, &msg->frames)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+/* ========== Chat ========== */
+
+static error_code_t encode_send_chat(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    const msg_send_chat_t* msg = payload;
+    error_code_t err;
+    if ((err = serialize_lstring(buffer, msg->recipient, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, MAX_CHAT_LEN)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_send_chat(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                     size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    msg_send_chat_t* msg = payload;
+    error_code_t err;
+    if ((err = deserialize_lstring(buffer, msg->recipient, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, MAX_CHAT_LEN)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t encode_chat_fields(serialize_buffer_t* buffer, const msg_chat_message_t* msg) {
+    error_code_t err;
+    if ((err = serialize_lstring(buffer, msg->sender, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->recipient, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = serialize_lstring(buffer, msg->message, MAX_CHAT_LEN)) != SUCCESS) return err;
+    if ((err = serialize_svarint(buffer, (int64_t)msg->timestamp)) != SUCCESS) return err;
+    return SUCCESS;
+}
+
+static error_code_t decode_chat_fields(serialize_buffer_t* buffer, msg_chat_message_t* msg) {
+    int64_t timestamp;
+    error_code_t err;
+    if ((err = deserialize_lstring(buffer, msg->sender, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->recipient, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_lstring(buffer, msg->message, MAX_CHAT_LEN)) != SUCCESS) return err;
+    if ((err = deserialize_svarint(buffer, &timestamp)) != SUCCESS) return err;
+    msg->timestamp = (time_t)timestamp;
+    return SUCCESS;
+}
+
+static error_code_t encode_chat_message(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    (void)payload_size;
+    return encode_chat_fields(buffer, (const msg_chat_message_t*)payload);
+}
+
+static error_code_t decode_chat_message(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                        size_t* payload_size) {
+    (void)max_payload_size; (void)payload_size;
+    return decode_chat_fields(buffer, (msg_chat_message_t*)payload);
+}
+
+static error_code_t encode_chat_history(serialize_buffer_t* buffer, const void* payload, size_t payload_size) {
+    const msg_chat_history_t* msg = payload;
+    error_code_t err;
+    if (payload_size < offsetof(msg_chat_history_t, messages)) return ERR_INVALID_PARAM;
+    if ((err = serialize_lstring(buffer, msg->target_player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = encode_list_count(buffer, msg->count, 50, offsetof(msg_chat_history_t, messages),
+                                 sizeof(msg_chat_message_t), payload_size)) != SUCCESS) return err;
+    for (int i = 0; i < msg->count; i++) {
+        if ((err = encode_chat_fields(buffer, &msg->messages[i])) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+static error_code_t decode_chat_history(serialize_buffer_t* buffer, void* payload, size_t max_payload_size,
+                                        size_t* payload_size) {
+    msg_chat_history_t* msg = payload;
+    char target[MAX_PSEUDO_LEN];
+    int count;
+    error_code_t err;
+    if ((err = deserialize_lstring(buffer, target, MAX_PSEUDO_LEN)) != SUCCESS) return err;
+    if ((err = decode_count(buffer, 50, &count)) != SUCCESS) return err;
+    if ((err = list_size(offsetof(msg_chat_history_t, messages), sizeof(msg_chat_message_t), count,
+                         max_payload_size, payload_size)) != SUCCESS) return err;
+    memset(msg, 0, *payload_size);
+    memcpy(msg->target_player, target, strlen(target) + 1);
+    msg->count = count;
+    for (int i = 0; i < count; i++) {
+        if ((err = decode_chat_fields(buffer, &msg->messages[i])) != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+/* ========== Dispatch ========== */
+
+static const codec_entry_t g_codec_table[] = {
+    {MSG_PORT_NEGOTIATION,   encode_port_negotiation,   decode_port_negotiation,   sizeof(msg_port_negotiation_t)},
+    {MSG_CONNECT,            encode_connect,            decode_connect,            sizeof(msg_connect_t)},
+    {MSG_CHALLENGE,          encode_challenge,          decode_challenge,          sizeof(msg_challenge_t)},
+    {MSG_ACCEPT_CHALLENGE,   encode_player_ref,         decode_player_ref,         sizeof(msg_challenge_response_t)},
+    {MSG_DECLINE_CHALLENGE,  encode_player_ref,         decode_player_ref,         sizeof(msg_challenge_response_t)},
+    {MSG_CHALLENGE_ACCEPT,   encode_challenge_reply,    decode_challenge_reply,    sizeof(msg_challenge_accept_t)},
+    {MSG_CHALLENGE_DECLINE,  encode_challenge_reply,    decode_challenge_reply,    sizeof(msg_challenge_decline_t)},
+    {MSG_PLAY_MOVE,          encode_play_move,          decode_play_move,          sizeof(msg_play_move_t)},
+    {MSG_GET_BOARD,          encode_get_board,          decode_get_board,          sizeof(msg_get_board_t)},
+    {MSG_SPECTATE_GAME,      encode_game_handle,        decode_game_handle,        sizeof(msg_spectate_game_t)},
+    {MSG_STOP_SPECTATE,      encode_game_handle,        decode_game_handle,        sizeof(msg_spectate_game_t)},
+    {MSG_SET_BIO,            encode_set_bio,            decode_set_bio,            sizeof(msg_set_bio_t)},
+    {MSG_GET_BIO,            encode_player_ref,         decode_player_ref,         sizeof(msg_get_bio_t)},
+    {MSG_GET_PLAYER_STATS,   encode_player_ref,         decode_player_ref,         sizeof(msg_get_player_stats_t)},
+    {MSG_SEND_CHAT,          encode_send_chat,          decode_send_chat,          sizeof(msg_send_chat_t)},
+    {MSG_CHAT_MESSAGE,       encode_chat_message,       decode_chat_message,       sizeof(msg_chat_message_t)},
+    {MSG_CHAT_HISTORY,       encode_chat_history,       decode_chat_history,       0},
+    {MSG_ADD_FRIEND,         encode_player_ref,         decode_player_ref,         sizeof(msg_add_friend_t)},
+    {MSG_REMOVE_FRIEND,      encode_player_ref,         decode_player_ref,         sizeof(msg_remove_friend_t)},
+    {MSG_LIST_FRIENDS,       encode_friend_list,        decode_friend_list,        0},
+    {MSG_LIST_SAVED_GAMES,   encode_player_ref,         decode_player_ref,         sizeof(msg_list_saved_games_t)},
+    {MSG_VIEW_SAVED_GAME,    encode_game_ref,           decode_game_ref,           sizeof(msg_view_saved_game_t)},
+    {MSG_SAVED_GAME_LIST,    encode_game_list,          decode_game_list,          0},
+    {MSG_SAVED_GAME_STATE,   encode_board_state,        decode_board_state,        sizeof(msg_saved_game_state_t)},
+    {MSG_CONNECT_ACK,        encode_connect_ack,        decode_connect_ack,        sizeof(msg_connect_ack_t)},
+    {MSG_ERROR,              encode_error,              decode_error,              sizeof(msg_error_t)},
+    {MSG_PLAYER_LIST,        encode_player_list,        decode_player_list,        0},
+    {MSG_CHALLENGE_RECEIVED, encode_challenge_received, decode_challenge_received, sizeof(msg_challenge_received_t)},
+    {MSG_GAME_STARTED,       encode_game_started,       decode_game_started,       sizeof(msg_game_started_t)},
+    {MSG_MOVE_RESULT,        encode_move_result,        decode_move_result,        sizeof(msg_move_result_t)},
+    {MSG_BOARD_STATE,        encode_board_state,        decode_board_state,        sizeof(msg_board_state_t)},
+    {MSG_GAME_OVER,          encode_game_over,          decode_game_over,          sizeof(msg_game_over_t)},
+    {MSG_CHALLENGE_LIST,     encode_challenge_list,     decode_challenge_list,     0},
+    {MSG_GAME_LIST,          encode_game_list,          decode_game_list,          0},
+    {MSG_MY_GAME_LIST,       encode_game_list,          decode_game_list,          0},
+    {MSG_SPECTATE_ACK,       encode_spectate_ack,       decode_spectate_ack,       sizeof(msg_spectate_ack_t)},
+    {MSG_SPECTATOR_JOINED,   encode_spectator_joined,   decode_spectator_joined,   sizeof(msg_spectator_joined_t)},
+    {MSG_BIO_RESPONSE,       encode_bio_response,       decode_bio_response,       sizeof(msg_bio_response_t)},
+    {MSG_PLAYER_STATS,       encode_player_stats,       decode_player_stats,       sizeof(msg_player_stats_t)},
+    {MSG_BOARD_DELTA,        encode_board_delta,        decode_board_delta,        0},
+    {MSG_BOARD_RESYNC,       encode_game_handle,        decode_game_handle,        sizeof(msg_board_resync_t)},
+    {MSG_LIST_PAGE,          encode_list_page,          decode_list_page,          sizeof(msg_list_page_t)},
+    {MSG_LIST_END,           encode_list_end,           decode_list_end,           sizeof(msg_list_end_t)},
+};
+
+static const codec_entry_t* codec_find(message_type_t type) {
+    for (size_t i = 0; i < sizeof(g_codec_table) / sizeof(g_codec_table[0]); i++) {
+        if (g_codec_table[i].type == type) return &g_codec_table[i];
+    }
+    return NULL;
+}
+
+uint8_t codec_for_version(const char* version) {
+    int major = 0, minor = 0;
+    if (!version || sscanf(version, "%d.%d", &major, &minor) != 2) return CODEC_RAW;
+    return (major > 1 || (major == 1 && minor >= 1)) ? CODEC_COMPACT : CODEC_RAW;
+}
+
+bool codec_supports(message_type_t type) {
+    return codec_find(type) != NULL;
+}
+
+error_code_t codec_encode(message_type_t type, const void* payload, size_t payload_size,
+                          void* output, size_t max_output, size_t* output_size) {
+    if (!payload || !output || !output_size) return ERR_INVALID_PARAM;
+
+    const codec_entry_t* entry = codec_find(type);
+    if (!entry) return ERR_INVALID_PARAM;
+    if (entry->fixed_size != 0 && payload_size < entry->fixed_size) return ERR_INVALID_PARAM;
+
+    /* No need to clear the buffer: encoders write every byte they count */
+    serialize_buffer_t buffer;
+    buffer.size = 0;
+    buffer.position = 0;
+
+    error_code_t err = entry->encode(&buffer, payload, payload_size);
+    if (err != SUCCESS) return err;
+    if (buffer.size > max_output) return ERR_SERIALIZATION;
+
+    memcpy(output, buffer.data, buffer.size);
+    *output_size = buffer.size;
+    return SUCCESS;
+}
+
+error_code_t codec_decode(message_type_t type, const void* input, size_t input_size,
+                          void* payload, size_t max_payload_size, size_t* payload_size) {
+    if (!input || !payload || !payload_size) return ERR_INVALID_PARAM;
+    if (input_size > MAX_MESSAGE_SIZE) return ERR_SERIALIZATION;
+
+    const codec_entry_t* entry = codec_find(type);
+    if (!entry) return ERR_SERIALIZATION;
+
+    if (entry->fixed_size != 0) {
+        if (entry->fixed_size > max_payload_size) return ERR_SERIALIZATION;
+        memset(payload, 0, entry->fixed_size);
+        *payload_size = entry->fixed_size;
+    }
+
+    serialize_buffer_t buffer;
+    memcpy(buffer.data, input, input_size);
+    buffer.size = input_size;
+    buffer.position = 0;
+
+    error_code_t err = entry->decode(&buffer, payload, max_payload_size, payload_size);
+    if (err != SUCCESS) return err;
+
+    /* Trailing bytes mean the peer and we disagree on the layout */
+    if (buffer.position != buffer.size) return ERR_SERIALIZATION;
+    return SUCCESS;
+}
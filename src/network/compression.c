@@ -0,0 +1,135 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../../include/network/compression.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+
+/* Bumped with atomics: compression runs on every handler thread, and a
+ * shared lock per frame would serialize them */
+static compression_stats_t g_stats;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool compression_should_compress(message_type_t type, size_t payload_size) {
+    if (payload_size < COMPRESSION_THRESHOLD) return false;
+
+    /* Bulk responses only: moves and board updates stay on the fast path */
+    switch (type) {
+        case MSG_PLAYER_LIST:
+        case MSG_GAME_LIST:
+        case MSG_MY_GAME_LIST:
+        case MSG_SAVED_GAME_LIST:
+        case MSG_CHALLENGE_LIST:
+        case MSG_CHAT_HISTORY:
+        case MSG_LIST_FRIENDS:
+        case MSG_BIO_RESPONSE:
+        case MSG_SET_BIO:
+            return true;
+        default:
+            return false;
+    }
+}
+
+error_code_t compression_compress(const void* input, size_t input_size,
+                                  void* output, size_t max_output, size_t* output_size) {
+    if (!input || !output || !output_size) return ERR_INVALID_PARAM;
+
+    uint64_t start = monotonic_ns();
+
+    /* Frames never exceed MAX_MESSAGE_SIZE, so an 8KB window sees the whole
+     * payload; the default 32KB window and memLevel cost far more to set up
+     * per frame than deflating a few KB */
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    int rc = deflateInit2(&stream, COMPRESSION_LEVEL, Z_DEFLATED, COMPRESSION_WINDOW_BITS,
+                          COMPRESSION_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+    size_t dest_len = 0;
+    if (rc == Z_OK) {
+        stream.next_in = (Bytef*)input;
+        stream.avail_in = (uInt)input_size;
+        stream.next_out = (Bytef*)output;
+        stream.avail_out = (uInt)max_output;
+        rc = deflate(&stream, Z_FINISH);
+        dest_len = stream.total_out;
+        deflateEnd(&stream);
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+
+    /* Not worth a flag if it did not shrink (Z_OK here means out of room) */
+    bool shrunk = (rc == Z_STREAM_END && dest_len < input_size);
+
+    __atomic_add_fetch(&g_stats.compress_ns, elapsed, __ATOMIC_RELAXED);
+    if (shrunk) {
+        __atomic_add_fetch(&g_stats.frames_compressed, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&g_stats.bytes_in, input_size, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&g_stats.bytes_out, dest_len, __ATOMIC_RELAXED);
+    } else {
+        __atomic_add_fetch(&g_stats.frames_skipped, 1, __ATOMIC_RELAXED);
+    }
+
+    if (!shrunk) return ERR_SERIALIZATION;
+    *output_size = dest_len;
+    return SUCCESS;
+}
+
+error_code_t compression_decompress(const void* input, size_t input_size,
+                                    void* output, size_t max_output, size_t* output_size) {
+    if (!input || !output || !output_size) return ERR_INVALID_PARAM;
+
+    uint64_t start = monotonic_ns();
+    uLongf dest_len = (uLongf)max_output;
+    int rc = uncompress((Bytef*)output, &dest_len, (const Bytef*)input, (uLong)input_size);
+    uint64_t elapsed = monotonic_ns() - start;
+
+    /* Z_BUF_ERROR: the peer inflated past the largest payload we accept */
+    if (rc != Z_OK) return ERR_SERIALIZATION;
+
+    __atomic_add_fetch(&g_stats.frames_decompressed, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&g_stats.decompress_ns, elapsed, __ATOMIC_RELAXED);
+
+    *output_size = dest_len;
+    return SUCCESS;
+}
+
+void compression_get_stats(compression_stats_t* stats) {
+    if (!stats) return;
+    stats->frames_compressed = __atomic_load_n(&g_stats.frames_compressed, __ATOMIC_RELAXED);
+    stats->frames_skipped = __atomic_load_n(&g_stats.frames_skipped, __ATOMIC_RELAXED);
+    stats->bytes_in = __atomic_load_n(&g_stats.bytes_in, __ATOMIC_RELAXED);
+    stats->bytes_out = __atomic_load_n(&g_stats.bytes_out, __ATOMIC_RELAXED);
+    stats->compress_ns = __atomic_load_n(&g_stats.compress_ns, __ATOMIC_RELAXED);
+    stats->frames_decompressed = __atomic_load_n(&g_stats.frames_decompressed, __ATOMIC_RELAXED);
+    stats->decompress_ns = __atomic_load_n(&g_stats.decompress_ns, __ATOMIC_RELAXED);
+}
+
+void compression_reset_stats(void) {
+    __atomic_store_n(&g_stats.frames_compressed, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_stats.frames_skipped, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_stats.bytes_in, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_stats.bytes_out, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_stats.compress_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_stats.frames_decompressed, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_stats.decompress_ns, 0, __ATOMIC_RELAXED);
+}
+
+void compression_print_stats(const char* label) {
+    compression_stats_t stats;
+    compression_get_stats(&stats);
+
+    uint64_t attempts = stats.frames_compressed + stats.frames_skipped;
+    printf("%s compression: %llu/%llu frames compressed, %llu -> %llu bytes (%.2fx), "
+           "deflate %.1f us/frame, inflate %.1f us/frame (%llu frames)\n",
+           label ? label : "Frame",
+           (unsigned long long)stats.frames_compressed, (unsigned long long)attempts,
+           (unsigned long long)stats.bytes_in, (unsigned long long)stats.bytes_out,
+           stats.bytes_out ? (double)stats.bytes_in / (double)stats.bytes_out : 0.0,
+           attempts ? (double)stats.compress_ns / (double)attempts / 1000.0 : 0.0,
+           stats.frames_decompressed ? (double)stats.decompress_ns / (double)stats.frames_decompressed / 1000.0 : 0.0,
+           (unsigned long long)stats.frames_decompressed);
+}
@@ -3,7 +3,6 @@
  */
 
 #include "../../include/network/connection.h"
-#include <unistd.h>
 #include <string.h>
 #include <arpa/inet.h>
 
@@ -14,30 +13,43 @@ error_code_t connection_init(connection_t* conn) {
     memset(&conn->addr, 0, sizeof(conn->addr));
     conn->connected = false;
     conn->sequence = 0;
+    conn->rx = NULL;
+    conn->tx = NULL;
+    conn->transport = &transport_tcp;
+    conn->transport_data = NULL;
     
     return SUCCESS;
 }
 
+const transport_ops_t* connection_transport(const connection_t* conn) {
+    return conn && conn->transport ? conn->transport : &transport_tcp;
+}
+
 error_code_t connection_close(connection_t* conn) {
     if (!conn) return ERR_INVALID_PARAM;
     
-    /* Close socket */
-    if (conn->socket_fd >= 0) {
-        close(conn->socket_fd);
-        conn->socket_fd = -1;
-    }
+    /* Close the socket (or the in-process channel end) */
+    connection_transport(conn)->close(conn);
+    
+    /* Anything still buffered belonged to this connection */
+    read_buffer_destroy(conn->rx);
+    conn->rx = NULL;
+    write_queue_destroy(conn->tx);
+    conn->tx = NULL;
     
     conn->connected = false;
     return SUCCESS;
 }
 
 bool connection_is_connected(const connection_t* conn) {
-    return conn && conn->connected && conn->socket_fd >= 0;
+    /* In-process transports have no fd, only their channel */
+    return conn && conn->connected && (conn->socket_fd >= 0 || conn->transport_data != NULL);
 }
 
 const char* connection_get_peer_ip(const connection_t* conn) {
     static char ip_str[INET_ADDRSTRLEN];
     if (!conn) return "unknown";
+    if (connection_transport(conn)->peer_name) return connection_transport(conn)->peer_name;
     
     inet_ntop(AF_INET, &conn->addr.sin_addr, ip_str, INET_ADDRSTRLEN);
     return ip_str;
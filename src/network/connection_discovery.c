@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <sys/time.h>
 
 /* Find a single free port */
 error_code_t connection_find_free_port(int* port) {
@@ -69,7 +70,7 @@ error_code_t connection_create_discovery_server(connection_t* conn, int port) {
         return ERR_NETWORK_ERROR;
     }
     
-    if (listen(conn->socket_fd, 5) < 0) {
+    if (listen(conn->socket_fd, CONNECTION_BACKLOG_DEFAULT) < 0) {
         close(conn->socket_fd);
         conn->socket_fd = -1;
         return ERR_NETWORK_ERROR;
@@ -0,0 +1,265 @@
+/* In-Process Loopback Connections
+ * Two connection_t ends joined by a pair of byte rings in memory. Each
+ * direction behaves like a stream socket: writes block while the ring is
+ * full, reads see EOF once the other end has closed and the ring is empty.
+ * Tests and benchmarks use it to run the full session and handler stack
+ * without the kernel network path.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "../../include/network/connection.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+/* One direction */
+typedef struct {
+    char data[LOOPBACK_CAPACITY];
+    size_t head;
+    size_t count;
+    bool closed;                /* Either end closed */
+    pthread_cond_t readable;
+    pthread_cond_t writable;
+} loopback_pipe_t;
+
+typedef struct loopback_channel loopback_channel_t;
+
+typedef struct {
+    loopback_channel_t* channel;
+    loopback_pipe_t* in;
+    loopback_pipe_t* out;
+} loopback_end_t;
+
+struct loopback_channel {
+    pthread_mutex_t lock;       /* Guards both directions */
+    loopback_pipe_t pipes[2];
+    loopback_end_t ends[2];
+    int open_ends;              /* The last close frees the channel */
+};
+
+static void deadline_after(struct timespec* ts, int timeout_ms) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += timeout_ms / 1000;
+    ts->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* Caller holds the lock. false once the deadline has passed. */
+static bool loopback_wait(loopback_channel_t* channel, pthread_cond_t* cond, int timeout_ms,
+                          const struct timespec* deadline) {
+    if (timeout_ms == 0) return false;
+    if (timeout_ms < 0) return pthread_cond_wait(cond, &channel->lock) == 0;
+    return pthread_cond_timedwait(cond, &channel->lock, deadline) != ETIMEDOUT;
+}
+
+/* Caller holds the lock. Both directions fail writes and read to EOF. */
+static void loopback_shut(loopback_channel_t* channel) {
+    for (int i = 0; i < 2; i++) {
+        channel->pipes[i].closed = true;
+        pthread_cond_broadcast(&channel->pipes[i].readable);
+        pthread_cond_broadcast(&channel->pipes[i].writable);
+    }
+}
+
+static error_code_t loopback_write(void* ctx, struct iovec* iov, int iov_count, int timeout_ms) {
+    loopback_end_t* end = (loopback_end_t*)ctx;
+    if (!end || !iov) return ERR_INVALID_PARAM;
+
+    loopback_channel_t* channel = end->channel;
+    loopback_pipe_t* out = end->out;
+    struct timespec deadline;
+    if (timeout_ms > 0) deadline_after(&deadline, timeout_ms);
+
+    error_code_t err = SUCCESS;
+    bool wrote = false;
+    pthread_mutex_lock(&channel->lock);
+    for (int i = 0; i < iov_count && err == SUCCESS; i++) {
+        const char* data = (const char*)iov[i].iov_base;
+        size_t remaining = iov[i].iov_len;
+
+        while (remaining > 0) {
+            while (out->count == LOOPBACK_CAPACITY && !out->closed) {
+                if (!loopback_wait(channel, &out->writable, timeout_ms, &deadline)) break;
+            }
+            if (out->closed) {
+                err = ERR_NETWORK_ERROR;
+                break;
+            }
+            if (out->count == LOOPBACK_CAPACITY) {
+                /* Same contract as a socket: part of a frame went out, so the
+                 * stream is torn and shut rather than left for a retry */
+                if (wrote) {
+                    loopback_shut(channel);
+                    err = ERR_NETWORK_ERROR;
+                } else {
+                    err = ERR_TIMEOUT;
+                }
+                break;
+            }
+
+            /* Into the free run after the tail, wrapping at most once per pass */
+            size_t tail = (out->head + out->count) % LOOPBACK_CAPACITY;
+            size_t room = LOOPBACK_CAPACITY - out->count;
+            size_t chunk = remaining < room ? remaining : room;
+            size_t first = LOOPBACK_CAPACITY - tail;
+            if (first > chunk) first = chunk;
+            memcpy(out->data + tail, data, first);
+            memcpy(out->data, data + first, chunk - first);
+
+            out->count += chunk;
+            data += chunk;
+            remaining -= chunk;
+            wrote = true;
+            pthread_cond_broadcast(&out->readable);
+        }
+    }
+    pthread_mutex_unlock(&channel->lock);
+    return err;
+}
+
+static error_code_t loopback_fill(connection_t* conn, read_buffer_t* rx, bool block, size_t* received) {
+    loopback_end_t* end = (loopback_end_t*)conn->transport_data;
+    if (!end || !rx) return ERR_INVALID_PARAM;
+    if (received) *received = 0;
+
+    loopback_channel_t* channel = end->channel;
+    loopback_pipe_t* in = end->in;
+
+    pthread_mutex_lock(&channel->lock);
+    rx->stats.reads++;
+    while (block && in->count == 0 && !in->closed) {
+        pthread_cond_wait(&in->readable, &channel->lock);
+    }
+    if (in->count == 0) {
+        pthread_mutex_unlock(&channel->lock);
+        return in->closed ? ERR_NETWORK_ERROR : SUCCESS;
+    }
+
+    /* Everything pending that fits, straight from one ring into the other */
+    size_t room = READ_BUFFER_SIZE - read_buffer_pending(rx);
+    size_t n = in->count < room ? in->count : room;
+    size_t first = LOOPBACK_CAPACITY - in->head;
+    if (first > n) first = n;
+    read_buffer_append(rx, in->data + in->head, first);
+    read_buffer_append(rx, in->data, n - first);
+
+    in->head = (in->head + n) % LOOPBACK_CAPACITY;
+    in->count -= n;
+    rx->stats.bytes += n;
+    pthread_cond_broadcast(&in->writable);
+    pthread_mutex_unlock(&channel->lock);
+
+    if (received) *received = n;
+    return SUCCESS;
+}
+
+static error_code_t loopback_wait_readable(connection_t* conn, int timeout_ms) {
+    loopback_end_t* end = (loopback_end_t*)conn->transport_data;
+    if (!end) return ERR_NETWORK_ERROR;
+
+    loopback_channel_t* channel = end->channel;
+    loopback_pipe_t* in = end->in;
+    struct timespec deadline;
+    if (timeout_ms > 0) deadline_after(&deadline, timeout_ms);
+
+    pthread_mutex_lock(&channel->lock);
+    while (in->count == 0 && !in->closed) {
+        if (!loopback_wait(channel, &in->readable, timeout_ms, &deadline)) break;
+    }
+    bool ready = in->count > 0 || in->closed;
+    pthread_mutex_unlock(&channel->lock);
+
+    /* A closed pipe is readable; the read reports the EOF */
+    return ready ? SUCCESS : ERR_TIMEOUT;
+}
+
+static error_code_t loopback_sendv(connection_t* conn, struct iovec* iov, int iov_count, int timeout_ms) {
+    return loopback_write(conn->transport_data, iov, iov_count, timeout_ms);
+}
+
+static error_code_t loopback_check_alive(connection_t* conn) {
+    loopback_end_t* end = (loopback_end_t*)conn->transport_data;
+    if (!end) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&end->channel->lock);
+    bool closed = end->out->closed;
+    pthread_mutex_unlock(&end->channel->lock);
+    return closed ? ERR_NETWORK_ERROR : SUCCESS;
+}
+
+static void loopback_channel_destroy(loopback_channel_t* channel) {
+    for (int i = 0; i < 2; i++) {
+        pthread_cond_destroy(&channel->pipes[i].readable);
+        pthread_cond_destroy(&channel->pipes[i].writable);
+    }
+    pthread_mutex_destroy(&channel->lock);
+    free(channel);
+}
+
+/* Closing either end fails the peer's writes and gives its reads EOF */
+static void loopback_close(connection_t* conn) {
+    loopback_end_t* end = (loopback_end_t*)conn->transport_data;
+    if (!end) return;
+    conn->transport_data = NULL;
+
+    loopback_channel_t* channel = end->channel;
+    pthread_mutex_lock(&channel->lock);
+    loopback_shut(channel);
+    int remaining = --channel->open_ends;
+    pthread_mutex_unlock(&channel->lock);
+
+    if (remaining == 0) loopback_channel_destroy(channel);
+}
+
+const transport_ops_t transport_loopback = {
+    "loopback",
+    loopback_fill,
+    loopback_wait_readable,
+    loopback_sendv,
+    loopback_check_alive,
+    loopback_close,
+    "loopback"
+};
+
+error_code_t connection_loopback_pair(connection_t* a, connection_t* b) {
+    if (!a || !b || a == b) return ERR_INVALID_PARAM;
+
+    loopback_channel_t* channel = calloc(1, sizeof(loopback_channel_t));
+    if (!channel) return ERR_MAX_CAPACITY;
+
+    /* Timed waits measure against the monotonic clock */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&channel->lock, NULL);
+    for (int i = 0; i < 2; i++) {
+        pthread_cond_init(&channel->pipes[i].readable, &attr);
+        pthread_cond_init(&channel->pipes[i].writable, &attr);
+    }
+    pthread_condattr_destroy(&attr);
+
+    /* a reads pipes[0] and writes pipes[1]; b the other way round */
+    connection_t* conns[2] = { a, b };
+    for (int i = 0; i < 2; i++) {
+        loopback_end_t* end = &channel->ends[i];
+        end->channel = channel;
+        end->in = &channel->pipes[i];
+        end->out = &channel->pipes[1 - i];
+
+        connection_init(conns[i]);
+        conns[i]->transport = &transport_loopback;
+        conns[i]->transport_data = end;
+        conns[i]->connected = true;
+        conns[i]->tx = write_queue_create();
+        write_queue_set_sink(conns[i]->tx, loopback_write, end);
+    }
+    channel->open_ends = 2;
+
+    return SUCCESS;
+}
@@ -0,0 +1,177 @@
+/* Readiness Multiplexing
+ * epoll-based multiplexing for any number of sockets, and a poll() wait for
+ * a single fd. Neither uses fd_set, so descriptors above FD_SETSIZE are fine.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "../../include/network/connection.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+static uint32_t to_epoll_events(uint32_t events) {
+    uint32_t out = 0;
+    if (events & POLL_CONTEXT_READ) out |= EPOLLIN;
+    if (events & POLL_CONTEXT_WRITE) out |= EPOLLOUT;
+    if (events & POLL_CONTEXT_ONESHOT) out |= EPOLLONESHOT;
+    return out;
+}
+
+static uint32_t from_epoll_events(uint32_t events) {
+    uint32_t out = 0;
+    if (events & (EPOLLIN | EPOLLRDHUP)) out |= POLL_CONTEXT_READ;
+    if (events & EPOLLOUT) out |= POLL_CONTEXT_WRITE;
+    if (events & (EPOLLERR | EPOLLHUP)) out |= POLL_CONTEXT_ERROR;
+    return out;
+}
+
+error_code_t poll_context_init(poll_context_t* ctx, int timeout_ms) {
+    if (!ctx) return ERR_INVALID_PARAM;
+
+    ctx->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (ctx->epoll_fd < 0) return ERR_NETWORK_ERROR;
+    ctx->timeout_ms = timeout_ms;
+    ctx->registered = 0;
+    ctx->ready = NULL;
+    ctx->ready_count = 0;
+    ctx->ready_capacity = 0;
+
+    return SUCCESS;
+}
+
+void poll_context_destroy(poll_context_t* ctx) {
+    if (!ctx) return;
+    if (ctx->epoll_fd >= 0) {
+        close(ctx->epoll_fd);
+        ctx->epoll_fd = -1;
+    }
+    free(ctx->ready);
+    ctx->ready = NULL;
+    ctx->ready_count = 0;
+    ctx->ready_capacity = 0;
+    ctx->registered = 0;
+}
+
+static error_code_t poll_context_ctl(poll_context_t* ctx, int op, int fd, uint32_t events) {
+    if (!ctx || ctx->epoll_fd < 0 || fd < 0) return ERR_INVALID_PARAM;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = to_epoll_events(events);
+    ev.data.fd = fd;
+
+    if (epoll_ctl(ctx->epoll_fd, op, fd, &ev) < 0) {
+        if (errno == EEXIST) return ERR_DUPLICATE;
+        if (errno == ENOENT) return ERR_INVALID_PARAM;
+        return ERR_NETWORK_ERROR;
+    }
+    return SUCCESS;
+}
+
+error_code_t poll_context_add(poll_context_t* ctx, int fd, uint32_t events) {
+    error_code_t err = poll_context_ctl(ctx, EPOLL_CTL_ADD, fd, events);
+    if (err == SUCCESS) ctx->registered++;
+    return err;
+}
+
+error_code_t poll_context_modify(poll_context_t* ctx, int fd, uint32_t events) {
+    return poll_context_ctl(ctx, EPOLL_CTL_MOD, fd, events);
+}
+
+error_code_t poll_context_remove(poll_context_t* ctx, int fd) {
+    error_code_t err = poll_context_ctl(ctx, EPOLL_CTL_DEL, fd, 0);
+    if (err == SUCCESS) ctx->registered--;
+    return err;
+}
+
+error_code_t poll_context_wait(poll_context_t* ctx, int* ready_count) {
+    if (!ctx || ctx->epoll_fd < 0) return ERR_INVALID_PARAM;
+
+    /* Room for every registered fd, up to one batch */
+    int want = ctx->registered < 1 ? 1 : ctx->registered;
+    if (want > POLL_CONTEXT_MAX_EVENTS) want = POLL_CONTEXT_MAX_EVENTS;
+    if (want > ctx->ready_capacity) {
+        poll_event_t* grown = realloc(ctx->ready, (size_t)want * sizeof(poll_event_t));
+        if (!grown) return ERR_MAX_CAPACITY;
+        ctx->ready = grown;
+        ctx->ready_capacity = want;
+    }
+
+    struct epoll_event events[POLL_CONTEXT_BATCH];
+    int max_events = ctx->ready_capacity < POLL_CONTEXT_BATCH ? ctx->ready_capacity : POLL_CONTEXT_BATCH;
+    ctx->ready_count = 0;
+
+    int result = epoll_wait(ctx->epoll_fd, events, max_events, ctx->timeout_ms);
+    if (result < 0) {
+        if (errno == EINTR) {
+            if (ready_count) *ready_count = 0;
+            return SUCCESS;
+        }
+        return ERR_NETWORK_ERROR;
+    }
+
+    /* Drain further batches without waiting */
+    while (result > 0) {
+        for (int i = 0; i < result; i++) {
+            ctx->ready[ctx->ready_count].fd = events[i].data.fd;
+            ctx->ready[ctx->ready_count].events = from_epoll_events(events[i].events);
+            ctx->ready_count++;
+        }
+        if (result < max_events) break;
+        int room = ctx->ready_capacity - ctx->ready_count;
+        if (room <= 0) break;
+        result = epoll_wait(ctx->epoll_fd, events, room < max_events ? room : max_events, 0);
+        if (result < 0) break;
+    }
+
+    if (ready_count) *ready_count = ctx->ready_count;
+    return SUCCESS;
+}
+
+const poll_event_t* poll_context_ready(const poll_context_t* ctx, int index) {
+    if (!ctx || index < 0 || index >= ctx->ready_count) return NULL;
+    return &ctx->ready[index];
+}
+
+static uint32_t poll_context_events_for(const poll_context_t* ctx, int fd) {
+    if (!ctx || fd < 0) return 0;
+    for (int i = 0; i < ctx->ready_count; i++) {
+        if (ctx->ready[i].fd == fd) return ctx->ready[i].events;
+    }
+    return 0;
+}
+
+bool poll_context_is_readable(const poll_context_t* ctx, int fd) {
+    /* Hangups read as EOF, so report them as readable */
+    return (poll_context_events_for(ctx, fd) & (POLL_CONTEXT_READ | POLL_CONTEXT_ERROR)) != 0;
+}
+
+bool poll_context_is_writable(const poll_context_t* ctx, int fd) {
+    return (poll_context_events_for(ctx, fd) & POLL_CONTEXT_WRITE) != 0;
+}
+
+error_code_t poll_fd(int fd, uint32_t events, int timeout_ms) {
+    if (fd < 0) return ERR_INVALID_PARAM;
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = 0;
+    if (events & POLL_CONTEXT_READ) pfd.events |= POLLIN;
+    if (events & POLL_CONTEXT_WRITE) pfd.events |= POLLOUT;
+    pfd.revents = 0;
+
+    int ret;
+    do {
+        ret = poll(&pfd, 1, timeout_ms < 0 ? -1 : timeout_ms);
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 0) return ERR_NETWORK_ERROR;
+    if (ret == 0) return ERR_TIMEOUT;
+    if (pfd.revents & POLLNVAL) return ERR_NETWORK_ERROR;
+
+    /* POLLHUP/POLLERR: the next read or write reports the actual error */
+    return SUCCESS;
+}
@@ -1,7 +1,11 @@
 /* TCP Connection Operations
- * Handles TCP socket creation, connection, accepting, and data transfer
+ * Handles TCP socket creation, connection, accepting, and data transfer.
+ * Framed receives and sends go through the connection's transport, so they
+ * work unchanged over Unix sockets and loopback pairs.
  */
 
+#define _DEFAULT_SOURCE
+
 #include "../../include/network/connection.h"
 #include <unistd.h>
 #include <string.h>
@@ -10,12 +14,16 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <errno.h>
-#include <sys/select.h>
 #include <fcntl.h>
 #include <netinet/tcp.h>
+#include <time.h>
 
 error_code_t connection_create_server(connection_t* conn, int port) {
-    if (!conn) return ERR_INVALID_PARAM;
+    return connection_create_listener(conn, port, CONNECTION_BACKLOG_DEFAULT, false);
+}
+
+error_code_t connection_create_listener(connection_t* conn, int port, int backlog, bool reuse_port) {
+    if (!conn || backlog <= 0) return ERR_INVALID_PARAM;
     
     /* Create server socket */
     conn->socket_fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -25,6 +33,10 @@ error_code_t connection_create_server(connection_t* conn, int port) {
     
     int opt = 1;
     setsockopt(conn->socket_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (reuse_port && setsockopt(conn->socket_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        close(conn->socket_fd);
+        return ERR_NETWORK_ERROR;
+    }
     
     struct sockaddr_in server_addr;
     memset(&server_addr, 0, sizeof(server_addr));
@@ -37,13 +49,17 @@ error_code_t connection_create_server(connection_t* conn, int port) {
         return ERR_NETWORK_ERROR;
     }
     
-    if (listen(conn->socket_fd, 5) < 0) {
+    if (listen(conn->socket_fd, backlog) < 0) {
         close(conn->socket_fd);
         return ERR_NETWORK_ERROR;
     }
     
     conn->addr = server_addr;
     conn->connected = true;
+    conn->rx = NULL;
+    conn->tx = NULL;
+    conn->transport = &transport_tcp;
+    conn->transport_data = NULL;
     return SUCCESS;
 }
 
@@ -74,33 +90,112 @@ error_code_t connection_connect(connection_t* conn, const char* host, int port)
     
     conn->addr = server_addr;
     conn->connected = true;
+    conn->transport = &transport_tcp;
+    conn->transport_data = NULL;
+    conn->tx = write_queue_create();
     
     /* Enable TCP keepalive to detect broken connections */
     connection_enable_keepalive(conn);
+    connection_enable_nodelay(conn);
     
     return SUCCESS;
 }
 
+/* Shared by accept and adopt once socket_fd, addr and transport are set */
+static void connection_setup_accepted(connection_t* client) {
+    client->connected = true;
+    client->sequence = 0;
+    client->rx = NULL;
+    client->tx = write_queue_create();
+    client->transport_data = NULL;
+    
+    /* Enable TCP keepalive to detect broken connections */
+    if (client->transport == &transport_tcp) {
+        connection_enable_keepalive(client);
+        connection_enable_nodelay(client);
+    }
+}
+
 error_code_t connection_accept(connection_t* server, connection_t* client) {
     if (!server || !client) return ERR_INVALID_PARAM;
     
+    /* Accepted sockets use the listener's transport; only TCP has an address */
+    client->transport = connection_transport(server);
+    memset(&client->addr, 0, sizeof(client->addr));
     socklen_t addr_len = sizeof(client->addr);
+    bool tcp = client->transport == &transport_tcp;
     
     /* Accept connection */
-    client->socket_fd = accept(server->socket_fd, (struct sockaddr*)&client->addr, &addr_len);
+    client->socket_fd = accept(server->socket_fd, tcp ? (struct sockaddr*)&client->addr : NULL,
+                               tcp ? &addr_len : NULL);
     if (client->socket_fd < 0) {
         return ERR_NETWORK_ERROR;
     }
     
-    client->connected = true;
-    client->sequence = 0;
+    connection_setup_accepted(client);
+    return SUCCESS;
+}
+
+error_code_t connection_adopt(connection_t* conn, int fd) {
+    if (!conn || fd < 0) return ERR_INVALID_PARAM;
     
-    /* Enable TCP keepalive to detect broken connections */
-    connection_enable_keepalive(client);
+    /* The fd may come from any listener; its family picks the transport */
+    int domain = AF_INET;
+    socklen_t domain_len = sizeof(domain);
+    if (getsockopt(fd, SOL_SOCKET, SO_DOMAIN, &domain, &domain_len) < 0) {
+        return ERR_NETWORK_ERROR;
+    }
+    
+    memset(&conn->addr, 0, sizeof(conn->addr));
+    if (domain == AF_UNIX) {
+        conn->transport = &transport_unix;
+    } else {
+        socklen_t addr_len = sizeof(conn->addr);
+        if (getpeername(fd, (struct sockaddr*)&conn->addr, &addr_len) < 0) {
+            return ERR_NETWORK_ERROR;
+        }
+        conn->transport = &transport_tcp;
+    }
+    
+    conn->socket_fd = fd;
+    connection_setup_accepted(conn);
+    return SUCCESS;
+}
+
+error_code_t connection_resume(connection_t* conn, connection_t* fresh) {
+    if (!conn || !fresh || conn == fresh) return ERR_INVALID_PARAM;
+    if (conn->socket_fd < 0 || fresh->socket_fd < 0) {
+        connection_close(fresh);
+        return ERR_INVALID_PARAM;
+    }
+    
+    /* dup2 swaps the socket behind the fd number in one step; a sender that
+     * already picked up the number writes to the new socket */
+    if (dup2(fresh->socket_fd, conn->socket_fd) < 0) {
+        connection_close(fresh);
+        return ERR_NETWORK_ERROR;
+    }
+    conn->transport = connection_transport(fresh);
+    conn->addr = fresh->addr;
+    conn->connected = true;
     
+    /* Unread bytes of the old socket are partial frames at best; whatever
+     * `fresh` read past its handshake belongs to the resumed session */
+    read_buffer_t* old_rx = conn->rx;
+    conn->rx = fresh->rx;
+    fresh->rx = old_rx;
+    write_queue_discard(conn->tx);
+    
+    connection_close(fresh);
     return SUCCESS;
 }
 
+void connection_shutdown(connection_t* conn) {
+    if (conn && conn->socket_fd >= 0) {
+        shutdown(conn->socket_fd, SHUT_RDWR);
+    }
+}
+
 error_code_t connection_send_raw(connection_t* conn, const void* data, size_t size) {
     if (!conn || !data || size == 0) return ERR_INVALID_PARAM;
     if (!conn->connected) return ERR_NETWORK_ERROR;
@@ -171,28 +266,16 @@ error_code_t connection_send_timeout(connection_t* conn, const void* data, size_
     size_t remaining = size;
     
     while (remaining > 0) {
-        /* Use select() to wait for socket to be writable */
-        fd_set write_fds;
-        struct timeval timeout;
-        
-        FD_ZERO(&write_fds);
-        FD_SET(conn->socket_fd, &write_fds);
-        
-        timeout.tv_sec = timeout_ms / 1000;
-        timeout.tv_usec = (timeout_ms % 1000) * 1000;
-        
-        int ret = select(conn->socket_fd + 1, NULL, &write_fds, NULL, &timeout);
-        
-        if (ret < 0) {
-            if (errno == EINTR) continue;
-            conn->connected = false;
-            return ERR_NETWORK_ERROR;
-        }
-        
-        if (ret == 0) {
+        /* Wait for the socket to be writable */
+        error_code_t err = poll_fd(conn->socket_fd, POLL_CONTEXT_WRITE, timeout_ms);
+        if (err == ERR_TIMEOUT) {
             /* Timeout - socket not ready for writing */
             return ERR_TIMEOUT;
         }
+        if (err != SUCCESS) {
+            conn->connected = false;
+            return ERR_NETWORK_ERROR;
+        }
         
         /* Socket is writable, attempt to send */
         ssize_t sent = send(conn->socket_fd, ptr, remaining, MSG_NOSIGNAL);
@@ -221,28 +304,16 @@ error_code_t connection_recv_timeout(connection_t* conn, void* buffer, size_t si
     if (!conn || !buffer || size == 0) return ERR_INVALID_PARAM;
     if (!conn->connected) return ERR_NETWORK_ERROR;
     
-    /* Set up select() with timeout */
-    fd_set read_fds;
-    struct timeval timeout;
-    
-    FD_ZERO(&read_fds);
-    FD_SET(conn->socket_fd, &read_fds);
-    
-    timeout.tv_sec = timeout_ms / 1000;
-    timeout.tv_usec = (timeout_ms % 1000) * 1000;
-    
-    int ret = select(conn->socket_fd + 1, &read_fds, NULL, NULL, &timeout);
-    
-    if (ret < 0) {
-        if (errno == EINTR) return ERR_NETWORK_ERROR;
-        conn->connected = false;  /* Mark as disconnected */
-        return ERR_NETWORK_ERROR;
-    }
-    
-    if (ret == 0) {
+    /* Wait for data with timeout */
+    error_code_t err = poll_fd(conn->socket_fd, POLL_CONTEXT_READ, timeout_ms);
+    if (err == ERR_TIMEOUT) {
         /* Timeout occurred */
         return ERR_TIMEOUT;
     }
+    if (err != SUCCESS) {
+        conn->connected = false;  /* Mark as disconnected */
+        return ERR_NETWORK_ERROR;
+    }
     
     /* Data is available, proceed with read */
     char* ptr = (char*)buffer;
@@ -277,28 +348,16 @@ error_code_t connection_recv_peek(connection_t* conn, void* buffer, size_t size,
     if (!conn || !buffer || size == 0) return ERR_INVALID_PARAM;
     if (!conn->connected) return ERR_NETWORK_ERROR;
 
-    /* Set up select() with timeout */
-    fd_set read_fds;
-    struct timeval timeout;
-
-    FD_ZERO(&read_fds);
-    FD_SET(conn->socket_fd, &read_fds);
-
-    timeout.tv_sec = timeout_ms / 1000;
-    timeout.tv_usec = (timeout_ms % 1000) * 1000;
-
-    int ret = select(conn->socket_fd + 1, &read_fds, NULL, NULL, &timeout);
-
-    if (ret < 0) {
-        if (errno == EINTR) return ERR_NETWORK_ERROR;
-        conn->connected = false;  /* Mark as disconnected */
-        return ERR_NETWORK_ERROR;
-    }
-
-    if (ret == 0) {
+    /* Wait for data with timeout */
+    error_code_t err = poll_fd(conn->socket_fd, POLL_CONTEXT_READ, timeout_ms);
+    if (err == ERR_TIMEOUT) {
         /* Timeout occurred */
         return ERR_TIMEOUT;
     }
+    if (err != SUCCESS) {
+        conn->connected = false;  /* Mark as disconnected */
+        return ERR_NETWORK_ERROR;
+    }
 
     /* Data is available, proceed with peek */
     char* ptr = (char*)buffer;
@@ -329,6 +388,115 @@ error_code_t connection_recv_peek(connection_t* conn, void* buffer, size_t size,
     return SUCCESS;
 }
 
+error_code_t connection_wait_readable(connection_t* conn, int timeout_ms) {
+    if (!conn) return ERR_INVALID_PARAM;
+    if (!conn->connected) return ERR_NETWORK_ERROR;
+
+    error_code_t err = connection_transport(conn)->wait_readable(conn, timeout_ms);
+    if (err == ERR_NETWORK_ERROR) {
+        conn->connected = false;  /* Mark as disconnected */
+    }
+    return err;
+}
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Read until the ring holds a whole frame (or just its header). Blocking
+ * callers read directly; timed callers wait for readability first, so a
+ * frame that arrives in one segment costs one wait and one read. */
+static error_code_t connection_buffer_frame(connection_t* conn, bool header_only, int timeout_ms) {
+    if (!conn->rx) {
+        conn->rx = read_buffer_create();
+        if (!conn->rx) return ERR_MAX_CAPACITY;
+    }
+
+    int64_t deadline = timeout_ms >= 0 ? monotonic_ms() + timeout_ms : 0;
+
+    while (1) {
+        message_header_t header;
+        error_code_t err = read_buffer_peek_header(conn->rx, &header);
+        if (err == SUCCESS) {
+            if (header_only) return SUCCESS;
+            if (header.length > MAX_PAYLOAD_SIZE) return ERR_SERIALIZATION;
+            if (read_buffer_pending(conn->rx) >= HEADER_SIZE + header.length) return SUCCESS;
+        }
+
+        if (timeout_ms > 0) {
+            int64_t remaining = deadline - monotonic_ms();
+            if (remaining <= 0) return ERR_TIMEOUT;
+            conn->rx->stats.waits++;
+            err = connection_wait_readable(conn, (int)remaining);
+            if (err != SUCCESS) return err;
+        }
+
+        /* A zero timeout is a single non-blocking read, for event loops
+         * that already know the socket is readable */
+        size_t received;
+        err = connection_transport(conn)->fill(conn, conn->rx, timeout_ms < 0, &received);
+        if (err != SUCCESS) {
+            conn->connected = false;
+            return err;
+        }
+        if (timeout_ms == 0 && received == 0) return ERR_TIMEOUT;
+    }
+}
+
+error_code_t connection_recv_frame(connection_t* conn, frame_view_t* view, int timeout_ms) {
+    if (!conn || !view) return ERR_INVALID_PARAM;
+    if (!conn->connected) return ERR_NETWORK_ERROR;
+
+    error_code_t err = connection_buffer_frame(conn, false, timeout_ms);
+    if (err != SUCCESS) return err;
+    return read_buffer_next_frame(conn->rx, view);
+}
+
+error_code_t connection_peek_frame(connection_t* conn, message_header_t* header, int timeout_ms) {
+    if (!conn || !header) return ERR_INVALID_PARAM;
+    if (!conn->connected) return ERR_NETWORK_ERROR;
+
+    error_code_t err = connection_buffer_frame(conn, true, timeout_ms);
+    if (err != SUCCESS) return err;
+    return read_buffer_peek_header(conn->rx, header);
+}
+
+error_code_t connection_send_frame(connection_t* conn, const void* header, size_t header_size,
+                                   const void* payload, size_t payload_size, int timeout_ms) {
+    if (!conn || !header) return ERR_INVALID_PARAM;
+    if (!conn->connected) return ERR_NETWORK_ERROR;
+
+    error_code_t err;
+    if (conn->tx) {
+        err = write_queue_send(conn->tx, conn->socket_fd, header, header_size, payload, payload_size, timeout_ms);
+    } else {
+        /* Connections built by hand (tests, temporary copies) send directly */
+        struct iovec iov[2] = {
+            { (void*)header, header_size },
+            { (void*)payload, payload_size }
+        };
+        err = connection_transport(conn)->sendv(conn, iov, 2, timeout_ms);
+    }
+
+    if (err == ERR_NETWORK_ERROR) conn->connected = false;
+    return err;
+}
+
+void connection_cork(connection_t* conn) {
+    if (conn) write_queue_cork(conn->tx);
+}
+
+error_code_t connection_uncork(connection_t* conn, int timeout_ms) {
+    if (!conn) return ERR_INVALID_PARAM;
+    if (!conn->tx) return SUCCESS;
+
+    error_code_t err = write_queue_uncork(conn->tx, conn->socket_fd, timeout_ms);
+    if (err == ERR_NETWORK_ERROR) conn->connected = false;
+    return err;
+}
+
 /* Enable TCP keepalive to detect broken connections */
 error_code_t connection_enable_keepalive(connection_t* conn) {
     if (!conn || conn->socket_fd < 0) return ERR_INVALID_PARAM;
@@ -350,6 +518,17 @@ error_code_t connection_enable_keepalive(connection_t* conn) {
     return SUCCESS;
 }
 
+/* Disable Nagle: batching is done by corking, not by the kernel */
+error_code_t connection_enable_nodelay(connection_t* conn) {
+    if (!conn || conn->socket_fd < 0) return ERR_INVALID_PARAM;
+
+    int nodelay = 1;
+    if (setsockopt(conn->socket_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0) {
+        return ERR_NETWORK_ERROR;
+    }
+    return SUCCESS;
+}
+
 /* Set socket to non-blocking or blocking mode */
 error_code_t connection_set_nonblocking(connection_t* conn, bool enable) {
     if (!conn || conn->socket_fd < 0) return ERR_INVALID_PARAM;
@@ -370,27 +549,15 @@ error_code_t connection_set_nonblocking(connection_t* conn, bool enable) {
     return SUCCESS;
 }
 
-/* Check if connection is still alive by sending TCP probe */
+/* Check if connection is still alive (a zero-length probe on sockets) */
 error_code_t connection_check_alive(connection_t* conn) {
-    if (!conn || conn->socket_fd < 0) return ERR_INVALID_PARAM;
+    if (!conn) return ERR_INVALID_PARAM;
     if (!conn->connected) return ERR_NETWORK_ERROR;
     
-    /* Use send() with MSG_NOSIGNAL and zero-length to check connection */
-    /* This doesn't actually send data but checks if connection is alive */
-    char dummy = 0;
-    ssize_t result = send(conn->socket_fd, &dummy, 0, MSG_NOSIGNAL | MSG_DONTWAIT);
-    
-    if (result < 0) {
-        if (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN || errno == EBADF) {
-            /* Connection is broken */
-            conn->connected = false;
-            return ERR_NETWORK_ERROR;
-        }
-        /* EAGAIN/EWOULDBLOCK is OK for non-blocking check */
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return SUCCESS;
-        }
+    error_code_t err = connection_transport(conn)->check_alive(conn);
+    if (err == ERR_NETWORK_ERROR) {
+        /* Connection is broken */
+        conn->connected = false;
     }
-    
-    return SUCCESS;
+    return err;
 }
@@ -0,0 +1,286 @@
+/* Event-Driven Socket Backend
+ * Backend selection and the epoll implementation. The io_uring
+ * implementation lives in io_uring.c.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "../../include/network/io_backend.h"
+#include "../../include/network/connection.h"
+#include "../../include/network/write_queue.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/* Per-fd receive state (epoll) */
+typedef enum {
+    EPOLL_FD_NONE = 0,      /* Not registered */
+    EPOLL_FD_WATCH,         /* Level-triggered, every wait */
+    EPOLL_FD_ONESHOT,       /* Armed for one report */
+    EPOLL_FD_DISARMED       /* Registered, already reported */
+} epoll_fd_mode_t;
+
+typedef struct {
+    poll_context_t poll;
+    uint8_t* modes;         /* epoll_fd_mode_t, indexed by fd */
+    size_t mode_capacity;
+    char* chunks;           /* One receive buffer per event, reused every wait */
+} epoll_backend_t;
+
+static error_code_t epoll_reserve(epoll_backend_t* ep, int fd) {
+    if ((size_t)fd < ep->mode_capacity) return SUCCESS;
+
+    size_t capacity = ep->mode_capacity ? ep->mode_capacity : 1024;
+    while (capacity <= (size_t)fd) capacity *= 2;
+    uint8_t* grown = realloc(ep->modes, capacity);
+    if (!grown) return ERR_MAX_CAPACITY;
+    memset(grown + ep->mode_capacity, 0, capacity - ep->mode_capacity);
+    ep->modes = grown;
+    ep->mode_capacity = capacity;
+    return SUCCESS;
+}
+
+static error_code_t epoll_backend_init(io_backend_t* io) {
+    epoll_backend_t* ep = calloc(1, sizeof(epoll_backend_t));
+    if (!ep) return ERR_MAX_CAPACITY;
+
+    ep->chunks = malloc((size_t)IO_BACKEND_MAX_EVENTS * IO_BACKEND_BUFFER_SIZE);
+    if (!ep->chunks || poll_context_init(&ep->poll, -1) != SUCCESS) {
+        free(ep->chunks);
+        free(ep);
+        return ERR_NETWORK_ERROR;
+    }
+    for (int i = 0; i < io->listener_count; i++) {
+        if (poll_context_add(&ep->poll, io->listeners[i], POLL_CONTEXT_READ) != SUCCESS) {
+            poll_context_destroy(&ep->poll);
+            free(ep->chunks);
+            free(ep);
+            return ERR_NETWORK_ERROR;
+        }
+    }
+
+    io->impl = ep;
+    return SUCCESS;
+}
+
+static void epoll_backend_destroy(io_backend_t* io) {
+    epoll_backend_t* ep = (epoll_backend_t*)io->impl;
+    poll_context_destroy(&ep->poll);
+    free(ep->modes);
+    free(ep->chunks);
+    free(ep);
+}
+
+static error_code_t epoll_backend_arm(io_backend_t* io, int fd, bool multishot) {
+    epoll_backend_t* ep = (epoll_backend_t*)io->impl;
+    error_code_t err = epoll_reserve(ep, fd);
+    if (err != SUCCESS) return err;
+
+    uint32_t events = multishot ? POLL_CONTEXT_READ : (POLL_CONTEXT_READ | POLL_CONTEXT_ONESHOT);
+    if (ep->modes[fd] == EPOLL_FD_NONE) {
+        err = poll_context_add(&ep->poll, fd, events);
+    } else {
+        err = poll_context_modify(&ep->poll, fd, events);
+    }
+    io->stats.syscalls++;
+    if (err != SUCCESS) return err;
+
+    ep->modes[fd] = multishot ? EPOLL_FD_WATCH : EPOLL_FD_ONESHOT;
+    return SUCCESS;
+}
+
+static error_code_t epoll_backend_unwatch(io_backend_t* io, int fd) {
+    epoll_backend_t* ep = (epoll_backend_t*)io->impl;
+    if ((size_t)fd >= ep->mode_capacity || ep->modes[fd] == EPOLL_FD_NONE) return SUCCESS;
+
+    ep->modes[fd] = EPOLL_FD_NONE;
+    io->stats.syscalls++;
+    poll_context_remove(&ep->poll, fd);
+    return SUCCESS;
+}
+
+static error_code_t epoll_backend_send(io_backend_t* io, int fd, const void* header, size_t header_size,
+                                       const void* payload, size_t payload_size) {
+    struct iovec iov[2] = {
+        { (void*)header, header_size },
+        { (void*)payload, payload_size }
+    };
+    write_queue_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    error_code_t err = write_queue_sendv(fd, iov, 2, 5000, &stats);
+    io->stats.syscalls += stats.sends + stats.waits;
+    return err;
+}
+
+static bool io_backend_is_listener(const io_backend_t* io, int fd) {
+    for (int i = 0; i < io->listener_count; i++) {
+        if (io->listeners[i] == fd) return true;
+    }
+    return false;
+}
+
+static error_code_t epoll_backend_wait(io_backend_t* io, io_event_t* events, int max_events, int timeout_ms,
+                                       int* count) {
+    epoll_backend_t* ep = (epoll_backend_t*)io->impl;
+
+    ep->poll.timeout_ms = timeout_ms;
+    int ready = 0;
+    io->stats.syscalls++;
+    error_code_t err = poll_context_wait(&ep->poll, &ready);
+    if (err != SUCCESS) return err;
+
+    int produced = 0;
+    for (int i = 0; i < ready; i++) {
+        const poll_event_t* ev = poll_context_ready(&ep->poll, i);
+        int fd = ev->fd;
+
+        if (produced == max_events) {
+            /* No room this time; a one-shot fd must be re-armed or it is lost */
+            if ((size_t)fd < ep->mode_capacity && ep->modes[fd] == EPOLL_FD_ONESHOT) {
+                poll_context_modify(&ep->poll, fd, POLL_CONTEXT_READ | POLL_CONTEXT_ONESHOT);
+                io->stats.syscalls++;
+            }
+            continue;
+        }
+
+        if (io_backend_is_listener(io, fd)) {
+            io->stats.syscalls++;
+            int client = accept(fd, NULL, NULL);
+            if (client < 0) continue;
+            io->stats.accepts++;
+            events[produced].type = IO_EVENT_ACCEPT;
+            events[produced].fd = client;
+            events[produced].data = NULL;
+            events[produced].length = 0;
+            produced++;
+            continue;
+        }
+
+        if ((size_t)fd >= ep->mode_capacity || ep->modes[fd] == EPOLL_FD_NONE) continue;
+        if (ep->modes[fd] == EPOLL_FD_ONESHOT) ep->modes[fd] = EPOLL_FD_DISARMED;
+
+        char* chunk = ep->chunks + (size_t)produced * IO_BACKEND_BUFFER_SIZE;
+        io->stats.syscalls++;
+        ssize_t n = recv(fd, chunk, IO_BACKEND_BUFFER_SIZE, MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            if (ep->modes[fd] == EPOLL_FD_DISARMED) epoll_backend_arm(io, fd, false);
+            continue;
+        }
+
+        events[produced].fd = fd;
+        if (n > 0) {
+            io->stats.receives++;
+            io->stats.bytes_in += (uint64_t)n;
+            events[produced].type = IO_EVENT_DATA;
+            events[produced].data = chunk;
+            events[produced].length = (size_t)n;
+        } else {
+            /* EOF or error: stop reporting the fd */
+            epoll_backend_unwatch(io, fd);
+            events[produced].type = IO_EVENT_CLOSED;
+            events[produced].data = NULL;
+            events[produced].length = 0;
+        }
+        produced++;
+    }
+
+    *count = produced;
+    return SUCCESS;
+}
+
+error_code_t io_backend_init(io_backend_t* io, io_backend_kind_t kind, int listen_fd) {
+    if (!io) return ERR_INVALID_PARAM;
+
+    memset(io, 0, sizeof(*io));
+    if (listen_fd >= 0) io->listeners[io->listener_count++] = listen_fd;
+
+    if (kind == IO_BACKEND_URING) {
+        io->kind = IO_BACKEND_URING;
+        if (uring_backend_init(io) == SUCCESS) return SUCCESS;
+    }
+
+    io->kind = IO_BACKEND_EPOLL;
+    return epoll_backend_init(io);
+}
+
+void io_backend_destroy(io_backend_t* io) {
+    if (!io || !io->impl) return;
+    if (io->kind == IO_BACKEND_URING) {
+        uring_backend_destroy(io);
+    } else {
+        epoll_backend_destroy(io);
+    }
+    io->impl = NULL;
+}
+
+error_code_t io_backend_listen(io_backend_t* io, int listen_fd) {
+    if (!io || !io->impl || listen_fd < 0) return ERR_INVALID_PARAM;
+    if (io->listener_count == IO_BACKEND_MAX_LISTENERS) return ERR_MAX_CAPACITY;
+
+    /* io_uring arms the accept with the next wait */
+    if (io->kind == IO_BACKEND_EPOLL) {
+        epoll_backend_t* ep = (epoll_backend_t*)io->impl;
+        io->stats.syscalls++;
+        if (poll_context_add(&ep->poll, listen_fd, POLL_CONTEXT_READ) != SUCCESS) return ERR_NETWORK_ERROR;
+    }
+    io->listeners[io->listener_count++] = listen_fd;
+    return SUCCESS;
+}
+
+error_code_t io_backend_watch(io_backend_t* io, int fd) {
+    if (!io || !io->impl || fd < 0) return ERR_INVALID_PARAM;
+    if (io->kind == IO_BACKEND_URING) return uring_backend_arm(io, fd, true);
+    return epoll_backend_arm(io, fd, true);
+}
+
+error_code_t io_backend_recv(io_backend_t* io, int fd) {
+    if (!io || !io->impl || fd < 0) return ERR_INVALID_PARAM;
+    if (io->kind == IO_BACKEND_URING) return uring_backend_arm(io, fd, false);
+    return epoll_backend_arm(io, fd, false);
+}
+
+error_code_t io_backend_unwatch(io_backend_t* io, int fd) {
+    if (!io || !io->impl || fd < 0) return ERR_INVALID_PARAM;
+    if (io->kind == IO_BACKEND_URING) return uring_backend_unwatch(io, fd);
+    return epoll_backend_unwatch(io, fd);
+}
+
+error_code_t io_backend_send(io_backend_t* io, int fd, const void* header, size_t header_size,
+                             const void* payload, size_t payload_size) {
+    if (!io || !io->impl || fd < 0 || !header || (!payload && payload_size > 0)) return ERR_INVALID_PARAM;
+    if (header_size + payload_size > MAX_MESSAGE_SIZE) return ERR_SERIALIZATION;
+
+    io->stats.sends++;
+    io->stats.bytes_out += header_size + payload_size;
+    if (io->kind == IO_BACKEND_URING) return uring_backend_send(io, fd, header, header_size, payload, payload_size);
+    return epoll_backend_send(io, fd, header, header_size, payload, payload_size);
+}
+
+error_code_t io_backend_wait(io_backend_t* io, io_event_t* events, int max_events, int timeout_ms,
+                             int* count) {
+    if (!io || !io->impl || !events || max_events <= 0 || !count) return ERR_INVALID_PARAM;
+    if (max_events > IO_BACKEND_MAX_EVENTS) max_events = IO_BACKEND_MAX_EVENTS;
+
+    *count = 0;
+    if (io->kind == IO_BACKEND_URING) return uring_backend_wait(io, events, max_events, timeout_ms, count);
+    return epoll_backend_wait(io, events, max_events, timeout_ms, count);
+}
+
+const char* io_backend_name(io_backend_kind_t kind) {
+    return kind == IO_BACKEND_URING ? "io_uring" : "epoll";
+}
+
+error_code_t io_backend_parse(const char* name, io_backend_kind_t* kind) {
+    if (!name || !kind) return ERR_INVALID_PARAM;
+    if (strcmp(name, "epoll") == 0) {
+        *kind = IO_BACKEND_EPOLL;
+    } else if (strcmp(name, "io_uring") == 0 || strcmp(name, "uring") == 0) {
+        *kind = IO_BACKEND_URING;
+    } else {
+        return ERR_INVALID_PARAM;
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,632 @@
+/* Event-Driven Socket Backend - io_uring
+ * Talks to the kernel through the raw io_uring syscalls (no liburing).
+ *  - Accept: one multishot accept per listener yields every connection.
+ *  - Receive: multishot (or one-shot) receives that pick a buffer from a
+ *    registered buffer ring, so idle sockets hold no memory. Buffers handed
+ *    out by a wait go back to the ring at the start of the next wait.
+ *  - Send: frames are copied into slots and queued per fd; each fd has at
+ *    most one chain in flight, linked with IOSQE_IO_LINK so frames leave in
+ *    order. Short or cancelled sends are resubmitted from where they stopped.
+ * Arming and sends are only queued in the submission ring; io_backend_wait()
+ * submits them and reaps completions in one io_uring_enter.
+ * Needs Linux 6.0 or later (buffer rings, multishot receive).
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "../../include/network/io_backend.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#define URING_SQ_ENTRIES 1024
+#define URING_CQ_ENTRIES 8192
+#define URING_BUFFER_GROUP 0
+#define URING_CHAIN_MAX 16      /* Frames per linked send chain */
+
+/* user_data: operation in the top byte. Receive/cancel carry a 24-bit
+ * generation and the fd below it, accepts the listener index; sends carry
+ * their slot pointer
+ * (user-space pointers fit in 56 bits). */
+#define URING_OP_SHIFT 56
+#define URING_GEN_SHIFT 32
+#define URING_GEN_MASK 0xFFFFFFu
+
+enum {
+    URING_OP_ACCEPT = 1,
+    URING_OP_RECV,
+    URING_OP_SEND,
+    URING_OP_CANCEL
+};
+
+enum {
+    URING_RECV_NONE = 0,
+    URING_RECV_ONESHOT,
+    URING_RECV_MULTISHOT
+};
+
+typedef struct uring_slot {
+    struct uring_slot* next;
+    int fd;
+    uint32_t gen;
+    bool inflight;
+    size_t length;
+    size_t offset;          /* Bytes already sent */
+    char data[];
+} uring_slot_t;
+
+/* Per-fd state */
+typedef struct {
+    uint32_t gen;           /* Bumped by unwatch; older completions are dropped */
+    uint8_t recv;           /* URING_RECV_* wanted */
+    bool armed;             /* A receive is outstanding in the kernel */
+    bool rearm;             /* Submit a receive at the next wait */
+    bool dirty;             /* On the dirty list */
+    bool failed;            /* A send failed; discard the rest of the queue */
+    int inflight;           /* Frames of the current chain still in the kernel */
+    uring_slot_t* send_head;
+    uring_slot_t* send_tail;
+} uring_fd_t;
+
+typedef struct {
+    int ring_fd;
+
+    /* Submission ring */
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_flags;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned sq_local_tail;
+    struct io_uring_sqe* sqes;
+
+    /* Completion ring */
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+
+    void* ring_ptr;
+    size_t ring_size;
+    size_t sqes_size;
+
+    /* Provided receive buffers */
+    struct io_uring_buf_ring* buf_ring;
+    size_t buf_ring_size;
+    char* buffers;
+    uint16_t buf_tail;
+    uint16_t lent[IO_BACKEND_BUFFER_COUNT];  /* Handed out by the last wait */
+    int lent_count;
+
+    uring_fd_t* fds;
+    size_t fd_capacity;
+    int* dirty;
+    int dirty_count;
+    int dirty_capacity;
+
+    uring_slot_t* zombies;  /* In-flight sends of unwatched fds */
+    bool accept_armed[IO_BACKEND_MAX_LISTENERS];
+} uring_backend_t;
+
+static int uring_setup(unsigned entries, struct io_uring_params* params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static uint64_t uring_fd_data(int op, uint32_t gen, int fd) {
+    return ((uint64_t)op << URING_OP_SHIFT) | ((uint64_t)(gen & URING_GEN_MASK) << URING_GEN_SHIFT) |
+           (uint32_t)fd;
+}
+
+static unsigned uring_sq_space(const uring_backend_t* ur) {
+    unsigned head = __atomic_load_n(ur->sq_head, __ATOMIC_ACQUIRE);
+    return ur->sq_entries - (ur->sq_local_tail - head);
+}
+
+static struct io_uring_sqe* uring_get_sqe(uring_backend_t* ur) {
+    if (uring_sq_space(ur) == 0) return NULL;
+    struct io_uring_sqe* sqe = &ur->sqes[ur->sq_local_tail & ur->sq_mask];
+    ur->sq_local_tail++;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+/* Submit everything queued; with min_complete, also wait (timeout < 0: forever) */
+static int uring_enter(io_backend_t* io, unsigned min_complete, int timeout_ms) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+
+    __atomic_store_n(ur->sq_tail, ur->sq_local_tail, __ATOMIC_RELEASE);
+    unsigned to_submit = ur->sq_local_tail - __atomic_load_n(ur->sq_head, __ATOMIC_ACQUIRE);
+
+    unsigned flags = 0;
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    void* argp = NULL;
+    size_t argsz = 0;
+
+    if (min_complete > 0) {
+        flags |= IORING_ENTER_GETEVENTS;
+        if (timeout_ms >= 0) {
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000LL;
+            memset(&arg, 0, sizeof(arg));
+            arg.ts = (uint64_t)(uintptr_t)&ts;
+            flags |= IORING_ENTER_EXT_ARG;
+            argp = &arg;
+            argsz = sizeof(arg);
+        }
+    } else if (__atomic_load_n(ur->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) {
+        /* Let the kernel move overflowed completions into the ring */
+        flags |= IORING_ENTER_GETEVENTS;
+    } else if (to_submit == 0) {
+        return 0;
+    }
+
+    io->stats.syscalls++;
+    int ret = (int)syscall(__NR_io_uring_enter, ur->ring_fd, to_submit, min_complete, flags, argp, argsz);
+    return ret < 0 ? -errno : ret;
+}
+
+/* Make room for n SQEs in a row (a link chain must not span two submits) */
+static bool uring_reserve(io_backend_t* io, unsigned n) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+    if (uring_sq_space(ur) >= n) return true;
+    uring_enter(io, 0, 0);
+    return uring_sq_space(ur) >= n;
+}
+
+static uring_fd_t* uring_fd_state(uring_backend_t* ur, int fd) {
+    if (fd < 0) return NULL;
+    if ((size_t)fd >= ur->fd_capacity) {
+        size_t capacity = ur->fd_capacity ? ur->fd_capacity : 1024;
+        while (capacity <= (size_t)fd) capacity *= 2;
+        uring_fd_t* grown = realloc(ur->fds, capacity * sizeof(uring_fd_t));
+        if (!grown) return NULL;
+        memset(grown + ur->fd_capacity, 0, (capacity - ur->fd_capacity) * sizeof(uring_fd_t));
+        ur->fds = grown;
+        ur->fd_capacity = capacity;
+    }
+    return &ur->fds[fd];
+}
+
+static void uring_mark_dirty(uring_backend_t* ur, int fd) {
+    uring_fd_t* state = &ur->fds[fd];
+    if (state->dirty) return;
+
+    if (ur->dirty_count == ur->dirty_capacity) {
+        int capacity = ur->dirty_capacity ? ur->dirty_capacity * 2 : 256;
+        int* grown = realloc(ur->dirty, (size_t)capacity * sizeof(int));
+        if (!grown) return;
+        ur->dirty = grown;
+        ur->dirty_capacity = capacity;
+    }
+    ur->dirty[ur->dirty_count++] = fd;
+    state->dirty = true;
+}
+
+static void uring_recycle(uring_backend_t* ur, uint16_t bid) {
+    struct io_uring_buf* buf = &ur->buf_ring->bufs[ur->buf_tail & (IO_BACKEND_BUFFER_COUNT - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(ur->buffers + (size_t)bid * IO_BACKEND_BUFFER_SIZE);
+    buf->len = IO_BACKEND_BUFFER_SIZE;
+    buf->bid = bid;
+    ur->buf_tail++;
+}
+
+static void uring_publish_buffers(uring_backend_t* ur) {
+    __atomic_store_n(&ur->buf_ring->tail, ur->buf_tail, __ATOMIC_RELEASE);
+}
+
+static void uring_release(uring_backend_t* ur) {
+    if (ur->buf_ring) munmap(ur->buf_ring, ur->buf_ring_size);
+    if (ur->sqes) munmap(ur->sqes, ur->sqes_size);
+    if (ur->ring_ptr) munmap(ur->ring_ptr, ur->ring_size);
+    if (ur->ring_fd >= 0) close(ur->ring_fd);
+    free(ur->buffers);
+    free(ur);
+}
+
+error_code_t uring_backend_init(io_backend_t* io) {
+    uring_backend_t* ur = calloc(1, sizeof(uring_backend_t));
+    if (!ur) return ERR_MAX_CAPACITY;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = URING_CQ_ENTRIES;
+    ur->ring_fd = uring_setup(URING_SQ_ENTRIES, &params);
+    if (ur->ring_fd < 0) {
+        free(ur);
+        return ERR_NETWORK_ERROR;
+    }
+
+    uint32_t required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & required) != required) {
+        uring_release(ur);
+        return ERR_NETWORK_ERROR;
+    }
+
+    /* SQ and CQ rings share one mapping */
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ur->ring_size = sq_size > cq_size ? sq_size : cq_size;
+    ur->ring_ptr = mmap(NULL, ur->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ur->ring_fd, IORING_OFF_SQ_RING);
+    if (ur->ring_ptr == MAP_FAILED) {
+        ur->ring_ptr = NULL;
+        uring_release(ur);
+        return ERR_NETWORK_ERROR;
+    }
+    ur->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ur->sqes = mmap(NULL, ur->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ur->ring_fd, IORING_OFF_SQES);
+    if (ur->sqes == MAP_FAILED) {
+        ur->sqes = NULL;
+        uring_release(ur);
+        return ERR_NETWORK_ERROR;
+    }
+
+    char* base = (char*)ur->ring_ptr;
+    ur->sq_head = (unsigned*)(base + params.sq_off.head);
+    ur->sq_tail = (unsigned*)(base + params.sq_off.tail);
+    ur->sq_flags = (unsigned*)(base + params.sq_off.flags);
+    ur->sq_mask = *(unsigned*)(base + params.sq_off.ring_mask);
+    ur->sq_entries = *(unsigned*)(base + params.sq_off.ring_entries);
+    ur->sq_local_tail = *ur->sq_tail;
+    unsigned* sq_array = (unsigned*)(base + params.sq_off.array);
+    for (unsigned i = 0; i < ur->sq_entries; i++) sq_array[i] = i;
+
+    ur->cq_head = (unsigned*)(base + params.cq_off.head);
+    ur->cq_tail = (unsigned*)(base + params.cq_off.tail);
+    ur->cq_mask = *(unsigned*)(base + params.cq_off.ring_mask);
+    ur->cqes = (struct io_uring_cqe*)(base + params.cq_off.cqes);
+
+    /* Buffer ring: the kernel picks a buffer per receive */
+    ur->buf_ring_size = IO_BACKEND_BUFFER_COUNT * sizeof(struct io_uring_buf);
+    ur->buf_ring = mmap(NULL, ur->buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ur->buffers = malloc((size_t)IO_BACKEND_BUFFER_COUNT * IO_BACKEND_BUFFER_SIZE);
+    if (ur->buf_ring == MAP_FAILED || !ur->buffers) {
+        if (ur->buf_ring == MAP_FAILED) ur->buf_ring = NULL;
+        uring_release(ur);
+        return ERR_MAX_CAPACITY;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ur->buf_ring;
+    reg.ring_entries = IO_BACKEND_BUFFER_COUNT;
+    reg.bgid = URING_BUFFER_GROUP;
+    if (uring_register(ur->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        uring_release(ur);
+        return ERR_NETWORK_ERROR;
+    }
+    for (uint16_t bid = 0; bid < IO_BACKEND_BUFFER_COUNT; bid++) uring_recycle(ur, bid);
+    uring_publish_buffers(ur);
+
+    io->impl = ur;
+    return SUCCESS;
+}
+
+static void uring_free_queue(uring_backend_t* ur, uring_fd_t* state) {
+    uring_slot_t* slot = state->send_head;
+    while (slot) {
+        uring_slot_t* next = slot->next;
+        if (slot->inflight) {
+            /* Still referenced by the kernel; freed when it completes */
+            slot->next = ur->zombies;
+            ur->zombies = slot;
+        } else {
+            free(slot);
+        }
+        slot = next;
+    }
+    state->send_head = NULL;
+    state->send_tail = NULL;
+    state->inflight = 0;
+    state->failed = false;
+}
+
+void uring_backend_destroy(io_backend_t* io) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+
+    /* Closing the ring cancels whatever is still outstanding */
+    close(ur->ring_fd);
+    ur->ring_fd = -1;
+
+    for (size_t fd = 0; fd < ur->fd_capacity; fd++) {
+        uring_slot_t* slot = ur->fds[fd].send_head;
+        while (slot) {
+            uring_slot_t* next = slot->next;
+            free(slot);
+            slot = next;
+        }
+    }
+    while (ur->zombies) {
+        uring_slot_t* next = ur->zombies->next;
+        free(ur->zombies);
+        ur->zombies = next;
+    }
+    free(ur->fds);
+    free(ur->dirty);
+    uring_release(ur);
+}
+
+error_code_t uring_backend_arm(io_backend_t* io, int fd, bool multishot) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+    uring_fd_t* state = uring_fd_state(ur, fd);
+    if (!state) return ERR_MAX_CAPACITY;
+
+    state->recv = multishot ? URING_RECV_MULTISHOT : URING_RECV_ONESHOT;
+    if (!state->armed) {
+        state->rearm = true;
+        uring_mark_dirty(ur, fd);
+    }
+    return SUCCESS;
+}
+
+error_code_t uring_backend_unwatch(io_backend_t* io, int fd) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+    if ((size_t)fd >= ur->fd_capacity) return SUCCESS;
+    uring_fd_t* state = &ur->fds[fd];
+
+    if (state->armed || state->inflight > 0) {
+        /* Cancel now, while fd still names this socket: once the caller
+         * closes it, a pending receive would keep the socket open */
+        if (uring_reserve(io, 1)) {
+            struct io_uring_sqe* sqe = uring_get_sqe(ur);
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = fd;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+            sqe->user_data = uring_fd_data(URING_OP_CANCEL, state->gen, fd);
+            uring_enter(io, 0, 0);
+        }
+    }
+
+    state->gen++;
+    state->recv = URING_RECV_NONE;
+    state->armed = false;
+    state->rearm = false;
+    uring_free_queue(ur, state);
+    return SUCCESS;
+}
+
+error_code_t uring_backend_send(io_backend_t* io, int fd, const void* header, size_t header_size,
+                                const void* payload, size_t payload_size) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+    uring_fd_t* state = uring_fd_state(ur, fd);
+    if (!state) return ERR_MAX_CAPACITY;
+
+    uring_slot_t* slot = malloc(sizeof(uring_slot_t) + header_size + payload_size);
+    if (!slot) return ERR_MAX_CAPACITY;
+    slot->next = NULL;
+    slot->fd = fd;
+    slot->gen = state->gen;
+    slot->inflight = false;
+    slot->length = header_size + payload_size;
+    slot->offset = 0;
+    memcpy(slot->data, header, header_size);
+    if (payload_size > 0) memcpy(slot->data + header_size, payload, payload_size);
+
+    if (state->send_tail) {
+        state->send_tail->next = slot;
+    } else {
+        state->send_head = slot;
+    }
+    state->send_tail = slot;
+    uring_mark_dirty(ur, fd);
+    return SUCCESS;
+}
+
+static void uring_submit_recv(io_backend_t* io, int fd, uring_fd_t* state) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+    if (!uring_reserve(io, 1)) return;
+
+    struct io_uring_sqe* sqe = uring_get_sqe(ur);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->ioprio = state->recv == URING_RECV_MULTISHOT ? IORING_RECV_MULTISHOT : 0;
+    sqe->user_data = uring_fd_data(URING_OP_RECV, state->gen, fd);
+    state->armed = true;
+    state->rearm = false;
+}
+
+static void uring_submit_sends(io_backend_t* io, int fd, uring_fd_t* state) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+
+    unsigned count = 0;
+    for (uring_slot_t* slot = state->send_head; slot && count < URING_CHAIN_MAX; slot = slot->next) count++;
+    if (!uring_reserve(io, count)) return;
+
+    uring_slot_t* slot = state->send_head;
+    for (unsigned i = 0; i < count; i++, slot = slot->next) {
+        struct io_uring_sqe* sqe = uring_get_sqe(ur);
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t)(uintptr_t)(slot->data + slot->offset);
+        sqe->len = (uint32_t)(slot->length - slot->offset);
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        if (i + 1 < count) sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = ((uint64_t)URING_OP_SEND << URING_OP_SHIFT) | (uint64_t)(uintptr_t)slot;
+        slot->inflight = true;
+        state->inflight++;
+    }
+}
+
+static void uring_submit_pending(io_backend_t* io) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+
+    for (int i = 0; i < io->listener_count; i++) {
+        if (ur->accept_armed[i] || !uring_reserve(io, 1)) continue;
+        struct io_uring_sqe* sqe = uring_get_sqe(ur);
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = io->listeners[i];
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->user_data = ((uint64_t)URING_OP_ACCEPT << URING_OP_SHIFT) | (uint64_t)i;
+        ur->accept_armed[i] = true;
+    }
+
+    for (int i = 0; i < ur->dirty_count; i++) {
+        int fd = ur->dirty[i];
+        uring_fd_t* state = &ur->fds[fd];
+        state->dirty = false;
+        if (state->rearm && state->recv != URING_RECV_NONE && !state->armed) {
+            uring_submit_recv(io, fd, state);
+        }
+        if (state->send_head && state->inflight == 0) {
+            uring_submit_sends(io, fd, state);
+        }
+    }
+    ur->dirty_count = 0;
+}
+
+static void uring_complete_send(uring_backend_t* ur, uring_slot_t* slot, int res) {
+    int fd = slot->fd;
+    uring_fd_t* state = (size_t)fd < ur->fd_capacity ? &ur->fds[fd] : NULL;
+
+    if (!state || slot->gen != state->gen) {
+        /* The fd was unwatched while this was in flight */
+        uring_slot_t** link = &ur->zombies;
+        while (*link && *link != slot) link = &(*link)->next;
+        if (*link) *link = slot->next;
+        free(slot);
+        return;
+    }
+
+    slot->inflight = false;
+    state->inflight--;
+
+    bool done = false;
+    if (res >= 0) {
+        slot->offset += (size_t)res;
+        done = slot->offset >= slot->length;
+    } else if (res != -ECANCELED) {
+        /* The receive side reports the broken connection */
+        state->failed = true;
+    }
+
+    if (done || state->failed) {
+        uring_slot_t** link = &state->send_head;
+        while (*link && *link != slot) link = &(*link)->next;
+        if (*link) {
+            *link = slot->next;
+            if (state->send_tail == slot) {
+                state->send_tail = NULL;
+                for (uring_slot_t* s = state->send_head; s; s = s->next) state->send_tail = s;
+            }
+        }
+        free(slot);
+    }
+
+    if (state->inflight == 0) {
+        if (state->failed) uring_free_queue(ur, state);
+        if (state->send_head) uring_mark_dirty(ur, fd);
+    }
+}
+
+error_code_t uring_backend_wait(io_backend_t* io, io_event_t* events, int max_events, int timeout_ms,
+                                int* count) {
+    uring_backend_t* ur = (uring_backend_t*)io->impl;
+
+    /* Buffers lent by the previous wait go back to the kernel */
+    for (int i = 0; i < ur->lent_count; i++) uring_recycle(ur, ur->lent[i]);
+    ur->lent_count = 0;
+    uring_publish_buffers(ur);
+
+    uring_submit_pending(io);
+
+    unsigned head = *ur->cq_head;
+    bool empty = head == __atomic_load_n(ur->cq_tail, __ATOMIC_ACQUIRE);
+    int ret = uring_enter(io, empty && timeout_ms != 0 ? 1 : 0, timeout_ms);
+    if (ret < 0 && ret != -ETIME && ret != -EINTR && ret != -EBUSY && ret != -EAGAIN) {
+        return ERR_NETWORK_ERROR;
+    }
+
+    int produced = 0;
+    unsigned tail = __atomic_load_n(ur->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail && produced < max_events) {
+        struct io_uring_cqe* cqe = &ur->cqes[head & ur->cq_mask];
+        uint64_t data = cqe->user_data;
+        int res = cqe->res;
+        uint32_t flags = cqe->flags;
+        head++;
+
+        int op = (int)(data >> URING_OP_SHIFT);
+        if (op == URING_OP_SEND) {
+            uring_complete_send(ur, (uring_slot_t*)(uintptr_t)(data & ((1ULL << URING_OP_SHIFT) - 1)), res);
+        } else if (op == URING_OP_ACCEPT) {
+            int listener = (int)(uint32_t)data;
+            if (!(flags & IORING_CQE_F_MORE) && listener < IO_BACKEND_MAX_LISTENERS) {
+                ur->accept_armed[listener] = false;
+            }
+            if (res >= 0) {
+                io->stats.accepts++;
+                events[produced].type = IO_EVENT_ACCEPT;
+                events[produced].fd = res;
+                events[produced].data = NULL;
+                events[produced].length = 0;
+                produced++;
+            }
+        } else if (op == URING_OP_RECV) {
+            int fd = (int)(uint32_t)data;
+            uint32_t gen = (uint32_t)(data >> URING_GEN_SHIFT) & URING_GEN_MASK;
+            bool has_buffer = (flags & IORING_CQE_F_BUFFER) != 0;
+            uint16_t bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+            uring_fd_t* state = (size_t)fd < ur->fd_capacity ? &ur->fds[fd] : NULL;
+
+            if (!state || (state->gen & URING_GEN_MASK) != gen) {
+                /* Stale: the fd was unwatched */
+                if (has_buffer) uring_recycle(ur, bid);
+                continue;
+            }
+            if (!(flags & IORING_CQE_F_MORE)) state->armed = false;
+
+            if (res > 0 && has_buffer) {
+                ur->lent[ur->lent_count++] = bid;
+                io->stats.receives++;
+                io->stats.bytes_in += (uint64_t)res;
+                events[produced].type = IO_EVENT_DATA;
+                events[produced].fd = fd;
+                events[produced].data = ur->buffers + (size_t)bid * IO_BACKEND_BUFFER_SIZE;
+                events[produced].length = (size_t)res;
+                produced++;
+                if (state->recv == URING_RECV_ONESHOT) {
+                    state->recv = URING_RECV_NONE;
+                } else if (!state->armed) {
+                    state->rearm = true;
+                    uring_mark_dirty(ur, fd);
+                }
+            } else if (res == -ENOBUFS) {
+                /* Ring ran dry; retry once this wait's buffers are back */
+                if (has_buffer) uring_recycle(ur, bid);
+                state->rearm = true;
+                uring_mark_dirty(ur, fd);
+            } else if (res != -ECANCELED) {
+                if (has_buffer) uring_recycle(ur, bid);
+                state->recv = URING_RECV_NONE;
+                events[produced].type = IO_EVENT_CLOSED;
+                events[produced].fd = fd;
+                events[produced].data = NULL;
+                events[produced].length = 0;
+                produced++;
+            }
+        }
+        /* URING_OP_CANCEL: nothing to do */
+
+        if (head == tail) tail = __atomic_load_n(ur->cq_tail, __ATOMIC_ACQUIRE);
+    }
+    __atomic_store_n(ur->cq_head, head, __ATOMIC_RELEASE);
+    uring_publish_buffers(ur);
+
+    *count = produced;
+    return SUCCESS;
+}
@@ -0,0 +1,153 @@
+#define _DEFAULT_SOURCE
+
+#include "../../include/network/read_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+
+read_buffer_t* read_buffer_create(void) {
+    read_buffer_t* rb = malloc(sizeof(read_buffer_t));
+    if (!rb) return NULL;
+    read_buffer_reset(rb);
+    return rb;
+}
+
+void read_buffer_destroy(read_buffer_t* rb) {
+    free(rb);
+}
+
+void read_buffer_reset(read_buffer_t* rb) {
+    if (!rb) return;
+    rb->head = 0;
+    rb->count = 0;
+    memset(&rb->stats, 0, sizeof(rb->stats));
+}
+
+/* Copy `size` unread bytes starting `offset` past head, following the wrap */
+static void ring_copy_out(const read_buffer_t* rb, size_t offset, void* out, size_t size) {
+    size_t start = (rb->head + offset) % READ_BUFFER_SIZE;
+    size_t first = READ_BUFFER_SIZE - start;
+    if (first > size) first = size;
+    memcpy(out, rb->data + start, first);
+    memcpy((char*)out + first, rb->data, size - first);
+}
+
+error_code_t read_buffer_fill(read_buffer_t* rb, int fd, bool block, size_t* received) {
+    if (!rb || fd < 0) return ERR_INVALID_PARAM;
+    if (received) *received = 0;
+
+    size_t free_space = READ_BUFFER_SIZE - rb->count;
+    if (free_space == 0) return SUCCESS;
+
+    /* Empty: restart at offset 0 so the next frames are contiguous */
+    if (rb->count == 0) rb->head = 0;
+
+    /* Free space is at most two segments: tail to end, then start to head */
+    size_t tail = (rb->head + rb->count) % READ_BUFFER_SIZE;
+    struct iovec iov[2];
+    int iov_count = 1;
+    iov[0].iov_base = rb->data + tail;
+    if (tail >= rb->head) {
+        iov[0].iov_len = READ_BUFFER_SIZE - tail;
+        if (rb->head > 0) {
+            iov[1].iov_base = rb->data;
+            iov[1].iov_len = rb->head;
+            iov_count = 2;
+        }
+    } else {
+        iov[0].iov_len = rb->head - tail;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (size_t)iov_count;
+
+    ssize_t n;
+    do {
+        rb->stats.reads++;
+        n = recvmsg(fd, &msg, block ? 0 : MSG_DONTWAIT);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return SUCCESS;
+        return ERR_NETWORK_ERROR;
+    }
+    if (n == 0) return ERR_NETWORK_ERROR;  /* Peer closed */
+
+    rb->count += (size_t)n;
+    rb->stats.bytes += (uint64_t)n;
+    if (received) *received = (size_t)n;
+    return SUCCESS;
+}
+
+error_code_t read_buffer_append(read_buffer_t* rb, const void* data, size_t size) {
+    if (!rb || (!data && size > 0)) return ERR_INVALID_PARAM;
+    if (size > READ_BUFFER_SIZE - rb->count) return ERR_MAX_CAPACITY;
+
+    size_t tail = (rb->head + rb->count) % READ_BUFFER_SIZE;
+    size_t first = READ_BUFFER_SIZE - tail;
+    if (first > size) first = size;
+    memcpy(rb->data + tail, data, first);
+    memcpy(rb->data, (const char*)data + first, size - first);
+    rb->count += size;
+    return SUCCESS;
+}
+
+error_code_t read_buffer_peek_header(const read_buffer_t* rb, message_header_t* header) {
+    if (!rb || !header) return ERR_INVALID_PARAM;
+    if (rb->count < HEADER_SIZE) return ERR_TIMEOUT;
+
+    message_header_t wire;
+    ring_copy_out(rb, 0, &wire, HEADER_SIZE);
+    header->type = ntohl(wire.type);
+    header->length = ntohl(wire.length);
+    header->sequence = ntohl(wire.sequence);
+    header->reserved = ntohl(wire.reserved);
+    return SUCCESS;
+}
+
+error_code_t read_buffer_next_frame(read_buffer_t* rb, frame_view_t* view) {
+    if (!rb || !view) return ERR_INVALID_PARAM;
+
+    message_header_t header;
+    error_code_t err = read_buffer_peek_header(rb, &header);
+    if (err != SUCCESS) return err;
+
+    /* Validate message header */
+    if (header.length > MAX_PAYLOAD_SIZE) return ERR_SERIALIZATION;
+    if (rb->count < HEADER_SIZE + header.length) return ERR_TIMEOUT;
+
+    size_t start = (rb->head + HEADER_SIZE) % READ_BUFFER_SIZE;
+    if (start + header.length <= READ_BUFFER_SIZE) {
+        view->payload = rb->data + start;
+    } else {
+        /* Payload straddles the end of the ring */
+        ring_copy_out(rb, HEADER_SIZE, rb->scratch, header.length);
+        view->payload = rb->scratch;
+        rb->stats.linearized++;
+    }
+
+    view->type = (message_type_t)header.type;
+    view->sequence = header.sequence;
+    view->flags = header.reserved;
+    view->length = header.length;
+
+    /* Bytes stay in place until the next fill, which only writes free space */
+    rb->head = (rb->head + HEADER_SIZE + header.length) % READ_BUFFER_SIZE;
+    rb->count -= HEADER_SIZE + header.length;
+    rb->stats.frames++;
+    return SUCCESS;
+}
+
+size_t read_buffer_pending(const read_buffer_t* rb) {
+    return rb ? rb->count : 0;
+}
+
+void read_buffer_get_stats(const read_buffer_t* rb, read_buffer_stats_t* stats) {
+    if (!rb || !stats) return;
+    *stats = rb->stats;
+}
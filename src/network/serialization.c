@@ -76,6 +76,40 @@ error_code_t serialize_bytes(serialize_buffer_t* buffer, const void* data, size_
     return SUCCESS;
 }
 
+/* Variable-length integers: 7 bits per byte, high bit set on all but the last */
+error_code_t serialize_varint(serialize_buffer_t* buffer, uint64_t value) {
+    if (!buffer) return ERR_INVALID_PARAM;
+    
+    do {
+        if (buffer->position + 1 > MAX_MESSAGE_SIZE) return ERR_SERIALIZATION;
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        buffer->data[buffer->position++] = (char)byte;
+    } while (value);
+    if (buffer->position > buffer->size) buffer->size = buffer->position;
+    
+    return SUCCESS;
+}
+
+/* Signed values are zigzag-encoded so small negatives stay short */
+error_code_t serialize_svarint(serialize_buffer_t* buffer, int64_t value) {
+    return serialize_varint(buffer, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+/* Length-prefixed string: varint length then the bytes, no terminator */
+error_code_t serialize_lstring(serialize_buffer_t* buffer, const char* str, size_t max_len) {
+    if (!buffer || !str || max_len == 0) return ERR_INVALID_PARAM;
+    
+    /* Fields may not be terminated; never read past the field */
+    const char* end = memchr(str, '\0', max_len - 1);
+    size_t len = end ? (size_t)(end - str) : max_len - 1;
+    
+    error_code_t err = serialize_varint(buffer, len);
+    if (err != SUCCESS) return err;
+    return serialize_bytes(buffer, str, len);
+}
+
 error_code_t deserialize_int32(serialize_buffer_t* buffer, int32_t* value) {
     if (!buffer || !value) return ERR_INVALID_PARAM;
     if (buffer->position + sizeof(int32_t) > (size_t)buffer->size) return ERR_SERIALIZATION;
@@ -131,6 +165,49 @@ error_code_t deserialize_bytes(serialize_buffer_t* buffer, void* data, size_t si
     return SUCCESS;
 }
 
+error_code_t deserialize_varint(serialize_buffer_t* buffer, uint64_t* value) {
+    if (!buffer || !value) return ERR_INVALID_PARAM;
+    
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (buffer->position + 1 > buffer->size) return ERR_SERIALIZATION;
+        uint8_t byte = (uint8_t)buffer->data[buffer->position++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return SUCCESS;
+        }
+    }
+    
+    return ERR_SERIALIZATION;  /* More than 10 bytes */
+}
+
+error_code_t deserialize_svarint(serialize_buffer_t* buffer, int64_t* value) {
+    if (!value) return ERR_INVALID_PARAM;
+    
+    uint64_t raw;
+    error_code_t err = deserialize_varint(buffer, &raw);
+    if (err != SUCCESS) return err;
+    *value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+    
+    return SUCCESS;
+}
+
+error_code_t deserialize_lstring(serialize_buffer_t* buffer, char* str, size_t max_len) {
+    if (!buffer || !str || max_len == 0) return ERR_INVALID_PARAM;
+    
+    uint64_t len;
+    error_code_t err = deserialize_varint(buffer, &len);
+    if (err != SUCCESS) return err;
+    if (len >= max_len) return ERR_SERIALIZATION;
+    
+    err = deserialize_bytes(buffer, str, (size_t)len);
+    if (err != SUCCESS) return err;
+    str[len] = '\0';
+    
+    return SUCCESS;
+}
+
 error_code_t serialize_header(serialize_buffer_t* buffer, const message_header_t* header) {
     if (!buffer || !header) return ERR_INVALID_PARAM;
     
@@ -157,6 +234,17 @@ error_code_t deserialize_header(serialize_buffer_t* buffer, message_header_t* he
 
 error_code_t serialize_message(message_type_t type, const void* payload, size_t payload_size, 
                                void* output, size_t* output_size) {
+    return serialize_message_tagged(type, 0, payload, payload_size, output, output_size);
+}
+
+error_code_t serialize_message_tagged(message_type_t type, uint32_t sequence, const void* payload,
+                                      size_t payload_size, void* output, size_t* output_size) {
+    return serialize_message_frame(type, sequence, 0, payload, payload_size, output, output_size);
+}
+
+error_code_t serialize_message_frame(message_type_t type, uint32_t sequence, uint32_t flags,
+                                     const void* payload, size_t payload_size,
+                                     void* output, size_t* output_size) {
     if (!output || !output_size) return ERR_INVALID_PARAM;
     if (payload_size > MAX_PAYLOAD_SIZE) return ERR_SERIALIZATION;
     
@@ -167,8 +255,8 @@ error_code_t serialize_message(message_type_t type, const void* payload, size_t
     message_header_t header;
     header.type = type;
     header.length = payload_size;
-    header.sequence = 0;
-    header.reserved = 0;
+    header.sequence = sequence;
+    header.reserved = flags;
     
     // Serialize header
     error_code_t err = serialize_header(&buffer, &header);
@@ -236,6 +324,7 @@ error_code_t serialize_board_state(serialize_buffer_t* buffer, const msg_board_s
     error_code_t err;
     
     if ((err = serialize_bool(buffer, msg->exists)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
     if ((err = serialize_string(buffer, msg->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
     if ((err = serialize_string(buffer, msg->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
     if ((err = serialize_string(buffer, msg->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
@@ -257,7 +346,10 @@ error_code_t deserialize_board_state(serialize_buffer_t* buffer, msg_board_state
     if (!buffer || !msg) return ERR_INVALID_PARAM;
     error_code_t err;
     
+    uint64_t game;
     if ((err = deserialize_bool(buffer, &msg->exists)) != SUCCESS) return err;
+    if ((err = deserialize_varint(buffer, &game)) != SUCCESS) return err;
+    msg->game = (game_handle_t)game;
     if ((err = deserialize_string(buffer, msg->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
     if ((err = deserialize_string(buffer, msg->player_a, MAX_PSEUDO_LEN)) != SUCCESS) return err;
     if ((err = deserialize_string(buffer, msg->player_b, MAX_PSEUDO_LEN)) != SUCCESS) return err;
@@ -279,7 +371,7 @@ error_code_t serialize_move(serialize_buffer_t* buffer, const msg_play_move_t* m
     if (!buffer || !msg) return ERR_INVALID_PARAM;
     error_code_t err;
     
-    if ((err = serialize_string(buffer, msg->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
+    if ((err = serialize_varint(buffer, msg->game)) != SUCCESS) return err;
     if ((err = serialize_string(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
     if ((err = serialize_int32(buffer, msg->pit_index)) != SUCCESS) return err;
     
@@ -290,7 +382,9 @@ error_code_t deserialize_move(serialize_buffer_t* buffer, msg_play_move_t* msg)
     if (!buffer || !msg) return ERR_INVALID_PARAM;
     error_code_t err;
     
-    if ((err = deserialize_string(buffer, msg->game_id, MAX_GAME_ID_LEN)) != SUCCESS) return err;
+    uint64_t game;
+    if ((err = deserialize_varint(buffer, &game)) != SUCCESS) return err;
+    msg->game = (game_handle_t)game;
     if ((err = deserialize_string(buffer, msg->player, MAX_PSEUDO_LEN)) != SUCCESS) return err;
     if ((err = deserialize_int32(buffer, &msg->pit_index)) != SUCCESS) return err;
     
@@ -1,11 +1,26 @@
 #include "../../include/network/session.h"
 #include "../../include/network/serialization.h"
+#include "../../include/network/codec.h"
+#include "../../include/network/compression.h"
+#include "../../include/common/checksum.h"
 #include <string.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <arpa/inet.h>
 
+/* Reply context: while a server thread handles a tagged request, frames it
+ * sends to that same session echo the request's sequence number. Frames sent
+ * to any other session carry sequence 0 and are notifications. */
+static _Thread_local const session_t* t_reply_session = NULL;
+static _Thread_local uint32_t t_reply_sequence = 0;
+
+/* Send batch: the session a thread is serving stays corked until
+ * session_batch_flush(). Only that session: other clients' sessions belong
+ * to their own handler threads, which may close them before the flush. */
+static _Thread_local session_t* t_batch = NULL;
+
 /* Helper function to check if type is in expected list */
 static bool is_expected_type(message_type_t type, const message_type_t* expected_types, size_t num_expected) {
     if (!expected_types || num_expected == 0) return true;  /* Accept any if no expected specified */
@@ -20,10 +35,14 @@ error_code_t session_init(session_t* session) {
     
     connection_init(&session->conn);
     memset(session->pseudo, 0, MAX_PSEUDO_LEN);
+    session->player_id = 0;
     memset(session->session_id, 0, 64);
     session->authenticated = false;
     session->created_at = time(NULL);
     session->last_activity = time(NULL);
+    session->codec = CODEC_RAW;
+    session->features = 0;
+    session->backlog = NULL;
     
     return SUCCESS;
 }
@@ -54,7 +73,86 @@ error_code_t session_close(session_t* session) {
     return SUCCESS;
 }
 
-error_code_t session_send_message(session_t* session, message_type_t type, const void* payload, size_t payload_size) {
+void session_begin_reply(const session_t* session, uint32_t sequence) {
+    t_reply_session = session;
+    t_reply_sequence = sequence;
+}
+
+void session_end_reply(void) {
+    t_reply_session = NULL;
+    t_reply_sequence = 0;
+}
+
+void session_batch_begin(session_t* session) {
+    if (!session || !session->conn.tx || t_batch) return;
+    connection_cork(&session->conn);
+    t_batch = session;
+}
+
+void session_batch_flush(void) {
+    if (!t_batch) return;
+    /* A timeout wrote nothing and keeps the replies queued for the next
+     * send; a write torn part-way comes back as a network error */
+    if (connection_uncork(&t_batch->conn, 5000) == ERR_NETWORK_ERROR) {
+        t_batch->authenticated = false;
+    }
+    t_batch = NULL;
+}
+
+/* Hand a received payload to the caller, decoding compact frames */
+static error_code_t session_deliver_payload(message_type_t type, uint32_t flags, const char* data, size_t size,
+                                            void* payload, size_t max_payload_size, size_t* actual_size) {
+    if (size == 0) {
+        if (actual_size) *actual_size = 0;
+        return SUCCESS;
+    }
+    if (!payload) return ERR_SERIALIZATION;
+
+    /* Compression wraps whatever encoding the payload uses */
+    char inflated[MAX_PAYLOAD_SIZE];
+    if (flags & HEADER_FLAG_COMPRESSED) {
+        error_code_t err = compression_decompress(data, size, inflated, sizeof(inflated), &size);
+        if (err != SUCCESS) return err;
+        data = inflated;
+    }
+
+    if (flags & HEADER_FLAG_COMPACT) {
+        size_t decoded_size;
+        error_code_t err = codec_decode(type, data, size, payload, max_payload_size, &decoded_size);
+        if (err != SUCCESS) return err;
+        if (actual_size) *actual_size = decoded_size;
+        return SUCCESS;
+    }
+
+    if (size > max_payload_size) return ERR_SERIALIZATION;
+    memcpy(payload, data, size);
+    if (actual_size) *actual_size = size;
+    return SUCCESS;
+}
+
+/* CRC-32C of a frame as sent: its header, then the payload after the CRC */
+static uint32_t session_frame_crc(const message_header_t* wire_header, const void* body, size_t body_size) {
+    return checksum_crc32c(checksum_crc32c(0, wire_header, sizeof(*wire_header)), body, body_size);
+}
+
+/* Check a HEADER_FLAG_CHECKSUM frame and leave only its payload in view */
+static error_code_t session_verify_frame(frame_view_t* frame) {
+    if (frame->length < FRAME_CHECKSUM_SIZE) return ERR_SERIALIZATION;
+    message_header_t wire;
+    wire.type = htonl((uint32_t)frame->type);
+    wire.length = htonl((uint32_t)frame->length);
+    wire.sequence = htonl(frame->sequence);
+    wire.reserved = htonl(frame->flags);
+    uint32_t crc;
+    memcpy(&crc, frame->payload, sizeof(crc));
+    frame->payload += FRAME_CHECKSUM_SIZE;
+    frame->length -= FRAME_CHECKSUM_SIZE;
+    if (ntohl(crc) != session_frame_crc(&wire, frame->payload, frame->length)) return ERR_SERIALIZATION;
+    return SUCCESS;
+}
+
+static error_code_t session_write_frame(session_t* session, message_type_t type, uint32_t sequence,
+                                        const void* payload, size_t payload_size) {
     if (!session) return ERR_INVALID_PARAM;
     
     /* Check if connection is still alive before attempting send */
@@ -63,14 +161,54 @@ error_code_t session_send_message(session_t* session, message_type_t type, const
         return ERR_NETWORK_ERROR;
     }
     
-    char buffer[MAX_MESSAGE_SIZE];
-    size_t total_size;
+    const void* body = payload;
+    size_t body_size = payload_size;
+    uint32_t flags = 0;
+    
+    /* Compact peers get the variable-length encoding; anything the codec
+     * cannot represent still goes out raw */
+    char compact[MAX_PAYLOAD_SIZE];
+    size_t compact_size;
+    if (session->codec == CODEC_COMPACT && payload && payload_size > 0 && codec_supports(type) &&
+        codec_encode(type, payload, payload_size, compact, sizeof(compact), &compact_size) == SUCCESS) {
+        body = compact;
+        body_size = compact_size;
+        flags |= HEADER_FLAG_COMPACT;
+    }
+    
+    /* Large bulk responses are deflated if the peer asked for it */
+    char packed[MAX_PAYLOAD_SIZE];
+    size_t packed_size;
+    if ((session->features & CONNECT_FEATURE_COMPRESSION) && body &&
+        compression_should_compress(type, body_size) &&
+        compression_compress(body, body_size, packed, sizeof(packed), &packed_size) == SUCCESS) {
+        body = packed;
+        body_size = packed_size;
+        flags |= HEADER_FLAG_COMPRESSED;
+    }
+    
+    /* The CRC rides after the header, so the body is still not copied */
+    size_t checksum_size = 0;
+    if (session->features & CONNECT_FEATURE_CHECKSUM) {
+        checksum_size = FRAME_CHECKSUM_SIZE;
+        flags |= HEADER_FLAG_CHECKSUM;
+    }
     
-    error_code_t err = serialize_message(type, payload, payload_size, buffer, &total_size);
-    if (err != SUCCESS) return err;
+    if (body_size + checksum_size > MAX_PAYLOAD_SIZE) return ERR_SERIALIZATION;
     
-    /* Use send with timeout to prevent freezing */
-    err = connection_send_timeout(&session->conn, buffer, total_size, 5000);
+    /* Header and body go out as one scatter-gather write, no frame copy */
+    struct {
+        message_header_t header;
+        uint32_t crc;
+    } head;
+    head.header.type = htonl((uint32_t)type);
+    head.header.length = htonl((uint32_t)(body_size + checksum_size));
+    head.header.sequence = htonl(sequence);
+    head.header.reserved = htonl(flags);
+    if (checksum_size) head.crc = htonl(session_frame_crc(&head.header, body, body_size));
+    
+    error_code_t err = connection_send_frame(&session->conn, &head, sizeof(head.header) + checksum_size, body, body_size,
+                                             5000);
     if (err != SUCCESS) {
         /* Mark session as disconnected on error */
         if (err == ERR_NETWORK_ERROR) {
@@ -83,80 +221,127 @@ error_code_t session_send_message(session_t* session, message_type_t type, const
     return SUCCESS;
 }
 
-error_code_t session_recv_message(session_t* session, message_type_t* type, void* payload, size_t max_payload_size, size_t* actual_size, const message_type_t* expected_types, size_t num_expected) {
-    if (!session || !type) return ERR_INVALID_PARAM;
+/* Untagged frames on a resumable session take the next backlog slot.
+ * Recording and writing under one lock keeps the backlog in wire order,
+ * which is what lets the client's count of frames name a resume point. */
+static error_code_t session_send_frame(session_t* session, message_type_t type, uint32_t sequence,
+                                       const void* payload, size_t payload_size) {
+    session_backlog_t* backlog = session ? session->backlog : NULL;
+    if (sequence != 0 || !backlog) {
+        return session_write_frame(session, type, sequence, payload, payload_size);
+    }
 
-    /* Check if connection is still alive */
-    if (!connection_is_connected(&session->conn)) {
-        session->authenticated = false;
-        return ERR_NETWORK_ERROR;
+    pthread_mutex_lock(&backlog->lock);
+    session_backlog_frame_t* frame = &backlog->frames[backlog->recorded % SESSION_BACKLOG_FRAMES];
+    frame->type = type;
+    if (payload_size <= SESSION_BACKLOG_PAYLOAD) {
+        frame->size = (uint32_t)payload_size;
+        if (payload_size > 0) memcpy(frame->payload, payload, payload_size);
+    } else {
+        frame->size = SESSION_BACKLOG_DROPPED;
     }
+    backlog->recorded++;
+    error_code_t err = session_write_frame(session, type, sequence, payload, payload_size);
+    pthread_mutex_unlock(&backlog->lock);
+    return err;
+}
 
-    while (1) {
-        // First, read the header
-        message_header_t header;
-        size_t received;
+session_backlog_t* session_backlog_create(void) {
+    session_backlog_t* backlog = calloc(1, sizeof(session_backlog_t));
+    if (!backlog) return NULL;
+    pthread_mutex_init(&backlog->lock, NULL);
+    return backlog;
+}
+
+void session_backlog_destroy(session_backlog_t* backlog) {
+    if (!backlog) return;
+    pthread_mutex_destroy(&backlog->lock);
+    free(backlog);
+}
+
+error_code_t session_resume(session_t* session, connection_t* fresh, uint32_t notifications_seen) {
+    if (!session || !fresh) return ERR_INVALID_PARAM;
+
+    /* Holding the lock keeps other threads' notifications out until the
+     * replay is on the wire, so nothing overtakes it */
+    session_backlog_t* backlog = session->backlog;
+    if (backlog) pthread_mutex_lock(&backlog->lock);
+
+    error_code_t err = connection_resume(&session->conn, fresh);
+    if (err == SUCCESS) {
+        session->authenticated = true;
+        session_touch_activity(session);
 
-        error_code_t err = connection_recv_raw(&session->conn, &header, sizeof(header), &received);
-        if (err != SUCCESS) {
-            if (err == ERR_NETWORK_ERROR) {
-                session->authenticated = false;
+        /* The part of [seen, recorded) the ring still holds */
+        uint32_t end = backlog ? backlog->recorded : 0;
+        uint32_t oldest = end > SESSION_BACKLOG_FRAMES ? end - SESSION_BACKLOG_FRAMES : 0;
+        uint32_t first = notifications_seen;
+        bool complete = backlog && first >= oldest && first <= end;
+        if (first < oldest) first = oldest;
+        if (first > end) first = end;
+
+        msg_resume_ack_t ack;
+        memset(&ack, 0, sizeof(ack));
+        for (uint32_t i = first; i < end; i++) {
+            if (backlog->frames[i % SESSION_BACKLOG_FRAMES].size == SESSION_BACKLOG_DROPPED) {
+                complete = false;
+            } else {
+                ack.replayed++;
             }
-            return err;
         }
-        if (received != sizeof(header)) {
-            session->authenticated = false;
-            return ERR_NETWORK_ERROR;
+        ack.success = true;
+        ack.complete = complete;
+        ack.notifications_sent = end;
+        snprintf(ack.message, sizeof(ack.message), "Session resumed");
+
+        err = session_write_frame(session, MSG_RESUME_ACK, 0, &ack, sizeof(ack));
+        for (uint32_t i = first; i < end && err == SUCCESS; i++) {
+            const session_backlog_frame_t* frame = &backlog->frames[i % SESSION_BACKLOG_FRAMES];
+            if (frame->size == SESSION_BACKLOG_DROPPED) continue;
+            err = session_write_frame(session, frame->type, 0, frame->payload, frame->size);
         }
+    }
 
-        // Convert from network byte order
-        header.type = ntohl(header.type);
-        header.length = ntohl(header.length);
-        header.sequence = ntohl(header.sequence);
+    if (backlog) pthread_mutex_unlock(&backlog->lock);
+    return err;
+}
 
-        /* Validate message header */
-        if (header.length > MAX_PAYLOAD_SIZE) {
-            session->authenticated = false;
-            return ERR_SERIALIZATION;
-        }
+error_code_t session_send_message(session_t* session, message_type_t type, const void* payload, size_t payload_size) {
+    uint32_t sequence = (session && session == t_reply_session) ? t_reply_sequence : 0;
+    return session_send_frame(session, type, sequence, payload, payload_size);
+}
 
-        message_type_t msg_type = (message_type_t)header.type;
-
-        // Read payload if present
-        char temp_payload[MAX_PAYLOAD_SIZE];
-        size_t payload_size = 0;
-        if (header.length > 0) {
-            err = connection_recv_raw(&session->conn, temp_payload, header.length, &received);
-            if (err != SUCCESS) {
-                if (err == ERR_NETWORK_ERROR) {
-                    session->authenticated = false;
-                }
-                return err;
-            }
-            if (received != header.length) {
-                session->authenticated = false;
-                return ERR_NETWORK_ERROR;
-            }
-            payload_size = header.length;
-        }
+error_code_t session_send_notification(session_t* session, message_type_t type, const void* payload, size_t payload_size) {
+    return session_send_frame(session, type, 0, payload, payload_size);
+}
 
-        session_touch_activity(session);
+uint32_t session_next_sequence(session_t* session) {
+    if (!session) return 0;
 
-        if (is_expected_type(msg_type, expected_types, num_expected)) {
-            *type = msg_type;
-            if (payload_size > 0) {
-                if (!payload || payload_size > max_payload_size) return ERR_SERIALIZATION;
-                memcpy(payload, temp_payload, payload_size);
-            }
-            if (actual_size) *actual_size = payload_size;
-            return SUCCESS;
-        } else {
-            return ERR_UNEXPECTED_MESSAGE;
-        }
+    /* Tag 0 is reserved for notifications */
+    uint32_t sequence = ++session->conn.sequence;
+    if (sequence == 0) {
+        sequence = ++session->conn.sequence;
     }
+    return sequence;
 }
 
-error_code_t session_recv_message_timeout(session_t* session, message_type_t* type, void* payload, size_t max_payload_size, size_t* actual_size, int timeout_ms, const message_type_t* expected_types, size_t num_expected) {
+error_code_t session_send_tagged(session_t* session, message_type_t type, uint32_t sequence, const void* payload, size_t payload_size) {
+    return session_send_frame(session, type, sequence, payload, payload_size);
+}
+
+error_code_t session_send_request(session_t* session, message_type_t type, const void* payload, size_t payload_size, uint32_t* sequence_out) {
+    if (!session) return ERR_INVALID_PARAM;
+
+    uint32_t sequence = session_next_sequence(session);
+    error_code_t err = session_send_frame(session, type, sequence, payload, payload_size);
+    if (err == SUCCESS && sequence_out) *sequence_out = sequence;
+    return err;
+}
+
+/* Receive one frame from the connection's ring and hand it to the caller.
+ * The payload is decoded straight out of the ring; there is no staging copy. */
+static error_code_t session_recv_frame(session_t* session, message_type_t* type, uint32_t* sequence, void* payload, size_t max_payload_size, size_t* actual_size, int timeout_ms, const message_type_t* expected_types, size_t num_expected) {
     if (!session || !type) return ERR_INVALID_PARAM;
 
     /* Check if connection is still alive */
@@ -165,72 +350,44 @@ error_code_t session_recv_message_timeout(session_t* session, message_type_t* ty
         return ERR_NETWORK_ERROR;
     }
 
-    int remaining_timeout = timeout_ms;
-
-    while (remaining_timeout > 0) {
-        // First, read the header with timeout
-        message_header_t header;
-        size_t received;
-
-        error_code_t err = connection_recv_timeout(&session->conn, &header, sizeof(header), &received, remaining_timeout);
-        if (err != SUCCESS) {
-            if (err == ERR_NETWORK_ERROR) {
-                session->authenticated = false;
-            }
-            return err;
-        }
-        if (received != sizeof(header)) {
+    frame_view_t frame;
+    error_code_t err = connection_recv_frame(&session->conn, &frame, timeout_ms);
+    if (err != SUCCESS) {
+        if (err == ERR_NETWORK_ERROR || err == ERR_SERIALIZATION) {
             session->authenticated = false;
-            return ERR_NETWORK_ERROR;
         }
+        return err;
+    }
 
-        // Convert from network byte order
-        header.type = ntohl(header.type);
-        header.length = ntohl(header.length);
-        header.sequence = ntohl(header.sequence);
+    session_touch_activity(session);
 
-        /* Validate message header */
-        if (header.length > MAX_PAYLOAD_SIZE) {
-            session->authenticated = false;
-            return ERR_SERIALIZATION;
-        }
+    /* A frame that fails its checksum leaves nothing after it to trust */
+    if ((frame.flags & HEADER_FLAG_CHECKSUM) && session_verify_frame(&frame) != SUCCESS) {
+        session->authenticated = false;
+        return ERR_SERIALIZATION;
+    }
 
-        message_type_t msg_type = (message_type_t)header.type;
-
-        // Read payload if present (also with timeout)
-        char temp_payload[MAX_PAYLOAD_SIZE];
-        size_t payload_size = 0;
-        if (header.length > 0) {
-            err = connection_recv_timeout(&session->conn, temp_payload, header.length, &received, remaining_timeout);
-            if (err != SUCCESS) {
-                if (err == ERR_NETWORK_ERROR) {
-                    session->authenticated = false;
-                }
-                return err;
-            }
-            if (received != header.length) {
-                session->authenticated = false;
-                return ERR_NETWORK_ERROR;
-            }
-            payload_size = header.length;
-        }
+    if (!is_expected_type(frame.type, expected_types, num_expected)) {
+        return ERR_UNEXPECTED_MESSAGE;
+    }
+    *type = frame.type;
+    if (sequence) *sequence = frame.sequence;
+    return session_deliver_payload(frame.type, frame.flags, frame.payload, frame.length,
+                                   payload, max_payload_size, actual_size);
+}
 
-        session_touch_activity(session);
+error_code_t session_recv_message(session_t* session, message_type_t* type, void* payload, size_t max_payload_size, size_t* actual_size, const message_type_t* expected_types, size_t num_expected) {
+    return session_recv_frame(session, type, NULL, payload, max_payload_size, actual_size, -1, expected_types, num_expected);
+}
 
-        if (is_expected_type(msg_type, expected_types, num_expected)) {
-            *type = msg_type;
-            if (payload_size > 0) {
-                if (!payload || payload_size > max_payload_size) return ERR_SERIALIZATION;
-                memcpy(payload, temp_payload, payload_size);
-            }
-            if (actual_size) *actual_size = payload_size;
-            return SUCCESS;
-        } else {
-            return ERR_UNEXPECTED_MESSAGE;
-        }
-    }
+error_code_t session_recv_message_timeout(session_t* session, message_type_t* type, void* payload, size_t max_payload_size, size_t* actual_size, int timeout_ms, const message_type_t* expected_types, size_t num_expected) {
+    if (timeout_ms <= 0) return ERR_TIMEOUT;
+    return session_recv_frame(session, type, NULL, payload, max_payload_size, actual_size, timeout_ms, expected_types, num_expected);
+}
 
-    return ERR_TIMEOUT;  // If loop exits without finding expected
+error_code_t session_recv_tagged_timeout(session_t* session, message_type_t* type, uint32_t* sequence, void* payload, size_t max_payload_size, size_t* actual_size, int timeout_ms) {
+    if (timeout_ms <= 0) return ERR_TIMEOUT;
+    return session_recv_frame(session, type, sequence, payload, max_payload_size, actual_size, timeout_ms, NULL, 0);
 }
 
 error_code_t session_peek_message_type(session_t* session, message_type_t* type, int timeout_ms) {
@@ -242,26 +399,16 @@ error_code_t session_peek_message_type(session_t* session, message_type_t* type,
         return ERR_NETWORK_ERROR;
     }
 
-    // Peek the header
+    /* Peek the buffered header; bytes already pulled into the ring are no
+     * longer visible to MSG_PEEK on the socket */
     message_header_t header;
-    size_t received;
-
-    error_code_t err = connection_recv_peek(&session->conn, &header, sizeof(header), &received, timeout_ms);
+    error_code_t err = connection_peek_frame(&session->conn, &header, timeout_ms);
     if (err != SUCCESS) {
         if (err == ERR_NETWORK_ERROR) {
             session->authenticated = false;
         }
         return err;
     }
-    if (received != sizeof(header)) {
-        session->authenticated = false;
-        return ERR_NETWORK_ERROR;
-    }
-
-    // Convert from network byte order
-    header.type = ntohl(header.type);
-    header.length = ntohl(header.length);
-    header.sequence = ntohl(header.sequence);
 
     /* Validate message header */
     if (header.length > MAX_PAYLOAD_SIZE) {
@@ -282,10 +429,24 @@ error_code_t session_send_error(session_t* session, error_code_t error, const ch
     error_msg.error_code = error;
     strncpy(error_msg.error_msg, msg ? msg : error_to_string(error), 255);
     error_msg.error_msg[255] = '\0';
+    error_msg.retry_after_ms = 0;
     
     return session_send_message(session, MSG_ERROR, &error_msg, sizeof(error_msg));
 }
 
+error_code_t session_send_rate_limited(session_t* session, uint32_t retry_after_ms, const char* msg) {
+    if (!session) return ERR_INVALID_PARAM;
+
+    msg_error_t error_msg;
+    memset(&error_msg, 0, sizeof(error_msg));
+    error_msg.error_code = ERR_RATE_LIMITED;
+    snprintf(error_msg.error_msg, sizeof(error_msg.error_msg), "%s, retry in %u ms",
+             msg ? msg : error_to_string(ERR_RATE_LIMITED), retry_after_ms);
+    error_msg.retry_after_ms = retry_after_ms;
+
+    return session_send_message(session, MSG_ERROR, &error_msg, sizeof(error_msg));
+}
+
 error_code_t session_send_connect_ack(session_t* session, bool success, const char* msg) {
     if (!session) return ERR_INVALID_PARAM;
     
@@ -296,16 +457,28 @@ error_code_t session_send_connect_ack(session_t* session, bool success, const ch
     strncpy(ack.session_id, session->session_id, 63);
     ack.session_id[63] = '\0';
     
+    /* Plain 1.0 peers get the ack without the fields they do not know;
+     * newer peers learn the codec and features the rest of the connection uses */
+    if (session->codec != CODEC_COMPACT && session->features == 0) {
+        return session_send_message(session, MSG_CONNECT_ACK, &ack, offsetof(msg_connect_ack_t, version));
+    }
+    memset(ack.version, 0, sizeof(ack.version));
+    strncpy(ack.version, session->codec == CODEC_COMPACT ? PROTOCOL_VERSION_COMPACT : PROTOCOL_VERSION,
+            sizeof(ack.version) - 1);
+    ack.features = session->features;
+    
     return session_send_message(session, MSG_CONNECT_ACK, &ack, sizeof(ack));
 }
 
 error_code_t session_send_message_connect_ack(connection_t conn, const char* msg) {   
     msg_connect_ack_t ack;
     session_t temp_session;
+    memset(&ack, 0, sizeof(ack));
+    memset(&temp_session, 0, sizeof(temp_session));
     temp_session.conn = conn;
     strncpy(ack.message, msg ? msg : ("Failed"), 255);
     ack.message[255] = '\0';
-    return session_send_message(&temp_session, MSG_CONNECT_ACK, &ack, sizeof(ack));
+    return session_send_message(&temp_session, MSG_CONNECT_ACK, &ack, offsetof(msg_connect_ack_t, version));
 }
 
 error_code_t session_send_board_state(session_t* session, const msg_board_state_t* board) {
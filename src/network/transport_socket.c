@@ -0,0 +1,64 @@
+/* Socket Transports
+ * TCP and Unix domain stream sockets share every operation; they differ
+ * only in how the socket is created and what the peer is called.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "../../include/network/connection.h"
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+static error_code_t socket_fill(connection_t* conn, read_buffer_t* rx, bool block, size_t* received) {
+    return read_buffer_fill(rx, conn->socket_fd, block, received);
+}
+
+static error_code_t socket_wait_readable(connection_t* conn, int timeout_ms) {
+    return poll_fd(conn->socket_fd, POLL_CONTEXT_READ, timeout_ms);
+}
+
+static error_code_t socket_sendv(connection_t* conn, struct iovec* iov, int iov_count, int timeout_ms) {
+    return write_queue_sendv(conn->socket_fd, iov, iov_count, timeout_ms, NULL);
+}
+
+/* Zero-length send: fails only if the connection is broken */
+static error_code_t socket_check_alive(connection_t* conn) {
+    if (conn->socket_fd < 0) return ERR_INVALID_PARAM;
+
+    char dummy = 0;
+    ssize_t result = send(conn->socket_fd, &dummy, 0, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (result < 0 && (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN || errno == EBADF)) {
+        return ERR_NETWORK_ERROR;
+    }
+
+    /* EAGAIN/EWOULDBLOCK is OK for non-blocking check */
+    return SUCCESS;
+}
+
+static void socket_close(connection_t* conn) {
+    if (conn->socket_fd >= 0) {
+        close(conn->socket_fd);
+        conn->socket_fd = -1;
+    }
+}
+
+const transport_ops_t transport_tcp = {
+    "tcp",
+    socket_fill,
+    socket_wait_readable,
+    socket_sendv,
+    socket_check_alive,
+    socket_close,
+    NULL
+};
+
+const transport_ops_t transport_unix = {
+    "unix",
+    socket_fill,
+    socket_wait_readable,
+    socket_sendv,
+    socket_check_alive,
+    socket_close,
+    "local"
+};
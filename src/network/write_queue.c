@@ -0,0 +1,190 @@
+#define _DEFAULT_SOURCE
+
+#include "../../include/network/write_queue.h"
+#include "../../include/network/connection.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+write_queue_t* write_queue_create(void) {
+    write_queue_t* wq = malloc(sizeof(write_queue_t));
+    if (!wq) return NULL;
+    pthread_mutex_init(&wq->lock, NULL);
+    wq->corked = 0;
+    wq->used = 0;
+    memset(&wq->stats, 0, sizeof(wq->stats));
+    wq->sink = NULL;
+    wq->sink_ctx = NULL;
+    return wq;
+}
+
+void write_queue_set_sink(write_queue_t* wq, write_queue_sink_t sink, void* ctx) {
+    if (!wq) return;
+    wq->sink = sink;
+    wq->sink_ctx = ctx;
+}
+
+void write_queue_destroy(write_queue_t* wq) {
+    if (!wq) return;
+    pthread_mutex_destroy(&wq->lock);
+    free(wq);
+}
+
+/* Part of the bytes went out and the rest cannot: the peer would read a torn
+ * frame, so the connection is shut down and reported dead */
+static error_code_t write_torn(int fd) {
+    shutdown(fd, SHUT_RDWR);
+    return ERR_NETWORK_ERROR;
+}
+
+error_code_t write_queue_sendv(int fd, struct iovec* iov, int iov_count, int timeout_ms,
+                               write_queue_stats_t* stats) {
+    if (fd < 0 || !iov) return ERR_INVALID_PARAM;
+
+    /* Skip empty entries so a finished send leaves iov_count at 0 */
+    while (iov_count > 0 && iov->iov_len == 0) {
+        iov++;
+        iov_count--;
+    }
+
+    bool wrote = false;
+    while (iov_count > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iov_count;
+
+        /* Optimistic: the socket buffer almost always has room */
+        if (stats) stats->sends++;
+        ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (stats) stats->waits++;
+                error_code_t err = poll_fd(fd, POLL_CONTEXT_WRITE, timeout_ms);
+                if (err != SUCCESS) return wrote ? write_torn(fd) : err;
+                continue;
+            }
+            return wrote ? write_torn(fd) : ERR_NETWORK_ERROR;
+        }
+        if (sent == 0) return wrote ? write_torn(fd) : ERR_NETWORK_ERROR;
+        if (stats) stats->bytes += (uint64_t)sent;
+        wrote = true;
+
+        /* Advance past what went out */
+        size_t done = (size_t)sent;
+        while (iov_count > 0 && done >= iov->iov_len) {
+            done -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count > 0) {
+            iov->iov_base = (char*)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/* Caller holds the lock */
+static error_code_t write_out(write_queue_t* wq, int fd, struct iovec* iov, int iov_count, int timeout_ms) {
+    if (!wq->sink) return write_queue_sendv(fd, iov, iov_count, timeout_ms, &wq->stats);
+
+    for (int i = 0; i < iov_count; i++) wq->stats.bytes += iov[i].iov_len;
+    wq->stats.sends++;
+    return wq->sink(wq->sink_ctx, iov, iov_count, timeout_ms);
+}
+
+/* Caller holds the lock */
+static error_code_t flush_locked(write_queue_t* wq, int fd, int timeout_ms) {
+    if (wq->used == 0) return SUCCESS;
+
+    struct iovec iov = { wq->data, wq->used };
+    wq->stats.flushes++;
+    error_code_t err = write_out(wq, fd, &iov, 1, timeout_ms);
+
+    /* A timeout sent nothing: the frames stay queued for the next flush.
+     * Any other failure leaves no connection to send them on. */
+    if (err != ERR_TIMEOUT) wq->used = 0;
+    return err;
+}
+
+error_code_t write_queue_send(write_queue_t* wq, int fd, const void* header, size_t header_size,
+                              const void* payload, size_t payload_size, int timeout_ms) {
+    if (!wq || !header || (!payload && payload_size > 0)) return ERR_INVALID_PARAM;
+
+    size_t frame_size = header_size + payload_size;
+    error_code_t err = SUCCESS;
+
+    pthread_mutex_lock(&wq->lock);
+    wq->stats.frames++;
+
+    if (wq->corked > 0 && frame_size <= WRITE_QUEUE_SIZE) {
+        if (wq->used + frame_size > WRITE_QUEUE_SIZE) {
+            err = flush_locked(wq, fd, timeout_ms);
+        }
+        if (err == SUCCESS) {
+            memcpy(wq->data + wq->used, header, header_size);
+            if (payload_size > 0) memcpy(wq->data + wq->used + header_size, payload, payload_size);
+            wq->used += frame_size;
+            wq->stats.queued++;
+        }
+        pthread_mutex_unlock(&wq->lock);
+        return err;
+    }
+
+    /* Uncorked: anything still queued goes first to keep frames in order */
+    err = flush_locked(wq, fd, timeout_ms);
+    if (err == SUCCESS) {
+        struct iovec iov[2] = {
+            { (void*)header, header_size },
+            { (void*)payload, payload_size }
+        };
+        wq->stats.flushes++;
+        err = write_out(wq, fd, iov, 2, timeout_ms);
+    }
+    pthread_mutex_unlock(&wq->lock);
+    return err;
+}
+
+void write_queue_cork(write_queue_t* wq) {
+    if (!wq) return;
+    pthread_mutex_lock(&wq->lock);
+    wq->corked++;
+    pthread_mutex_unlock(&wq->lock);
+}
+
+error_code_t write_queue_uncork(write_queue_t* wq, int fd, int timeout_ms) {
+    if (!wq) return ERR_INVALID_PARAM;
+
+    error_code_t err = SUCCESS;
+    pthread_mutex_lock(&wq->lock);
+    if (wq->corked > 0) wq->corked--;
+    if (wq->corked == 0) err = flush_locked(wq, fd, timeout_ms);
+    pthread_mutex_unlock(&wq->lock);
+    return err;
+}
+
+void write_queue_discard(write_queue_t* wq) {
+    if (!wq) return;
+    pthread_mutex_lock(&wq->lock);
+    wq->used = 0;
+    pthread_mutex_unlock(&wq->lock);
+}
+
+size_t write_queue_pending(write_queue_t* wq) {
+    if (!wq) return 0;
+    pthread_mutex_lock(&wq->lock);
+    size_t used = wq->used;
+    pthread_mutex_unlock(&wq->lock);
+    return used;
+}
+
+void write_queue_get_stats(write_queue_t* wq, write_queue_stats_t* stats) {
+    if (!wq || !stats) return;
+    pthread_mutex_lock(&wq->lock);
+    *stats = wq->stats;
+    pthread_mutex_unlock(&wq->lock);
+}
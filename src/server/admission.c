@@ -0,0 +1,161 @@
+/* Admission Control Implementation
+ * Buckets are per session and touched only by its handler thread, so they
+ * need no lock; the in-progress count is the only shared state.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../../include/server/admission.h"
+#include "../../include/common/messages.h"
+#include <string.h>
+#include <time.h>
+
+/* Sustained requests/s and burst per class */
+static const struct {
+    const char* name;
+    double rate;
+    double burst;
+} g_class_limits[ADMISSION_CLASS_COUNT] = {
+    [ADMISSION_CLASS_GAME]    = { "game",    20.0, 40.0 },
+    [ADMISSION_CLASS_QUERY]   = { "query",   10.0, 20.0 },
+    [ADMISSION_CLASS_CHAT]    = { "chat",     2.0,  5.0 },
+    [ADMISSION_CLASS_LIST]    = { "list",     4.0, 10.0 },
+    [ADMISSION_CLASS_STORAGE] = { "storage",  1.0,  3.0 },
+};
+
+static int g_inflight = 0;
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void token_bucket_init(token_bucket_t* bucket, double rate, double burst, double now) {
+    bucket->rate = rate;
+    bucket->burst = burst;
+    bucket->tokens = burst;
+    bucket->last = now;
+}
+
+bool token_bucket_take(token_bucket_t* bucket, double cost, double now, uint32_t* retry_ms) {
+    if (now > bucket->last) {
+        bucket->tokens += (now - bucket->last) * bucket->rate;
+        if (bucket->tokens > bucket->burst) bucket->tokens = bucket->burst;
+        bucket->last = now;
+    }
+
+    if (bucket->tokens >= cost) {
+        bucket->tokens -= cost;
+        return true;
+    }
+    if (retry_ms) {
+        double wait = bucket->rate > 0 ? (cost - bucket->tokens) / bucket->rate : 60.0;
+        *retry_ms = (uint32_t)(wait * 1000.0) + 1;
+    }
+    return false;
+}
+
+static admission_class_t classify_list(int32_t list_type) {
+    return list_type == MSG_LIST_SAVED_GAMES ? ADMISSION_CLASS_STORAGE : ADMISSION_CLASS_LIST;
+}
+
+admission_class_t admission_classify(message_type_t type, const void* payload, size_t payload_size) {
+    switch (type) {
+        case MSG_LIST_SAVED_GAMES:
+        case MSG_VIEW_SAVED_GAME:
+            return ADMISSION_CLASS_STORAGE;
+
+        case MSG_LIST_PAGE:
+            if (payload && payload_size >= sizeof(msg_list_page_t)) {
+                return classify_list(((const msg_list_page_t*)payload)->list_type);
+            }
+            return ADMISSION_CLASS_LIST;
+
+        case MSG_LIST_PLAYERS:
+        case MSG_LIST_GAMES:
+        case MSG_LIST_MY_GAMES:
+        case MSG_LIST_FRIENDS:
+            return ADMISSION_CLASS_LIST;
+
+        case MSG_SEND_CHAT:
+            return ADMISSION_CLASS_CHAT;
+
+        case MSG_SET_BIO:
+        case MSG_GET_BIO:
+        case MSG_GET_PLAYER_STATS:
+        case MSG_ADD_FRIEND:
+        case MSG_REMOVE_FRIEND:
+        case MSG_GET_CHALLENGES:
+            return ADMISSION_CLASS_QUERY;
+
+        default:
+            return ADMISSION_CLASS_GAME;
+    }
+}
+
+const char* admission_class_name(admission_class_t cls) {
+    return cls < ADMISSION_CLASS_COUNT ? g_class_limits[cls].name : "unknown";
+}
+
+void admission_init(admission_t* admission) {
+    double now = monotonic_seconds();
+    memset(admission, 0, sizeof(*admission));
+    token_bucket_init(&admission->session, ADMISSION_SESSION_RATE, ADMISSION_SESSION_BURST, now);
+    for (int i = 0; i < ADMISSION_CLASS_COUNT; i++) {
+        token_bucket_init(&admission->classes[i], g_class_limits[i].rate, g_class_limits[i].burst, now);
+    }
+}
+
+int admission_overload_level(void) {
+    int inflight = __atomic_load_n(&g_inflight, __ATOMIC_RELAXED);
+    if (inflight >= ADMISSION_SHED_INFLIGHT) return 2;
+    if (inflight >= ADMISSION_OVERLOAD_INFLIGHT) return 1;
+    return 0;
+}
+
+/* Lowest class an overload level sheds */
+static admission_class_t shed_from(int level) {
+    if (level >= 2) return ADMISSION_CLASS_CHAT;
+    if (level == 1) return ADMISSION_CLASS_STORAGE;
+    return ADMISSION_CLASS_COUNT;
+}
+
+error_code_t admission_begin(admission_t* admission, message_type_t type, const void* payload,
+                             size_t payload_size, uint32_t* retry_ms, bool* shed) {
+    if (!admission || !retry_ms || !shed) return ERR_INVALID_PARAM;
+
+    /* Logging out is never refused */
+    if (type == MSG_DISCONNECT) {
+        __atomic_add_fetch(&g_inflight, 1, __ATOMIC_RELAXED);
+        return SUCCESS;
+    }
+
+    admission_class_t cls = admission_classify(type, payload, payload_size);
+    int level = admission_overload_level();
+    *shed = false;
+
+    /* Shedding spends none of the session's tokens: the client is not at fault */
+    if (cls >= shed_from(level)) {
+        *shed = true;
+        *retry_ms = ADMISSION_OVERLOAD_RETRY_MS * (uint32_t)level;
+        return ERR_RATE_LIMITED;
+    }
+
+    double now = monotonic_seconds();
+    token_bucket_t* class_bucket = &admission->classes[cls];
+    if (!token_bucket_take(class_bucket, 1.0, now, retry_ms)) {
+        return ERR_RATE_LIMITED;
+    }
+    if (!token_bucket_take(&admission->session, 1.0, now, retry_ms)) {
+        class_bucket->tokens += 1.0;
+        return ERR_RATE_LIMITED;
+    }
+
+    __atomic_add_fetch(&g_inflight, 1, __ATOMIC_RELAXED);
+    return SUCCESS;
+}
+
+void admission_end(void) {
+    __atomic_sub_fetch(&g_inflight, 1, __ATOMIC_RELAXED);
+}
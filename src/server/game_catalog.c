@@ -0,0 +1,339 @@
+/* Game Catalog Implementation
+ * Games are held in an array indexed by log ID, which the log assigns
+ * densely from 1. The listings are arrays of (created_at, ID) keys kept
+ * sorted: one for all games and one per player, indexed by pseudo ID.
+ * Games are started in date order, so a new key almost always goes at the
+ * end; a deleted game's key is moved out, but the game keeps its date so a
+ * cursor pointing at it still finds its place.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../../include/server/game_catalog.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CATALOG_BUILD_BATCH 1024
+
+typedef struct {
+    char* label;                /* NULL until added */
+    int64_t created_at;
+    pseudo_id_t player_a;
+    pseudo_id_t player_b;
+    uint32_t moves;
+    uint8_t state;
+    int8_t winner;
+    bool known;                 /* Added at some point; keeps created_at once deleted */
+    bool live;
+} catalog_game_t;
+
+typedef struct {
+    int64_t created_at;
+    game_log_id_t id;
+} catalog_key_t;
+
+typedef struct {
+    catalog_key_t* keys;
+    uint32_t count;
+    uint32_t capacity;
+} key_list_t;
+
+static struct {
+    catalog_game_t* games;      /* By log ID */
+    uint64_t games_size;
+    key_list_t all;
+    key_list_t* players;        /* By pseudo ID */
+    uint32_t players_size;
+    uint64_t live;
+    uint32_t listed_players;
+    uint32_t build_ms;
+    pthread_mutex_t lock;
+} g_catalog = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* ========== Key lists ========== */
+
+static bool key_less(catalog_key_t a, catalog_key_t b) {
+    return a.created_at < b.created_at || (a.created_at == b.created_at && a.id < b.id);
+}
+
+/* Index of the first key not below `key` */
+static uint32_t list_lower_bound(const key_list_t* list, catalog_key_t key) {
+    uint32_t low = 0, high = list->count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (key_less(list->keys[mid], key)) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static bool list_insert(key_list_t* list, catalog_key_t key) {
+    if (list->count == list->capacity) {
+        uint32_t capacity = list->capacity ? list->capacity * 2 : 8;
+        catalog_key_t* keys = realloc(list->keys, (size_t)capacity * sizeof(catalog_key_t));
+        if (!keys) return false;
+        list->keys = keys;
+        list->capacity = capacity;
+    }
+    /* Usually the newest game: no search, nothing to move */
+    uint32_t at = (list->count == 0 || key_less(list->keys[list->count - 1], key))
+                      ? list->count
+                      : list_lower_bound(list, key);
+    memmove(&list->keys[at + 1], &list->keys[at], (size_t)(list->count - at) * sizeof(catalog_key_t));
+    list->keys[at] = key;
+    list->count++;
+    return true;
+}
+
+static void list_remove(key_list_t* list, catalog_key_t key) {
+    uint32_t at = list_lower_bound(list, key);
+    if (at == list->count || list->keys[at].id != key.id) return;
+    list->count--;
+    memmove(&list->keys[at], &list->keys[at + 1], (size_t)(list->count - at) * sizeof(catalog_key_t));
+}
+
+/* Caller holds the lock; NULL if it cannot grow */
+static key_list_t* player_list(pseudo_id_t player) {
+    if (player >= g_catalog.players_size) {
+        uint32_t size = g_catalog.players_size ? g_catalog.players_size : 256;
+        while (size <= player) size *= 2;
+        key_list_t* players = realloc(g_catalog.players, (size_t)size * sizeof(key_list_t));
+        if (!players) return NULL;
+        memset(players + g_catalog.players_size, 0, (size_t)(size - g_catalog.players_size) * sizeof(key_list_t));
+        g_catalog.players = players;
+        g_catalog.players_size = size;
+    }
+    return &g_catalog.players[player];
+}
+
+static bool player_insert(pseudo_id_t player, catalog_key_t key) {
+    if (player == PSEUDO_ID_NONE) return true;
+    key_list_t* list = player_list(player);
+    if (!list || !list_insert(list, key)) return false;
+    if (list->count == 1) g_catalog.listed_players++;
+    return true;
+}
+
+static void player_remove(pseudo_id_t player, catalog_key_t key) {
+    if (player == PSEUDO_ID_NONE || player >= g_catalog.players_size) return;
+    key_list_t* list = &g_catalog.players[player];
+    uint32_t before = list->count;
+    list_remove(list, key);
+    if (before == 1 && list->count == 0) g_catalog.listed_players--;
+}
+
+/* ========== Games ========== */
+
+/* Caller holds the lock */
+static catalog_game_t* game_at(game_log_id_t id) {
+    return (id != GAME_LOG_ID_NONE && id < g_catalog.games_size) ? &g_catalog.games[id] : NULL;
+}
+
+static catalog_game_t* game_reserve(game_log_id_t id) {
+    if (id == GAME_LOG_ID_NONE) return NULL;
+    if (id >= g_catalog.games_size) {
+        uint64_t size = g_catalog.games_size ? g_catalog.games_size : 1024;
+        while (size <= id) size *= 2;
+        catalog_game_t* games = realloc(g_catalog.games, (size_t)size * sizeof(catalog_game_t));
+        if (!games) return NULL;
+        memset(games + g_catalog.games_size, 0, (size_t)(size - g_catalog.games_size) * sizeof(catalog_game_t));
+        g_catalog.games = games;
+        g_catalog.games_size = size;
+    }
+    return &g_catalog.games[id];
+}
+
+/* Caller holds the lock */
+static error_code_t add_locked(game_log_id_t id, const char* label, pseudo_id_t player_a, pseudo_id_t player_b,
+                               time_t created_at) {
+    catalog_game_t* game = game_reserve(id);
+    if (!game) return ERR_MAX_CAPACITY;
+    if (game->live) return SUCCESS;
+
+    char* copy = strdup(label ? label : "");
+    if (!copy) return ERR_MAX_CAPACITY;
+
+    catalog_key_t key = { (int64_t)created_at, id };
+    if (!list_insert(&g_catalog.all, key)) {
+        free(copy);
+        return ERR_MAX_CAPACITY;
+    }
+    if (!player_insert(player_a, key) || (player_b != player_a && !player_insert(player_b, key))) {
+        player_remove(player_a, key);
+        list_remove(&g_catalog.all, key);
+        free(copy);
+        return ERR_MAX_CAPACITY;
+    }
+
+    game->label = copy;
+    game->created_at = key.created_at;
+    game->player_a = player_a;
+    game->player_b = player_b;
+    game->moves = 0;
+    game->state = GAME_STATE_IN_PROGRESS;
+    game->winner = NO_WINNER;
+    game->known = true;
+    game->live = true;
+    g_catalog.live++;
+    return SUCCESS;
+}
+
+/* Caller holds the lock */
+static void clear_locked(void) {
+    for (uint64_t id = 0; id < g_catalog.games_size; id++) {
+        free(g_catalog.games[id].label);
+    }
+    for (uint32_t player = 0; player < g_catalog.players_size; player++) {
+        free(g_catalog.players[player].keys);
+    }
+    free(g_catalog.games);
+    free(g_catalog.players);
+    free(g_catalog.all.keys);
+    g_catalog.games = NULL;
+    g_catalog.games_size = 0;
+    g_catalog.players = NULL;
+    g_catalog.players_size = 0;
+    memset(&g_catalog.all, 0, sizeof(g_catalog.all));
+    g_catalog.live = 0;
+    g_catalog.listed_players = 0;
+}
+
+/* ========== Public API ========== */
+
+error_code_t game_catalog_build(void) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    game_log_info_t* batch = malloc(CATALOG_BUILD_BATCH * sizeof(game_log_info_t));
+    if (!batch) return ERR_MAX_CAPACITY;
+
+    pthread_mutex_lock(&g_catalog.lock);
+    clear_locked();
+    pthread_mutex_unlock(&g_catalog.lock);
+
+    /* In ID order, which is close enough to date order that inserts append */
+    error_code_t err = SUCCESS;
+    game_log_id_t from = GAME_LOG_ID_NONE;
+    do {
+        int count;
+        err = game_log_scan(from, PSEUDO_ID_NONE, batch, CATALOG_BUILD_BATCH, &count, &from);
+        pthread_mutex_lock(&g_catalog.lock);
+        for (int i = 0; i < count && err == SUCCESS; i++) {
+            err = add_locked(batch[i].id, batch[i].label, batch[i].player_a, batch[i].player_b,
+                             batch[i].created_at);
+            catalog_game_t* game = game_at(batch[i].id);
+            if (err == SUCCESS && game) {
+                game->state = (uint8_t)batch[i].state;
+                game->winner = (int8_t)batch[i].winner;
+                game->moves = batch[i].moves;
+            }
+        }
+        pthread_mutex_unlock(&g_catalog.lock);
+    } while (err == SUCCESS && from != GAME_LOG_ID_NONE);
+    free(batch);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_mutex_lock(&g_catalog.lock);
+    g_catalog.build_ms = (uint32_t)((end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000);
+    pthread_mutex_unlock(&g_catalog.lock);
+    return err;
+}
+
+void game_catalog_clear(void) {
+    pthread_mutex_lock(&g_catalog.lock);
+    clear_locked();
+    pthread_mutex_unlock(&g_catalog.lock);
+}
+
+error_code_t game_catalog_add(game_log_id_t id, const char* label, pseudo_id_t player_a, pseudo_id_t player_b,
+                              time_t created_at) {
+    if (id == GAME_LOG_ID_NONE) return ERR_INVALID_PARAM;
+    pthread_mutex_lock(&g_catalog.lock);
+    error_code_t err = add_locked(id, label, player_a, player_b, created_at);
+    pthread_mutex_unlock(&g_catalog.lock);
+    return err;
+}
+
+void game_catalog_finish(game_log_id_t id, game_state_t state, winner_t winner, uint32_t moves) {
+    pthread_mutex_lock(&g_catalog.lock);
+    catalog_game_t* game = game_at(id);
+    if (game && game->live) {
+        game->state = (uint8_t)state;
+        game->winner = (int8_t)winner;
+        game->moves = moves;
+    }
+    pthread_mutex_unlock(&g_catalog.lock);
+}
+
+void game_catalog_remove(game_log_id_t id) {
+    pthread_mutex_lock(&g_catalog.lock);
+    catalog_game_t* game = game_at(id);
+    if (game && game->live) {
+        catalog_key_t key = { game->created_at, id };
+        list_remove(&g_catalog.all, key);
+        player_remove(game->player_a, key);
+        if (game->player_b != game->player_a) player_remove(game->player_b, key);
+        free(game->label);
+        game->label = NULL;
+        game->live = false;
+        g_catalog.live--;
+    }
+    pthread_mutex_unlock(&g_catalog.lock);
+}
+
+error_code_t game_catalog_page(const game_catalog_filter_t* filter, game_log_id_t from, game_log_info_t* out,
+                               int max, int* count, game_log_id_t* next) {
+    if (!filter || !out || max < 1 || !count || !next) return ERR_INVALID_PARAM;
+    *count = 0;
+    *next = GAME_LOG_ID_NONE;
+
+    pthread_mutex_lock(&g_catalog.lock);
+    const key_list_t* list = &g_catalog.all;
+    if (filter->player != PSEUDO_ID_NONE) {
+        list = filter->player < g_catalog.players_size ? &g_catalog.players[filter->player] : NULL;
+    }
+
+    /* Start at the later of the cursor and the range's start */
+    catalog_key_t start = { filter->since ? (int64_t)filter->since : INT64_MIN, 0 };
+    if (from != GAME_LOG_ID_NONE) {
+        const catalog_game_t* game = game_at(from);
+        catalog_key_t cursor = { game && game->known ? game->created_at : INT64_MAX, from };
+        if (key_less(start, cursor)) start = cursor;
+    }
+
+    for (uint32_t at = list ? list_lower_bound(list, start) : 0; list && at < list->count; at++) {
+        catalog_key_t key = list->keys[at];
+        if (filter->until && key.created_at >= (int64_t)filter->until) break;
+        if (*count == max) {
+            *next = key.id;
+            break;
+        }
+
+        const catalog_game_t* game = &g_catalog.games[key.id];
+        game_log_info_t* info = &out[*count];
+        info->id = key.id;
+        snprintf(info->label, sizeof(info->label), "%s", game->label);
+        info->player_a = game->player_a;
+        info->player_b = game->player_b;
+        info->created_at = (time_t)game->created_at;
+        info->state = (game_state_t)game->state;
+        info->winner = (winner_t)game->winner;
+        info->moves = game->moves;
+        (*count)++;
+    }
+    pthread_mutex_unlock(&g_catalog.lock);
+    return SUCCESS;
+}
+
+void game_catalog_get_stats(game_catalog_stats_t* stats) {
+    if (!stats) return;
+    pthread_mutex_lock(&g_catalog.lock);
+    stats->games = g_catalog.live;
+    stats->players = g_catalog.listed_players;
+    stats->build_ms = g_catalog.build_ms;
+    pthread_mutex_unlock(&g_catalog.lock);
+}
@@ -0,0 +1,2362 @@
+/* Game Log Implementation
+ * Segment files are <dir>/NNNNNNNN.seg, numbered from 1, each starting with
+ * a 16-byte header (magic, version, number). Records are little-endian:
+ *   u32 crc       CRC-32C of everything after this field
+ *   u8  type      LOG_RECORD_*
+ *   u8  reserved
+ *   u16 length    Body bytes
+ *   u64 game      Game ID
+ *   u64 prev      Location of the game's previous record, 0 for START
+ *   body
+ * Version 1 segments and archives used zlib's CRC-32 throughout; they are
+ * still read, but appends always go to a version 2 segment, and compaction
+ * writes version 2 archives with each kept record's CRC redone.
+ * A location is the segment number in the high 32 bits and the offset in the
+ * low 32, so 0 is never a record. Index entries live in fixed-size chunks
+ * that are never moved, so growing the index never copies it.
+ *
+ * Appends are serialized by the index lock, which also assigns each record
+ * its location, so records enter the write-behind queue in file order. The
+ * queue is a byte ring with one producer (whoever holds the index lock) and
+ * one consumer (the writer thread); they pass records through the head and
+ * tail counters without taking each other's lock. Queue positions only grow,
+ * so "written" and "synced" are each one counter that waiters compare with.
+ *
+ * Compaction turns a sealed segment into <dir>/NNNNNNNN.arc, holding only
+ * the records still needed: the GAME record of each stored game whose last
+ * record it is, and DELETE records for games that still have records in an
+ * earlier file. Those are copied unchanged, in order, into blocks of about
+ * LOG_ARCHIVE_BLOCK bytes, each deflated on its own:
+ *   16-byte header (archive magic, version, number)
+ *   blocks: u32 CRC-32C of the compressed bytes, u32 compressed length,
+ *           u32 record bytes, compressed bytes
+ *   index: per block, u32 offset of its first record and u64 file offset
+ *   trailer: u32 blocks, u32 end of the records, u64 index offset,
+ *            u64 highest game ID the segment had, u32 CRC-32C of the index,
+ *            u32 archive magic
+ * Record offsets run on from LOG_SEGMENT_HEADER as if the records were
+ * still in a segment, and an archived record's location carries
+ * LOG_ARCHIVE_BIT in its segment number. A read counts itself in from
+ * taking its locations under the index lock until it is done with them,
+ * in one of two counters picked by the epoch; the swap moves the epoch on,
+ * and the segment file stays open and mapped until the counter of the
+ * epoch before it drops to zero, so a read still holding a segment
+ * location reads the segment. Reading an archived record finds
+ * its block in the index by binary search and inflates it; each archive
+ * keeps its last inflated block.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "../../include/server/game_log.h"
+#include "../../include/common/checksum.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define LOG_MAGIC 0x474C5741u           /* "AWLG" */
+#define LOG_VERSION 2
+#define LOG_VERSION_CRC32 1             /* Checked with zlib's CRC-32 */
+#define LOG_SEGMENT_HEADER 16
+#define LOG_RECORD_HEADER 24
+#define LOG_MAX_BODY 4096
+#define LOG_READ_AHEAD 128              /* Covers all but START and GAME records */
+#define LOG_PATH_MAX 1024
+
+#define LOG_QUEUE_SIZE (4u << 20)       /* Power of two */
+#define LOG_QUEUE_ALIGN 16
+#define LOG_WRITE_IOVECS 256            /* Records per pwritev */
+#define LOG_SCAN_MAX_THREADS 8          /* Segments read at once on open */
+#define LOG_REPLAY_INLINE 256           /* Moves replayed on a load without allocating */
+
+#define LOG_ARCHIVE_MAGIC 0x414C5741u   /* "AWLA" */
+#define LOG_ARCHIVE_VERSION 2
+#define LOG_ARCHIVE_VERSION_CRC32 1
+#define LOG_ARCHIVE_BIT 0x80000000u     /* In a location's segment number */
+#define LOG_ARCHIVE_BLOCK (64u << 10)   /* Record bytes per block, roughly */
+#define LOG_ARCHIVE_BLOCK_MAX (LOG_ARCHIVE_BLOCK + LOG_RECORD_HEADER + LOG_MAX_BODY)
+#define LOG_ARCHIVE_BLOCK_HEADER 12
+#define LOG_ARCHIVE_INDEX_ENTRY 12
+#define LOG_ARCHIVE_TRAILER 32
+#define LOG_COMPACT_BATCH 4096          /* Records checked per hold of the index lock */
+
+#define LOG_CHUNK_ENTRIES 65536
+#define LOG_MAX_CHUNKS 65536
+
+#define LOCATION(segment, offset) (((uint64_t)(segment) << 32) | (uint32_t)(offset))
+#define LOCATION_SEGMENT(loc) ((uint32_t)((loc) >> 32))
+#define LOCATION_OFFSET(loc) ((uint32_t)(loc))
+/* The segment a record is or was in, archived or not */
+#define LOCATION_FILE(loc) (LOCATION_SEGMENT(loc) & ~LOG_ARCHIVE_BIT)
+
+enum {
+    LOG_RECORD_START = 1,       /* created_at, player names, label */
+    LOG_RECORD_MOVE = 2,        /* pit, state and winner after, seconds since creation */
+    LOG_RECORD_SNAPSHOT = 3,    /* The whole board */
+    LOG_RECORD_DELETE = 4,
+    LOG_RECORD_GAME = 5         /* A whole finished game, see below */
+};
+
+/* MOVE body */
+#define MOVE_BODY_SIZE 7
+/* SNAPSHOT body: pits, scores, current player, state, winner, two times */
+#define SNAPSHOT_BODY_SIZE (NUM_PITS + 5 + 16)
+
+/* GAME body, version 1:
+ *   u8  version
+ *   u8  flags          GAME_FLAG_*
+ *   u8  state
+ *   i8  winner
+ *   u32 created_at     Unix time
+ *   u32 duration       Seconds from creation to the last move
+ *   u16 moves
+ *   player_a, player_b and (with GAME_FLAG_LABEL) label, u8-length-prefixed
+ *   moves, 4 bits each, low nibble first (without GAME_FLAG_NO_HISTORY)
+ *   boards after moves 64, 128, ... below `moves` (likewise), then the final
+ *   board; each is the pits, the scores and the player to move
+ * A typical game of 60 moves takes about 70 bytes, 94 with its header. */
+#define GAME_VERSION 1
+#define GAME_FIXED_SIZE 14
+#define GAME_BOARD_SIZE (NUM_PITS + 3)
+#define GAME_FLAG_LABEL 0x01            /* Not the default "<a>-vs-<b>" */
+#define GAME_FLAG_NO_HISTORY 0x02       /* Only the final board was kept */
+
+typedef struct {
+    uint8_t flags;
+    uint8_t state;
+    int8_t winner;
+    uint32_t created_at;
+    uint32_t duration;
+    uint16_t moves;
+    char names[2][MAX_PSEUDO_LEN];
+    char label[MAX_GAME_ID_LEN];
+    const uint8_t* history;     /* NULL without history */
+    const uint8_t* boards;      /* Periodic boards, then the final one */
+    uint32_t periodic;          /* Periodic boards */
+} compact_game_t;
+
+typedef struct {
+    uint64_t first;             /* START record */
+    uint64_t last;              /* Latest record */
+    int64_t created_at;
+    pseudo_id_t player_a;
+    pseudo_id_t player_b;
+    uint32_t moves;
+    uint8_t state;
+    int8_t winner;
+    bool whole;                 /* The latest record is a GAME record */
+    bool deleted;
+} log_entry_t;
+
+/* A decoded record. The body is left where it was found: in a mapped
+ * segment, a buffer being scanned, or `copy` for one read with pread or out
+ * of an archive block. */
+typedef struct {
+    uint8_t type;
+    uint16_t length;
+    uint64_t game;
+    uint64_t prev;
+    const uint8_t* body;
+    uint8_t copy[LOG_RECORD_HEADER + LOG_MAX_BODY];
+} log_record_t;
+
+/* A file mapped read-only */
+typedef struct {
+    uint8_t* data;
+    size_t size;
+} log_map_t;
+
+/* An archive segment, mapped whole; the index is read when it is opened */
+typedef struct {
+    log_map_t map;
+    uint32_t blocks;
+    uint32_t* raw_start;        /* Block b holds records [raw_start[b], raw_start[b + 1]) */
+    uint64_t* file_offset;      /* ... and starts here; file_offset[blocks] is the index */
+    uint64_t max_game;
+    uint64_t file_size;
+    bool zlib_crc;              /* Version 1 */
+    pthread_mutex_t lock;       /* Guards the cached block */
+    int64_t cached;             /* Block in `cache`, -1 for none */
+    uint8_t* cache;             /* Allocated on the first read */
+} archive_t;
+
+static struct {
+    bool open;
+    char dir[LOG_PATH_MAX];
+    int fds[GAME_LOG_MAX_SEGMENTS + 1];     /* By segment number; -1 once archived and unread */
+    log_map_t maps[GAME_LOG_MAX_SEGMENTS + 1];  /* Sealed segments */
+    archive_t* archives[GAME_LOG_MAX_SEGMENTS + 1];
+    bool zlib_crc[GAME_LOG_MAX_SEGMENTS + 1];   /* Version 1 segment files */
+    uint32_t pins[GAME_LOG_MAX_SEGMENTS + 1];   /* Live games without a GAME record with records in it */
+    uint32_t segment;                       /* Active segment */
+    uint32_t size;                          /* Its length */
+    uint64_t sealed_bytes;                  /* Length of the segments before it */
+    log_entry_t* chunks[LOG_MAX_CHUNKS];
+    uint64_t count;                         /* IDs 1..count are assigned */
+    uint64_t live;                          /* Not deleted */
+    uint64_t appends;
+    uint64_t file_reads;                    /* Records read with pread */
+    int scan_threads;                       /* 0: one per online CPU */
+    uint32_t scan_ms;                       /* Index rebuild on the last open */
+    uint32_t epoch;                         /* Its parity picks the counter new reads join */
+    uint32_t readers[2];                    /* Reads in progress, by epoch parity */
+    bool draining;                          /* Compaction waits for a counter to drop to zero */
+    uint32_t archived;                      /* Segments that are archives */
+    uint64_t compactions;
+    uint64_t compacted_bytes;
+    uint64_t archived_bytes;
+    uint64_t compact_ms;
+    pthread_mutex_t lock;
+    pthread_mutex_t drain_lock;
+    pthread_cond_t drained;
+} g_log = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .drain_lock = PTHREAD_MUTEX_INITIALIZER,
+    .drained = PTHREAD_COND_INITIALIZER,
+};
+
+/* A segment or archive being read on open */
+typedef struct {
+    uint32_t segment;
+    int fd;
+    archive_t* archive;         /* NULL for a segment */
+    uint8_t* data;              /* The whole file, or an archive's records; NULL if it had no valid header */
+    log_map_t map;              /* `data` when the file is mapped */
+    uint32_t valid_size;
+    uint32_t bytes;             /* File size counted in the stats */
+    bool zlib_crc;              /* Version 1 */
+    error_code_t err;
+} segment_load_t;
+
+/* Background compaction */
+static struct {
+    bool running;
+    bool stop;
+    int interval_ms;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_mutex_t pass;       /* One compaction pass at a time */
+} g_compactor = {
+    .interval_ms = GAME_LOG_COMPACT_INTERVAL_DEFAULT_MS,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .pass = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* Queue entry header; the record follows, padded to LOG_QUEUE_ALIGN. A size
+ * of 0 marks the rest of the ring as unused, and the next entry is at its
+ * start. */
+typedef struct {
+    uint32_t size;              /* Entry bytes, header included */
+    uint32_t length;            /* Record bytes */
+    uint64_t location;
+} queue_entry_t;
+
+static struct {
+    bool running;
+    bool stop;
+    bool idle;                  /* Waiting for work; appenders must wake it */
+    bool failed;                /* A write or sync failed; nothing more is written */
+    uint8_t* queue;
+    uint64_t head;              /* Bytes queued; advanced by appenders */
+    uint64_t tail;              /* Bytes written; advanced by the writer */
+    uint64_t durable;           /* Bytes synced */
+    uint64_t sync_target;       /* Someone waits for a sync up to here */
+    game_log_sync_t policy;
+    int interval_ms;
+    uint64_t writes;
+    uint64_t commits;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* Writer: work queued or sync wanted */
+    pthread_cond_t done;        /* Waiters: tail or durable moved */
+} g_writer = {
+    .policy = GAME_LOG_SYNC_INTERVAL,
+    .interval_ms = GAME_LOG_SYNC_INTERVAL_DEFAULT_MS,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+/* The checksum of a file of version 2 on, or of a version 1 file */
+static uint32_t file_crc(bool zlib_crc, const uint8_t* data, size_t size) {
+    return zlib_crc ? (uint32_t)crc32(0L, data, (uInt)size) : checksum_crc32c(0, data, size);
+}
+
+static uint32_t record_crc(const uint8_t* record, size_t size, bool zlib_crc) {
+    return file_crc(zlib_crc, record + 4, size - 4);
+}
+
+static void segment_path(uint32_t segment, char* path, size_t size) {
+    snprintf(path, size, "%s/%08u.seg", g_log.dir, segment);
+}
+
+static void archive_path(uint32_t segment, const char* suffix, char* path, size_t size) {
+    snprintf(path, size, "%s/%08u.arc%s", g_log.dir, segment, suffix);
+}
+
+/* ========== Index ========== */
+
+static log_entry_t* entry_at(uint64_t id) {
+    if (id == GAME_LOG_ID_NONE || id > g_log.count) return NULL;
+    log_entry_t* chunk = g_log.chunks[(id - 1) / LOG_CHUNK_ENTRIES];
+    return chunk ? &chunk[(id - 1) % LOG_CHUNK_ENTRIES] : NULL;
+}
+
+/* Entry for `id`, allocating its chunk; caller holds the lock */
+static log_entry_t* entry_reserve(uint64_t id) {
+    uint64_t chunk_index = (id - 1) / LOG_CHUNK_ENTRIES;
+    if (id == GAME_LOG_ID_NONE || chunk_index >= LOG_MAX_CHUNKS) return NULL;
+    if (!g_log.chunks[chunk_index]) {
+        g_log.chunks[chunk_index] = calloc(LOG_CHUNK_ENTRIES, sizeof(log_entry_t));
+        if (!g_log.chunks[chunk_index]) return NULL;
+    }
+    if (id > g_log.count) g_log.count = id;
+    return &g_log.chunks[chunk_index][(id - 1) % LOG_CHUNK_ENTRIES];
+}
+
+static bool entry_live(const log_entry_t* entry) {
+    return entry && entry->first != 0 && !entry->deleted;
+}
+
+/* Pin (or unpin) files `from` to `to`: compaction leaves a pinned segment
+ * as it is. Caller holds the lock. */
+static void pin_files(uint32_t from, uint32_t to, bool pin) {
+    for (uint32_t s = from; s <= to && s <= GAME_LOG_MAX_SEGMENTS; s++) {
+        if (pin) g_log.pins[s]++;
+        else g_log.pins[s]--;
+    }
+}
+
+/* A live game without a GAME record pins every file from its first record
+ * to its latest */
+static void pin_entry(const log_entry_t* entry, bool pin) {
+    pin_files(LOCATION_FILE(entry->first), LOCATION_FILE(entry->last), pin);
+}
+
+/* `entry` is about to get a record at `location` that leaves it without a
+ * GAME record: pin what it did not pin yet */
+static void pin_extend(const log_entry_t* entry, uint64_t location) {
+    uint32_t from = entry->whole ? LOCATION_FILE(entry->first) : LOCATION_FILE(entry->last) + 1;
+    pin_files(from, LOCATION_FILE(location), true);
+}
+
+/* The label game_manager_generate_label gives a new game, which GAME
+ * records leave out */
+static void default_label(const char* name_a, const char* name_b, char label[MAX_GAME_ID_LEN]) {
+    snprintf(label, MAX_GAME_ID_LEN, "%s-vs-%s", name_a, name_b);
+}
+
+/* u8-length-prefixed string; NULL if it overruns the body */
+static const uint8_t* get_string(const uint8_t* p, const uint8_t* end, char* out, size_t max) {
+    size_t len = (p < end) ? *p++ : 0;
+    if (len >= max || p + len > end) return NULL;
+    memcpy(out, p, len);
+    out[len] = '\0';
+    return p + len;
+}
+
+static uint32_t periodic_boards(uint32_t moves) {
+    return moves ? (moves - 1) / GAME_LOG_SNAPSHOT_INTERVAL : 0;
+}
+
+/* Split a GAME body; false if it is malformed or from a later version */
+static bool parse_compact(const log_record_t* record, compact_game_t* game) {
+    const uint8_t* p = record->body;
+    const uint8_t* end = record->body + record->length;
+    if (record->length < GAME_FIXED_SIZE || p[0] != GAME_VERSION) return false;
+
+    game->flags = p[1];
+    game->state = p[2];
+    game->winner = (int8_t)p[3];
+    game->created_at = get_u32(p + 4);
+    game->duration = get_u32(p + 8);
+    game->moves = get_u16(p + 12);
+    p += GAME_FIXED_SIZE;
+
+    for (int i = 0; i < 2 && p; i++) p = get_string(p, end, game->names[i], MAX_PSEUDO_LEN);
+    if (!p) return false;
+    if (game->flags & GAME_FLAG_LABEL) {
+        p = get_string(p, end, game->label, MAX_GAME_ID_LEN);
+        if (!p) return false;
+    } else {
+        default_label(game->names[0], game->names[1], game->label);
+    }
+
+    game->history = NULL;
+    game->periodic = 0;
+    if (!(game->flags & GAME_FLAG_NO_HISTORY)) {
+        game->history = p;
+        game->periodic = periodic_boards(game->moves);
+        p += (game->moves + 1) / 2;
+    }
+    game->boards = p;
+    return p + (size_t)(game->periodic + 1) * GAME_BOARD_SIZE <= end;
+}
+
+static uint8_t compact_move(const compact_game_t* game, uint32_t i) {
+    uint8_t packed = game->history[i / 2];
+    return (i % 2) ? (uint8_t)(packed >> 4) : (uint8_t)(packed & 0x0F);
+}
+
+/* Board `index` of a GAME record: periodic ones first, then the final one */
+static void compact_board(const compact_game_t* game, uint32_t index, board_t* board) {
+    const uint8_t* p = game->boards + (size_t)index * GAME_BOARD_SIZE;
+    board_init(board);
+    for (int i = 0; i < NUM_PITS; i++) board->pits[i] = p[i];
+    board->scores[0] = p[NUM_PITS];
+    board->scores[1] = p[NUM_PITS + 1];
+    board->current_player = (player_id_t)p[NUM_PITS + 2];
+    board->created_at = (time_t)game->created_at;
+    board->last_move_at = (time_t)game->created_at;
+}
+
+/* Bring the index up to date with one record */
+static void index_apply(const log_record_t* record, uint64_t location) {
+    /* A GAME record stands for the whole game, whether or not the records
+     * before it are still there: compaction drops them */
+    if (record->type == LOG_RECORD_GAME) {
+        compact_game_t game;
+        log_entry_t* entry = entry_reserve(record->game);
+        if (!entry || entry->deleted || !parse_compact(record, &game)) return;
+
+        if (entry->first == 0) {
+            entry->first = location;
+            entry->created_at = game.created_at;
+            entry->player_a = pseudo_intern(game.names[0]);
+            entry->player_b = pseudo_intern(game.names[1]);
+            g_log.live++;
+        } else if (!entry->whole) {
+            pin_entry(entry, false);
+        }
+        entry->last = location;
+        entry->moves = game.moves;
+        entry->state = game.state;
+        entry->winner = game.winner;
+        entry->whole = true;
+        return;
+    }
+
+    if (record->type == LOG_RECORD_START) {
+        log_entry_t* entry = entry_reserve(record->game);
+        if (!entry || entry->first != 0 || record->length < 11) return;
+
+        const uint8_t* p = record->body + 8;
+        const uint8_t* end = record->body + record->length;
+        char names[2][MAX_PSEUDO_LEN];
+        for (int i = 0; i < 2; i++) {
+            size_t len = (p < end) ? *p++ : 0;
+            if (len >= MAX_PSEUDO_LEN || p + len > end) return;
+            memcpy(names[i], p, len);
+            names[i][len] = '\0';
+            p += len;
+        }
+
+        entry->first = location;
+        entry->last = location;
+        entry->created_at = (int64_t)get_u64(record->body);
+        entry->player_a = pseudo_intern(names[0]);
+        entry->player_b = pseudo_intern(names[1]);
+        entry->moves = 0;
+        entry->state = GAME_STATE_IN_PROGRESS;
+        entry->winner = NO_WINNER;
+        entry->whole = false;
+        g_log.live++;
+        pin_entry(entry, true);
+        return;
+    }
+
+    log_entry_t* entry = entry_at(record->game);
+    if (!entry_live(entry)) return;
+
+    switch (record->type) {
+        case LOG_RECORD_MOVE:
+            if (record->length < MOVE_BODY_SIZE) return;
+            pin_extend(entry, location);
+            entry->last = location;
+            entry->moves++;
+            entry->state = record->body[1];
+            entry->winner = (int8_t)record->body[2];
+            entry->whole = false;
+            break;
+        case LOG_RECORD_SNAPSHOT:
+            if (record->length < SNAPSHOT_BODY_SIZE) return;
+            pin_extend(entry, location);
+            entry->last = location;
+            entry->state = record->body[NUM_PITS + 3];
+            entry->winner = (int8_t)record->body[NUM_PITS + 4];
+            entry->whole = false;
+            break;
+        case LOG_RECORD_DELETE:
+            if (!entry->whole) pin_entry(entry, false);
+            entry->deleted = true;
+            g_log.live--;
+            break;
+        default:
+            break;
+    }
+}
+
+/* ========== Segments ========== */
+
+/* Size of the record at the start of `data`; 0 if it is torn or corrupt */
+static size_t record_size(const uint8_t* data, size_t available, bool zlib_crc) {
+    if (available < LOG_RECORD_HEADER) return 0;
+    uint16_t length = get_u16(data + 6);
+    if (length > LOG_MAX_BODY || available < (size_t)LOG_RECORD_HEADER + length) return 0;
+
+    size_t size = LOG_RECORD_HEADER + length;
+    if (get_u32(data) != record_crc(data, size, zlib_crc)) return 0;
+    return size;
+}
+
+/* Decode a record record_size has accepted, in place; returns its size */
+static size_t decode_record(const uint8_t* data, log_record_t* record) {
+    record->type = data[4];
+    record->length = get_u16(data + 6);
+    record->game = get_u64(data + 8);
+    record->prev = get_u64(data + 16);
+    record->body = data + LOG_RECORD_HEADER;
+    return LOG_RECORD_HEADER + (size_t)record->length;
+}
+
+/* Parse the record at the start of `data`; 0 if it is torn or corrupt */
+static size_t parse_record(const uint8_t* data, size_t available, bool zlib_crc, log_record_t* record) {
+    size_t size = record_size(data, available, zlib_crc);
+    if (size != 0) decode_record(data, record);
+    return size;
+}
+
+/* ========== Mappings ========== */
+
+/* Map `size` bytes of `fd` read-only; false if mmap fails, and the file is
+ * then read with pread instead */
+static bool map_file(int fd, size_t size, int advice, log_map_t* map) {
+    map->data = NULL;
+    map->size = 0;
+    if (size == 0) return false;
+    void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) return false;
+    madvise(data, size, advice);
+    map->data = data;
+    map->size = size;
+    return true;
+}
+
+static void unmap_file(log_map_t* map) {
+    if (map->data) munmap(map->data, map->size);
+    map->data = NULL;
+    map->size = 0;
+}
+
+/* ========== Archives ========== */
+
+static void archive_free(archive_t* archive) {
+    if (!archive) return;
+    unmap_file(&archive->map);
+    pthread_mutex_destroy(&archive->lock);
+    free(archive->raw_start);
+    free(archive->file_offset);
+    free(archive->cache);
+    free(archive);
+}
+
+/* Map archive `segment` and check its header, trailer and index, keeping
+ * the index; NULL if any is wrong. Closes `fd` either way. */
+static archive_t* archive_open(uint32_t segment, int fd) {
+    struct stat st;
+    log_map_t map = { NULL, 0 };
+    bool mapped = fstat(fd, &st) == 0 && (uint64_t)st.st_size >= LOG_SEGMENT_HEADER + LOG_ARCHIVE_TRAILER &&
+                  map_file(fd, (size_t)st.st_size, MADV_RANDOM, &map);
+    close(fd);
+    if (!mapped) return NULL;
+
+    const uint8_t* trailer = map.data + map.size - LOG_ARCHIVE_TRAILER;
+    uint32_t blocks = get_u32(trailer);
+    uint64_t index_offset = get_u64(trailer + 8);
+    const uint8_t* index = map.data + index_offset;
+    uint32_t version = get_u32(map.data + 4);
+    bool zlib_crc = version == LOG_ARCHIVE_VERSION_CRC32;
+    if (get_u32(map.data) != LOG_ARCHIVE_MAGIC || (version != LOG_ARCHIVE_VERSION && !zlib_crc) ||
+        get_u32(map.data + 8) != segment || get_u32(trailer + 28) != LOG_ARCHIVE_MAGIC ||
+        index_offset + (uint64_t)blocks * LOG_ARCHIVE_INDEX_ENTRY + LOG_ARCHIVE_TRAILER != map.size ||
+        file_crc(zlib_crc, index, (size_t)blocks * LOG_ARCHIVE_INDEX_ENTRY) != get_u32(trailer + 24)) {
+        unmap_file(&map);
+        return NULL;
+    }
+
+    archive_t* archive = calloc(1, sizeof(*archive));
+    if (!archive) {
+        unmap_file(&map);
+        return NULL;
+    }
+    archive->map = map;
+    archive->zlib_crc = zlib_crc;
+    archive->cached = -1;
+    pthread_mutex_init(&archive->lock, NULL);
+    archive->raw_start = malloc(((size_t)blocks + 1) * sizeof(uint32_t));
+    archive->file_offset = malloc(((size_t)blocks + 1) * sizeof(uint64_t));
+    if (!archive->raw_start || !archive->file_offset) {
+        archive_free(archive);
+        return NULL;
+    }
+
+    archive->blocks = blocks;
+    archive->max_game = get_u64(trailer + 16);
+    archive->file_size = map.size;
+    archive->raw_start[blocks] = get_u32(trailer + 4);
+    archive->file_offset[blocks] = index_offset;
+    bool ok = archive->raw_start[blocks] >= LOG_SEGMENT_HEADER;
+    for (uint32_t b = 0; b < blocks; b++) {
+        archive->raw_start[b] = get_u32(index + (size_t)b * LOG_ARCHIVE_INDEX_ENTRY);
+        archive->file_offset[b] = get_u64(index + (size_t)b * LOG_ARCHIVE_INDEX_ENTRY + 4);
+        uint32_t previous = b ? archive->raw_start[b - 1] : LOG_SEGMENT_HEADER;
+        ok = ok && archive->raw_start[b] >= previous && archive->file_offset[b] >= LOG_SEGMENT_HEADER;
+    }
+    for (uint32_t b = 0; ok && b < blocks; b++) {
+        ok = archive->raw_start[b + 1] - archive->raw_start[b] <= LOG_ARCHIVE_BLOCK_MAX &&
+             archive->file_offset[b + 1] > archive->file_offset[b] + LOG_ARCHIVE_BLOCK_HEADER;
+    }
+    if (!ok) {
+        archive_free(archive);
+        return NULL;
+    }
+    return archive;
+}
+
+/* Inflate block `b` into `out`, straight from the mapping */
+static bool archive_block(const archive_t* archive, uint32_t b, uint8_t* out) {
+    const uint8_t* packed = archive->map.data + archive->file_offset[b];
+    uint64_t size = archive->file_offset[b + 1] - archive->file_offset[b];
+    uint32_t raw = archive->raw_start[b + 1] - archive->raw_start[b];
+    uint32_t length = get_u32(packed + 4);
+    if (length != size - LOG_ARCHIVE_BLOCK_HEADER || get_u32(packed + 8) != raw ||
+        file_crc(archive->zlib_crc, packed + LOG_ARCHIVE_BLOCK_HEADER, length) != get_u32(packed)) {
+        return false;
+    }
+    uLongf inflated = raw;
+    return uncompress(out, &inflated, packed + LOG_ARCHIVE_BLOCK_HEADER, length) == Z_OK && inflated == raw;
+}
+
+/* Up to `max` record bytes from `offset` in an archive into `data`; 0 if
+ * the offset is outside it or its block is bad */
+static size_t archive_read(archive_t* archive, uint32_t offset, uint8_t* data, size_t max) {
+    uint32_t low = 0, high = archive->blocks;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (archive->raw_start[mid + 1] <= offset) low = mid + 1;
+        else high = mid;
+    }
+    if (low == archive->blocks || offset < archive->raw_start[low]) return 0;
+
+    size_t n = 0;
+    pthread_mutex_lock(&archive->lock);
+    if (!archive->cache) archive->cache = malloc(LOG_ARCHIVE_BLOCK_MAX);
+    if (archive->cache && archive->cached != (int64_t)low) {
+        archive->cached = archive_block(archive, low, archive->cache) ? (int64_t)low : -1;
+    }
+    if (archive->cached == (int64_t)low) {
+        n = archive->raw_start[low + 1] - offset;
+        if (n > max) n = max;
+        memcpy(data, archive->cache + (offset - archive->raw_start[low]), n);
+    }
+    pthread_mutex_unlock(&archive->lock);
+    return n;
+}
+
+/* A read is counted from taking its locations, with the lock held, until
+ * it is done with the records; returns the counter to leave */
+static uint32_t reader_enter(void) {
+    uint32_t parity = g_log.epoch & 1;
+    __atomic_add_fetch(&g_log.readers[parity], 1, __ATOMIC_SEQ_CST);
+    return parity;
+}
+
+static void reader_leave(uint32_t parity) {
+    if (__atomic_sub_fetch(&g_log.readers[parity], 1, __ATOMIC_SEQ_CST) == 0 &&
+        __atomic_load_n(&g_log.draining, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&g_log.drain_lock);
+        pthread_cond_broadcast(&g_log.drained);
+        pthread_mutex_unlock(&g_log.drain_lock);
+    }
+}
+
+/* Wait for the reads counted in `parity`, which no new read joins since
+ * the epoch moved on; caller does not hold the lock */
+static void readers_drain(uint32_t parity) {
+    pthread_mutex_lock(&g_log.drain_lock);
+    __atomic_store_n(&g_log.draining, true, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&g_log.readers[parity], __ATOMIC_SEQ_CST) != 0) {
+        pthread_cond_wait(&g_log.drained, &g_log.drain_lock);
+    }
+    __atomic_store_n(&g_log.draining, false, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&g_log.drain_lock);
+}
+
+/* Records in sealed segments are decoded in place in their mapping and
+ * archived ones copied out of their block, with no system call once the
+ * pages and the block are in memory; the active segment is read with pread */
+static error_code_t read_record(uint64_t location, game_log_id_t game, log_record_t* record) {
+    uint32_t segment = LOCATION_SEGMENT(location);
+    uint32_t offset = LOCATION_OFFSET(location);
+    if (segment & LOG_ARCHIVE_BIT) {
+        /* Records never span blocks */
+        archive_t* archive = LOCATION_FILE(location) <= GAME_LOG_MAX_SEGMENTS
+                                 ? g_log.archives[LOCATION_FILE(location)] : NULL;
+        size_t n = archive ? archive_read(archive, offset, record->copy, sizeof(record->copy)) : 0;
+        if (n == 0 || parse_record(record->copy, n, archive->zlib_crc, record) == 0 || record->game != game) {
+            return ERR_SERIALIZATION;
+        }
+        return SUCCESS;
+    }
+    if (segment == 0 || segment > GAME_LOG_MAX_SEGMENTS) return ERR_SERIALIZATION;
+
+    const uint8_t* mapped = __atomic_load_n(&g_log.maps[segment].data, __ATOMIC_ACQUIRE);
+    if (mapped) {
+        size_t size = g_log.maps[segment].size;
+        if (offset >= size || parse_record(mapped + offset, size - offset, g_log.zlib_crc[segment], record) == 0 ||
+            record->game != game) {
+            return ERR_SERIALIZATION;
+        }
+        return SUCCESS;
+    }
+    if (g_log.fds[segment] < 0) return ERR_SERIALIZATION;
+
+    /* Most records fit in the read-ahead; a longer one takes a second read */
+    __atomic_add_fetch(&g_log.file_reads, 1, __ATOMIC_RELAXED);
+    uint8_t* data = record->copy;
+    int fd = g_log.fds[segment];
+    ssize_t n = pread(fd, data, LOG_READ_AHEAD, offset);
+    if (n >= LOG_RECORD_HEADER) {
+        size_t size = LOG_RECORD_HEADER + (size_t)get_u16(data + 6);
+        if (size > (size_t)n && size <= sizeof(record->copy)) {
+            ssize_t rest = pread(fd, data + n, size - (size_t)n, (off_t)offset + (off_t)n);
+            if (rest > 0) n += rest;
+        }
+    }
+    if (n <= 0 || parse_record(data, (size_t)n, g_log.zlib_crc[segment], record) == 0 || record->game != game) {
+        return ERR_SERIALIZATION;
+    }
+    return SUCCESS;
+}
+
+static void write_segment_header(uint8_t header[LOG_SEGMENT_HEADER], uint32_t segment) {
+    memset(header, 0, LOG_SEGMENT_HEADER);
+    put_u32(header, LOG_MAGIC);
+    put_u32(header + 4, LOG_VERSION);
+    put_u32(header + 8, segment);
+}
+
+/* Start segment `segment` and make it the active one; caller holds the lock */
+static error_code_t segment_create(uint32_t segment) {
+    if (segment == 0 || segment > GAME_LOG_MAX_SEGMENTS) return ERR_MAX_CAPACITY;
+
+    char path[LOG_PATH_MAX + 16];
+    segment_path(segment, path, sizeof(path));
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return ERR_NETWORK_ERROR;
+
+    uint8_t header[LOG_SEGMENT_HEADER];
+    write_segment_header(header, segment);
+    if (pwrite(fd, header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        close(fd);
+        return ERR_NETWORK_ERROR;
+    }
+
+    /* The new file's directory entry must survive a crash too */
+    int dir_fd = open(g_log.dir, O_RDONLY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+
+    /* The segment being sealed will not change again: map it for reads. Its
+     * last records may still be queued, but readers wait for those. */
+    if (g_log.segment != 0) {
+        g_log.sealed_bytes += g_log.size;
+        log_map_t map;
+        if (g_log.fds[g_log.segment] >= 0 && map_file(g_log.fds[g_log.segment], g_log.size, MADV_RANDOM, &map)) {
+            /* Readers take the size once they see the data */
+            g_log.maps[g_log.segment].size = map.size;
+            __atomic_store_n(&g_log.maps[g_log.segment].data, map.data, __ATOMIC_RELEASE);
+        }
+    }
+    g_log.fds[segment] = fd;
+    g_log.zlib_crc[segment] = false;
+    g_log.segment = segment;
+    g_log.size = LOG_SEGMENT_HEADER;
+    return SUCCESS;
+}
+
+/* Inflate every block of an archive for segment_read: load->data gets its
+ * records at their offsets, and load->valid_size stops at the first bad
+ * block */
+static void* archive_load(segment_load_t* load) {
+    archive_t* archive = load->archive;
+    uint32_t end = archive->raw_start[archive->blocks];
+    uint8_t* data = calloc(1, end);
+    if (!data) {
+        load->err = ERR_MAX_CAPACITY;
+        return NULL;
+    }
+
+    /* Read ahead for this pass only; lookups afterwards are by block */
+    madvise(archive->map.data, archive->map.size, MADV_SEQUENTIAL);
+    uint32_t valid = LOG_SEGMENT_HEADER;
+    for (uint32_t b = 0; b < archive->blocks; b++) {
+        if (!archive_block(archive, b, data + archive->raw_start[b])) break;
+        valid = archive->raw_start[b + 1];
+    }
+    madvise(archive->map.data, archive->map.size, MADV_RANDOM);
+
+    size_t offset = LOG_SEGMENT_HEADER;
+    while (offset < valid) {
+        size_t used = record_size(data + offset, valid - offset, archive->zlib_crc);
+        if (used == 0) break;
+        offset += used;
+    }
+    load->data = data;
+    load->valid_size = (uint32_t)offset;
+    load->bytes = (uint32_t)archive->file_size;
+    load->zlib_crc = archive->zlib_crc;
+    return NULL;
+}
+
+/* Read a whole segment and check its records, without the index lock, so
+ * that several segments can be read at once. The file is mapped for a
+ * sequential pass (read into memory if it cannot be). load->valid_size is
+ * the length of its good records; anything after it is torn or corrupt. */
+static void* segment_read(void* arg) {
+    segment_load_t* load = (segment_load_t*)arg;
+    load->data = NULL;
+    load->map.data = NULL;
+    load->map.size = 0;
+    load->valid_size = 0;
+    load->bytes = 0;
+    load->err = SUCCESS;
+    if (load->archive) return archive_load(load);
+
+    struct stat st;
+    if (fstat(load->fd, &st) != 0) {
+        load->err = ERR_NETWORK_ERROR;
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size < LOG_SEGMENT_HEADER) return NULL;
+
+    uint8_t* data;
+    if (map_file(load->fd, size, MADV_SEQUENTIAL, &load->map)) {
+        data = load->map.data;
+    } else {
+        data = malloc(size);
+        if (!data) {
+            load->err = ERR_MAX_CAPACITY;
+            return NULL;
+        }
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = pread(load->fd, data + done, size - done, (off_t)done);
+            if (n <= 0) break;
+            done += (size_t)n;
+        }
+        if (done != size) {
+            free(data);
+            load->err = ERR_NETWORK_ERROR;
+            return NULL;
+        }
+    }
+    uint32_t version = get_u32(data + 4);
+    if (get_u32(data) != LOG_MAGIC || (version != LOG_VERSION && version != LOG_VERSION_CRC32) ||
+        get_u32(data + 8) != load->segment) {
+        if (load->map.data) unmap_file(&load->map);
+        else free(data);
+        return NULL;
+    }
+
+    load->zlib_crc = version == LOG_VERSION_CRC32;
+    size_t offset = LOG_SEGMENT_HEADER;
+    while (offset < size) {
+        size_t used = record_size(data + offset, size - offset, load->zlib_crc);
+        if (used == 0) break;
+        offset += used;
+    }
+    load->data = data;
+    load->valid_size = (uint32_t)offset;
+    load->bytes = (uint32_t)offset;
+    return NULL;
+}
+
+static void segment_release(segment_load_t* load) {
+    if (load->map.data) unmap_file(&load->map);
+    else free(load->data);
+    load->data = NULL;
+}
+
+/* Add a segment segment_read has checked to the index, in log order;
+ * caller holds the lock */
+static void segment_apply(segment_load_t* load) {
+    if (!load->data) return;
+    uint32_t segment = load->archive ? load->segment | LOG_ARCHIVE_BIT : load->segment;
+    log_record_t record;
+    for (size_t offset = LOG_SEGMENT_HEADER; offset < load->valid_size;) {
+        size_t used = decode_record(load->data + offset, &record);
+        index_apply(&record, LOCATION(segment, offset));
+        offset += used;
+    }
+    /* IDs of games whose records compaction dropped stay assigned */
+    if (load->archive && load->archive->max_game > g_log.count) g_log.count = load->archive->max_game;
+}
+
+static int scan_thread_count(void) {
+    int threads = g_log.scan_threads;
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    return threads < LOG_SCAN_MAX_THREADS ? threads : LOG_SCAN_MAX_THREADS;
+}
+
+/* Rebuild the index from segments 1..count, whose fds or archives are
+ * open; sealed segments keep the mapping they were read through. Segments
+ * are read and checked a batch at a time, one thread each, and applied in
+ * order, since a game's records may span segments. Caller holds the lock. */
+static error_code_t segments_scan(uint32_t count) {
+    segment_load_t loads[LOG_SCAN_MAX_THREADS];
+    pthread_t threads[LOG_SCAN_MAX_THREADS];
+    uint32_t batch = (uint32_t)scan_thread_count();
+
+    for (uint32_t first = 1; first <= count; first += batch) {
+        uint32_t n = count - first + 1 < batch ? count - first + 1 : batch;
+        bool started[LOG_SCAN_MAX_THREADS] = { false };
+        for (uint32_t i = 0; i < n; i++) {
+            loads[i].segment = first + i;
+            loads[i].fd = g_log.fds[first + i];
+            loads[i].archive = g_log.archives[first + i];
+            if (n > 1) started[i] = pthread_create(&threads[i], NULL, segment_read, &loads[i]) == 0;
+            if (!started[i]) segment_read(&loads[i]);
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (started[i]) pthread_join(threads[i], NULL);
+        }
+
+        error_code_t err = SUCCESS;
+        for (uint32_t i = 0; i < n; i++) {
+            if (err == SUCCESS) err = loads[i].err;
+            if (err == SUCCESS) {
+                if (g_log.segment != 0) g_log.sealed_bytes += g_log.size;
+                g_log.segment = loads[i].segment;
+                g_log.size = loads[i].bytes;
+                if (!loads[i].archive) g_log.zlib_crc[loads[i].segment] = loads[i].zlib_crc;
+                segment_apply(&loads[i]);
+            }
+            if (err == SUCCESS && loads[i].map.data && loads[i].segment < count) {
+                /* Sealed: the mapping stays for reads, which go anywhere */
+                madvise(loads[i].map.data, loads[i].map.size, MADV_RANDOM);
+                g_log.maps[loads[i].segment] = loads[i].map;
+            } else if (loads[i].archive) {
+                free(loads[i].data);
+            } else {
+                segment_release(&loads[i]);
+            }
+        }
+        if (err != SUCCESS) return err;
+    }
+    return SUCCESS;
+}
+
+/* ========== Write-behind ========== */
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void writer_wake(void) {
+    if (__atomic_load_n(&g_writer.idle, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&g_writer.lock);
+        pthread_cond_signal(&g_writer.wake);
+        pthread_mutex_unlock(&g_writer.lock);
+    }
+}
+
+/* Block until the writer has reached `position`: written, or also synced
+ * if `durable` */
+static error_code_t writer_wait(uint64_t position, bool durable) {
+    pthread_mutex_lock(&g_writer.lock);
+    if (durable && g_writer.sync_target < position) {
+        g_writer.sync_target = position;
+        pthread_cond_signal(&g_writer.wake);
+    }
+    while (g_writer.running && !g_writer.failed &&
+           (durable ? g_writer.durable : g_writer.tail) < position) {
+        pthread_cond_wait(&g_writer.done, &g_writer.lock);
+    }
+    error_code_t err = g_writer.failed ? ERR_NETWORK_ERROR : SUCCESS;
+    pthread_mutex_unlock(&g_writer.lock);
+    return err;
+}
+
+/* Copy a record into the queue; caller holds the index lock, which makes
+ * it the only producer. *position is where the queue must get to for the
+ * record to be written. */
+static error_code_t queue_push(const uint8_t* record, size_t length, uint64_t location, uint64_t* position) {
+    uint32_t need = (uint32_t)((sizeof(queue_entry_t) + length + LOG_QUEUE_ALIGN - 1) & ~(size_t)(LOG_QUEUE_ALIGN - 1));
+    uint64_t head = g_writer.head;
+    uint32_t offset = (uint32_t)(head & (LOG_QUEUE_SIZE - 1));
+    uint32_t pad = (LOG_QUEUE_SIZE - offset < need) ? LOG_QUEUE_SIZE - offset : 0;
+
+    /* Full: let the writer catch up */
+    if (head + pad + need - __atomic_load_n(&g_writer.tail, __ATOMIC_ACQUIRE) > LOG_QUEUE_SIZE) {
+        pthread_mutex_lock(&g_writer.lock);
+        while (!g_writer.failed && head + pad + need - g_writer.tail > LOG_QUEUE_SIZE) {
+            pthread_cond_signal(&g_writer.wake);
+            pthread_cond_wait(&g_writer.done, &g_writer.lock);
+        }
+        pthread_mutex_unlock(&g_writer.lock);
+    }
+    if (__atomic_load_n(&g_writer.failed, __ATOMIC_ACQUIRE)) return ERR_NETWORK_ERROR;
+
+    if (pad) {
+        ((queue_entry_t*)(g_writer.queue + offset))->size = 0;
+        offset = 0;
+    }
+    queue_entry_t* entry = (queue_entry_t*)(g_writer.queue + offset);
+    entry->size = need;
+    entry->length = (uint32_t)length;
+    entry->location = location;
+    memcpy(entry + 1, record, length);
+
+    *position = head + pad + need;
+    __atomic_store_n(&g_writer.head, *position, __ATOMIC_SEQ_CST);
+    writer_wake();
+    return SUCCESS;
+}
+
+/* Write one run of records that are contiguous in a segment */
+static bool write_run(uint64_t location, struct iovec* iov, int count) {
+    int fd = g_log.fds[LOCATION_SEGMENT(location)];
+    off_t offset = LOCATION_OFFSET(location);
+    while (count > 0) {
+        ssize_t n = pwritev(fd, iov, count, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        __atomic_add_fetch(&g_writer.writes, 1, __ATOMIC_RELAXED);
+
+        offset += n;
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return true;
+}
+
+/* Write queue bytes [from, to), grouping records that follow each other in
+ * a segment. Segments written are added to [*dirty_low, *dirty_high]. */
+static bool write_batch(uint64_t from, uint64_t to, uint32_t* dirty_low, uint32_t* dirty_high) {
+    struct iovec iov[LOG_WRITE_IOVECS];
+    int count = 0;
+    uint64_t run_start = 0, run_end = 0;
+
+    for (uint64_t pos = from; pos < to;) {
+        uint32_t offset = (uint32_t)(pos & (LOG_QUEUE_SIZE - 1));
+        queue_entry_t* entry = (queue_entry_t*)(g_writer.queue + offset);
+        if (entry->size == 0) {
+            pos += LOG_QUEUE_SIZE - offset;
+            continue;
+        }
+
+        if (count > 0 && (entry->location != run_end || count == LOG_WRITE_IOVECS)) {
+            if (!write_run(run_start, iov, count)) return false;
+            count = 0;
+        }
+        if (count == 0) run_start = entry->location;
+        iov[count].iov_base = entry + 1;
+        iov[count].iov_len = entry->length;
+        count++;
+        run_end = entry->location + entry->length;
+
+        uint32_t segment = LOCATION_SEGMENT(entry->location);
+        if (*dirty_low == 0 || segment < *dirty_low) *dirty_low = segment;
+        if (segment > *dirty_high) *dirty_high = segment;
+        pos += entry->size;
+    }
+    return count == 0 || write_run(run_start, iov, count);
+}
+
+static bool sync_segments(uint32_t low, uint32_t high) {
+    for (uint32_t segment = low; segment != 0 && segment <= high; segment++) {
+        if (fdatasync(g_log.fds[segment]) != 0) return false;
+    }
+    return true;
+}
+
+/* Drain the queue; sync when a waiter asks, when the interval is up, and
+ * before exiting */
+static void* writer_main(void* arg) {
+    (void)arg;
+    uint32_t dirty_low = 0, dirty_high = 0;
+    uint64_t last_sync = monotonic_ms();
+
+    pthread_mutex_lock(&g_writer.lock);
+    for (;;) {
+        uint64_t head = __atomic_load_n(&g_writer.head, __ATOMIC_SEQ_CST);
+        uint64_t now = monotonic_ms();
+        bool unsynced = g_writer.durable != g_writer.tail;
+        bool interval = g_writer.policy == GAME_LOG_SYNC_INTERVAL;
+        bool sync = unsynced && (g_writer.sync_target > g_writer.durable || g_writer.stop ||
+                                 (interval && now >= last_sync + (uint64_t)g_writer.interval_ms));
+
+        if (g_writer.failed || (head == g_writer.tail && !sync)) {
+            if (g_writer.stop) break;
+
+            __atomic_store_n(&g_writer.idle, true, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&g_writer.head, __ATOMIC_SEQ_CST) == head) {
+                uint64_t deadline = (unsynced && interval) ? last_sync + (uint64_t)g_writer.interval_ms
+                                                           : now + 1000;
+                struct timespec ts = { (time_t)(deadline / 1000), (long)(deadline % 1000) * 1000000 };
+                pthread_cond_timedwait(&g_writer.wake, &g_writer.lock, &ts);
+            }
+            __atomic_store_n(&g_writer.idle, false, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        /* Write without the lock; appenders keep queueing meanwhile */
+        uint64_t written = g_writer.tail;
+        pthread_mutex_unlock(&g_writer.lock);
+        bool ok = head == written || write_batch(written, head, &dirty_low, &dirty_high);
+        pthread_mutex_lock(&g_writer.lock);
+        if (ok) __atomic_store_n(&g_writer.tail, head, __ATOMIC_RELEASE);
+
+        /* Everything written so far goes in this commit */
+        sync = ok && g_writer.durable != head &&
+               (g_writer.sync_target > g_writer.durable || g_writer.stop ||
+                (interval && now >= last_sync + (uint64_t)g_writer.interval_ms));
+        if (sync) {
+            pthread_mutex_unlock(&g_writer.lock);
+            ok = sync_segments(dirty_low, dirty_high);
+            pthread_mutex_lock(&g_writer.lock);
+            if (ok) {
+                g_writer.durable = head;
+                g_writer.commits++;
+                dirty_low = dirty_high = 0;
+                last_sync = monotonic_ms();
+            }
+        }
+        if (!ok) __atomic_store_n(&g_writer.failed, true, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&g_writer.done);
+    }
+    pthread_cond_broadcast(&g_writer.done);
+    pthread_mutex_unlock(&g_writer.lock);
+    return NULL;
+}
+
+static error_code_t writer_start(void) {
+    g_writer.queue = malloc(LOG_QUEUE_SIZE);
+    if (!g_writer.queue) return ERR_MAX_CAPACITY;
+    g_writer.head = g_writer.tail = g_writer.durable = g_writer.sync_target = 0;
+    g_writer.stop = g_writer.idle = g_writer.failed = false;
+    g_writer.writes = g_writer.commits = 0;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_writer.wake, &attr);
+    pthread_cond_init(&g_writer.done, &attr);
+    pthread_condattr_destroy(&attr);
+
+    g_writer.running = true;
+    if (pthread_create(&g_writer.thread, NULL, writer_main, NULL) != 0) {
+        g_writer.running = false;
+        pthread_cond_destroy(&g_writer.wake);
+        pthread_cond_destroy(&g_writer.done);
+        free(g_writer.queue);
+        g_writer.queue = NULL;
+        return ERR_MAX_CAPACITY;
+    }
+    return SUCCESS;
+}
+
+/* Drain, sync and stop the writer */
+static void writer_stop(void) {
+    if (!g_writer.running) return;
+    pthread_mutex_lock(&g_writer.lock);
+    g_writer.stop = true;
+    pthread_cond_signal(&g_writer.wake);
+    pthread_mutex_unlock(&g_writer.lock);
+    pthread_join(g_writer.thread, NULL);
+
+    pthread_mutex_lock(&g_writer.lock);
+    g_writer.running = false;
+    pthread_cond_broadcast(&g_writer.done);
+    pthread_mutex_unlock(&g_writer.lock);
+    pthread_cond_destroy(&g_writer.wake);
+    pthread_cond_destroy(&g_writer.done);
+    free(g_writer.queue);
+    g_writer.queue = NULL;
+}
+
+/* Caller holds the lock. The record is queued for the writer; *position is
+ * the queue position it is written at. */
+static error_code_t append_record(uint8_t type, game_log_id_t game, uint64_t prev,
+                                  const uint8_t* body, uint16_t length, uint64_t* location,
+                                  uint64_t* position) {
+    if (!g_log.open) return ERR_INVALID_PARAM;
+    if (length > LOG_MAX_BODY) return ERR_INVALID_PARAM;
+
+    size_t size = LOG_RECORD_HEADER + length;
+    if ((uint64_t)g_log.size + size > GAME_LOG_SEGMENT_SIZE) {
+        error_code_t err = segment_create(g_log.segment + 1);
+        if (err != SUCCESS) return err;
+    }
+
+    uint8_t record[LOG_RECORD_HEADER + LOG_MAX_BODY];
+    record[4] = type;
+    record[5] = 0;
+    put_u16(record + 6, length);
+    put_u64(record + 8, game);
+    put_u64(record + 16, prev);
+    if (length > 0) memcpy(record + LOG_RECORD_HEADER, body, length);
+    put_u32(record, record_crc(record, size, false));
+
+    *location = LOCATION(g_log.segment, g_log.size);
+    error_code_t err = queue_push(record, size, *location, position);
+    if (err != SUCCESS) return err;
+
+    g_log.size += (uint32_t)size;
+    g_log.appends++;
+    return SUCCESS;
+}
+
+/* ========== Compaction ========== */
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} byte_buffer_t;
+
+static bool buffer_append(byte_buffer_t* buffer, const void* data, size_t size) {
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        while (capacity < buffer->size + size) capacity *= 2;
+        uint8_t* grown = realloc(buffer->data, capacity);
+        if (!grown) return false;
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return true;
+}
+
+/* Deflate the records in `raw` as the archive's next block, at *file_offset */
+static bool archive_write_block(int fd, const byte_buffer_t* raw, uint8_t* packed, uint64_t* file_offset) {
+    uLongf length = compressBound(LOG_ARCHIVE_BLOCK_MAX);
+    if (compress2(packed + LOG_ARCHIVE_BLOCK_HEADER, &length, raw->data, (uLong)raw->size, Z_DEFAULT_COMPRESSION) !=
+        Z_OK) {
+        return false;
+    }
+    put_u32(packed, checksum_crc32c(0, packed + LOG_ARCHIVE_BLOCK_HEADER, length));
+    put_u32(packed + 4, (uint32_t)length);
+    put_u32(packed + 8, (uint32_t)raw->size);
+    size_t size = LOG_ARCHIVE_BLOCK_HEADER + length;
+    if (pwrite(fd, packed, size, (off_t)*file_offset) != (ssize_t)size) return false;
+    *file_offset += size;
+    return true;
+}
+
+/* Whether a sealed segment's record is still needed; caller holds the lock */
+static bool compact_keeps(uint32_t segment, const uint8_t* record, uint32_t offset) {
+    log_entry_t* entry = entry_at(get_u64(record + 8));
+    if (!entry || entry->first == 0) return false;
+    switch (record[4]) {
+        case LOG_RECORD_GAME:
+            return !entry->deleted && entry->last == LOCATION(segment, offset);
+        case LOG_RECORD_DELETE:
+            /* Needed while the game has records in an earlier file */
+            return entry->deleted && LOCATION_FILE(entry->first) < segment;
+        default:
+            return false;
+    }
+}
+
+/* Write archive `segment` from the records of `load` still needed, then
+ * swap it in for the segment. *remap gets (ID, old location, new location)
+ * for each GAME record kept, *firsts the IDs of live games whose first
+ * record is in the segment. */
+static error_code_t archive_create(segment_load_t* load, uint64_t max_game, byte_buffer_t* remap,
+                                   byte_buffer_t* firsts) {
+    uint32_t segment = load->segment;
+    char path[LOG_PATH_MAX + 24], tmp[LOG_PATH_MAX + 24];
+    archive_path(segment, "", path, sizeof(path));
+    archive_path(segment, ".tmp", tmp, sizeof(tmp));
+    int fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return ERR_NETWORK_ERROR;
+
+    uint8_t header[LOG_SEGMENT_HEADER];
+    memset(header, 0, sizeof(header));
+    put_u32(header, LOG_ARCHIVE_MAGIC);
+    put_u32(header + 4, LOG_ARCHIVE_VERSION);
+    put_u32(header + 8, segment);
+
+    byte_buffer_t raw = { 0 }, index = { 0 };
+    uint8_t* packed = malloc(LOG_ARCHIVE_BLOCK_HEADER + compressBound(LOG_ARCHIVE_BLOCK_MAX));
+    uint64_t file_offset = LOG_SEGMENT_HEADER;
+    uint32_t raw_offset = LOG_SEGMENT_HEADER;
+    uint32_t blocks = 0;
+    bool ok = packed && pwrite(fd, header, sizeof(header), 0) == (ssize_t)sizeof(header);
+
+    /* Records are checked a batch at a time, so appends wait at most that long */
+    for (uint32_t offset = LOG_SEGMENT_HEADER; ok && offset < load->valid_size;) {
+        uint32_t kept[LOG_COMPACT_BATCH], kept_count = 0;
+        uint64_t starts[LOG_COMPACT_BATCH];
+        uint32_t start_count = 0;
+        pthread_mutex_lock(&g_log.lock);
+        for (uint32_t n = 0; n < LOG_COMPACT_BATCH && offset < load->valid_size; n++) {
+            const uint8_t* record = load->data + offset;
+            if (compact_keeps(segment, record, offset)) kept[kept_count++] = offset;
+            uint64_t id = get_u64(record + 8);
+            log_entry_t* entry = entry_at(id);
+            if (entry_live(entry) && entry->first == LOCATION(segment, offset)) starts[start_count++] = id;
+            offset += LOG_RECORD_HEADER + get_u16(record + 6);
+        }
+        pthread_mutex_unlock(&g_log.lock);
+        ok = start_count == 0 || buffer_append(firsts, starts, start_count * sizeof(uint64_t));
+
+        for (uint32_t k = 0; ok && k < kept_count; k++) {
+            const uint8_t* record = load->data + kept[k];
+            size_t size = LOG_RECORD_HEADER + get_u16(record + 6);
+            if (raw.size == 0) {
+                uint8_t entry[LOG_ARCHIVE_INDEX_ENTRY];
+                put_u32(entry, raw_offset);
+                put_u64(entry + 4, file_offset);
+                ok = buffer_append(&index, entry, sizeof(entry));
+                blocks++;
+            }
+            ok = ok && buffer_append(&raw, record, size);
+            if (ok && load->zlib_crc) {
+                uint8_t* copied = raw.data + raw.size - size;
+                put_u32(copied, record_crc(copied, size, false));
+            }
+            if (ok && record[4] == LOG_RECORD_GAME) {
+                uint64_t moved[3] = { get_u64(record + 8), LOCATION(segment, kept[k]),
+                                      LOCATION(segment | LOG_ARCHIVE_BIT, raw_offset) };
+                ok = buffer_append(remap, moved, sizeof(moved));
+            }
+            raw_offset += (uint32_t)size;
+            if (ok && raw.size >= LOG_ARCHIVE_BLOCK) {
+                ok = archive_write_block(fd, &raw, packed, &file_offset);
+                raw.size = 0;
+            }
+        }
+    }
+    if (ok && raw.size > 0) ok = archive_write_block(fd, &raw, packed, &file_offset);
+
+    uint8_t trailer[LOG_ARCHIVE_TRAILER];
+    put_u32(trailer, blocks);
+    put_u32(trailer + 4, raw_offset);
+    put_u64(trailer + 8, file_offset);
+    put_u64(trailer + 16, max_game);
+    put_u32(trailer + 24, checksum_crc32c(0, index.data, index.size));
+    put_u32(trailer + 28, LOG_ARCHIVE_MAGIC);
+    ok = ok && (index.size == 0 || pwrite(fd, index.data, index.size, (off_t)file_offset) == (ssize_t)index.size) &&
+         pwrite(fd, trailer, sizeof(trailer), (off_t)(file_offset + index.size)) == (ssize_t)sizeof(trailer);
+    free(raw.data);
+    free(index.data);
+    free(packed);
+
+    /* The archive is complete on disk before it replaces the segment */
+    ok = ok && fdatasync(fd) == 0 && rename(tmp, path) == 0;
+    if (!ok) {
+        close(fd);
+        unlink(tmp);
+        return ERR_NETWORK_ERROR;
+    }
+    int dir_fd = open(g_log.dir, O_RDONLY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    load->archive = archive_open(segment, fd);
+    return load->archive ? SUCCESS : ERR_SERIALIZATION;
+}
+
+/* Archive sealed segment `segment`, which no game without a GAME record
+ * has records in */
+static error_code_t compact_segment(uint32_t segment) {
+    uint64_t started = monotonic_ms();
+    pthread_mutex_lock(&g_log.lock);
+    if (!g_log.open || segment >= g_log.segment || g_log.fds[segment] < 0) {
+        pthread_mutex_unlock(&g_log.lock);
+        return ERR_INVALID_PARAM;
+    }
+    segment_load_t load = { .segment = segment, .fd = g_log.fds[segment] };
+    uint64_t max_game = g_log.count;
+    pthread_mutex_unlock(&g_log.lock);
+
+    /* Reading and writing go without the lock; only compact_keeps and the
+     * swap below take it */
+    segment_read(&load);
+    if (load.err != SUCCESS) return load.err;
+    byte_buffer_t remap = { 0 }, firsts = { 0 };
+    error_code_t err = archive_create(&load, max_game, &remap, &firsts);
+    segment_release(&load);
+    if (err != SUCCESS) {
+        free(remap.data);
+        free(firsts.data);
+        return err;
+    }
+
+    pthread_mutex_lock(&g_log.lock);
+    const uint64_t* moved = (const uint64_t*)remap.data;
+    for (size_t i = 0; i < remap.size / (3 * sizeof(uint64_t)); i++, moved += 3) {
+        log_entry_t* entry = entry_at(moved[0]);
+        if (entry && entry->last == moved[1]) entry->last = moved[2];
+    }
+    /* A game whose first record went keeps its GAME record as the first */
+    const uint64_t* first_ids = (const uint64_t*)firsts.data;
+    for (size_t i = 0; i < firsts.size / sizeof(uint64_t); i++) {
+        log_entry_t* entry = entry_at(first_ids[i]);
+        if (entry_live(entry) && LOCATION_SEGMENT(entry->first) == segment) entry->first = entry->last;
+    }
+    struct stat st;
+    uint64_t bytes = fstat(g_log.fds[segment], &st) == 0 ? (uint64_t)st.st_size : 0;
+    g_log.archives[segment] = load.archive;
+    uint32_t parity = g_log.epoch++ & 1;
+    g_log.sealed_bytes = g_log.sealed_bytes - bytes + load.archive->file_size;
+    g_log.archived++;
+    g_log.compactions++;
+    g_log.compacted_bytes += bytes;
+    g_log.archived_bytes += load.archive->file_size;
+    g_log.compact_ms += monotonic_ms() - started;
+    pthread_mutex_unlock(&g_log.lock);
+    free(remap.data);
+    free(firsts.data);
+
+    /* Reads that took a location in the segment before the swap still use
+     * its file and mapping; new ones only find the archive */
+    readers_drain(parity);
+    pthread_mutex_lock(&g_log.lock);
+    int fd = g_log.fds[segment];
+    log_map_t map = g_log.maps[segment];
+    g_log.fds[segment] = -1;
+    g_log.maps[segment].data = NULL;
+    g_log.maps[segment].size = 0;
+    pthread_mutex_unlock(&g_log.lock);
+    close(fd);
+    unmap_file(&map);
+
+    char path[LOG_PATH_MAX + 16];
+    segment_path(segment, path, sizeof(path));
+    unlink(path);
+    return SUCCESS;
+}
+
+error_code_t game_log_compact(void) {
+    pthread_mutex_lock(&g_compactor.pass);
+    pthread_mutex_lock(&g_log.lock);
+    if (!g_log.open) {
+        pthread_mutex_unlock(&g_log.lock);
+        pthread_mutex_unlock(&g_compactor.pass);
+        return ERR_INVALID_PARAM;
+    }
+
+    /* Segments holding records of a game without a GAME record (in progress,
+     * or finished without its history) stay as they are */
+    static bool pinned[GAME_LOG_MAX_SEGMENTS + 1];
+    for (uint32_t s = 1; s <= GAME_LOG_MAX_SEGMENTS; s++) pinned[s] = g_log.pins[s] != 0;
+    uint32_t active = g_log.segment;
+    uint64_t position = g_writer.head;
+    pthread_mutex_unlock(&g_log.lock);
+
+    /* The sealed segments must be written and synced before being read */
+    error_code_t err = writer_wait(position, true);
+    for (uint32_t segment = 1; err == SUCCESS && segment < active; segment++) {
+        if (pinned[segment] || g_log.fds[segment] < 0) continue;
+        err = compact_segment(segment);
+    }
+    pthread_mutex_unlock(&g_compactor.pass);
+    return err;
+}
+
+error_code_t game_log_rotate(void) {
+    pthread_mutex_lock(&g_log.lock);
+    error_code_t err = g_log.open ? segment_create(g_log.segment + 1) : ERR_INVALID_PARAM;
+    pthread_mutex_unlock(&g_log.lock);
+    return err;
+}
+
+static void* compactor_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_compactor.lock);
+    while (!g_compactor.stop) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)g_compactor.interval_ms * 1000000;
+        ts.tv_sec += (time_t)(ns / 1000000000);
+        ts.tv_nsec = (long)(ns % 1000000000);
+        pthread_cond_timedwait(&g_compactor.wake, &g_compactor.lock, &ts);
+        if (g_compactor.stop) break;
+
+        pthread_mutex_unlock(&g_compactor.lock);
+        if (game_log_compact() != SUCCESS) fprintf(stderr, "Warning: Game log compaction failed\n");
+        pthread_mutex_lock(&g_compactor.lock);
+    }
+    pthread_mutex_unlock(&g_compactor.lock);
+    return NULL;
+}
+
+static void compactor_start(void) {
+    if (g_compactor.interval_ms <= 0) return;
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_compactor.wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    g_compactor.stop = false;
+    g_compactor.running = pthread_create(&g_compactor.thread, NULL, compactor_main, NULL) == 0;
+    if (!g_compactor.running) {
+        pthread_cond_destroy(&g_compactor.wake);
+        fprintf(stderr, "Warning: Game log compaction thread not started\n");
+    }
+}
+
+/* Caller must not hold the index lock, which a running pass takes */
+static void compactor_stop(void) {
+    if (!g_compactor.running) return;
+    pthread_mutex_lock(&g_compactor.lock);
+    g_compactor.stop = true;
+    pthread_cond_signal(&g_compactor.wake);
+    pthread_mutex_unlock(&g_compactor.lock);
+    pthread_join(g_compactor.thread, NULL);
+    pthread_cond_destroy(&g_compactor.wake);
+    g_compactor.running = false;
+}
+
+void game_log_set_compaction(int interval_ms) {
+    pthread_mutex_lock(&g_compactor.lock);
+    g_compactor.interval_ms = interval_ms > 0 ? interval_ms : 0;
+    pthread_mutex_unlock(&g_compactor.lock);
+}
+
+/* ========== Open / close ========== */
+
+static void close_locked(void) {
+    writer_stop();
+    for (uint32_t i = 1; i <= GAME_LOG_MAX_SEGMENTS; i++) {
+        if (g_log.fds[i] >= 0) close(g_log.fds[i]);
+        g_log.fds[i] = -1;
+        g_log.zlib_crc[i] = false;
+        g_log.pins[i] = 0;
+        unmap_file(&g_log.maps[i]);
+        archive_free(g_log.archives[i]);
+        g_log.archives[i] = NULL;
+    }
+    g_log.archived = 0;
+    g_log.compactions = g_log.compacted_bytes = g_log.archived_bytes = g_log.compact_ms = 0;
+    for (uint32_t i = 0; i < LOG_MAX_CHUNKS; i++) {
+        free(g_log.chunks[i]);
+        g_log.chunks[i] = NULL;
+    }
+    g_log.open = false;
+    g_log.segment = 0;
+    g_log.size = 0;
+    g_log.sealed_bytes = 0;
+    g_log.count = 0;
+    g_log.live = 0;
+    g_log.appends = 0;
+    g_log.file_reads = 0;
+}
+
+error_code_t game_log_open(const char* dir) {
+    if (!dir || strlen(dir) >= LOG_PATH_MAX) return ERR_INVALID_PARAM;
+
+    compactor_stop();
+    pthread_mutex_lock(&g_log.lock);
+    if (g_log.open) close_locked();
+    for (uint32_t i = 0; i <= GAME_LOG_MAX_SEGMENTS; i++) g_log.fds[i] = -1;
+    snprintf(g_log.dir, sizeof(g_log.dir), "%s", dir);
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        pthread_mutex_unlock(&g_log.lock);
+        return ERR_NETWORK_ERROR;
+    }
+
+    /* Segments are contiguous from 1, each a segment file or an archive;
+     * the last one found is the active one */
+    uint64_t started = monotonic_ms();
+    uint32_t count = 0;
+    error_code_t err = SUCCESS;
+    while (err == SUCCESS && count < GAME_LOG_MAX_SEGMENTS) {
+        char path[LOG_PATH_MAX + 24];
+        archive_path(count + 1, ".tmp", path, sizeof(path));
+        unlink(path);
+        archive_path(count + 1, "", path, sizeof(path));
+        int arc_fd = open(path, O_RDONLY);
+        archive_t* archive = arc_fd >= 0 ? archive_open(count + 1, arc_fd) : NULL;
+
+        char seg_path[LOG_PATH_MAX + 16];
+        segment_path(count + 1, seg_path, sizeof(seg_path));
+        if (archive) {
+            /* Compaction stopped before removing the segment */
+            unlink(seg_path);
+            g_log.archives[++count] = archive;
+            g_log.archived++;
+            continue;
+        }
+        int fd = open(seg_path, O_RDWR);
+        if (fd < 0 && arc_fd >= 0) err = ERR_SERIALIZATION;     /* An archive that lost its segment is unreadable */
+        if (fd < 0) break;
+        if (arc_fd >= 0) unlink(path);
+        g_log.fds[++count] = fd;
+    }
+    if (err == SUCCESS) err = segments_scan(count);
+    g_log.scan_ms = (uint32_t)(monotonic_ms() - started);
+
+    if (err == SUCCESS) {
+        if (g_log.segment == 0) {
+            err = segment_create(1);
+        } else if (g_log.archives[g_log.segment]) {
+            err = segment_create(g_log.segment + 1);
+        } else if (g_log.zlib_crc[g_log.segment] && g_log.size >= LOG_SEGMENT_HEADER) {
+            /* New records go to a segment of the current version */
+            err = ftruncate(g_log.fds[g_log.segment], g_log.size) == 0 ? segment_create(g_log.segment + 1)
+                                                                          : ERR_NETWORK_ERROR;
+        } else if (g_log.size < LOG_SEGMENT_HEADER) {
+            /* The active segment never got its header: start it again */
+            close(g_log.fds[g_log.segment]);
+            g_log.fds[g_log.segment] = -1;
+            uint32_t segment = g_log.segment;
+            g_log.segment = 0;
+            err = segment_create(segment);
+        } else if (ftruncate(g_log.fds[g_log.segment], g_log.size) != 0) {
+            /* Cut off a torn tail so new records follow the last good one */
+            err = ERR_NETWORK_ERROR;
+        }
+    }
+
+    if (err != SUCCESS) {
+        close_locked();
+        pthread_mutex_unlock(&g_log.lock);
+        return err;
+    }
+    err = writer_start();
+    if (err != SUCCESS) {
+        close_locked();
+        pthread_mutex_unlock(&g_log.lock);
+        return err;
+    }
+    g_log.open = true;
+    g_log.appends = 0;
+    pthread_mutex_unlock(&g_log.lock);
+    compactor_start();
+    return SUCCESS;
+}
+
+void game_log_close(void) {
+    compactor_stop();
+    pthread_mutex_lock(&g_log.lock);
+    if (g_log.open) close_locked();
+    pthread_mutex_unlock(&g_log.lock);
+}
+
+void game_log_set_scan_threads(int threads) {
+    pthread_mutex_lock(&g_log.lock);
+    g_log.scan_threads = threads > 0 ? threads : 0;
+    pthread_mutex_unlock(&g_log.lock);
+}
+
+void game_log_set_sync(game_log_sync_t policy, int interval_ms) {
+    pthread_mutex_lock(&g_writer.lock);
+    g_writer.policy = policy;
+    if (policy == GAME_LOG_SYNC_INTERVAL) {
+        g_writer.interval_ms = interval_ms > 0 ? interval_ms : GAME_LOG_SYNC_INTERVAL_DEFAULT_MS;
+    }
+    if (g_writer.running) pthread_cond_signal(&g_writer.wake);
+    pthread_mutex_unlock(&g_writer.lock);
+}
+
+error_code_t game_log_parse_sync(const char* text, game_log_sync_t* policy, int* interval_ms) {
+    if (!text || !policy || !interval_ms) return ERR_INVALID_PARAM;
+    if (strcmp(text, "every") == 0) {
+        *policy = GAME_LOG_SYNC_EVERY;
+    } else if (strcmp(text, "none") == 0) {
+        *policy = GAME_LOG_SYNC_NONE;
+    } else {
+        char* end;
+        long ms = strtol(text, &end, 10);
+        if (end == text || *end != '\0' || ms <= 0 || ms > 60000) return ERR_INVALID_PARAM;
+        *policy = GAME_LOG_SYNC_INTERVAL;
+        *interval_ms = (int)ms;
+    }
+    return SUCCESS;
+}
+
+const char* game_log_sync_name(game_log_sync_t policy) {
+    switch (policy) {
+        case GAME_LOG_SYNC_EVERY: return "every append";
+        case GAME_LOG_SYNC_INTERVAL: return "interval";
+        case GAME_LOG_SYNC_NONE: return "none";
+    }
+    return "unknown";
+}
+
+error_code_t game_log_flush(void) {
+    pthread_mutex_lock(&g_log.lock);
+    if (!g_log.open) {
+        pthread_mutex_unlock(&g_log.lock);
+        return ERR_INVALID_PARAM;
+    }
+    uint64_t position = g_writer.head;
+    pthread_mutex_unlock(&g_log.lock);
+    return writer_wait(position, true);
+}
+
+/* After an append: with GAME_LOG_SYNC_EVERY, wait for its commit */
+static error_code_t append_commit(uint64_t position) {
+    pthread_mutex_lock(&g_writer.lock);
+    bool every = g_writer.policy == GAME_LOG_SYNC_EVERY;
+    pthread_mutex_unlock(&g_writer.lock);
+    return every ? writer_wait(position, true) : SUCCESS;
+}
+
+/* ========== Appends ========== */
+
+static uint8_t* put_string(uint8_t* p, const char* s, size_t max) {
+    size_t len = strnlen(s ? s : "", max - 1);
+    *p++ = (uint8_t)len;
+    memcpy(p, s, len);
+    return p + len;
+}
+
+/* First record of a new game, which gets the next ID */
+static error_code_t append_new_game(uint8_t type, const uint8_t* body, uint16_t length, game_log_id_t* id_out) {
+    pthread_mutex_lock(&g_log.lock);
+    game_log_id_t id = g_log.count + 1;
+    uint64_t location, position = 0;
+    error_code_t err = append_record(type, id, 0, body, length, &location, &position);
+    if (err == SUCCESS) {
+        log_record_t record = { .type = type, .length = length, .game = id, .body = body };
+        index_apply(&record, location);
+        if (!entry_live(entry_at(id))) err = ERR_MAX_CAPACITY;
+    }
+    pthread_mutex_unlock(&g_log.lock);
+    if (err == SUCCESS) err = append_commit(position);
+
+    *id_out = (err == SUCCESS) ? id : GAME_LOG_ID_NONE;
+    return err;
+}
+
+error_code_t game_log_start(pseudo_id_t player_a, pseudo_id_t player_b, const char* label,
+                            time_t created_at, game_log_id_t* id_out) {
+    if (player_a == PSEUDO_ID_NONE || player_b == PSEUDO_ID_NONE || !id_out) return ERR_INVALID_PARAM;
+
+    uint8_t body[LOG_MAX_BODY];
+    put_u64(body, (uint64_t)(int64_t)created_at);
+    uint8_t* p = put_string(body + 8, pseudo_name(player_a), MAX_PSEUDO_LEN);
+    p = put_string(p, pseudo_name(player_b), MAX_PSEUDO_LEN);
+    p = put_string(p, label ? label : "", MAX_GAME_ID_LEN);
+    return append_new_game(LOG_RECORD_START, body, (uint16_t)(p - body), id_out);
+}
+
+/* Append a record to a live game and update its index entry */
+static error_code_t append_to_game(game_log_id_t id, uint8_t type, const uint8_t* body, uint16_t length) {
+    pthread_mutex_lock(&g_log.lock);
+    log_entry_t* entry = entry_at(id);
+    if (!entry_live(entry)) {
+        pthread_mutex_unlock(&g_log.lock);
+        return ERR_GAME_NOT_FOUND;
+    }
+
+    uint64_t location, position = 0;
+    error_code_t err = append_record(type, id, entry->last, body, length, &location, &position);
+    if (err == SUCCESS) {
+        log_record_t record = { .type = type, .length = length, .game = id, .prev = entry->last, .body = body };
+        index_apply(&record, location);
+    }
+    pthread_mutex_unlock(&g_log.lock);
+    return err == SUCCESS ? append_commit(position) : err;
+}
+
+error_code_t game_log_append_move(game_log_id_t id, int pit_index, const board_t* after) {
+    if (!after || pit_index < 0 || pit_index >= NUM_PITS) return ERR_INVALID_PARAM;
+
+    int64_t elapsed = (int64_t)(after->last_move_at - after->created_at);
+    if (elapsed < 0) elapsed = 0;
+    if (elapsed > (int64_t)UINT32_MAX) elapsed = UINT32_MAX;
+
+    uint8_t body[MOVE_BODY_SIZE];
+    body[0] = (uint8_t)pit_index;
+    body[1] = (uint8_t)after->state;
+    body[2] = (uint8_t)(int8_t)after->winner;
+    put_u32(body + 3, (uint32_t)elapsed);
+    return append_to_game(id, LOG_RECORD_MOVE, body, sizeof(body));
+}
+
+error_code_t game_log_append_snapshot(game_log_id_t id, const board_t* board) {
+    if (!board) return ERR_INVALID_PARAM;
+
+    uint8_t body[SNAPSHOT_BODY_SIZE];
+    for (int i = 0; i < NUM_PITS; i++) body[i] = (uint8_t)board->pits[i];
+    body[NUM_PITS] = (uint8_t)board->scores[0];
+    body[NUM_PITS + 1] = (uint8_t)board->scores[1];
+    body[NUM_PITS + 2] = (uint8_t)board->current_player;
+    body[NUM_PITS + 3] = (uint8_t)board->state;
+    body[NUM_PITS + 4] = (uint8_t)(int8_t)board->winner;
+    put_u64(body + NUM_PITS + 5, (uint64_t)(int64_t)board->created_at);
+    put_u64(body + NUM_PITS + 13, (uint64_t)(int64_t)board->last_move_at);
+    return append_to_game(id, LOG_RECORD_SNAPSHOT, body, sizeof(body));
+}
+
+error_code_t game_log_delete(game_log_id_t id) {
+    return append_to_game(id, LOG_RECORD_DELETE, NULL, 0);
+}
+
+static uint8_t* put_board(uint8_t* p, const board_t* board) {
+    for (int i = 0; i < NUM_PITS; i++) p[i] = (uint8_t)board->pits[i];
+    p[NUM_PITS] = (uint8_t)board->scores[0];
+    p[NUM_PITS + 1] = (uint8_t)board->scores[1];
+    p[NUM_PITS + 2] = (uint8_t)board->current_player;
+    return p + GAME_BOARD_SIZE;
+}
+
+/* GAME body; without `moves` only the final board is kept */
+static error_code_t encode_compact(const char* name_a, const char* name_b, const char* label, int64_t created_at,
+                                   const uint8_t* moves, uint32_t count, const board_t* final,
+                                   uint8_t body[LOG_MAX_BODY], uint16_t* length) {
+    if (count > GAME_LOG_MAX_HISTORY) return ERR_MAX_CAPACITY;
+
+    char plain[MAX_GAME_ID_LEN];
+    default_label(name_a, name_b, plain);
+    bool own_label = label && strcmp(label, plain) != 0;
+
+    int64_t duration = (int64_t)final->last_move_at - created_at;
+    if (duration < 0) duration = 0;
+    if (duration > (int64_t)UINT32_MAX) duration = UINT32_MAX;
+
+    uint8_t* p = body;
+    p[0] = GAME_VERSION;
+    p[1] = (uint8_t)((own_label ? GAME_FLAG_LABEL : 0) | (moves ? 0 : GAME_FLAG_NO_HISTORY));
+    p[2] = (uint8_t)final->state;
+    p[3] = (uint8_t)(int8_t)final->winner;
+    put_u32(p + 4, (uint32_t)created_at);
+    put_u32(p + 8, (uint32_t)duration);
+    put_u16(p + 12, (uint16_t)count);
+    p = put_string(p + GAME_FIXED_SIZE, name_a, MAX_PSEUDO_LEN);
+    p = put_string(p, name_b, MAX_PSEUDO_LEN);
+    if (own_label) p = put_string(p, label, MAX_GAME_ID_LEN);
+
+    if (moves) {
+        memset(p, 0, (count + 1) / 2);
+        for (uint32_t i = 0; i < count; i++) {
+            if (moves[i] >= NUM_PITS) return ERR_INVALID_PARAM;
+            p[i / 2] |= (uint8_t)((i % 2) ? moves[i] << 4 : moves[i]);
+        }
+        p += (count + 1) / 2;
+
+        /* Periodic boards, by replaying the moves */
+        board_t board;
+        board_init(&board);
+        for (uint32_t i = 0; i < count; i++) {
+            if (i > 0 && i % GAME_LOG_SNAPSHOT_INTERVAL == 0) p = put_board(p, &board);
+            int captured;
+            if (board_execute_move(&board, board.current_player, moves[i], &captured) != SUCCESS) {
+                return ERR_INVALID_PARAM;
+            }
+        }
+    }
+    p = put_board(p, final);
+    *length = (uint16_t)(p - body);
+    return SUCCESS;
+}
+
+error_code_t game_log_finish(game_log_id_t id, const char* label, const uint8_t* moves, uint32_t count,
+                             const board_t* final) {
+    if ((!moves && count > 0) || !final) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&g_log.lock);
+    log_entry_t* entry = entry_at(id);
+    if (!entry_live(entry)) {
+        pthread_mutex_unlock(&g_log.lock);
+        return ERR_GAME_NOT_FOUND;
+    }
+    pseudo_id_t player_a = entry->player_a, player_b = entry->player_b;
+    int64_t created_at = entry->created_at;
+    pthread_mutex_unlock(&g_log.lock);
+
+    uint8_t body[LOG_MAX_BODY];
+    uint16_t length;
+    static const uint8_t no_moves[1];
+    error_code_t err = encode_compact(pseudo_name(player_a), pseudo_name(player_b), label, created_at,
+                                      moves ? moves : no_moves, count, final, body, &length);
+    if (err != SUCCESS) return err;
+    return append_to_game(id, LOG_RECORD_GAME, body, length);
+}
+
+error_code_t game_log_import(const game_log_game_t* game, game_log_id_t* id_out) {
+    if (!game || !id_out) return ERR_INVALID_PARAM;
+    if (game->player_a == PSEUDO_ID_NONE || game->player_b == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
+
+    uint8_t body[LOG_MAX_BODY];
+    uint16_t length;
+    error_code_t err = encode_compact(pseudo_name(game->player_a), pseudo_name(game->player_b), game->label,
+                                      (int64_t)game->board.created_at, NULL, game->moves, &game->board,
+                                      body, &length);
+    if (err != SUCCESS) return err;
+    return append_new_game(LOG_RECORD_GAME, body, length, id_out);
+}
+
+/* ========== Reads ========== */
+
+/* Label and player names from a START body */
+static void decode_start(const log_record_t* record, game_log_game_t* game) {
+    const uint8_t* p = record->body + 8;
+    const uint8_t* end = record->body + record->length;
+    char fields[3][MAX_GAME_ID_LEN];
+    for (int i = 0; i < 3; i++) {
+        size_t len = (p < end) ? *p++ : 0;
+        if (p + len > end) len = (size_t)(end - p);
+        memcpy(fields[i], p, len);
+        fields[i][len] = '\0';
+        p += len;
+    }
+    game->player_a = pseudo_intern(fields[0]);
+    game->player_b = pseudo_intern(fields[1]);
+    snprintf(game->label, sizeof(game->label), "%s", fields[2]);
+}
+
+static void decode_snapshot(const log_record_t* record, board_t* board) {
+    const uint8_t* body = record->body;
+    for (int i = 0; i < NUM_PITS; i++) board->pits[i] = body[i];
+    board->scores[0] = body[NUM_PITS];
+    board->scores[1] = body[NUM_PITS + 1];
+    board->current_player = (player_id_t)body[NUM_PITS + 2];
+    board->state = (game_state_t)body[NUM_PITS + 3];
+    board->winner = (winner_t)(int8_t)body[NUM_PITS + 4];
+    board->created_at = (time_t)(int64_t)get_u64(body + NUM_PITS + 5);
+    board->last_move_at = (time_t)(int64_t)get_u64(body + NUM_PITS + 13);
+}
+
+typedef struct {
+    uint8_t pit;
+    uint8_t state;              /* As logged after the move */
+    uint32_t elapsed;
+} replay_move_t;
+
+/* Copy of a live entry, once the records it points at are written. On
+ * success the caller is a reader until reader_leave(*reader). */
+static error_code_t entry_snapshot(game_log_id_t id, log_entry_t* entry, uint32_t* reader) {
+    pthread_mutex_lock(&g_log.lock);
+    log_entry_t* found = entry_at(id);
+    if (!g_log.open || !entry_live(found)) {
+        pthread_mutex_unlock(&g_log.lock);
+        return ERR_GAME_NOT_FOUND;
+    }
+    *entry = *found;
+    uint64_t position = g_writer.head;
+    *reader = reader_enter();
+    pthread_mutex_unlock(&g_log.lock);
+
+    /* The game's records may still be queued */
+    error_code_t err = writer_wait(position, false);
+    if (err != SUCCESS) reader_leave(*reader);
+    return err;
+}
+
+/* A game from its GAME record, with the board after `move` moves */
+static error_code_t load_compact(const log_record_t* record, uint32_t move, game_log_game_t* game) {
+    compact_game_t compact;
+    if (!parse_compact(record, &compact)) return ERR_SERIALIZATION;
+    if (move > compact.moves || (!compact.history && move != compact.moves)) return ERR_INVALID_PARAM;
+
+    memset(game, 0, sizeof(*game));
+    game->id = record->game;
+    game->moves = move;
+    game->player_a = pseudo_intern(compact.names[0]);
+    game->player_b = pseudo_intern(compact.names[1]);
+    snprintf(game->label, sizeof(game->label), "%s", compact.label);
+
+    board_t* board = &game->board;
+    if (move == compact.moves) {
+        compact_board(&compact, compact.periodic, board);
+        board->state = (game_state_t)compact.state;
+        board->winner = (winner_t)compact.winner;
+        board->last_move_at = (time_t)((int64_t)compact.created_at + compact.duration);
+        return SUCCESS;
+    }
+
+    /* The nearest board at or before `move`, then the moves after it */
+    uint32_t from = move - move % GAME_LOG_SNAPSHOT_INTERVAL;
+    if (from == 0) {
+        board_init(board);
+        board->created_at = board->last_move_at = (time_t)compact.created_at;
+    } else {
+        compact_board(&compact, from / GAME_LOG_SNAPSHOT_INTERVAL - 1, board);
+    }
+    for (uint32_t i = from; i < move; i++) {
+        int captured;
+        if (board_execute_move(board, board->current_player, compact_move(&compact, i), &captured) != SUCCESS) {
+            return ERR_SERIALIZATION;
+        }
+    }
+    return SUCCESS;
+}
+
+/* Every move of a game still kept as START/MOVE records, oldest first, in
+ * a buffer the caller frees. `record` is left holding the START record. */
+static error_code_t chain_history(const log_entry_t* entry, game_log_id_t id, uint8_t** moves, uint32_t* count,
+                                  log_record_t* record) {
+    *moves = NULL;
+    *count = 0;
+    uint32_t capacity = 0;
+    for (uint64_t location = entry->last;;) {
+        error_code_t err = read_record(location, id, record);
+        if (err == SUCCESS && record->type == LOG_RECORD_START) break;
+        if (err == SUCCESS && (record->prev == 0 || (record->type != LOG_RECORD_MOVE &&
+                                                     record->type != LOG_RECORD_SNAPSHOT))) {
+            err = ERR_SERIALIZATION;
+        }
+        if (err == SUCCESS && record->type == LOG_RECORD_MOVE && *count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            uint8_t* grown = realloc(*moves, capacity);
+            if (!grown) err = ERR_MAX_CAPACITY;
+            else *moves = grown;
+        }
+        if (err != SUCCESS) {
+            free(*moves);
+            *moves = NULL;
+            return err;
+        }
+        if (record->type == LOG_RECORD_MOVE) (*moves)[(*count)++] = record->body[0];
+        location = record->prev;
+    }
+
+    for (uint32_t i = 0; i < *count / 2; i++) {
+        uint8_t pit = (*moves)[i];
+        (*moves)[i] = (*moves)[*count - 1 - i];
+        (*moves)[*count - 1 - i] = pit;
+    }
+    return SUCCESS;
+}
+
+/* The latest state of the game behind `entry` */
+static error_code_t load_entry(const log_entry_t* entry, game_log_id_t id, game_log_game_t* game) {
+    error_code_t err = SUCCESS;
+
+    /* Walk back to the last snapshot (or the start), keeping the moves after
+     * it; they only go to the heap past LOG_REPLAY_INLINE */
+    replay_move_t inline_moves[LOG_REPLAY_INLINE];
+    replay_move_t* moves = inline_moves;
+    size_t depth = 0, capacity = LOG_REPLAY_INLINE;
+    log_record_t record;
+    uint64_t location = entry->last;
+    for (;;) {
+        err = read_record(location, id, &record);
+        if (err != SUCCESS) break;
+        if (record.type == LOG_RECORD_GAME && depth == 0) {
+            return load_compact(&record, get_u16(record.body + 12), game);
+        }
+        if (record.type != LOG_RECORD_MOVE) break;
+        if (record.length < MOVE_BODY_SIZE || record.prev == 0) {
+            err = ERR_SERIALIZATION;
+            break;
+        }
+
+        if (depth == capacity) {
+            capacity *= 2;
+            replay_move_t* grown = moves == inline_moves ? malloc(capacity * sizeof(*moves))
+                                                         : realloc(moves, capacity * sizeof(*moves));
+            if (!grown) {
+                err = ERR_MAX_CAPACITY;
+                break;
+            }
+            if (moves == inline_moves) memcpy(grown, inline_moves, sizeof(inline_moves));
+            moves = grown;
+        }
+        moves[depth].pit = record.body[0];
+        moves[depth].state = record.body[1];
+        moves[depth].elapsed = get_u32(record.body + 3);
+        depth++;
+        location = record.prev;
+    }
+
+    memset(game, 0, sizeof(*game));
+    game->id = id;
+    game->moves = entry->moves;
+    if (err == SUCCESS) {
+        if (record.type == LOG_RECORD_SNAPSHOT && record.length >= SNAPSHOT_BODY_SIZE) {
+            decode_snapshot(&record, &game->board);
+            err = read_record(entry->first, id, &record);
+        } else if (record.type == LOG_RECORD_START) {
+            board_init(&game->board);
+            game->board.created_at = (time_t)entry->created_at;
+            game->board.last_move_at = (time_t)entry->created_at;
+        } else {
+            err = ERR_SERIALIZATION;
+        }
+    }
+    if (err == SUCCESS && record.type != LOG_RECORD_START) err = ERR_SERIALIZATION;
+    if (err == SUCCESS) decode_start(&record, game);
+
+    /* Replay oldest first; a move the rules refuse, or that does not end in
+     * the state logged with it, means the log is wrong */
+    for (size_t i = depth; err == SUCCESS && i > 0; i--) {
+        int captured;
+        board_t* board = &game->board;
+        if (board_execute_move(board, board->current_player, moves[i - 1].pit, &captured) != SUCCESS ||
+            board->state != (game_state_t)moves[i - 1].state) {
+            err = ERR_SERIALIZATION;
+            break;
+        }
+        board->last_move_at = (time_t)(entry->created_at + moves[i - 1].elapsed);
+    }
+
+    if (moves != inline_moves) free(moves);
+    return err;
+}
+
+error_code_t game_log_load(game_log_id_t id, game_log_game_t* game) {
+    if (!game) return ERR_INVALID_PARAM;
+
+    log_entry_t entry;
+    uint32_t reader;
+    error_code_t err = entry_snapshot(id, &entry, &reader);
+    if (err != SUCCESS) return err;
+    err = load_entry(&entry, id, game);
+    reader_leave(reader);
+    return err;
+}
+
+/* The game behind `entry` after `move` moves */
+static error_code_t load_entry_at(const log_entry_t* entry, game_log_id_t id, uint32_t move, game_log_game_t* game) {
+    log_record_t record;
+    error_code_t err = read_record(entry->last, id, &record);
+    if (err != SUCCESS) return err;
+    if (record.type == LOG_RECORD_GAME) return load_compact(&record, move, game);
+
+    uint8_t* moves;
+    uint32_t count;
+    err = chain_history(entry, id, &moves, &count, &record);
+    if (err != SUCCESS) return err;
+    if (move > count) {
+        free(moves);
+        return ERR_INVALID_PARAM;
+    }
+
+    memset(game, 0, sizeof(*game));
+    game->id = id;
+    game->moves = move;
+    decode_start(&record, game);
+    board_init(&game->board);
+    game->board.created_at = game->board.last_move_at = (time_t)entry->created_at;
+    for (uint32_t i = 0; i < move; i++) {
+        int captured;
+        if (board_execute_move(&game->board, game->board.current_player, moves[i], &captured) != SUCCESS) {
+            err = ERR_SERIALIZATION;
+            break;
+        }
+    }
+    free(moves);
+    return err;
+}
+
+error_code_t game_log_load_at(game_log_id_t id, uint32_t move, game_log_game_t* game) {
+    if (!game) return ERR_INVALID_PARAM;
+
+    log_entry_t entry;
+    uint32_t reader;
+    error_code_t err = entry_snapshot(id, &entry, &reader);
+    if (err != SUCCESS) return err;
+    err = load_entry_at(&entry, id, move, game);
+    reader_leave(reader);
+    return err;
+}
+
+/* Every move of the game behind `entry`, oldest first */
+static error_code_t entry_history(const log_entry_t* entry, game_log_id_t id, uint8_t* moves, uint32_t max,
+                                  uint32_t* count) {
+    log_record_t record;
+    error_code_t err = read_record(entry->last, id, &record);
+    if (err != SUCCESS) return err;
+
+    if (record.type == LOG_RECORD_GAME) {
+        compact_game_t compact;
+        if (!parse_compact(&record, &compact)) return ERR_SERIALIZATION;
+        if (!compact.history) return SUCCESS;
+        if (compact.moves > max) return ERR_MAX_CAPACITY;
+        for (uint32_t i = 0; i < compact.moves; i++) moves[i] = compact_move(&compact, i);
+        *count = compact.moves;
+        return SUCCESS;
+    }
+
+    uint8_t* chain;
+    uint32_t chain_count;
+    err = chain_history(entry, id, &chain, &chain_count, &record);
+    if (err != SUCCESS) return err;
+    if (chain_count > max) {
+        err = ERR_MAX_CAPACITY;
+    } else {
+        if (chain_count) memcpy(moves, chain, chain_count);
+        *count = chain_count;
+    }
+    free(chain);
+    return err;
+}
+
+error_code_t game_log_history(game_log_id_t id, uint8_t* moves, uint32_t max, uint32_t* count) {
+    if (!moves || !count) return ERR_INVALID_PARAM;
+    *count = 0;
+
+    log_entry_t entry;
+    uint32_t reader;
+    error_code_t err = entry_snapshot(id, &entry, &reader);
+    if (err != SUCCESS) return err;
+    err = entry_history(&entry, id, moves, max, count);
+    reader_leave(reader);
+    return err;
+}
+
+error_code_t game_log_scan(game_log_id_t from, pseudo_id_t player, game_log_info_t* out, int max,
+                           int* count, game_log_id_t* next) {
+    if (!out || max < 1 || !count || !next) return ERR_INVALID_PARAM;
+    *count = 0;
+    *next = GAME_LOG_ID_NONE;
+
+    uint64_t* firsts = malloc((size_t)max * sizeof(uint64_t));
+    if (!firsts) return ERR_MAX_CAPACITY;
+
+    pthread_mutex_lock(&g_log.lock);
+    for (game_log_id_t id = from ? from : 1; g_log.open && id <= g_log.count; id++) {
+        log_entry_t* entry = entry_at(id);
+        if (!entry_live(entry)) continue;
+        if (player != PSEUDO_ID_NONE && entry->player_a != player && entry->player_b != player) continue;
+        if (*count == max) {
+            *next = id;
+            break;
+        }
+
+        game_log_info_t* info = &out[*count];
+        info->id = id;
+        info->label[0] = '\0';
+        info->player_a = entry->player_a;
+        info->player_b = entry->player_b;
+        info->created_at = (time_t)entry->created_at;
+        info->state = (game_state_t)entry->state;
+        info->winner = (winner_t)entry->winner;
+        info->moves = entry->moves;
+        firsts[*count] = entry->first;
+        (*count)++;
+    }
+    uint64_t position = g_writer.head;
+    uint32_t reader = reader_enter();
+    pthread_mutex_unlock(&g_log.lock);
+    writer_wait(position, false);
+
+    /* Labels are only on disk, in the game's first record */
+    for (int i = 0; i < *count; i++) {
+        log_record_t record;
+        if (read_record(firsts[i], out[i].id, &record) != SUCCESS) continue;
+        if (record.type == LOG_RECORD_START) {
+            game_log_game_t game;
+            decode_start(&record, &game);
+            snprintf(out[i].label, sizeof(out[i].label), "%s", game.label);
+        } else if (record.type == LOG_RECORD_GAME) {
+            compact_game_t compact;
+            if (parse_compact(&record, &compact)) {
+                snprintf(out[i].label, sizeof(out[i].label), "%s", compact.label);
+            }
+        }
+    }
+    reader_leave(reader);
+    free(firsts);
+    return SUCCESS;
+}
+
+error_code_t game_log_list_active(game_log_id_t* ids, int max, int* count, uint64_t* total) {
+    if (!ids || max < 0 || !count || !total) return ERR_INVALID_PARAM;
+    *count = 0;
+    *total = 0;
+
+    /* Newest first, then reversed */
+    pthread_mutex_lock(&g_log.lock);
+    for (game_log_id_t id = g_log.open ? g_log.count : 0; id >= 1; id--) {
+        log_entry_t* entry = entry_at(id);
+        if (!entry_live(entry) || entry->state != GAME_STATE_IN_PROGRESS) continue;
+        if (*count < max) ids[(*count)++] = id;
+        (*total)++;
+    }
+    pthread_mutex_unlock(&g_log.lock);
+
+    for (int i = 0; i < *count / 2; i++) {
+        game_log_id_t id = ids[i];
+        ids[i] = ids[*count - 1 - i];
+        ids[*count - 1 - i] = id;
+    }
+    return SUCCESS;
+}
+
+void game_log_get_stats(game_log_stats_t* stats) {
+    if (!stats) return;
+    pthread_mutex_lock(&g_log.lock);
+    stats->games = g_log.live;
+    stats->segments = g_log.segment;
+    stats->bytes = g_log.sealed_bytes + g_log.size;
+    stats->appends = g_log.appends;
+    stats->scan_ms = g_log.scan_ms;
+    stats->archives = g_log.archived;
+    stats->compactions = g_log.compactions;
+    stats->compacted_bytes = g_log.compacted_bytes;
+    stats->archived_bytes = g_log.archived_bytes;
+    stats->compact_ms = g_log.compact_ms;
+    stats->queued = g_writer.head - __atomic_load_n(&g_writer.tail, __ATOMIC_ACQUIRE);
+    pthread_mutex_unlock(&g_log.lock);
+    stats->writes = __atomic_load_n(&g_writer.writes, __ATOMIC_RELAXED);
+    stats->file_reads = __atomic_load_n(&g_log.file_reads, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&g_writer.lock);
+    stats->commits = g_writer.commits;
+    pthread_mutex_unlock(&g_writer.lock);
+}
@@ -1,7 +1,9 @@
 #include "../../include/server/game_manager.h"
 #include "../../include/server/storage.h"
+#include "../../include/network/board_delta.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 error_code_t game_manager_init(game_manager_t* manager) {
     if (!manager) return ERR_INVALID_PARAM;
@@ -11,12 +13,13 @@ error_code_t game_manager_init(game_manager_t* manager) {
     
     for (int i = 0; i < MAX_GAMES; i++) {
         manager->games[i].active = false;
+        manager->games[i].handle = GAME_HANDLE_NONE;
+        manager->games[i].generation = 0;
+        manager->games[i].moves = NULL;
+        manager->games[i].moves_capacity = 0;
         pthread_mutex_init(&manager->games[i].lock, NULL);
     }
     
-    // Load persisted games
-    storage_load_all_games(manager);
-    
     return SUCCESS;
 }
 
@@ -27,22 +30,33 @@ error_code_t game_manager_destroy(game_manager_t* manager) {
     
     for (int i = 0; i < MAX_GAMES; i++) {
         pthread_mutex_destroy(&manager->games[i].lock);
+        free(manager->games[i].moves);
+        manager->games[i].moves = NULL;
     }
     
     return SUCCESS;
 }
 
-error_code_t game_manager_create_game(game_manager_t* manager, const char* player_a, 
-                                     const char* player_b, char* game_id_out) {
-    if (!manager || !player_a || !player_b) return ERR_INVALID_PARAM;
-    
-    pthread_mutex_lock(&manager->lock);
-    
-    if (manager->game_count >= MAX_GAMES) {
-        pthread_mutex_unlock(&manager->lock);
-        return ERR_MAX_CAPACITY;
+/* Add a move to the game's history; once one is lost the rest are not kept */
+static void keep_move(game_instance_t* game, int pit_index) {
+    if (game->moves_kept + 1 != game->move_seq) return;
+    if (game->moves_kept == game->moves_capacity) {
+        if (game->moves_capacity >= GAME_LOG_MAX_HISTORY) return;
+        uint32_t capacity = game->moves_capacity ? game->moves_capacity * 2 : 128;
+        uint8_t* grown = realloc(game->moves, capacity);
+        if (!grown) return;
+        game->moves = grown;
+        game->moves_capacity = capacity;
     }
-    
+    game->moves[game->moves_kept++] = (uint8_t)pit_index;
+}
+
+/* A free slot with a fresh handle, returned with its lock held so nobody
+ * sees the handle before the game is filled in; caller holds the manager
+ * lock */
+static game_instance_t* claim_slot(game_manager_t* manager) {
+    if (manager->game_count >= MAX_GAMES) return NULL;
+
     // Find free slot
     int slot = -1;
     for (int i = 0; i < MAX_GAMES; i++) {
@@ -51,44 +65,106 @@ error_code_t game_manager_create_game(game_manager_t* manager, const char* playe
             break;
         }
     }
+    if (slot == -1) return NULL;
+
+    game_instance_t* game = &manager->games[slot];
+    pthread_mutex_lock(&game->lock);
+
+    // Generation 0 is never used, so no handle is GAME_HANDLE_NONE
+    game->generation++;
+    if (game->generation == 0) game->generation = 1;
+    game->handle = GAME_HANDLE_MAKE(slot, game->generation);
+    game->spectator_count = 0;
+    return game;
+}
+
+error_code_t game_manager_create_game(game_manager_t* manager, pseudo_id_t player_a,
+                                     pseudo_id_t player_b, game_handle_t* handle_out, char* label_out) {
+    if (!manager || player_a == PSEUDO_ID_NONE || player_b == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
+    
+    pthread_mutex_lock(&manager->lock);
     
-    if (slot == -1) {
+    game_instance_t* game = claim_slot(manager);
+    if (!game) {
         pthread_mutex_unlock(&manager->lock);
         return ERR_MAX_CAPACITY;
     }
-    
-    game_instance_t* game = &manager->games[slot];
-    
-    // Generate game ID
-    game_manager_generate_id(player_a, player_b, game->game_id);
+    game_manager_generate_label(pseudo_name(player_a), pseudo_name(player_b), game->game_id);
     
     // Set players
-    strncpy(game->player_a, player_a, MAX_PSEUDO_LEN - 1);
-    strncpy(game->player_b, player_b, MAX_PSEUDO_LEN - 1);
+    game->player_a = player_a;
+    game->player_b = player_b;
     
     // Initialize board
     board_init(&game->board);
-    
-    // Initialize spectators
-    game->spectator_count = 0;
+    game->move_seq = 0;
+    game->moves_kept = 0;
+
+    // Log the game's start; its moves are appended as they are played
+    game->log_id = GAME_LOG_ID_NONE;
+    storage_start_game(game);
     
     game->active = true;
     manager->game_count++;
+    pthread_mutex_unlock(&game->lock);
     
-    if (game_id_out) {
-        strncpy(game_id_out, game->game_id, MAX_GAME_ID_LEN - 1);
+    if (handle_out) {
+        *handle_out = game->handle;
+    }
+    if (label_out) {
+        snprintf(label_out, MAX_GAME_ID_LEN, "%s", game->game_id);
     }
     
     pthread_mutex_unlock(&manager->lock);
     return SUCCESS;
 }
 
-error_code_t game_manager_remove_game(game_manager_t* manager, const char* game_id) {
-    if (!manager || !game_id) return ERR_INVALID_PARAM;
+error_code_t game_manager_restore_game(game_manager_t* manager, const game_log_game_t* saved,
+                                       const uint8_t* moves, uint32_t moves_kept, game_handle_t* handle_out) {
+    if (!manager || !saved || saved->player_a == PSEUDO_ID_NONE || saved->player_b == PSEUDO_ID_NONE) {
+        return ERR_INVALID_PARAM;
+    }
 
     pthread_mutex_lock(&manager->lock);
 
-    game_instance_t* game = game_manager_find_game(manager, game_id);
+    game_instance_t* game = claim_slot(manager);
+    if (!game) {
+        pthread_mutex_unlock(&manager->lock);
+        return ERR_MAX_CAPACITY;
+    }
+    snprintf(game->game_id, MAX_GAME_ID_LEN, "%s", saved->label);
+    game->log_id = saved->id;
+    game->player_a = saved->player_a;
+    game->player_b = saved->player_b;
+    game->board = saved->board;
+
+    // Keep its history as if the moves were played; without all of it the
+    // game gets no GAME record when it ends
+    game->move_seq = 0;
+    game->moves_kept = 0;
+    for (uint32_t i = 0; moves && moves_kept == saved->moves && i < moves_kept; i++) {
+        game->move_seq++;
+        keep_move(game, moves[i]);
+    }
+    game->move_seq = saved->moves;
+
+    game->active = true;
+    manager->game_count++;
+    pthread_mutex_unlock(&game->lock);
+    if (handle_out) {
+        *handle_out = game->handle;
+    }
+
+    pthread_mutex_unlock(&manager->lock);
+    return SUCCESS;
+}
+
+error_code_t game_manager_remove_game(game_manager_t* manager, game_handle_t handle) {
+    if (!manager) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&manager->lock);
+
+    game_instance_t* game = game_manager_find_game(manager, handle);
     if (!game) {
         pthread_mutex_unlock(&manager->lock);
         return ERR_GAME_NOT_FOUND;
@@ -97,41 +173,56 @@ error_code_t game_manager_remove_game(game_manager_t* manager, const char* game_
     // Keep saved game file for review when game ends
     // storage_delete_game(game->game_id);  // Commented out to preserve completed games
 
-    // Mark game as inactive
+    // Mark game as inactive; its handle now finds nothing
+    pthread_mutex_lock(&game->lock);
     game->active = false;
+    game->handle = GAME_HANDLE_NONE;
+    pthread_mutex_unlock(&game->lock);
     manager->game_count--;
 
     pthread_mutex_unlock(&manager->lock);
     return SUCCESS;
 }
 
-void game_manager_generate_id(const char* player_a, const char* player_b, char* game_id) {
-    snprintf(game_id, MAX_GAME_ID_LEN, "%s-vs-%s", player_a, player_b);
+void game_manager_generate_label(const char* player_a, const char* player_b, char* label) {
+    snprintf(label, MAX_GAME_ID_LEN, "%s-vs-%s", player_a, player_b);
 }
 
-game_instance_t* game_manager_find_game(game_manager_t* manager, const char* game_id) {
-    if (!manager || !game_id) return NULL;
+game_instance_t* game_manager_find_game(game_manager_t* manager, game_handle_t handle) {
+    if (!manager || handle == GAME_HANDLE_NONE) return NULL;
     
-    for (int i = 0; i < MAX_GAMES; i++) {
-        if (manager->games[i].active && strcmp(manager->games[i].game_id, game_id) == 0) {
-            return &manager->games[i];
-        }
-    }
+    uint32_t slot = GAME_HANDLE_SLOT(handle);
+    if (slot >= MAX_GAMES) return NULL;
     
-    return NULL;
+    game_instance_t* game = &manager->games[slot];
+    if (!game->active || game->handle != handle) return NULL;
+    return game;
+}
+
+/* The game behind `handle` with its lock held, or NULL. The slot can be
+ * removed and reused between the lookup and the lock, so the handle is
+ * checked again once the lock is held. */
+static game_instance_t* lock_game(game_manager_t* manager, game_handle_t handle) {
+    game_instance_t* game = game_manager_find_game(manager, handle);
+    if (!game) return NULL;
+
+    pthread_mutex_lock(&game->lock);
+    if (!game->active || game->handle != handle) {
+        pthread_mutex_unlock(&game->lock);
+        return NULL;
+    }
+    return game;
 }
 
-game_instance_t* game_manager_find_game_by_players(game_manager_t* manager, 
-                                                   const char* player_a, const char* player_b) {
-    if (!manager || !player_a || !player_b) return NULL;
+game_instance_t* game_manager_find_game_by_players(game_manager_t* manager,
+                                                   pseudo_id_t player_a, pseudo_id_t player_b) {
+    if (!manager || player_a == PSEUDO_ID_NONE || player_b == PSEUDO_ID_NONE) return NULL;
     
     for (int i = 0; i < MAX_GAMES; i++) {
         if (!manager->games[i].active) continue;
         
-        if ((strcmp(manager->games[i].player_a, player_a) == 0 && 
-             strcmp(manager->games[i].player_b, player_b) == 0) ||
-            (strcmp(manager->games[i].player_a, player_b) == 0 && 
-             strcmp(manager->games[i].player_b, player_a) == 0)) {
+        if ((manager->games[i].player_a == player_a && manager->games[i].player_b == player_b) ||
+            (manager->games[i].player_a == player_b && manager->games[i].player_b == player_a)) {
             return &manager->games[i];
         }
     }
@@ -139,20 +230,19 @@ game_instance_t* game_manager_find_game_by_players(game_manager_t* manager,
     return NULL;
 }
 
-error_code_t game_manager_play_move(game_manager_t* manager, const char* game_id, 
-                                   const char* player, int pit_index, int* seeds_captured) {
-    if (!manager || !game_id || !player || !seeds_captured) return ERR_INVALID_PARAM;
+error_code_t game_manager_play_move(game_manager_t* manager, game_handle_t handle, 
+                                   pseudo_id_t player, int pit_index, int* seeds_captured,
+                                   msg_board_delta_t* delta_out) {
+    if (!manager || player == PSEUDO_ID_NONE || !seeds_captured) return ERR_INVALID_PARAM;
     
-    game_instance_t* game = game_manager_find_game(manager, game_id);
+    game_instance_t* game = lock_game(manager, handle);
     if (!game) return ERR_GAME_NOT_FOUND;
     
-    pthread_mutex_lock(&game->lock);
-    
     // Determine player ID
     player_id_t player_id;
-    if (strcmp(game->player_a, player) == 0) {
+    if (game->player_a == player) {
         player_id = PLAYER_A;
-    } else if (strcmp(game->player_b, player) == 0) {
+    } else if (game->player_b == player) {
         player_id = PLAYER_B;
     } else {
         pthread_mutex_unlock(&game->lock);
@@ -160,43 +250,64 @@ error_code_t game_manager_play_move(game_manager_t* manager, const char* game_id
     }
     
     // Execute move
+    board_t before;
+    board_copy(&game->board, &before);
     error_code_t result = board_execute_move(&game->board, player_id, pit_index, seeds_captured);
     
-    // Save game state after successful move
+    // Append the move to the game log after a successful move
     if (result == SUCCESS) {
-        storage_save_game(game);
+        game->move_seq++;
+        if (delta_out) {
+            board_delta_build(&before, &game->board, game->handle, game->move_seq, pit_index, delta_out);
+        }
+        keep_move(game, pit_index);
+        storage_record_move(game, pit_index);
+        if (game->board.state != GAME_STATE_IN_PROGRESS) {
+            storage_finish_game(game);
+        }
     }
     
     pthread_mutex_unlock(&game->lock);
     return result;
 }
 
-error_code_t game_manager_get_board(game_manager_t* manager, const char* game_id, board_t* board_out) {
-    if (!manager || !game_id || !board_out) return ERR_INVALID_PARAM;
+error_code_t game_manager_get_board(game_manager_t* manager, game_handle_t handle, board_t* board_out) {
+    if (!manager || !board_out) return ERR_INVALID_PARAM;
     
-    game_instance_t* game = game_manager_find_game(manager, game_id);
+    game_instance_t* game = lock_game(manager, handle);
     if (!game) return ERR_GAME_NOT_FOUND;
     
-    pthread_mutex_lock(&game->lock);
     board_copy(&game->board, board_out);
     pthread_mutex_unlock(&game->lock);
     
     return SUCCESS;
 }
 
+error_code_t game_manager_get_keyframe(game_manager_t* manager, game_handle_t handle,
+                                       msg_board_delta_t* delta_out) {
+    if (!manager || !delta_out) return ERR_INVALID_PARAM;
+    
+    game_instance_t* game = lock_game(manager, handle);
+    if (!game) return ERR_GAME_NOT_FOUND;
+    
+    board_delta_build_keyframe(&game->board, game->handle, game->move_seq, delta_out);
+    pthread_mutex_unlock(&game->lock);
+    
+    return SUCCESS;
+}
+
 int game_manager_count_active_games(game_manager_t* manager) {
     if (!manager) return 0;
     return manager->game_count;
 }
 
-bool game_manager_is_player_in_game(game_manager_t* manager, const char* player) {
-    if (!manager || !player) return false;
+bool game_manager_is_player_in_game(game_manager_t* manager, pseudo_id_t player) {
+    if (!manager || player == PSEUDO_ID_NONE) return false;
     
     for (int i = 0; i < MAX_GAMES; i++) {
         if (!manager->games[i].active) continue;
         
-        if (strcmp(manager->games[i].player_a, player) == 0 ||
-            strcmp(manager->games[i].player_b, player) == 0) {
+        if (manager->games[i].player_a == player || manager->games[i].player_b == player) {
             return true;
         }
     }
@@ -204,17 +315,23 @@ bool game_manager_is_player_in_game(game_manager_t* manager, const char* player)
     return false;
 }
 
+/* Game summary for the wire: pseudos are resolved here */
+static void fill_game_info(const game_instance_t* game, game_info_t* info) {
+    info->game = game->handle;
+    snprintf(info->game_id, MAX_GAME_ID_LEN, "%s", game->game_id);
+    snprintf(info->player_a, MAX_PSEUDO_LEN, "%s", pseudo_name(game->player_a));
+    snprintf(info->player_b, MAX_PSEUDO_LEN, "%s", pseudo_name(game->player_b));
+    info->spectator_count = game->spectator_count;
+    info->state = game->board.state;
+}
+
 int game_manager_get_active_games(game_manager_t* manager, game_info_t* games_out, int max_games) {
     if (!manager || !games_out) return 0;
 
     int count = 0;
     for (int i = 0; i < MAX_GAMES && count < max_games; i++) {
         if (manager->games[i].active) {
-            snprintf(games_out[count].game_id, MAX_GAME_ID_LEN, "%s", manager->games[i].game_id);
-            snprintf(games_out[count].player_a, MAX_PSEUDO_LEN, "%s", manager->games[i].player_a);
-            snprintf(games_out[count].player_b, MAX_PSEUDO_LEN, "%s", manager->games[i].player_b);
-            games_out[count].spectator_count = manager->games[i].spectator_count;
-            games_out[count].state = manager->games[i].board.state;
+            fill_game_info(&manager->games[i], &games_out[count]);
             count++;
         }
     }
@@ -222,19 +339,14 @@ int game_manager_get_active_games(game_manager_t* manager, game_info_t* games_ou
     return count;
 }
 
-int game_manager_get_player_games(game_manager_t* manager, const char* player, game_info_t* games_out, int max_games) {
-    if (!manager || !player || !games_out) return 0;
+int game_manager_get_player_games(game_manager_t* manager, pseudo_id_t player, game_info_t* games_out, int max_games) {
+    if (!manager || player == PSEUDO_ID_NONE || !games_out) return 0;
 
     int count = 0;
     for (int i = 0; i < MAX_GAMES && count < max_games; i++) {
         if (manager->games[i].active &&
-            (strcmp(manager->games[i].player_a, player) == 0 ||
-             strcmp(manager->games[i].player_b, player) == 0)) {
-            snprintf(games_out[count].game_id, MAX_GAME_ID_LEN, "%s", manager->games[i].game_id);
-            snprintf(games_out[count].player_a, MAX_PSEUDO_LEN, "%s", manager->games[i].player_a);
-            snprintf(games_out[count].player_b, MAX_PSEUDO_LEN, "%s", manager->games[i].player_b);
-            games_out[count].spectator_count = manager->games[i].spectator_count;
-            games_out[count].state = manager->games[i].board.state;
+            (manager->games[i].player_a == player || manager->games[i].player_b == player)) {
+            fill_game_info(&manager->games[i], &games_out[count]);
             count++;
         }
     }
@@ -242,17 +354,40 @@ int game_manager_get_player_games(game_manager_t* manager, const char* player, g
     return count;
 }
 
-error_code_t game_manager_add_spectator(game_manager_t* manager, const char* game_id, const char* spectator) {
-    if (!manager || !game_id || !spectator) return ERR_INVALID_PARAM;
+error_code_t game_manager_list_games(game_manager_t* manager, pseudo_id_t player, uint32_t cursor,
+                                     game_info_t* games_out, int max_games,
+                                     int* count, uint32_t* next_cursor) {
+    if (!manager || !games_out || !count || !next_cursor || max_games < 1) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&manager->lock);
+
+    *count = 0;
+    *next_cursor = 0;
+    for (uint32_t i = cursor; i < MAX_GAMES; i++) {
+        const game_instance_t* game = &manager->games[i];
+        if (!game->active) continue;
+        if (player != PSEUDO_ID_NONE && game->player_a != player && game->player_b != player) continue;
+        if (*count == max_games) {
+            *next_cursor = i;
+            break;
+        }
+        fill_game_info(game, &games_out[*count]);
+        (*count)++;
+    }
+
+    pthread_mutex_unlock(&manager->lock);
+    return SUCCESS;
+}
+
+error_code_t game_manager_add_spectator(game_manager_t* manager, game_handle_t handle, pseudo_id_t spectator) {
+    if (!manager || spectator == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
     
-    game_instance_t* game = game_manager_find_game(manager, game_id);
+    game_instance_t* game = lock_game(manager, handle);
     if (!game) return ERR_GAME_NOT_FOUND;
     
-    pthread_mutex_lock(&game->lock);
-    
     /* Check if already spectating */
     for (int i = 0; i < game->spectator_count; i++) {
-        if (strcmp(game->spectators[i], spectator) == 0) {
+        if (game->spectators[i] == spectator) {
             pthread_mutex_unlock(&game->lock);
             return SUCCESS;  /* Already spectating */
         }
@@ -265,27 +400,25 @@ error_code_t game_manager_add_spectator(game_manager_t* manager, const char* gam
     }
     
     /* Add spectator */
-    snprintf(game->spectators[game->spectator_count], MAX_PSEUDO_LEN, "%s", spectator);
+    game->spectators[game->spectator_count] = spectator;
     game->spectator_count++;
     
     pthread_mutex_unlock(&game->lock);
     return SUCCESS;
 }
 
-error_code_t game_manager_remove_spectator(game_manager_t* manager, const char* game_id, const char* spectator) {
-    if (!manager || !game_id || !spectator) return ERR_INVALID_PARAM;
+error_code_t game_manager_remove_spectator(game_manager_t* manager, game_handle_t handle, pseudo_id_t spectator) {
+    if (!manager || spectator == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
     
-    game_instance_t* game = game_manager_find_game(manager, game_id);
+    game_instance_t* game = lock_game(manager, handle);
     if (!game) return ERR_GAME_NOT_FOUND;
     
-    pthread_mutex_lock(&game->lock);
-    
     /* Find and remove spectator */
     for (int i = 0; i < game->spectator_count; i++) {
-        if (strcmp(game->spectators[i], spectator) == 0) {
+        if (game->spectators[i] == spectator) {
             /* Shift remaining spectators */
             for (int j = i; j < game->spectator_count - 1; j++) {
-                snprintf(game->spectators[j], MAX_PSEUDO_LEN, "%s", game->spectators[j + 1]);
+                game->spectators[j] = game->spectators[j + 1];
             }
             game->spectator_count--;
             pthread_mutex_unlock(&game->lock);
@@ -297,13 +430,12 @@ error_code_t game_manager_remove_spectator(game_manager_t* manager, const char*
     return ERR_PLAYER_NOT_FOUND;  /* Spectator not found */
 }
 
-int game_manager_get_spectator_count(game_manager_t* manager, const char* game_id) {
-    if (!manager || !game_id) return 0;
+int game_manager_get_spectator_count(game_manager_t* manager, game_handle_t handle) {
+    if (!manager) return 0;
     
-    game_instance_t* game = game_manager_find_game(manager, game_id);
+    game_instance_t* game = lock_game(manager, handle);
     if (!game) return 0;
     
-    pthread_mutex_lock(&game->lock);
     int count = game->spectator_count;
     pthread_mutex_unlock(&game->lock);
     
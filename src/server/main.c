@@ -12,9 +12,14 @@
 #include "../../include/server/server_registry.h"
 #include "../../include/server/server_handlers.h"
 #include "../../include/server/server_connection.h"
+#include "../../include/server/resume_token.h"
 #include "../../include/network/connection.h"
 #include "../../include/network/session.h"
+#include "../../include/network/codec.h"
+#include "../../include/network/compression.h"
+#include "../../include/network/io_backend.h"
 #include "../../include/server/storage.h"
+#include "../../include/server/game_catalog.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -24,52 +29,417 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <time.h>
+#include <sys/stat.h>
 
 /* Global managers */
 static game_manager_t g_game_manager;
 static matchmaking_t g_matchmaking;
 static volatile bool g_running = true;
 static int g_discovery_port = 12345; /* Discovery port for TCP connections */
+static io_backend_kind_t g_io_backend = IO_BACKEND_EPOLL;
+static int g_acceptor_count = 0;    /* 0: one per online CPU */
+static int g_backlog = CONNECTION_BACKLOG_DEFAULT;
+static game_log_sync_t g_sync_policy = GAME_LOG_SYNC_INTERVAL;
+static int g_sync_interval_ms = GAME_LOG_SYNC_INTERVAL_DEFAULT_MS;
+
+/* Signal handler */
+void signal_handler(int sig)
+{
+    printf("\n\nReceived signal %d, shutting down server...\n", sig);
+    g_running = false;
+}
+
+/* Connections accepted but still waiting for their MSG_CONNECT, per acceptor */
+#define MAX_PENDING_HANDSHAKES 1024
+#define MAX_ACCEPTORS 64
+#define HANDSHAKE_TIMEOUT_SEC 10
 
-/* Client handler structure (used in main connection accept loop) */
 typedef struct
 {
     connection_t conn;
-    char pseudo[MAX_PSEUDO_LEN];
+    time_t accepted_at;
+} pending_handshake_t;
+
+/* One accept loop on its own thread. With several, each owns a listener
+ * bound with SO_REUSEPORT and the kernel spreads new connections across
+ * them, so a reconnect storm is accepted and handshaken in parallel. */
+typedef struct
+{
+    int index;
+    connection_t listener;
+    io_backend_t io;
+    pending_handshake_t pending[MAX_PENDING_HANDSHAKES];
+    int pending_count;
     pthread_t thread;
-} client_handler_t;
+} acceptor_t;
 
-/* Signal handler */
-void signal_handler(int sig)
+static void drop_pending(acceptor_t* acceptor, int index, bool close_conn)
 {
-    printf("\n\nReceived signal %d, shutting down server...\n", sig);
-    g_running = false;
+    io_backend_unwatch(&acceptor->io, acceptor->pending[index].conn.socket_fd);
+    if (close_conn)
+    {
+        connection_close(&acceptor->pending[index].conn);
+    }
+    acceptor->pending[index] = acceptor->pending[--acceptor->pending_count];
 }
 
-/* Simple FNV-1a 32-bit hash for strings */
-static uint32_t fnv1a_hash(const char *s) {
-    uint32_t hash = 2166136261u;
-    while (*s) {
-        hash ^= (unsigned char)*s++;
-        hash *= 16777619u;
+/* Register the client and hand it to its own thread */
+static void admit_client(connection_t client_conn, const msg_connect_t* connect_msg)
+{
+    /* Interned IDs are never freed: a name seen for the first time only gets
+     * one if it can be admitted. Registry slots are never freed either, so
+     * once it is full no new name is interned; the unlocked check can only
+     * let a few racing acceptors through before that. */
+    pseudo_id_t player = pseudo_lookup(connect_msg->pseudo);
+    if (player == PSEUDO_ID_NONE && matchmaking_has_room(&g_matchmaking))
+    {
+        player = pseudo_intern(connect_msg->pseudo);
+    }
+
+    /* Add to matchmaking: the check for a pseudo already in use happens
+     * under the matchmaking lock, so concurrent acceptors cannot both win */
+    error_code_t err = player == PSEUDO_ID_NONE
+        ? ERR_MAX_CAPACITY
+        : matchmaking_add_player(&g_matchmaking, player, connection_get_peer_ip(&client_conn));
+
+    /* A session held for a resume does not keep its owner out: the fresh
+     * login takes the player over and the held session is let go */
+    if (err == ERR_DUPLICATE && session_registry_replace_detached(player))
+    {
+        err = SUCCESS;
+    }
+    if (err != SUCCESS)
+    {
+        // Send a proper connect ACK with success=false so the client will detect the rejection
+        session_t temp_fail_session;
+        memset(&temp_fail_session, 0, sizeof(temp_fail_session));
+        temp_fail_session.conn = client_conn;
+        session_send_connect_ack(&temp_fail_session, false,
+                                 err == ERR_DUPLICATE ? "Pseudo deja utilise" : "Connexion refusee");
+        connection_close(&client_conn);
+        return;
+    }
+    printf("Connection from %s (%s)\n", connect_msg->pseudo, connection_get_peer_ip(&client_conn));
+
+    /* Send acknowledgment */
+    session_t temp_session;
+    memset(&temp_session, 0, sizeof(temp_session));
+    temp_session.conn = client_conn;
+    temp_session.codec = codec_for_version(connect_msg->version);
+    temp_session.features = connect_msg->features & (CONNECT_FEATURE_COMPRESSION | CONNECT_FEATURE_CHECKSUM);
+    strncpy(temp_session.pseudo, connect_msg->pseudo, MAX_PSEUDO_LEN - 1);
+    temp_session.pseudo[MAX_PSEUDO_LEN - 1] = '\0';
+
+    /* The session id is the token the client resumes with */
+    resume_token_issue(connect_msg->pseudo, temp_session.session_id, sizeof(temp_session.session_id));
+
+    session_send_connect_ack(&temp_session, true, "Bienvenue sur Awale!");
+
+    /* Create client handler thread */
+    client_handler_t *handler = malloc(sizeof(client_handler_t));
+    handler->conn = client_conn;
+    strncpy(handler->pseudo, connect_msg->pseudo, MAX_PSEUDO_LEN - 1);
+    handler->pseudo[MAX_PSEUDO_LEN - 1] = '\0';
+    memcpy(handler->session_id, temp_session.session_id, sizeof(handler->session_id));
+    handler->codec = temp_session.codec;
+    handler->features = temp_session.features;
+
+    /* The handler frees itself when the client leaves, possibly before
+     * pthread_create returns: keep nothing of it past this point */
+    printf("Client handler thread started for %s\n\n", handler->pseudo);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, client_handler, handler) != 0)
+    {
+        fprintf(stderr, "Failed to create client thread\n");
+        connection_close(&client_conn);
+        free(handler);
+        return;
     }
-    return hash;
+
+    pthread_detach(thread);
+}
+
+/* Give the connection to the session it resumes; a refused client falls
+ * back to a fresh MSG_CONNECT */
+static void resume_client(connection_t client_conn, const msg_resume_t* resume_msg)
+{
+    printf("Resume request from %s (%s)\n", resume_msg->pseudo, connection_get_peer_ip(&client_conn));
+    if (session_registry_resume(resume_msg, &client_conn) == SUCCESS)
+    {
+        return;
+    }
+
+    session_t temp_session;
+    memset(&temp_session, 0, sizeof(temp_session));
+    temp_session.conn = client_conn;
+    msg_resume_ack_t ack;
+    memset(&ack, 0, sizeof(ack));
+    snprintf(ack.message, sizeof(ack.message), "No session to resume");
+    session_send_message(&temp_session, MSG_RESUME_ACK, &ack, sizeof(ack));
+    connection_close(&client_conn);
+}
+
+static void start_handshake(acceptor_t* acceptor, int fd)
+{
+    connection_t client_conn;
+    connection_init(&client_conn);
+    if (connection_adopt(&client_conn, fd) != SUCCESS)
+    {
+        close(fd);
+        return;
+    }
+
+    printf("Connection client acceptee a partir de %s\n", connection_get_peer_ip(&client_conn));
+
+    if (acceptor->pending_count == MAX_PENDING_HANDSHAKES || io_backend_recv(&acceptor->io, fd) != SUCCESS)
+    {
+        connection_close(&client_conn);
+        return;
+    }
+    acceptor->pending[acceptor->pending_count].conn = client_conn;
+    acceptor->pending[acceptor->pending_count].accepted_at = time(NULL);
+    acceptor->pending_count++;
+}
+
+/* Bytes (or a hangup) for a pending connection: admit it once its
+ * MSG_CONNECT is complete. Anything after that frame stays in the
+ * connection's receive ring for the handler thread. */
+static void continue_handshake(acceptor_t* acceptor, const io_event_t* event)
+{
+    int index = -1;
+    for (int i = 0; i < acceptor->pending_count; i++)
+    {
+        if (acceptor->pending[i].conn.socket_fd == event->fd)
+        {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0)
+    {
+        return;
+    }
+
+    connection_t* conn = &acceptor->pending[index].conn;
+    if (event->type == IO_EVENT_CLOSED)
+    {
+        drop_pending(acceptor, index, true);
+        return;
+    }
+
+    if (!conn->rx)
+    {
+        conn->rx = read_buffer_create();
+    }
+    if (!conn->rx || read_buffer_append(conn->rx, event->data, event->length) != SUCCESS)
+    {
+        drop_pending(acceptor, index, true);
+        return;
+    }
+
+    frame_view_t frame;
+    error_code_t err = read_buffer_next_frame(conn->rx, &frame);
+    if (err == ERR_TIMEOUT)
+    {
+        /* Not all of it yet */
+        if (io_backend_recv(&acceptor->io, event->fd) != SUCCESS)
+        {
+            drop_pending(acceptor, index, true);
+        }
+        return;
+    }
+
+    if (err == SUCCESS && frame.type == MSG_RESUME && frame.length == sizeof(msg_resume_t))
+    {
+        msg_resume_t resume_msg;
+        memcpy(&resume_msg, frame.payload, sizeof(resume_msg));
+        resume_msg.pseudo[MAX_PSEUDO_LEN - 1] = '\0';
+        resume_msg.token[sizeof(resume_msg.token) - 1] = '\0';
+
+        connection_t client_conn = *conn;
+        drop_pending(acceptor, index, false);
+        resume_client(client_conn, &resume_msg);
+        return;
+    }
+
+    /* Older clients send a shorter msg_connect_t; never more than ours */
+    if (err != SUCCESS || frame.type != MSG_CONNECT || frame.length == 0 || frame.length > sizeof(msg_connect_t))
+    {
+        drop_pending(acceptor, index, true);
+        return;
+    }
+
+    msg_connect_t connect_msg;
+    memset(&connect_msg, 0, sizeof(connect_msg));
+    memcpy(&connect_msg, frame.payload, frame.length);
+    connect_msg.pseudo[MAX_PSEUDO_LEN - 1] = '\0';
+    connect_msg.version[sizeof(connect_msg.version) - 1] = '\0';
+
+    connection_t client_conn = *conn;
+    drop_pending(acceptor, index, false);
+    admit_client(client_conn, &connect_msg);
+}
+
+static void expire_handshakes(acceptor_t* acceptor, time_t now)
+{
+    for (int i = acceptor->pending_count - 1; i >= 0; i--)
+    {
+        if (now - acceptor->pending[i].accepted_at >= HANDSHAKE_TIMEOUT_SEC)
+        {
+            drop_pending(acceptor, i, true);
+        }
+    }
+}
+
+/* Accept loop: the backend accepts and reads each MSG_CONNECT without
+ * blocking, so a slow client cannot hold up the others */
+static void* acceptor_thread(void* arg)
+{
+    acceptor_t* acceptor = (acceptor_t*)arg;
+    io_event_t events[IO_BACKEND_MAX_EVENTS];
+
+    while (g_running)
+    {
+        expire_handshakes(acceptor, time(NULL));
+
+        int count = 0;
+        if (io_backend_wait(&acceptor->io, events, IO_BACKEND_MAX_EVENTS, 1000, &count) != SUCCESS)
+        {
+            if (g_running)
+            {
+                fprintf(stderr, "Acceptor %d failed to wait for connections\n", acceptor->index);
+            }
+            continue;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            if (events[i].type == IO_EVENT_ACCEPT)
+            {
+                start_handshake(acceptor, events[i].fd);
+            }
+            else
+            {
+                continue_handshake(acceptor, &events[i]);
+            }
+        }
+    }
+
+    for (int i = acceptor->pending_count - 1; i >= 0; i--)
+    {
+        drop_pending(acceptor, i, true);
+    }
+    return NULL;
+}
+
+/* --convert-games: move an old games.dat into the game log, then exit.
+ * The server must not be running on the same data directory. */
+static int convert_legacy_games(const char* path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+    {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+    if (storage_init() != SUCCESS)
+    {
+        fprintf(stderr, "Failed to initialize storage\n");
+        return 1;
+    }
+    game_log_stats_t before, after;
+    game_log_get_stats(&before);
+
+    int converted = 0, skipped = 0;
+    error_code_t err = storage_convert_legacy_games(path, &converted, &skipped);
+    game_log_get_stats(&after);
+    storage_cleanup();
+    if (err != SUCCESS)
+    {
+        fprintf(stderr, "Conversion of %s failed after %d game(s): %s\n", path, converted, error_to_string(err));
+        return 1;
+    }
+
+    char done[1024];
+    snprintf(done, sizeof(done), "%s.converted", path);
+    if (rename(path, done) != 0)
+    {
+        fprintf(stderr, "Converted, but could not rename %s to %s\n", path, done);
+        return 1;
+    }
+    printf("Converted %d game(s), skipped %d bad record(s): %lld bytes in %s, %llu bytes in %s\n",
+           converted, skipped, (long long)st.st_size, path,
+           (unsigned long long)(after.bytes - before.bytes), GAMES_LOG_DIR);
+    printf("Old file kept as %s\n", done);
+    return 0;
 }
 
 int main(int argc, char** argv) {
     printf("Server main started\n");
     g_discovery_port = 12345;  /* Default discovery port */
 
-    if (argc == 2) {
-        g_discovery_port = atoi(argv[1]);
+    const char* unix_path = NULL;
+    const char* convert_path = NULL;
+    int positional = 0;
+    bool bad_usage = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--unix") == 0 && i + 1 < argc)
+        {
+            unix_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--acceptors") == 0 && i + 1 < argc)
+        {
+            g_acceptor_count = atoi(argv[++i]);
+            bad_usage = bad_usage || g_acceptor_count <= 0;
+        }
+        else if (strcmp(argv[i], "--backlog") == 0 && i + 1 < argc)
+        {
+            g_backlog = atoi(argv[++i]);
+            bad_usage = bad_usage || g_backlog <= 0;
+        }
+        else if (strcmp(argv[i], "--sync") == 0 && i + 1 < argc)
+        {
+            bad_usage = bad_usage || game_log_parse_sync(argv[++i], &g_sync_policy, &g_sync_interval_ms) != SUCCESS;
+        }
+        else if (strcmp(argv[i], "--convert-games") == 0)
+        {
+            convert_path = (i + 1 < argc) ? argv[++i] : GAMES_FILE;
+        }
+        else if (positional == 0)
+        {
+            g_discovery_port = atoi(argv[i]);
+            positional++;
+        }
+        else if (positional == 1 && io_backend_parse(argv[i], &g_io_backend) == SUCCESS)
+        {
+            positional++;
+        }
+        else
+        {
+            bad_usage = true;
+        }
     }
-    else if (argc > 2)
+    if (bad_usage)
     {
-        printf("Usage: %s [discovery_port]\n", argv[0]);
+        printf("Usage: %s [discovery_port] [epoll|io_uring] [--unix PATH] [--acceptors N] [--backlog N] [--sync every|none|MS] [--convert-games [PATH]]\n", argv[0]);
         printf("  discovery_port: Port for initial client connections (default: 12345)\n");
+        printf("  epoll|io_uring: Network backend for accepting clients (default: epoll)\n");
+        printf("  --unix PATH:    Also accept local clients on a Unix domain socket\n");
+        printf("  --acceptors N:  Accept threads sharing the port via SO_REUSEPORT (default: one per CPU)\n");
+        printf("  --backlog N:    Pending connections queued per listener (default: %d)\n", CONNECTION_BACKLOG_DEFAULT);
+        printf("  --sync POLICY:  Game log sync: every move, none, or every MS milliseconds (default: %d)\n",
+               GAME_LOG_SYNC_INTERVAL_DEFAULT_MS);
+        printf("  --convert-games [PATH]: Move an old games file (default: %s) into the game log and exit\n",
+               GAMES_FILE);
         printf("  Clients will discover server via UDP broadcast.\n");
         return 1;
     }
+    if (convert_path)
+    {
+        game_log_set_sync(g_sync_policy, g_sync_interval_ms);
+        return convert_legacy_games(convert_path);
+    }
 
     printf("╔══════════════════════════════════════════════════════╗\n");
     printf("║         AWALE SERVER (Modular Architecture)          ║\n");
@@ -78,6 +448,30 @@ int main(int argc, char** argv) {
     printf("Broadcast Port: 12346 (UDP)\n");
     printf("Initializing...\n");
 
+    /* Initialize storage first: matchmaking loads the players from it */
+    printf("Initializing storage\n");
+    game_log_set_sync(g_sync_policy, g_sync_interval_ms);
+    if (storage_init() != SUCCESS) {
+        fprintf(stderr, "Failed to initialize storage\n");
+        return 1;
+    }
+    if (g_sync_policy == GAME_LOG_SYNC_INTERVAL)
+    {
+        printf("Storage initialized (game log sync every %d ms)\n", g_sync_interval_ms);
+    }
+    else
+    {
+        printf("Storage initialized (game log sync: %s)\n", game_log_sync_name(g_sync_policy));
+    }
+    game_catalog_stats_t catalog_stats;
+    game_catalog_get_stats(&catalog_stats);
+    printf("Saved-game catalog: %llu game(s), %u player(s), built in %u ms\n",
+           (unsigned long long)catalog_stats.games, catalog_stats.players, catalog_stats.build_ms);
+    game_log_stats_t segment_stats;
+    game_log_get_stats(&segment_stats);
+    printf("Game log: %u segment(s), %u compacted into archives, %.1f MB\n", segment_stats.segments,
+           segment_stats.archives, (double)segment_stats.bytes / 1e6);
+
     /* Initialize managers */
     printf("Initializing game manager\n");
     if (game_manager_init(&g_game_manager) != SUCCESS)
@@ -107,13 +501,22 @@ int main(int argc, char** argv) {
     connection_manager_init(&g_game_manager, &g_matchmaking, &g_running, g_discovery_port);
     printf("Connection manager initialized\n");
 
-    /* Initialize storage */
-    printf("Initializing storage\n");
-    if (storage_init() != SUCCESS) {
-        fprintf(stderr, "Failed to initialize storage\n");
-        return 1;
+    /* Recovery: games in progress when the server stopped resume where they were */
+    struct timespec recovery_start, recovery_end;
+    clock_gettime(CLOCK_MONOTONIC, &recovery_start);
+    int restored = 0, skipped = 0;
+    if (storage_load_all_games(&g_game_manager, &restored, &skipped) != SUCCESS)
+    {
+        fprintf(stderr, "Failed to recover games in progress\n");
     }
-    printf("Storage initialized\n");
+    clock_gettime(CLOCK_MONOTONIC, &recovery_end);
+    game_log_stats_t log_stats;
+    game_log_get_stats(&log_stats);
+    printf("Recovered %d game(s) in progress (%d left in the log) in %ld ms; index of %llu game(s) rebuilt in %u ms\n",
+           restored, skipped,
+           (long)((recovery_end.tv_sec - recovery_start.tv_sec) * 1000 +
+                  (recovery_end.tv_nsec - recovery_start.tv_nsec) / 1000000),
+           (unsigned long long)log_stats.games, log_stats.scan_ms);
     
     printf("Game manager initialisé\n");
     printf("Matchmaking initialisé\n");
@@ -138,150 +541,113 @@ int main(int argc, char** argv) {
     pthread_detach(udp_thread);
     printf("UDP broadcast discovery listening on port 12346\n");
 
-    /* Create discovery server (single socket) */
-    printf("Creating discovery server\n");
-    connection_t discovery_server;
-    if (connection_init(&discovery_server) != SUCCESS)
+    /* One listener per acceptor; SO_REUSEPORT lets them share the port */
+    if (g_acceptor_count <= 0)
     {
-        fprintf(stderr, "Failed to init discovery server connection\n");
-        return 1;
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        g_acceptor_count = cpus > 0 ? (int)cpus : 1;
     }
-    printf("Connection init done\n");
-    if (connection_create_server(&discovery_server, g_discovery_port) != SUCCESS)
+    if (g_acceptor_count > MAX_ACCEPTORS)
     {
-        fprintf(stderr, "Failed to create discovery server socket\n");
+        g_acceptor_count = MAX_ACCEPTORS;
+    }
+    acceptor_t* acceptors = calloc((size_t)g_acceptor_count, sizeof(acceptor_t));
+    if (!acceptors)
+    {
+        fprintf(stderr, "Failed to allocate acceptors\n");
         return 1;
     }
-    printf("Discovery server created\n");
 
-    printf("Discovery server listening on port %d\n", g_discovery_port);
-    printf("\nServer ready! Waiting for connections...\n\n");
-    fflush(stdout);
-
-    /* Accept loop */
-    time_t last_cleanup = time(NULL);
-    while (g_running)
+    printf("Creating discovery server\n");
+    for (int i = 0; i < g_acceptor_count; i++)
     {
-        /* Periodic cleanup of expired challenges */
-        time_t now = time(NULL);
-        if (now - last_cleanup >= 30) {  /* Clean up every 30 seconds */
-            matchmaking_cleanup_expired_challenges(&g_matchmaking);
-            last_cleanup = now;
-        }
-
-        /* Accept client connection on discovery port */
-        connection_t client_conn;
-        connection_init(&client_conn);
-
-        error_code_t err = connection_accept(&discovery_server, &client_conn);
-        if (err != SUCCESS)
-        {
-            if (g_running)
-            {
-                fprintf(stderr, "Failed to accept client connection\n");
-            }
-            continue;
-        }
-
-        printf("Connection client acceptee a partir de %s\n", connection_get_peer_ip(&client_conn));
-
-        /* Receive initial MSG_CONNECT */
-        message_header_t header;
-        size_t received;
-        if (connection_recv_raw(&client_conn, &header, sizeof(header), &received) != SUCCESS)
+        acceptors[i].index = i;
+        connection_init(&acceptors[i].listener);
+        if (connection_create_listener(&acceptors[i].listener, g_discovery_port, g_backlog,
+                                       g_acceptor_count > 1) != SUCCESS)
         {
-            connection_close(&client_conn);
-            continue;
+            fprintf(stderr, "Failed to create discovery server socket\n");
+            return 1;
         }
+    }
+    printf("Discovery server listening on port %d (%d acceptor(s), backlog %d)\n",
+           g_discovery_port, g_acceptor_count, g_backlog);
 
-        header.type = ntohl(header.type);
-        header.length = ntohl(header.length);
-
-        if (header.type != MSG_CONNECT || header.length == 0)
+    /* Optional local listener: same protocol, no TCP/IP stack */
+    connection_t unix_server;
+    connection_init(&unix_server);
+    if (unix_path)
+    {
+        if (connection_create_unix_server(&unix_server, unix_path) != SUCCESS)
         {
-            connection_close(&client_conn);
-            continue;
+            fprintf(stderr, "Failed to create Unix socket %s\n", unix_path);
+            return 1;
         }
+        printf("Local clients accepted on %s\n", unix_path);
+    }
 
-        /* Read connect message */
-        msg_connect_t connect_msg;
-        if (connection_recv_raw(&client_conn, &connect_msg, header.length, &received) != SUCCESS)
+    for (int i = 0; i < g_acceptor_count; i++)
+    {
+        acceptor_t* acceptor = &acceptors[i];
+        if (io_backend_init(&acceptor->io, g_io_backend, acceptor->listener.socket_fd) != SUCCESS)
         {
-            connection_close(&client_conn);
-            continue;
+            fprintf(stderr, "Failed to initialize %s backend\n", io_backend_name(g_io_backend));
+            return 1;
         }
-
-        connect_msg.pseudo[MAX_PSEUDO_LEN - 1] = '\0';
-
-        player_info_t players[100];
-        int count;
-        error_code_t error_matchmaking = matchmaking_get_players(&g_matchmaking, players, 100, &count);
-        bool pseudo_already_use = false;
-        if (error_matchmaking == SUCCESS)
+        if (i == 0 && acceptor->io.kind != g_io_backend)
         {
-            for (int i = 0; i < count; i++)
-            {
-                if (strcmp(connect_msg.pseudo, players[i].pseudo) == 0)
-                {
-                    // Send a proper connect ACK with success=false so the client will detect the rejection
-                    session_t temp_fail_session;
-                    memset(&temp_fail_session, 0, sizeof(temp_fail_session));
-                    temp_fail_session.conn = client_conn;
-                    session_send_connect_ack(&temp_fail_session, false, "Pseudo deja utilise");
-                    pseudo_already_use = true;
-                    break;
-                }
-            }
+            printf("%s unavailable, falling back to %s\n", io_backend_name(g_io_backend),
+                   io_backend_name(acceptor->io.kind));
         }
-        if (pseudo_already_use)
+        /* The local socket sees little traffic; the first acceptor takes it */
+        if (i == 0 && unix_path && io_backend_listen(&acceptor->io, unix_server.socket_fd) != SUCCESS)
         {
-            connection_close(&client_conn);
-            continue;
+            fprintf(stderr, "Failed to accept on %s\n", unix_path);
+            return 1;
         }
-        printf("Connection from %s (%s)\n", connect_msg.pseudo, connection_get_peer_ip(&client_conn));
+    }
+    printf("Network backend: %s\n", io_backend_name(acceptors[0].io.kind));
 
-        /* Add to matchmaking */
-        if (matchmaking_add_player(&g_matchmaking, connect_msg.pseudo, connection_get_peer_ip(&client_conn)) != SUCCESS)
+    for (int i = 0; i < g_acceptor_count; i++)
+    {
+        if (pthread_create(&acceptors[i].thread, NULL, acceptor_thread, &acceptors[i]) != 0)
         {
-            connection_close(&client_conn);
-            continue;
+            fprintf(stderr, "Failed to create acceptor thread\n");
+            return 1;
         }
+    }
+    printf("\nServer ready! Waiting for connections...\n\n");
+    fflush(stdout);
 
-        /* Send acknowledgment */
-        session_t temp_session;
-        temp_session.conn = client_conn;
-        strncpy(temp_session.pseudo, connect_msg.pseudo, MAX_PSEUDO_LEN - 1);
-        temp_session.pseudo[MAX_PSEUDO_LEN - 1] = '\0';
-
-        /* Create simple session ID */
-        uint32_t h = fnv1a_hash(connect_msg.pseudo);
-        snprintf(temp_session.session_id, sizeof(temp_session.session_id), "S%08x", h);
-        temp_session.session_id[sizeof(temp_session.session_id) - 1] = '\0';
-
-        session_send_connect_ack(&temp_session, true, "Bienvenue sur Awale!");
-
-        /* Create client handler thread */
-        client_handler_t *handler = malloc(sizeof(client_handler_t));
-        handler->conn = client_conn;
-        strncpy(handler->pseudo, connect_msg.pseudo, MAX_PSEUDO_LEN - 1);
-        handler->pseudo[MAX_PSEUDO_LEN - 1] = '\0';
-
-        if (pthread_create(&handler->thread, NULL, client_handler, handler) != 0)
-        {
-            fprintf(stderr, "Failed to create client thread\n");
-            connection_close(&client_conn);
-            free(handler);
-            continue;
+    time_t last_cleanup = time(NULL);
+    while (g_running)
+    {
+        /* Periodic cleanup of expired challenges */
+        time_t now = time(NULL);
+        if (now - last_cleanup >= 30) {  /* Clean up every 30 seconds */
+            matchmaking_cleanup_expired_challenges(&g_matchmaking);
+            last_cleanup = now;
         }
+        struct timespec tick = { 1, 0 };
+        nanosleep(&tick, NULL);
+    }
 
-        pthread_detach(handler->thread);
-
-    printf("Client handler thread started for %s\n\n", handler->pseudo);
+    for (int i = 0; i < g_acceptor_count; i++)
+    {
+        pthread_join(acceptors[i].thread, NULL);
+        io_backend_destroy(&acceptors[i].io);
+        connection_close(&acceptors[i].listener);
     }
+    free(acceptors);
 
     printf("\nServer stopped\n");
+    compression_print_stats("Server");
 
-    connection_close(&discovery_server);
+    if (unix_path)
+    {
+        connection_close(&unix_server);
+        unlink(unix_path);
+    }
     game_manager_destroy(&g_game_manager);
     matchmaking_destroy(&g_matchmaking);
     storage_cleanup();
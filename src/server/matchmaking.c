@@ -7,16 +7,28 @@
 /* Static counter for challenge ID generation */
 static int64_t g_next_challenge_id = 1;
 
-/* Helper function to get player index from pseudo */
-static int get_player_index(matchmaking_t* mm, const char* pseudo) {
+/* Helper function to get player index from pseudo ID */
+static int get_player_index(matchmaking_t* mm, pseudo_id_t player) {
     for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
+        if (mm->players[i].id == player) {
             return i;
         }
     }
     return -1;
 }
 
+/* Cold record of player `index`, read from the store on first use; caller
+ * holds mm->lock. A player with no record yet gets an empty one. */
+static player_profile_t* get_profile(matchmaking_t* mm, int index) {
+    if (!mm->profiles[index]) {
+        player_profile_t* profile = calloc(1, sizeof(player_profile_t));
+        if (!profile) return NULL;
+        storage_load_player_profile(pseudo_name(mm->players[index].id), profile);
+        mm->profiles[index] = profile;
+    }
+    return mm->profiles[index];
+}
+
 error_code_t matchmaking_init(matchmaking_t* mm) {
     if (!mm) return ERR_INVALID_PARAM;
     
@@ -34,6 +46,7 @@ error_code_t matchmaking_init(matchmaking_t* mm) {
 
     for (int i = 0; i < MAX_PLAYERS; i++) {
         mm->players[i].connected = false;
+        mm->profiles[i] = NULL;
     }
     
     // Load persisted player data
@@ -44,21 +57,26 @@ error_code_t matchmaking_init(matchmaking_t* mm) {
 
 error_code_t matchmaking_destroy(matchmaking_t* mm) {
     if (!mm) return ERR_INVALID_PARAM;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        free(mm->profiles[i]);
+        mm->profiles[i] = NULL;
+    }
     pthread_mutex_destroy(&mm->lock);
     return SUCCESS;
 }
 
-error_code_t matchmaking_add_player(matchmaking_t* mm, const char* pseudo, const char* ip) {
-    if (!mm || !pseudo || !ip) return ERR_INVALID_PARAM;
+error_code_t matchmaking_add_player(matchmaking_t* mm, pseudo_id_t player, const char* ip) {
+    if (!mm || player == PSEUDO_ID_NONE || !ip) return ERR_INVALID_PARAM;
     
     pthread_mutex_lock(&mm->lock);
     
     // Check if player already exists
     for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
+        if (mm->players[i].id == player) {
+            error_code_t err = mm->players[i].connected ? ERR_DUPLICATE : SUCCESS;
             mm->players[i].connected = true;
             pthread_mutex_unlock(&mm->lock);
-            return SUCCESS;
+            return err;
         }
     }
     
@@ -67,10 +85,11 @@ error_code_t matchmaking_add_player(matchmaking_t* mm, const char* pseudo, const
         return ERR_MAX_CAPACITY;
     }
     
-    player_entry_t* player = &mm->players[mm->player_count];
-    strncpy(player->info.pseudo, pseudo, MAX_PSEUDO_LEN - 1);
-    strncpy(player->info.ip, ip, MAX_IP_LEN - 1);
-    player->connected = true;
+    player_entry_t* entry = &mm->players[mm->player_count];
+    memset(entry, 0, sizeof(*entry));
+    entry->id = player;
+    strncpy(entry->ip, ip, MAX_IP_LEN - 1);
+    entry->connected = true;
     
     mm->player_count++;
     
@@ -78,13 +97,13 @@ error_code_t matchmaking_add_player(matchmaking_t* mm, const char* pseudo, const
     return SUCCESS;
 }
 
-error_code_t matchmaking_remove_player(matchmaking_t* mm, const char* pseudo) {
-    if (!mm || !pseudo) return ERR_INVALID_PARAM;
+error_code_t matchmaking_remove_player(matchmaking_t* mm, pseudo_id_t player) {
+    if (!mm || player == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
     
     pthread_mutex_lock(&mm->lock);
     
     for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
+        if (mm->players[i].id == player) {
             mm->players[i].connected = false;
             pthread_mutex_unlock(&mm->lock);
             return SUCCESS;
@@ -95,9 +114,9 @@ error_code_t matchmaking_remove_player(matchmaking_t* mm, const char* pseudo) {
     return SUCCESS;  /* Not an error if player not found */
 }
 
-error_code_t matchmaking_create_challenge(matchmaking_t* mm, const char* challenger, 
-                                         const char* opponent, bool* mutual_found) {
-    if (!mm || !challenger || !opponent || !mutual_found) return ERR_INVALID_PARAM;
+error_code_t matchmaking_create_challenge(matchmaking_t* mm, pseudo_id_t challenger, 
+                                         pseudo_id_t opponent, bool* mutual_found) {
+    if (!mm || challenger == PSEUDO_ID_NONE || opponent == PSEUDO_ID_NONE || !mutual_found) return ERR_INVALID_PARAM;
     
     *mutual_found = false;
     
@@ -107,8 +126,8 @@ error_code_t matchmaking_create_challenge(matchmaking_t* mm, const char* challen
     for (int i = 0; i < mm->challenge_count; i++) {
         if (!mm->challenges[i].active) continue;
         
-        if (strcmp(mm->challenges[i].challenger, opponent) == 0 &&
-            strcmp(mm->challenges[i].opponent, challenger) == 0) {
+        if (mm->challenges[i].challenger == opponent &&
+            mm->challenges[i].opponent == challenger) {
             *mutual_found = true;
             mm->challenges[i].active = false;
             pthread_mutex_unlock(&mm->lock);
@@ -124,8 +143,8 @@ error_code_t matchmaking_create_challenge(matchmaking_t* mm, const char* challen
     
     for (int i = 0; i < MAX_CHALLENGES; i++) {
         if (!mm->challenges[i].active) {
-            strncpy(mm->challenges[i].challenger, challenger, MAX_PSEUDO_LEN - 1);
-            strncpy(mm->challenges[i].opponent, opponent, MAX_PSEUDO_LEN - 1);
+            mm->challenges[i].challenger = challenger;
+            mm->challenges[i].opponent = opponent;
             mm->challenges[i].created_at = time(NULL);
             mm->challenges[i].active = true;
             mm->challenge_count++;
@@ -137,30 +156,121 @@ error_code_t matchmaking_create_challenge(matchmaking_t* mm, const char* challen
     return SUCCESS;
 }
 
-error_code_t matchmaking_get_players(matchmaking_t* mm, player_info_t* players, int max_players, int* count) {
-    if (!mm || !players || !count) return ERR_INVALID_PARAM;
-    
+bool matchmaking_player_connected(matchmaking_t* mm, pseudo_id_t player) {
+    if (!mm || player == PSEUDO_ID_NONE) return false;
+
     pthread_mutex_lock(&mm->lock);
-    
+    int index = get_player_index(mm, player);
+    bool connected = index >= 0 && mm->players[index].connected;
+    pthread_mutex_unlock(&mm->lock);
+    return connected;
+}
+
+bool matchmaking_has_room(matchmaking_t* mm) {
+    if (!mm) return false;
+
+    pthread_mutex_lock(&mm->lock);
+    bool room = mm->player_count < MAX_PLAYERS;
+    pthread_mutex_unlock(&mm->lock);
+    return room;
+}
+
+/* Registry slots are never reused (a returning player gets their old slot
+ * back), so the slot index stays a valid cursor while players come and go */
+error_code_t matchmaking_list_players(matchmaking_t* mm, uint32_t cursor, player_list_item_t* items,
+                                      int max_items, int* count, uint32_t* next_cursor) {
+    if (!mm || !items || !count || !next_cursor || max_items < 1) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&mm->lock);
+
     *count = 0;
-    for (int i = 0; i < mm->player_count && *count < max_players; i++) {
-        if (mm->players[i].connected) {
-            players[*count] = mm->players[i].info;
-            (*count)++;
+    *next_cursor = 0;
+    for (uint32_t i = cursor; i < (uint32_t)mm->player_count; i++) {
+        if (!mm->players[i].connected) continue;
+        if (*count == max_items) {
+            *next_cursor = i;
+            break;
         }
+        snprintf(items[*count].pseudo, MAX_PSEUDO_LEN, "%s", pseudo_name(mm->players[i].id));
+        memcpy(items[*count].ip, mm->players[i].ip, MAX_IP_LEN);
+        (*count)++;
     }
-    
+
     pthread_mutex_unlock(&mm->lock);
     return SUCCESS;
 }
 
-bool matchmaking_player_exists(matchmaking_t* mm, const char* pseudo) {
-    if (!mm || !pseudo) return false;
+/* Cursor is a challenge slot index */
+error_code_t matchmaking_list_challengers(matchmaking_t* mm, pseudo_id_t opponent, uint32_t cursor,
+                                          char challengers[][MAX_PSEUDO_LEN], int max_items,
+                                          int* count, uint32_t* next_cursor) {
+    if (!mm || opponent == PSEUDO_ID_NONE || !challengers || !count || !next_cursor || max_items < 1) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&mm->lock);
+
+    *count = 0;
+    *next_cursor = 0;
+    for (uint32_t i = cursor; i < MAX_CHALLENGES; i++) {
+        if (!mm->challenges[i].active || mm->challenges[i].opponent != opponent) continue;
+        if (*count == max_items) {
+            *next_cursor = i;
+            break;
+        }
+        snprintf(challengers[*count], MAX_PSEUDO_LEN, "%s", pseudo_name(mm->challenges[i].challenger));
+        (*count)++;
+    }
+
+    pthread_mutex_unlock(&mm->lock);
+    return SUCCESS;
+}
+
+/* Cursor is a position in the friend list; removals shift later entries */
+error_code_t matchmaking_list_friends(matchmaking_t* mm, pseudo_id_t player, uint32_t cursor,
+                                      char friends[][MAX_PSEUDO_LEN], int max_items,
+                                      int* count, uint32_t* next_cursor) {
+    if (!mm || player == PSEUDO_ID_NONE || !friends || !count || !next_cursor || max_items < 1) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&mm->lock);
+
+    int index = -1;
+    for (int i = 0; i < mm->player_count; i++) {
+        if (mm->players[i].id == player) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        pthread_mutex_unlock(&mm->lock);
+        return ERR_PLAYER_NOT_FOUND;
+    }
+
+    const player_profile_t* profile = get_profile(mm, index);
+    if (!profile) {
+        pthread_mutex_unlock(&mm->lock);
+        return ERR_MAX_CAPACITY;
+    }
+    *count = 0;
+    *next_cursor = 0;
+    for (uint32_t i = cursor; i < (uint32_t)profile->friend_count && i < MAX_FRIENDS; i++) {
+        if (*count == max_items) {
+            *next_cursor = i;
+            break;
+        }
+        snprintf(friends[*count], MAX_PSEUDO_LEN, "%s", pseudo_name(profile->friends[i]));
+        (*count)++;
+    }
+
+    pthread_mutex_unlock(&mm->lock);
+    return SUCCESS;
+}
+
+bool matchmaking_player_exists(matchmaking_t* mm, pseudo_id_t player) {
+    if (!mm || player == PSEUDO_ID_NONE) return false;
     
     pthread_mutex_lock(&mm->lock);
     
     for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
+        if (mm->players[i].id == player) {
             pthread_mutex_unlock(&mm->lock);
             return true;
         }
@@ -170,15 +280,15 @@ bool matchmaking_player_exists(matchmaking_t* mm, const char* pseudo) {
     return false;
 }
 
-error_code_t matchmaking_remove_challenge(matchmaking_t* mm, const char* challenger, const char* opponent) {
-    if (!mm || !challenger || !opponent) return ERR_INVALID_PARAM;
+error_code_t matchmaking_remove_challenge(matchmaking_t* mm, pseudo_id_t challenger, pseudo_id_t opponent) {
+    if (!mm || challenger == PSEUDO_ID_NONE || opponent == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
     
     pthread_mutex_lock(&mm->lock);
     
     for (int i = 0; i < MAX_CHALLENGES; i++) {
         if (mm->challenges[i].active &&
-            strcmp(mm->challenges[i].challenger, challenger) == 0 &&
-            strcmp(mm->challenges[i].opponent, opponent) == 0) {
+            mm->challenges[i].challenger == challenger &&
+            mm->challenges[i].opponent == opponent) {
             mm->challenges[i].active = false;
             mm->challenge_count--;
             pthread_mutex_unlock(&mm->lock);
@@ -190,24 +300,24 @@ error_code_t matchmaking_remove_challenge(matchmaking_t* mm, const char* challen
     return ERR_GAME_NOT_FOUND;  /* Challenge not found */
 }
 
-error_code_t matchmaking_update_player_stats(matchmaking_t* mm, const char* pseudo, 
+error_code_t matchmaking_update_player_stats(matchmaking_t* mm, pseudo_id_t player, 
                                             bool game_won, int score_earned) {
-    if (!mm || !pseudo) return ERR_INVALID_PARAM;
+    if (!mm || player == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
     
     pthread_mutex_lock(&mm->lock);
     
     for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
-            mm->players[i].info.games_played++;
+        if (mm->players[i].id == player) {
+            mm->players[i].games_played++;
             if (game_won) {
-                mm->players[i].info.games_won++;
+                mm->players[i].games_won++;
             } else {
-                mm->players[i].info.games_lost++;
+                mm->players[i].games_lost++;
             }
-            mm->players[i].info.total_score += score_earned;
+            mm->players[i].total_score += score_earned;
             
             // Save updated player data to disk
-            storage_save_players(mm);
+            storage_save_player(mm, i);
             
             pthread_mutex_unlock(&mm->lock);
             return SUCCESS;
@@ -218,16 +328,17 @@ error_code_t matchmaking_update_player_stats(matchmaking_t* mm, const char* pseu
     return ERR_PLAYER_NOT_FOUND;
 }
 
-error_code_t matchmaking_create_challenge_with_id(matchmaking_t* mm, const char* challenger,
-                                                    const char* opponent, int64_t* challenge_id, bool* is_new) {
-    if (!mm || !challenger || !opponent || !challenge_id || !is_new) return ERR_INVALID_PARAM;
+error_code_t matchmaking_create_challenge_with_id(matchmaking_t* mm, pseudo_id_t challenger,
+                                                    pseudo_id_t opponent, int64_t* challenge_id, bool* is_new) {
+    if (!mm || challenger == PSEUDO_ID_NONE || opponent == PSEUDO_ID_NONE || !challenge_id || !is_new) return ERR_INVALID_PARAM;
 
     pthread_mutex_lock(&mm->lock);
 
     int challenger_idx = get_player_index(mm, challenger);
     int opponent_idx = get_player_index(mm, opponent);
     if (challenger_idx == -1 || opponent_idx == -1) {
-        printf("Challenge creation failed: player not found (%s or %s)\n", challenger, opponent);
+        printf("Challenge creation failed: player not found (%s or %s)\n",
+               pseudo_name(challenger), pseudo_name(opponent));
         pthread_mutex_unlock(&mm->lock);
         return ERR_PLAYER_NOT_FOUND;
     }
@@ -256,8 +367,8 @@ error_code_t matchmaking_create_challenge_with_id(matchmaking_t* mm, const char*
     // Check if challenge already exists between these players
     for (int i = 0; i < MAX_CHALLENGES; i++) {
         if (mm->challenges[i].active &&
-            strcmp(mm->challenges[i].challenger, challenger) == 0 &&
-            strcmp(mm->challenges[i].opponent, opponent) == 0) {
+            mm->challenges[i].challenger == challenger &&
+            mm->challenges[i].opponent == opponent) {
             *challenge_id = mm->challenges[i].challenge_id;
             *is_new = false;
             printf("Challenge already exists (ID: %lld), reusing\n", (long long)*challenge_id);
@@ -278,13 +389,14 @@ error_code_t matchmaking_create_challenge_with_id(matchmaking_t* mm, const char*
             mm->challenges[i].challenge_id = g_next_challenge_id++;
             *challenge_id = mm->challenges[i].challenge_id;
             *is_new = true;
-            strncpy(mm->challenges[i].challenger, challenger, MAX_PSEUDO_LEN - 1);
-            strncpy(mm->challenges[i].opponent, opponent, MAX_PSEUDO_LEN - 1);
+            mm->challenges[i].challenger = challenger;
+            mm->challenges[i].opponent = opponent;
             mm->challenges[i].created_at = time(NULL);
             mm->challenges[i].active = true;
             mm->challenge_count++;
             mm->last_challenge_times[challenger_idx][opponent_idx] = now;
-            printf("Challenge created: %s -> %s (ID: %lld)\n", challenger, opponent, (long long)*challenge_id);
+            printf("Challenge created: %s -> %s (ID: %lld)\n", pseudo_name(challenger), pseudo_name(opponent),
+                   (long long)*challenge_id);
             break;
         }
     }
@@ -341,8 +453,8 @@ void matchmaking_cleanup_expired_challenges(matchmaking_t* mm) {
             (now - mm->challenges[i].created_at) > CHALLENGE_TIMEOUT_SECONDS) {
             printf("Challenge %lld expired (challenger: %s, opponent: %s)\n",
                    (long long)mm->challenges[i].challenge_id,
-                   mm->challenges[i].challenger,
-                   mm->challenges[i].opponent);
+                   pseudo_name(mm->challenges[i].challenger),
+                   pseudo_name(mm->challenges[i].opponent));
             mm->challenges[i].active = false;
             mm->challenge_count--;
         }
@@ -351,15 +463,15 @@ void matchmaking_cleanup_expired_challenges(matchmaking_t* mm) {
     pthread_mutex_unlock(&mm->lock);
 }
 
-error_code_t matchmaking_get_player_stats(matchmaking_t* mm, const char* pseudo, 
-                                         player_info_t* info_out) {
-    if (!mm || !pseudo || !info_out) return ERR_INVALID_PARAM;
+error_code_t matchmaking_get_player_stats(matchmaking_t* mm, pseudo_id_t player, 
+                                         player_entry_t* entry_out) {
+    if (!mm || player == PSEUDO_ID_NONE || !entry_out) return ERR_INVALID_PARAM;
     
     pthread_mutex_lock(&mm->lock);
     
     for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
-            memcpy(info_out, &mm->players[i].info, sizeof(player_info_t));
+        if (mm->players[i].id == player) {
+            *entry_out = mm->players[i];
             pthread_mutex_unlock(&mm->lock);
             return SUCCESS;
         }
@@ -369,121 +481,138 @@ error_code_t matchmaking_get_player_stats(matchmaking_t* mm, const char* pseudo,
     return ERR_PLAYER_NOT_FOUND;
 }
 
-error_code_t matchmaking_set_player_bio(matchmaking_t* mm, const char* pseudo, const char bio[][256], int lines) {
-    if (!mm || !pseudo || !bio || lines < 0 || lines > 10) return ERR_INVALID_PARAM;
+error_code_t matchmaking_set_player_bio(matchmaking_t* mm, pseudo_id_t player, const char bio[][256], int lines) {
+    if (!mm || player == PSEUDO_ID_NONE || !bio || lines < 0 || lines > 10) return ERR_INVALID_PARAM;
     pthread_mutex_lock(&mm->lock);
-    for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
-            mm->players[i].info.bio_lines = lines;
-            for (int b = 0; b < lines; b++) {
-                snprintf(mm->players[i].info.bio[b], sizeof(mm->players[i].info.bio[b]), "%s", bio[b]);
-            }
-            storage_save_players(mm);
-            pthread_mutex_unlock(&mm->lock);
-            return SUCCESS;
-        }
+    int index = get_player_index(mm, player);
+    player_profile_t* profile = index >= 0 ? get_profile(mm, index) : NULL;
+    if (!profile) {
+        pthread_mutex_unlock(&mm->lock);
+        return index >= 0 ? ERR_MAX_CAPACITY : ERR_PLAYER_NOT_FOUND;
     }
+    profile->bio_lines = lines;
+    for (int b = 0; b < lines; b++) {
+        snprintf(profile->bio[b], sizeof(profile->bio[b]), "%s", bio[b]);
+    }
+    storage_save_player(mm, index);
     pthread_mutex_unlock(&mm->lock);
-    return ERR_PLAYER_NOT_FOUND;
+    return SUCCESS;
+}
+
+error_code_t matchmaking_get_player_bio(matchmaking_t* mm, pseudo_id_t player, char bio[][256], int* lines) {
+    if (!mm || player == PSEUDO_ID_NONE || !bio || !lines) return ERR_INVALID_PARAM;
+    pthread_mutex_lock(&mm->lock);
+    int index = get_player_index(mm, player);
+    const player_profile_t* profile = index >= 0 ? get_profile(mm, index) : NULL;
+    if (!profile) {
+        pthread_mutex_unlock(&mm->lock);
+        return index >= 0 ? ERR_MAX_CAPACITY : ERR_PLAYER_NOT_FOUND;
+    }
+    *lines = profile->bio_lines;
+    for (int b = 0; b < profile->bio_lines && b < 10; b++) {
+        memcpy(bio[b], profile->bio[b], sizeof(profile->bio[b]));
+    }
+    pthread_mutex_unlock(&mm->lock);
+    return SUCCESS;
 }
 
-error_code_t matchmaking_add_friend(matchmaking_t* mm, const char* pseudo, const char* friend_pseudo) {
-    if (!mm || !pseudo || !friend_pseudo) return ERR_INVALID_PARAM;
+error_code_t matchmaking_add_friend(matchmaking_t* mm, pseudo_id_t player, pseudo_id_t friend_id) {
+    if (!mm || player == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
 
     /* Check if friend exists */
-    if (!matchmaking_player_exists(mm, friend_pseudo)) {
+    if (!matchmaking_player_exists(mm, friend_id)) {
         return ERR_PLAYER_NOT_FOUND;
     }
 
     /* Cannot add self as friend */
-    if (strcmp(pseudo, friend_pseudo) == 0) {
+    if (player == friend_id) {
         return ERR_INVALID_PARAM;
     }
 
     pthread_mutex_lock(&mm->lock);
-    for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
-            /* Check if already friends */
-            for (int f = 0; f < mm->players[i].info.friend_count; f++) {
-                if (strcmp(mm->players[i].info.friends[f], friend_pseudo) == 0) {
-                    pthread_mutex_unlock(&mm->lock);
-                    return ERR_DUPLICATE;  /* Already friends */
-                }
-            }
-
-            /* Check if friend list is full */
-            if (mm->players[i].info.friend_count >= MAX_FRIENDS) {
-                pthread_mutex_unlock(&mm->lock);
-                return ERR_MAX_CAPACITY;
-            }
-
-            /* Add friend */
-            strncpy(mm->players[i].info.friends[mm->players[i].info.friend_count],
-                    friend_pseudo, MAX_PSEUDO_LEN - 1);
-            mm->players[i].info.friends[mm->players[i].info.friend_count][MAX_PSEUDO_LEN - 1] = '\0';
-            mm->players[i].info.friend_count++;
+    int index = get_player_index(mm, player);
+    player_profile_t* profile = index >= 0 ? get_profile(mm, index) : NULL;
+    if (!profile) {
+        pthread_mutex_unlock(&mm->lock);
+        return index >= 0 ? ERR_MAX_CAPACITY : ERR_PLAYER_NOT_FOUND;
+    }
 
-            storage_save_players(mm);
+    /* Check if already friends */
+    for (int f = 0; f < profile->friend_count; f++) {
+        if (profile->friends[f] == friend_id) {
             pthread_mutex_unlock(&mm->lock);
-            return SUCCESS;
+            return ERR_DUPLICATE;  /* Already friends */
         }
     }
+
+    /* Check if friend list is full */
+    if (profile->friend_count >= MAX_FRIENDS) {
+        pthread_mutex_unlock(&mm->lock);
+        return ERR_MAX_CAPACITY;
+    }
+
+    /* Add friend */
+    profile->friends[profile->friend_count] = friend_id;
+    profile->friend_count++;
+
+    storage_save_player(mm, index);
     pthread_mutex_unlock(&mm->lock);
-    return ERR_PLAYER_NOT_FOUND;
+    return SUCCESS;
 }
 
-error_code_t matchmaking_remove_friend(matchmaking_t* mm, const char* pseudo, const char* friend_pseudo) {
-    if (!mm || !pseudo || !friend_pseudo) return ERR_INVALID_PARAM;
+error_code_t matchmaking_remove_friend(matchmaking_t* mm, pseudo_id_t player, pseudo_id_t friend_id) {
+    if (!mm || player == PSEUDO_ID_NONE || friend_id == PSEUDO_ID_NONE) return ERR_INVALID_PARAM;
 
     pthread_mutex_lock(&mm->lock);
-    for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
-            /* Find and remove friend */
-            for (int f = 0; f < mm->players[i].info.friend_count; f++) {
-                if (strcmp(mm->players[i].info.friends[f], friend_pseudo) == 0) {
-                    /* Shift remaining friends */
-                    for (int j = f; j < mm->players[i].info.friend_count - 1; j++) {
-                        strcpy(mm->players[i].info.friends[j], mm->players[i].info.friends[j + 1]);
-                    }
-                    mm->players[i].info.friend_count--;
-
-                    storage_save_players(mm);
-                    pthread_mutex_unlock(&mm->lock);
-                    return SUCCESS;
-                }
+    int index = get_player_index(mm, player);
+    player_profile_t* profile = index >= 0 ? get_profile(mm, index) : NULL;
+    if (!profile) {
+        pthread_mutex_unlock(&mm->lock);
+        return index >= 0 ? ERR_MAX_CAPACITY : ERR_PLAYER_NOT_FOUND;
+    }
+
+    /* Find and remove friend */
+    for (int f = 0; f < profile->friend_count; f++) {
+        if (profile->friends[f] == friend_id) {
+            /* Shift remaining friends */
+            for (int j = f; j < profile->friend_count - 1; j++) {
+                profile->friends[j] = profile->friends[j + 1];
             }
+            profile->friend_count--;
+
+            storage_save_player(mm, index);
             pthread_mutex_unlock(&mm->lock);
-            return ERR_PLAYER_NOT_FOUND;  /* Friend not found in list */
+            return SUCCESS;
         }
     }
     pthread_mutex_unlock(&mm->lock);
-    return ERR_PLAYER_NOT_FOUND;
+    return ERR_PLAYER_NOT_FOUND;  /* Friend not found in list */
 }
 
-bool matchmaking_are_friends(matchmaking_t* mm, const char* pseudo1, const char* pseudo2) {
-    if (!mm || !pseudo1 || !pseudo2) return false;
+bool matchmaking_are_friends(matchmaking_t* mm, pseudo_id_t player1, pseudo_id_t player2) {
+    if (!mm || player1 == PSEUDO_ID_NONE || player2 == PSEUDO_ID_NONE) return false;
 
     pthread_mutex_lock(&mm->lock);
-    for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo1) == 0) {
-            for (int f = 0; f < mm->players[i].info.friend_count; f++) {
-                if (strcmp(mm->players[i].info.friends[f], pseudo2) == 0) {
-                    pthread_mutex_unlock(&mm->lock);
-                    return true;
-                }
+    bool found = false;
+    int index = get_player_index(mm, player1);
+    const player_profile_t* profile = index >= 0 ? get_profile(mm, index) : NULL;
+    if (profile) {
+        for (int f = 0; f < profile->friend_count; f++) {
+            if (profile->friends[f] == player2) {
+                found = true;
+                break;
             }
-            break;
         }
     }
     pthread_mutex_unlock(&mm->lock);
-    return false;
+    return found;
 }
 
-int matchmaking_get_player_index(matchmaking_t* mm, const char* pseudo) {
-    if (!mm || !pseudo) return -1;
+int matchmaking_get_player_index(matchmaking_t* mm, pseudo_id_t player) {
+    if (!mm || player == PSEUDO_ID_NONE) return -1;
 
     for (int i = 0; i < mm->player_count; i++) {
-        if (strcmp(mm->players[i].info.pseudo, pseudo) == 0) {
+        if (mm->players[i].id == player) {
             return i;
         }
     }
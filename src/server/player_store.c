@@ -0,0 +1,545 @@
+/* Player Store Implementation
+ * The file starts with a header page (magic, version, record size); slot i
+ * follows at PLAYER_STORE_PAGE_SIZE + i * 2 * copy size. Each copy is a
+ * whole number of pages:
+ *   u32 crc        CRC-32C of the rest of the copy up to the record's end
+ *   u32 reserved
+ *   u64 sequence   0 for a copy never written
+ *   char key[MAX_PSEUDO_LEN]   The player's pseudo
+ *   record         At COPY_HEADER
+ * A slot with no good copy, or holding a name another slot already has, is
+ * free for the next new player. A version 1 file, checked with zlib's
+ * CRC-32, has its good copies' CRCs redone when it is opened, and only
+ * then its header set to the current version.
+ *
+ * A stored record waits in the slot's pending buffer, and the slot's index
+ * in the dirty list, until a flush round takes it. Rounds run one at a
+ * time, from the flusher or player_store_flush, and write without the
+ * store lock; a record stored meanwhile waits for the next round.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "../../include/server/player_store.h"
+#include "../../include/common/checksum.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define STORE_MAGIC 0x53505741u         /* "AWPS" */
+#define STORE_VERSION 2
+#define STORE_VERSION_CRC32 1           /* Copies checked with zlib's CRC-32 */
+#define COPY_HEADER 128
+#define COPY_KEY 16
+
+typedef struct {
+    pseudo_id_t player;         /* PSEUDO_ID_NONE: free */
+    uint64_t sequence;          /* Of the newest copy written, 0 if none */
+    uint8_t current;            /* Copy holding it */
+    uint8_t* pending;           /* Stored, not yet taken by a flush: the dirty flag */
+    uint8_t* writing;           /* Taken by the flush in progress */
+} store_slot_t;
+
+/* A record a flush round writes */
+typedef struct {
+    uint32_t slot;
+    uint8_t copy;
+    uint64_t sequence;
+    pseudo_id_t player;
+    uint8_t* record;
+} flush_job_t;
+
+static struct {
+    bool open;
+    int fd;
+    size_t record_size;
+    size_t copy_size;           /* COPY_HEADER + record, rounded up to pages */
+    bool zlib_crc;              /* Version 1 file not upgraded yet */
+    uint8_t* map;               /* The whole file, read-only */
+    size_t map_size;
+    store_slot_t* slots;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t* slot_of;          /* By pseudo ID: slot + 1, 0 for none */
+    uint32_t slot_of_size;
+    uint32_t* dirty;            /* Slots with a pending record */
+    uint32_t dirty_count;
+    uint32_t dirty_capacity;
+    uint32_t in_flight;         /* Slots the running round writes; dirty keeps room for them */
+    uint64_t puts;
+    uint64_t written;
+    uint64_t syncs;
+    int interval_ms;
+    bool flushing;              /* A round is writing */
+    bool stop;
+    bool running;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* Flusher: stop */
+    pthread_cond_t done;        /* A round ended */
+} g_store = {
+    .fd = -1,
+    .interval_ms = PLAYER_STORE_FLUSH_INTERVAL_DEFAULT_MS,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static off_t copy_offset(uint32_t slot, uint8_t copy) {
+    return (off_t)PLAYER_STORE_PAGE_SIZE + ((off_t)slot * 2 + copy) * (off_t)g_store.copy_size;
+}
+
+static uint32_t copy_crc(const uint8_t* copy) {
+    return checksum_crc32c(0, copy + 4, COPY_HEADER + g_store.record_size - 4);
+}
+
+/* A copy written before the upgrade of a version 1 file may have either */
+static bool copy_zlib_valid(const uint8_t* copy) {
+    uint32_t crc;
+    memcpy(&crc, copy, sizeof(crc));
+    return g_store.zlib_crc && crc == (uint32_t)crc32(0L, copy + 4, (uInt)(COPY_HEADER + g_store.record_size - 4));
+}
+
+static bool copy_valid(const uint8_t* copy) {
+    uint32_t crc;
+    memcpy(&crc, copy, sizeof(crc));
+    return crc == copy_crc(copy) || copy_zlib_valid(copy);
+}
+
+static uint64_t get_sequence(const uint8_t* copy) {
+    uint64_t sequence;
+    memcpy(&sequence, copy + 8, sizeof(sequence));
+    return sequence;
+}
+
+/* The record in a slot's copy on disk, through the mapping */
+static const uint8_t* mapped_record(uint32_t slot) {
+    return g_store.map + copy_offset(slot, g_store.slots[slot].current) + COPY_HEADER;
+}
+
+/* ========== Index ========== */
+
+static bool grow(void** array, uint32_t* capacity, uint32_t needed, size_t item) {
+    if (needed <= *capacity) return true;
+    uint32_t grown = *capacity ? *capacity : 64;
+    while (grown < needed) grown *= 2;
+    void* p = realloc(*array, (size_t)grown * item);
+    if (!p) return false;
+    memset((uint8_t*)p + (size_t)*capacity * item, 0, (size_t)(grown - *capacity) * item);
+    *array = p;
+    *capacity = grown;
+    return true;
+}
+
+static store_slot_t* find_slot(pseudo_id_t player) {
+    if (player == PSEUDO_ID_NONE || player >= g_store.slot_of_size || g_store.slot_of[player] == 0) return NULL;
+    return &g_store.slots[g_store.slot_of[player] - 1];
+}
+
+static bool bind_slot(pseudo_id_t player, uint32_t slot) {
+    if (!grow((void**)&g_store.slot_of, &g_store.slot_of_size, player + 1, sizeof(uint32_t))) return false;
+    g_store.slot_of[player] = slot + 1;
+    g_store.slots[slot].player = player;
+    return true;
+}
+
+/* Map the file again after it grew; caller holds the lock */
+static bool remap(size_t size) {
+    if (g_store.map) munmap(g_store.map, g_store.map_size);
+    g_store.map = NULL;
+    g_store.map_size = 0;
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, g_store.fd, 0);
+    if (map == MAP_FAILED) return false;
+    g_store.map = map;
+    g_store.map_size = size;
+    return true;
+}
+
+/* A slot for a player stored for the first time: a free one, or a new one
+ * at the end of the file. Caller holds the lock. */
+static error_code_t new_slot(pseudo_id_t player, store_slot_t** out) {
+    uint32_t slot = 0;
+    while (slot < g_store.count && g_store.slots[slot].player != PSEUDO_ID_NONE) slot++;
+
+    if (slot == g_store.count) {
+        if (!grow((void**)&g_store.slots, &g_store.capacity, slot + 1, sizeof(store_slot_t))) {
+            return ERR_MAX_CAPACITY;
+        }
+        size_t size = (size_t)copy_offset(slot + 1, 0);
+        if (ftruncate(g_store.fd, (off_t)size) != 0 || !remap(size)) return ERR_NETWORK_ERROR;
+        memset(&g_store.slots[slot], 0, sizeof(store_slot_t));
+        g_store.count++;
+    }
+    if (!bind_slot(player, slot)) return ERR_MAX_CAPACITY;
+    *out = &g_store.slots[slot];
+    return SUCCESS;
+}
+
+/* Pick each slot's newest good copy; caller holds the lock */
+static void index_slots(void) {
+    for (uint32_t slot = 0; slot < g_store.count; slot++) {
+        store_slot_t* s = &g_store.slots[slot];
+        memset(s, 0, sizeof(*s));
+        for (uint8_t copy = 0; copy < 2; copy++) {
+            const uint8_t* p = g_store.map + copy_offset(slot, copy);
+            uint64_t sequence = get_sequence(p);
+            if (sequence <= s->sequence || !copy_valid(p)) continue;
+            s->sequence = sequence;
+            s->current = copy;
+        }
+        if (s->sequence == 0) continue;
+
+        char key[MAX_PSEUDO_LEN];
+        memcpy(key, g_store.map + copy_offset(slot, s->current) + COPY_KEY, MAX_PSEUDO_LEN);
+        key[MAX_PSEUDO_LEN - 1] = '\0';
+        pseudo_id_t player = pseudo_intern(key);
+        /* A name stored twice keeps its first slot; the other one is reused
+         * above its sequence, so its old copy is never picked again */
+        if (player != PSEUDO_ID_NONE && !find_slot(player)) bind_slot(player, slot);
+    }
+}
+
+/* Redo the CRC of every copy of a version 1 file that still has zlib's,
+ * then mark the file current. A crash before the header is written leaves
+ * it at version 1, where either CRC is good. Caller holds the lock. */
+static error_code_t upgrade_crcs(void) {
+    for (uint32_t slot = 0; slot < g_store.count; slot++) {
+        for (uint8_t copy = 0; copy < 2; copy++) {
+            const uint8_t* p = g_store.map + copy_offset(slot, copy);
+            if (get_sequence(p) == 0 || !copy_zlib_valid(p)) continue;
+            uint32_t crc = copy_crc(p);
+            if (pwrite(g_store.fd, &crc, sizeof(crc), copy_offset(slot, copy)) != (ssize_t)sizeof(crc)) {
+                return ERR_NETWORK_ERROR;
+            }
+        }
+    }
+    uint32_t version = STORE_VERSION;
+    if (fdatasync(g_store.fd) != 0 || pwrite(g_store.fd, &version, sizeof(version), 4) != (ssize_t)sizeof(version) ||
+        fdatasync(g_store.fd) != 0) {
+        return ERR_NETWORK_ERROR;
+    }
+    g_store.zlib_crc = false;
+    return SUCCESS;
+}
+
+/* The newest copy of a slot's record, or NULL if it has none yet; caller
+ * holds the lock */
+static const uint8_t* slot_record(uint32_t slot) {
+    store_slot_t* s = &g_store.slots[slot];
+    if (s->pending) return s->pending;
+    if (s->writing) return s->writing;
+    return s->sequence ? mapped_record(slot) : NULL;
+}
+
+/* ========== Flushing ========== */
+
+/* Write every pending record to its slot's older copy and sync them
+ * together. Caller holds the lock; it is released while writing. */
+static error_code_t flush_round(void) {
+    while (g_store.flushing) pthread_cond_wait(&g_store.done, &g_store.lock);
+    if (g_store.dirty_count == 0) return SUCCESS;
+
+    uint32_t count = g_store.dirty_count;
+    size_t copy_bytes = COPY_HEADER + g_store.record_size;
+    flush_job_t* jobs = malloc(count * sizeof(flush_job_t));
+    uint8_t* buffer = calloc(1, copy_bytes);
+    if (!jobs || !buffer) {
+        free(jobs);
+        free(buffer);
+        return ERR_MAX_CAPACITY;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        store_slot_t* s = &g_store.slots[g_store.dirty[i]];
+        s->writing = s->pending;
+        s->pending = NULL;
+        jobs[i] = (flush_job_t){ g_store.dirty[i], s->sequence ? (uint8_t)(s->current ^ 1) : 0, s->sequence + 1,
+                                 s->player, s->writing };
+    }
+    g_store.dirty_count = 0;
+    g_store.in_flight = count;
+    g_store.flushing = true;
+    pthread_mutex_unlock(&g_store.lock);
+
+    /* Without the lock: puts meanwhile fill new pending buffers */
+    bool ok = true;
+    for (uint32_t i = 0; i < count && ok; i++) {
+        memset(buffer, 0, COPY_HEADER);
+        memcpy(buffer + 8, &jobs[i].sequence, sizeof(jobs[i].sequence));
+        const char* name = pseudo_name(jobs[i].player);
+        if (name) strncpy((char*)buffer + COPY_KEY, name, MAX_PSEUDO_LEN - 1);
+        memcpy(buffer + COPY_HEADER, jobs[i].record, g_store.record_size);
+        uint32_t crc = copy_crc(buffer);
+        memcpy(buffer, &crc, sizeof(crc));
+        ok = pwrite(g_store.fd, buffer, copy_bytes, copy_offset(jobs[i].slot, jobs[i].copy)) == (ssize_t)copy_bytes;
+    }
+    if (ok) ok = fdatasync(g_store.fd) == 0;
+    free(buffer);
+
+    pthread_mutex_lock(&g_store.lock);
+    for (uint32_t i = 0; i < count; i++) {
+        store_slot_t* s = &g_store.slots[jobs[i].slot];
+        if (ok) {
+            s->current = jobs[i].copy;
+            s->sequence = jobs[i].sequence;
+            free(s->writing);
+            g_store.written++;
+        } else if (s->pending) {
+            free(s->writing);
+        } else {
+            /* Retried with the next round; puts kept room for it in the list */
+            s->pending = s->writing;
+            g_store.dirty[g_store.dirty_count++] = jobs[i].slot;
+        }
+        s->writing = NULL;
+    }
+    if (ok) g_store.syncs++;
+    g_store.in_flight = 0;
+    g_store.flushing = false;
+    pthread_cond_broadcast(&g_store.done);
+    free(jobs);
+    return ok ? SUCCESS : ERR_NETWORK_ERROR;
+}
+
+static void* flusher_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_store.lock);
+    while (!g_store.stop) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)g_store.interval_ms * 1000000;
+        ts.tv_sec += (time_t)(ns / 1000000000);
+        ts.tv_nsec = (long)(ns % 1000000000);
+        pthread_cond_timedwait(&g_store.wake, &g_store.lock, &ts);
+        if (g_store.stop) break;
+        if (flush_round() != SUCCESS) {
+            fprintf(stderr, "Warning: Failed to flush player store\n");
+        }
+    }
+    pthread_mutex_unlock(&g_store.lock);
+    return NULL;
+}
+
+/* ========== Public API ========== */
+
+/* Release everything; caller holds the lock and the flusher is stopped */
+static void release(void) {
+    for (uint32_t i = 0; i < g_store.count; i++) {
+        free(g_store.slots[i].pending);
+        free(g_store.slots[i].writing);
+    }
+    free(g_store.slots);
+    free(g_store.slot_of);
+    free(g_store.dirty);
+    if (g_store.map) munmap(g_store.map, g_store.map_size);
+    if (g_store.fd >= 0) close(g_store.fd);
+    g_store.slots = NULL;
+    g_store.slot_of = NULL;
+    g_store.dirty = NULL;
+    g_store.map = NULL;
+    g_store.map_size = 0;
+    g_store.fd = -1;
+    g_store.count = g_store.capacity = g_store.slot_of_size = 0;
+    g_store.dirty_count = g_store.dirty_capacity = 0;
+    g_store.open = false;
+}
+
+static error_code_t open_file(const char* path, bool* created) {
+    g_store.fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (g_store.fd < 0) return ERR_NETWORK_ERROR;
+
+    struct stat st;
+    if (fstat(g_store.fd, &st) != 0) return ERR_NETWORK_ERROR;
+
+    uint8_t header[PLAYER_STORE_PAGE_SIZE] = {0};
+    uint32_t magic = STORE_MAGIC, version = STORE_VERSION;
+    uint64_t record_size = g_store.record_size;
+    *created = st.st_size == 0;
+    if (*created) {
+        memcpy(header, &magic, sizeof(magic));
+        memcpy(header + 4, &version, sizeof(version));
+        memcpy(header + 8, &record_size, sizeof(record_size));
+        if (pwrite(g_store.fd, header, sizeof(header), 0) != (ssize_t)sizeof(header) || fdatasync(g_store.fd) != 0) {
+            return ERR_NETWORK_ERROR;
+        }
+        st.st_size = sizeof(header);
+    } else {
+        if (pread(g_store.fd, header, sizeof(header), 0) != (ssize_t)sizeof(header)) return ERR_SERIALIZATION;
+        uint32_t found;
+        memcpy(&found, header + 4, sizeof(found));
+        g_store.zlib_crc = found == STORE_VERSION_CRC32;
+        if (memcmp(header, &magic, sizeof(magic)) != 0 || (found != version && !g_store.zlib_crc) ||
+            memcmp(header + 8, &record_size, sizeof(record_size)) != 0) {
+            return ERR_SERIALIZATION;
+        }
+    }
+
+    /* A slot cut short by a crash while the file grew held no record yet */
+    uint64_t slots = ((uint64_t)st.st_size - PLAYER_STORE_PAGE_SIZE) / (2 * g_store.copy_size);
+    size_t size = (size_t)copy_offset((uint32_t)slots, 0);
+    if ((uint64_t)st.st_size != size && ftruncate(g_store.fd, (off_t)size) != 0) return ERR_NETWORK_ERROR;
+    if (!remap(size)) return ERR_NETWORK_ERROR;
+    if (!grow((void**)&g_store.slots, &g_store.capacity, (uint32_t)slots, sizeof(store_slot_t))) {
+        return ERR_MAX_CAPACITY;
+    }
+    g_store.count = (uint32_t)slots;
+    index_slots();
+    return g_store.zlib_crc ? upgrade_crcs() : SUCCESS;
+}
+
+error_code_t player_store_open(const char* path, size_t record_size, bool* created) {
+    if (!path || record_size == 0 || !created) return ERR_INVALID_PARAM;
+    player_store_close();
+
+    pthread_mutex_lock(&g_store.lock);
+    g_store.record_size = record_size;
+    g_store.copy_size = (COPY_HEADER + record_size + PLAYER_STORE_PAGE_SIZE - 1) /
+                        PLAYER_STORE_PAGE_SIZE * PLAYER_STORE_PAGE_SIZE;
+    g_store.puts = g_store.written = g_store.syncs = 0;
+    g_store.stop = g_store.flushing = g_store.zlib_crc = false;
+    g_store.open = true;
+    error_code_t err = open_file(path, created);
+    if (err != SUCCESS) {
+        release();
+        pthread_mutex_unlock(&g_store.lock);
+        return err;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_store.wake, &attr);
+    pthread_cond_init(&g_store.done, &attr);
+    pthread_condattr_destroy(&attr);
+
+    g_store.running = pthread_create(&g_store.thread, NULL, flusher_main, NULL) == 0;
+    if (!g_store.running) {
+        pthread_cond_destroy(&g_store.wake);
+        pthread_cond_destroy(&g_store.done);
+        release();
+        pthread_mutex_unlock(&g_store.lock);
+        return ERR_MAX_CAPACITY;
+    }
+    pthread_mutex_unlock(&g_store.lock);
+    return SUCCESS;
+}
+
+void player_store_close(void) {
+    pthread_mutex_lock(&g_store.lock);
+    if (!g_store.open) {
+        pthread_mutex_unlock(&g_store.lock);
+        return;
+    }
+    g_store.stop = true;
+    pthread_cond_signal(&g_store.wake);
+    pthread_mutex_unlock(&g_store.lock);
+    if (g_store.running) pthread_join(g_store.thread, NULL);
+    g_store.running = false;
+
+    pthread_mutex_lock(&g_store.lock);
+    if (flush_round() != SUCCESS) {
+        fprintf(stderr, "Warning: Failed to flush player store\n");
+    }
+    pthread_cond_destroy(&g_store.wake);
+    pthread_cond_destroy(&g_store.done);
+    release();
+    pthread_mutex_unlock(&g_store.lock);
+}
+
+void player_store_set_flush_interval(int interval_ms) {
+    pthread_mutex_lock(&g_store.lock);
+    g_store.interval_ms = interval_ms > 0 ? interval_ms : PLAYER_STORE_FLUSH_INTERVAL_DEFAULT_MS;
+    pthread_mutex_unlock(&g_store.lock);
+}
+
+error_code_t player_store_get(pseudo_id_t player, void* record) {
+    if (!record) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&g_store.lock);
+    if (!g_store.open) {
+        pthread_mutex_unlock(&g_store.lock);
+        return ERR_INVALID_PARAM;
+    }
+    store_slot_t* s = find_slot(player);
+    const uint8_t* src = s ? slot_record((uint32_t)(s - g_store.slots)) : NULL;
+    if (src) memcpy(record, src, g_store.record_size);
+    pthread_mutex_unlock(&g_store.lock);
+    return src ? SUCCESS : ERR_PLAYER_NOT_FOUND;
+}
+
+error_code_t player_store_put(pseudo_id_t player, const void* record) {
+    if (player == PSEUDO_ID_NONE || !record) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&g_store.lock);
+    if (!g_store.open) {
+        pthread_mutex_unlock(&g_store.lock);
+        return ERR_INVALID_PARAM;
+    }
+    store_slot_t* s = find_slot(player);
+    if (!s || !s->pending) {
+        /* Everything a new slot needs is ready before it is bound */
+        uint8_t* pending = malloc(g_store.record_size);
+        error_code_t err = pending ? SUCCESS : ERR_MAX_CAPACITY;
+        /* Room for the running round's slots too: a failed round puts them
+         * back in the list, next to whatever was stored meanwhile */
+        if (err == SUCCESS && !grow((void**)&g_store.dirty, &g_store.dirty_capacity,
+                                    g_store.dirty_count + g_store.in_flight + 1, sizeof(uint32_t))) {
+            err = ERR_MAX_CAPACITY;
+        }
+        if (err == SUCCESS && !s) err = new_slot(player, &s);
+        if (err != SUCCESS) {
+            free(pending);
+            pthread_mutex_unlock(&g_store.lock);
+            return err;
+        }
+        s->pending = pending;
+        g_store.dirty[g_store.dirty_count++] = (uint32_t)(s - g_store.slots);
+    }
+    memcpy(s->pending, record, g_store.record_size);
+    g_store.puts++;
+    pthread_mutex_unlock(&g_store.lock);
+    return SUCCESS;
+}
+
+error_code_t player_store_flush(void) {
+    pthread_mutex_lock(&g_store.lock);
+    error_code_t err = g_store.open ? flush_round() : ERR_INVALID_PARAM;
+    pthread_mutex_unlock(&g_store.lock);
+    return err;
+}
+
+error_code_t player_store_each(void (*visit)(pseudo_id_t player, const void* record, void* arg), void* arg) {
+    if (!visit) return ERR_INVALID_PARAM;
+
+    pthread_mutex_lock(&g_store.lock);
+    if (!g_store.open) {
+        pthread_mutex_unlock(&g_store.lock);
+        return ERR_INVALID_PARAM;
+    }
+    for (uint32_t slot = 0; slot < g_store.count; slot++) {
+        const uint8_t* record = g_store.slots[slot].player != PSEUDO_ID_NONE ? slot_record(slot) : NULL;
+        if (record) visit(g_store.slots[slot].player, record, arg);
+    }
+    pthread_mutex_unlock(&g_store.lock);
+    return SUCCESS;
+}
+
+void player_store_get_stats(player_store_stats_t* stats) {
+    if (!stats) return;
+    pthread_mutex_lock(&g_store.lock);
+    memset(stats, 0, sizeof(*stats));
+    for (uint32_t slot = 0; g_store.open && slot < g_store.count; slot++) {
+        if (g_store.slots[slot].player != PSEUDO_ID_NONE && slot_record(slot)) stats->records++;
+    }
+    stats->dirty = g_store.dirty_count;
+    stats->puts = g_store.puts;
+    stats->written = g_store.written;
+    stats->syncs = g_store.syncs;
+    pthread_mutex_unlock(&g_store.lock);
+}
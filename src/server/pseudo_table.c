@@ -0,0 +1,146 @@
+/* Pseudo Table Implementation
+ * Names live in fixed-size chunks that are never moved or freed, so
+ * pseudo_name needs no lock. The hash index (open addressing, FNV-1a)
+ * doubles when half full and is guarded by a read-write lock.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../../include/server/pseudo_table.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PSEUDO_CHUNK_SIZE 256
+#define PSEUDO_MAX_CHUNKS 4096      /* Up to ~1M distinct pseudos */
+#define PSEUDO_INITIAL_SLOTS 512
+
+typedef char pseudo_chunk_t[PSEUDO_CHUNK_SIZE][MAX_PSEUDO_LEN];
+
+static struct {
+    pseudo_chunk_t* chunks[PSEUDO_MAX_CHUNKS];
+    uint32_t count;                 /* IDs 1..count are assigned */
+    uint32_t* slots;                /* ID or 0 (empty) */
+    uint32_t slot_count;            /* Power of two */
+    pthread_rwlock_t lock;
+} g_table = { .lock = PTHREAD_RWLOCK_INITIALIZER };
+
+static uint32_t hash_pseudo(const char* pseudo) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)pseudo; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static char* name_slot(uint32_t id) {
+    uint32_t index = id - 1;
+    return (*g_table.chunks[index / PSEUDO_CHUNK_SIZE])[index % PSEUDO_CHUNK_SIZE];
+}
+
+/* Caller holds the lock; returns the slot holding `pseudo` or the empty
+ * slot where it would go */
+static uint32_t* find_slot(const char* pseudo, uint32_t hash) {
+    uint32_t mask = g_table.slot_count - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        uint32_t id = g_table.slots[i];
+        if (id == PSEUDO_ID_NONE || strcmp(name_slot(id), pseudo) == 0) {
+            return &g_table.slots[i];
+        }
+    }
+}
+
+static pseudo_id_t lookup_locked(const char* pseudo, uint32_t hash) {
+    if (!g_table.slots) return PSEUDO_ID_NONE;
+    return *find_slot(pseudo, hash);
+}
+
+/* Caller holds the write lock */
+static bool grow_index(void) {
+    uint32_t slot_count = g_table.slot_count ? g_table.slot_count * 2 : PSEUDO_INITIAL_SLOTS;
+    uint32_t* slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) return false;
+
+    uint32_t* old = g_table.slots;
+    g_table.slots = slots;
+    g_table.slot_count = slot_count;
+    for (uint32_t id = 1; id <= g_table.count; id++) {
+        const char* name = name_slot(id);
+        *find_slot(name, hash_pseudo(name)) = id;
+    }
+    free(old);
+    return true;
+}
+
+/* Pseudos are stored as char[MAX_PSEUDO_LEN]; a longer one is the same
+ * player as its truncation */
+static void make_key(const char* pseudo, char key[MAX_PSEUDO_LEN]) {
+    strncpy(key, pseudo, MAX_PSEUDO_LEN - 1);
+    key[MAX_PSEUDO_LEN - 1] = '\0';
+}
+
+pseudo_id_t pseudo_intern(const char* raw) {
+    if (!raw || raw[0] == '\0') return PSEUDO_ID_NONE;
+    char pseudo[MAX_PSEUDO_LEN];
+    make_key(raw, pseudo);
+    uint32_t hash = hash_pseudo(pseudo);
+
+    pthread_rwlock_rdlock(&g_table.lock);
+    pseudo_id_t id = lookup_locked(pseudo, hash);
+    pthread_rwlock_unlock(&g_table.lock);
+    if (id != PSEUDO_ID_NONE) return id;
+
+    pthread_rwlock_wrlock(&g_table.lock);
+    /* Another thread may have added it meanwhile */
+    id = lookup_locked(pseudo, hash);
+    if (id != PSEUDO_ID_NONE) {
+        pthread_rwlock_unlock(&g_table.lock);
+        return id;
+    }
+
+    uint32_t index = g_table.count;
+    if ((g_table.count + 1) * 2 > g_table.slot_count && !grow_index()) {
+        pthread_rwlock_unlock(&g_table.lock);
+        return PSEUDO_ID_NONE;
+    }
+    if (index % PSEUDO_CHUNK_SIZE == 0) {
+        if (index / PSEUDO_CHUNK_SIZE >= PSEUDO_MAX_CHUNKS) {
+            pthread_rwlock_unlock(&g_table.lock);
+            return PSEUDO_ID_NONE;
+        }
+        pseudo_chunk_t* chunk = calloc(1, sizeof(pseudo_chunk_t));
+        if (!chunk) {
+            pthread_rwlock_unlock(&g_table.lock);
+            return PSEUDO_ID_NONE;
+        }
+        g_table.chunks[index / PSEUDO_CHUNK_SIZE] = chunk;
+    }
+
+    id = index + 1;
+    memcpy(name_slot(id), pseudo, MAX_PSEUDO_LEN);
+    *find_slot(pseudo, hash) = id;
+    __atomic_store_n(&g_table.count, id, __ATOMIC_RELEASE);
+
+    pthread_rwlock_unlock(&g_table.lock);
+    return id;
+}
+
+pseudo_id_t pseudo_lookup(const char* raw) {
+    if (!raw || raw[0] == '\0') return PSEUDO_ID_NONE;
+    char pseudo[MAX_PSEUDO_LEN];
+    make_key(raw, pseudo);
+    uint32_t hash = hash_pseudo(pseudo);
+
+    pthread_rwlock_rdlock(&g_table.lock);
+    pseudo_id_t id = lookup_locked(pseudo, hash);
+    pthread_rwlock_unlock(&g_table.lock);
+    return id;
+}
+
+const char* pseudo_name(pseudo_id_t id) {
+    /* Whoever holds an ID got it after the name was written */
+    uint32_t count = __atomic_load_n(&g_table.count, __ATOMIC_ACQUIRE);
+    if (id == PSEUDO_ID_NONE || id > count) return "";
+    return name_slot(id);
+}
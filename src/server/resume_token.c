@@ -0,0 +1,140 @@
+/* Resumption Tokens Implementation
+ * SipHash-2-4 (Aumasson & Bernstein) as the MAC; it is short-input fast and
+ * needs no crypto library.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "../../include/server/resume_token.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+static uint8_t g_key[16];
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+
+static void fill_random(void* buffer, size_t size) {
+    uint8_t* out = (uint8_t*)buffer;
+    while (size > 0) {
+        ssize_t n = getrandom(out, size, 0);
+        if (n <= 0) break;
+        out += n;
+        size -= (size_t)n;
+    }
+    if (size == 0) return;
+
+    /* No entropy source: still unique per process, just not secret */
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t seed = (uint64_t)ts.tv_nsec ^ ((uint64_t)ts.tv_sec << 20) ^ ((uint64_t)getpid() << 40);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        out[i] = (uint8_t)(seed >> 56);
+    }
+}
+
+static void init_key(void) {
+    fill_random(g_key, sizeof(g_key));
+}
+
+#define ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND                                                        \
+    do {                                                                \
+        v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32);   \
+        v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;                        \
+        v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;                        \
+        v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32);   \
+    } while (0)
+
+static uint64_t load_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+uint64_t siphash24(const uint8_t key[16], const void* data, size_t size) {
+    const uint8_t* in = (const uint8_t*)data;
+    uint64_t k0 = load_le64(key);
+    uint64_t k1 = load_le64(key + 8);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    size_t blocks = size / 8;
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t m = load_le64(in + i * 8);
+        v3 ^= m;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= m;
+    }
+
+    /* Last block: remaining bytes, length in the top byte */
+    uint64_t b = (uint64_t)size << 56;
+    const uint8_t* tail = in + blocks * 8;
+    for (size_t i = 0; i < (size & 7); i++) {
+        b |= (uint64_t)tail[i] << (8 * i);
+    }
+    v3 ^= b;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/* MAC input: pseudo, a NUL, the nonce little-endian */
+static uint64_t token_mac(const char* pseudo, uint64_t nonce) {
+    uint8_t message[MAX_PSEUDO_LEN + 1 + 8];
+    size_t len = strnlen(pseudo, MAX_PSEUDO_LEN);
+    memcpy(message, pseudo, len);
+    message[len] = '\0';
+    for (int i = 0; i < 8; i++) {
+        message[len + 1 + i] = (uint8_t)(nonce >> (8 * i));
+    }
+
+    pthread_once(&g_key_once, init_key);
+    return siphash24(g_key, message, len + 1 + 8);
+}
+
+error_code_t resume_token_issue(const char* pseudo, char* token, size_t token_size) {
+    if (!pseudo || !token || token_size <= RESUME_TOKEN_LEN) return ERR_INVALID_PARAM;
+
+    uint64_t nonce;
+    fill_random(&nonce, sizeof(nonce));
+    snprintf(token, token_size, "%016llx%016llx", (unsigned long long)nonce,
+             (unsigned long long)token_mac(pseudo, nonce));
+    return SUCCESS;
+}
+
+static bool parse_hex64(const char* text, uint64_t* value) {
+    uint64_t v = 0;
+    for (int i = 0; i < 16; i++) {
+        char c = text[i];
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else return false;
+        v = (v << 4) | (uint64_t)digit;
+    }
+    *value = v;
+    return true;
+}
+
+bool resume_token_verify(const char* pseudo, const char* token) {
+    if (!pseudo || !token || strnlen(token, RESUME_TOKEN_LEN + 1) != RESUME_TOKEN_LEN) return false;
+
+    uint64_t nonce, mac;
+    if (!parse_hex64(token, &nonce) || !parse_hex64(token + 16, &mac)) return false;
+    return mac == token_mac(pseudo, nonce);
+}
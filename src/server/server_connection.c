@@ -5,6 +5,7 @@
 #include "../../include/server/server_connection.h"
 #include "../../include/server/server_registry.h"
 #include "../../include/server/server_handlers.h"
+#include "../../include/server/admission.h"
 #include "../../include/common/messages.h"
 #include "../../include/common/protocol.h"
 #include "../../include/network/session.h"
@@ -19,13 +20,6 @@ void handle_notification_message(message_type_t type, const void* payload, size_
     /* Server doesn't handle notifications */
 }
 
-/* Client handler structure */
-typedef struct {
-    connection_t conn;
-    char pseudo[MAX_PSEUDO_LEN];
-    pthread_t thread;
-} client_handler_t;
-
 /* Global state for connection manager */
 static game_manager_t* g_game_manager = NULL;
 static matchmaking_t* g_matchmaking = NULL;
@@ -56,13 +50,19 @@ void* client_handler(void* arg) {
     memcpy(&session.conn, &handler->conn, sizeof(connection_t));
     strncpy(session.pseudo, handler->pseudo, MAX_PSEUDO_LEN - 1);
     session.pseudo[MAX_PSEUDO_LEN - 1] = '\0';
+    session.player_id = pseudo_intern(session.pseudo);
+    snprintf(session.session_id, sizeof(session.session_id), "%s", handler->session_id);
+    session.codec = handler->codec;
+    session.features = handler->features;
     session.authenticated = true;
     
     printf("Client thread started for %s\n", session.pseudo);
     
-    /* Register session for push notifications */
-    if (!session_registry_add(&session)) {
+    /* Register session for push notifications; pushes are kept for replay */
+    session.backlog = session_backlog_create();
+    if (!session.backlog || !session_registry_add(&session)) {
     printf("Failed to register session for %s (max sessions reached)\n", session.pseudo);
+        session_backlog_destroy(session.backlog);
         session_close(&session);
         free(handler);
         return NULL;
@@ -71,9 +71,15 @@ void* client_handler(void* arg) {
     time_t last_check = time(NULL);
     const time_t CHECK_INTERVAL = 60;  /* Check connection health every 60 seconds */
     
-    /* Main message loop */
+    /* Kept across a resume so reconnecting does not refill the buckets */
+    admission_t admission;
+    admission_init(&admission);
+    
+    /* Main message loop; entered again after a resume */
+receive:
     while (*g_running && session_is_active(&session)) {
         message_type_t msg_type;
+        uint32_t msg_sequence = 0;
         char payload[MAX_PAYLOAD_SIZE];
         size_t payload_size;
         
@@ -89,8 +95,8 @@ void* client_handler(void* arg) {
         }
         
         /* Use timeout to allow periodic connection checking */
-        error_code_t err = session_recv_message_timeout(&session, &msg_type, payload,
-                                                        MAX_PAYLOAD_SIZE, &payload_size, 5000, NULL, 0);
+        error_code_t err = session_recv_tagged_timeout(&session, &msg_type, &msg_sequence, payload,
+                                                       MAX_PAYLOAD_SIZE, &payload_size, 5000);
         
         if (err == ERR_TIMEOUT) {
             /* Normal timeout - continue loop to check connection health */
@@ -106,6 +112,32 @@ void* client_handler(void* arg) {
             break;
         }
         
+        /* Responses sent while handling this request echo its sequence number;
+         * everything sent back to this client during it leaves in one write */
+        session_begin_reply(&session, msg_sequence);
+        session_batch_begin(&session);
+        
+        /* Refuse before doing any of the work */
+        uint32_t retry_ms = 0;
+        bool shed = false;
+        if (admission_begin(&admission, msg_type, payload, payload_size, &retry_ms, &shed) != SUCCESS) {
+            admission_class_t cls = admission_classify(msg_type, payload, payload_size);
+            if (!admission.limited) {
+                if (shed) {
+                    printf("Overload level %d: shedding %s requests from %s\n",
+                           admission_overload_level(), admission_class_name(cls), session.pseudo);
+                } else {
+                    printf("Rate limiting %s (%s requests)\n", session.pseudo, admission_class_name(cls));
+                }
+            }
+            admission.limited = true;
+            session_send_rate_limited(&session, retry_ms, shed ? "Server busy" : "Too many requests");
+            session_end_reply();
+            session_batch_flush();
+            continue;
+        }
+        admission.limited = false;
+        
         /* Route message to appropriate handler */
         switch (msg_type) {
             case MSG_LIST_PLAYERS:
@@ -158,6 +190,12 @@ void* client_handler(void* arg) {
                 break;
             }
             
+            case MSG_BOARD_RESYNC: {
+                msg_board_resync_t* req = (msg_board_resync_t*)payload;
+                handle_board_resync(&session, req);
+                break;
+            }
+            
             case MSG_LIST_GAMES:
                 handle_list_games(&session);
                 break;
@@ -168,13 +206,13 @@ void* client_handler(void* arg) {
                 
             case MSG_SPECTATE_GAME: {
                 msg_spectate_game_t* req = (msg_spectate_game_t*)payload;
-                handle_spectate_game(&session, req->game_id);
+                handle_spectate_game(&session, req->game);
                 break;
             }
             
             case MSG_STOP_SPECTATE: {
                 msg_spectate_game_t* req = (msg_spectate_game_t*)payload;
-                handle_stop_spectate(&session, req->game_id);
+                handle_stop_spectate(&session, req->game);
                 break;
             }
             
@@ -230,8 +268,21 @@ void* client_handler(void* arg) {
                 break;
             }
 
+            case MSG_LIST_PAGE: {
+                if (payload_size < sizeof(msg_list_page_t)) {
+                    session_send_error(&session, ERR_INVALID_PARAM, "Malformed list request");
+                    break;
+                }
+                msg_list_page_t* req = (msg_list_page_t*)payload;
+                handle_list_page(&session, req);
+                break;
+            }
+
             case MSG_DISCONNECT:
                 printf("Client %s requested disconnect\n", session.pseudo);
+                admission_end();
+                session_end_reply();
+                session_batch_flush();
                 goto cleanup;
                 
             default:
@@ -239,6 +290,20 @@ void* client_handler(void* arg) {
                 session_send_error(&session, ERR_UNKNOWN, "Unknown message type");
                 break;
         }
+        
+        admission_end();
+        session_end_reply();
+        session_batch_flush();
+    }
+    
+    /* Dropped rather than logged out: hold the session for a resume */
+    if (*g_running) {
+        printf("Client %s dropped, holding session for %d s\n", session.pseudo, RESUME_GRACE_SEC);
+        if (session_registry_await_resume(&session, RESUME_GRACE_SEC)) {
+            printf("Client %s resumed its session\n", session.pseudo);
+            last_check = time(NULL);
+            goto receive;
+        }
     }
     
 cleanup:
@@ -246,18 +311,23 @@ cleanup:
     
     /* Clean up all server-side resources for this client */
     session_registry_remove(&session);
-    matchmaking_remove_player(g_matchmaking, session.pseudo);
     
-    /* Remove player from any active games as spectator */
-    for (int i = 0; i < g_game_manager->game_count; i++) {
-        if (g_game_manager->games[i].active) {
-            game_manager_remove_spectator(g_game_manager, 
-                                         g_game_manager->games[i].game_id, 
-                                         session.pseudo);
+    /* No player left when a fresh login took it over while we waited */
+    if (session.player_id != PSEUDO_ID_NONE) {
+        matchmaking_remove_player(g_matchmaking, session.player_id);
+        
+        /* Remove player from any active games as spectator */
+        for (int i = 0; i < MAX_GAMES; i++) {
+            if (g_game_manager->games[i].active) {
+                game_manager_remove_spectator(g_game_manager, 
+                                             g_game_manager->games[i].handle, 
+                                             session.player_id);
+            }
         }
     }
     
     session_close(&session);
+    session_backlog_destroy(session.backlog);
     free(handler);
     
     return NULL;
@@ -7,10 +7,12 @@
 #include "../../include/server/matchmaking.h"
 #include "../../include/server/storage.h"
 #include "../../include/game/board.h"
+#include "../../include/network/board_delta.h"
 #include "../../include/common/protocol.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <stddef.h>
 
 /* Global managers (set via handlers_init) */
 static game_manager_t* g_game_manager = NULL;
@@ -21,43 +23,233 @@ void handlers_init(game_manager_t* game_mgr, matchmaking_t* matchmaking) {
     g_matchmaking = matchmaking;
 }
 
-/* Handle MSG_LIST_PLAYERS */
-void handle_list_players(session_t* session) {
-    msg_player_list_t list;
-    int count;
+/* ========== Paged lists ========== */
+
+/* One frame of any list response */
+typedef union {
+    msg_player_list_t players;
+    msg_challenge_list_t challenges;
+    msg_game_list_t games;
+    msg_list_friends_t friends;
+} list_frame_t;
+
+/* Fill `frame` with up to max entries from `cursor` on. Cursors are 64-bit
+ * for the saved games' log IDs; the other lists resume at a slot index. */
+typedef error_code_t (*list_fill_fn)(session_t* session, const msg_list_page_t* req, uint64_t cursor,
+                                     int max, list_frame_t* frame, int* count, uint64_t* next_cursor);
+
+typedef struct {
+    message_type_t request;    /* msg_list_page_t.list_type */
+    message_type_t response;   /* Type of every frame */
+    int capacity;              /* Entries the response struct holds */
+    size_t header;             /* Offset of the entry array */
+    size_t item;               /* Raw size of one entry */
+    list_fill_fn fill;
+    const char* error_msg;
+} list_endpoint_t;
+
+#define LIST_CAPACITY(type, field) ((int)(sizeof(((type*)0)->field) / sizeof(((type*)0)->field[0])))
+
+/* Slot lists take a 32-bit index; a cursor past every slot lists nothing */
+static uint32_t slot_cursor(uint64_t cursor) {
+    return cursor > UINT32_MAX ? UINT32_MAX : (uint32_t)cursor;
+}
 
-    /* Get full player info */
-    player_info_t full_players[100];
-    error_code_t err = matchmaking_get_players(g_matchmaking, full_players, 100, &count);
-    if (err == SUCCESS) {
-        list.count = count;
+static error_code_t fill_players(session_t* session, const msg_list_page_t* req, uint64_t cursor,
+                                 int max, list_frame_t* frame, int* count, uint64_t* next_cursor) {
+    (void)session; (void)req;
+    uint32_t next;
+    error_code_t err = matchmaking_list_players(g_matchmaking, slot_cursor(cursor), frame->players.players, max,
+                                                count, &next);
+    *next_cursor = next;
+    frame->players.count = *count;
+    return err;
+}
 
-        /* Copy only pseudo and ip to the list */
-        for (int i = 0; i < count; i++) {
-            memcpy(list.players[i].pseudo, full_players[i].pseudo, MAX_PSEUDO_LEN);
-            memcpy(list.players[i].ip, full_players[i].ip, MAX_IP_LEN);
-        }
+static error_code_t fill_games(session_t* session, const msg_list_page_t* req, uint64_t cursor,
+                               int max, list_frame_t* frame, int* count, uint64_t* next_cursor) {
+    (void)session; (void)req;
+    uint32_t next;
+    error_code_t err = game_manager_list_games(g_game_manager, PSEUDO_ID_NONE, slot_cursor(cursor),
+                                               frame->games.games, max, count, &next);
+    *next_cursor = next;
+    frame->games.count = *count;
+    return err;
+}
 
-        /* Calculate actual size: count field + only the actual number of players */
-        size_t actual_size = sizeof(list.count) + (count * sizeof(player_list_item_t));
+static error_code_t fill_my_games(session_t* session, const msg_list_page_t* req, uint64_t cursor,
+                                  int max, list_frame_t* frame, int* count, uint64_t* next_cursor) {
+    (void)req;
+    uint32_t next;
+    error_code_t err = game_manager_list_games(g_game_manager, session->player_id, slot_cursor(cursor),
+                                               frame->games.games, max, count, &next);
+    *next_cursor = next;
+    frame->games.count = *count;
+    return err;
+}
 
-        /* Validate payload size */
-        if (actual_size > MAX_PAYLOAD_SIZE) {
-            session_send_error(session, ERR_INVALID_PARAM, "Too many players to list");
-            return;
+static error_code_t fill_challengers(session_t* session, const msg_list_page_t* req, uint64_t cursor,
+                                     int max, list_frame_t* frame, int* count, uint64_t* next_cursor) {
+    (void)req;
+    uint32_t next;
+    error_code_t err = matchmaking_list_challengers(g_matchmaking, session->player_id, slot_cursor(cursor),
+                                                    frame->challenges.challengers, max, count, &next);
+    *next_cursor = next;
+    frame->challenges.count = *count;
+    return err;
+}
+
+static error_code_t fill_friends(session_t* session, const msg_list_page_t* req, uint64_t cursor,
+                                 int max, list_frame_t* frame, int* count, uint64_t* next_cursor) {
+    (void)req;
+    uint32_t next;
+    error_code_t err = matchmaking_list_friends(g_matchmaking, session->player_id, slot_cursor(cursor),
+                                                frame->friends.friends, max, count, &next);
+    *next_cursor = next;
+    frame->friends.count = *count;
+    return err;
+}
+
+static error_code_t fill_saved_games(session_t* session, const msg_list_page_t* req, uint64_t cursor,
+                                     int max, list_frame_t* frame, int* count, uint64_t* next_cursor) {
+    (void)session;
+    error_code_t err = storage_list_saved_games_page(req->player, cursor, frame->games.games, max,
+                                                     count, next_cursor);
+    frame->games.count = *count;
+    return err;
+}
+
+static const list_endpoint_t g_list_endpoints[] = {
+    {MSG_LIST_PLAYERS, MSG_PLAYER_LIST, LIST_CAPACITY(msg_player_list_t, players),
+     offsetof(msg_player_list_t, players), sizeof(player_list_item_t), fill_players,
+     "Failed to get player list"},
+    {MSG_LIST_GAMES, MSG_GAME_LIST, LIST_CAPACITY(msg_game_list_t, games),
+     offsetof(msg_game_list_t, games), sizeof(game_info_t), fill_games,
+     "Failed to list games"},
+    {MSG_LIST_MY_GAMES, MSG_MY_GAME_LIST, LIST_CAPACITY(msg_my_game_list_t, games),
+     offsetof(msg_my_game_list_t, games), sizeof(game_info_t), fill_my_games,
+     "Failed to list games"},
+    {MSG_GET_CHALLENGES, MSG_CHALLENGE_LIST, LIST_CAPACITY(msg_challenge_list_t, challengers),
+     offsetof(msg_challenge_list_t, challengers), MAX_PSEUDO_LEN, fill_challengers,
+     "Failed to list challenges"},
+    {MSG_LIST_FRIENDS, MSG_LIST_FRIENDS, LIST_CAPACITY(msg_list_friends_t, friends),
+     offsetof(msg_list_friends_t, friends), MAX_PSEUDO_LEN, fill_friends,
+     "Failed to get player info"},
+    {MSG_LIST_SAVED_GAMES, MSG_SAVED_GAME_LIST, LIST_CAPACITY(msg_saved_game_list_t, games),
+     offsetof(msg_saved_game_list_t, games), sizeof(game_info_t), fill_saved_games,
+     "Failed to list saved games"},
+};
+
+static const list_endpoint_t* list_endpoint_find(int32_t list_type) {
+    for (size_t i = 0; i < sizeof(g_list_endpoints) / sizeof(g_list_endpoints[0]); i++) {
+        if ((int32_t)g_list_endpoints[i].request == list_type) return &g_list_endpoints[i];
+    }
+    return NULL;
+}
+
+/* Entries per frame: compact frames are decoded back into the raw struct,
+ * so every codec is held to what a raw frame can carry */
+static int list_frame_capacity(const list_endpoint_t* endpoint, uint32_t limit) {
+    int max = endpoint->capacity;
+    int fit = (int)((MAX_PAYLOAD_SIZE - endpoint->header) / endpoint->item);
+    if (fit < max) max = fit;
+    if (limit > 0 && limit < (uint32_t)max) max = (int)limit;
+    return max;
+}
+
+/* Send list frames from req->cursor on: one, or all that remain when
+ * streaming. Only one frame is ever held, whatever the list length. */
+static error_code_t send_list_frames(session_t* session, const list_endpoint_t* endpoint,
+                                     const msg_list_page_t* req, bool stream, msg_list_end_t* end) {
+    list_frame_t frame;
+    uint64_t cursor = req->cursor;
+    int per_frame = list_frame_capacity(endpoint, req->limit);
+
+    memset(end, 0, sizeof(*end));
+    end->list_type = endpoint->request;
+
+    do {
+        int max = per_frame;
+        int count;
+        uint64_t next_cursor;
+        error_code_t err;
+
+        for (;;) {
+            memset(&frame, 0, sizeof(frame));
+            err = endpoint->fill(session, req, cursor, max, &frame, &count, &next_cursor);
+            if (err != SUCCESS) return err;
+
+            err = session_send_message(session, endpoint->response, &frame,
+                                       endpoint->header + (size_t)count * endpoint->item);
+            /* Varint fields can encode longer than raw: retry with fewer */
+            if (err == ERR_SERIALIZATION && count > 1) {
+                max = count / 2;
+                continue;
+            }
+            break;
         }
+        if (err != SUCCESS) return err;
 
-        printf("Sending player list with %d players, size %zu\n", count, actual_size);
-        session_send_message(session, MSG_PLAYER_LIST, &list, actual_size);
-    } else {
-        session_send_error(session, err, "Failed to get player list");
+        end->frames++;
+        end->entries += (uint32_t)count;
+        cursor = next_cursor;
+    } while (stream && cursor != 0);
+
+    end->next_cursor = cursor;
+    return SUCCESS;
+}
+
+/* Legacy list requests get the first frame only; paged ones are closed
+ * with MSG_LIST_END so the client knows where to resume */
+static void serve_list(session_t* session, const msg_list_page_t* req, bool paged) {
+    const list_endpoint_t* endpoint = list_endpoint_find(req->list_type);
+    if (!endpoint) {
+        session_send_error(session, ERR_INVALID_PARAM, "Not a list request");
+        return;
     }
+
+    msg_list_end_t end;
+    bool stream = paged && (req->flags & LIST_FLAG_STREAM);
+    error_code_t err = send_list_frames(session, endpoint, req, stream, &end);
+    if (err != SUCCESS) {
+        session_send_error(session, err, endpoint->error_msg);
+        return;
+    }
+
+    printf("Sent %s to %s: %u entries in %u frame(s)\n", message_type_to_string(endpoint->response),
+           session->pseudo, end.entries, end.frames);
+    if (paged) {
+        session_send_message(session, MSG_LIST_END, &end, sizeof(end));
+    }
+}
+
+static void serve_legacy_list(session_t* session, message_type_t list_type, const char* player) {
+    msg_list_page_t req;
+    memset(&req, 0, sizeof(req));
+    req.list_type = list_type;
+    if (player) {
+        snprintf(req.player, MAX_PSEUDO_LEN, "%.*s", MAX_PSEUDO_LEN - 1, player);
+    }
+    serve_list(session, &req, false);
+}
+
+/* Handle MSG_LIST_PAGE */
+void handle_list_page(session_t* session, const msg_list_page_t* req) {
+    msg_list_page_t page = *req;
+    page.player[MAX_PSEUDO_LEN - 1] = '\0';
+    serve_list(session, &page, true);
+}
+
+/* Handle MSG_LIST_PLAYERS */
+void handle_list_players(session_t* session) {
+    serve_legacy_list(session, MSG_LIST_PLAYERS, NULL);
 }
 
 /* Handle MSG_CHALLENGE - New notification-based approach */
 void handle_challenge(session_t* session, const char* opponent) {
     /* First check if opponent exists and is online */
-    session_t* opponent_session = session_registry_find(opponent);
+    pseudo_id_t opponent_id = pseudo_lookup(opponent);
+    session_t* opponent_session = session_registry_find(opponent_id);
     if (!opponent_session) {
         session_send_error(session, ERR_PLAYER_NOT_FOUND, "Player not found or offline");
         return;
@@ -66,7 +258,7 @@ void handle_challenge(session_t* session, const char* opponent) {
     /* Record the challenge with ID */
     int64_t challenge_id;
     bool is_new;
-    error_code_t err = matchmaking_create_challenge_with_id(g_matchmaking, session->pseudo, opponent, &challenge_id, &is_new);
+    error_code_t err = matchmaking_create_challenge_with_id(g_matchmaking, session->player_id, opponent_id, &challenge_id, &is_new);
 
     if (err != SUCCESS) {
         printf("Handle challenge failed for %s -> %s: error code %d\n", session->pseudo, opponent, err);
@@ -86,7 +278,7 @@ void handle_challenge(session_t* session, const char* opponent) {
         snprintf(notification.message, 256, "%s challenges you to a game!", session->pseudo);
         notification.challenge_id = challenge_id;
 
-        session_send_message(opponent_session, MSG_CHALLENGE_RECEIVED, &notification, sizeof(notification));
+        session_send_notification(opponent_session, MSG_CHALLENGE_RECEIVED, &notification, sizeof(notification));
         printf("Notification sent to %s\n", opponent);
     }
 }
@@ -94,56 +286,61 @@ void handle_challenge(session_t* session, const char* opponent) {
 /* Handle MSG_ACCEPT_CHALLENGE */
 void handle_accept_challenge(session_t* session, const char* challenger) {
     /* Find the challenger's session */
-    session_t* challenger_session = session_registry_find(challenger);
+    pseudo_id_t challenger_id = pseudo_lookup(challenger);
+    session_t* challenger_session = session_registry_find(challenger_id);
     if (!challenger_session) {
         session_send_error(session, ERR_PLAYER_NOT_FOUND, "Challenger not found or offline");
         return;
     }
     
     /* Create the game */
-    char game_id[MAX_GAME_ID_LEN];
-    error_code_t err = game_manager_create_game(g_game_manager, challenger, session->pseudo, game_id);
+    game_handle_t game;
+    char label[MAX_GAME_ID_LEN];
+    error_code_t err = game_manager_create_game(g_game_manager, challenger_id, session->player_id, &game, label);
     
     if (err != SUCCESS) {
         session_send_error(session, err, "Failed to create game");
         return;
     }
     
-    printf("Game started: %s vs %s (ID: %s)\n", challenger, session->pseudo, game_id);
+    printf("Game started: %s vs %s (ID: %s)\n", challenger, session->pseudo, label);
     
     /* Remove the challenge from matchmaking */
-    matchmaking_remove_challenge(g_matchmaking, challenger, session->pseudo);
+    matchmaking_remove_challenge(g_matchmaking, challenger_id, session->player_id);
     
     /* Send MSG_GAME_STARTED to both players */
     msg_game_started_t start_msg;
     memset(&start_msg, 0, sizeof(start_msg));
-    snprintf(start_msg.game_id, MAX_GAME_ID_LEN, "%s", game_id);
+    start_msg.game = game;
+    snprintf(start_msg.game_id, MAX_GAME_ID_LEN, "%s", label);
     snprintf(start_msg.player_a, MAX_PSEUDO_LEN, "%s", challenger);
     snprintf(start_msg.player_b, MAX_PSEUDO_LEN, "%s", session->pseudo);
     
     /* Send to accepter (Player B) */
     start_msg.your_side = PLAYER_B;
-    session_send_message(session, MSG_GAME_STARTED, &start_msg, sizeof(start_msg));
+    session_send_notification(session, MSG_GAME_STARTED, &start_msg, sizeof(start_msg));
     
     /* Send to challenger (Player A) */
     start_msg.your_side = PLAYER_A;
-    session_send_message(challenger_session, MSG_GAME_STARTED, &start_msg, sizeof(start_msg));
+    session_send_notification(challenger_session, MSG_GAME_STARTED, &start_msg, sizeof(start_msg));
 }
 
 /* Handle MSG_DECLINE_CHALLENGE */
 void handle_decline_challenge(session_t* session, const char* challenger) {
     /* Remove the challenge */
-    matchmaking_remove_challenge(g_matchmaking, challenger, session->pseudo);
+    pseudo_id_t challenger_id = pseudo_lookup(challenger);
+    matchmaking_remove_challenge(g_matchmaking, challenger_id, session->player_id);
     
     printf("Challenge declined: %s -> %s\n", challenger, session->pseudo);
     
     /* Optionally notify the challenger */
-    session_t* challenger_session = session_registry_find(challenger);
+    session_t* challenger_session = session_registry_find(challenger_id);
     if (challenger_session) {
         msg_error_t decline_msg;
+        memset(&decline_msg, 0, sizeof(decline_msg));
         decline_msg.error_code = SUCCESS;
         snprintf(decline_msg.error_msg, 256, "%s declined your challenge", session->pseudo);
-        session_send_message(challenger_session, MSG_ERROR, &decline_msg, sizeof(decline_msg));
+        session_send_notification(challenger_session, MSG_ERROR, &decline_msg, sizeof(decline_msg));
         printf("Decline notification sent to %s\n", challenger);
     } else {
         printf("Decline notification failed: challenger %s offline\n", challenger);
@@ -155,39 +352,43 @@ void handle_decline_challenge(session_t* session, const char* challenger) {
 
 /* Handle MSG_GET_CHALLENGES */
 void handle_get_challenges(session_t* session) {
-    msg_challenge_list_t list;
-    char challengers[100][MAX_PSEUDO_LEN];
+    serve_legacy_list(session, MSG_GET_CHALLENGES, NULL);
+}
+
+/* Push a board delta to both players and every spectator of a game */
+static void push_board_delta(game_instance_t* game, const msg_board_delta_t* delta) {
+    pseudo_id_t recipients[MAX_SPECTATORS_PER_GAME + 2];
     int count = 0;
     
-    pthread_mutex_lock(&g_matchmaking->lock);
-    
-    for (int i = 0; i < g_matchmaking->challenge_count && count < 100; i++) {
-        if (g_matchmaking->challenges[i].active &&
-            strcmp(g_matchmaking->challenges[i].opponent, session->pseudo) == 0) {
-            strncpy(challengers[count], g_matchmaking->challenges[i].challenger, MAX_PSEUDO_LEN - 1);
-            challengers[count][MAX_PSEUDO_LEN - 1] = '\0';
-            count++;
+    /* Snapshot recipients so no lock is held while sending */
+    pthread_mutex_lock(&game->lock);
+    recipients[count++] = game->player_a;
+    recipients[count++] = game->player_b;
+    for (int i = 0; i < game->spectator_count; i++) {
+        if (game->spectators[i] == game->player_a || game->spectators[i] == game->player_b) {
+            continue;  /* Players already get the delta */
         }
+        recipients[count++] = game->spectators[i];
     }
+    pthread_mutex_unlock(&game->lock);
     
-    pthread_mutex_unlock(&g_matchmaking->lock);
-    
-    list.count = count;
+    size_t wire_size = board_delta_wire_size(delta);
     for (int i = 0; i < count; i++) {
-        memcpy(list.challengers[i], challengers[i], MAX_PSEUDO_LEN);
+        session_t* recipient_session = session_registry_find(recipients[i]);
+        if (recipient_session) {
+            session_send_notification(recipient_session, MSG_BOARD_DELTA, delta, wire_size);
+        }
     }
-    
-    /* Calculate actual size: count field + actual number of challengers */
-    size_t actual_size = sizeof(list.count) + (count * MAX_PSEUDO_LEN);
-    session_send_message(session, MSG_CHALLENGE_LIST, &list, actual_size);
 }
 
 /* Handle MSG_PLAY_MOVE */
 void handle_play_move(session_t* session, const msg_play_move_t* move) {
     int seeds_captured = 0;
+    msg_board_delta_t delta;
     
-    error_code_t err = game_manager_play_move(g_game_manager, move->game_id, 
-                                              session->pseudo, move->pit_index, &seeds_captured);
+    error_code_t err = game_manager_play_move(g_game_manager, move->game, 
+                                              session->player_id, move->pit_index, &seeds_captured,
+                                              &delta);
     
     msg_move_result_t result;
     result.success = (err == SUCCESS);
@@ -198,11 +399,18 @@ void handle_play_move(session_t* session, const msg_play_move_t* move) {
                  move->pit_index, seeds_captured);
         
         /* Get game instance for statistics updates */
-        game_instance_t* game = game_manager_find_game(g_game_manager, move->game_id);
+        game_instance_t* game = game_manager_find_game(g_game_manager, move->game);
+        char label[MAX_GAME_ID_LEN] = "";
+        
+        /* Push the delta before the game can be removed below */
+        if (game) {
+            snprintf(label, sizeof(label), "%s", game->game_id);
+            push_board_delta(game, &delta);
+        }
         
         /* Check if game is over */
         board_t board;
-        if (game_manager_get_board(g_game_manager, move->game_id, &board) == SUCCESS) {
+        if (game_manager_get_board(g_game_manager, move->game, &board) == SUCCESS) {
             result.game_over = board_is_game_over(&board);
             result.winner = board_get_winner(&board);
             
@@ -221,11 +429,11 @@ void handle_play_move(session_t* session, const msg_play_move_t* move) {
                     matchmaking_update_player_stats(g_matchmaking, game->player_b, false, board.scores[1]);
                 }
                 
-                game_manager_remove_game(g_game_manager, move->game_id);
+                game_manager_remove_game(g_game_manager, move->game);
                 printf("Game ended: %s vs %s - Winner: %s\n", 
-                       game->player_a, game->player_b, 
-                       result.winner == (winner_t)PLAYER_A ? game->player_a : 
-                       result.winner == (winner_t)PLAYER_B ? game->player_b : "Draw");
+                       pseudo_name(game->player_a), pseudo_name(game->player_b), 
+                       result.winner == (winner_t)PLAYER_A ? pseudo_name(game->player_a) : 
+                       result.winner == (winner_t)PLAYER_B ? pseudo_name(game->player_b) : "Draw");
             }
         } else {
             result.game_over = false;
@@ -233,7 +441,7 @@ void handle_play_move(session_t* session, const msg_play_move_t* move) {
         }
         
     printf("Move: %s played pit %d in %s (captured: %d)\n", 
-               session->pseudo, move->pit_index, move->game_id, seeds_captured);
+               session->pseudo, move->pit_index, label, seeds_captured);
     } else {
         strncpy(result.message, error_to_string(err), 255);
         result.game_over = false;
@@ -247,10 +455,10 @@ void handle_play_move(session_t* session, const msg_play_move_t* move) {
     
     /* If move was successful, also notify the opponent */
     if (err == SUCCESS) {
-        game_instance_t* game = game_manager_find_game(g_game_manager, move->game_id);
+        game_instance_t* game = game_manager_find_game(g_game_manager, move->game);
         if (game) {
-            /* Determine opponent's pseudo */
-            const char* opponent = (strcmp(game->player_a, session->pseudo) == 0) 
+            /* Determine opponent */
+            pseudo_id_t opponent = game->player_a == session->player_id
                                    ? game->player_b 
                                    : game->player_a;
             
@@ -268,17 +476,20 @@ void handle_get_board(session_t* session, const msg_get_board_t* req) {
     msg_board_state_t board_msg;
     memset(&board_msg, 0, sizeof(board_msg));
     
-    /* Find game by players */
-    game_instance_t* game = game_manager_find_game_by_players(g_game_manager, 
-                                                               req->player_a, req->player_b);
+    /* Find game by handle, or by players for older clients */
+    game_instance_t* game = req->game != GAME_HANDLE_NONE
+        ? game_manager_find_game(g_game_manager, req->game)
+        : game_manager_find_game_by_players(g_game_manager, pseudo_lookup(req->player_a),
+                                            pseudo_lookup(req->player_b));
     
     if (game) {
         board_msg.exists = true;
+        board_msg.game = game->handle;
         strncpy(board_msg.game_id, game->game_id, MAX_GAME_ID_LEN - 1);
         board_msg.game_id[MAX_GAME_ID_LEN - 1] = '\0';
-        strncpy(board_msg.player_a, game->player_a, MAX_PSEUDO_LEN - 1);
+        strncpy(board_msg.player_a, pseudo_name(game->player_a), MAX_PSEUDO_LEN - 1);
         board_msg.player_a[MAX_PSEUDO_LEN - 1] = '\0';
-        strncpy(board_msg.player_b, game->player_b, MAX_PSEUDO_LEN - 1);
+        strncpy(board_msg.player_b, pseudo_name(game->player_b), MAX_PSEUDO_LEN - 1);
         board_msg.player_b[MAX_PSEUDO_LEN - 1] = '\0';
         
         pthread_mutex_lock(&game->lock);
@@ -291,6 +502,7 @@ void handle_get_board(session_t* session, const msg_get_board_t* req) {
         board_msg.current_player = game->board.current_player;
         board_msg.state = game->board.state;
         board_msg.winner = game->board.winner;
+        board_msg.seq = game->move_seq;
         
         pthread_mutex_unlock(&game->lock);
     } else {
@@ -300,33 +512,32 @@ void handle_get_board(session_t* session, const msg_get_board_t* req) {
     session_send_board_state(session, &board_msg);
 }
 
+/* Handle MSG_BOARD_RESYNC */
+void handle_board_resync(session_t* session, const msg_board_resync_t* req) {
+    msg_board_delta_t keyframe;
+    
+    error_code_t err = game_manager_get_keyframe(g_game_manager, req->game, &keyframe);
+    if (err != SUCCESS) {
+        session_send_error(session, err, "Game not found");
+        return;
+    }
+    
+    session_send_notification(session, MSG_BOARD_DELTA, &keyframe, board_delta_wire_size(&keyframe));
+}
+
 /* Handle MSG_LIST_GAMES */
 void handle_list_games(session_t* session) {
-    msg_game_list_t list;
-    memset(&list, 0, sizeof(list));
-
-    list.count = game_manager_get_active_games(g_game_manager, list.games, 50);
-
-    /* Calculate actual size */
-    size_t actual_size = sizeof(list.count) + (list.count * sizeof(game_info_t));
-    session_send_message(session, MSG_GAME_LIST, &list, actual_size);
+    serve_legacy_list(session, MSG_LIST_GAMES, NULL);
 }
 
 /* Handle MSG_LIST_MY_GAMES */
 void handle_list_my_games(session_t* session) {
-    msg_my_game_list_t list;
-    memset(&list, 0, sizeof(list));
-
-    list.count = game_manager_get_player_games(g_game_manager, session->pseudo, list.games, 50);
-
-    /* Calculate actual size */
-    size_t actual_size = sizeof(list.count) + (list.count * sizeof(game_info_t));
-    session_send_message(session, MSG_MY_GAME_LIST, &list, actual_size);
+    serve_legacy_list(session, MSG_LIST_MY_GAMES, NULL);
 }
 
 /* Handle MSG_SPECTATE_GAME */
-void handle_spectate_game(session_t* session, const char* game_id) {
-    game_instance_t* game = game_manager_find_game(g_game_manager, game_id);
+void handle_spectate_game(session_t* session, game_handle_t handle) {
+    game_instance_t* game = game_manager_find_game(g_game_manager, handle);
 
     if (!game) {
         session_send_error(session, ERR_GAME_NOT_FOUND, "Game not found");
@@ -334,10 +545,10 @@ void handle_spectate_game(session_t* session, const char* game_id) {
     }
 
     /* Check if spectator is friend with at least one player, or is a player in the game */
-    bool is_friend_a = matchmaking_are_friends(g_matchmaking, session->pseudo, game->player_a);
-    bool is_friend_b = matchmaking_are_friends(g_matchmaking, session->pseudo, game->player_b);
-    bool is_player_a = strcmp(session->pseudo, game->player_a) == 0;
-    bool is_player_b = strcmp(session->pseudo, game->player_b) == 0;
+    bool is_friend_a = matchmaking_are_friends(g_matchmaking, session->player_id, game->player_a);
+    bool is_friend_b = matchmaking_are_friends(g_matchmaking, session->player_id, game->player_b);
+    bool is_player_a = session->player_id == game->player_a;
+    bool is_player_b = session->player_id == game->player_b;
     bool is_authorized = is_friend_a || is_friend_b || is_player_a || is_player_b;
 
     if (!is_authorized) {
@@ -346,7 +557,7 @@ void handle_spectate_game(session_t* session, const char* game_id) {
     }
 
     /* Add spectator */
-    error_code_t err = game_manager_add_spectator(g_game_manager, game_id, session->pseudo);
+    error_code_t err = game_manager_add_spectator(g_game_manager, handle, session->player_id);
 
     if (err != SUCCESS) {
         session_send_error(session, err, "Failed to join as spectator");
@@ -356,39 +567,40 @@ void handle_spectate_game(session_t* session, const char* game_id) {
     /* Send acknowledgment */
     msg_spectate_ack_t ack;
     ack.success = true;
-    snprintf(ack.message, 256, "You are now spectating %s vs %s", game->player_a, game->player_b);
-    ack.spectator_count = game_manager_get_spectator_count(g_game_manager, game_id);
+    snprintf(ack.message, 256, "You are now spectating %s vs %s", pseudo_name(game->player_a),
+             pseudo_name(game->player_b));
+    ack.spectator_count = game_manager_get_spectator_count(g_game_manager, handle);
 
     session_send_message(session, MSG_SPECTATE_ACK, &ack, sizeof(ack));
 
-    printf("%s is now spectating %s\n", session->pseudo, game_id);
+    printf("%s is now spectating %s\n", session->pseudo, game->game_id);
 
     /* Notify players and other spectators */
     msg_spectator_joined_t notification;
     memset(&notification, 0, sizeof(notification));
     snprintf(notification.spectator, MAX_PSEUDO_LEN, "%s", session->pseudo);
-    snprintf(notification.game_id, MAX_GAME_ID_LEN, "%s", game_id);
+    notification.game = handle;
     notification.spectator_count = ack.spectator_count;
 
     /* Notify player A */
     session_t* player_a_session = session_registry_find(game->player_a);
     if (player_a_session) {
-        session_send_message(player_a_session, MSG_SPECTATOR_JOINED, &notification, sizeof(notification));
+        session_send_notification(player_a_session, MSG_SPECTATOR_JOINED, &notification, sizeof(notification));
     }
 
     /* Notify player B */
     session_t* player_b_session = session_registry_find(game->player_b);
     if (player_b_session) {
-        session_send_message(player_b_session, MSG_SPECTATOR_JOINED, &notification, sizeof(notification));
+        session_send_notification(player_b_session, MSG_SPECTATOR_JOINED, &notification, sizeof(notification));
     }
 
     /* Notify other spectators */
     pthread_mutex_lock(&game->lock);
     for (int i = 0; i < game->spectator_count; i++) {
-        if (strcmp(game->spectators[i], session->pseudo) != 0) {  /* Don't notify self */
+        if (game->spectators[i] != session->player_id) {  /* Don't notify self */
             session_t* spectator_session = session_registry_find(game->spectators[i]);
             if (spectator_session) {
-                session_send_message(spectator_session, MSG_SPECTATOR_JOINED, &notification, sizeof(notification));
+                session_send_notification(spectator_session, MSG_SPECTATOR_JOINED, &notification, sizeof(notification));
             }
         }
     }
@@ -396,11 +608,11 @@ void handle_spectate_game(session_t* session, const char* game_id) {
 }
 
 /* Handle MSG_STOP_SPECTATE */
-void handle_stop_spectate(session_t* session, const char* game_id) {
-    error_code_t err = game_manager_remove_spectator(g_game_manager, game_id, session->pseudo);
+void handle_stop_spectate(session_t* session, game_handle_t game) {
+    error_code_t err = game_manager_remove_spectator(g_game_manager, game, session->player_id);
     
     if (err == SUCCESS) {
-    printf("%s stopped spectating %s\n", session->pseudo, game_id);
+    printf("%s stopped spectating game %llx\n", session->pseudo, (unsigned long long)game);
         session_send_message(session, MSG_CHALLENGE_SENT, NULL, 0);  /* Reuse as ACK */
     } else {
         session_send_error(session, err, "Failed to stop spectating");
@@ -414,26 +626,14 @@ void handle_set_bio(session_t* session, const msg_set_bio_t* bio_msg) {
         return;
     }
 
-    /* Find the player in matchmaking */
-    pthread_mutex_lock(&g_matchmaking->lock);
-    
-    bool found = false;
-    for (int i = 0; i < g_matchmaking->player_count; i++) {
-        if (strcmp(g_matchmaking->players[i].info.pseudo, session->pseudo) == 0) {
-            /* Update bio */
-            g_matchmaking->players[i].info.bio_lines = bio_msg->bio_lines;
-            for (int j = 0; j < bio_msg->bio_lines && j < 10; j++) {
-                strncpy(g_matchmaking->players[i].info.bio[j], bio_msg->bio[j], 255);
-                g_matchmaking->players[i].info.bio[j][255] = '\0';
-            }
-            found = true;
-            break;
-        }
+    /* Lines arrive unterminated at worst */
+    char bio[10][256];
+    int lines = bio_msg->bio_lines < 0 ? 0 : (bio_msg->bio_lines > 10 ? 10 : bio_msg->bio_lines);
+    for (int j = 0; j < lines; j++) {
+        snprintf(bio[j], sizeof(bio[j]), "%.255s", bio_msg->bio[j]);
     }
-    
-    pthread_mutex_unlock(&g_matchmaking->lock);
 
-    if (found) {
+    if (matchmaking_set_player_bio(g_matchmaking, session->player_id, (const char (*)[256])bio, lines) == SUCCESS) {
     printf("%s updated their bio (%d lines)\n", session->pseudo, bio_msg->bio_lines);
         session_send_message(session, MSG_CHALLENGE_SENT, NULL, 0);  /* Reuse as ACK */
     } else {
@@ -453,25 +653,10 @@ void handle_get_bio(session_t* session, const msg_get_bio_t* bio_req) {
     snprintf(response.player, MAX_PSEUDO_LEN, "%s", bio_req->target_player);
     response.player[MAX_PSEUDO_LEN - 1] = '\0';
 
-    /* Find the player */
-    pthread_mutex_lock(&g_matchmaking->lock);
-    
-    bool found = false;
-    for (int i = 0; i < g_matchmaking->player_count; i++) {
-        if (strcmp(g_matchmaking->players[i].info.pseudo, bio_req->target_player) == 0) {
-            response.success = true;
-            response.bio_lines = g_matchmaking->players[i].info.bio_lines;
-            for (int j = 0; j < response.bio_lines && j < 10; j++) {
-                strncpy(response.bio[j], g_matchmaking->players[i].info.bio[j], 255);
-            }
-            found = true;
-            break;
-        }
-    }
-    
-    pthread_mutex_unlock(&g_matchmaking->lock);
-
-    if (!found) {
+    /* The bio is cold data: read from disk on first request */
+    if (matchmaking_get_player_bio(g_matchmaking, pseudo_lookup(bio_req->target_player), response.bio, &response.bio_lines) == SUCCESS) {
+        response.success = true;
+    } else {
         response.success = false;
         snprintf(response.message, sizeof(response.message), "Player '%s' not found", bio_req->target_player);
     }
@@ -492,8 +677,8 @@ void handle_get_player_stats(session_t* session, const msg_get_player_stats_t* s
     response.player[MAX_PSEUDO_LEN - 1] = '\0';
 
     /* Get player stats using matchmaking function */
-    player_info_t player_info;
-    error_code_t err = matchmaking_get_player_stats(g_matchmaking, stats_req->target_player, &player_info);
+    player_entry_t player_info;
+    error_code_t err = matchmaking_get_player_stats(g_matchmaking, pseudo_lookup(stats_req->target_player), &player_info);
 
     if (err == SUCCESS) {
         response.success = true;
@@ -531,7 +716,7 @@ void handle_send_chat(session_t* session, const msg_send_chat_t* chat_msg) {
 
     if (is_private) {
         /* Private chat: validate recipient exists */
-        session_t* recipient_session = session_registry_find(chat_msg->recipient);
+        session_t* recipient_session = session_registry_find(pseudo_lookup(chat_msg->recipient));
         if (!recipient_session) {
             session_send_error(session, ERR_PLAYER_NOT_FOUND, "Recipient not found or offline");
             return;
@@ -543,7 +728,7 @@ void handle_send_chat(session_t* session, const msg_send_chat_t* chat_msg) {
     snprintf(chat_notification.message, MAX_CHAT_LEN, "%s", chat_msg->message);
     chat_notification.timestamp = time(NULL);
 
-    session_send_message(recipient_session, MSG_CHAT_MESSAGE, &chat_notification, sizeof(chat_notification));
+    session_send_notification(recipient_session, MSG_CHAT_MESSAGE, &chat_notification, sizeof(chat_notification));
 
     printf("Private chat: %s -> %s\n", session->pseudo, chat_msg->recipient);
     } else {
@@ -556,10 +741,10 @@ void handle_send_chat(session_t* session, const msg_send_chat_t* chat_msg) {
         /* Send to all online players except sender */
         pthread_mutex_lock(&g_matchmaking->lock);
         for (int i = 0; i < g_matchmaking->player_count; i++) {
-            if (strcmp(g_matchmaking->players[i].info.pseudo, session->pseudo) != 0) {
-                session_t* player_session = session_registry_find(g_matchmaking->players[i].info.pseudo);
+            if (g_matchmaking->players[i].id != session->player_id) {
+                session_t* player_session = session_registry_find(g_matchmaking->players[i].id);
                 if (player_session) {
-                    session_send_message(player_session, MSG_CHAT_MESSAGE, &chat_notification, sizeof(chat_notification));
+                    session_send_notification(player_session, MSG_CHAT_MESSAGE, &chat_notification, sizeof(chat_notification));
                 }
             }
         }
@@ -570,7 +755,7 @@ void handle_send_chat(session_t* session, const msg_send_chat_t* chat_msg) {
 
     /* Send the chat notification back to the sender so their client displays the message
        via the same MSG_CHAT_MESSAGE handler. */
-    session_send_message(session, MSG_CHAT_MESSAGE, &chat_notification, sizeof(chat_notification));
+    session_send_notification(session, MSG_CHAT_MESSAGE, &chat_notification, sizeof(chat_notification));
 }
 
 /* Handle MSG_CHALLENGE_ACCEPT */
@@ -590,7 +775,7 @@ void handle_challenge_accept(session_t* session, const msg_challenge_accept_t* a
     }
 
     /* Verify that the accepter is the opponent */
-    if (strcmp(session->pseudo, challenge->opponent) != 0) {
+    if (session->player_id != challenge->opponent) {
         session_send_error(session, ERR_INVALID_PARAM, "You are not the recipient of this challenge");
         return;
     }
@@ -604,15 +789,16 @@ void handle_challenge_accept(session_t* session, const msg_challenge_accept_t* a
     }
 
     /* Create the game */
-    char game_id[MAX_GAME_ID_LEN];
-    err = game_manager_create_game(g_game_manager, challenge->challenger, session->pseudo, game_id);
+    game_handle_t game;
+    char label[MAX_GAME_ID_LEN];
+    err = game_manager_create_game(g_game_manager, challenge->challenger, session->player_id, &game, label);
 
     if (err != SUCCESS) {
         session_send_error(session, err, "Failed to create game");
         return;
     }
 
-    printf("Challenge accepted: %s vs %s (ID: %s)\n", challenge->challenger, session->pseudo, game_id);
+    printf("Challenge accepted: %s vs %s (ID: %s)\n", pseudo_name(challenge->challenger), session->pseudo, label);
 
     /* Remove the challenge */
     matchmaking_remove_challenge_by_id(g_matchmaking, accept_msg->challenge_id);
@@ -620,17 +806,18 @@ void handle_challenge_accept(session_t* session, const msg_challenge_accept_t* a
     /* Send MSG_GAME_STARTED to both players */
     msg_game_started_t start_msg;
     memset(&start_msg, 0, sizeof(start_msg));
-    snprintf(start_msg.game_id, MAX_GAME_ID_LEN, "%s", game_id);
-    snprintf(start_msg.player_a, MAX_PSEUDO_LEN, "%s", challenge->challenger);
+    start_msg.game = game;
+    snprintf(start_msg.game_id, MAX_GAME_ID_LEN, "%s", label);
+    snprintf(start_msg.player_a, MAX_PSEUDO_LEN, "%s", pseudo_name(challenge->challenger));
     snprintf(start_msg.player_b, MAX_PSEUDO_LEN, "%s", session->pseudo);
 
     /* Send to accepter (Player B) */
     start_msg.your_side = PLAYER_B;
-    session_send_message(session, MSG_GAME_STARTED, &start_msg, sizeof(start_msg));
+    session_send_notification(session, MSG_GAME_STARTED, &start_msg, sizeof(start_msg));
 
     /* Send to challenger (Player A) */
     start_msg.your_side = PLAYER_A;
-    session_send_message(challenger_session, MSG_GAME_STARTED, &start_msg, sizeof(start_msg));
+    session_send_notification(challenger_session, MSG_GAME_STARTED, &start_msg, sizeof(start_msg));
 }
 
 /* Handle MSG_CHALLENGE_DECLINE */
@@ -650,7 +837,7 @@ void handle_challenge_decline(session_t* session, const msg_challenge_decline_t*
     }
 
     /* Verify that the decliner is the opponent */
-    if (strcmp(session->pseudo, challenge->opponent) != 0) {
+    if (session->player_id != challenge->opponent) {
         session_send_error(session, ERR_INVALID_PARAM, "You are not the recipient of this challenge");
         return;
     }
@@ -669,7 +856,7 @@ void handle_challenge_decline(session_t* session, const msg_challenge_decline_t*
     }
     pthread_mutex_unlock(&g_matchmaking->lock);
 
-    printf("Challenge declined: %s -> %s\n", challenge->challenger, session->pseudo);
+    printf("Challenge declined: %s -> %s\n", pseudo_name(challenge->challenger), session->pseudo);
 
     /* Remove the challenge */
     matchmaking_remove_challenge_by_id(g_matchmaking, decline_msg->challenge_id);
@@ -678,12 +865,13 @@ void handle_challenge_decline(session_t* session, const msg_challenge_decline_t*
     session_t* challenger_session = session_registry_find(challenge->challenger);
     if (challenger_session) {
         msg_error_t decline_msg;
+        memset(&decline_msg, 0, sizeof(decline_msg));
         decline_msg.error_code = SUCCESS;
         snprintf(decline_msg.error_msg, 256, "%s declined your challenge", session->pseudo);
-        session_send_message(challenger_session, MSG_ERROR, &decline_msg, sizeof(decline_msg));
-        printf("Decline notification sent to %s (ID-based)\n", challenge->challenger);
+        session_send_notification(challenger_session, MSG_ERROR, &decline_msg, sizeof(decline_msg));
+        printf("Decline notification sent to %s (ID-based)\n", pseudo_name(challenge->challenger));
     } else {
-        printf("Decline notification failed: challenger %s offline (ID-based)\n", challenge->challenger);
+        printf("Decline notification failed: challenger %s offline (ID-based)\n", pseudo_name(challenge->challenger));
     }
 
     /* Confirm to decliner */
@@ -697,7 +885,7 @@ void handle_add_friend(session_t* session, const msg_add_friend_t* add_msg) {
         return;
     }
 
-    error_code_t err = matchmaking_add_friend(g_matchmaking, session->pseudo, add_msg->friend_pseudo);
+    error_code_t err = matchmaking_add_friend(g_matchmaking, session->player_id, pseudo_lookup(add_msg->friend_pseudo));
     if (err == SUCCESS) {
         printf("%s added %s as friend\n", session->pseudo, add_msg->friend_pseudo);
         session_send_message(session, MSG_CHALLENGE_SENT, NULL, 0);  /* Reuse as ACK */
@@ -719,7 +907,7 @@ void handle_remove_friend(session_t* session, const msg_remove_friend_t* remove_
         return;
     }
 
-    error_code_t err = matchmaking_remove_friend(g_matchmaking, session->pseudo, remove_msg->friend_pseudo);
+    error_code_t err = matchmaking_remove_friend(g_matchmaking, session->player_id, pseudo_lookup(remove_msg->friend_pseudo));
     if (err == SUCCESS) {
         printf("%s removed %s from friends\n", session->pseudo, remove_msg->friend_pseudo);
         session_send_message(session, MSG_CHALLENGE_SENT, NULL, 0);  /* Reuse as ACK */
@@ -730,71 +918,12 @@ void handle_remove_friend(session_t* session, const msg_remove_friend_t* remove_
 
 /* Handle MSG_LIST_FRIENDS */
 void handle_list_friends(session_t* session) {
-    msg_list_friends_t response;
-    memset(&response, 0, sizeof(response));
-
-    /* Get player info to access friends list */
-    player_info_t player_info;
-    error_code_t err = matchmaking_get_player_stats(g_matchmaking, session->pseudo, &player_info);
-    if (err != SUCCESS) {
-        session_send_error(session, err, "Failed to get player info");
-        return;
-    }
-
-    response.count = player_info.friend_count;
-    for (int i = 0; i < player_info.friend_count && i < MAX_FRIENDS; i++) {
-        strncpy(response.friends[i], player_info.friends[i], MAX_PSEUDO_LEN - 1);
-        response.friends[i][MAX_PSEUDO_LEN - 1] = '\0';
-    }
-
-    /* Calculate actual size */
-    size_t actual_size = sizeof(response.count) + (response.count * MAX_PSEUDO_LEN);
-    session_send_message(session, MSG_LIST_FRIENDS, &response, actual_size);
+    serve_legacy_list(session, MSG_LIST_FRIENDS, NULL);
 }
 
 /* Handle MSG_LIST_SAVED_GAMES */
 void handle_list_saved_games(session_t* session, const msg_list_saved_games_t* req) {
-    msg_saved_game_list_t response;
-    memset(&response, 0, sizeof(response));
-
-    /* Get list of saved games */
-    char game_ids[50][MAX_GAME_ID_LEN];
-    int count = 0;
-    error_code_t err = storage_list_saved_games(&count, game_ids, 50);
-    if (err != SUCCESS) {
-        session_send_error(session, err, "Failed to list saved games");
-        return;
-    }
-
-    /* Filter by player if specified */
-    int filtered_count = 0;
-    for (int i = 0; i < count && filtered_count < 50; i++) {
-        game_instance_t game;
-        if (storage_load_saved_game(game_ids[i], &game) == SUCCESS) {
-            /* Check if player is involved in this game */
-            bool include_game = true;
-            if (strlen(req->player) > 0) {
-                include_game = (strcmp(game.player_a, req->player) == 0 ||
-                               strcmp(game.player_b, req->player) == 0);
-            }
-
-            if (include_game) {
-                /* Populate game info */
-                snprintf(response.games[filtered_count].game_id, MAX_GAME_ID_LEN, "%s", game.game_id);
-                snprintf(response.games[filtered_count].player_a, MAX_PSEUDO_LEN, "%s", game.player_a);
-                snprintf(response.games[filtered_count].player_b, MAX_PSEUDO_LEN, "%s", game.player_b);
-                response.games[filtered_count].spectator_count = 0;  /* Not applicable for saved games */
-                response.games[filtered_count].state = game.board.state;
-                filtered_count++;
-            }
-        }
-    }
-
-    response.count = filtered_count;
-
-    /* Calculate actual size */
-    size_t actual_size = sizeof(response.count) + (response.count * sizeof(game_info_t));
-    session_send_message(session, MSG_SAVED_GAME_LIST, &response, actual_size);
+    serve_legacy_list(session, MSG_LIST_SAVED_GAMES, req->player);
 }
 
 /* Handle MSG_VIEW_SAVED_GAME */
@@ -812,8 +941,8 @@ void handle_view_saved_game(session_t* session, const msg_view_saved_game_t* req
 
     board_msg.exists = true;
     snprintf(board_msg.game_id, MAX_GAME_ID_LEN, "%s", game.game_id);
-    snprintf(board_msg.player_a, MAX_PSEUDO_LEN, "%s", game.player_a);
-    snprintf(board_msg.player_b, MAX_PSEUDO_LEN, "%s", game.player_b);
+    snprintf(board_msg.player_a, MAX_PSEUDO_LEN, "%s", pseudo_name(game.player_a));
+    snprintf(board_msg.player_b, MAX_PSEUDO_LEN, "%s", pseudo_name(game.player_b));
 
     for (int i = 0; i < NUM_PITS; i++) {
         board_msg.pits[i] = game.board.pits[i];
@@ -2,10 +2,15 @@
  * Thread-safe registry for managing active client sessions
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "../../include/server/server_registry.h"
+#include "../../include/server/resume_token.h"
 #include <pthread.h>
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
+#include <time.h>
 
 #define MAX_SESSIONS 100
 
@@ -13,7 +18,12 @@
 typedef struct {
     session_t* session;
     bool active;
+    bool detached;              /* Connection lost, handler waiting for a resume */
+    bool resume_ready;          /* `fresh` holds the connection to resume onto */
+    connection_t fresh;
+    uint32_t notifications_seen;
     pthread_mutex_t lock;
+    pthread_cond_t resumed;     /* Signalled when resume_ready is set */
 } session_entry_t;
 
 /* Global session registry */
@@ -23,12 +33,42 @@ static struct {
 } g_session_registry;
 
 void session_registry_init(void) {
+    /* Grace windows are measured on the monotonic clock */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
     pthread_mutex_init(&g_session_registry.lock, NULL);
     for (int i = 0; i < MAX_SESSIONS; i++) {
         g_session_registry.sessions[i].session = NULL;
         g_session_registry.sessions[i].active = false;
+        g_session_registry.sessions[i].detached = false;
+        g_session_registry.sessions[i].resume_ready = false;
         pthread_mutex_init(&g_session_registry.sessions[i].lock, NULL);
+        pthread_cond_init(&g_session_registry.sessions[i].resumed, &attr);
+    }
+    pthread_condattr_destroy(&attr);
+}
+
+/* Caller holds the registry lock */
+static session_entry_t* find_entry(const session_t* session) {
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        if (g_session_registry.sessions[i].active && g_session_registry.sessions[i].session == session) {
+            return &g_session_registry.sessions[i];
+        }
     }
+    return NULL;
+}
+
+/* Caller holds the registry lock */
+static void release_entry(session_entry_t* entry) {
+    if (entry->resume_ready) {
+        connection_close(&entry->fresh);
+    }
+    entry->active = false;
+    entry->session = NULL;
+    entry->detached = false;
+    entry->resume_ready = false;
 }
 
 bool session_registry_add(session_t* session) {
@@ -47,23 +87,20 @@ bool session_registry_add(session_t* session) {
 
 void session_registry_remove(session_t* session) {
     pthread_mutex_lock(&g_session_registry.lock);
-    for (int i = 0; i < MAX_SESSIONS; i++) {
-        if (g_session_registry.sessions[i].active && 
-            g_session_registry.sessions[i].session == session) {
-            g_session_registry.sessions[i].active = false;
-            g_session_registry.sessions[i].session = NULL;
-            break;
-        }
+    session_entry_t* entry = find_entry(session);
+    if (entry) {
+        release_entry(entry);
     }
     pthread_mutex_unlock(&g_session_registry.lock);
 }
 
-session_t* session_registry_find(const char* pseudo) {
+session_t* session_registry_find(pseudo_id_t player) {
     session_t* result = NULL;
+    if (player == PSEUDO_ID_NONE) return NULL;
     pthread_mutex_lock(&g_session_registry.lock);
     for (int i = 0; i < MAX_SESSIONS; i++) {
         if (g_session_registry.sessions[i].active && 
-            strcmp(g_session_registry.sessions[i].session->pseudo, pseudo) == 0) {
+            g_session_registry.sessions[i].session->player_id == player) {
             result = g_session_registry.sessions[i].session;
             break;
         }
@@ -71,3 +108,106 @@ session_t* session_registry_find(const char* pseudo) {
     pthread_mutex_unlock(&g_session_registry.lock);
     return result;
 }
+
+bool session_registry_await_resume(session_t* session, int grace_sec) {
+    if (!session) return false;
+
+    /* Notifications recorded meanwhile fail fast instead of filling a dead
+     * socket's buffer */
+    connection_shutdown(&session->conn);
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += grace_sec;
+
+    pthread_mutex_lock(&g_session_registry.lock);
+    session_entry_t* entry = find_entry(session);
+    if (!entry) {
+        pthread_mutex_unlock(&g_session_registry.lock);
+        return false;
+    }
+
+    entry->detached = true;
+    while (entry->session == session && !entry->resume_ready) {
+        if (pthread_cond_timedwait(&entry->resumed, &g_session_registry.lock, &deadline) == ETIMEDOUT) break;
+    }
+    if (entry->session != session) {
+        /* A fresh login took the player over and released the entry */
+        pthread_mutex_unlock(&g_session_registry.lock);
+        return false;
+    }
+    if (!entry->resume_ready) {
+        /* Window closed: from here on the token resumes nothing */
+        release_entry(entry);
+        pthread_mutex_unlock(&g_session_registry.lock);
+        return false;
+    }
+
+    connection_t fresh = entry->fresh;
+    uint32_t notifications_seen = entry->notifications_seen;
+    entry->resume_ready = false;
+    entry->detached = false;
+    pthread_mutex_unlock(&g_session_registry.lock);
+
+    /* If the new connection fails too, the handler sees it and waits again */
+    session_resume(session, &fresh, notifications_seen);
+    return true;
+}
+
+bool session_registry_replace_detached(pseudo_id_t player) {
+    if (player == PSEUDO_ID_NONE) return false;
+
+    pthread_mutex_lock(&g_session_registry.lock);
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        session_entry_t* entry = &g_session_registry.sessions[i];
+        if (entry->active && entry->detached && !entry->resume_ready &&
+            entry->session->player_id == player) {
+            /* The player now belongs to the new login: the waiting handler
+             * must not take it out of matchmaking when it cleans up */
+            entry->session->player_id = PSEUDO_ID_NONE;
+            release_entry(entry);
+            pthread_cond_signal(&entry->resumed);
+            pthread_mutex_unlock(&g_session_registry.lock);
+            return true;
+        }
+    }
+    pthread_mutex_unlock(&g_session_registry.lock);
+    return false;
+}
+
+error_code_t session_registry_resume(const msg_resume_t* msg, connection_t* conn) {
+    if (!msg || !conn) return ERR_INVALID_PARAM;
+    if (!resume_token_verify(msg->pseudo, msg->token)) return ERR_INVALID_PARAM;
+    pseudo_id_t player = pseudo_lookup(msg->pseudo);
+
+    pthread_mutex_lock(&g_session_registry.lock);
+    session_entry_t* entry = NULL;
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        session_entry_t* candidate = &g_session_registry.sessions[i];
+        if (candidate->active && candidate->session->player_id == player &&
+            strcmp(candidate->session->session_id, msg->token) == 0) {
+            entry = candidate;
+            break;
+        }
+    }
+    if (!entry) {
+        pthread_mutex_unlock(&g_session_registry.lock);
+        return ERR_PLAYER_NOT_FOUND;
+    }
+
+    /* A newer attempt replaces one the handler has not picked up yet */
+    if (entry->resume_ready) {
+        connection_close(&entry->fresh);
+    }
+    entry->fresh = *conn;
+    entry->notifications_seen = msg->notifications_seen;
+    entry->resume_ready = true;
+
+    /* The client saw the drop first; make the handler see it too */
+    if (!entry->detached) {
+        connection_shutdown(&entry->session->conn);
+    }
+    pthread_cond_signal(&entry->resumed);
+    pthread_mutex_unlock(&g_session_registry.lock);
+    return SUCCESS;
+}
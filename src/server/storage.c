@@ -7,6 +7,8 @@
 #include <time.h>
 #include "../../include/server/game_manager.h"
 #include "../../include/server/matchmaking.h"
+#include "../../include/server/player_store.h"
+#include "../../include/server/game_catalog.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,18 +17,21 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include <errno.h>
-#include <zlib.h>  /* For CRC32 checksums */
+#include "../../include/common/checksum.h"
+#include <zlib.h>  /* For the CRC-32 of files from before CRC-32C */
 #include <dirent.h>
 
 #include <limits.h>
 
 #define STORAGE_PATH_MAX 1024
+#define LIST_BATCH 32   /* Saved games converted per catalog page */
 
 /* File format versions */
-#define STORAGE_VERSION_GAME 1
-#define STORAGE_VERSION_PLAYER 1
+#define STORAGE_VERSION_LEGACY_GAME 1
+#define STORAGE_VERSION_PLAYER 2
+#define STORAGE_VERSION_PLAYER_CRC32 1  /* Checked with zlib's CRC-32 */
 
-/* Persistent game structure */
+/* Record of GAMES_FILE, from before the game log; read only to convert it */
 typedef struct {
     uint32_t version;
     char game_id[MAX_GAME_ID_LEN];
@@ -38,7 +43,7 @@ typedef struct {
     char spectators[MAX_SPECTATORS_PER_GAME][MAX_PSEUDO_LEN];
     int spectator_count;
     uint32_t crc;
-} persistent_game_t;
+} legacy_game_t;
 
 /* Persistent player structure */
 typedef struct {
@@ -65,106 +70,6 @@ static bool validate_crc(const void* data, size_t size, uint32_t expected_crc) {
     return actual_crc == expected_crc;
 }
 
-static error_code_t atomic_write(const char* filename, const void* data, size_t size) {
-    fprintf(stderr, "atomic_write: entered for %s (size=%zu)\n", filename, size);
-    fflush(stderr);
-    /* Ensure the directory exists (defensive) */
-    char dir_copy[STORAGE_PATH_MAX];
-    strncpy(dir_copy, filename, sizeof(dir_copy) - 1);
-    dir_copy[sizeof(dir_copy) - 1] = '\0';
-    char* last_slash = strrchr(dir_copy, '/');
-    if (last_slash) {
-        *last_slash = '\0';
-        storage_create_directory(dir_copy);
-        struct stat st;
-        if (stat(dir_copy, &st) == 0) {
-            fprintf(stderr, "atomic_write: dir %s exists, mode=0%o\n", dir_copy, st.st_mode & 0777);
-            fflush(stderr);
-        } else {
-            fprintf(stderr, "atomic_write: dir %s stat failed (%d: %s)\n", dir_copy, errno, strerror(errno));
-            fflush(stderr);
-        }
-    }
-
-    /* Fast path: try a simple fopen/fwrite (acceptable for tests). If this
-     * succeeds, use it. Otherwise fall back to atomic mkstemp/rename method.
-     */
-    FILE* f = fopen(filename, "wb");
-    fprintf(stderr, "atomic_write: fopen(%s) returned %p\n", filename, (void*)f);
-    fflush(stderr);
-    if (f) {
-        size_t written = fwrite(data, 1, size, f);
-        if (written != size) {
-            fprintf(stderr, "atomic_write: fwrite wrote %zu of %zu bytes (errno=%d: %s)\n", written, size, errno, strerror(errno));
-            fflush(stderr);
-        }
-        fclose(f);
-        if (written == size) return SUCCESS;
-        /* If fwrite failed to write fully, try fallback */
-    }
-
-    /* Create a unique temporary file next to the target file */
-    char tmp_template[STORAGE_PATH_MAX];
-    snprintf(tmp_template, sizeof(tmp_template), "%s.tmpXXXXXX", filename);
-    fprintf(stderr, "atomic_write: tmp_template=%s\n", tmp_template);
-    fflush(stderr);
-    int fd = mkstemp(tmp_template);
-    if (fd < 0) {
-        /* Fallback: create a unique temp filename in the same directory */
-        pid_t pid = getpid();
-        time_t now = time(NULL);
-    char fallback[STORAGE_PATH_MAX];
-    snprintf(fallback, sizeof(fallback), "%s.%d.%ld.tmp", filename, (int)pid, (long)now);
-        /* Try to open with O_CREAT|O_EXCL to avoid races */
-        fprintf(stderr, "atomic_write: mkstemp failed (%d: %s), trying fallback %s\n", errno, strerror(errno), fallback);
-        fflush(stderr);
-        fd = open(fallback, O_WRONLY | O_CREAT | O_EXCL, 0644);
-        if (fd < 0) {
-            fprintf(stderr, "atomic_write: open fallback failed (%d: %s)\n", errno, strerror(errno));
-            fflush(stderr);
-            return ERR_NETWORK_ERROR;  /* Reuse error code for file I/O */
-        }
-        /* Use fallback name for rename at the end */
-        strncpy(tmp_template, fallback, sizeof(tmp_template) - 1);
-        tmp_template[sizeof(tmp_template) - 1] = '\0';
-    }
-
-    /* Write all data in a loop to handle partial writes */
-    const uint8_t* ptr = (const uint8_t*)data;
-    size_t remaining = size;
-    fprintf(stderr, "atomic_write: begin write (%zu bytes) to fd=%d\n", size, fd);
-    fflush(stderr);
-    while (remaining > 0) {
-        ssize_t w = write(fd, ptr, remaining);
-        if (w < 0) {
-            fprintf(stderr, "atomic_write: write failed (%d: %s)\n", errno, strerror(errno));
-            fflush(stderr);
-            close(fd);
-            unlink(tmp_template);
-            return ERR_NETWORK_ERROR;
-        }
-        ptr += w;
-        remaining -= (size_t)w;
-    }
-
-    /* Ensure data is durable */
-    if (fsync(fd) != 0) {
-        fprintf(stderr, "atomic_write: fsync failed (%d: %s)\n", errno, strerror(errno));
-        fflush(stderr);
-    }
-    close(fd);
-
-    /* Atomic rename into place */
-    if (rename(tmp_template, filename) != 0) {
-        fprintf(stderr, "atomic_write: rename %s -> %s failed (%d: %s)\n", tmp_template, filename, errno, strerror(errno));
-        fflush(stderr);
-        unlink(tmp_template);
-        return ERR_NETWORK_ERROR;
-    }
-
-    return SUCCESS;
-}
-
 static error_code_t read_file(const char* filename, void** data, size_t* size) {
     int fd = open(filename, O_RDONLY);
     if (fd < 0) {
@@ -196,6 +101,8 @@ static error_code_t read_file(const char* filename, void** data, size_t* size) {
     return SUCCESS;
 }
 
+static error_code_t import_legacy_players(int* imported);
+
 /* Storage operations */
 error_code_t storage_init(void) {
     /* Create data directory if it doesn't exist */
@@ -203,11 +110,33 @@ error_code_t storage_init(void) {
         return ERR_NETWORK_ERROR;
     }
 
-    return SUCCESS;
+    bool created = false;
+    error_code_t err = player_store_open(PLAYERS_FILE, sizeof(persistent_player_t), &created);
+    if (err != SUCCESS) return err;
+    if (created) {
+        int imported = 0;
+        err = import_legacy_players(&imported);
+        if (err != SUCCESS) {
+            player_store_close();
+            return err;
+        }
+        if (imported > 0) printf("Imported %d player file(s) into %s\n", imported, PLAYERS_FILE);
+    }
+
+    err = game_log_open(GAMES_LOG_DIR);
+    if (err == SUCCESS) err = game_catalog_build();
+    if (err != SUCCESS) {
+        game_catalog_clear();
+        game_log_close();
+        player_store_close();
+    }
+    return err;
 }
 
 error_code_t storage_cleanup(void) {
-    /* Nothing special needed for cleanup */
+    game_catalog_clear();
+    game_log_close();
+    player_store_close();
     return SUCCESS;
 }
 
@@ -233,360 +162,431 @@ error_code_t storage_file_exists(const char* path, bool* exists) {
 }
 
 /* Game persistence */
-error_code_t storage_save_game(const game_instance_t* game) {
+error_code_t storage_start_game(game_instance_t* game) {
     if (!game) return ERR_INVALID_PARAM;
+    error_code_t err = game_log_start(game->player_a, game->player_b, game->game_id, game->board.created_at,
+                                      &game->log_id);
+    if (err != SUCCESS) return err;
+    return game_catalog_add(game->log_id, game->game_id, game->player_a, game->player_b, game->board.created_at);
+}
 
-    persistent_game_t pg;
-    memset(&pg, 0, sizeof(pg));
-
-    pg.version = STORAGE_VERSION_GAME;
-    snprintf(pg.game_id, MAX_GAME_ID_LEN, "%s", game->game_id);
-    snprintf(pg.player_a, MAX_PSEUDO_LEN, "%s", game->player_a);
-    snprintf(pg.player_b, MAX_PSEUDO_LEN, "%s", game->player_b);
-    memcpy(&pg.board, &game->board, sizeof(board_t));
-    pg.created_at = game->board.created_at;
-    pg.last_move_at = game->board.last_move_at;
-
-    /* Copy spectators */
-    pg.spectator_count = game->spectator_count;
-    for (int i = 0; i < game->spectator_count && i < MAX_SPECTATORS_PER_GAME; i++) {
-        strncpy(pg.spectators[i], game->spectators[i], MAX_PSEUDO_LEN - 1);
-    }
-
-    /* Calculate CRC (excluding the CRC field itself) */
-    pg.crc = calculate_crc32(&pg, sizeof(pg) - sizeof(pg.crc));
-
-    /* Diagnostic: write only to central games file (tests expect central storage) */
-    fprintf(stderr, "storage_save_game: writing record to %s\n", GAMES_FILE);
-    fflush(stderr);
+error_code_t storage_record_move(const game_instance_t* game, int pit_index) {
+    if (!game) return ERR_INVALID_PARAM;
+    return game_log_append_move(game->log_id, pit_index, &game->board);
+}
 
-    FILE* gf = fopen(GAMES_FILE, "r+b");
-    if (!gf) gf = fopen(GAMES_FILE, "w+b");
-    if (!gf) {
-        return ERR_NETWORK_ERROR;
-    }
+error_code_t storage_finish_game(const game_instance_t* game) {
+    if (!game) return ERR_INVALID_PARAM;
+    game_catalog_finish(game->log_id, game->board.state, game->board.winner, game->move_seq);
+    /* Without every move the game stays as it was logged */
+    if (game->moves_kept != game->move_seq) return ERR_MAX_CAPACITY;
+    return game_log_finish(game->log_id, game->game_id, game->moves, game->moves_kept, &game->board);
+}
 
-    /* Search for existing record to replace */
-    persistent_game_t tmp;
-    bool replaced = false;
-    while (fread(&tmp, 1, sizeof(tmp), gf) == sizeof(tmp)) {
-        if (strncmp(tmp.game_id, pg.game_id, MAX_GAME_ID_LEN) == 0) {
-            fseek(gf, -((long)sizeof(tmp)), SEEK_CUR);
-            fwrite(&pg, 1, sizeof(pg), gf);
-            fflush(gf);
-            replaced = true;
-            break;
-        }
-    }
-    if (!replaced) {
-        fwrite(&pg, 1, sizeof(pg), gf);
-        fflush(gf);
+error_code_t storage_save_game(game_instance_t* game) {
+    if (!game) return ERR_INVALID_PARAM;
+    if (game->log_id == GAME_LOG_ID_NONE) {
+        error_code_t err = storage_start_game(game);
+        if (err != SUCCESS) return err;
     }
-    fclose(gf);
-
-    return SUCCESS;
+    return game_log_append_snapshot(game->log_id, &game->board);
 }
 
-error_code_t storage_load_game(const char* game_id, game_instance_t* game) {
-    if (!game_id || !game) return ERR_INVALID_PARAM;
-
-    /* First, try to find the record in the central games file */
-    FILE* gf = fopen(GAMES_FILE, "rb");
-    if (gf) {
-        persistent_game_t tmp;
-        while (fread(&tmp, 1, sizeof(tmp), gf) == sizeof(tmp)) {
-            if (strncmp(tmp.game_id, game_id, MAX_GAME_ID_LEN) == 0) {
-                /* Found record - validate */
-                if (tmp.version != STORAGE_VERSION_GAME) {
-                    fclose(gf);
-                    return ERR_INVALID_PARAM;
-                }
-                uint32_t expected_crc = tmp.crc;
-                tmp.crc = 0;
-                if (!validate_crc(&tmp, sizeof(tmp) - sizeof(tmp.crc), expected_crc)) {
-                    fclose(gf);
-                    return ERR_INVALID_PARAM; /* CRC mismatch */
-                }
-                /* Populate game instance */
-                memset(game, 0, sizeof(*game));
-                snprintf(game->game_id, MAX_GAME_ID_LEN, "%s", tmp.game_id);
-                snprintf(game->player_a, MAX_PSEUDO_LEN, "%s", tmp.player_a);
-                snprintf(game->player_b, MAX_PSEUDO_LEN, "%s", tmp.player_b);
-                memcpy(&game->board, &tmp.board, sizeof(board_t));
-                game->active = true;
-                if (pthread_mutex_init(&game->lock, NULL) != 0) {
-                    fclose(gf);
-                    return ERR_INVALID_PARAM;
-                }
-                game->spectator_count = tmp.spectator_count;
-                for (int i = 0; i < tmp.spectator_count && i < MAX_SPECTATORS_PER_GAME; i++) {
-                    strncpy(game->spectators[i], tmp.spectators[i], MAX_PSEUDO_LEN - 1);
-                }
-                fclose(gf);
-                return SUCCESS;
-            }
-        }
-        fclose(gf);
-    }
+error_code_t storage_flush_games(void) {
+    return game_log_flush();
+}
 
-    /* Fallback: try per-game file */
-    char filename[512];
-    snprintf(filename, sizeof(filename), "%s/%s.dat", STORAGE_DIR, game_id);
+void storage_game_key(const char* label, game_log_id_t log_id, char key[MAX_GAME_ID_LEN]) {
+    /* Room for '#' and 20 digits */
+    snprintf(key, MAX_GAME_ID_LEN, "%.*s#%llu", MAX_GAME_ID_LEN - 22, label ? label : "",
+             (unsigned long long)log_id);
+}
 
-    void* data = NULL;
-    size_t size = 0;
-    error_code_t err = read_file(filename, &data, &size);
-    if (err != SUCCESS) {
-        return err;
-    }
+/* Log ID from a key; GAME_LOG_ID_NONE if it has none */
+static game_log_id_t parse_game_key(const char* key) {
+    const char* hash = strrchr(key, '#');
+    if (!hash || hash[1] < '0' || hash[1] > '9') return GAME_LOG_ID_NONE;
 
-    if (size != sizeof(persistent_game_t)) {
-        free(data);
-        return ERR_INVALID_PARAM;
-    }
+    char* end;
+    errno = 0;
+    unsigned long long id = strtoull(hash + 1, &end, 10);
+    if (*end != '\0' || errno != 0) return GAME_LOG_ID_NONE;
+    return (game_log_id_t)id;
+}
 
-    persistent_game_t* pg = (persistent_game_t*)data;
+error_code_t storage_load_game(const char* key, game_instance_t* game) {
+    if (!key || !game) return ERR_INVALID_PARAM;
 
-    /* Validate version */
-    if (pg->version != STORAGE_VERSION_GAME) {
-        free(data);
-        return ERR_INVALID_PARAM;
-    }
+    game_log_id_t id = parse_game_key(key);
+    if (id == GAME_LOG_ID_NONE) return ERR_GAME_NOT_FOUND;
 
-    /* Validate CRC (compute over struct excluding the CRC field) */
-    uint32_t expected_crc = pg->crc;
-    pg->crc = 0;  /* Zero out CRC field for validation */
-    if (!validate_crc(pg, sizeof(*pg) - sizeof(pg->crc), expected_crc)) {
-        fprintf(stderr, "storage_load_game: CRC mismatch (expected=%u)\n", expected_crc);
-        fflush(stderr);
-        free(data);
-        return ERR_INVALID_PARAM;
-    }
+    game_log_game_t logged;
+    error_code_t err = game_log_load(id, &logged);
+    if (err != SUCCESS) return err;
 
-    /* Copy data to game instance */
     memset(game, 0, sizeof(*game));
-    snprintf(game->game_id, MAX_GAME_ID_LEN, "%s", pg->game_id);
-    snprintf(game->player_a, MAX_PSEUDO_LEN, "%s", pg->player_a);
-    snprintf(game->player_b, MAX_PSEUDO_LEN, "%s", pg->player_b);
-    memcpy(&game->board, &pg->board, sizeof(board_t));
+    snprintf(game->game_id, MAX_GAME_ID_LEN, "%s", logged.label);
+    game->log_id = id;
+    game->player_a = logged.player_a;
+    game->player_b = logged.player_b;
+    game->board = logged.board;
+    game->move_seq = logged.moves;
     game->active = true;
-
-    /* Initialize mutex */
     if (pthread_mutex_init(&game->lock, NULL) != 0) {
-        free(data);
         return ERR_INVALID_PARAM;
     }
-
-    /* Copy spectators */
-    game->spectator_count = pg->spectator_count;
-    for (int i = 0; i < pg->spectator_count && i < MAX_SPECTATORS_PER_GAME; i++) {
-        strncpy(game->spectators[i], pg->spectators[i], MAX_PSEUDO_LEN - 1);
-    }
-
-    free(data);
     return SUCCESS;
 }
 
-error_code_t storage_delete_game(const char* game_id) {
-    if (!game_id) return ERR_INVALID_PARAM;
-
-    char filename[512];
-    snprintf(filename, sizeof(filename), "%s/%s.dat", STORAGE_DIR, game_id);
-
-    /* Delete per-game file if present */
-    if (unlink(filename) != 0 && errno != ENOENT) {
-        return ERR_NETWORK_ERROR;
-    }
-
-    /* Also remove from central games file by rewriting without this entry */
-    FILE* gf = fopen(GAMES_FILE, "rb");
-    if (!gf) return SUCCESS; /* Nothing to do if central file missing */
+error_code_t storage_delete_game(const char* key) {
+    if (!key) return ERR_INVALID_PARAM;
 
-    char tmpname[512];
-    snprintf(tmpname, sizeof(tmpname), "%s.tmp", GAMES_FILE);
-    FILE* out = fopen(tmpname, "wb");
-    if (!out) {
-        fclose(gf);
-        return SUCCESS; /* Best-effort removal */
-    }
+    game_log_id_t id = parse_game_key(key);
+    if (id == GAME_LOG_ID_NONE) return ERR_GAME_NOT_FOUND;
+    error_code_t err = game_log_delete(id);
+    if (err == SUCCESS) game_catalog_remove(id);
+    return err;
+}
 
-    persistent_game_t pg;
-    while (fread(&pg, 1, sizeof(pg), gf) == sizeof(pg)) {
-        if (strncmp(pg.game_id, game_id, MAX_GAME_ID_LEN) == 0) {
-            /* Skip this record */
+error_code_t storage_load_all_games(game_manager_t* manager, int* restored, int* skipped) {
+    if (!manager || !restored || !skipped) return ERR_INVALID_PARAM;
+    *restored = 0;
+    *skipped = 0;
+
+    /* The most recent games still in progress, as many as there is room for */
+    game_log_id_t ids[MAX_GAMES];
+    int count;
+    uint64_t total;
+    error_code_t err = game_log_list_active(ids, MAX_GAMES - game_manager_count_active_games(manager),
+                                            &count, &total);
+    if (err != SUCCESS) return err;
+    *skipped = (int)(total - (uint64_t)count);
+
+    uint8_t* moves = malloc(GAME_LOG_MAX_HISTORY);
+    if (!moves) return ERR_MAX_CAPACITY;
+
+    /* Newest first, each from its last snapshot and the moves after it,
+     * replayed through the rules; a game that does not replay stays in the
+     * log as it is */
+    for (int i = count - 1; i >= 0; i--) {
+        game_log_game_t saved;
+        err = game_log_load(ids[i], &saved);
+        if (err != SUCCESS) {
+            fprintf(stderr, "storage_load_all_games: game %llu does not replay (%s)\n",
+                    (unsigned long long)ids[i], error_to_string(err));
+            (*skipped)++;
+            continue;
+        }
+        if (game_manager_is_player_in_game(manager, saved.player_a) ||
+            game_manager_is_player_in_game(manager, saved.player_b)) {
+            (*skipped)++;
             continue;
         }
-        fwrite(&pg, 1, sizeof(pg), out);
-    }
-
-    fclose(gf);
-    fflush(out);
-    fclose(out);
-    /* Atomically replace central file */
-    rename(tmpname, GAMES_FILE);
-
-    return SUCCESS;
-}
-
-error_code_t storage_load_all_games(game_manager_t* manager) {
-    if (!manager) return ERR_INVALID_PARAM;
 
-    /* For now, we'll load games on-demand when requested */
-    /* In a full implementation, we might scan the data directory */
-    /* and load all game files on startup */
+        uint32_t kept = 0;
+        if (game_log_history(ids[i], moves, GAME_LOG_MAX_HISTORY, &kept) != SUCCESS) kept = 0;
+        if (game_manager_restore_game(manager, &saved, moves, kept, NULL) == SUCCESS) {
+            (*restored)++;
+        } else {
+            (*skipped)++;
+        }
+    }
 
+    free(moves);
     return SUCCESS;
 }
 
-/* Player persistence */
-error_code_t storage_save_players(const matchmaking_t* mm) {
-    if (!mm) return ERR_INVALID_PARAM;
-
-    /* For each player, save their data */
-    for (int i = 0; i < mm->player_count; i++) {
-        const player_entry_t* entry = &mm->players[i];
-
-        persistent_player_t pp;
-        memset(&pp, 0, sizeof(pp));
-
-        pp.version = STORAGE_VERSION_PLAYER;
-        strncpy(pp.pseudo, entry->info.pseudo, MAX_PSEUDO_LEN - 1);
-        pp.games_played = entry->info.games_played;
-        pp.games_won = entry->info.games_won;
-        pp.games_lost = entry->info.games_lost;
-        pp.total_score = entry->info.total_score;
-        /* Copy bio lines */
-        pp.bio_lines = entry->info.bio_lines;
-        for (int b = 0; b < pp.bio_lines && b < 10; b++) {
-            strncpy(pp.bio[b], entry->info.bio[b], sizeof(pp.bio[b]) - 1);
+error_code_t storage_convert_legacy_games(const char* path, int* converted, int* skipped) {
+    if (!path || !converted || !skipped) return ERR_INVALID_PARAM;
+    *converted = 0;
+    *skipped = 0;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) return ERR_NETWORK_ERROR;
+
+    error_code_t err = SUCCESS;
+    legacy_game_t record;
+    while (fread(&record, 1, sizeof(record), file) == sizeof(record)) {
+        uint32_t expected_crc = record.crc;
+        record.crc = 0;
+        if (record.version != STORAGE_VERSION_LEGACY_GAME ||
+            !validate_crc(&record, sizeof(record) - sizeof(record.crc), expected_crc)) {
+            (*skipped)++;
+            continue;
         }
-        /* Copy friends */
-        pp.friend_count = entry->info.friend_count;
-        for (int f = 0; f < pp.friend_count && f < MAX_FRIENDS; f++) {
-            strncpy(pp.friends[f], entry->info.friends[f], MAX_PSEUDO_LEN - 1);
+        record.game_id[MAX_GAME_ID_LEN - 1] = '\0';
+        record.player_a[MAX_PSEUDO_LEN - 1] = '\0';
+        record.player_b[MAX_PSEUDO_LEN - 1] = '\0';
+
+        game_log_game_t game;
+        memset(&game, 0, sizeof(game));
+        snprintf(game.label, sizeof(game.label), "%s", record.game_id);
+        game.player_a = pseudo_intern(record.player_a);
+        game.player_b = pseudo_intern(record.player_b);
+        game.board = record.board;
+        game.board.created_at = record.created_at;
+        game.board.last_move_at = record.last_move_at;
+        if (game.player_a == PSEUDO_ID_NONE || game.player_b == PSEUDO_ID_NONE) {
+            (*skipped)++;
+            continue;
         }
 
-        /* Calculate CRC */
-        pp.crc = calculate_crc32(&pp, sizeof(pp) - sizeof(pp.crc));
+        game_log_id_t id;
+        err = game_log_import(&game, &id);
+        if (err == SUCCESS) err = game_catalog_add(id, game.label, game.player_a, game.player_b, game.board.created_at);
+        if (err != SUCCESS) break;
+        game_catalog_finish(id, game.board.state, game.board.winner, 0);
+        (*converted)++;
+    }
+    fclose(file);
 
-        /* Create filename */
-        char filename[512];
-        snprintf(filename, sizeof(filename), "%s/player_%s.dat", STORAGE_DIR, entry->info.pseudo);
+    if (err != SUCCESS) return err;
+    return game_log_flush();
+}
 
-        /* Write player file */
-        error_code_t r = atomic_write(filename, &pp, sizeof(pp));
-        if (r != SUCCESS) {
-            fprintf(stderr, "storage_save_players: failed to write %s (err=%d)\n", filename, r);
-            fflush(stderr);
-            return r;
-        }
-    }
+/* Player persistence */
 
+/* Validate a record read from the store or an old player file */
+static error_code_t check_player(persistent_player_t* pp) {
+    bool zlib_crc = pp->version == STORAGE_VERSION_PLAYER_CRC32;
+    if (pp->version != STORAGE_VERSION_PLAYER && !zlib_crc) return ERR_SERIALIZATION;
+    uint32_t expected = pp->crc;
+    pp->crc = 0;
+    size_t size = sizeof(*pp) - sizeof(pp->crc);
+    if ((zlib_crc ? calculate_crc32(pp, size) : checksum_crc32c(0, pp, size)) != expected) return ERR_SERIALIZATION;
+    pp->crc = expected;
     return SUCCESS;
 }
 
-error_code_t storage_load_players(matchmaking_t* mm) {
-    if (!mm) return ERR_INVALID_PARAM;
+/* Read and validate data/player_<pseudo>.dat, from before the player store */
+static error_code_t read_player_file(const char* filename, persistent_player_t* pp) {
+    void* data = NULL;
+    size_t sz = 0;
+    error_code_t r = read_file(filename, &data, &sz);
+    if (r != SUCCESS) return r;
 
-    /* Clear current list */
-    mm->player_count = 0;
+    if (sz != sizeof(persistent_player_t)) {
+        free(data);
+        return ERR_SERIALIZATION;
+    }
+    memcpy(pp, data, sizeof(*pp));
+    free(data);
+    return check_player(pp);
+}
 
-    /* Scan data directory for player_*.dat files */
+/* Move the player_*.dat files into a new store; they are left in place */
+static error_code_t import_legacy_players(int* imported) {
+    *imported = 0;
     DIR* d = opendir(STORAGE_DIR);
     if (!d) return ERR_NETWORK_ERROR;
 
+    error_code_t err = SUCCESS;
     struct dirent* ent;
-    while ((ent = readdir(d)) != NULL) {
+    while (err == SUCCESS && (ent = readdir(d)) != NULL) {
         /* Look for files starting with "player_" and ending with ".dat" */
         if (strncmp(ent->d_name, "player_", 7) != 0) continue;
         size_t len = strlen(ent->d_name);
         if (len <= 4) continue;
         if (strcmp(ent->d_name + len - 4, ".dat") != 0) continue;
 
-        /* Build filename */
         char fname[512];
         snprintf(fname, sizeof(fname), "%s/%s", STORAGE_DIR, ent->d_name);
 
-        void* data = NULL;
-        size_t sz = 0;
-        error_code_t r = read_file(fname, &data, &sz);
-        if (r != SUCCESS) continue;
+        persistent_player_t pp;
+        if (read_player_file(fname, &pp) != SUCCESS) continue;
+        pseudo_id_t id = pseudo_intern(pp.pseudo);
+        if (id == PSEUDO_ID_NONE) continue;
+        err = player_store_put(id, &pp);
+        if (err == SUCCESS) (*imported)++;
+    }
+    closedir(d);
 
-        if (sz != sizeof(persistent_player_t)) {
-            free(data);
-            continue;
-        }
+    if (err == SUCCESS && *imported > 0) err = player_store_flush();
+    return err;
+}
 
-        persistent_player_t* pp = (persistent_player_t*)data;
-        /* Validate version and CRC */
-        if (pp->version != STORAGE_VERSION_PLAYER) {
-            free(data);
-            continue;
-        }
-        uint32_t expected = pp->crc;
-        pp->crc = 0;
-        if (!validate_crc(pp, sizeof(*pp) - sizeof(pp->crc), expected)) {
-            free(data);
-            continue;
-        }
+static void copy_profile_out(const player_profile_t* profile, persistent_player_t* pp) {
+    memset(pp->bio, 0, sizeof(pp->bio));
+    pp->bio_lines = profile->bio_lines;
+    for (int b = 0; b < pp->bio_lines && b < 10; b++) {
+        strncpy(pp->bio[b], profile->bio[b], sizeof(pp->bio[b]) - 1);
+    }
+    memset(pp->friends, 0, sizeof(pp->friends));
+    pp->friend_count = profile->friend_count;
+    for (int f = 0; f < pp->friend_count && f < MAX_FRIENDS; f++) {
+        strncpy(pp->friends[f], pseudo_name(profile->friends[f]), MAX_PSEUDO_LEN - 1);
+    }
+}
 
-        /* Add to matchmaking list if space */
-        if (mm->player_count < MAX_PLAYERS) {
-            player_entry_t* entry = &mm->players[mm->player_count];
-            memset(entry, 0, sizeof(*entry));
-            snprintf(entry->info.pseudo, MAX_PSEUDO_LEN, "%s", pp->pseudo);
-            entry->info.games_played = pp->games_played;
-            entry->info.games_won = pp->games_won;
-            entry->info.games_lost = pp->games_lost;
-            entry->info.total_score = pp->total_score;
-            entry->info.bio_lines = pp->bio_lines;
-            for (int b = 0; b < pp->bio_lines && b < 10; b++) {
-                snprintf(entry->info.bio[b], sizeof(entry->info.bio[b]), "%s", pp->bio[b]);
-            }
-            entry->info.friend_count = pp->friend_count;
-            for (int f = 0; f < pp->friend_count && f < MAX_FRIENDS; f++) {
-                snprintf(entry->info.friends[f], MAX_PSEUDO_LEN, "%s", pp->friends[f]);
-            }
-            mm->player_count++;
-        }
+/* Only copies the record into the player store; its flusher writes it */
+error_code_t storage_save_player(const matchmaking_t* mm, int index) {
+    if (!mm || index < 0 || index >= mm->player_count) return ERR_INVALID_PARAM;
+    const player_entry_t* entry = &mm->players[index];
+    const char* pseudo = pseudo_name(entry->id);
 
-        free(data);
+    persistent_player_t pp;
+    memset(&pp, 0, sizeof(pp));
+
+    /* A profile never loaded is unchanged: keep what the store has */
+    if (mm->profiles[index]) {
+        copy_profile_out(mm->profiles[index], &pp);
+    } else if (player_store_get(entry->id, &pp) != SUCCESS || check_player(&pp) != SUCCESS) {
+        memset(&pp, 0, sizeof(pp));
+    }
+
+    pp.version = STORAGE_VERSION_PLAYER;
+    memset(pp.pseudo, 0, sizeof(pp.pseudo));
+    strncpy(pp.pseudo, pseudo, MAX_PSEUDO_LEN - 1);
+    pp.games_played = entry->games_played;
+    pp.games_won = entry->games_won;
+    pp.games_lost = entry->games_lost;
+    pp.total_score = entry->total_score;
+
+    /* Calculate CRC */
+    pp.crc = 0;
+    pp.crc = checksum_crc32c(0, &pp, sizeof(pp) - sizeof(pp.crc));
+
+    error_code_t r = player_store_put(entry->id, &pp);
+    if (r != SUCCESS) {
+        fprintf(stderr, "storage_save_player: failed to store %s (err=%d)\n", pseudo, r);
+        fflush(stderr);
+    }
+    return r;
+}
+
+error_code_t storage_save_players(const matchmaking_t* mm) {
+    if (!mm) return ERR_INVALID_PARAM;
+
+    /* For each player, save their data */
+    for (int i = 0; i < mm->player_count; i++) {
+        error_code_t r = storage_save_player(mm, i);
+        if (r != SUCCESS) return r;
     }
 
-    closedir(d);
     return SUCCESS;
 }
 
-/* Saved games for review */
+error_code_t storage_flush_players(void) {
+    return player_store_flush();
+}
+
+error_code_t storage_load_player_profile(const char* pseudo, player_profile_t* profile) {
+    if (!pseudo || !profile) return ERR_INVALID_PARAM;
+
+    pseudo_id_t id = pseudo_lookup(pseudo);
+    if (id == PSEUDO_ID_NONE) return ERR_PLAYER_NOT_FOUND;
+    persistent_player_t pp;
+    error_code_t r = player_store_get(id, &pp);
+    if (r != SUCCESS) return r;
+    r = check_player(&pp);
+    if (r != SUCCESS) return r;
+
+    memset(profile, 0, sizeof(*profile));
+    profile->bio_lines = pp.bio_lines;
+    for (int b = 0; b < pp.bio_lines && b < 10; b++) {
+        snprintf(profile->bio[b], sizeof(profile->bio[b]), "%s", pp.bio[b]);
+    }
+    profile->friend_count = pp.friend_count;
+    for (int f = 0; f < pp.friend_count && f < MAX_FRIENDS; f++) {
+        profile->friends[f] = pseudo_intern(pp.friends[f]);
+    }
+    return SUCCESS;
+}
+
+static void load_player(pseudo_id_t id, const void* record, void* arg) {
+    matchmaking_t* mm = arg;
+    if (mm->player_count >= MAX_PLAYERS) return;
+
+    persistent_player_t pp;
+    memcpy(&pp, record, sizeof(pp));
+    if (check_player(&pp) != SUCCESS) return;
+
+    player_entry_t* entry = &mm->players[mm->player_count];
+    memset(entry, 0, sizeof(*entry));
+    entry->id = id;
+    entry->games_played = pp.games_played;
+    entry->games_won = pp.games_won;
+    entry->games_lost = pp.games_lost;
+    entry->total_score = pp.total_score;
+    mm->player_count++;
+}
+
+/* Loads the hot records only; profiles are read when first needed */
+error_code_t storage_load_players(matchmaking_t* mm) {
+    if (!mm) return ERR_INVALID_PARAM;
+
+    /* Clear current list */
+    mm->player_count = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        free(mm->profiles[i]);
+        mm->profiles[i] = NULL;
+    }
+
+    return player_store_each(load_player, mm);
+}
+
+/* Saved games for review, from the catalog (game_catalog.h) */
 error_code_t storage_list_saved_games(int* count, char game_ids[][MAX_GAME_ID_LEN], int max_games) {
     if (!count || !game_ids) return ERR_INVALID_PARAM;
 
     *count = 0;
+    if (max_games < 1) return SUCCESS;
+
+    /* A batch at a time through the stack; listing allocates nothing */
+    game_log_info_t games[LIST_BATCH];
+    game_catalog_filter_t filter;
+    memset(&filter, 0, sizeof(filter));
+    game_log_id_t from = GAME_LOG_ID_NONE;
+    do {
+        int want = max_games - *count < LIST_BATCH ? max_games - *count : LIST_BATCH;
+        int got;
+        error_code_t err = game_catalog_page(&filter, from, games, want, &got, &from);
+        if (err != SUCCESS) return err;
+        for (int i = 0; i < got; i++) {
+            storage_game_key(games[i].label, games[i].id, game_ids[(*count)++]);
+        }
+    } while (from != GAME_LOG_ID_NONE && *count < max_games);
+    return SUCCESS;
+}
 
-    /* Scan data directory for game files */
-    DIR* d = opendir(STORAGE_DIR);
-    if (!d) return ERR_NETWORK_ERROR;
+/* The cursor is the log ID of the first game of the page; the catalog
+ * finds it with a binary search and reads no disk */
+error_code_t storage_list_saved_games_page(const char* player, game_log_id_t cursor, game_info_t* games_out,
+                                           int max_games, int* count, game_log_id_t* next_cursor) {
+    if (!games_out || !count || !next_cursor || max_games < 1) return ERR_INVALID_PARAM;
 
-    struct dirent* ent;
-    while ((ent = readdir(d)) != NULL && *count < max_games) {
-        /* Look for files ending with ".dat" but not "player_" prefixed */
-        size_t len = strlen(ent->d_name);
-        if (len <= 4) continue;
-        if (strcmp(ent->d_name + len - 4, ".dat") != 0) continue;
-        if (strncmp(ent->d_name, "player_", 7) == 0) continue;  /* Skip player files */
+    *count = 0;
+    *next_cursor = 0;
 
-        /* Extract game ID from filename (remove .dat extension) */
-        char game_id[MAX_GAME_ID_LEN];
-        snprintf(game_id, MAX_GAME_ID_LEN, "%.*s", (int)(len - 4), ent->d_name);
-        snprintf(game_ids[*count], MAX_GAME_ID_LEN, "%s", game_id);
-        (*count)++;
+    game_catalog_filter_t filter;
+    memset(&filter, 0, sizeof(filter));
+    if (player && player[0] != '\0') {
+        filter.player = pseudo_lookup(player);
+        if (filter.player == PSEUDO_ID_NONE) return SUCCESS;  /* Never played */
     }
 
-    closedir(d);
+    game_log_info_t games[LIST_BATCH];
+    game_log_id_t next = cursor;
+    do {
+        int want = max_games - *count < LIST_BATCH ? max_games - *count : LIST_BATCH;
+        int got;
+        error_code_t err = game_catalog_page(&filter, next, games, want, &got, &next);
+        if (err != SUCCESS) return err;
+        for (int i = 0; i < got; i++) {
+            game_info_t* info = &games_out[(*count)++];
+            info->game = GAME_HANDLE_NONE;  /* Saved games are viewed by key */
+            storage_game_key(games[i].label, games[i].id, info->game_id);
+            snprintf(info->player_a, MAX_PSEUDO_LEN, "%s", pseudo_name(games[i].player_a));
+            snprintf(info->player_b, MAX_PSEUDO_LEN, "%s", pseudo_name(games[i].player_b));
+            info->spectator_count = 0;  /* Not applicable for saved games */
+            info->state = games[i].state;
+        }
+    } while (next != GAME_LOG_ID_NONE && *count < max_games);
+    *next_cursor = next;
     return SUCCESS;
 }
 
-error_code_t storage_load_saved_game(const char* game_id, game_instance_t* game) {
+error_code_t storage_load_saved_game(const char* key, game_instance_t* game) {
     /* Reuse the existing storage_load_game function */
-    return storage_load_game(game_id, game);
+    return storage_load_game(key, game);
 }
\ No newline at end of file
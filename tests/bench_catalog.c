@@ -0,0 +1,138 @@
+/* Saved-Game Catalog Benchmark
+ * Listing pages of stored games: building the catalog from the log, then
+ * pages filtered by player and by date from the catalog, against scanning
+ * the log index and reading each label from disk (game_log_scan).
+ *
+ * Usage: bench_catalog [games] [players]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "server/game_catalog.h"
+#include "server/game_log.h"
+#include "server/pseudo_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PAGE 50
+#define QUERIES 1000
+#define BASE_TIME 1600000000
+
+static double clock_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* One game a minute, between players i and i + 1 */
+static void fill(uint64_t games, pseudo_id_t* players, int player_count) {
+    game_log_game_t game;
+    memset(&game, 0, sizeof(game));
+    board_init(&game.board);
+    game.board.state = GAME_STATE_FINISHED;
+    game.board.winner = WINNER_A;
+    for (uint64_t i = 0; i < games; i++) {
+        game.player_a = players[i % (uint64_t)player_count];
+        game.player_b = players[(i + 1) % (uint64_t)player_count];
+        game.board.created_at = (time_t)(BASE_TIME + i * 60);
+        snprintf(game.label, sizeof(game.label), "bench-%llu", (unsigned long long)i);
+        game_log_id_t id;
+        if (game_log_import(&game, &id) != SUCCESS) exit(1);
+    }
+}
+
+static game_log_info_t g_page[PAGE];
+
+/* A page of a player's games starting at a random game of theirs */
+static double time_player_pages(bool catalog, pseudo_id_t* players, int player_count, uint64_t games) {
+    srand(7);
+    double start = clock_seconds();
+    for (int q = 0; q < QUERIES; q++) {
+        int p = rand() % player_count;
+        game_log_id_t from = (game_log_id_t)(rand() % (int)(games / 2)) + 1;
+        int count;
+        game_log_id_t next;
+        if (catalog) {
+            game_catalog_filter_t filter = { players[p], 0, 0 };
+            game_catalog_page(&filter, from, g_page, PAGE, &count, &next);
+        } else {
+            game_log_scan(from, players[p], g_page, PAGE, &count, &next);
+        }
+    }
+    return (clock_seconds() - start) / QUERIES;
+}
+
+/* A page of a random hour's games */
+static double time_date_pages(uint64_t games) {
+    srand(11);
+    double start = clock_seconds();
+    for (int q = 0; q < QUERIES; q++) {
+        time_t since = BASE_TIME + (time_t)(rand() % (int)games) * 60;
+        game_catalog_filter_t filter = { PSEUDO_ID_NONE, since, since + 3600 };
+        int count;
+        game_log_id_t next;
+        game_catalog_page(&filter, GAME_LOG_ID_NONE, g_page, PAGE, &count, &next);
+    }
+    return (clock_seconds() - start) / QUERIES;
+}
+
+int main(int argc, char** argv) {
+    uint64_t games = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000;
+    int player_count = argc > 2 ? atoi(argv[2]) : 1000;
+    if (games < 2) games = 100000;
+    if (player_count < 2) player_count = 1000;
+
+    char dir[] = "/tmp/awale_catalog_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    pseudo_id_t* players = malloc((size_t)player_count * sizeof(pseudo_id_t));
+    if (!players) return 1;
+    for (int i = 0; i < player_count; i++) {
+        char pseudo[MAX_PSEUDO_LEN];
+        snprintf(pseudo, sizeof(pseudo), "bench%d", i);
+        players[i] = pseudo_intern(pseudo);
+    }
+
+    game_log_set_sync(GAME_LOG_SYNC_NONE, 0);
+    if (game_log_open(dir) != SUCCESS) {
+        fprintf(stderr, "game_log_open failed\n");
+        return 1;
+    }
+    fill(games, players, player_count);
+    if (game_log_flush() != SUCCESS) return 1;
+
+    if (game_catalog_build() != SUCCESS) {
+        fprintf(stderr, "game_catalog_build failed\n");
+        return 1;
+    }
+    game_catalog_stats_t stats;
+    game_catalog_get_stats(&stats);
+    printf("Catalog of %llu games, %u players: built in %u ms\n", (unsigned long long)stats.games,
+           stats.players, stats.build_ms);
+
+    double scan = time_player_pages(false, players, player_count, games);
+    double catalog = time_player_pages(true, players, player_count, games);
+    double dates = time_date_pages(games);
+    printf("  player page of %d, log scan: %9.1f us\n", PAGE, scan * 1e6);
+    printf("  player page of %d, catalog:  %9.1f us  (%.0fx)\n", PAGE, catalog * 1e6, scan / catalog);
+    printf("  one hour's games, catalog:   %9.1f us\n", dates * 1e6);
+
+    game_catalog_clear();
+    game_log_stats_t log_stats;
+    game_log_get_stats(&log_stats);
+    game_log_close();
+    for (uint32_t segment = 1; segment <= log_stats.segments; segment++) {
+        char path[sizeof(dir) + 16];
+        snprintf(path, sizeof(path), "%s/%08u.seg", dir, segment);
+        unlink(path);
+    }
+    rmdir(dir);
+    free(players);
+    return 0;
+}
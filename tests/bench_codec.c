@@ -0,0 +1,359 @@
+/* Compact Codec Benchmark
+ * For every message type: payload bytes on the wire with the raw struct
+ * encoding and with the compact codec, plus encode/decode cost in ns
+ *
+ * Usage: bench_codec [iterations]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "network/codec.h"
+#include "network/board_delta.h"
+#include "common/protocol.h"
+#include "common/messages.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Big enough for any message struct, including full lists */
+typedef union {
+    msg_chat_history_t chat_history;
+    msg_player_list_t player_list;
+    msg_game_list_t game_list;
+    msg_bio_response_t bio;
+    char bytes[MAX_PAYLOAD_SIZE];
+} sample_t;
+
+static void fill_game(game_info_t* game, int i) {
+    game->game = GAME_HANDLE_MAKE(i, 1);
+    snprintf(game->game_id, MAX_GAME_ID_LEN, "player%d-vs-player%d", i, i + 1);
+    snprintf(game->player_a, MAX_PSEUDO_LEN, "player%d", i);
+    snprintf(game->player_b, MAX_PSEUDO_LEN, "player%d", i + 1);
+    game->spectator_count = i % 3;
+    game->state = GAME_STATE_IN_PROGRESS;
+}
+
+static void fill_board(msg_board_state_t* board) {
+    board->exists = true;
+    board->game = GAME_HANDLE_MAKE(17, 3);
+    snprintf(board->game_id, MAX_GAME_ID_LEN, "alice-vs-bob");
+    snprintf(board->player_a, MAX_PSEUDO_LEN, "alice");
+    snprintf(board->player_b, MAX_PSEUDO_LEN, "bob");
+    for (int i = 0; i < NUM_PITS; i++) board->pits[i] = (i * 3) % 7;
+    board->score_a = 12;
+    board->score_b = 9;
+    board->current_player = PLAYER_B;
+    board->state = GAME_STATE_IN_PROGRESS;
+    board->winner = NO_WINNER;
+    board->seq = 42;
+}
+
+/* Representative payload for `type`; returns the size a raw sender uses */
+static size_t make_sample(message_type_t type, void* out) {
+    memset(out, 0, sizeof(sample_t));
+
+    switch (type) {
+        case MSG_PORT_NEGOTIATION: {
+            msg_port_negotiation_t* msg = out;
+            msg->my_port = 12400;
+            return sizeof(*msg);
+        }
+        case MSG_CONNECT: {
+            msg_connect_t* msg = out;
+            snprintf(msg->pseudo, MAX_PSEUDO_LEN, "alice");
+            snprintf(msg->version, sizeof(msg->version), "%s", PROTOCOL_VERSION_COMPACT);
+            return sizeof(*msg);
+        }
+        case MSG_CHALLENGE: {
+            msg_challenge_t* msg = out;
+            snprintf(msg->challenger, MAX_PSEUDO_LEN, "alice");
+            snprintf(msg->opponent, MAX_PSEUDO_LEN, "bob");
+            return sizeof(*msg);
+        }
+        case MSG_ACCEPT_CHALLENGE:
+        case MSG_DECLINE_CHALLENGE:
+        case MSG_GET_BIO:
+        case MSG_GET_PLAYER_STATS:
+        case MSG_ADD_FRIEND:
+        case MSG_REMOVE_FRIEND:
+        case MSG_LIST_SAVED_GAMES:
+            snprintf((char*)out, MAX_PSEUDO_LEN, "bob");
+            return MAX_PSEUDO_LEN;
+        case MSG_CHALLENGE_ACCEPT:
+        case MSG_CHALLENGE_DECLINE: {
+            msg_challenge_accept_t* msg = out;
+            msg->challenge_id = 17;
+            snprintf(msg->response, sizeof(msg->response), "ok");
+            return sizeof(*msg);
+        }
+        case MSG_PLAY_MOVE: {
+            msg_play_move_t* msg = out;
+            msg->game = GAME_HANDLE_MAKE(17, 3);
+            snprintf(msg->player, MAX_PSEUDO_LEN, "alice");
+            msg->pit_index = 4;
+            return sizeof(*msg);
+        }
+        case MSG_GET_BOARD: {
+            msg_get_board_t* msg = out;
+            msg->game = GAME_HANDLE_MAKE(17, 3);
+            snprintf(msg->player_a, MAX_PSEUDO_LEN, "alice");
+            snprintf(msg->player_b, MAX_PSEUDO_LEN, "bob");
+            return sizeof(*msg);
+        }
+        case MSG_SPECTATE_GAME:
+        case MSG_STOP_SPECTATE:
+        case MSG_BOARD_RESYNC: {
+            msg_spectate_game_t* msg = out;
+            msg->game = GAME_HANDLE_MAKE(17, 3);
+            return sizeof(*msg);
+        }
+        case MSG_VIEW_SAVED_GAME:
+            snprintf((char*)out, MAX_GAME_ID_LEN, "alice-vs-bob");
+            return MAX_GAME_ID_LEN;
+        case MSG_SET_BIO: {
+            msg_set_bio_t* msg = out;
+            msg->bio_lines = 2;
+            snprintf(msg->bio[0], 256, "Awale player since 2019.");
+            snprintf(msg->bio[1], 256, "Likes long games.");
+            return sizeof(*msg);
+        }
+        case MSG_SEND_CHAT: {
+            msg_send_chat_t* msg = out;
+            snprintf(msg->recipient, MAX_PSEUDO_LEN, "bob");
+            snprintf(msg->message, MAX_CHAT_LEN, "good game, rematch?");
+            return sizeof(*msg);
+        }
+        case MSG_CHAT_MESSAGE: {
+            msg_chat_message_t* msg = out;
+            snprintf(msg->sender, MAX_PSEUDO_LEN, "alice");
+            snprintf(msg->recipient, MAX_PSEUDO_LEN, "bob");
+            snprintf(msg->message, MAX_CHAT_LEN, "good game, rematch?");
+            msg->timestamp = 1700000000;
+            return sizeof(*msg);
+        }
+        case MSG_CHAT_HISTORY: {
+            msg_chat_history_t* msg = out;
+            snprintf(msg->target_player, MAX_PSEUDO_LEN, "bob");
+            msg->count = 10;
+            for (int i = 0; i < msg->count; i++) {
+                snprintf(msg->messages[i].sender, MAX_PSEUDO_LEN, "%s", i % 2 ? "bob" : "alice");
+                snprintf(msg->messages[i].recipient, MAX_PSEUDO_LEN, "%s", i % 2 ? "alice" : "bob");
+                snprintf(msg->messages[i].message, MAX_CHAT_LEN, "message number %d", i);
+                msg->messages[i].timestamp = 1700000000 + i;
+            }
+            return offsetof(msg_chat_history_t, messages) + msg->count * sizeof(msg_chat_message_t);
+        }
+        case MSG_LIST_FRIENDS: {
+            msg_list_friends_t* msg = out;
+            msg->count = 5;
+            for (int i = 0; i < msg->count; i++) snprintf(msg->friends[i], MAX_PSEUDO_LEN, "friend%d", i);
+            return offsetof(msg_list_friends_t, friends) + msg->count * MAX_PSEUDO_LEN;
+        }
+        case MSG_SAVED_GAME_LIST:
+        case MSG_GAME_LIST:
+        case MSG_MY_GAME_LIST: {
+            msg_game_list_t* msg = out;
+            msg->count = 8;
+            for (int i = 0; i < msg->count; i++) fill_game(&msg->games[i], i);
+            return offsetof(msg_game_list_t, games) + msg->count * sizeof(game_info_t);
+        }
+        case MSG_SAVED_GAME_STATE:
+        case MSG_BOARD_STATE:
+            fill_board(out);
+            return sizeof(msg_board_state_t);
+        case MSG_CONNECT_ACK: {
+            msg_connect_ack_t* msg = out;
+            msg->success = true;
+            snprintf(msg->message, sizeof(msg->message), "Bienvenue sur Awale!");
+            snprintf(msg->session_id, sizeof(msg->session_id), "S1a2b3c4d");
+            snprintf(msg->version, sizeof(msg->version), "%s", PROTOCOL_VERSION_COMPACT);
+            return sizeof(*msg);
+        }
+        case MSG_ERROR: {
+            msg_error_t* msg = out;
+            msg->error_code = ERR_INVALID_MOVE;
+            snprintf(msg->error_msg, sizeof(msg->error_msg), "Invalid move");
+            return sizeof(*msg);
+        }
+        case MSG_PLAYER_LIST: {
+            msg_player_list_t* msg = out;
+            msg->count = 10;
+            for (int i = 0; i < msg->count; i++) {
+                snprintf(msg->players[i].pseudo, MAX_PSEUDO_LEN, "player%d", i);
+                snprintf(msg->players[i].ip, MAX_IP_LEN, "192.168.1.%d", 10 + i);
+            }
+            return offsetof(msg_player_list_t, players) + msg->count * sizeof(player_list_item_t);
+        }
+        case MSG_CHALLENGE_RECEIVED: {
+            msg_challenge_received_t* msg = out;
+            snprintf(msg->from, MAX_PSEUDO_LEN, "alice");
+            snprintf(msg->message, sizeof(msg->message), "alice challenges you");
+            msg->challenge_id = 17;
+            return sizeof(*msg);
+        }
+        case MSG_GAME_STARTED: {
+            msg_game_started_t* msg = out;
+            msg->game = GAME_HANDLE_MAKE(17, 3);
+            snprintf(msg->game_id, MAX_GAME_ID_LEN, "alice-vs-bob");
+            snprintf(msg->player_a, MAX_PSEUDO_LEN, "alice");
+            snprintf(msg->player_b, MAX_PSEUDO_LEN, "bob");
+            msg->your_side = PLAYER_B;
+            return sizeof(*msg);
+        }
+        case MSG_MOVE_RESULT: {
+            msg_move_result_t* msg = out;
+            msg->success = true;
+            snprintf(msg->message, sizeof(msg->message), "Move played");
+            msg->seeds_captured = 3;
+            msg->winner = NO_WINNER;
+            return sizeof(*msg);
+        }
+        case MSG_GAME_OVER: {
+            msg_game_over_t* msg = out;
+            msg->game = GAME_HANDLE_MAKE(17, 3);
+            msg->winner = WINNER_A;
+            msg->score_a = 26;
+            msg->score_b = 18;
+            snprintf(msg->message, sizeof(msg->message), "alice wins");
+            return sizeof(*msg);
+        }
+        case MSG_CHALLENGE_LIST: {
+            msg_challenge_list_t* msg = out;
+            msg->count = 3;
+            for (int i = 0; i < msg->count; i++) snprintf(msg->challengers[i], MAX_PSEUDO_LEN, "rival%d", i);
+            return offsetof(msg_challenge_list_t, challengers) + msg->count * MAX_PSEUDO_LEN;
+        }
+        case MSG_SPECTATE_ACK: {
+            msg_spectate_ack_t* msg = out;
+            msg->success = true;
+            snprintf(msg->message, sizeof(msg->message), "Now spectating");
+            msg->spectator_count = 2;
+            return sizeof(*msg);
+        }
+        case MSG_SPECTATOR_JOINED: {
+            msg_spectator_joined_t* msg = out;
+            snprintf(msg->spectator, MAX_PSEUDO_LEN, "carol");
+            msg->spectator_count = 2;
+            msg->game = GAME_HANDLE_MAKE(17, 3);
+            return sizeof(*msg);
+        }
+        case MSG_BIO_RESPONSE: {
+            msg_bio_response_t* msg = out;
+            msg->success = true;
+            snprintf(msg->player, MAX_PSEUDO_LEN, "bob");
+            msg->bio_lines = 2;
+            snprintf(msg->bio[0], 256, "Awale player since 2019.");
+            snprintf(msg->bio[1], 256, "Likes long games.");
+            return sizeof(*msg);
+        }
+        case MSG_PLAYER_STATS: {
+            msg_player_stats_t* msg = out;
+            msg->success = true;
+            snprintf(msg->player, MAX_PSEUDO_LEN, "bob");
+            msg->games_played = 120;
+            msg->games_won = 64;
+            msg->games_lost = 50;
+            msg->total_score = 2710;
+            return sizeof(*msg);
+        }
+        case MSG_BOARD_DELTA: {
+            msg_board_delta_t* msg = out;
+            msg->seq = 43;
+            msg->pit_played = 4;
+            msg->current_player = PLAYER_A;
+            msg->state = GAME_STATE_IN_PROGRESS;
+            msg->winner = NO_WINNER;
+            msg->score_a = 12;
+            msg->score_b = 11;
+            msg->changed_count = 4;
+            for (int i = 0; i < msg->changed_count; i++) {
+                msg->changed[i].pit = (uint8_t)(4 + i);
+                msg->changed[i].seeds = (uint8_t)(i + 1);
+            }
+            msg->game = GAME_HANDLE_MAKE(17, 3);
+            return board_delta_wire_size(msg);
+        }
+        case MSG_LIST_PAGE: {
+            msg_list_page_t* msg = out;
+            msg->list_type = MSG_LIST_PLAYERS;
+            msg->cursor = 57;
+            msg->flags = LIST_FLAG_STREAM;
+            return sizeof(*msg);
+        }
+        case MSG_LIST_END: {
+            msg_list_end_t* msg = out;
+            msg->list_type = MSG_LIST_PLAYERS;
+            msg->entries = 100;
+            msg->frames = 2;
+            return sizeof(*msg);
+        }
+        default:
+            return 0;  /* No payload */
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 100000;
+    if (iterations <= 0) iterations = 100000;
+
+    static sample_t sample;
+    static sample_t decoded;
+    static char wire[MAX_PAYLOAD_SIZE];
+
+    printf("Compact codec benchmark (%d iterations, payload bytes exclude the %d-byte header)\n",
+           iterations, (int)HEADER_SIZE);
+    printf("  %-22s %8s %8s %7s %10s %10s\n", "type", "raw", "compact", "ratio", "encode ns", "decode ns");
+
+    size_t raw_total = 0, compact_total = 0;
+    for (int t = MSG_PORT_NEGOTIATION; t <= MSG_LIST_END; t++) {
+        message_type_t type = (message_type_t)t;
+        size_t raw_size = make_sample(type, &sample);
+
+        if (raw_size == 0 || !codec_supports(type)) {
+            printf("  %-22s %8zu %8s\n", message_type_to_string(type), raw_size, "(empty)");
+            continue;
+        }
+
+        size_t wire_size = 0, decoded_size = 0;
+        double start = now_ns();
+        for (int i = 0; i < iterations; i++) {
+            if (codec_encode(type, &sample, raw_size, wire, sizeof(wire), &wire_size) != SUCCESS) {
+                fprintf(stderr, "encode failed for %s\n", message_type_to_string(type));
+                return 1;
+            }
+        }
+        double encode_ns = (now_ns() - start) / iterations;
+
+        start = now_ns();
+        for (int i = 0; i < iterations; i++) {
+            if (codec_decode(type, wire, wire_size, &decoded, sizeof(decoded), &decoded_size) != SUCCESS) {
+                fprintf(stderr, "decode failed for %s\n", message_type_to_string(type));
+                return 1;
+            }
+        }
+        double decode_ns = (now_ns() - start) / iterations;
+
+        /* The round trip must be exact, not just fast */
+        if (decoded_size != raw_size || memcmp(&decoded, &sample, raw_size) != 0) {
+            fprintf(stderr, "round trip mismatch for %s\n", message_type_to_string(type));
+            return 1;
+        }
+
+        raw_total += raw_size;
+        compact_total += wire_size;
+        printf("  %-22s %8zu %8zu %6.1fx %10.0f %10.0f\n", message_type_to_string(type),
+               raw_size, wire_size, (double)raw_size / (double)wire_size, encode_ns, decode_ns);
+    }
+
+    printf("  %-22s %8zu %8zu %6.1fx\n", "total", raw_total, compact_total,
+           compact_total ? (double)raw_total / (double)compact_total : 0.0);
+    return 0;
+}
@@ -0,0 +1,165 @@
+/* Game Log Compaction Benchmark
+ * Finished games spread over sealed segments, then one compaction pass in
+ * the background: space before and after, compaction throughput, append
+ * latency while it runs against idle, and loading a game from a segment
+ * against from an archive.
+ *
+ * Usage: bench_compaction [games] [segments]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "server/game_log.h"
+#include "server/pseudo_table.h"
+#include "game/rules.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOADS 2000
+#define APPENDS 20000
+#define PLAYERS 1000
+
+static double clock_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* One whole game, the first legal pit each turn, then its GAME record;
+ * games differ by players, label and date */
+static void play_game(pseudo_id_t* players, int player_count, uint64_t i) {
+    pseudo_id_t a = players[i % (uint64_t)player_count], b = players[(i * 7 + 1) % (uint64_t)player_count];
+    if (a == b) b = players[(i + 1) % (uint64_t)player_count];
+    char label[MAX_GAME_ID_LEN];
+    snprintf(label, sizeof(label), "bench-%llu", (unsigned long long)i);
+
+    game_log_id_t id;
+    if (game_log_start(a, b, label, (time_t)(1600000000 + i * 60), &id) != SUCCESS) exit(1);
+    board_t board;
+    board_init(&board);
+    uint8_t moves[GAME_LOG_MAX_HISTORY];
+    uint32_t count = 0;
+    while (count < GAME_LOG_MAX_HISTORY && board.state == GAME_STATE_IN_PROGRESS) {
+        int pit = 0;
+        while (pit < NUM_PITS && rules_validate_move(&board, board.current_player, pit) != SUCCESS) pit++;
+        int captured;
+        if (pit == NUM_PITS || board_execute_move(&board, board.current_player, pit, &captured) != SUCCESS) break;
+        if (game_log_append_move(id, pit, &board) != SUCCESS) exit(1);
+        moves[count++] = (uint8_t)pit;
+    }
+    if (game_log_finish(id, label, moves, count, &board) != SUCCESS) exit(1);
+}
+
+static double time_loads(uint64_t games) {
+    srand(3);
+    game_log_game_t game;
+    double start = clock_seconds();
+    for (int i = 0; i < LOADS; i++) {
+        if (game_log_load((game_log_id_t)(rand() % (int)games) + 1, &game) != SUCCESS) exit(1);
+    }
+    return (clock_seconds() - start) / LOADS;
+}
+
+/* Average and worst append of APPENDS moves to a game in progress */
+static void time_appends(game_log_id_t id, volatile bool* until_done, double* avg, double* worst) {
+    board_t board;
+    board_init(&board);
+    double total = 0;
+    *worst = 0;
+    int n = 0;
+    while (n < APPENDS || (until_done && !*until_done)) {
+        double start = clock_seconds();
+        if (game_log_append_move(id, n % NUM_PITS, &board) != SUCCESS) exit(1);
+        double took = clock_seconds() - start;
+        total += took;
+        if (took > *worst) *worst = took;
+        n++;
+    }
+    *avg = total / n;
+}
+
+static volatile bool g_compacted;
+
+static void* compact_thread(void* arg) {
+    (void)arg;
+    if (game_log_compact() != SUCCESS) exit(1);
+    g_compacted = true;
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    uint64_t games = argc > 1 ? strtoull(argv[1], NULL, 10) : 40000;
+    int segments = argc > 2 ? atoi(argv[2]) : 8;
+    if (games < 100) games = 40000;
+    if (segments < 1) segments = 8;
+
+    char dir[] = "/tmp/awale_compaction_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    game_log_set_sync(GAME_LOG_SYNC_NONE, 0);
+    game_log_set_compaction(0);
+    if (game_log_open(dir) != SUCCESS) {
+        fprintf(stderr, "game_log_open failed\n");
+        return 1;
+    }
+    pseudo_id_t players[PLAYERS];
+    for (int i = 0; i < PLAYERS; i++) {
+        char pseudo[MAX_PSEUDO_LEN];
+        snprintf(pseudo, sizeof(pseudo), "bench%d", i);
+        players[i] = pseudo_intern(pseudo);
+    }
+    pseudo_id_t a = players[0], b = players[1];
+    for (uint64_t i = 0; i < games; i++) {
+        play_game(players, PLAYERS, i);
+        if ((i + 1) % (games / (uint64_t)segments) == 0 && game_log_rotate() != SUCCESS) return 1;
+    }
+    game_log_id_t active;
+    if (game_log_start(a, b, "active", time(NULL), &active) != SUCCESS) return 1;
+    if (game_log_flush() != SUCCESS) return 1;
+
+    game_log_stats_t before, after;
+    game_log_get_stats(&before);
+    printf("%llu finished games in %u segments: %.1f MB\n", (unsigned long long)games, before.segments - 1,
+           before.bytes / 1e6);
+    double segment_load = time_loads(games);
+    double idle_avg, idle_worst;
+    time_appends(active, NULL, &idle_avg, &idle_worst);
+
+    /* Compaction in the background, appends going on meanwhile */
+    pthread_t thread;
+    g_compacted = false;
+    if (pthread_create(&thread, NULL, compact_thread, NULL) != 0) return 1;
+    double busy_avg, busy_worst;
+    time_appends(active, &g_compacted, &busy_avg, &busy_worst);
+    pthread_join(thread, NULL);
+    game_log_get_stats(&after);
+
+    double mb = after.compacted_bytes / 1e6;
+    printf("Compacted %llu segment(s): %.1f MB -> %.1f MB archived (%.1f%% saved) in %llu ms, %.0f MB/s\n",
+           (unsigned long long)after.compactions, mb, after.archived_bytes / 1e6,
+           100.0 * (1.0 - (double)after.archived_bytes / (double)after.compacted_bytes),
+           (unsigned long long)after.compact_ms, after.compact_ms ? mb * 1000.0 / after.compact_ms : 0.0);
+    printf("  append, idle:             avg %6.2f us, worst %8.1f us\n", idle_avg * 1e6, idle_worst * 1e6);
+    printf("  append, while compacting: avg %6.2f us, worst %8.1f us\n", busy_avg * 1e6, busy_worst * 1e6);
+    printf("  load, from a segment:   %7.1f us\n", segment_load * 1e6);
+    printf("  load, from an archive:  %7.1f us\n", time_loads(games) * 1e6);
+
+    game_log_close();
+    const char* suffixes[] = { "seg", "arc" };
+    for (uint32_t segment = 1; segment <= after.segments; segment++) {
+        for (int s = 0; s < 2; s++) {
+            char path[sizeof(dir) + 16];
+            snprintf(path, sizeof(path), "%s/%08u.%s", dir, segment, suffixes[s]);
+            unlink(path);
+        }
+    }
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/* Frame Compression Benchmark
+ * Compression ratio and deflate/inflate cost for the bulk responses that
+ * qualify for HEADER_FLAG_COMPRESSED, measured on compact-encoded payloads
+ * filled to capacity
+ *
+ * Usage: bench_compression [iterations]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "network/codec.h"
+#include "network/compression.h"
+#include "common/protocol.h"
+#include "common/messages.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+
+static const char* g_words[] = {
+    "good", "game", "rematch", "nice", "capture", "seeds", "pit", "again",
+    "thanks", "tomorrow", "well", "played", "strategy", "lucky", "tonight"
+};
+#define NUM_WORDS (sizeof(g_words) / sizeof(g_words[0]))
+
+typedef union {
+    msg_player_list_t player_list;
+    msg_game_list_t game_list;
+    msg_chat_history_t chat_history;
+    msg_list_friends_t friends;
+    msg_challenge_list_t challenges;
+    msg_bio_response_t bio;
+} bulk_t;
+
+static void fill_sentence(char* out, size_t size, unsigned int seed) {
+    size_t used = 0;
+    out[0] = '\0';
+    for (int w = 0; w < 8 && used + 12 < size; w++) {
+        seed = seed * 1103515245u + 12345u;
+        used += (size_t)snprintf(out + used, size - used, "%s%s", w ? " " : "", g_words[(seed >> 16) % NUM_WORDS]);
+    }
+}
+
+/* Bulk response filled to capacity; returns the size a raw sender uses */
+static size_t make_bulk(message_type_t type, bulk_t* out) {
+    memset(out, 0, sizeof(*out));
+
+    switch (type) {
+        case MSG_PLAYER_LIST:
+            out->player_list.count = 100;
+            for (int i = 0; i < 100; i++) {
+                snprintf(out->player_list.players[i].pseudo, MAX_PSEUDO_LEN, "player%03d", i);
+                snprintf(out->player_list.players[i].ip, MAX_IP_LEN, "10.0.%d.%d", i / 50, 10 + i);
+            }
+            return offsetof(msg_player_list_t, players) + 100 * sizeof(player_list_item_t);
+        case MSG_GAME_LIST:
+        case MSG_MY_GAME_LIST:
+        case MSG_SAVED_GAME_LIST:
+            out->game_list.count = 50;
+            for (int i = 0; i < 50; i++) {
+                game_info_t* game = &out->game_list.games[i];
+                snprintf(game->player_a, MAX_PSEUDO_LEN, "player%03d", i * 2);
+                snprintf(game->player_b, MAX_PSEUDO_LEN, "player%03d", i * 2 + 1);
+                snprintf(game->game_id, MAX_GAME_ID_LEN, "%s-vs-%s", game->player_a, game->player_b);
+                game->spectator_count = i % 4;
+                game->state = GAME_STATE_IN_PROGRESS;
+            }
+            return offsetof(msg_game_list_t, games) + 50 * sizeof(game_info_t);
+        case MSG_CHAT_HISTORY:
+            snprintf(out->chat_history.target_player, MAX_PSEUDO_LEN, "bob");
+            out->chat_history.count = 50;
+            for (int i = 0; i < 50; i++) {
+                msg_chat_message_t* msg = &out->chat_history.messages[i];
+                snprintf(msg->sender, MAX_PSEUDO_LEN, "%s", i % 2 ? "bob" : "alice");
+                snprintf(msg->recipient, MAX_PSEUDO_LEN, "%s", i % 2 ? "alice" : "bob");
+                fill_sentence(msg->message, MAX_CHAT_LEN, (unsigned int)i);
+                msg->timestamp = 1700000000 + i * 37;
+            }
+            return offsetof(msg_chat_history_t, messages) + 50 * sizeof(msg_chat_message_t);
+        case MSG_LIST_FRIENDS:
+            out->friends.count = MAX_FRIENDS;
+            for (int i = 0; i < MAX_FRIENDS; i++) snprintf(out->friends.friends[i], MAX_PSEUDO_LEN, "friend%02d", i);
+            return offsetof(msg_list_friends_t, friends) + MAX_FRIENDS * MAX_PSEUDO_LEN;
+        case MSG_CHALLENGE_LIST:
+            out->challenges.count = 100;
+            for (int i = 0; i < 100; i++) snprintf(out->challenges.challengers[i], MAX_PSEUDO_LEN, "rival%03d", i);
+            return offsetof(msg_challenge_list_t, challengers) + 100 * MAX_PSEUDO_LEN;
+        case MSG_BIO_RESPONSE:
+            out->bio.success = true;
+            snprintf(out->bio.player, MAX_PSEUDO_LEN, "bob");
+            out->bio.bio_lines = 10;
+            for (int i = 0; i < 10; i++) fill_sentence(out->bio.bio[i], 256, (unsigned int)(100 + i));
+            return sizeof(msg_bio_response_t);
+        default:
+            return 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    if (iterations <= 0) iterations = 20000;
+
+    message_type_t types[] = {
+        MSG_PLAYER_LIST, MSG_GAME_LIST, MSG_MY_GAME_LIST, MSG_SAVED_GAME_LIST,
+        MSG_CHALLENGE_LIST, MSG_CHAT_HISTORY, MSG_LIST_FRIENDS, MSG_BIO_RESPONSE
+    };
+
+    static bulk_t sample;
+    static char compact[MAX_PAYLOAD_SIZE];
+    static char packed[MAX_PAYLOAD_SIZE];
+    static char inflated[MAX_PAYLOAD_SIZE];
+
+    printf("Frame compression benchmark (%d iterations, zlib level %d, threshold %d bytes)\n",
+           iterations, COMPRESSION_LEVEL, COMPRESSION_THRESHOLD);
+    printf("  %-18s %8s %10s %7s %11s %11s\n", "type", "compact", "compressed", "ratio", "deflate us", "inflate us");
+
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        size_t raw_size = make_bulk(types[t], &sample);
+        size_t compact_size, packed_size = 0, inflated_size;
+
+        if (codec_encode(types[t], &sample, raw_size, compact, sizeof(compact), &compact_size) != SUCCESS) {
+            fprintf(stderr, "encode failed for %s\n", message_type_to_string(types[t]));
+            return 1;
+        }
+        if (!compression_should_compress(types[t], compact_size)) {
+            printf("  %-18s %8zu %10s\n", message_type_to_string(types[t]), compact_size, "(below threshold)");
+            continue;
+        }
+
+        compression_reset_stats();
+        for (int i = 0; i < iterations; i++) {
+            if (compression_compress(compact, compact_size, packed, sizeof(packed), &packed_size) != SUCCESS) {
+                fprintf(stderr, "compress failed for %s\n", message_type_to_string(types[t]));
+                return 1;
+            }
+            if (compression_decompress(packed, packed_size, inflated, sizeof(inflated), &inflated_size) != SUCCESS ||
+                inflated_size != compact_size) {
+                fprintf(stderr, "decompress failed for %s\n", message_type_to_string(types[t]));
+                return 1;
+            }
+        }
+
+        compression_stats_t stats;
+        compression_get_stats(&stats);
+        printf("  %-18s %8zu %10zu %6.2fx %11.2f %11.2f\n", message_type_to_string(types[t]),
+               compact_size, packed_size, (double)compact_size / (double)packed_size,
+               (double)stats.compress_ns / iterations / 1000.0,
+               (double)stats.decompress_ns / iterations / 1000.0);
+    }
+
+    return 0;
+}
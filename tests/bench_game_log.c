@@ -0,0 +1,122 @@
+/* Game Log Benchmark
+ * Move-append latency as the number of stored games grows. The log is
+ * filled with started games up to each checkpoint, then moves are appended
+ * to games picked at random; latency should stay flat from 1k to 1M games.
+ * Also times rebuilding the index when the full log is reopened.
+ *
+ * Usage: bench_game_log [max_games]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "server/game_log.h"
+#include "server/pseudo_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PLAYERS 1000
+#define SAMPLES 20000
+
+static double clock_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static pseudo_id_t g_players[PLAYERS];
+
+static void fill(uint64_t from, uint64_t to) {
+    for (uint64_t i = from; i < to; i++) {
+        char label[MAX_GAME_ID_LEN];
+        snprintf(label, sizeof(label), "bench-game-%llu", (unsigned long long)i);
+        game_log_id_t id;
+        if (game_log_start(g_players[i % PLAYERS], g_players[(i * 7 + 1) % PLAYERS], label,
+                           time(NULL), &id) != SUCCESS) {
+            fprintf(stderr, "game_log_start failed at game %llu\n", (unsigned long long)i);
+            exit(1);
+        }
+    }
+}
+
+static void measure(uint64_t games, double* latencies) {
+    board_t board;
+    board_init(&board);
+    for (int i = 0; i < SAMPLES; i++) {
+        game_log_id_t id = 1 + (game_log_id_t)((unsigned)rand() % games);
+        double start = clock_seconds();
+        if (game_log_append_move(id, i % NUM_PITS, &board) != SUCCESS) {
+            fprintf(stderr, "game_log_append_move failed\n");
+            exit(1);
+        }
+        latencies[i] = clock_seconds() - start;
+    }
+    qsort(latencies, SAMPLES, sizeof(double), compare_double);
+
+    game_log_stats_t stats;
+    game_log_get_stats(&stats);
+    printf("  %9llu games  %4u segment(s) %8.1f MB  append p50 %6.2f us  p99 %6.2f us\n",
+           (unsigned long long)games, stats.segments, stats.bytes / 1e6,
+           latencies[SAMPLES / 2] * 1e6, latencies[SAMPLES * 99 / 100] * 1e6);
+}
+
+int main(int argc, char** argv) {
+    uint64_t max_games = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+
+    char dir[] = "/tmp/awale_game_log_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    if (game_log_open(dir) != SUCCESS) {
+        fprintf(stderr, "game_log_open failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < PLAYERS; i++) {
+        char pseudo[MAX_PSEUDO_LEN];
+        snprintf(pseudo, sizeof(pseudo), "bench%d", i);
+        g_players[i] = pseudo_intern(pseudo);
+    }
+
+    double* latencies = malloc(SAMPLES * sizeof(double));
+    if (!latencies) return 1;
+    srand(42);
+
+    printf("Move appends, %d samples per checkpoint:\n", SAMPLES);
+    uint64_t stored = 0;
+    for (uint64_t games = 1000; games <= max_games; games *= 10) {
+        fill(stored, games);
+        stored = games;
+        measure(games, latencies);
+    }
+
+    double start = clock_seconds();
+    game_log_close();
+    if (game_log_open(dir) != SUCCESS) {
+        fprintf(stderr, "game_log_open failed on reopen\n");
+        return 1;
+    }
+    double elapsed = clock_seconds() - start;
+    game_log_stats_t stats;
+    game_log_get_stats(&stats);
+    printf("Index rebuild: %llu games, %.1f MB in %.3f s\n", (unsigned long long)stats.games,
+           stats.bytes / 1e6, elapsed);
+    game_log_close();
+
+    for (uint32_t segment = 1; segment <= stats.segments; segment++) {
+        char path[sizeof(dir) + 16];
+        snprintf(path, sizeof(path), "%s/%08u.seg", dir, segment);
+        unlink(path);
+    }
+    rmdir(dir);
+    free(latencies);
+    return 0;
+}
@@ -0,0 +1,125 @@
+/* Group Commit Benchmark
+ * Threads append moves to their own games under each game log sync policy
+ * and report per-move latency and total moves/s. With one thread and sync
+ * on every move each append pays a whole fdatasync; with more threads the
+ * writer commits their moves together.
+ *
+ * Usage: bench_group_commit [moves_per_thread]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "server/game_log.h"
+#include "server/pseudo_table.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 16
+
+static double clock_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    game_log_id_t game;
+    int moves;
+    double* latencies;
+} appender_t;
+
+static void* appender_main(void* arg) {
+    appender_t* appender = (appender_t*)arg;
+    board_t board;
+    board_init(&board);
+    for (int i = 0; i < appender->moves; i++) {
+        double start = clock_seconds();
+        if (game_log_append_move(appender->game, i % NUM_PITS, &board) != SUCCESS) {
+            fprintf(stderr, "game_log_append_move failed\n");
+            exit(1);
+        }
+        appender->latencies[i] = clock_seconds() - start;
+    }
+    return NULL;
+}
+
+static void run(const char* dir, game_log_sync_t policy, int interval_ms, int threads, int moves) {
+    game_log_set_sync(policy, interval_ms);
+    if (game_log_open(dir) != SUCCESS) {
+        fprintf(stderr, "game_log_open failed\n");
+        exit(1);
+    }
+
+    pseudo_id_t a = pseudo_intern("bench_a"), b = pseudo_intern("bench_b");
+    appender_t appenders[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    double* latencies = malloc((size_t)threads * moves * sizeof(double));
+    if (!latencies) exit(1);
+    for (int i = 0; i < threads; i++) {
+        if (game_log_start(a, b, "bench", time(NULL), &appenders[i].game) != SUCCESS) exit(1);
+        appenders[i].moves = moves;
+        appenders[i].latencies = latencies + (size_t)i * moves;
+    }
+    game_log_flush();
+    game_log_stats_t before;
+    game_log_get_stats(&before);
+
+    double start = clock_seconds();
+    for (int i = 0; i < threads; i++) pthread_create(&ids[i], NULL, appender_main, &appenders[i]);
+    for (int i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+    double elapsed = clock_seconds() - start;
+
+    game_log_stats_t after;
+    game_log_get_stats(&after);
+    game_log_close();
+
+    int total = threads * moves;
+    qsort(latencies, (size_t)total, sizeof(double), compare_double);
+    char name[32];
+    if (policy == GAME_LOG_SYNC_INTERVAL) {
+        snprintf(name, sizeof(name), "every %d ms", interval_ms);
+    } else {
+        snprintf(name, sizeof(name), "%s", game_log_sync_name(policy));
+    }
+    uint64_t commits = after.commits - before.commits;
+    printf("  %-14s %2d thread(s)  p50 %9.2f us  p99 %9.2f us  %9.0f moves/s  %6llu commits (%.1f moves each)\n",
+           name, threads, latencies[total / 2] * 1e6, latencies[(size_t)total * 99 / 100] * 1e6,
+           total / elapsed, (unsigned long long)commits, commits ? (double)total / commits : 0.0);
+    free(latencies);
+}
+
+int main(int argc, char** argv) {
+    int moves = argc > 1 ? atoi(argv[1]) : 10000;
+    if (moves <= 0) moves = 10000;
+
+    char dir[] = "/tmp/awale_group_commit_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    printf("Move appends, %d per thread:\n", moves);
+    int thread_counts[] = { 1, 8 };
+    for (int t = 0; t < 2; t++) {
+        run(dir, GAME_LOG_SYNC_EVERY, 0, thread_counts[t], moves);
+        run(dir, GAME_LOG_SYNC_INTERVAL, 10, thread_counts[t], moves);
+        run(dir, GAME_LOG_SYNC_NONE, 0, thread_counts[t], moves);
+    }
+
+    for (uint32_t segment = 1; segment <= GAME_LOG_MAX_SEGMENTS; segment++) {
+        char path[sizeof(dir) + 16];
+        snprintf(path, sizeof(path), "%s/%08u.seg", dir, segment);
+        if (unlink(path) != 0) break;
+    }
+    rmdir(dir);
+    return 0;
+}
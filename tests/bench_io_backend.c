@@ -0,0 +1,323 @@
+/* Network Backend Benchmark
+ * Echo throughput and server CPU per message for the thread-per-connection
+ * path the server's handlers use (buffered receive + scatter-gather send)
+ * and for one event loop on each io_backend (epoll, io_uring), over
+ * loopback TCP with many connections sending pipelined bursts
+ *
+ * Usage: bench_io_backend [messages] [connections]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "network/session.h"
+#include "network/connection.h"
+#include "network/io_backend.h"
+#include "network/read_buffer.h"
+#include "network/serialization.h"
+#include "common/protocol.h"
+#include "common/messages.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/* Frames each client sends before reading the echoes */
+#define BURST_FRAMES 8
+#define PAYLOAD_SIZE 24
+
+typedef enum {
+    MODE_THREADS,
+    MODE_EPOLL,
+    MODE_URING
+} bench_mode_t;
+
+typedef struct {
+    int* fds;
+    int connections;
+    int rounds;
+    bool ok;
+} client_args_t;
+
+typedef struct {
+    session_t session;
+    double cpu_seconds;
+    uint64_t syscalls;
+} echo_thread_t;
+
+typedef struct {
+    double wall_seconds;
+    double cpu_seconds;     /* Server side only */
+    uint64_t syscalls;      /* Server side only */
+    const char* backend;
+} bench_result_t;
+
+static double clock_seconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = read(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+/* Connected loopback pairs: client[i] talks to server[i] */
+static bool open_pairs(int connections, int* client, int* server) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 128) < 0 ||
+        getsockname(listener, (struct sockaddr*)&addr, &len) < 0) {
+        close(listener);
+        return false;
+    }
+
+    int one = 1;
+    for (int i = 0; i < connections; i++) {
+        client[i] = socket(AF_INET, SOCK_STREAM, 0);
+        if (client[i] < 0 || connect(client[i], (struct sockaddr*)&addr, sizeof(addr)) < 0) break;
+        server[i] = accept(listener, NULL, NULL);
+        if (server[i] < 0) break;
+        setsockopt(client[i], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        setsockopt(server[i], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    close(listener);
+    return true;
+}
+
+/* Load generator: a burst to every connection, then every echo back */
+static void* client_thread(void* arg) {
+    client_args_t* args = (client_args_t*)arg;
+    char payload[PAYLOAD_SIZE];
+    memset(payload, 'm', sizeof(payload));
+
+    char frame[MAX_MESSAGE_SIZE];
+    size_t frame_size;
+    args->ok = serialize_message_frame(MSG_GET_BOARD, 1, 0, payload, sizeof(payload), frame, &frame_size) == SUCCESS;
+    if (!args->ok) return NULL;
+
+    size_t burst_size = frame_size * BURST_FRAMES;
+    char* burst = malloc(burst_size);
+    char* echo = malloc(burst_size);
+    if (!burst || !echo) {
+        args->ok = false;
+        free(burst);
+        free(echo);
+        return NULL;
+    }
+    for (int i = 0; i < BURST_FRAMES; i++) memcpy(burst + (size_t)i * frame_size, frame, frame_size);
+
+    for (int round = 0; round < args->rounds && args->ok; round++) {
+        for (int c = 0; c < args->connections && args->ok; c++) {
+            args->ok = write_all(args->fds[c], burst, burst_size);
+        }
+        for (int c = 0; c < args->connections && args->ok; c++) {
+            args->ok = read_all(args->fds[c], echo, burst_size) && memcmp(echo, burst, burst_size) == 0;
+        }
+    }
+
+    for (int c = 0; c < args->connections; c++) shutdown(args->fds[c], SHUT_WR);
+    free(burst);
+    free(echo);
+    return NULL;
+}
+
+/* The server's own model: one thread per connection */
+static void* echo_thread(void* arg) {
+    echo_thread_t* t = (echo_thread_t*)arg;
+    double cpu_start = clock_seconds(CLOCK_THREAD_CPUTIME_ID);
+    char payload[MAX_PAYLOAD_SIZE];
+
+    for (;;) {
+        message_type_t type;
+        uint32_t sequence;
+        size_t size;
+        if (session_recv_tagged_timeout(&t->session, &type, &sequence, payload, sizeof(payload), &size, 5000) != SUCCESS) {
+            break;
+        }
+        if (session_send_tagged(&t->session, type, sequence, payload, size) != SUCCESS) break;
+    }
+
+    t->cpu_seconds = clock_seconds(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    read_buffer_stats_t rx;
+    write_queue_stats_t tx;
+    memset(&rx, 0, sizeof(rx));
+    memset(&tx, 0, sizeof(tx));
+    read_buffer_get_stats(t->session.conn.rx, &rx);
+    write_queue_get_stats(t->session.conn.tx, &tx);
+    t->syscalls = rx.waits + rx.reads + tx.sends + tx.waits;
+    return NULL;
+}
+
+static bool run_threads(int connections, int* server, bench_result_t* result) {
+    echo_thread_t* threads = calloc((size_t)connections, sizeof(echo_thread_t));
+    pthread_t* ids = calloc((size_t)connections, sizeof(pthread_t));
+    if (!threads || !ids) return false;
+
+    for (int i = 0; i < connections; i++) {
+        session_init(&threads[i].session);
+        threads[i].session.conn.socket_fd = server[i];
+        threads[i].session.conn.connected = true;
+        threads[i].session.conn.tx = write_queue_create();
+        pthread_create(&ids[i], NULL, echo_thread, &threads[i]);
+    }
+    for (int i = 0; i < connections; i++) {
+        pthread_join(ids[i], NULL);
+        result->cpu_seconds += threads[i].cpu_seconds;
+        result->syscalls += threads[i].syscalls;
+        session_close(&threads[i].session);
+    }
+    result->backend = "threads";
+
+    free(threads);
+    free(ids);
+    return true;
+}
+
+/* One event loop: read_buffer per fd, echo every complete frame */
+static bool run_event_loop(io_backend_kind_t kind, int connections, int* server, bench_result_t* result) {
+    io_backend_t io;
+    if (io_backend_init(&io, kind, -1) != SUCCESS) return false;
+    result->backend = io_backend_name(io.kind);
+
+    int max_fd = 0;
+    for (int i = 0; i < connections; i++) {
+        if (server[i] > max_fd) max_fd = server[i];
+    }
+    read_buffer_t** rx = calloc((size_t)max_fd + 1, sizeof(read_buffer_t*));
+    if (!rx) return false;
+    for (int i = 0; i < connections; i++) {
+        rx[server[i]] = read_buffer_create();
+        io_backend_watch(&io, server[i]);
+    }
+
+    double cpu_start = clock_seconds(CLOCK_THREAD_CPUTIME_ID);
+    int open = connections;
+    bool ok = true;
+    io_event_t events[IO_BACKEND_MAX_EVENTS];
+    double last_event = clock_seconds(CLOCK_MONOTONIC);
+    while (open > 0 && ok) {
+        /* A wait can return nothing but send completions */
+        int count = 0;
+        if (io_backend_wait(&io, events, IO_BACKEND_MAX_EVENTS, 1000, &count) != SUCCESS) {
+            ok = false;
+            break;
+        }
+        if (count == 0) {
+            ok = clock_seconds(CLOCK_MONOTONIC) - last_event < 5.0;
+            continue;
+        }
+        last_event = clock_seconds(CLOCK_MONOTONIC);
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].fd;
+            if (events[i].type == IO_EVENT_CLOSED) {
+                io_backend_unwatch(&io, fd);
+                open--;
+                continue;
+            }
+            if (read_buffer_append(rx[fd], events[i].data, events[i].length) != SUCCESS) {
+                ok = false;
+                break;
+            }
+            frame_view_t view;
+            while (read_buffer_next_frame(rx[fd], &view) == SUCCESS) {
+                message_header_t header = { htonl(view.type), htonl((uint32_t)view.length), htonl(view.sequence), 0 };
+                io_backend_send(&io, fd, &header, sizeof(header), view.payload, view.length);
+            }
+        }
+    }
+    result->cpu_seconds = clock_seconds(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    result->syscalls = io.stats.syscalls;
+
+    for (int i = 0; i < connections; i++) {
+        read_buffer_destroy(rx[server[i]]);
+        close(server[i]);
+    }
+    free(rx);
+    io_backend_destroy(&io);
+    return ok;
+}
+
+static bool run_case(bench_mode_t mode, int connections, int rounds, bench_result_t* result) {
+    int* client = calloc((size_t)connections, sizeof(int));
+    int* server = calloc((size_t)connections, sizeof(int));
+    if (!client || !server || !open_pairs(connections, client, server)) return false;
+
+    memset(result, 0, sizeof(*result));
+    client_args_t args = { client, connections, rounds, true };
+    double wall_start = clock_seconds(CLOCK_MONOTONIC);
+    pthread_t loader;
+    pthread_create(&loader, NULL, client_thread, &args);
+
+    bool ok;
+    if (mode == MODE_THREADS) {
+        ok = run_threads(connections, server, result);
+    } else {
+        ok = run_event_loop(mode == MODE_URING ? IO_BACKEND_URING : IO_BACKEND_EPOLL, connections, server, result);
+    }
+    pthread_join(loader, NULL);
+    result->wall_seconds = clock_seconds(CLOCK_MONOTONIC) - wall_start;
+
+    for (int i = 0; i < connections; i++) close(client[i]);
+    free(client);
+    free(server);
+    return ok && args.ok;
+}
+
+int main(int argc, char* argv[]) {
+    int messages = argc > 1 ? atoi(argv[1]) : 200000;
+    int connections = argc > 2 ? atoi(argv[2]) : 64;
+    if (messages <= 0) messages = 200000;
+    if (connections <= 0) connections = 64;
+
+    int rounds = messages / (connections * BURST_FRAMES);
+    if (rounds < 1) rounds = 1;
+    long total = (long)rounds * connections * BURST_FRAMES;
+
+    printf("Network backend benchmark (%ld echoes, %d connections, bursts of %d, %d-byte payload)\n",
+           total, connections, BURST_FRAMES, PAYLOAD_SIZE);
+    printf("  %-9s %12s %14s %14s\n", "server", "msg/s", "cpu-us/msg", "syscall/msg");
+
+    bench_mode_t modes[] = { MODE_THREADS, MODE_EPOLL, MODE_URING };
+    for (int m = 0; m < 3; m++) {
+        bench_result_t result;
+        if (!run_case(modes[m], connections, rounds, &result)) {
+            fprintf(stderr, "%s case failed\n", m == 0 ? "threads" : m == 1 ? "epoll" : "io_uring");
+            return 1;
+        }
+        printf("  %-9s %12.0f %14.2f %14.3f\n", result.backend, total / result.wall_seconds,
+               result.cpu_seconds * 1e6 / total, (double)result.syscalls / total);
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/* Request Pipelining Benchmark
+ * Measures request throughput on one connection with 1 and 16 tagged
+ * requests outstanding, and checks every response echoes its request tag
+ *
+ * Usage: bench_pipeline [host] [port] [requests]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "network/session.h"
+#include "network/connection.h"
+#include "common/protocol.h"
+#include "common/messages.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_DEPTH 16
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static error_code_t bench_connect(session_t* session, const char* host, int port, const char* pseudo) {
+    session_init(session);
+    connection_init(&session->conn);
+    error_code_t err = connection_connect(&session->conn, host, port);
+    if (err != SUCCESS) return err;
+
+    msg_connect_t connect_msg;
+    memset(&connect_msg, 0, sizeof(connect_msg));
+    snprintf(connect_msg.pseudo, MAX_PSEUDO_LEN, "%s", pseudo);
+    snprintf(connect_msg.version, 16, "%s", PROTOCOL_VERSION);
+
+    err = session_send_message(session, MSG_CONNECT, &connect_msg, sizeof(connect_msg));
+    if (err != SUCCESS) return err;
+
+    message_type_t type;
+    msg_connect_ack_t ack;
+    size_t size;
+    err = session_recv_message_timeout(session, &type, &ack, sizeof(ack), &size, 5000, NULL, 0);
+    if (err != SUCCESS) return err;
+    if (type != MSG_CONNECT_ACK || !ack.success) return ERR_NETWORK_ERROR;
+
+    snprintf(session->pseudo, MAX_PSEUDO_LEN, "%s", pseudo);
+    return SUCCESS;
+}
+
+/* Run `total` requests keeping up to `depth` in flight; returns requests/s or -1 */
+static double bench_run(session_t* session, int depth, int total) {
+    msg_get_player_stats_t req;
+    memset(&req, 0, sizeof(req));
+    snprintf(req.target_player, MAX_PSEUDO_LEN, "%s", session->pseudo);
+
+    uint32_t outstanding[MAX_DEPTH];
+    int in_flight = 0;
+    int sent = 0;
+    int received = 0;
+    char payload[MAX_PAYLOAD_SIZE];
+
+    double start = now_seconds();
+
+    while (received < total) {
+        while (in_flight < depth && sent < total) {
+            uint32_t sequence;
+            if (session_send_request(session, MSG_GET_PLAYER_STATS, &req, sizeof(req), &sequence) != SUCCESS) {
+                fprintf(stderr, "send failed after %d requests\n", sent);
+                return -1;
+            }
+            outstanding[in_flight++] = sequence;
+            sent++;
+        }
+
+        message_type_t type;
+        uint32_t sequence;
+        size_t size;
+        error_code_t err = session_recv_tagged_timeout(session, &type, &sequence, payload,
+                                                       sizeof(payload), &size, 5000);
+        if (err != SUCCESS) {
+            fprintf(stderr, "receive failed: %s\n", error_to_string(err));
+            return -1;
+        }
+
+        /* Notifications carry tag 0 and are not ours to count */
+        if (sequence == 0) continue;
+
+        int slot = -1;
+        for (int i = 0; i < in_flight; i++) {
+            if (outstanding[i] == sequence) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0 || type != MSG_PLAYER_STATS) {
+            fprintf(stderr, "unmatched response: type %s tag %u\n", message_type_to_string(type), sequence);
+            return -1;
+        }
+        outstanding[slot] = outstanding[--in_flight];
+        received++;
+    }
+
+    double elapsed = now_seconds() - start;
+    return elapsed > 0 ? total / elapsed : 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? atoi(argv[2]) : 12345;
+    int total = argc > 3 ? atoi(argv[3]) : 20000;
+
+    char pseudo[MAX_PSEUDO_LEN];
+    snprintf(pseudo, sizeof(pseudo), "bench%d", (int)getpid());
+
+    session_t session;
+    error_code_t err = bench_connect(&session, host, port, pseudo);
+    if (err != SUCCESS) {
+        fprintf(stderr, "Could not connect to %s:%d: %s\n", host, port, error_to_string(err));
+        return 1;
+    }
+
+    printf("Request pipelining benchmark (%d x MSG_GET_PLAYER_STATS)\n", total);
+
+    double base = 0;
+    int depths[] = {1, MAX_DEPTH};
+    for (size_t i = 0; i < sizeof(depths) / sizeof(depths[0]); i++) {
+        double rate = bench_run(&session, depths[i], total);
+        if (rate < 0) {
+            session_close(&session);
+            return 1;
+        }
+        if (depths[i] == 1) base = rate;
+        printf("  depth %2d: %10.0f req/s", depths[i], rate);
+        if (depths[i] != 1 && base > 0) printf("  (%.2fx)", rate / base);
+        printf("\n");
+    }
+
+    session_send_message(&session, MSG_DISCONNECT, NULL, 0);
+    session_close(&session);
+    return 0;
+}
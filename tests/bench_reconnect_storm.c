@@ -0,0 +1,257 @@
+/* Reconnect Storm Benchmark
+ * Every client connects at once, as after a server restart, and logs in:
+ * MSG_CONNECT, wait for a successful MSG_CONNECT_ACK, then MSG_DISCONNECT.
+ * The server keeps at most MAX_PLAYERS accounts, so clients share a pool of
+ * STORM_ACCOUNTS pseudos and a login is also refused while another client
+ * holds the same pseudo. A refused, reset or rejected attempt (full backlog,
+ * full handshake table, pseudo in use) is retried with jittered backoff.
+ * Reports how long it takes until every client has logged in once.
+ *
+ * Usage: bench_reconnect_storm <host> <port> [clients] [label]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "network/connection.h"
+#include "network/serialization.h"
+#include "common/protocol.h"
+#include "common/messages.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/* Give up on the run after this long */
+#define STORM_TIME_LIMIT 60.0
+#define STORM_BACKOFF_MAX 0.2
+/* Leaves room under MAX_PLAYERS for accounts already on disk */
+#define STORM_ACCOUNTS 64
+
+typedef enum {
+    CLIENT_IDLE,            /* Waiting for retry_at */
+    CLIENT_CONNECTING,
+    CLIENT_WAIT_ACK,
+    CLIENT_DONE
+} client_state_t;
+
+typedef struct {
+    int fd;
+    client_state_t state;
+    int attempts;
+    double retry_at;
+    size_t received;
+    char reply[HEADER_SIZE + sizeof(msg_connect_ack_t)];
+} storm_client_t;
+
+typedef struct {
+    struct sockaddr_in addr;
+    poll_context_t poll;
+    storm_client_t* clients;
+    int* by_fd;             /* fd -> client index */
+    size_t max_fd;
+    double start;
+    double* latencies;
+    int done;
+    long retries;
+} storm_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Close with RST so thousands of logins leave no TIME_WAIT behind */
+static void abort_socket(int fd) {
+    struct linger linger = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    close(fd);
+}
+
+static bool send_frame(int fd, message_type_t type, const void* payload, size_t size) {
+    char frame[MAX_MESSAGE_SIZE];
+    size_t frame_size;
+    if (serialize_message_frame(type, 1, 0, payload, size, frame, &frame_size) != SUCCESS) return false;
+    return send(fd, frame, frame_size, MSG_NOSIGNAL) == (ssize_t)frame_size;
+}
+
+static void release(storm_t* storm, storm_client_t* client) {
+    poll_context_remove(&storm->poll, client->fd);
+    storm->by_fd[client->fd] = -1;
+    abort_socket(client->fd);
+    client->fd = -1;
+}
+
+static void retry_later(storm_t* storm, storm_client_t* client) {
+    if (client->fd >= 0) release(storm, client);
+    client->attempts++;
+    storm->retries++;
+
+    double backoff = 0.001 * (double)(1 << (client->attempts < 8 ? client->attempts : 8));
+    if (backoff > STORM_BACKOFF_MAX) backoff = STORM_BACKOFF_MAX;
+    client->retry_at = now_seconds() + backoff * (0.5 + (double)rand() / RAND_MAX);
+    client->state = CLIENT_IDLE;
+}
+
+static void start_attempt(storm_t* storm, int index) {
+    storm_client_t* client = &storm->clients[index];
+    client->received = 0;
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0 || (size_t)fd >= storm->max_fd) {
+        if (fd >= 0) close(fd);
+        retry_later(storm, client);
+        return;
+    }
+    client->fd = fd;
+    storm->by_fd[fd] = index;
+
+    if (connect(fd, (struct sockaddr*)&storm->addr, sizeof(storm->addr)) < 0 && errno != EINPROGRESS) {
+        retry_later(storm, client);
+        return;
+    }
+    client->state = CLIENT_CONNECTING;
+    if (poll_context_add(&storm->poll, fd, POLL_CONTEXT_WRITE) != SUCCESS) retry_later(storm, client);
+}
+
+static void on_connected(storm_t* storm, int index) {
+    storm_client_t* client = &storm->clients[index];
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(client->fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0) {
+        retry_later(storm, client);
+        return;
+    }
+
+    msg_connect_t msg;
+    memset(&msg, 0, sizeof(msg));
+    snprintf(msg.pseudo, MAX_PSEUDO_LEN, "storm%02d", index % STORM_ACCOUNTS);
+    snprintf(msg.version, sizeof(msg.version), "%s", PROTOCOL_VERSION);
+    if (!send_frame(client->fd, MSG_CONNECT, &msg, sizeof(msg)) ||
+        poll_context_modify(&storm->poll, client->fd, POLL_CONTEXT_READ) != SUCCESS) {
+        retry_later(storm, client);
+        return;
+    }
+    client->state = CLIENT_WAIT_ACK;
+}
+
+static void on_reply(storm_t* storm, int index) {
+    storm_client_t* client = &storm->clients[index];
+    ssize_t n = recv(client->fd, client->reply + client->received, sizeof(client->reply) - client->received, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+    if (n <= 0) {
+        retry_later(storm, client);
+        return;
+    }
+    client->received += (size_t)n;
+    if (client->received < HEADER_SIZE) return;
+
+    message_header_t header;
+    memcpy(&header, client->reply, sizeof(header));
+    size_t length = ntohl(header.length);
+    if (ntohl(header.type) != MSG_CONNECT_ACK || length < sizeof(bool) || length > sizeof(msg_connect_ack_t)) {
+        retry_later(storm, client);
+        return;
+    }
+    if (client->received < HEADER_SIZE + length) return;
+
+    /* Rejected (e.g. server full): try again once others have left */
+    msg_connect_ack_t ack;
+    memset(&ack, 0, sizeof(ack));
+    memcpy(&ack, client->reply + HEADER_SIZE, length);
+    if (!ack.success) {
+        retry_later(storm, client);
+        return;
+    }
+
+    send_frame(client->fd, MSG_DISCONNECT, NULL, 0);
+    release(storm, client);
+    client->state = CLIENT_DONE;
+    storm->latencies[storm->done++] = now_seconds() - storm->start;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <host> <port> [clients] [label]\n", argv[0]);
+        return 1;
+    }
+    int total = argc > 3 ? atoi(argv[3]) : 10000;
+    const char* label = argc > 4 ? argv[4] : "";
+    if (total <= 0) total = 10000;
+
+    storm_t storm;
+    memset(&storm, 0, sizeof(storm));
+    storm.addr.sin_family = AF_INET;
+    storm.addr.sin_port = htons((uint16_t)atoi(argv[2]));
+    if (inet_pton(AF_INET, argv[1], &storm.addr.sin_addr) != 1) {
+        fprintf(stderr, "Bad address %s\n", argv[1]);
+        return 1;
+    }
+
+    struct rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    storm.max_fd = (size_t)limit.rlim_cur;
+    storm.clients = calloc((size_t)total, sizeof(storm_client_t));
+    storm.by_fd = malloc(storm.max_fd * sizeof(int));
+    storm.latencies = calloc((size_t)total, sizeof(double));
+    if (!storm.clients || !storm.by_fd || !storm.latencies || poll_context_init(&storm.poll, 5) != SUCCESS) {
+        return 1;
+    }
+    for (size_t i = 0; i < storm.max_fd; i++) storm.by_fd[i] = -1;
+    srand(1);
+
+    /* The storm: every client starts connecting now */
+    storm.start = now_seconds();
+    for (int i = 0; i < total; i++) start_attempt(&storm, i);
+
+    while (storm.done < total && now_seconds() - storm.start < STORM_TIME_LIMIT) {
+        int ready = 0;
+        if (poll_context_wait(&storm.poll, &ready) != SUCCESS) break;
+        for (int r = 0; r < ready; r++) {
+            const poll_event_t* ev = poll_context_ready(&storm.poll, r);
+            int index = (size_t)ev->fd < storm.max_fd ? storm.by_fd[ev->fd] : -1;
+            if (index < 0) continue;
+            if (storm.clients[index].state == CLIENT_CONNECTING) {
+                on_connected(&storm, index);
+            } else if (storm.clients[index].state == CLIENT_WAIT_ACK) {
+                on_reply(&storm, index);
+            }
+        }
+
+        double now = now_seconds();
+        for (int i = 0; i < total; i++) {
+            if (storm.clients[i].state == CLIENT_IDLE && storm.clients[i].retry_at <= now) start_attempt(&storm, i);
+        }
+    }
+    double elapsed = now_seconds() - storm.start;
+
+    qsort(storm.latencies, (size_t)storm.done, sizeof(double), compare_double);
+    double p50 = storm.done ? storm.latencies[storm.done / 2] : 0;
+    int p99_index = (storm.done * 99) / 100;
+    if (p99_index >= storm.done) p99_index = storm.done - 1;
+    double p99 = storm.done ? storm.latencies[p99_index] : 0;
+    printf("  %-28s %6d/%-6d logins in %7.3f s  (%8.0f/s)  p50 %7.3f s  p99 %7.3f s  retries %ld\n",
+           label, storm.done, total, elapsed, storm.done / elapsed, p50, p99, storm.retries);
+
+    for (int i = 0; i < total; i++) {
+        if (storm.clients[i].state != CLIENT_DONE && storm.clients[i].state != CLIENT_IDLE) {
+            release(&storm, &storm.clients[i]);
+        }
+    }
+    poll_context_destroy(&storm.poll);
+    free(storm.clients);
+    free(storm.by_fd);
+    free(storm.latencies);
+    return storm.done == total ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+/* Recovery Benchmark
+ * Startup time for a log of stored games, most of them finished and a few
+ * still in progress: rebuilding the index with one thread and with one per
+ * CPU, then putting the games in progress back in a game manager.
+ *
+ * Usage: bench_recovery [games] [in_progress]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "server/game_log.h"
+#include "server/game_manager.h"
+#include "server/pseudo_table.h"
+#include "server/storage.h"
+#include "game/rules.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PLAYERS 1000
+#define MAX_MOVES 256
+
+static double clock_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* One whole game, the first legal pit each turn */
+static uint8_t g_moves[MAX_MOVES];
+static board_t g_boards[MAX_MOVES + 1];
+static uint32_t g_length;
+
+static void play_reference_game(void) {
+    board_t board;
+    board_init(&board);
+    g_boards[0] = board;
+    while (g_length < MAX_MOVES && board.state == GAME_STATE_IN_PROGRESS) {
+        int pit = 0;
+        while (pit < NUM_PITS && rules_validate_move(&board, board.current_player, pit) != SUCCESS) pit++;
+        int captured;
+        if (pit == NUM_PITS || board_execute_move(&board, board.current_player, pit, &captured) != SUCCESS) break;
+        g_moves[g_length++] = (uint8_t)pit;
+        g_boards[g_length] = board;
+    }
+}
+
+/* Games in progress stop half way; each pair of players has one at most */
+static void fill(uint64_t games, uint64_t in_progress, pseudo_id_t* players) {
+    for (uint64_t i = 0; i < games; i++) {
+        bool active = i >= games - in_progress;
+        pseudo_id_t a = players[(i * 2) % PLAYERS], b = players[(i * 2 + 1) % PLAYERS];
+        if (active) {
+            char name[MAX_PSEUDO_LEN];
+            snprintf(name, sizeof(name), "bench_active_%llu", (unsigned long long)i);
+            a = pseudo_intern(name);
+            snprintf(name, sizeof(name), "bench_rival_%llu", (unsigned long long)i);
+            b = pseudo_intern(name);
+        }
+
+        game_log_id_t id;
+        if (game_log_start(a, b, "bench", g_boards[0].created_at, &id) != SUCCESS) exit(1);
+        uint32_t moves = active ? g_length / 2 : g_length;
+        for (uint32_t m = 0; m < moves; m++) {
+            if (game_log_append_move(id, g_moves[m], &g_boards[m + 1]) != SUCCESS) exit(1);
+        }
+        if (!active && game_log_finish(id, "bench", g_moves, g_length, &g_boards[g_length]) != SUCCESS) exit(1);
+    }
+}
+
+static void recover(const char* dir, int threads) {
+    game_log_set_scan_threads(threads);
+    double start = clock_seconds();
+    if (game_log_open(dir) != SUCCESS) {
+        fprintf(stderr, "game_log_open failed\n");
+        exit(1);
+    }
+    double opened = clock_seconds();
+
+    game_manager_t manager;
+    game_manager_init(&manager);
+    int restored, skipped;
+    if (storage_load_all_games(&manager, &restored, &skipped) != SUCCESS) exit(1);
+    double done = clock_seconds();
+
+    game_log_stats_t stats;
+    game_log_get_stats(&stats);
+    char name[16];
+    if (threads) snprintf(name, sizeof(name), "%d thread(s)", threads);
+    else snprintf(name, sizeof(name), "per CPU");
+    printf("  %-12s index %7.1f ms  restore %d game(s) %6.1f ms  total %7.1f ms\n", name,
+           (opened - start) * 1e3, restored, (done - opened) * 1e3, (done - start) * 1e3);
+
+    game_manager_destroy(&manager);
+    game_log_close();
+}
+
+int main(int argc, char** argv) {
+    uint64_t games = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000;
+    uint64_t in_progress = argc > 2 ? strtoull(argv[2], NULL, 10) : MAX_GAMES;
+    if (games == 0) games = 100000;
+    if (in_progress > games) in_progress = games;
+
+    char dir[] = "/tmp/awale_recovery_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    play_reference_game();
+    pseudo_id_t players[PLAYERS];
+    for (int i = 0; i < PLAYERS; i++) {
+        char pseudo[MAX_PSEUDO_LEN];
+        snprintf(pseudo, sizeof(pseudo), "bench%d", i);
+        players[i] = pseudo_intern(pseudo);
+    }
+
+    game_log_set_sync(GAME_LOG_SYNC_NONE, 0);
+    if (game_log_open(dir) != SUCCESS) {
+        fprintf(stderr, "game_log_open failed\n");
+        return 1;
+    }
+    fill(games, in_progress, players);
+    game_log_stats_t stats;
+    game_log_get_stats(&stats);
+    game_log_close();
+    printf("Recovery of %llu games (%llu in progress, %u moves each), %u segment(s), %.1f MB:\n",
+           (unsigned long long)games, (unsigned long long)in_progress, g_length, stats.segments,
+           stats.bytes / 1e6);
+
+    recover(dir, 1);
+    recover(dir, 0);
+
+    for (uint32_t segment = 1; segment <= stats.segments; segment++) {
+        char path[sizeof(dir) + 16];
+        snprintf(path, sizeof(path), "%s/%08u.seg", dir, segment);
+        unlink(path);
+    }
+    rmdir(dir);
+    return 0;
+}
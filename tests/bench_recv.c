@@ -0,0 +1,243 @@
+/* Receive Path Benchmark
+ * Syscalls per message and messages per CPU-second on the receiving thread,
+ * comparing the previous header-then-payload reads (select + read for each)
+ * with the buffered ring reader, over a loopback TCP connection
+ *
+ * Usage: bench_recv [messages]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "network/session.h"
+#include "network/connection.h"
+#include "network/read_buffer.h"
+#include "network/serialization.h"
+#include "common/protocol.h"
+#include "common/messages.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/* Frames per write in burst mode, like a pipelined client or a busy push path */
+#define BURST_FRAMES 32
+
+typedef struct {
+    int fd;
+    int messages;
+    size_t payload_size;
+    bool ping_pong;         /* Wait for a one-byte ack after every frame */
+} writer_args_t;
+
+typedef struct {
+    uint64_t syscalls;
+    double cpu_seconds;
+    double wall_seconds;
+} recv_result_t;
+
+static double clock_seconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int tcp_pair(int fds[2]) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 1) < 0 ||
+        getsockname(listener, (struct sockaddr*)&addr, &len) < 0) {
+        close(listener);
+        return -1;
+    }
+
+    fds[1] = socket(AF_INET, SOCK_STREAM, 0);
+    if (fds[1] < 0 || connect(fds[1], (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(listener);
+        return -1;
+    }
+    fds[0] = accept(listener, NULL, NULL);
+    close(listener);
+    if (fds[0] < 0) return -1;
+
+    int one = 1;
+    setsockopt(fds[1], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fds[0], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return 0;
+}
+
+static bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static void* writer_thread(void* arg) {
+    writer_args_t* args = (writer_args_t*)arg;
+    static char payload[MAX_PAYLOAD_SIZE];
+    memset(payload, 'x', sizeof(payload));
+
+    char frame[MAX_MESSAGE_SIZE];
+    size_t frame_size;
+    if (serialize_message_frame(MSG_CHAT_MESSAGE, 0, 0, payload, args->payload_size, frame, &frame_size) != SUCCESS) {
+        return NULL;
+    }
+
+    if (args->ping_pong) {
+        char ack;
+        for (int i = 0; i < args->messages; i++) {
+            if (!write_all(args->fd, frame, frame_size)) break;
+            if (read(args->fd, &ack, 1) != 1) break;
+        }
+        return NULL;
+    }
+
+    char* burst = malloc(frame_size * BURST_FRAMES);
+    if (!burst) return NULL;
+    for (int i = 0; i < BURST_FRAMES; i++) memcpy(burst + (size_t)i * frame_size, frame, frame_size);
+    for (int sent = 0; sent < args->messages; sent += BURST_FRAMES) {
+        int count = args->messages - sent < BURST_FRAMES ? args->messages - sent : BURST_FRAMES;
+        if (!write_all(args->fd, burst, frame_size * (size_t)count)) break;
+    }
+    free(burst);
+    return NULL;
+}
+
+/* The receive path before the ring buffer: wait + read for the header, wait +
+ * read for the payload into a stack buffer, then copy out. Counts every call. */
+static error_code_t baseline_read(int fd, void* buffer, size_t size, uint64_t* syscalls) {
+    fd_set read_fds;
+    struct timeval timeout = { 5, 0 };
+    FD_ZERO(&read_fds);
+    FD_SET(fd, &read_fds);
+    (*syscalls)++;
+    if (select(fd + 1, &read_fds, NULL, NULL, &timeout) <= 0) return ERR_TIMEOUT;
+
+    char* ptr = (char*)buffer;
+    while (size > 0) {
+        (*syscalls)++;
+        ssize_t n = read(fd, ptr, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return ERR_NETWORK_ERROR;
+        ptr += n;
+        size -= (size_t)n;
+    }
+    return SUCCESS;
+}
+
+static error_code_t baseline_recv(int fd, void* payload, size_t max_payload_size, uint64_t* syscalls) {
+    message_header_t header;
+    error_code_t err = baseline_read(fd, &header, sizeof(header), syscalls);
+    if (err != SUCCESS) return err;
+    header.length = ntohl(header.length);
+    if (header.length > MAX_PAYLOAD_SIZE) return ERR_SERIALIZATION;
+
+    char temp_payload[MAX_PAYLOAD_SIZE];
+    if (header.length > 0) {
+        err = baseline_read(fd, temp_payload, header.length, syscalls);
+        if (err != SUCCESS) return err;
+    }
+    if (header.length > max_payload_size) return ERR_SERIALIZATION;
+    memcpy(payload, temp_payload, header.length);
+    return SUCCESS;
+}
+
+static bool run_case(bool buffered, bool ping_pong, size_t payload_size, int messages, recv_result_t* result) {
+    int fds[2];
+    if (tcp_pair(fds) < 0) return false;
+
+    writer_args_t args = { fds[1], messages, payload_size, ping_pong };
+    pthread_t writer;
+    if (pthread_create(&writer, NULL, writer_thread, &args) != 0) return false;
+
+    session_t session;
+    session_init(&session);
+    session.conn.socket_fd = fds[0];
+    session.conn.connected = true;
+
+    static char payload[MAX_PAYLOAD_SIZE];
+    uint64_t syscalls = 0;
+    bool ok = true;
+    double wall_start = clock_seconds(CLOCK_MONOTONIC);
+    double cpu_start = clock_seconds(CLOCK_THREAD_CPUTIME_ID);
+
+    for (int i = 0; i < messages && ok; i++) {
+        error_code_t err;
+        if (buffered) {
+            message_type_t type;
+            size_t size;
+            err = session_recv_message_timeout(&session, &type, payload, sizeof(payload), &size, 5000, NULL, 0);
+        } else {
+            err = baseline_recv(fds[0], payload, sizeof(payload), &syscalls);
+        }
+        ok = (err == SUCCESS);
+        if (ok && ping_pong) {
+            ok = write_all(fds[0], "k", 1);
+            syscalls++;
+        }
+    }
+
+    result->cpu_seconds = clock_seconds(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    result->wall_seconds = clock_seconds(CLOCK_MONOTONIC) - wall_start;
+    if (buffered && session.conn.rx) {
+        read_buffer_stats_t stats;
+        read_buffer_get_stats(session.conn.rx, &stats);
+        syscalls += stats.waits + stats.reads;
+    }
+    result->syscalls = syscalls;
+
+    pthread_join(writer, NULL);
+    session_close(&session);
+    close(fds[1]);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int messages = argc > 1 ? atoi(argv[1]) : 100000;
+    if (messages <= 0) messages = 100000;
+
+    /* A compact move, a raw board state, a full list page */
+    size_t sizes[] = { 24, sizeof(msg_board_state_t), 4096 };
+    const char* modes[] = { "burst", "ping-pong" };
+
+    printf("Receive path benchmark (%d messages per case, loopback TCP)\n", messages);
+    printf("  %-9s %7s %-8s %10s %12s %12s\n", "mode", "payload", "reader", "syscall/msg", "msg/cpu-s", "msg/s");
+
+    for (int m = 0; m < 2; m++) {
+        bool ping_pong = (m == 1);
+        int count = ping_pong ? messages / 10 : messages;
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            for (int buffered = 0; buffered <= 1; buffered++) {
+                recv_result_t result;
+                if (!run_case(buffered, ping_pong, sizes[s], count, &result)) {
+                    fprintf(stderr, "%s case failed (%zu bytes)\n", modes[m], sizes[s]);
+                    return 1;
+                }
+                printf("  %-9s %7zu %-8s %10.3f %12.0f %12.0f\n", modes[m], sizes[s],
+                       buffered ? "ring" : "baseline", (double)result.syscalls / count,
+                       result.cpu_seconds > 0 ? count / result.cpu_seconds : 0.0,
+                       result.wall_seconds > 0 ? count / result.wall_seconds : 0.0);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+/* Saved-Game Review Benchmark
+ * Loading finished games at random, as MSG_VIEW_SAVED_GAME does, once their
+ * pages are cached: from a sealed segment (mapped, decoded in place), from
+ * the active segment (pread) and from an archive (one inflated block per
+ * lookup, the last one kept). Also counts pread calls per load.
+ *
+ * Usage: bench_saved_games [games]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "server/game_log.h"
+#include "server/pseudo_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOADS 200000
+#define PLAYERS 1000
+
+static double clock_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void fill(game_log_id_t* first, uint64_t games, pseudo_id_t* players) {
+    game_log_game_t game;
+    memset(&game, 0, sizeof(game));
+    board_init(&game.board);
+    game.board.state = GAME_STATE_FINISHED;
+    game.board.winner = WINNER_A;
+    for (uint64_t i = 0; i < games; i++) {
+        game.player_a = players[i % PLAYERS];
+        game.player_b = players[(i + 1) % PLAYERS];
+        game.board.created_at = (time_t)(1600000000 + i * 60);
+        snprintf(game.label, sizeof(game.label), "bench-%llu", (unsigned long long)i);
+        game_log_id_t id;
+        if (game_log_import(&game, &id) != SUCCESS) exit(1);
+        if (i == 0) *first = id;
+    }
+}
+
+/* Average load time of random games among [first, first + games), and
+ * pread calls per load */
+static void time_loads(const char* what, game_log_id_t first, uint64_t games, bool sequential) {
+    game_log_game_t game;
+    srand(5);
+    for (uint64_t i = 0; i < games; i++) {
+        if (game_log_load(first + i, &game) != SUCCESS) exit(1);   /* Warm up */
+    }
+
+    game_log_stats_t before, after;
+    game_log_get_stats(&before);
+    double start = clock_seconds();
+    for (int i = 0; i < LOADS; i++) {
+        game_log_id_t id = first + (sequential ? (uint64_t)i % games : (uint64_t)rand() % games);
+        if (game_log_load(id, &game) != SUCCESS) exit(1);
+    }
+    double per_load = (clock_seconds() - start) / LOADS;
+    game_log_get_stats(&after);
+    printf("  %-34s %7.2f us  %.2f pread/load\n", what, per_load * 1e6,
+           (double)(after.file_reads - before.file_reads) / LOADS);
+}
+
+int main(int argc, char** argv) {
+    uint64_t games = argc > 1 ? strtoull(argv[1], NULL, 10) : 50000;
+    if (games < 100) games = 50000;
+
+    char dir[] = "/tmp/awale_saved_games_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    pseudo_id_t players[PLAYERS];
+    for (int i = 0; i < PLAYERS; i++) {
+        char pseudo[MAX_PSEUDO_LEN];
+        snprintf(pseudo, sizeof(pseudo), "bench%d", i);
+        players[i] = pseudo_intern(pseudo);
+    }
+
+    game_log_set_sync(GAME_LOG_SYNC_NONE, 0);
+    game_log_set_compaction(0);
+    if (game_log_open(dir) != SUCCESS) {
+        fprintf(stderr, "game_log_open failed\n");
+        return 1;
+    }
+
+    /* Half in a sealed segment, half in the active one */
+    game_log_id_t sealed, active;
+    fill(&sealed, games / 2, players);
+    if (game_log_rotate() != SUCCESS) return 1;
+    fill(&active, games / 2, players);
+    if (game_log_flush() != SUCCESS) return 1;
+
+    printf("Loading one of %llu finished games, cached (%d loads):\n", (unsigned long long)(games / 2), LOADS);
+    time_loads("sealed segment (mapped)", sealed, games / 2, false);
+    time_loads("active segment (pread)", active, games / 2, false);
+
+    if (game_log_rotate() != SUCCESS || game_log_compact() != SUCCESS) return 1;
+    time_loads("archive, random", sealed, games / 2, false);
+    time_loads("archive, in ID order", sealed, games / 2, true);
+
+    game_log_stats_t stats;
+    game_log_get_stats(&stats);
+    game_log_close();
+    const char* suffixes[] = { "seg", "arc" };
+    for (uint32_t segment = 1; segment <= stats.segments; segment++) {
+        for (int s = 0; s < 2; s++) {
+            char path[sizeof(dir) + 16];
+            snprintf(path, sizeof(path), "%s/%08u.%s", dir, segment, suffixes[s]);
+            unlink(path);
+        }
+    }
+    rmdir(dir);
+    return 0;
+}
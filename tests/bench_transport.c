@@ -0,0 +1,121 @@
+/* Transport Benchmark
+ * Request/reply round trips through the session layer over each transport:
+ * TCP on 127.0.0.1, a Unix domain socket, and the in-process loopback pair.
+ * One echo thread serves one client, so the figure is latency per round
+ * trip rather than aggregate throughput.
+ *
+ * Usage: bench_transport [round_trips]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "network/session.h"
+#include "network/connection.h"
+#include "common/protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define PAYLOAD_SIZE 24
+#define BENCH_TCP_PORT 4013
+
+static double clock_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void* echo_thread(void* arg) {
+    session_t* session = (session_t*)arg;
+    char payload[MAX_PAYLOAD_SIZE];
+
+    for (;;) {
+        message_type_t type;
+        uint32_t sequence;
+        size_t size;
+        if (session_recv_tagged_timeout(session, &type, &sequence, payload, sizeof(payload), &size, 5000) != SUCCESS) {
+            break;
+        }
+        if (session_send_tagged(session, type, sequence, payload, size) != SUCCESS) break;
+    }
+    return NULL;
+}
+
+/* Connected pair over the named transport */
+static bool open_pair(const char* transport, const char* path, session_t* client, session_t* server) {
+    session_init(client);
+    session_init(server);
+    if (strcmp(transport, "loopback") == 0) {
+        return connection_loopback_pair(&client->conn, &server->conn) == SUCCESS;
+    }
+
+    connection_t listener;
+    connection_init(&listener);
+    bool ok;
+    if (strcmp(transport, "unix") == 0) {
+        ok = connection_create_unix_server(&listener, path) == SUCCESS &&
+             connection_connect_unix(&client->conn, path) == SUCCESS;
+    } else {
+        ok = connection_create_server(&listener, BENCH_TCP_PORT) == SUCCESS &&
+             connection_connect(&client->conn, "127.0.0.1", BENCH_TCP_PORT) == SUCCESS;
+    }
+    ok = ok && connection_accept(&listener, &server->conn) == SUCCESS;
+    connection_close(&listener);
+    if (strcmp(transport, "unix") == 0) unlink(path);
+    return ok;
+}
+
+static bool run_case(const char* transport, int round_trips, double* seconds) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/awale_bench_%d.sock", (int)getpid());
+
+    session_t client, server;
+    if (!open_pair(transport, path, &client, &server)) return false;
+
+    pthread_t echo;
+    pthread_create(&echo, NULL, echo_thread, &server);
+
+    char payload[PAYLOAD_SIZE];
+    char reply[MAX_PAYLOAD_SIZE];
+    memset(payload, 'r', sizeof(payload));
+    bool ok = true;
+    double start = clock_seconds();
+    for (int i = 0; i < round_trips && ok; i++) {
+        message_type_t type;
+        uint32_t sequence;
+        size_t size;
+        ok = session_send_tagged(&client, MSG_GET_BOARD, (uint32_t)i + 1, payload, sizeof(payload)) == SUCCESS &&
+             session_recv_tagged_timeout(&client, &type, &sequence, reply, sizeof(reply), &size, 5000) == SUCCESS &&
+             sequence == (uint32_t)i + 1;
+    }
+    *seconds = clock_seconds() - start;
+
+    /* Closing the client ends the echo thread */
+    session_close(&client);
+    pthread_join(echo, NULL);
+    session_close(&server);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int round_trips = argc > 1 ? atoi(argv[1]) : 50000;
+    if (round_trips <= 0) round_trips = 50000;
+
+    printf("Transport benchmark (%d round trips, %d-byte payload)\n", round_trips, PAYLOAD_SIZE);
+    printf("  %-9s %12s %12s\n", "transport", "rtt/s", "us/rtt");
+
+    const char* transports[] = { "tcp", "unix", "loopback" };
+    for (int t = 0; t < 3; t++) {
+        double seconds;
+        if (!run_case(transports[t], round_trips, &seconds)) {
+            fprintf(stderr, "%s case failed\n", transports[t]);
+            return 1;
+        }
+        printf("  %-9s %12.0f %12.2f\n", transports[t], round_trips / seconds, seconds * 1e6 / round_trips);
+    }
+
+    return 0;
+}
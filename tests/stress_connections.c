@@ -0,0 +1,195 @@
+/* Connection Stress Test
+ * Opens thousands of loopback connections in one process, so socket fds run
+ * far past FD_SETSIZE, and drives them all through one poll context: every
+ * client sends a tagged request, the server side echoes it, every client
+ * checks its reply, then all clients hang up and the server sees each EOF.
+ *
+ * Usage: stress_connections [port] [connections]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "network/session.h"
+#include "network/connection.h"
+#include "common/protocol.h"
+#include "common/messages.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define DEFAULT_CONNECTIONS 5000
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Two fds per connection plus headroom; raise the soft limit if allowed */
+static int fit_to_fd_limit(int wanted) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return wanted;
+
+    rlim_t needed = (rlim_t)wanted * 2 + 64;
+    if (limit.rlim_cur < needed) {
+        limit.rlim_cur = limit.rlim_max == RLIM_INFINITY || limit.rlim_max >= needed ? needed : limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (limit.rlim_cur >= needed) return wanted;
+    return (int)((limit.rlim_cur - 64) / 2);
+}
+
+int main(int argc, char* argv[]) {
+    int port = argc > 1 ? atoi(argv[1]) : 4012;
+    int wanted = argc > 2 ? atoi(argv[2]) : DEFAULT_CONNECTIONS;
+    if (wanted <= 0) wanted = DEFAULT_CONNECTIONS;
+
+    int total = fit_to_fd_limit(wanted);
+    if (total < wanted) {
+        printf("File descriptor limit allows only %d of %d connections\n", total, wanted);
+    }
+    if (total <= 0) return 1;
+
+    session_t* clients = calloc((size_t)total, sizeof(session_t));
+    session_t* servers = calloc((size_t)total, sizeof(session_t));
+    if (!clients || !servers) return 1;
+
+    connection_t listener;
+    connection_init(&listener);
+    if (connection_create_server(&listener, port) != SUCCESS) {
+        fprintf(stderr, "Cannot listen on port %d\n", port);
+        return 1;
+    }
+
+    poll_context_t ctx;
+    if (poll_context_init(&ctx, 5000) != SUCCESS) return 1;
+    poll_context_add(&ctx, listener.socket_fd, POLL_CONTEXT_READ);
+
+    /* fd -> server session, sized for the highest fd we can get */
+    struct rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    size_t max_fd = (size_t)limit.rlim_cur;
+    session_t** by_fd = calloc(max_fd, sizeof(session_t*));
+    if (!by_fd) return 1;
+
+    /* Phase 1: connect and accept (the listen backlog is small, so accept
+     * each connection as soon as the listener reports it) */
+    double start = now_seconds();
+    int highest_fd = 0;
+    for (int i = 0; i < total; i++) {
+        session_init(&clients[i]);
+        if (connection_connect(&clients[i].conn, "127.0.0.1", port) != SUCCESS) {
+            fprintf(stderr, "connect %d failed\n", i);
+            return 1;
+        }
+
+        int ready = 0;
+        if (poll_context_wait(&ctx, &ready) != SUCCESS || !poll_context_is_readable(&ctx, listener.socket_fd)) {
+            fprintf(stderr, "listener not readable after connect %d\n", i);
+            return 1;
+        }
+        session_init(&servers[i]);
+        if (connection_accept(&listener, &servers[i].conn) != SUCCESS) {
+            fprintf(stderr, "accept %d failed\n", i);
+            return 1;
+        }
+        int fd = servers[i].conn.socket_fd;
+        if ((size_t)fd >= max_fd || poll_context_add(&ctx, fd, POLL_CONTEXT_READ) != SUCCESS) {
+            fprintf(stderr, "cannot register fd %d\n", fd);
+            return 1;
+        }
+        by_fd[fd] = &servers[i];
+        if (fd > highest_fd) highest_fd = fd;
+        if (clients[i].conn.socket_fd > highest_fd) highest_fd = clients[i].conn.socket_fd;
+    }
+    poll_context_remove(&ctx, listener.socket_fd);
+    double connected = now_seconds();
+
+    /* Phase 2: every client sends a request tagged with its index */
+    for (int i = 0; i < total; i++) {
+        uint32_t value = (uint32_t)i;
+        if (session_send_tagged(&clients[i], MSG_GET_BOARD, (uint32_t)i + 1, &value, sizeof(value)) != SUCCESS) {
+            fprintf(stderr, "client %d send failed\n", i);
+            return 1;
+        }
+    }
+
+    /* The server side answers whatever the poll context reports */
+    int answered = 0;
+    while (answered < total) {
+        int ready = 0;
+        if (poll_context_wait(&ctx, &ready) != SUCCESS || ready == 0) {
+            fprintf(stderr, "server stalled after %d of %d requests\n", answered, total);
+            return 1;
+        }
+        for (int r = 0; r < ready; r++) {
+            const poll_event_t* ev = poll_context_ready(&ctx, r);
+            session_t* server = by_fd[ev->fd];
+            frame_view_t frame;
+            while (connection_recv_frame(&server->conn, &frame, 0) == SUCCESS) {
+                uint32_t value;
+                memcpy(&value, frame.payload, sizeof(value));
+                value = value * 2 + 1;
+                if (session_send_tagged(server, MSG_GET_BOARD, frame.sequence, &value, sizeof(value)) != SUCCESS) {
+                    fprintf(stderr, "reply on fd %d failed\n", ev->fd);
+                    return 1;
+                }
+                answered++;
+            }
+        }
+    }
+
+    /* Each client reads its own reply; fds above FD_SETSIZE use poll() */
+    for (int i = 0; i < total; i++) {
+        message_type_t type;
+        uint32_t sequence, value;
+        size_t size;
+        if (session_recv_tagged_timeout(&clients[i], &type, &sequence, &value, sizeof(value), &size, 5000) != SUCCESS ||
+            sequence != (uint32_t)i + 1 || value != (uint32_t)i * 2 + 1) {
+            fprintf(stderr, "client %d got a wrong or missing reply\n", i);
+            return 1;
+        }
+    }
+    double exchanged = now_seconds();
+
+    /* Phase 3: clients hang up; the server sees every EOF */
+    for (int i = 0; i < total; i++) session_close(&clients[i]);
+    int closed = 0;
+    while (closed < total) {
+        int ready = 0;
+        if (poll_context_wait(&ctx, &ready) != SUCCESS || ready == 0) {
+            fprintf(stderr, "only %d of %d hangups seen\n", closed, total);
+            return 1;
+        }
+        for (int r = 0; r < ready; r++) {
+            const poll_event_t* ev = poll_context_ready(&ctx, r);
+            session_t* server = by_fd[ev->fd];
+            frame_view_t frame;
+            if (connection_recv_frame(&server->conn, &frame, 0) == ERR_NETWORK_ERROR) {
+                int fd = server->conn.socket_fd;
+                poll_context_remove(&ctx, fd);
+                by_fd[fd] = NULL;
+                session_close(server);
+                closed++;
+            }
+        }
+    }
+    double finished = now_seconds();
+
+    printf("%d connections (highest fd %d, FD_SETSIZE %d)\n", total, highest_fd, FD_SETSIZE);
+    printf("  connect+accept: %.3f s\n", connected - start);
+    printf("  request/reply:  %.3f s (%.0f round trips/s)\n", exchanged - connected,
+           total / (exchanged - connected));
+    printf("  hangup:         %.3f s\n", finished - exchanged);
+
+    poll_context_destroy(&ctx);
+    connection_close(&listener);
+    free(by_fd);
+    free(clients);
+    free(servers);
+    return 0;
+}
@@ -5,11 +5,24 @@
 #include "network/serialization.h"
 #include "network/connection.h"
 #include "network/session.h"
+#include "network/board_delta.h"
+#include "network/codec.h"
+#include "network/compression.h"
+#include "network/read_buffer.h"
+#include "network/write_queue.h"
+#include "network/io_backend.h"
 #include "common/protocol.h"
 #include "common/messages.h"
+#include "common/checksum.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 /* Test utilities */
 #define TEST(name) void test_##name()
@@ -113,13 +126,48 @@ TEST(serialize_full_message) {
     assert(output_size == HEADER_SIZE + sizeof(connect_msg));
 }
 
+TEST(serialize_tagged_message) {
+    msg_get_bio_t req;
+    memset(&req, 0, sizeof(req));
+    strncpy(req.target_player, "Alice", MAX_PSEUDO_LEN);
+    
+    char output[MAX_MESSAGE_SIZE];
+    size_t output_size;
+    
+    error_code_t err = serialize_message_tagged(MSG_GET_BIO, 0xA5A50007u, &req,
+                                                sizeof(req), output, &output_size);
+    assert(err == SUCCESS);
+    assert(output_size == HEADER_SIZE + sizeof(req));
+    
+    /* The tag travels in the header sequence field */
+    serialize_buffer_t buffer;
+    serialize_buffer_init(&buffer);
+    memcpy(buffer.data, output, HEADER_SIZE);
+    buffer.size = HEADER_SIZE;
+    message_header_t header;
+    err = deserialize_header(&buffer, &header);
+    assert(err == SUCCESS);
+    assert(header.type == MSG_GET_BIO);
+    assert(header.sequence == 0xA5A50007u);
+    
+    /* Untagged messages (notifications) carry sequence 0 */
+    err = serialize_message(MSG_GET_BIO, &req, sizeof(req), output, &output_size);
+    assert(err == SUCCESS);
+    serialize_buffer_init(&buffer);
+    memcpy(buffer.data, output, HEADER_SIZE);
+    buffer.size = HEADER_SIZE;
+    err = deserialize_header(&buffer, &header);
+    assert(err == SUCCESS);
+    assert(header.sequence == 0);
+}
+
 TEST(message_size_calculation) {
     /* Test that we correctly calculate message sizes */
     msg_player_list_t list;
     list.count = 3;
     
     /* Correct size: count + actual players */
-    size_t correct_size = sizeof(list.count) + (3 * sizeof(player_info_t));
+    size_t correct_size = sizeof(list.count) + (3 * sizeof(list.players[0]));
     
     /* Wrong size: entire struct */
     size_t wrong_size = sizeof(list);
@@ -154,27 +202,85 @@ TEST(connection_is_connected) {
     assert(connection_is_connected(&conn) == true);
 }
 
-/* ========== Select Context Tests ========== */
+/* ========== Poll Context Tests ========== */
 
-TEST(select_context_init) {
-    select_context_t ctx;
-    error_code_t err = select_context_init(&ctx, 5, 0);
+TEST(poll_context_init) {
+    poll_context_t ctx;
+    error_code_t err = poll_context_init(&ctx, 5000);
     
     assert(err == SUCCESS);
-    assert(ctx.max_fd == -1);
-    assert(ctx.timeout.tv_sec == 5);
-    assert(ctx.timeout.tv_usec == 0);
+    assert(ctx.epoll_fd >= 0);
+    assert(ctx.registered == 0);
+    assert(ctx.ready_count == 0);
+    assert(ctx.timeout_ms == 5000);
+    poll_context_destroy(&ctx);
+    assert(ctx.epoll_fd == -1);
 }
 
-TEST(select_context_add_fd) {
-    select_context_t ctx;
-    select_context_init(&ctx, 1, 0);
+TEST(poll_context_add_fd) {
+    poll_context_t ctx;
+    poll_context_init(&ctx, 1000);
+    
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    assert(poll_context_add(&ctx, fds[0], POLL_CONTEXT_READ) == SUCCESS);
+    assert(poll_context_add(&ctx, fds[0], POLL_CONTEXT_READ) == ERR_DUPLICATE);
+    assert(ctx.registered == 1);
     
-    int test_fd = 5;
-    select_context_add_read(&ctx, test_fd);
+    /* Readable once the peer writes */
+    assert(write(fds[1], "x", 1) == 1);
+    int ready;
+    assert(poll_context_wait(&ctx, &ready) == SUCCESS);
+    assert(ready == 1);
+    assert(poll_context_is_readable(&ctx, fds[0]));
+    assert(!poll_context_is_writable(&ctx, fds[0]));
+    assert(poll_context_ready(&ctx, 0)->fd == fds[0]);
+    assert(poll_context_ready(&ctx, 1) == NULL);
     
-    assert(ctx.max_fd == test_fd);
-    assert(FD_ISSET(test_fd, &ctx.read_fds));
+    /* Write interest reports a writable socket */
+    assert(poll_context_modify(&ctx, fds[0], POLL_CONTEXT_READ | POLL_CONTEXT_WRITE) == SUCCESS);
+    assert(poll_context_wait(&ctx, &ready) == SUCCESS);
+    assert(poll_context_is_writable(&ctx, fds[0]));
+    
+    assert(poll_context_remove(&ctx, fds[0]) == SUCCESS);
+    assert(ctx.registered == 0);
+    close(fds[0]);
+    close(fds[1]);
+    poll_context_destroy(&ctx);
+}
+
+TEST(poll_context_beyond_fd_setsize) {
+    /* Push a socket past FD_SETSIZE, where fd_set would be out of bounds */
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    int high = fcntl(fds[0], F_DUPFD, 1100);
+    if (high < 0) {
+        /* RLIMIT_NOFILE too low to test; nothing to check */
+        close(fds[0]);
+        close(fds[1]);
+        return;
+    }
+    assert(high >= 1100);
+    
+    poll_context_t ctx;
+    poll_context_init(&ctx, 1000);
+    assert(poll_context_add(&ctx, high, POLL_CONTEXT_READ) == SUCCESS);
+    assert(write(fds[1], "y", 1) == 1);
+    int ready;
+    assert(poll_context_wait(&ctx, &ready) == SUCCESS && ready == 1);
+    assert(poll_context_is_readable(&ctx, high));
+    assert(poll_fd(high, POLL_CONTEXT_READ, 0) == SUCCESS);
+    
+    /* Peer hangup is reported as readable (EOF) */
+    close(fds[1]);
+    char c;
+    assert(read(high, &c, 1) == 1);
+    assert(poll_context_wait(&ctx, &ready) == SUCCESS && ready == 1);
+    assert(poll_context_is_readable(&ctx, high));
+    
+    poll_context_destroy(&ctx);
+    close(high);
+    close(fds[0]);
 }
 
 /* ========== Protocol Tests ========== */
@@ -204,11 +310,11 @@ TEST(msg_connect_structure) {
 
 TEST(msg_play_move_structure) {
     msg_play_move_t msg;
-    strncpy(msg.game_id, "game123", MAX_GAME_ID_LEN);
+    msg.game = GAME_HANDLE_MAKE(3, 1);
     msg.pit_index = 5;
     
     assert(msg.pit_index >= 0 && msg.pit_index < NUM_PITS);
-    assert(strlen(msg.game_id) > 0);
+    assert(msg.game != GAME_HANDLE_NONE);
 }
 
 TEST(msg_board_state_structure) {
@@ -251,16 +357,16 @@ TEST(message_size_limit) {
     msg_player_list_t list;
     memset(&list, 0, sizeof(list));
     /* Compute the maximum number of player entries that fit in the payload */
-    size_t max_allowed = (MAX_PAYLOAD_SIZE - sizeof(list.count)) / sizeof(player_info_t);
+    size_t max_allowed = (MAX_PAYLOAD_SIZE - sizeof(list.count)) / sizeof(list.players[0]);
 
     /* Use the maximum allowed count and ensure it fits */
     list.count = (int)max_allowed;
-    size_t msg_size = sizeof(list.count) + (list.count * sizeof(player_info_t));
+    size_t msg_size = sizeof(list.count) + (list.count * sizeof(list.players[0]));
     assert(msg_size <= MAX_PAYLOAD_SIZE);
 
     /* Using one more than allowed should overflow */
     list.count = (int)(max_allowed + 1);
-    msg_size = sizeof(list.count) + (list.count * sizeof(player_info_t));
+    msg_size = sizeof(list.count) + (list.count * sizeof(list.players[0]));
     assert(msg_size > MAX_PAYLOAD_SIZE);
 }
 
@@ -294,24 +400,40 @@ TEST(connection_error_states) {
     assert(conn.socket_fd == -1);
 }
 
-TEST(select_context_edge_cases) {
-    select_context_t ctx;
+TEST(poll_context_edge_cases) {
+    poll_context_t ctx;
     
     /* Test with invalid parameters */
-    error_code_t err = select_context_init(NULL, 1, 0);
+    error_code_t err = poll_context_init(NULL, 1000);
     assert(err != SUCCESS);
     
     /* Test valid initialization */
-    err = select_context_init(&ctx, 1, 0);
+    err = poll_context_init(&ctx, 0);
     assert(err == SUCCESS);
     
     /* Test adding invalid fd */
-    err = select_context_add_read(&ctx, -1);
+    err = poll_context_add(&ctx, -1, POLL_CONTEXT_READ);
     assert(err != SUCCESS);
     
-    /* Test adding valid fd */
-    err = select_context_add_read(&ctx, 0); /* stdin */
-    assert(err == SUCCESS);
+    /* Removing an fd that was never added */
+    err = poll_context_remove(&ctx, 0);
+    assert(err != SUCCESS);
+    
+    /* Nothing registered: a zero timeout returns at once */
+    int ready = -1;
+    err = poll_context_wait(&ctx, &ready);
+    assert(err == SUCCESS && ready == 0);
+    assert(!poll_context_is_readable(&ctx, 0));
+    
+    /* Single-fd waits */
+    assert(poll_fd(-1, POLL_CONTEXT_READ, 0) == ERR_INVALID_PARAM);
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    assert(poll_fd(fds[0], POLL_CONTEXT_READ, 10) == ERR_TIMEOUT);
+    assert(poll_fd(fds[0], POLL_CONTEXT_WRITE, 10) == SUCCESS);
+    close(fds[0]);
+    close(fds[1]);
+    poll_context_destroy(&ctx);
 }
 
 TEST(serialization_edge_cases) {
@@ -384,6 +506,1102 @@ TEST(notification_listener_error_recovery) {
     assert(IS_NOTIFICATION_MESSAGE(MSG_PLAY_MOVE) == false);
 }
 
+/* ========== Board Delta Tests ========== */
+
+static void make_test_board(board_t* board) {
+    memset(board, 0, sizeof(*board));
+    for (int i = 0; i < NUM_PITS; i++) {
+        board->pits[i] = INITIAL_SEEDS_PER_PIT;
+    }
+    board->current_player = PLAYER_A;
+    board->state = GAME_STATE_IN_PROGRESS;
+    board->winner = NO_WINNER;
+}
+
+TEST(board_delta_changed_pits_only) {
+    board_t before, after;
+    make_test_board(&before);
+    after = before;
+
+    /* Sow pit 2: four seeds into pits 3..6, capture nothing */
+    after.pits[2] = 0;
+    for (int i = 3; i <= 6; i++) after.pits[i]++;
+    after.current_player = PLAYER_B;
+
+    msg_board_delta_t delta;
+    board_delta_build(&before, &after, 1, 1, 2, &delta);
+
+    assert(!(delta.flags & BOARD_DELTA_KEYFRAME));
+    assert(delta.seq == 1);
+    assert(delta.pit_played == 2);
+    assert(delta.changed_count == 5);
+    assert(delta.score_a == 0 && delta.score_b == 0);
+    assert(delta.current_player == PLAYER_B);
+}
+
+TEST(board_delta_keyframe_interval) {
+    board_t before, after;
+    make_test_board(&before);
+    after = before;
+    after.scores[0] = 7;
+
+    msg_board_delta_t delta;
+    board_delta_build(&before, &after, 1, BOARD_KEYFRAME_INTERVAL, 0, &delta);
+    assert(delta.flags & BOARD_DELTA_KEYFRAME);
+    assert(delta.changed_count == NUM_PITS);
+    assert(delta.score_a == 7);  /* Absolute on keyframes */
+
+    board_delta_build(&before, &after, 1, BOARD_KEYFRAME_INTERVAL + 1, 0, &delta);
+    assert(!(delta.flags & BOARD_DELTA_KEYFRAME));
+    assert(delta.score_a == 7);  /* Relative: 7 - 0 */
+}
+
+TEST(board_delta_apply_sequence) {
+    board_t before, after;
+    make_test_board(&before);
+    after = before;
+    after.pits[0] = 0;
+    after.pits[1] = 5;
+    after.scores[1] = 2;
+
+    msg_board_state_t cached;
+    memset(&cached, 0, sizeof(cached));
+    cached.exists = true;
+    for (int i = 0; i < NUM_PITS; i++) cached.pits[i] = before.pits[i];
+    cached.seq = 3;
+
+    msg_board_delta_t delta;
+    board_delta_build(&before, &after, 1, 4, 0, &delta);
+    assert(board_delta_apply(&cached, &delta) == SUCCESS);
+    assert(cached.seq == 4);
+    assert(cached.pits[0] == 0 && cached.pits[1] == 5);
+    assert(cached.score_b == 2);
+
+    /* Replayed delta is stale */
+    assert(board_delta_apply(&cached, &delta) == ERR_DUPLICATE);
+
+    /* Skipping seq 5 is a gap */
+    board_delta_build(&before, &after, 1, 6, 0, &delta);
+    assert(board_delta_apply(&cached, &delta) == ERR_SEQUENCE_GAP);
+    assert(cached.seq == 4);
+
+    /* A keyframe heals the gap */
+    board_delta_build_keyframe(&after, 1, 6, &delta);
+    assert(board_delta_apply(&cached, &delta) == SUCCESS);
+    assert(cached.seq == 6);
+    assert(cached.score_b == 2);
+}
+
+TEST(board_delta_wire_size) {
+    board_t board;
+    make_test_board(&board);
+
+    msg_board_delta_t delta;
+    board_delta_build_keyframe(&board, 1, 0, &delta);
+
+    size_t size = board_delta_wire_size(&delta);
+    assert(size == offsetof(msg_board_delta_t, changed) + NUM_PITS * sizeof(board_delta_pit_t));
+    assert(size < sizeof(msg_board_state_t));
+    assert(board_delta_validate(&delta, size) == SUCCESS);
+
+    /* Truncated inside the changed pits */
+    assert(board_delta_validate(&delta, size - 1) == ERR_SERIALIZATION);
+
+    delta.changed_count = NUM_PITS + 1;
+    assert(board_delta_validate(&delta, size) == ERR_SERIALIZATION);
+}
+
+/* ========== Compact Codec Tests ========== */
+
+TEST(varint_round_trip) {
+    serialize_buffer_t buffer;
+    serialize_buffer_init(&buffer);
+
+    uint64_t values[] = {0, 1, 127, 128, 300, 16383, 16384, UINT32_MAX, UINT64_MAX};
+    size_t count = sizeof(values) / sizeof(values[0]);
+    for (size_t i = 0; i < count; i++) {
+        assert(serialize_varint(&buffer, values[i]) == SUCCESS);
+    }
+    /* Small values take one byte, the largest ten */
+    assert(buffer.data[0] == 0 && buffer.data[1] == 1);
+
+    serialize_buffer_reset(&buffer);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value;
+        assert(deserialize_varint(&buffer, &value) == SUCCESS);
+        assert(value == values[i]);
+    }
+    assert(buffer.position == buffer.size);
+
+    /* Zigzag keeps small negatives short */
+    serialize_buffer_init(&buffer);
+    assert(serialize_svarint(&buffer, -1) == SUCCESS);
+    assert(buffer.size == 1);
+    assert(serialize_svarint(&buffer, INT64_MIN) == SUCCESS);
+    serialize_buffer_reset(&buffer);
+    int64_t signed_value;
+    assert(deserialize_svarint(&buffer, &signed_value) == SUCCESS);
+    assert(signed_value == -1);
+    assert(deserialize_svarint(&buffer, &signed_value) == SUCCESS);
+    assert(signed_value == INT64_MIN);
+
+    /* Unterminated varint */
+    serialize_buffer_init(&buffer);
+    buffer.data[0] = (char)0x80;
+    buffer.size = 1;
+    uint64_t value;
+    assert(deserialize_varint(&buffer, &value) == ERR_SERIALIZATION);
+}
+
+TEST(lstring_round_trip) {
+    serialize_buffer_t buffer;
+    serialize_buffer_init(&buffer);
+
+    assert(serialize_lstring(&buffer, "Alice", MAX_PSEUDO_LEN) == SUCCESS);
+    assert(buffer.size == 1 + 5);
+    assert(serialize_lstring(&buffer, "", MAX_PSEUDO_LEN) == SUCCESS);
+
+    serialize_buffer_reset(&buffer);
+    char out[MAX_PSEUDO_LEN];
+    assert(deserialize_lstring(&buffer, out, sizeof(out)) == SUCCESS);
+    assert(strcmp(out, "Alice") == 0);
+    assert(deserialize_lstring(&buffer, out, sizeof(out)) == SUCCESS);
+    assert(out[0] == '\0');
+
+    /* A length that does not fit the destination is rejected */
+    serialize_buffer_init(&buffer);
+    assert(serialize_lstring(&buffer, "abcdefgh", 64) == SUCCESS);
+    serialize_buffer_reset(&buffer);
+    char small[4];
+    assert(deserialize_lstring(&buffer, small, sizeof(small)) == ERR_SERIALIZATION);
+}
+
+TEST(codec_round_trip) {
+    msg_chat_message_t chat;
+    memset(&chat, 0, sizeof(chat));
+    strncpy(chat.sender, "alice", MAX_PSEUDO_LEN);
+    strncpy(chat.recipient, "bob", MAX_PSEUDO_LEN);
+    strncpy(chat.message, "good game", MAX_CHAT_LEN);
+    chat.timestamp = 1700000000;
+
+    char wire[MAX_PAYLOAD_SIZE];
+    size_t wire_size;
+    assert(codec_encode(MSG_CHAT_MESSAGE, &chat, sizeof(chat), wire, sizeof(wire), &wire_size) == SUCCESS);
+    assert(wire_size < 32);
+
+    msg_chat_message_t decoded;
+    size_t decoded_size;
+    memset(&decoded, 0xFF, sizeof(decoded));
+    assert(codec_decode(MSG_CHAT_MESSAGE, wire, wire_size, &decoded, sizeof(decoded), &decoded_size) == SUCCESS);
+    assert(decoded_size == sizeof(chat));
+    assert(memcmp(&decoded, &chat, sizeof(chat)) == 0);
+
+    /* Lists come back at the size a raw sender would have used */
+    msg_player_list_t list;
+    memset(&list, 0, sizeof(list));
+    list.count = 2;
+    strncpy(list.players[0].pseudo, "alice", MAX_PSEUDO_LEN);
+    strncpy(list.players[0].ip, "127.0.0.1", MAX_IP_LEN);
+    strncpy(list.players[1].pseudo, "bob", MAX_PSEUDO_LEN);
+    strncpy(list.players[1].ip, "10.0.0.2", MAX_IP_LEN);
+    size_t raw_size = offsetof(msg_player_list_t, players) + 2 * sizeof(player_list_item_t);
+
+    assert(codec_encode(MSG_PLAYER_LIST, &list, raw_size, wire, sizeof(wire), &wire_size) == SUCCESS);
+    msg_player_list_t decoded_list;
+    assert(codec_decode(MSG_PLAYER_LIST, wire, wire_size, &decoded_list, sizeof(decoded_list),
+                        &decoded_size) == SUCCESS);
+    assert(decoded_size == raw_size);
+    assert(memcmp(&decoded_list, &list, raw_size) == 0);
+
+    /* Paged list request and its end marker */
+    msg_list_page_t page;
+    memset(&page, 0, sizeof(page));
+    page.list_type = MSG_LIST_SAVED_GAMES;
+    page.cursor = 300;
+    page.limit = 25;
+    page.flags = LIST_FLAG_STREAM;
+    strncpy(page.player, "alice", MAX_PSEUDO_LEN);
+    assert(codec_encode(MSG_LIST_PAGE, &page, sizeof(page), wire, sizeof(wire), &wire_size) == SUCCESS);
+    assert(wire_size < 16);
+    msg_list_page_t decoded_page;
+    assert(codec_decode(MSG_LIST_PAGE, wire, wire_size, &decoded_page, sizeof(decoded_page),
+                        &decoded_size) == SUCCESS);
+    assert(decoded_size == sizeof(page));
+    assert(memcmp(&decoded_page, &page, sizeof(page)) == 0);
+
+    /* Saved-game cursors are game log IDs and keep all 64 bits */
+    msg_list_end_t end;
+    memset(&end, 0, sizeof(end));
+    end.list_type = MSG_LIST_SAVED_GAMES;
+    end.next_cursor = ((uint64_t)1 << 40) + 4097;
+    end.entries = 100000;
+    end.frames = 1000;
+    assert(codec_encode(MSG_LIST_END, &end, sizeof(end), wire, sizeof(wire), &wire_size) == SUCCESS);
+    msg_list_end_t decoded_end;
+    assert(codec_decode(MSG_LIST_END, wire, wire_size, &decoded_end, sizeof(decoded_end),
+                        &decoded_size) == SUCCESS);
+    assert(decoded_end.list_type == end.list_type && decoded_end.next_cursor == end.next_cursor);
+    assert(decoded_end.entries == end.entries && decoded_end.frames == end.frames);
+
+    /* Game handles survive with both halves intact */
+    msg_play_move_t move;
+    memset(&move, 0, sizeof(move));
+    move.game = GAME_HANDLE_MAKE(4095, 0xFFFFFFFFu);
+    strncpy(move.player, "alice", MAX_PSEUDO_LEN);
+    move.pit_index = 9;
+    assert(codec_encode(MSG_PLAY_MOVE, &move, sizeof(move), wire, sizeof(wire), &wire_size) == SUCCESS);
+    msg_play_move_t decoded_move;
+    assert(codec_decode(MSG_PLAY_MOVE, wire, wire_size, &decoded_move, sizeof(decoded_move),
+                        &decoded_size) == SUCCESS);
+    assert(decoded_move.game == move.game);
+    assert(GAME_HANDLE_SLOT(decoded_move.game) == 4095);
+    assert(GAME_HANDLE_GENERATION(decoded_move.game) == 0xFFFFFFFFu);
+
+    /* Empty payloads have no compact form */
+    assert(!codec_supports(MSG_LIST_PLAYERS));
+    assert(codec_supports(MSG_BOARD_STATE));
+}
+
+TEST(codec_rejects_malformed) {
+    msg_game_over_t over;
+    memset(&over, 0, sizeof(over));
+    over.game = GAME_HANDLE_MAKE(12, 7);
+    over.winner = WINNER_A;
+    over.score_a = 25;
+    strncpy(over.message, "Alice wins", sizeof(over.message));
+
+    char wire[MAX_PAYLOAD_SIZE];
+    size_t wire_size;
+    assert(codec_encode(MSG_GAME_OVER, &over, sizeof(over), wire, sizeof(wire), &wire_size) == SUCCESS);
+
+    msg_game_over_t decoded;
+    size_t decoded_size;
+    /* Truncated, trailing garbage, and a destination that is too small */
+    assert(codec_decode(MSG_GAME_OVER, wire, wire_size - 1, &decoded, sizeof(decoded), &decoded_size) != SUCCESS);
+    wire[wire_size] = 0;
+    assert(codec_decode(MSG_GAME_OVER, wire, wire_size + 1, &decoded, sizeof(decoded), &decoded_size) != SUCCESS);
+    assert(codec_decode(MSG_GAME_OVER, wire, wire_size, &decoded, sizeof(decoded) - 1, &decoded_size) != SUCCESS);
+
+    /* A list count beyond the struct capacity */
+    serialize_buffer_t buffer;
+    serialize_buffer_init(&buffer);
+    assert(serialize_varint(&buffer, 101) == SUCCESS);
+    msg_player_list_t list;
+    assert(codec_decode(MSG_PLAYER_LIST, buffer.data, buffer.size, &list, sizeof(list), &decoded_size) != SUCCESS);
+
+    /* Output that would not fit is refused rather than truncated */
+    assert(codec_encode(MSG_GAME_OVER, &over, sizeof(over), wire, 4, &wire_size) == ERR_SERIALIZATION);
+}
+
+TEST(codec_version_negotiation) {
+    assert(codec_for_version(PROTOCOL_VERSION) == CODEC_RAW);
+    assert(codec_for_version(PROTOCOL_VERSION_COMPACT) == CODEC_COMPACT);
+    assert(codec_for_version("2.0") == CODEC_COMPACT);
+    assert(codec_for_version("") == CODEC_RAW);
+    assert(codec_for_version(NULL) == CODEC_RAW);
+}
+
+/* ========== Compression Tests ========== */
+
+TEST(compression_round_trip) {
+    /* A full player list, compact-encoded, as the server would send it */
+    static msg_player_list_t list;
+    memset(&list, 0, sizeof(list));
+    list.count = 100;
+    for (int i = 0; i < list.count; i++) {
+        snprintf(list.players[i].pseudo, MAX_PSEUDO_LEN, "player%d", i);
+        snprintf(list.players[i].ip, MAX_IP_LEN, "192.168.1.%d", i);
+    }
+    size_t raw_size = offsetof(msg_player_list_t, players) + list.count * sizeof(player_list_item_t);
+
+    char compact[MAX_PAYLOAD_SIZE];
+    size_t compact_size;
+    assert(codec_encode(MSG_PLAYER_LIST, &list, raw_size, compact, sizeof(compact), &compact_size) == SUCCESS);
+    assert(compression_should_compress(MSG_PLAYER_LIST, compact_size));
+
+    compression_reset_stats();
+    char packed[MAX_PAYLOAD_SIZE];
+    size_t packed_size;
+    assert(compression_compress(compact, compact_size, packed, sizeof(packed), &packed_size) == SUCCESS);
+    assert(packed_size < compact_size);
+
+    char inflated[MAX_PAYLOAD_SIZE];
+    size_t inflated_size;
+    assert(compression_decompress(packed, packed_size, inflated, sizeof(inflated), &inflated_size) == SUCCESS);
+    assert(inflated_size == compact_size);
+    assert(memcmp(inflated, compact, compact_size) == 0);
+
+    compression_stats_t stats;
+    compression_get_stats(&stats);
+    assert(stats.frames_compressed == 1);
+    assert(stats.bytes_in == compact_size && stats.bytes_out == packed_size);
+    assert(stats.frames_decompressed == 1);
+}
+
+TEST(compression_hot_path_excluded) {
+    /* Moves and board updates never compress, whatever their size */
+    assert(!compression_should_compress(MSG_PLAY_MOVE, MAX_PAYLOAD_SIZE));
+    assert(!compression_should_compress(MSG_MOVE_RESULT, MAX_PAYLOAD_SIZE));
+    assert(!compression_should_compress(MSG_BOARD_STATE, MAX_PAYLOAD_SIZE));
+    assert(!compression_should_compress(MSG_BOARD_DELTA, MAX_PAYLOAD_SIZE));
+
+    /* Bulk types only above the threshold */
+    assert(!compression_should_compress(MSG_GAME_LIST, COMPRESSION_THRESHOLD - 1));
+    assert(compression_should_compress(MSG_GAME_LIST, COMPRESSION_THRESHOLD));
+}
+
+TEST(compression_rejects_malformed) {
+    char input[64];
+    memset(input, 'x', sizeof(input));
+    char output[MAX_PAYLOAD_SIZE];
+    size_t output_size;
+
+    /* Not a zlib stream */
+    assert(compression_decompress(input, sizeof(input), output, sizeof(output), &output_size) == ERR_SERIALIZATION);
+
+    /* Inflates past the caller's limit */
+    static char big[MAX_PAYLOAD_SIZE];
+    memset(big, 'a', sizeof(big));
+    char packed[MAX_PAYLOAD_SIZE];
+    size_t packed_size;
+    assert(compression_compress(big, sizeof(big), packed, sizeof(packed), &packed_size) == SUCCESS);
+    assert(compression_decompress(packed, packed_size, output, 100, &output_size) == ERR_SERIALIZATION);
+
+    /* Incompressible input is reported, not sent bigger */
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < sizeof(input); i++) {
+        seed = seed * 1103515245u + 12345u;
+        input[i] = (char)(seed >> 16);
+    }
+    assert(compression_compress(input, sizeof(input), packed, sizeof(packed), &packed_size) == ERR_SERIALIZATION);
+}
+
+TEST(crc32c_matches_portable) {
+    /* The standard check value, whichever implementation runs */
+    assert(checksum_crc32c(0, "123456789", 9) == 0xE3069283u);
+    assert(checksum_crc32c_portable(0, "123456789", 9) == 0xE3069283u);
+
+    /* Every alignment and a range of lengths across the 3-stream rounds */
+    static uint8_t data[4096];
+    unsigned int seed = 99;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t size = 0; size + offset <= sizeof(data); size += 13) {
+            uint32_t crc = checksum_crc32c(0, data + offset, size);
+            assert(crc == checksum_crc32c_portable(0, data + offset, size));
+            /* Chained over two pieces */
+            assert(crc == checksum_crc32c(checksum_crc32c(0, data + offset, size / 3), data + offset + size / 3,
+                                          size - size / 3));
+        }
+    }
+}
+
+TEST(checksum_frames) {
+    session_t a, b;
+    session_init(&a);
+    session_init(&b);
+    assert(connection_loopback_pair(&a.conn, &b.conn) == SUCCESS);
+    a.features = CONNECT_FEATURE_CHECKSUM;
+
+    /* Checked on receipt whatever the receiver negotiated */
+    char payload[512];
+    memset(payload, 'p', sizeof(payload));
+    assert(session_send_message(&a, MSG_GET_BOARD, payload, sizeof(payload)) == SUCCESS);
+    message_header_t header;
+    assert(connection_peek_frame(&b.conn, &header, 1000) == SUCCESS);
+    assert(header.reserved & HEADER_FLAG_CHECKSUM);
+    assert(header.length == sizeof(payload) + FRAME_CHECKSUM_SIZE);
+    char received[sizeof(payload)];
+    message_type_t type;
+    size_t size;
+    assert(session_recv_message_timeout(&b, &type, received, sizeof(received), &size, 1000, NULL, 0) == SUCCESS);
+    assert(type == MSG_GET_BOARD && size == sizeof(payload) && memcmp(received, payload, size) == 0);
+
+    /* An empty payload still carries its CRC */
+    assert(session_send_message(&a, MSG_GET_BOARD, NULL, 0) == SUCCESS);
+    assert(session_recv_message_timeout(&b, &type, received, sizeof(received), &size, 1000, NULL, 0) == SUCCESS);
+    assert(size == 0);
+
+    /* A flipped bit fails the frame and the session */
+    char corrupt[FRAME_CHECKSUM_SIZE + 8] = { 0 };
+    message_header_t wire = { htonl(MSG_GET_BOARD), htonl(sizeof(corrupt)), 0, htonl(HEADER_FLAG_CHECKSUM) };
+    uint32_t crc = htonl(checksum_crc32c(checksum_crc32c(0, &wire, sizeof(wire)), corrupt + FRAME_CHECKSUM_SIZE, 8));
+    memcpy(corrupt, &crc, sizeof(crc));
+    corrupt[FRAME_CHECKSUM_SIZE + 3] ^= 0x10;
+    assert(connection_send_frame(&a.conn, &wire, sizeof(wire), corrupt, sizeof(corrupt), 1000) == SUCCESS);
+    b.authenticated = true;
+    assert(session_recv_message_timeout(&b, &type, received, sizeof(received), &size, 1000, NULL, 0) ==
+           ERR_SERIALIZATION);
+    assert(!b.authenticated);
+
+    session_close(&a);
+    session_close(&b);
+}
+
+/* ========== Read Buffer Tests ========== */
+
+TEST(read_buffer_partial_frames) {
+    read_buffer_t* rb = read_buffer_create();
+    assert(rb != NULL);
+
+    msg_play_move_t move;
+    memset(&move, 0, sizeof(move));
+    move.game = GAME_HANDLE_MAKE(12, 7);
+    move.pit_index = 4;
+
+    char frame[MAX_MESSAGE_SIZE];
+    size_t frame_size;
+    assert(serialize_message_frame(MSG_PLAY_MOVE, 7, HEADER_FLAG_COMPACT, &move, sizeof(move),
+                                   frame, &frame_size) == SUCCESS);
+
+    /* A header split across reads, then a payload missing its last byte */
+    frame_view_t view;
+    assert(read_buffer_append(rb, frame, 10) == SUCCESS);
+    assert(read_buffer_next_frame(rb, &view) == ERR_TIMEOUT);
+    assert(read_buffer_append(rb, frame + 10, frame_size - 11) == SUCCESS);
+    assert(read_buffer_next_frame(rb, &view) == ERR_TIMEOUT);
+    assert(read_buffer_append(rb, frame + frame_size - 1, 1) == SUCCESS);
+
+    assert(read_buffer_next_frame(rb, &view) == SUCCESS);
+    assert(view.type == MSG_PLAY_MOVE);
+    assert(view.sequence == 7);
+    assert(view.flags == HEADER_FLAG_COMPACT);
+    assert(view.length == sizeof(move));
+    assert(memcmp(view.payload, &move, sizeof(move)) == 0);
+    assert(read_buffer_pending(rb) == 0);
+    assert(read_buffer_next_frame(rb, &view) == ERR_TIMEOUT);
+
+    read_buffer_destroy(rb);
+}
+
+TEST(read_buffer_wraps_ring) {
+    read_buffer_t* rb = read_buffer_create();
+    assert(rb != NULL);
+
+    static char payload[5000];
+    char frame[MAX_MESSAGE_SIZE];
+    size_t frame_size;
+
+    /* Frames of 5016 bytes eventually straddle the end of the ring */
+    uint32_t sent = 0, received = 0;
+    while (received < 40) {
+        while (sent < 40) {
+            memset(payload, (int)('a' + sent % 26), sizeof(payload));
+            assert(serialize_message_frame(MSG_CHAT_HISTORY, sent, 0, payload, sizeof(payload),
+                                           frame, &frame_size) == SUCCESS);
+            if (read_buffer_append(rb, frame, frame_size) != SUCCESS) break;
+            sent++;
+        }
+        frame_view_t view;
+        assert(read_buffer_next_frame(rb, &view) == SUCCESS);
+        assert(view.sequence == received);
+        assert(view.length == sizeof(payload));
+        assert(view.payload[0] == (char)('a' + received % 26));
+        assert(view.payload[view.length - 1] == (char)('a' + received % 26));
+        received++;
+    }
+
+    read_buffer_stats_t stats;
+    read_buffer_get_stats(rb, &stats);
+    assert(stats.frames == 40);
+    assert(stats.linearized > 0);
+    read_buffer_destroy(rb);
+}
+
+TEST(read_buffer_rejects_oversized) {
+    read_buffer_t* rb = read_buffer_create();
+    assert(rb != NULL);
+
+    message_header_t header;
+    header.type = htonl(MSG_PLAY_MOVE);
+    header.length = htonl(MAX_PAYLOAD_SIZE + 1);
+    header.sequence = 0;
+    header.reserved = 0;
+    assert(read_buffer_append(rb, &header, sizeof(header)) == SUCCESS);
+
+    frame_view_t view;
+    assert(read_buffer_next_frame(rb, &view) == ERR_SERIALIZATION);
+    assert(read_buffer_append(rb, NULL, 1) == ERR_INVALID_PARAM);
+    read_buffer_destroy(rb);
+}
+
+TEST(connection_recv_frame_batches_reads) {
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    /* Ten small frames already queued: one read picks them all up */
+    for (uint32_t i = 0; i < 10; i++) {
+        char frame[MAX_MESSAGE_SIZE];
+        size_t frame_size;
+        assert(serialize_message_frame(MSG_GET_BOARD, i + 1, 0, &i, sizeof(i), frame, &frame_size) == SUCCESS);
+        assert(write(fds[1], frame, frame_size) == (ssize_t)frame_size);
+    }
+
+    connection_t conn;
+    connection_init(&conn);
+    conn.socket_fd = fds[0];
+    conn.connected = true;
+
+    for (uint32_t i = 0; i < 10; i++) {
+        frame_view_t view;
+        assert(connection_recv_frame(&conn, &view, 1000) == SUCCESS);
+        assert(view.type == MSG_GET_BOARD && view.sequence == i + 1);
+    }
+    read_buffer_stats_t stats;
+    read_buffer_get_stats(conn.rx, &stats);
+    assert(stats.reads == 1 && stats.waits == 1 && stats.frames == 10);
+
+    /* Nothing left: a timed receive times out, then EOF closes the connection */
+    frame_view_t view;
+    assert(connection_recv_frame(&conn, &view, 50) == ERR_TIMEOUT);
+    close(fds[1]);
+    assert(connection_recv_frame(&conn, &view, 1000) == ERR_NETWORK_ERROR);
+    assert(!connection_is_connected(&conn));
+
+    connection_close(&conn);
+    assert(conn.rx == NULL);
+}
+
+/* ========== Write Queue Tests ========== */
+
+static void make_socket_session(session_t* session, int fd) {
+    session_init(session);
+    session->conn.socket_fd = fd;
+    session->conn.connected = true;
+    session->conn.tx = write_queue_create();
+    assert(session->conn.tx != NULL);
+}
+
+TEST(write_queue_direct_send) {
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    session_t sender, receiver;
+    make_socket_session(&sender, fds[0]);
+    make_socket_session(&receiver, fds[1]);
+
+    /* Uncorked: header and payload leave in a single sendmsg */
+    msg_play_move_t move;
+    memset(&move, 0, sizeof(move));
+    move.game = GAME_HANDLE_MAKE(12, 7);
+    move.pit_index = 3;
+    assert(session_send_notification(&sender, MSG_PLAY_MOVE, &move, sizeof(move)) == SUCCESS);
+
+    write_queue_stats_t stats;
+    write_queue_get_stats(sender.conn.tx, &stats);
+    assert(stats.frames == 1 && stats.queued == 0 && stats.sends == 1);
+    assert(stats.bytes == HEADER_SIZE + sizeof(move));
+
+    message_type_t type;
+    msg_play_move_t received;
+    size_t size;
+    assert(session_recv_message_timeout(&receiver, &type, &received, sizeof(received), &size, 1000, NULL, 0) == SUCCESS);
+    assert(type == MSG_PLAY_MOVE && size == sizeof(move));
+    assert(received.pit_index == 3 && received.game == GAME_HANDLE_MAKE(12, 7));
+
+    session_close(&sender);
+    session_close(&receiver);
+}
+
+TEST(write_queue_batch_coalesces) {
+    int fds_a[2], fds_b[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_a) == 0);
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_b) == 0);
+    session_t a, b, peer_a, peer_b;
+    make_socket_session(&a, fds_a[0]);
+    make_socket_session(&b, fds_b[0]);
+    make_socket_session(&peer_a, fds_a[1]);
+    make_socket_session(&peer_b, fds_b[1]);
+
+    /* One tick serving `a`: replies to it plus a push to another client */
+    session_batch_begin(&a);
+    for (uint32_t i = 0; i < 5; i++) {
+        assert(session_send_tagged(&a, MSG_GET_BOARD, i + 1, &i, sizeof(i)) == SUCCESS);
+    }
+    assert(session_send_notification(&b, MSG_GET_BOARD, NULL, 0) == SUCCESS);
+    assert(write_queue_pending(a.conn.tx) == 5 * (HEADER_SIZE + sizeof(uint32_t)));
+    /* `b` is another handler's session: never corked, so never held */
+    assert(write_queue_pending(b.conn.tx) == 0);
+    session_batch_flush();
+
+    write_queue_stats_t stats;
+    write_queue_get_stats(a.conn.tx, &stats);
+    assert(stats.frames == 5 && stats.queued == 5 && stats.flushes == 1 && stats.sends == 1);
+    assert(write_queue_pending(a.conn.tx) == 0 && write_queue_pending(b.conn.tx) == 0);
+
+    /* Frames arrive intact and in order */
+    for (uint32_t i = 0; i < 5; i++) {
+        message_type_t type;
+        uint32_t sequence, value;
+        size_t size;
+        assert(session_recv_tagged_timeout(&peer_a, &type, &sequence, &value, sizeof(value), &size, 1000) == SUCCESS);
+        assert(type == MSG_GET_BOARD && sequence == i + 1 && value == i);
+    }
+    message_type_t type;
+    size_t size;
+    assert(session_recv_message_timeout(&peer_b, &type, NULL, 0, &size, 1000, NULL, 0) == SUCCESS);
+    assert(type == MSG_GET_BOARD && size == 0);
+
+    /* Outside a batch sends go straight out again */
+    uint32_t value = 9;
+    assert(session_send_notification(&a, MSG_GET_BOARD, &value, sizeof(value)) == SUCCESS);
+    assert(write_queue_pending(a.conn.tx) == 0);
+
+    session_close(&a);
+    session_close(&b);
+    session_close(&peer_a);
+    session_close(&peer_b);
+}
+
+TEST(write_queue_flushes_when_full) {
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    int sndbuf = 256 * 1024;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &sndbuf, sizeof(sndbuf));
+    write_queue_t* wq = write_queue_create();
+    assert(wq != NULL);
+
+    static char payload[6000];
+    memset(payload, 'p', sizeof(payload));
+    char header[HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+
+    /* Six 6 KB frames overflow a 32 KB queue once */
+    write_queue_cork(wq);
+    for (int i = 0; i < 6; i++) {
+        assert(write_queue_send(wq, fds[0], header, sizeof(header), payload, sizeof(payload), 1000) == SUCCESS);
+    }
+    write_queue_stats_t stats;
+    write_queue_get_stats(wq, &stats);
+    assert(stats.flushes == 1);
+    assert(write_queue_pending(wq) == (HEADER_SIZE + sizeof(payload)));
+    assert(write_queue_uncork(wq, fds[0], 1000) == SUCCESS);
+    write_queue_get_stats(wq, &stats);
+    assert(stats.flushes == 2 && stats.bytes == 6 * (HEADER_SIZE + sizeof(payload)));
+
+    write_queue_destroy(wq);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(write_queue_keeps_frames_on_timeout) {
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    write_queue_t* wq = write_queue_create();
+    assert(wq != NULL);
+
+    /* Nobody reads fds[1]: fill the socket until it refuses more */
+    static char filler[4096];
+    memset(filler, 'f', sizeof(filler));
+    size_t filled = 0;
+    ssize_t n;
+    while ((n = send(fds[0], filler, sizeof(filler), MSG_DONTWAIT)) > 0) filled += (size_t)n;
+
+    char header[HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    uint32_t payload = 7;
+    write_queue_cork(wq);
+    assert(write_queue_send(wq, fds[0], header, sizeof(header), &payload, sizeof(payload), 1000) == SUCCESS);
+
+    /* Nothing went out, so the frame stays queued for the next flush */
+    assert(write_queue_uncork(wq, fds[0], 20) == ERR_TIMEOUT);
+    assert(write_queue_pending(wq) == HEADER_SIZE + sizeof(payload));
+
+    size_t drained = 0;
+    while (drained < filled && (n = recv(fds[1], filler, sizeof(filler), 0)) > 0) drained += (size_t)n;
+    assert(write_queue_uncork(wq, fds[0], 1000) == SUCCESS);
+    assert(write_queue_pending(wq) == 0);
+    char frame[HEADER_SIZE + sizeof(payload)];
+    assert(recv(fds[1], frame, sizeof(frame), MSG_WAITALL) == (ssize_t)sizeof(frame));
+
+    write_queue_destroy(wq);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/* ========== Event Backend Tests ========== */
+
+/* Wait until `want` bytes for fd arrived (or a CLOSED event when want is 0) */
+static size_t backend_collect(io_backend_t* io, int fd, read_buffer_t* rb, size_t want, bool* closed) {
+    size_t got = 0;
+    for (int round = 0; round < 50 && (want == 0 ? !*closed : got < want); round++) {
+        io_event_t events[16];
+        int count = 0;
+        assert(io_backend_wait(io, events, 16, 100, &count) == SUCCESS);
+        for (int i = 0; i < count; i++) {
+            assert(events[i].fd == fd);
+            if (events[i].type == IO_EVENT_CLOSED) {
+                *closed = true;
+            } else {
+                assert(events[i].type == IO_EVENT_DATA);
+                assert(read_buffer_append(rb, events[i].data, events[i].length) == SUCCESS);
+                got += events[i].length;
+            }
+        }
+    }
+    return got;
+}
+
+static void check_backend_echo(io_backend_kind_t kind) {
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    io_backend_t io;
+    assert(io_backend_init(&io, kind, -1) == SUCCESS);
+    assert(io_backend_watch(&io, fds[0]) == SUCCESS);
+
+    /* Three frames in one write */
+    char frames[3 * MAX_MESSAGE_SIZE];
+    size_t total = 0;
+    for (uint32_t i = 0; i < 3; i++) {
+        uint32_t value = htonl(i * 7);
+        size_t size;
+        assert(serialize_message_frame(MSG_GET_BOARD, i + 1, 0, &value, sizeof(value), frames + total, &size) == SUCCESS);
+        total += size;
+    }
+    assert(write(fds[1], frames, total) == (ssize_t)total);
+
+    read_buffer_t* rb = read_buffer_create();
+    bool closed = false;
+    assert(backend_collect(&io, fds[0], rb, total, &closed) == total);
+
+    /* Echo each frame back with its sequence; the backend keeps the order */
+    frame_view_t view;
+    int echoed = 0;
+    while (read_buffer_next_frame(rb, &view) == SUCCESS) {
+        message_header_t header = { htonl(view.type), htonl((uint32_t)view.length), htonl(view.sequence), 0 };
+        assert(io_backend_send(&io, fds[0], &header, sizeof(header), view.payload, view.length) == SUCCESS);
+        echoed++;
+    }
+    assert(echoed == 3);
+    int count = 0;
+    io_event_t events[4];
+    assert(io_backend_wait(&io, events, 4, 0, &count) == SUCCESS);
+
+    session_t peer;
+    make_socket_session(&peer, fds[1]);
+    for (uint32_t i = 0; i < 3; i++) {
+        message_type_t type;
+        uint32_t sequence, value;
+        size_t size;
+        assert(session_recv_tagged_timeout(&peer, &type, &sequence, &value, sizeof(value), &size, 1000) == SUCCESS);
+        assert(type == MSG_GET_BOARD && sequence == i + 1 && ntohl(value) == i * 7);
+    }
+
+    io_backend_stats_t stats = io.stats;
+    assert(stats.sends == 3 && stats.bytes_in == total && stats.bytes_out == total);
+
+    /* Hangup ends the watch */
+    session_close(&peer);
+    backend_collect(&io, fds[0], rb, 0, &closed);
+    assert(closed);
+
+    assert(io_backend_unwatch(&io, fds[0]) == SUCCESS);
+    close(fds[0]);
+    read_buffer_destroy(rb);
+    io_backend_destroy(&io);
+}
+
+TEST(io_backend_epoll_echo) {
+    check_backend_echo(IO_BACKEND_EPOLL);
+}
+
+TEST(io_backend_uring_echo) {
+    /* Falls back to epoll where io_uring is unavailable */
+    check_backend_echo(IO_BACKEND_URING);
+}
+
+TEST(io_backend_accept_and_oneshot) {
+    io_backend_kind_t kinds[] = { IO_BACKEND_EPOLL, IO_BACKEND_URING };
+    for (int k = 0; k < 2; k++) {
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        assert(bind(listener, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+        assert(listen(listener, 8) == 0);
+        assert(getsockname(listener, (struct sockaddr*)&addr, &len) == 0);
+
+        io_backend_t io;
+        assert(io_backend_init(&io, kinds[k], listener) == SUCCESS);
+
+        int clients[2];
+        for (int i = 0; i < 2; i++) {
+            clients[i] = socket(AF_INET, SOCK_STREAM, 0);
+            assert(connect(clients[i], (struct sockaddr*)&addr, sizeof(addr)) == 0);
+        }
+        int accepted[2];
+        int accepted_count = 0;
+        for (int round = 0; round < 50 && accepted_count < 2; round++) {
+            io_event_t events[4];
+            int count = 0;
+            assert(io_backend_wait(&io, events, 4, 100, &count) == SUCCESS);
+            for (int i = 0; i < count; i++) {
+                assert(events[i].type == IO_EVENT_ACCEPT);
+                accepted[accepted_count++] = events[i].fd;
+            }
+        }
+        assert(accepted_count == 2 && io.stats.accepts == 2);
+
+        /* One-shot receive: one DATA event, then nothing until re-armed */
+        assert(io_backend_recv(&io, accepted[0]) == SUCCESS);
+        assert(write(clients[0], "abc", 3) == 3);
+        read_buffer_t* rb = read_buffer_create();
+        bool closed = false;
+        assert(backend_collect(&io, accepted[0], rb, 3, &closed) == 3);
+        assert(write(clients[0], "de", 2) == 2);
+        io_event_t events[4];
+        int count = 0;
+        assert(io_backend_wait(&io, events, 4, 50, &count) == SUCCESS && count == 0);
+        assert(io_backend_recv(&io, accepted[0]) == SUCCESS);
+        assert(backend_collect(&io, accepted[0], rb, 2, &closed) == 2);
+        assert(read_buffer_pending(rb) == 5);
+
+        for (int i = 0; i < 2; i++) {
+            io_backend_unwatch(&io, accepted[i]);
+            close(accepted[i]);
+            close(clients[i]);
+        }
+        read_buffer_destroy(rb);
+        io_backend_destroy(&io);
+        close(listener);
+    }
+}
+
+/* ========== Transport Tests ========== */
+
+/* Tagged frames both ways, one direction corked */
+static void check_session_round_trip(session_t* a, session_t* b) {
+    char payload[MAX_PAYLOAD_SIZE];
+    message_type_t type;
+    uint32_t sequence;
+    size_t size;
+
+    assert(session_send_tagged(a, MSG_GET_BOARD, 7, "ping", 4) == SUCCESS);
+    assert(session_recv_tagged_timeout(b, &type, &sequence, payload, sizeof(payload), &size, 1000) == SUCCESS);
+    assert(type == MSG_GET_BOARD && sequence == 7 && size == 4 && memcmp(payload, "ping", 4) == 0);
+
+    connection_cork(&b->conn);
+    for (uint32_t i = 0; i < 3; i++) {
+        assert(session_send_tagged(b, MSG_GET_BOARD, 100 + i, &i, sizeof(i)) == SUCCESS);
+    }
+    assert(write_queue_pending(b->conn.tx) > 0);
+    assert(connection_uncork(&b->conn, 1000) == SUCCESS);
+    for (uint32_t i = 0; i < 3; i++) {
+        uint32_t value;
+        assert(session_recv_tagged_timeout(a, &type, &sequence, &value, sizeof(value), &size, 1000) == SUCCESS);
+        assert(sequence == 100 + i && value == i);
+    }
+}
+
+TEST(loopback_session_round_trip) {
+    session_t a, b;
+    session_init(&a);
+    session_init(&b);
+    assert(connection_loopback_pair(&a.conn, &b.conn) == SUCCESS);
+    assert(connection_is_connected(&a.conn) && a.conn.socket_fd < 0);
+    assert(strcmp(connection_transport(&a.conn)->name, "loopback") == 0);
+    assert(strcmp(connection_get_peer_ip(&b.conn), "loopback") == 0);
+
+    check_session_round_trip(&a, &b);
+
+    /* Nothing pending: a timed receive times out */
+    char payload[16];
+    message_type_t type;
+    uint32_t sequence;
+    size_t size;
+    assert(session_recv_tagged_timeout(&a, &type, &sequence, payload, sizeof(payload), &size, 20) == ERR_TIMEOUT);
+
+    /* Frames sent before a close are still delivered, then EOF */
+    assert(session_send_tagged(&b, MSG_GET_BOARD, 9, "bye", 3) == SUCCESS);
+    session_close(&b);
+    assert(session_recv_tagged_timeout(&a, &type, &sequence, payload, sizeof(payload), &size, 1000) == SUCCESS);
+    assert(sequence == 9);
+    assert(session_recv_tagged_timeout(&a, &type, &sequence, payload, sizeof(payload), &size, 1000) == ERR_NETWORK_ERROR);
+    assert(connection_check_alive(&a.conn) == ERR_NETWORK_ERROR);
+    session_close(&a);
+}
+
+TEST(loopback_backpressure) {
+    connection_t a, b;
+    assert(connection_loopback_pair(&a, &b) == SUCCESS);
+
+    /* Fill a's outbound ring; one more frame cannot go out in time */
+    static char payload[MAX_PAYLOAD_SIZE];
+    message_header_t header = { htonl(MSG_GET_BOARD), htonl(sizeof(payload)), 0, 0 };
+    size_t frame_size = sizeof(header) + sizeof(payload);
+    for (size_t sent = 0; sent + frame_size <= LOOPBACK_CAPACITY; sent += frame_size) {
+        assert(connection_send_frame(&a, &header, sizeof(header), payload, sizeof(payload), 0) == SUCCESS);
+    }
+    assert(connection_send_frame(&a, &header, sizeof(header), payload, sizeof(payload), 20) == ERR_TIMEOUT);
+
+    /* Draining on the other end makes room again */
+    frame_view_t view;
+    assert(connection_recv_frame(&b, &view, 1000) == SUCCESS && view.length == sizeof(payload));
+    connection_close(&a);
+    connection_close(&b);
+}
+
+TEST(loopback_torn_write_closes) {
+    connection_t a, b;
+    assert(connection_loopback_pair(&a, &b) == SUCCESS);
+
+    /* A bare header first, so the ring ends up with less room than a frame */
+    message_header_t ping = { htonl(MSG_GET_BOARD), 0, 0, 0 };
+    assert(connection_send_frame(&a, &ping, sizeof(ping), NULL, 0, 0) == SUCCESS);
+    static char payload[MAX_PAYLOAD_SIZE];
+    message_header_t header = { htonl(MSG_GET_BOARD), htonl(sizeof(payload)), 0, 0 };
+    size_t frame_size = sizeof(header) + sizeof(payload);
+    int frames = 1;
+    for (size_t sent = sizeof(ping); sent + frame_size <= LOOPBACK_CAPACITY; sent += frame_size) {
+        assert(connection_send_frame(&a, &header, sizeof(header), payload, sizeof(payload), 0) == SUCCESS);
+        frames++;
+    }
+
+    /* Part of the next frame fits: the stream is torn, so it is shut */
+    assert(connection_send_frame(&a, &header, sizeof(header), payload, sizeof(payload), 20) == ERR_NETWORK_ERROR);
+    assert(connection_check_alive(&a) == ERR_NETWORK_ERROR);
+
+    /* The peer gets every whole frame, then EOF instead of the torn one */
+    frame_view_t view;
+    for (int i = 0; i < frames; i++) {
+        assert(connection_recv_frame(&b, &view, 1000) == SUCCESS);
+    }
+    assert(connection_recv_frame(&b, &view, 1000) == ERR_NETWORK_ERROR);
+    connection_close(&a);
+    connection_close(&b);
+}
+
+TEST(unix_socket_session_round_trip) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/awale_test_%d.sock", (int)getpid());
+
+    connection_t server;
+    connection_init(&server);
+    assert(connection_create_unix_server(&server, path) == SUCCESS);
+
+    /* Accepted through the event backend, like the server does */
+    io_backend_t io;
+    assert(io_backend_init(&io, IO_BACKEND_EPOLL, -1) == SUCCESS);
+    assert(io_backend_listen(&io, server.socket_fd) == SUCCESS);
+
+    session_t client, peer;
+    session_init(&client);
+    session_init(&peer);
+    assert(connection_connect_unix(&client.conn, path) == SUCCESS);
+
+    io_event_t events[4];
+    int count = 0;
+    assert(io_backend_wait(&io, events, 4, 1000, &count) == SUCCESS);
+    assert(count == 1 && events[0].type == IO_EVENT_ACCEPT);
+    assert(connection_adopt(&peer.conn, events[0].fd) == SUCCESS);
+    assert(connection_transport(&peer.conn) == &transport_unix);
+    assert(strcmp(connection_get_peer_ip(&peer.conn), "local") == 0);
+
+    check_session_round_trip(&client, &peer);
+
+    session_close(&client);
+    session_close(&peer);
+    io_backend_destroy(&io);
+    connection_close(&server);
+    unlink(path);
+}
+
+/* A chat push carrying `n`, as the server would send it */
+static void send_numbered_notification(session_t* session, int n) {
+    msg_chat_message_t chat;
+    memset(&chat, 0, sizeof(chat));
+    snprintf(chat.message, sizeof(chat.message), "n%d", n);
+    assert(session_send_notification(session, MSG_CHAT_MESSAGE, &chat, sizeof(chat)) == SUCCESS);
+}
+
+static int recv_numbered_notification(session_t* session) {
+    msg_chat_message_t chat;
+    message_type_t type;
+    uint32_t sequence;
+    size_t size;
+    assert(session_recv_tagged_timeout(session, &type, &sequence, &chat, sizeof(chat), &size, 1000) == SUCCESS);
+    assert(type == MSG_CHAT_MESSAGE && sequence == 0);
+    return atoi(chat.message + 1);
+}
+
+/* Drop the client's connection and open a new one; `fresh` is its server end */
+static void reconnect_client(connection_t* listener, const char* path, session_t* client, connection_t* fresh) {
+    session_close(client);
+    session_init(client);
+    assert(connection_connect_unix(&client->conn, path) == SUCCESS);
+    connection_init(fresh);
+    assert(connection_accept(listener, fresh) == SUCCESS);
+}
+
+static msg_resume_ack_t recv_resume_ack(session_t* client) {
+    msg_resume_ack_t ack;
+    message_type_t type;
+    size_t size;
+    memset(&ack, 0, sizeof(ack));
+    assert(session_recv_message_timeout(client, &type, &ack, sizeof(ack), &size, 1000, NULL, 0) == SUCCESS);
+    assert(type == MSG_RESUME_ACK && ack.success);
+    return ack;
+}
+
+TEST(session_resume_replays_backlog) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/awale_resume_%d.sock", (int)getpid());
+    connection_t listener;
+    connection_init(&listener);
+    assert(connection_create_unix_server(&listener, path) == SUCCESS);
+
+    session_t client, server;
+    session_init(&client);
+    session_init(&server);
+    assert(connection_connect_unix(&client.conn, path) == SUCCESS);
+    assert(connection_accept(&listener, &server.conn) == SUCCESS);
+    server.backlog = session_backlog_create();
+    int server_fd = server.conn.socket_fd;
+
+    /* Three pushes and a tagged reply; the client reads only the first push */
+    for (int i = 0; i < 3; i++) send_numbered_notification(&server, i);
+    assert(session_send_tagged(&server, MSG_PLAYER_LIST, 7, NULL, 0) == SUCCESS);
+    assert(recv_numbered_notification(&client) == 0);
+
+    connection_t fresh;
+    reconnect_client(&listener, path, &client, &fresh);
+    assert(session_resume(&server, &fresh, 1) == SUCCESS);
+    assert(server.conn.socket_fd == server_fd);
+
+    /* The two missed pushes follow the ack; replies are not replayed */
+    msg_resume_ack_t ack = recv_resume_ack(&client);
+    assert(ack.complete && ack.replayed == 2 && ack.notifications_sent == 3);
+    assert(recv_numbered_notification(&client) == 1);
+    assert(recv_numbered_notification(&client) == 2);
+
+    /* Later sends use the new socket under the old fd number */
+    send_numbered_notification(&server, 3);
+    assert(recv_numbered_notification(&client) == 3);
+
+    /* Resuming from before what the ring still holds replays what it has */
+    for (int i = 4; i < 4 + SESSION_BACKLOG_FRAMES; i++) {
+        send_numbered_notification(&server, i);
+        assert(recv_numbered_notification(&client) == i);
+    }
+    reconnect_client(&listener, path, &client, &fresh);
+    assert(session_resume(&server, &fresh, 0) == SUCCESS);
+    ack = recv_resume_ack(&client);
+    assert(!ack.complete && ack.replayed == SESSION_BACKLOG_FRAMES);
+    assert(ack.notifications_sent == 4 + SESSION_BACKLOG_FRAMES);
+    assert(recv_numbered_notification(&client) == 4);
+
+    session_close(&client);
+    session_close(&server);
+    session_backlog_destroy(server.backlog);
+    connection_close(&listener);
+    unlink(path);
+}
+
 /* ========== Main Test Runner ========== */
 
 int main() {
@@ -400,6 +1618,7 @@ int main() {
     RUN_TEST(serialize_bool);
     RUN_TEST(serialize_message_header);
     RUN_TEST(serialize_full_message);
+    RUN_TEST(serialize_tagged_message);
     RUN_TEST(message_size_calculation);
     
     /* Connection tests */
@@ -407,10 +1626,11 @@ int main() {
     RUN_TEST(connection_init);
     RUN_TEST(connection_is_connected);
     
-    /* Select tests */
-    printf("\nSelect Context Tests:\n");
-    RUN_TEST(select_context_init);
-    RUN_TEST(select_context_add_fd);
+    /* Poll tests */
+    printf("\nPoll Context Tests:\n");
+    RUN_TEST(poll_context_init);
+    RUN_TEST(poll_context_add_fd);
+    RUN_TEST(poll_context_beyond_fd_setsize);
     
     /* Protocol tests */
     printf("\nProtocol Tests:\n");
@@ -432,13 +1652,67 @@ int main() {
     printf("\nError Handling Tests:\n");
     RUN_TEST(protocol_error_handling);
     RUN_TEST(connection_error_states);
-    RUN_TEST(select_context_edge_cases);
+    RUN_TEST(poll_context_edge_cases);
     RUN_TEST(serialization_edge_cases);
 
     /* Freeze prevention tests */
     printf("\nFreeze Prevention Tests:\n");
     RUN_TEST(session_timeout_behavior);
     RUN_TEST(notification_listener_error_recovery);
+
+    /* Board delta tests */
+    printf("\nBoard Delta Tests:\n");
+    RUN_TEST(board_delta_changed_pits_only);
+    RUN_TEST(board_delta_keyframe_interval);
+    RUN_TEST(board_delta_apply_sequence);
+    RUN_TEST(board_delta_wire_size);
+
+    /* Compact codec tests */
+    printf("\nCompact Codec Tests:\n");
+    RUN_TEST(varint_round_trip);
+    RUN_TEST(lstring_round_trip);
+    RUN_TEST(codec_round_trip);
+    RUN_TEST(codec_rejects_malformed);
+    RUN_TEST(codec_version_negotiation);
+
+    /* Compression tests */
+    printf("\nCompression Tests:\n");
+    RUN_TEST(compression_round_trip);
+    RUN_TEST(compression_hot_path_excluded);
+    RUN_TEST(compression_rejects_malformed);
+
+    /* Checksum tests */
+    printf("\nChecksum Tests:\n");
+    RUN_TEST(crc32c_matches_portable);
+    RUN_TEST(checksum_frames);
+
+    /* Read buffer tests */
+    printf("\nRead Buffer Tests:\n");
+    RUN_TEST(read_buffer_partial_frames);
+    RUN_TEST(read_buffer_wraps_ring);
+    RUN_TEST(read_buffer_rejects_oversized);
+    RUN_TEST(connection_recv_frame_batches_reads);
+
+    /* Write queue tests */
+    printf("\nWrite Queue Tests:\n");
+    RUN_TEST(write_queue_direct_send);
+    RUN_TEST(write_queue_batch_coalesces);
+    RUN_TEST(write_queue_flushes_when_full);
+    RUN_TEST(write_queue_keeps_frames_on_timeout);
+
+    /* Event backend tests */
+    printf("\nEvent Backend Tests:\n");
+    RUN_TEST(io_backend_epoll_echo);
+    RUN_TEST(io_backend_uring_echo);
+    RUN_TEST(io_backend_accept_and_oneshot);
+
+    /* Transport tests */
+    printf("\nTransport Tests:\n");
+    RUN_TEST(loopback_session_round_trip);
+    RUN_TEST(loopback_backpressure);
+    RUN_TEST(loopback_torn_write_closes);
+    RUN_TEST(unix_socket_session_round_trip);
+    RUN_TEST(session_resume_replays_backlog);
     
     printf("\n");
     printf("═══════════════════════════════════════════════════════\n");
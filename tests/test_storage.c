@@ -5,10 +5,21 @@
 #include "server/storage.h"
 #include "server/game_manager.h"
 #include "server/matchmaking.h"
+#include "server/server_connection.h"
+#include "server/server_handlers.h"
+#include "server/server_registry.h"
+#include "server/resume_token.h"
+#include "server/player_store.h"
+#include "server/game_catalog.h"
+#include "server/admission.h"
+#include "game/rules.h"
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
+#include <zlib.h>
  #include <stdlib.h>
 
 /* Test utilities */
@@ -55,8 +66,8 @@ TEST(game_save_load) {
     game_instance_t game;
     memset(&game, 0, sizeof(game));
     snprintf(game.game_id, MAX_GAME_ID_LEN, "test-game-123");
-    snprintf(game.player_a, MAX_PSEUDO_LEN, "Alice");
-    snprintf(game.player_b, MAX_PSEUDO_LEN, "Bob");
+    game.player_a = pseudo_intern("Alice");
+    game.player_b = pseudo_intern("Bob");
     game.active = true;
 
     /* Initialize board */
@@ -73,21 +84,23 @@ TEST(game_save_load) {
     }
 
     /* Load game */
+    char key[MAX_GAME_ID_LEN];
+    storage_game_key(game.game_id, game.log_id, key);
     game_instance_t loaded_game;
-    err = storage_load_game("test-game-123", &loaded_game);
+    err = storage_load_game(key, &loaded_game);
     assert(err == SUCCESS);
 
     /* Verify data */
     assert(strcmp(loaded_game.game_id, "test-game-123") == 0);
-    assert(strcmp(loaded_game.player_a, "Alice") == 0);
-    assert(strcmp(loaded_game.player_b, "Bob") == 0);
+    assert(strcmp(pseudo_name(loaded_game.player_a), "Alice") == 0);
+    assert(strcmp(pseudo_name(loaded_game.player_b), "Bob") == 0);
     assert(loaded_game.active == true);
     assert(loaded_game.board.scores[PLAYER_A] == 15);
     assert(loaded_game.board.scores[PLAYER_B] == 12);
     assert(loaded_game.board.current_player == PLAYER_B);
 
     /* Clean up */
-    storage_delete_game("test-game-123");
+    storage_delete_game(key);
     storage_cleanup();
 }
 
@@ -98,8 +111,8 @@ TEST(game_delete) {
     game_instance_t game;
     memset(&game, 0, sizeof(game));
     snprintf(game.game_id, MAX_GAME_ID_LEN, "delete-test");
-    snprintf(game.player_a, MAX_PSEUDO_LEN, "Player1");
-    snprintf(game.player_b, MAX_PSEUDO_LEN, "Player2");
+    game.player_a = pseudo_intern("Player1");
+    game.player_b = pseudo_intern("Player2");
     game.active = true;
     board_init(&game.board);
 
@@ -108,16 +121,18 @@ TEST(game_delete) {
 
     /* Verify file exists */
     bool exists = false;
-    err = storage_file_exists("./data/games.dat", &exists);
+    err = storage_file_exists("./data/games/00000001.seg", &exists);
     assert(err == SUCCESS);
     assert(exists == true);
 
     /* Delete game */
-    err = storage_delete_game("delete-test");
+    char key[MAX_GAME_ID_LEN];
+    storage_game_key(game.game_id, game.log_id, key);
+    err = storage_delete_game(key);
     assert(err == SUCCESS);
 
     /* Verify game file still exists but game is gone */
-    err = storage_load_game("delete-test", &game);
+    err = storage_load_game(key, &game);
     assert(err != SUCCESS); /* Should fail to load deleted game */
 
     storage_cleanup();
@@ -132,15 +147,15 @@ TEST(player_save_load) {
     matchmaking_init(&mm);
 
     /* Add test players */
-    error_code_t err = matchmaking_add_player(&mm, "TestPlayer1", "192.168.1.1");
+    error_code_t err = matchmaking_add_player(&mm, pseudo_intern("TestPlayer1"), "192.168.1.1");
     assert(err == SUCCESS);
-    err = matchmaking_add_player(&mm, "TestPlayer2", "192.168.1.2");
+    err = matchmaking_add_player(&mm, pseudo_intern("TestPlayer2"), "192.168.1.2");
     assert(err == SUCCESS);
 
     /* Update player stats */
-    err = matchmaking_update_player_stats(&mm, "TestPlayer1", true, 25);
+    err = matchmaking_update_player_stats(&mm, pseudo_intern("TestPlayer1"), true, 25);
     assert(err == SUCCESS);
-    err = matchmaking_update_player_stats(&mm, "TestPlayer2", false, 18);
+    err = matchmaking_update_player_stats(&mm, pseudo_intern("TestPlayer2"), false, 18);
     assert(err == SUCCESS);
 
     /* Save players */
@@ -156,15 +171,15 @@ TEST(player_save_load) {
     assert(err == SUCCESS);
 
     /* Verify loaded data */
-    player_info_t info;
-    err = matchmaking_get_player_stats(&mm2, "TestPlayer1", &info);
+    player_entry_t info;
+    err = matchmaking_get_player_stats(&mm2, pseudo_intern("TestPlayer1"), &info);
     assert(err == SUCCESS);
     assert(info.games_played == 1);
     assert(info.games_won == 1);
     assert(info.games_lost == 0);
     assert(info.total_score == 25);
 
-    err = matchmaking_get_player_stats(&mm2, "TestPlayer2", &info);
+    err = matchmaking_get_player_stats(&mm2, pseudo_intern("TestPlayer2"), &info);
     assert(err == SUCCESS);
     assert(info.games_played == 1);
     assert(info.games_won == 0);
@@ -183,8 +198,8 @@ TEST(data_integrity_crc) {
     game_instance_t game;
     memset(&game, 0, sizeof(game));
     snprintf(game.game_id, MAX_GAME_ID_LEN, "crc-test");
-    snprintf(game.player_a, MAX_PSEUDO_LEN, "CRCPlayer");
-    snprintf(game.player_b, MAX_PSEUDO_LEN, "CRCPlayer2");
+    game.player_a = pseudo_intern("CRCPlayer");
+    game.player_b = pseudo_intern("CRCPlayer2");
     game.active = true;
     board_init(&game.board);
 
@@ -192,18 +207,21 @@ TEST(data_integrity_crc) {
     error_code_t err = storage_save_game(&game);
     assert(err == SUCCESS);
 
-    /* Manually corrupt the file */
-    FILE* f = fopen("./data/games.dat", "r+b");
+    /* Manually corrupt the snapshot just written, at the end of the log */
+    assert(storage_flush_games() == SUCCESS);
+    FILE* f = fopen("./data/games/00000001.seg", "r+b");
     if (f) {
-        fseek(f, 10, SEEK_SET); /* Skip header */
+        fseek(f, -5, SEEK_END);
         uint8_t bad_byte = 0xFF;
         fwrite(&bad_byte, 1, 1, f);
         fclose(f);
     }
 
     /* Try to load - should fail due to CRC mismatch */
+    char key[MAX_GAME_ID_LEN];
+    storage_game_key(game.game_id, game.log_id, key);
     game_instance_t loaded_game;
-    err = storage_load_game("crc-test", &loaded_game);
+    err = storage_load_game(key, &loaded_game);
     assert(err != SUCCESS); /* Should fail due to corruption */
 
     storage_cleanup();
@@ -217,18 +235,18 @@ TEST(player_bio_functionality) {
     matchmaking_init(&mm);
 
     /* Add player */
-    error_code_t err = matchmaking_add_player(&mm, "BioTestPlayer", "127.0.0.1");
+    error_code_t err = matchmaking_add_player(&mm, pseudo_intern("BioTestPlayer"), "127.0.0.1");
     assert(err == SUCCESS);
 
     /* Set bio via matchmaking API */
     {
         const char bio_lines[2][256] = {"This is line 1 of my bio","This is line 2 of my bio"};
-        err = matchmaking_set_player_bio(&mm, "BioTestPlayer", bio_lines, 2);
+        err = matchmaking_set_player_bio(&mm, pseudo_intern("BioTestPlayer"), bio_lines, 2);
         assert(err == SUCCESS);
     }
 
     /* Update stats (this will trigger save) */
-    err = matchmaking_update_player_stats(&mm, "BioTestPlayer", true, 10);
+    err = matchmaking_update_player_stats(&mm, pseudo_intern("BioTestPlayer"), true, 10);
     assert(err == SUCCESS);
 
     /* Save and reload (redundant but explicit) */
@@ -241,19 +259,1281 @@ TEST(player_bio_functionality) {
     err = storage_load_players(&mm2);
     assert(err == SUCCESS);
 
-    /* Verify bio was preserved */
-    player_info_t info;
-    err = matchmaking_get_player_stats(&mm2, "BioTestPlayer", &info);
+    /* Verify bio was preserved; loading left it on disk until asked for */
+    assert(mm2.profiles[matchmaking_get_player_index(&mm2, pseudo_intern("BioTestPlayer"))] == NULL);
+    char bio[10][256];
+    int lines = 0;
+    err = matchmaking_get_player_bio(&mm2, pseudo_intern("BioTestPlayer"), bio, &lines);
     assert(err == SUCCESS);
-    assert(info.bio_lines == 2);
-    assert(strcmp(info.bio[0], "This is line 1 of my bio") == 0);
-    assert(strcmp(info.bio[1], "This is line 2 of my bio") == 0);
+    assert(lines == 2);
+    assert(strcmp(bio[0], "This is line 1 of my bio") == 0);
+    assert(strcmp(bio[1], "This is line 2 of my bio") == 0);
+
+    /* A stats update on a player whose profile was never loaded keeps it */
+    matchmaking_t mm3;
+    memset(&mm3, 0, sizeof(mm3));
+    matchmaking_init(&mm3);
+    err = matchmaking_update_player_stats(&mm3, pseudo_intern("BioTestPlayer"), false, 3);
+    assert(err == SUCCESS);
+    matchmaking_destroy(&mm3);
+    memset(&mm3, 0, sizeof(mm3));
+    matchmaking_init(&mm3);
+    player_entry_t info;
+    assert(matchmaking_get_player_stats(&mm3, pseudo_intern("BioTestPlayer"), &info) == SUCCESS);
+    assert(info.games_played == 2 && info.total_score == 13);
+    assert(matchmaking_get_player_bio(&mm3, pseudo_intern("BioTestPlayer"), bio, &lines) == SUCCESS && lines == 2);
+    matchmaking_destroy(&mm3);
 
     matchmaking_destroy(&mm);
     matchmaking_destroy(&mm2);
     storage_cleanup();
 }
 
+TEST(paged_player_listing) {
+    storage_init();
+
+    matchmaking_t mm;
+    memset(&mm, 0, sizeof(mm));
+    matchmaking_init(&mm);
+
+    char pseudo[MAX_PSEUDO_LEN];
+    for (int i = 0; i < 60; i++) {
+        snprintf(pseudo, sizeof(pseudo), "pager%02d", i);
+        assert(matchmaking_add_player(&mm, pseudo_intern(pseudo), "127.0.0.1") == SUCCESS);
+    }
+    for (int i = 0; i < 60; i += 3) {
+        snprintf(pseudo, sizeof(pseudo), "pager%02d", i);
+        matchmaking_remove_player(&mm, pseudo_intern(pseudo));
+    }
+
+    /* A connected pseudo cannot be added a second time; one that left can */
+    assert(matchmaking_add_player(&mm, pseudo_intern("pager01"), "127.0.0.1") == ERR_DUPLICATE);
+    assert(matchmaking_add_player(&mm, pseudo_intern("pager03"), "127.0.0.1") == SUCCESS);
+    matchmaking_remove_player(&mm, pseudo_intern("pager03"));
+
+    /* Walk in pages of 7; players leaving mid-walk do not shift the cursor */
+    player_list_item_t items[7];
+    bool seen[60] = {false};
+    uint32_t cursor = 0;
+    int total = 0, pages = 0;
+    do {
+        int count;
+        uint32_t next;
+        assert(matchmaking_list_players(&mm, cursor, items, 7, &count, &next) == SUCCESS);
+        assert(count <= 7);
+        assert(next == 0 || count == 7);
+        for (int i = 0; i < count; i++) {
+            int index = atoi(items[i].pseudo + 5);
+            assert(index % 3 != 0);
+            assert(!seen[index]);
+            seen[index] = true;
+        }
+        total += count;
+        cursor = next;
+        if (pages++ == 2) {
+            matchmaking_remove_player(&mm, pseudo_intern("pager01"));  /* Already listed */
+        }
+    } while (cursor != 0);
+    assert(total == 40);
+
+    int count;
+    uint32_t next;
+    assert(matchmaking_list_players(&mm, 1000, items, 7, &count, &next) == SUCCESS);
+    assert(count == 0 && next == 0);
+    assert(matchmaking_list_players(&mm, 0, items, 0, &count, &next) == ERR_INVALID_PARAM);
+
+    matchmaking_destroy(&mm);
+    storage_cleanup();
+}
+
+TEST(paged_saved_game_listing) {
+    storage_init();
+
+    game_instance_t game;
+    char keys[5][MAX_GAME_ID_LEN];
+    for (int i = 0; i < 5; i++) {
+        memset(&game, 0, sizeof(game));
+        snprintf(game.game_id, MAX_GAME_ID_LEN, "paged-%d", i);
+        game.player_a = pseudo_intern(i % 2 ? "PageCarol" : "PageDave");
+        game.player_b = pseudo_intern("PageErin");
+        board_init(&game.board);
+        assert(storage_save_game(&game) == SUCCESS);
+        storage_game_key(game.game_id, game.log_id, keys[i]);
+    }
+
+    /* One entry per page with a filter: every match shows up exactly once */
+    game_info_t info;
+    game_log_id_t cursor = 0;
+    int carol = 0, erin = 0;
+    do {
+        int count;
+        assert(storage_list_saved_games_page("PageCarol", cursor, &info, 1, &count, &cursor) == SUCCESS);
+        if (count == 1) {
+            assert(strcmp(info.player_a, "PageCarol") == 0);
+            carol++;
+        }
+    } while (cursor != 0);
+    assert(carol == 2);
+
+    do {
+        int count;
+        assert(storage_list_saved_games_page("PageErin", cursor, &info, 1, &count, &cursor) == SUCCESS);
+        erin += count;
+    } while (cursor != 0);
+    assert(erin == 5);
+
+    for (int i = 0; i < 5; i++) {
+        storage_delete_game(keys[i]);
+    }
+    storage_cleanup();
+}
+
+/* Moves are appended as they are played and replayed on load; reopening
+ * rebuilds the index and cuts off a torn record at the end */
+TEST(game_log_append_replay) {
+    storage_init();
+
+    game_instance_t game;
+    memset(&game, 0, sizeof(game));
+    snprintf(game.game_id, MAX_GAME_ID_LEN, "log-test");
+    game.player_a = pseudo_intern("LogAlice");
+    game.player_b = pseudo_intern("LogBob");
+    board_init(&game.board);
+    assert(storage_start_game(&game) == SUCCESS);
+    assert(game.log_id != GAME_LOG_ID_NONE);
+
+    int moves[] = { 2, 8, 4, 10, 0, 7 };
+    for (size_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        int captured;
+        assert(board_execute_move(&game.board, game.board.current_player, moves[i], &captured) == SUCCESS);
+        assert(storage_record_move(&game, moves[i]) == SUCCESS);
+    }
+
+    char key[MAX_GAME_ID_LEN];
+    storage_game_key(game.game_id, game.log_id, key);
+    game_instance_t loaded;
+    assert(storage_load_game(key, &loaded) == SUCCESS);
+    assert(strcmp(loaded.game_id, "log-test") == 0);
+    assert(memcmp(loaded.board.pits, game.board.pits, sizeof(game.board.pits)) == 0);
+    assert(loaded.board.scores[PLAYER_A] == game.board.scores[PLAYER_A]);
+    assert(loaded.board.scores[PLAYER_B] == game.board.scores[PLAYER_B]);
+    assert(loaded.board.current_player == game.board.current_player);
+    assert(loaded.move_seq == 6);
+    pthread_mutex_destroy(&loaded.lock);
+
+    /* Half a record at the end, as if the server died mid-append */
+    assert(storage_flush_games() == SUCCESS);
+    FILE* f = fopen("./data/games/00000001.seg", "ab");
+    assert(f);
+    uint8_t torn[10] = { 0xAB };
+    fwrite(torn, 1, sizeof(torn), f);
+    fclose(f);
+
+    storage_cleanup();
+    storage_init();
+    assert(storage_load_game(key, &loaded) == SUCCESS);
+    assert(memcmp(loaded.board.pits, game.board.pits, sizeof(game.board.pits)) == 0);
+    pthread_mutex_destroy(&loaded.lock);
+
+    /* Appends continue after the cut */
+    int captured;
+    int pit = game.board.current_player == PLAYER_A ? 1 : 7;
+    assert(board_execute_move(&game.board, game.board.current_player, pit, &captured) == SUCCESS);
+    assert(storage_record_move(&game, pit) == SUCCESS);
+    assert(storage_load_game(key, &loaded) == SUCCESS);
+    assert(loaded.move_seq == 7);
+    assert(memcmp(loaded.board.pits, game.board.pits, sizeof(game.board.pits)) == 0);
+    pthread_mutex_destroy(&loaded.lock);
+
+    storage_delete_game(key);
+    storage_cleanup();
+}
+
+/* Threads appending under each sync policy: every record reaches the disk,
+ * and with GAME_LOG_SYNC_EVERY concurrent appends share commits */
+#define SYNC_TEST_THREADS 4
+#define SYNC_TEST_MOVES 200
+
+static void* sync_test_appender(void* arg) {
+    game_log_id_t id = *(game_log_id_t*)arg;
+    board_t board;
+    board_init(&board);
+    for (int i = 0; i < SYNC_TEST_MOVES; i++) {
+        assert(game_log_append_move(id, i % NUM_PITS, &board) == SUCCESS);
+    }
+    return NULL;
+}
+
+TEST(game_log_sync_policies) {
+    game_log_sync_t policies[] = { GAME_LOG_SYNC_EVERY, GAME_LOG_SYNC_INTERVAL, GAME_LOG_SYNC_NONE };
+    pseudo_id_t a = pseudo_intern("SyncA"), b = pseudo_intern("SyncB");
+
+    for (int p = 0; p < 3; p++) {
+        game_log_set_sync(policies[p], 5);
+        storage_init();
+
+        game_log_id_t ids[SYNC_TEST_THREADS];
+        pthread_t threads[SYNC_TEST_THREADS];
+        for (int i = 0; i < SYNC_TEST_THREADS; i++) {
+            assert(game_log_start(a, b, "sync-test", time(NULL), &ids[i]) == SUCCESS);
+        }
+        game_log_stats_t before;
+        game_log_get_stats(&before);
+        for (int i = 0; i < SYNC_TEST_THREADS; i++) {
+            assert(pthread_create(&threads[i], NULL, sync_test_appender, &ids[i]) == 0);
+        }
+        for (int i = 0; i < SYNC_TEST_THREADS; i++) pthread_join(threads[i], NULL);
+
+        game_log_stats_t after;
+        game_log_get_stats(&after);
+        if (policies[p] == GAME_LOG_SYNC_EVERY) {
+            assert(after.queued == 0);
+            assert(after.commits > before.commits);
+            assert(after.commits - before.commits <= SYNC_TEST_THREADS * SYNC_TEST_MOVES);
+        }
+
+        /* Reopening sees only what reached the segments */
+        storage_cleanup();
+        storage_init();
+        game_log_info_t infos[SYNC_TEST_THREADS];
+        int count;
+        game_log_id_t next;
+        assert(game_log_scan(ids[0], b, infos, SYNC_TEST_THREADS, &count, &next) == SUCCESS);
+        assert(count == SYNC_TEST_THREADS);
+        for (int i = 0; i < count; i++) {
+            assert(infos[i].moves == SYNC_TEST_MOVES);
+            assert(game_log_delete(infos[i].id) == SUCCESS);
+        }
+        storage_cleanup();
+    }
+    game_log_set_sync(GAME_LOG_SYNC_INTERVAL, GAME_LOG_SYNC_INTERVAL_DEFAULT_MS);
+}
+
+/* Plays the first legal pit each turn for up to `limit` moves, logging
+ * them; boards[i] is the board after i moves */
+static uint32_t play_logged_game(game_log_id_t id, uint32_t limit, uint8_t* played, board_t* boards) {
+    board_t board;
+    board_init(&board);
+    uint32_t count = 0;
+    boards[0] = board;
+    while (count < limit && board.state == GAME_STATE_IN_PROGRESS) {
+        int pit = 0;
+        while (rules_validate_move(&board, board.current_player, pit) != SUCCESS) pit++;
+        int captured;
+        assert(board_execute_move(&board, board.current_player, pit, &captured) == SUCCESS);
+        assert(game_log_append_move(id, pit, &board) == SUCCESS);
+        played[count++] = (uint8_t)pit;
+        boards[count] = board;
+    }
+    return count;
+}
+
+/* A finished game becomes one GAME record, under 100 bytes for 60 moves;
+ * any move of it can be loaded, and the index is rebuilt from it on reopen */
+TEST(game_log_compact_game) {
+    storage_init();
+    pseudo_id_t a = pseudo_intern("CmpA"), b = pseudo_intern("CmpB");
+    uint8_t played[100];
+    board_t boards[101];
+    game_log_id_t id;
+    game_log_stats_t before, after;
+
+    /* Typical length, default label */
+    assert(game_log_start(a, b, "CmpA-vs-CmpB", time(NULL), &id) == SUCCESS);
+    uint32_t count = play_logged_game(id, 60, played, boards);
+    assert(count == 60);
+    assert(game_log_flush() == SUCCESS);
+    game_log_get_stats(&before);
+    assert(game_log_finish(id, "CmpA-vs-CmpB", played, count, &boards[count]) == SUCCESS);
+    assert(game_log_flush() == SUCCESS);
+    game_log_get_stats(&after);
+    assert(after.bytes - before.bytes < 100);
+    assert(game_log_delete(id) == SUCCESS);
+
+    /* Longer, so a periodic board is kept */
+    assert(game_log_start(a, b, "compact-test", time(NULL), &id) == SUCCESS);
+    count = play_logged_game(id, 90, played, boards);
+    assert(count > GAME_LOG_SNAPSHOT_INTERVAL + 1);
+    const board_t* final = &boards[count];
+    assert(game_log_finish(id, "compact-test", played, count, final) == SUCCESS);
+
+    for (int reopen = 0; reopen < 2; reopen++) {
+        game_log_game_t loaded;
+        assert(game_log_load(id, &loaded) == SUCCESS);
+        assert(strcmp(loaded.label, "compact-test") == 0);
+        assert(loaded.player_a == a && loaded.player_b == b);
+        assert(loaded.moves == count);
+        assert(memcmp(loaded.board.pits, final->pits, sizeof(final->pits)) == 0);
+
+        uint32_t at[] = { 0, 30, GAME_LOG_SNAPSHOT_INTERVAL, GAME_LOG_SNAPSHOT_INTERVAL + 1, count };
+        for (size_t i = 0; i < sizeof(at) / sizeof(at[0]); i++) {
+            assert(game_log_load_at(id, at[i], &loaded) == SUCCESS);
+            assert(loaded.moves == at[i]);
+            assert(memcmp(loaded.board.pits, boards[at[i]].pits, sizeof(final->pits)) == 0);
+            assert(loaded.board.scores[PLAYER_A] == boards[at[i]].scores[PLAYER_A]);
+            assert(loaded.board.current_player == boards[at[i]].current_player);
+        }
+        assert(game_log_load_at(id, count + 1, &loaded) == ERR_INVALID_PARAM);
+
+        uint8_t history[100];
+        uint32_t kept;
+        assert(game_log_history(id, history, 100, &kept) == SUCCESS);
+        assert(kept == count && memcmp(history, played, count) == 0);
+        assert(game_log_history(id, history, 10, &kept) == ERR_MAX_CAPACITY);
+
+        game_log_info_t info;
+        int found;
+        game_log_id_t next;
+        assert(game_log_scan(id, a, &info, 1, &found, &next) == SUCCESS);
+        assert(found == 1 && info.id == id && info.moves == count);
+        assert(strcmp(info.label, "compact-test") == 0);
+
+        storage_cleanup();
+        storage_init();
+    }
+
+    assert(game_log_delete(id) == SUCCESS);
+    storage_cleanup();
+}
+
+static bool log_file_exists(uint32_t segment, const char* suffix) {
+    char path[64];
+    snprintf(path, sizeof(path), "./data/games/%08u.%s", segment, suffix);
+    return access(path, F_OK) == 0;
+}
+
+/* A sealed segment is archived once no game without a GAME record has
+ * records in it; finished games then load from the archive, deleted ones
+ * stay deleted, and both survive a reopen */
+TEST(game_log_archive_segments) {
+    storage_init();
+    pseudo_id_t a = pseudo_intern("ArcA"), b = pseudo_intern("ArcB");
+    uint8_t played[100], played_z[100];
+    board_t boards[101], boards_z[101];
+    game_log_id_t x, y, z;
+
+    assert(game_log_rotate() == SUCCESS);
+    game_log_stats_t stats;
+    game_log_get_stats(&stats);
+    uint32_t segment = stats.segments;
+
+    assert(game_log_start(a, b, "archive-x", time(NULL), &x) == SUCCESS);
+    uint32_t count = play_logged_game(x, 90, played, boards);
+    assert(game_log_finish(x, "archive-x", played, count, &boards[count]) == SUCCESS);
+    assert(game_log_start(a, b, "archive-y", time(NULL), &y) == SUCCESS);
+    assert(game_log_delete(y) == SUCCESS);
+    assert(game_log_start(a, b, "archive-z", time(NULL), &z) == SUCCESS);
+    uint32_t count_z = play_logged_game(z, 100, played_z, boards_z);
+    assert(game_log_rotate() == SUCCESS);
+
+    /* z has no GAME record yet */
+    assert(game_log_compact() == SUCCESS);
+    assert(log_file_exists(segment, "seg") && !log_file_exists(segment, "arc"));
+
+    assert(game_log_finish(z, "archive-z", played_z, count_z, &boards_z[count_z]) == SUCCESS);
+    assert(game_log_rotate() == SUCCESS);
+    game_log_stats_t before, after;
+    game_log_get_stats(&before);
+    assert(game_log_compact() == SUCCESS);
+    game_log_get_stats(&after);
+    assert(!log_file_exists(segment, "seg") && log_file_exists(segment, "arc"));
+    assert(after.archives >= before.archives + 2);
+    assert(after.compactions >= before.compactions + 2);
+    assert(after.archived_bytes - before.archived_bytes < (after.compacted_bytes - before.compacted_bytes) / 4);
+
+    /* x is deleted after its segment was archived: the DELETE record goes
+     * into the next archive */
+    game_log_id_t w;
+    assert(game_log_start(a, b, "archive-w", time(NULL), &w) == SUCCESS);
+    assert(game_log_delete(x) == SUCCESS);
+    assert(game_log_rotate() == SUCCESS);
+    assert(game_log_delete(w) == SUCCESS);
+    assert(game_log_compact() == SUCCESS);
+    assert(log_file_exists(segment + 2, "arc"));
+
+    for (int reopen = 0; reopen < 2; reopen++) {
+        game_log_game_t loaded;
+        assert(game_log_load(x, &loaded) == ERR_GAME_NOT_FOUND);
+        assert(game_log_load(y, &loaded) == ERR_GAME_NOT_FOUND);
+        assert(game_log_load(w, &loaded) == ERR_GAME_NOT_FOUND);
+        assert(game_log_load(z, &loaded) == SUCCESS);
+        assert(strcmp(loaded.label, "archive-z") == 0);
+        assert(loaded.moves == count_z);
+        assert(memcmp(loaded.board.pits, boards_z[count_z].pits, sizeof(loaded.board.pits)) == 0);
+        assert(game_log_load_at(z, GAME_LOG_SNAPSHOT_INTERVAL + 1, &loaded) == SUCCESS);
+        assert(memcmp(loaded.board.pits, boards_z[GAME_LOG_SNAPSHOT_INTERVAL + 1].pits,
+                      sizeof(loaded.board.pits)) == 0);
+
+        uint8_t history[200];
+        uint32_t kept;
+        assert(game_log_history(z, history, sizeof(history), &kept) == SUCCESS);
+        assert(kept == count_z && memcmp(history, played_z, count_z) == 0);
+
+        game_log_info_t info;
+        int found;
+        game_log_id_t next;
+        assert(game_log_scan(x, a, &info, 1, &found, &next) == SUCCESS);
+        assert(found == 1 && info.id == z && strcmp(info.label, "archive-z") == 0);
+
+        storage_cleanup();
+        storage_init();
+    }
+
+    /* IDs of games dropped entirely are not handed out again */
+    game_log_id_t fresh;
+    assert(game_log_start(a, b, "archive-fresh", time(NULL), &fresh) == SUCCESS);
+    assert(fresh > w);
+    assert(game_log_delete(fresh) == SUCCESS);
+    assert(game_log_delete(z) == SUCCESS);
+    storage_cleanup();
+}
+
+/* Loads running while their games' segments are archived always succeed:
+ * a load that found a segment location keeps reading the segment */
+typedef struct {
+    game_log_id_t first;
+    uint32_t games;
+    bool stop;
+    uint32_t loads;
+    uint32_t failures;
+} compaction_reader_t;
+
+static void* load_while_compacting(void* arg) {
+    compaction_reader_t* reader = arg;
+    game_log_game_t game;
+    for (uint32_t i = 0; !__atomic_load_n(&reader->stop, __ATOMIC_ACQUIRE); i++) {
+        if (game_log_load(reader->first + i % reader->games, &game) != SUCCESS) reader->failures++;
+        __atomic_add_fetch(&reader->loads, 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+TEST(game_log_loads_during_compaction) {
+    storage_init();
+    game_log_game_t game;
+    memset(&game, 0, sizeof(game));
+    board_init(&game.board);
+    game.board.state = GAME_STATE_FINISHED;
+    game.board.winner = WINNER_A;
+    game.player_a = pseudo_intern("DuringA");
+    game.player_b = pseudo_intern("DuringB");
+    compaction_reader_t reader = { .games = 400 };
+    for (uint32_t i = 0; i < reader.games; i++) {
+        game_log_id_t id;
+        game.board.created_at = time(NULL);
+        snprintf(game.label, sizeof(game.label), "during-%u", i);
+        assert(game_log_import(&game, &id) == SUCCESS);
+        if (i == 0) reader.first = id;
+        assert(id == reader.first + i);
+        if (i % 100 == 99) assert(game_log_rotate() == SUCCESS);
+    }
+    assert(game_log_flush() == SUCCESS);
+
+    game_log_stats_t before, after;
+    game_log_get_stats(&before);
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, load_while_compacting, &reader) == 0);
+    while (__atomic_load_n(&reader.loads, __ATOMIC_ACQUIRE) == 0) sched_yield();
+    assert(game_log_compact() == SUCCESS);
+    assert(game_log_compact() == SUCCESS);
+    uint32_t loads = __atomic_load_n(&reader.loads, __ATOMIC_ACQUIRE);
+    while (__atomic_load_n(&reader.loads, __ATOMIC_ACQUIRE) < loads + 1000) sched_yield();
+    __atomic_store_n(&reader.stop, true, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+    game_log_get_stats(&after);
+    assert(after.archives >= before.archives + 3);
+    assert(reader.failures == 0);
+
+    for (uint32_t i = 0; i < reader.games; i++) assert(game_log_delete(reader.first + i) == SUCCESS);
+    storage_cleanup();
+}
+
+/* Once its segment is sealed a finished game loads from the mapping, with
+ * no pread, also after a reopen; pages longer than the listing's batch
+ * come back whole */
+TEST(game_log_mapped_reads) {
+    storage_init();
+    pseudo_id_t a = pseudo_intern("MapA"), b = pseudo_intern("MapB");
+    uint8_t played[100];
+    board_t boards[101];
+    game_log_id_t id;
+    assert(game_log_start(a, b, "mapped", time(NULL), &id) == SUCCESS);
+    uint32_t count = play_logged_game(id, 60, played, boards);
+    assert(game_log_finish(id, "mapped", played, count, &boards[count]) == SUCCESS);
+
+    game_log_game_t loaded;
+    game_log_stats_t before, after;
+    game_log_get_stats(&before);
+    assert(game_log_load(id, &loaded) == SUCCESS);
+    game_log_get_stats(&after);
+    assert(after.file_reads == before.file_reads + 1);
+
+    assert(game_log_rotate() == SUCCESS);
+    for (int reopen = 0; reopen < 2; reopen++) {
+        game_log_get_stats(&before);
+        for (int i = 0; i < 10; i++) {
+            assert(game_log_load(id, &loaded) == SUCCESS);
+            assert(loaded.moves == count && strcmp(loaded.label, "mapped") == 0);
+            assert(memcmp(loaded.board.pits, boards[count].pits, sizeof(loaded.board.pits)) == 0);
+        }
+        game_log_get_stats(&after);
+        assert(after.file_reads == before.file_reads);
+        storage_cleanup();
+        storage_init();
+    }
+    assert(game_log_delete(id) == SUCCESS);
+
+    game_instance_t game;
+    char keys[40][MAX_GAME_ID_LEN];
+    for (int i = 0; i < 40; i++) {
+        memset(&game, 0, sizeof(game));
+        snprintf(game.game_id, MAX_GAME_ID_LEN, "batch-%d", i);
+        game.player_a = pseudo_intern("BatchFay");
+        game.player_b = pseudo_intern("BatchGus");
+        board_init(&game.board);
+        assert(storage_save_game(&game) == SUCCESS);
+        storage_game_key(game.game_id, game.log_id, keys[i]);
+    }
+    game_info_t infos[40];
+    int listed;
+    game_log_id_t cursor;
+    assert(storage_list_saved_games_page("BatchFay", 0, infos, 35, &listed, &cursor) == SUCCESS);
+    assert(listed == 35 && cursor != 0);
+    assert(strcmp(infos[34].game_id, keys[34]) == 0);
+    assert(storage_list_saved_games_page("BatchFay", cursor, infos, 35, &listed, &cursor) == SUCCESS);
+    assert(listed == 5 && cursor == 0);
+    assert(strcmp(infos[4].game_id, keys[39]) == 0);
+    for (int i = 0; i < 40; i++) storage_delete_game(keys[i]);
+    storage_cleanup();
+}
+
+/* Rewrite a segment the way version 1 wrote it, with zlib's CRC-32 on each
+ * record (16-byte header, 24-byte record headers) */
+static void downgrade_segment(uint32_t segment) {
+    char path[64];
+    snprintf(path, sizeof(path), "./data/games/%08u.seg", segment);
+    FILE* file = fopen(path, "r+b");
+    assert(file);
+    static uint8_t data[1 << 20];
+    size_t size = fread(data, 1, sizeof(data), file);
+    assert(size >= 16 && size < sizeof(data));
+    data[4] = 1;
+    for (size_t offset = 16; offset + 24 <= size;) {
+        size_t record = 24 + (size_t)(data[offset + 6] | data[offset + 7] << 8);
+        if (offset + record > size) break;
+        uint32_t crc = (uint32_t)crc32(0L, data + offset + 4, (uInt)(record - 4));
+        for (int i = 0; i < 4; i++) data[offset + (size_t)i] = (uint8_t)(crc >> (8 * i));
+        offset += record;
+    }
+    rewind(file);
+    assert(fwrite(data, 1, size, file) == size);
+    fclose(file);
+}
+
+/* A segment from before CRC-32C still loads; new records go to a new
+ * segment, and compaction archives the old one with CRC-32C */
+TEST(game_log_reads_version_1) {
+    storage_init();
+    pseudo_id_t a = pseudo_intern("OldA"), b = pseudo_intern("OldB");
+    uint8_t played[100], played_open[100];
+    board_t boards[101], boards_open[101];
+    assert(game_log_rotate() == SUCCESS);
+    game_log_stats_t stats;
+    game_log_get_stats(&stats);
+    uint32_t segment = stats.segments;
+
+    game_log_id_t done, open;
+    assert(game_log_start(a, b, "crc32-done", time(NULL), &done) == SUCCESS);
+    uint32_t count = play_logged_game(done, 70, played, boards);
+    assert(game_log_finish(done, "crc32-done", played, count, &boards[count]) == SUCCESS);
+    assert(game_log_start(a, b, "crc32-open", time(NULL), &open) == SUCCESS);
+    uint32_t count_open = play_logged_game(open, 20, played_open, boards_open);
+    storage_cleanup();
+    downgrade_segment(segment);
+
+    storage_init();
+    game_log_get_stats(&stats);
+    assert(stats.segments == segment + 1);
+    game_log_game_t loaded;
+    assert(game_log_load(done, &loaded) == SUCCESS);
+    assert(loaded.moves == count && memcmp(loaded.board.pits, boards[count].pits, sizeof(loaded.board.pits)) == 0);
+    assert(game_log_load(open, &loaded) == SUCCESS);
+    assert(loaded.moves == count_open);
+    assert(memcmp(loaded.board.pits, boards_open[count_open].pits, sizeof(loaded.board.pits)) == 0);
+
+    assert(game_log_finish(open, "crc32-open", played_open, count_open, &boards_open[count_open]) == SUCCESS);
+    assert(game_log_rotate() == SUCCESS);
+    assert(game_log_compact() == SUCCESS);
+    assert(!log_file_exists(segment, "seg") && log_file_exists(segment, "arc"));
+    char path[64];
+    snprintf(path, sizeof(path), "./data/games/%08u.arc", segment);
+    FILE* file = fopen(path, "rb");
+    uint8_t header[8];
+    assert(file && fread(header, 1, sizeof(header), file) == sizeof(header));
+    fclose(file);
+    assert(header[4] == 2);
+
+    storage_cleanup();
+    storage_init();
+    assert(game_log_load(done, &loaded) == SUCCESS);
+    assert(loaded.moves == count && strcmp(loaded.label, "crc32-done") == 0);
+    assert(game_log_load(open, &loaded) == SUCCESS);
+    assert(loaded.moves == count_open && strcmp(loaded.label, "crc32-open") == 0);
+    assert(game_log_delete(done) == SUCCESS);
+    assert(game_log_delete(open) == SUCCESS);
+    storage_cleanup();
+}
+
+/* Old games.dat records are imported with their final board; a record
+ * failing its CRC is skipped */
+TEST(legacy_games_conversion) {
+    struct {
+        uint32_t version;
+        char game_id[MAX_GAME_ID_LEN];
+        char player_a[MAX_PSEUDO_LEN];
+        char player_b[MAX_PSEUDO_LEN];
+        board_t board;
+        time_t created_at;
+        time_t last_move_at;
+        char spectators[MAX_SPECTATORS_PER_GAME][MAX_PSEUDO_LEN];
+        int spectator_count;
+        uint32_t crc;
+    } records[2];
+    memset(records, 0, sizeof(records));
+    for (int i = 0; i < 2; i++) {
+        records[i].version = 1;
+        snprintf(records[i].game_id, MAX_GAME_ID_LEN, "legacy-%d", i);
+        snprintf(records[i].player_a, MAX_PSEUDO_LEN, "LegacyA");
+        snprintf(records[i].player_b, MAX_PSEUDO_LEN, "LegacyB");
+        board_init(&records[i].board);
+        records[i].board.pits[3] = 0;
+        records[i].board.scores[PLAYER_A] = 4;
+        records[i].crc = crc32(0L, (const Bytef*)&records[i], sizeof(records[i]) - sizeof(records[i].crc));
+    }
+    records[1].board.scores[PLAYER_B] = 9;     /* After its CRC */
+
+    const char* path = "./data/legacy_games_test.dat";
+    FILE* f = fopen(path, "wb");
+    assert(f);
+    fwrite(records, 1, sizeof(records), f);
+    fclose(f);
+
+    storage_init();
+    int converted, skipped;
+    assert(storage_convert_legacy_games(path, &converted, &skipped) == SUCCESS);
+    assert(converted == 1 && skipped == 1);
+
+    game_log_info_t infos[64];
+    int count;
+    game_log_id_t next;
+    assert(game_log_scan(1, pseudo_lookup("LegacyA"), infos, 64, &count, &next) == SUCCESS);
+    assert(count == 1);
+    assert(strcmp(infos[0].label, "legacy-0") == 0);
+
+    char key[MAX_GAME_ID_LEN];
+    storage_game_key(infos[0].label, infos[0].id, key);
+    game_instance_t loaded;
+    assert(storage_load_game(key, &loaded) == SUCCESS);
+    assert(loaded.board.pits[3] == 0 && loaded.board.scores[PLAYER_A] == 4);
+    pthread_mutex_destroy(&loaded.lock);
+
+    uint32_t kept;
+    uint8_t history[1];
+    assert(game_log_history(infos[0].id, history, 1, &kept) == SUCCESS);
+    assert(kept == 0);
+
+    storage_delete_game(key);
+    storage_cleanup();
+    unlink(path);
+}
+
+/* Games in progress come back after a restart, replayed through the rules;
+ * one whose log does not replay is left out */
+TEST(startup_recovery) {
+    storage_init();
+    game_manager_t gm;
+    assert(game_manager_init(&gm) == SUCCESS);
+    pseudo_id_t a = pseudo_intern("RecoverA"), b = pseudo_intern("RecoverB");
+    game_handle_t handle;
+    assert(game_manager_create_game(&gm, a, b, &handle, NULL) == SUCCESS);
+    game_instance_t* game = game_manager_find_game(&gm, handle);
+    for (int i = 0; i < 10; i++) {
+        int pit = 0, captured;
+        while (rules_validate_move(&game->board, game->board.current_player, pit) != SUCCESS) pit++;
+        pseudo_id_t mover = game->board.current_player == PLAYER_A ? a : b;
+        assert(game_manager_play_move(&gm, handle, mover, pit, &captured, NULL) == SUCCESS);
+    }
+    board_t board = game->board;
+    game_log_id_t log_id = game->log_id;
+
+    /* Player A cannot play pit 7 */
+    pseudo_id_t c = pseudo_intern("RecoverC"), d = pseudo_intern("RecoverD");
+    game_log_id_t broken;
+    board_t start;
+    board_init(&start);
+    assert(game_log_start(c, d, "recover-broken", start.created_at, &broken) == SUCCESS);
+    assert(game_log_append_move(broken, 7, &start) == SUCCESS);
+    game_manager_destroy(&gm);
+    storage_cleanup();
+
+    storage_init();
+    assert(game_manager_init(&gm) == SUCCESS);
+    int restored, skipped;
+    assert(storage_load_all_games(&gm, &restored, &skipped) == SUCCESS);
+    assert(restored >= 1 && skipped >= 1);
+    assert(!game_manager_is_player_in_game(&gm, c));
+
+    game = game_manager_find_game_by_players(&gm, a, b);
+    assert(game != NULL && game->log_id == log_id);
+    assert(memcmp(game->board.pits, board.pits, sizeof(board.pits)) == 0);
+    assert(game->board.current_player == board.current_player);
+    assert(game->move_seq == 10 && game->moves_kept == 10);
+
+    /* Play continues, logged under the same game */
+    int pit = 0, captured;
+    while (rules_validate_move(&game->board, game->board.current_player, pit) != SUCCESS) pit++;
+    pseudo_id_t mover = game->board.current_player == PLAYER_A ? a : b;
+    assert(game_manager_play_move(&gm, game->handle, mover, pit, &captured, NULL) == SUCCESS);
+    game_log_game_t loaded;
+    assert(game_log_load(log_id, &loaded) == SUCCESS);
+    assert(loaded.moves == 11);
+    assert(memcmp(loaded.board.pits, game->board.pits, sizeof(board.pits)) == 0);
+
+    game_log_delete(log_id);
+    game_log_delete(broken);
+    game_manager_destroy(&gm);
+    storage_cleanup();
+}
+
+/* Only records changed since the last flush are written, and a torn write
+ * of the newer copy leaves the older one */
+TEST(player_store_dirty_flush) {
+    const char* path = "./data/player_store_test.db";
+    unlink(path);
+    player_store_set_flush_interval(60000);     /* Flushed by hand only */
+
+    bool created = false;
+    assert(player_store_open(path, 300, &created) == SUCCESS);
+    assert(created);
+    pseudo_id_t ids[3] = { pseudo_intern("StoreA"), pseudo_intern("StoreB"), pseudo_intern("StoreC") };
+    uint8_t record[300], out[300];
+    for (int i = 0; i < 3; i++) {
+        memset(record, 'a' + i, sizeof(record));
+        assert(player_store_put(ids[i], record) == SUCCESS);
+    }
+    memset(record, 'A', sizeof(record));
+    assert(player_store_put(ids[0], record) == SUCCESS);
+    assert(player_store_get(ids[0], out) == SUCCESS && out[0] == 'A');
+    assert(player_store_get(pseudo_intern("StoreNone"), out) == ERR_PLAYER_NOT_FOUND);
+
+    player_store_stats_t stats;
+    player_store_get_stats(&stats);
+    assert(stats.records == 3 && stats.dirty == 3 && stats.puts == 4 && stats.written == 0);
+    assert(player_store_flush() == SUCCESS);
+    player_store_get_stats(&stats);
+    assert(stats.dirty == 0 && stats.written == 3 && stats.syncs == 1);
+
+    /* Second write of StoreB goes to its other copy */
+    memset(record, 'B', sizeof(record));
+    assert(player_store_put(ids[1], record) == SUCCESS);
+    assert(player_store_flush() == SUCCESS);
+    player_store_get_stats(&stats);
+    assert(stats.written == 4 && stats.syncs == 2);
+    player_store_close();
+
+    assert(player_store_open(path, 300, &created) == SUCCESS);
+    assert(!created);
+    assert(player_store_get(ids[0], out) == SUCCESS && out[0] == 'A' && out[299] == 'A');
+    assert(player_store_get(ids[1], out) == SUCCESS && out[0] == 'B');
+    assert(player_store_get(ids[2], out) == SUCCESS && out[0] == 'c');
+    player_store_close();
+
+    /* Slot 1 (StoreB), copy 1: header page, then two 4 KiB copies per slot */
+    FILE* f = fopen(path, "r+b");
+    assert(f);
+    fseek(f, PLAYER_STORE_PAGE_SIZE + 3 * PLAYER_STORE_PAGE_SIZE + 200, SEEK_SET);
+    fputc('X', f);
+    fclose(f);
+    assert(player_store_open(path, 300, &created) == SUCCESS);
+    assert(player_store_get(ids[1], out) == SUCCESS && out[0] == 'b');
+
+    /* Another record size is refused */
+    player_store_close();
+    assert(player_store_open(path, 400, &created) == ERR_SERIALIZATION);
+    player_store_set_flush_interval(PLAYER_STORE_FLUSH_INTERVAL_DEFAULT_MS);
+    unlink(path);
+}
+
+/* Listings come from the catalog by date, filtered by player and date
+ * range; cursors survive deletes and the catalog survives a restart */
+TEST(game_catalog_filters) {
+    storage_init();
+    pseudo_id_t a = pseudo_intern("CatalogA"), b = pseudo_intern("CatalogB"), c = pseudo_intern("CatalogC");
+    const time_t base = 1000000000;
+
+    /* Started out of date order: game i was created at base + dates[i] */
+    const int dates[6] = { 50, 10, 30, 20, 60, 40 };
+    game_instance_t games[6];
+    for (int i = 0; i < 6; i++) {
+        memset(&games[i], 0, sizeof(games[i]));
+        snprintf(games[i].game_id, MAX_GAME_ID_LEN, "catalog-%d", i);
+        games[i].player_a = a;
+        games[i].player_b = i % 2 ? b : c;
+        board_init(&games[i].board);
+        games[i].board.created_at = base + dates[i];
+        assert(storage_start_game(&games[i]) == SUCCESS);
+    }
+    games[3].board.state = GAME_STATE_FINISHED;
+    games[3].board.winner = WINNER_B;
+    assert(storage_finish_game(&games[3]) == SUCCESS);
+
+    /* By date, one per page */
+    game_catalog_filter_t filter = { a, base + 10, base + 60 };
+    game_log_info_t info;
+    game_log_id_t cursor = GAME_LOG_ID_NONE;
+    const int by_date[5] = { 1, 3, 2, 5, 0 };
+    for (int i = 0; i < 5; i++) {
+        int count;
+        assert(game_catalog_page(&filter, cursor, &info, 1, &count, &cursor) == SUCCESS);
+        assert(count == 1 && info.id == games[by_date[i]].log_id);
+        if (by_date[i] == 3) {
+            assert(info.state == GAME_STATE_FINISHED && info.winner == WINNER_B && info.moves == 0);
+            assert(strcmp(info.label, "catalog-3") == 0);
+        }
+        /* Delete the game the cursor points at: the page after still comes */
+        if (i == 2) {
+            char key[MAX_GAME_ID_LEN];
+            storage_game_key(games[5].game_id, games[5].log_id, key);
+            assert(storage_delete_game(key) == SUCCESS);
+            i++;
+        }
+    }
+    assert(cursor == GAME_LOG_ID_NONE);
+
+    /* Player filter: CatalogB played games 1, 3 and 5 (deleted) */
+    game_log_info_t infos[8];
+    int count;
+    game_log_id_t next;
+    filter = (game_catalog_filter_t){ b, 0, 0 };
+    assert(game_catalog_page(&filter, GAME_LOG_ID_NONE, infos, 8, &count, &next) == SUCCESS);
+    assert(count == 2 && infos[0].id == games[1].log_id && infos[1].id == games[3].log_id);
+    filter = (game_catalog_filter_t){ c, base + 45, 0 };
+    assert(game_catalog_page(&filter, GAME_LOG_ID_NONE, infos, 8, &count, &next) == SUCCESS);
+    assert(count == 2 && infos[0].id == games[0].log_id && infos[1].id == games[4].log_id);
+    storage_cleanup();
+
+    /* Rebuilt from the log */
+    storage_init();
+    filter = (game_catalog_filter_t){ b, 0, 0 };
+    assert(game_catalog_page(&filter, GAME_LOG_ID_NONE, infos, 8, &count, &next) == SUCCESS);
+    assert(count == 2 && infos[1].id == games[3].log_id);
+    assert(infos[1].state == GAME_STATE_FINISHED && infos[1].winner == WINNER_B);
+
+    for (int i = 0; i < 6; i++) {
+        char key[MAX_GAME_ID_LEN];
+        storage_game_key(games[i].game_id, games[i].log_id, key);
+        storage_delete_game(key);
+    }
+    filter = (game_catalog_filter_t){ a, 0, 0 };
+    assert(game_catalog_page(&filter, GAME_LOG_ID_NONE, infos, 8, &count, &next) == SUCCESS);
+    assert(count == 0);
+    storage_cleanup();
+}
+
+/* ========== Pseudo Table Tests ========== */
+
+TEST(pseudo_table_interning) {
+    pseudo_id_t alice = pseudo_intern("InternAlice");
+    assert(alice != PSEUDO_ID_NONE);
+    assert(pseudo_intern("InternAlice") == alice);
+    assert(pseudo_lookup("InternAlice") == alice);
+    assert(strcmp(pseudo_name(alice), "InternAlice") == 0);
+
+    /* Lookups never assign */
+    assert(pseudo_lookup("InternNobody") == PSEUDO_ID_NONE);
+    assert(pseudo_lookup("InternNobody") == PSEUDO_ID_NONE);
+    assert(pseudo_intern("") == PSEUDO_ID_NONE);
+    assert(strcmp(pseudo_name(PSEUDO_ID_NONE), "") == 0);
+
+    /* A pseudo too long for the wire is the same player as its truncation */
+    char longer[MAX_PSEUDO_LEN + 8];
+    memset(longer, 'x', sizeof(longer) - 1);
+    longer[sizeof(longer) - 1] = '\0';
+    pseudo_id_t truncated = pseudo_intern(longer);
+    longer[MAX_PSEUDO_LEN - 1] = '\0';
+    assert(pseudo_lookup(longer) == truncated);
+
+    /* Names stay put while the index grows past several chunks */
+    const char* name = pseudo_name(alice);
+    char pseudo[MAX_PSEUDO_LEN];
+    pseudo_id_t first = PSEUDO_ID_NONE;
+    for (int i = 0; i < 1000; i++) {
+        snprintf(pseudo, sizeof(pseudo), "intern%04d", i);
+        pseudo_id_t id = pseudo_intern(pseudo);
+        assert(id != PSEUDO_ID_NONE);
+        if (i == 0) first = id;
+    }
+    assert(name == pseudo_name(alice));
+    assert(pseudo_lookup("intern0000") == first);
+    assert(strcmp(pseudo_name(pseudo_lookup("intern0999")), "intern0999") == 0);
+}
+
+/* ========== Game Handle Tests ========== */
+
+TEST(game_handle_generations) {
+    game_manager_t gm;
+    assert(game_manager_init(&gm) == SUCCESS);
+    pseudo_id_t alice = pseudo_intern("HandleAlice");
+    pseudo_id_t bob = pseudo_intern("HandleBob");
+
+    game_handle_t first;
+    char label[MAX_GAME_ID_LEN];
+    assert(game_manager_create_game(&gm, alice, bob, &first, label) == SUCCESS);
+    assert(first != GAME_HANDLE_NONE);
+    assert(strcmp(label, "HandleAlice-vs-HandleBob") == 0);
+    game_instance_t* game = game_manager_find_game(&gm, first);
+    assert(game != NULL && game->handle == first);
+
+    /* A rematch reuses the slot but not the handle */
+    assert(game_manager_remove_game(&gm, first) == SUCCESS);
+    assert(game_manager_find_game(&gm, first) == NULL);
+    game_handle_t second;
+    assert(game_manager_create_game(&gm, alice, bob, &second, NULL) == SUCCESS);
+    assert(GAME_HANDLE_SLOT(second) == GAME_HANDLE_SLOT(first));
+    assert(second != first);
+    assert(game_manager_find_game(&gm, first) == NULL);
+    assert(game_manager_find_game(&gm, second) != NULL);
+    assert(game_manager_remove_game(&gm, first) == ERR_GAME_NOT_FOUND);
+
+    /* Nor does it reach the new game through the per-game operations */
+    board_t board;
+    msg_board_delta_t keyframe;
+    int captured = 0;
+    assert(game_manager_get_board(&gm, first, &board) == ERR_GAME_NOT_FOUND);
+    assert(game_manager_get_keyframe(&gm, first, &keyframe) == ERR_GAME_NOT_FOUND);
+    assert(game_manager_play_move(&gm, first, alice, 0, &captured, NULL) == ERR_GAME_NOT_FOUND);
+    assert(game_manager_get_board(&gm, second, &board) == SUCCESS);
+
+    /* Handles from outside the pool find nothing */
+    assert(game_manager_find_game(&gm, GAME_HANDLE_NONE) == NULL);
+    assert(game_manager_find_game(&gm, GAME_HANDLE_MAKE(MAX_GAMES, 1)) == NULL);
+
+    game_manager_destroy(&gm);
+}
+
+/* ========== Admission Tests ========== */
+
+TEST(token_bucket_refill) {
+    token_bucket_t bucket;
+    uint32_t retry_ms = 0;
+    token_bucket_init(&bucket, 2.0, 3.0, 100.0);
+    for (int i = 0; i < 3; i++) assert(token_bucket_take(&bucket, 1.0, 100.0, &retry_ms));
+    assert(!token_bucket_take(&bucket, 1.0, 100.0, &retry_ms));
+    assert(retry_ms >= 500 && retry_ms <= 501);
+
+    /* Half a second at 2/s buys one request; a long idle caps at the burst */
+    assert(token_bucket_take(&bucket, 1.0, 100.5, &retry_ms));
+    assert(!token_bucket_take(&bucket, 1.0, 100.5, NULL));
+    for (int i = 0; i < 3; i++) assert(token_bucket_take(&bucket, 1.0, 200.0, NULL));
+    assert(!token_bucket_take(&bucket, 1.0, 200.0, NULL));
+}
+
+TEST(admission_sheds_expensive_first) {
+    admission_t admission;
+    uint32_t retry_ms;
+    bool shed;
+    msg_list_page_t page;
+    memset(&page, 0, sizeof(page));
+    page.list_type = MSG_LIST_SAVED_GAMES;
+    assert(admission_classify(MSG_LIST_PAGE, &page, sizeof(page)) == ADMISSION_CLASS_STORAGE);
+    assert(admission_classify(MSG_SEND_CHAT, NULL, 0) == ADMISSION_CLASS_CHAT);
+
+    /* A session's storage scans run out long before its game requests */
+    admission_init(&admission);
+    int admitted = 0;
+    for (int i = 0; i < 10; i++) {
+        if (admission_begin(&admission, MSG_LIST_SAVED_GAMES, NULL, 0, &retry_ms, &shed) == SUCCESS) {
+            admission_end();
+            admitted++;
+        } else {
+            assert(!shed && retry_ms > 0);
+        }
+    }
+    assert(admitted == 3);
+    assert(admission_begin(&admission, MSG_GET_BOARD, NULL, 0, &retry_ms, &shed) == SUCCESS);
+    admission_end();
+
+    /* Requests left in progress raise the overload level */
+    admission_init(&admission);
+    for (int i = 0; i < ADMISSION_OVERLOAD_INFLIGHT; i++) {
+        assert(admission_begin(&admission, MSG_GET_BOARD, NULL, 0, &retry_ms, &shed) == SUCCESS);
+    }
+    assert(admission_overload_level() == 1);
+    assert(admission_begin(&admission, MSG_LIST_PAGE, &page, sizeof(page), &retry_ms, &shed) == ERR_RATE_LIMITED);
+    assert(shed && retry_ms == ADMISSION_OVERLOAD_RETRY_MS);
+    assert(admission_begin(&admission, MSG_LIST_PLAYERS, NULL, 0, &retry_ms, &shed) == SUCCESS);
+    for (int i = ADMISSION_OVERLOAD_INFLIGHT + 1; i < ADMISSION_SHED_INFLIGHT; i++) {
+        assert(admission_begin(&admission, MSG_GET_BOARD, NULL, 0, &retry_ms, &shed) == SUCCESS);
+    }
+    assert(admission_overload_level() == 2);
+    assert(admission_begin(&admission, MSG_SEND_CHAT, NULL, 0, &retry_ms, &shed) == ERR_RATE_LIMITED && shed);
+    assert(admission_begin(&admission, MSG_GET_BIO, NULL, 0, &retry_ms, &shed) == SUCCESS);
+    assert(admission_begin(&admission, MSG_DISCONNECT, NULL, 0, &retry_ms, &shed) == SUCCESS);
+    for (int i = 0; i < ADMISSION_SHED_INFLIGHT + 2; i++) admission_end();
+    assert(admission_overload_level() == 0);
+}
+
+/* ========== Handler Tests ========== */
+
+/* The real handler thread, driven over an in-process loopback connection */
+TEST(client_handler_over_loopback) {
+    storage_init();
+    game_manager_t gm;
+    matchmaking_t mm;
+    volatile bool running = true;
+    assert(game_manager_init(&gm) == SUCCESS);
+    assert(matchmaking_init(&mm) == SUCCESS);
+    session_registry_init();
+    handlers_init(&gm, &mm);
+    connection_manager_init(&gm, &mm, &running, 0);
+
+    client_handler_t* handler = calloc(1, sizeof(client_handler_t));
+    assert(handler);
+    session_t client;
+    session_init(&client);
+    assert(connection_loopback_pair(&client.conn, &handler->conn) == SUCCESS);
+    snprintf(handler->pseudo, MAX_PSEUDO_LEN, "LoopUser");
+
+    /* The handler frees itself on exit */
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, client_handler, handler) == 0);
+
+    char payload[MAX_PAYLOAD_SIZE];
+    message_type_t type;
+    uint32_t sequence;
+    size_t size;
+    assert(session_send_tagged(&client, MSG_LIST_PLAYERS, 41, NULL, 0) == SUCCESS);
+    assert(session_recv_tagged_timeout(&client, &type, &sequence, payload, sizeof(payload), &size, 5000) == SUCCESS);
+    assert(type == MSG_PLAYER_LIST && sequence == 41);
+
+    assert(session_send_tagged(&client, MSG_DISCONNECT, 42, NULL, 0) == SUCCESS);
+    pthread_join(thread, NULL);
+    assert(session_recv_tagged_timeout(&client, &type, &sequence, payload, sizeof(payload), &size, 1000) == ERR_NETWORK_ERROR);
+    session_close(&client);
+
+    game_manager_destroy(&gm);
+    matchmaking_destroy(&mm);
+    storage_cleanup();
+}
+
+/* A handler whose client dropped holds the session and resumes it on a new
+ * Unix socket, replaying the notification pushed while it was away */
+TEST(client_handler_resume) {
+    storage_init();
+    game_manager_t gm;
+    matchmaking_t mm;
+    volatile bool running = true;
+    assert(game_manager_init(&gm) == SUCCESS);
+    assert(matchmaking_init(&mm) == SUCCESS);
+    session_registry_init();
+    handlers_init(&gm, &mm);
+    connection_manager_init(&gm, &mm, &running, 0);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/awale_resume_%d.sock", (int)getpid());
+    connection_t listener;
+    connection_init(&listener);
+    assert(connection_create_unix_server(&listener, path) == SUCCESS);
+
+    client_handler_t* handler = calloc(1, sizeof(client_handler_t));
+    assert(handler);
+    session_t client;
+    session_init(&client);
+    assert(connection_connect_unix(&client.conn, path) == SUCCESS);
+    assert(connection_accept(&listener, &handler->conn) == SUCCESS);
+    snprintf(handler->pseudo, MAX_PSEUDO_LEN, "ResumeUser");
+    assert(resume_token_issue(handler->pseudo, handler->session_id, sizeof(handler->session_id)) == SUCCESS);
+
+    msg_resume_t resume;
+    memset(&resume, 0, sizeof(resume));
+    snprintf(resume.pseudo, MAX_PSEUDO_LEN, "ResumeUser");
+    memcpy(resume.token, handler->session_id, sizeof(resume.token));
+
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, client_handler, handler) == 0);
+
+    char payload[MAX_PAYLOAD_SIZE];
+    message_type_t type;
+    uint32_t sequence;
+    size_t size;
+    assert(session_send_tagged(&client, MSG_LIST_PLAYERS, 1, NULL, 0) == SUCCESS);
+    assert(session_recv_tagged_timeout(&client, &type, &sequence, payload, sizeof(payload), &size, 5000) == SUCCESS);
+    assert(type == MSG_PLAYER_LIST && sequence == 1);
+
+    /* Forged and foreign tokens are refused */
+    connection_t stray;
+    connection_init(&stray);
+    msg_resume_t forged = resume;
+    forged.token[RESUME_TOKEN_LEN - 1] = forged.token[RESUME_TOKEN_LEN - 1] == '0' ? '1' : '0';
+    assert(session_registry_resume(&forged, &stray) == ERR_INVALID_PARAM);
+    msg_resume_t foreign = resume;
+    assert(resume_token_issue("ResumeUser", foreign.token, sizeof(foreign.token)) == SUCCESS);
+    assert(session_registry_resume(&foreign, &stray) == ERR_PLAYER_NOT_FOUND);
+
+    /* Drop the client; a push made meanwhile goes to the backlog */
+    session_close(&client);
+    session_t* held = session_registry_find(pseudo_lookup("ResumeUser"));
+    assert(held);
+    msg_chat_message_t chat;
+    memset(&chat, 0, sizeof(chat));
+    snprintf(chat.message, sizeof(chat.message), "while you were away");
+    session_send_notification(held, MSG_CHAT_MESSAGE, &chat, sizeof(chat));
+
+    session_init(&client);
+    connection_t fresh;
+    connection_init(&fresh);
+    assert(connection_connect_unix(&client.conn, path) == SUCCESS);
+    assert(connection_accept(&listener, &fresh) == SUCCESS);
+    assert(session_registry_resume(&resume, &fresh) == SUCCESS);
+
+    msg_resume_ack_t ack;
+    assert(session_recv_tagged_timeout(&client, &type, &sequence, &ack, sizeof(ack), &size, 5000) == SUCCESS);
+    assert(type == MSG_RESUME_ACK && ack.success && ack.complete && ack.replayed == 1);
+    assert(session_recv_tagged_timeout(&client, &type, &sequence, payload, sizeof(payload), &size, 5000) == SUCCESS);
+    assert(type == MSG_CHAT_MESSAGE && sequence == 0);
+
+    /* The same handler keeps serving requests on the new connection */
+    assert(session_send_tagged(&client, MSG_LIST_PLAYERS, 2, NULL, 0) == SUCCESS);
+    assert(session_recv_tagged_timeout(&client, &type, &sequence, payload, sizeof(payload), &size, 5000) == SUCCESS);
+    assert(type == MSG_PLAYER_LIST && sequence == 2);
+
+    assert(session_send_tagged(&client, MSG_DISCONNECT, 3, NULL, 0) == SUCCESS);
+    pthread_join(thread, NULL);
+    assert(session_registry_find(pseudo_lookup("ResumeUser")) == NULL);
+    session_close(&client);
+    connection_close(&listener);
+    unlink(path);
+
+    game_manager_destroy(&gm);
+    matchmaking_destroy(&mm);
+    storage_cleanup();
+}
+
+/* A fresh login for a player whose dropped session is held takes the player
+ * over: the held session is released without waiting out the grace window */
+TEST(client_handler_replaced_by_login) {
+    storage_init();
+    game_manager_t gm;
+    matchmaking_t mm;
+    volatile bool running = true;
+    assert(game_manager_init(&gm) == SUCCESS);
+    assert(matchmaking_init(&mm) == SUCCESS);
+    session_registry_init();
+    handlers_init(&gm, &mm);
+    connection_manager_init(&gm, &mm, &running, 0);
+
+    pseudo_id_t player = pseudo_intern("TakeoverUser");
+    assert(matchmaking_add_player(&mm, player, "local") == SUCCESS);
+
+    client_handler_t* handler = calloc(1, sizeof(client_handler_t));
+    assert(handler);
+    session_t client;
+    session_init(&client);
+    assert(connection_loopback_pair(&client.conn, &handler->conn) == SUCCESS);
+    snprintf(handler->pseudo, MAX_PSEUDO_LEN, "TakeoverUser");
+    assert(resume_token_issue(handler->pseudo, handler->session_id, sizeof(handler->session_id)) == SUCCESS);
+
+    msg_resume_t resume;
+    memset(&resume, 0, sizeof(resume));
+    snprintf(resume.pseudo, MAX_PSEUDO_LEN, "TakeoverUser");
+    memcpy(resume.token, handler->session_id, sizeof(resume.token));
+
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, client_handler, handler) == 0);
+
+    char payload[MAX_PAYLOAD_SIZE];
+    message_type_t type;
+    uint32_t sequence;
+    size_t size;
+    assert(session_send_tagged(&client, MSG_LIST_PLAYERS, 1, NULL, 0) == SUCCESS);
+    assert(session_recv_tagged_timeout(&client, &type, &sequence, payload, sizeof(payload), &size, 5000) == SUCCESS);
+
+    /* Nothing to replace while the session is live */
+    assert(!session_registry_replace_detached(player));
+    session_close(&client);
+
+    /* The new login sees the pseudo in use until the handler has detached */
+    assert(matchmaking_add_player(&mm, player, "local") == ERR_DUPLICATE);
+    while (!session_registry_replace_detached(player)) sched_yield();
+    pthread_join(thread, NULL);
+
+    /* The player stays logged in for the new login; the old token is void */
+    assert(matchmaking_player_connected(&mm, player));
+    assert(session_registry_find(player) == NULL);
+    connection_t stray;
+    connection_init(&stray);
+    assert(session_registry_resume(&resume, &stray) == ERR_PLAYER_NOT_FOUND);
+
+    game_manager_destroy(&gm);
+    matchmaking_destroy(&mm);
+    storage_cleanup();
+}
+
+/* A client flooding storage scans through the real handler gets
+ * ERR_RATE_LIMITED with a retry hint, and its other requests still work */
+TEST(client_handler_rate_limits) {
+    storage_init();
+    game_manager_t gm;
+    matchmaking_t mm;
+    volatile bool running = true;
+    assert(game_manager_init(&gm) == SUCCESS);
+    assert(matchmaking_init(&mm) == SUCCESS);
+    session_registry_init();
+    handlers_init(&gm, &mm);
+    connection_manager_init(&gm, &mm, &running, 0);
+
+    client_handler_t* handler = calloc(1, sizeof(client_handler_t));
+    assert(handler);
+    session_t client;
+    session_init(&client);
+    assert(connection_loopback_pair(&client.conn, &handler->conn) == SUCCESS);
+    snprintf(handler->pseudo, MAX_PSEUDO_LEN, "NoisyUser");
+
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, client_handler, handler) == 0);
+
+    char payload[MAX_PAYLOAD_SIZE];
+    message_type_t type;
+    uint32_t sequence;
+    size_t size;
+    msg_list_saved_games_t req;
+    memset(&req, 0, sizeof(req));
+    int limited = 0;
+    for (uint32_t i = 1; i <= 8; i++) {
+        assert(session_send_tagged(&client, MSG_LIST_SAVED_GAMES, i, &req, sizeof(req)) == SUCCESS);
+        assert(session_recv_tagged_timeout(&client, &type, &sequence, payload, sizeof(payload), &size, 5000) == SUCCESS);
+        assert(sequence == i);
+        if (type == MSG_ERROR) {
+            msg_error_t* error = (msg_error_t*)payload;
+            assert(error->error_code == ERR_RATE_LIMITED && error->retry_after_ms > 0);
+            limited++;
+        }
+    }
+    assert(limited == 5);
+
+    assert(session_send_tagged(&client, MSG_LIST_PLAYERS, 9, NULL, 0) == SUCCESS);
+    assert(session_recv_tagged_timeout(&client, &type, &sequence, payload, sizeof(payload), &size, 5000) == SUCCESS);
+    assert(type == MSG_PLAYER_LIST && sequence == 9);
+
+    assert(session_send_tagged(&client, MSG_DISCONNECT, 10, NULL, 0) == SUCCESS);
+    pthread_join(thread, NULL);
+    session_close(&client);
+
+    game_manager_destroy(&gm);
+    matchmaking_destroy(&mm);
+    storage_cleanup();
+}
+
 /* ========== Main Test Runner ========== */
 
 int main() {
@@ -270,6 +1550,35 @@ int main() {
     RUN_TEST(player_save_load);
     RUN_TEST(data_integrity_crc);
     RUN_TEST(player_bio_functionality);
+    RUN_TEST(paged_player_listing);
+    RUN_TEST(paged_saved_game_listing);
+    RUN_TEST(game_log_append_replay);
+    RUN_TEST(game_log_sync_policies);
+    RUN_TEST(game_log_compact_game);
+    RUN_TEST(game_log_archive_segments);
+    RUN_TEST(game_log_mapped_reads);
+    RUN_TEST(game_log_loads_during_compaction);
+    RUN_TEST(game_log_reads_version_1);
+    RUN_TEST(legacy_games_conversion);
+    RUN_TEST(startup_recovery);
+    RUN_TEST(player_store_dirty_flush);
+    RUN_TEST(game_catalog_filters);
+
+    /* Pseudo Table Tests */
+    RUN_TEST(pseudo_table_interning);
+
+    /* Game Handle Tests */
+    RUN_TEST(game_handle_generations);
+
+    /* Admission Tests */
+    RUN_TEST(token_bucket_refill);
+    RUN_TEST(admission_sheds_expensive_first);
+
+    /* Handler Tests */
+    RUN_TEST(client_handler_over_loopback);
+    RUN_TEST(client_handler_resume);
+    RUN_TEST(client_handler_replaced_by_login);
+    RUN_TEST(client_handler_rate_limits);
 
     printf("\n═══════════════════════════════════════════════════════\n");
     printf("  All %d tests passed!\n", tests_passed);